@@ -0,0 +1,407 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================
+//  OpcodeInfo — per-opcode metadata, built by the compiler
+//
+//  One entry per opcode value below kOpcodeSpace, generated from
+//  OpcodeList.inc:
+//    name        as in the list
+//    direction   from the prefix: CMSG_ client → server, SMSG_
+//                server → client, MSG_ either way
+//    category    first matching word of the name (kCategoryWords)
+//    size class  fixed for the opcodes in kFixedSizes, else variable
+//    compressed  the opcodes in kZlibBodies, with the offset of
+//                their [4] raw size field (zlib stream follows)
+//
+//  Every entry is a constant: Get() is an array index, Find() one
+//  probe of a name hash table, and nothing runs at startup.  Each
+//  opcode is classified in its own constant expression so no single
+//  evaluation comes near the compilers' constexpr step limits.
+// ============================================================
+
+enum class OpcodeDirection : uint8_t
+{
+    Unknown,   // not in the list, or UMSG_ / NUM_MSG_TYPES
+    Client,    // CMSG_
+    Server,    // SMSG_
+    Both,      // MSG_
+};
+
+enum class OpcodeSizeClass : uint8_t
+{
+    Variable,   // no fixed size known
+    Fixed,      // always fixedSize payload bytes (0 = empty)
+};
+
+enum class OpcodeCategory : uint8_t
+{
+    None,       // not an opcode of this build
+    Session,    // auth, login, characters, ping, account data, warden
+    Movement,
+    Chat,
+    Combat,
+    Spell,
+    Item,
+    Loot,
+    Quest,
+    Trade,      // vendors, auction house, mail, player trade
+    Group,      // party, raid, LFG, battlegrounds, arenas
+    Guild,
+    Social,     // friends, ignore, who, calendar
+    Pet,
+    Progress,   // achievements, reputation, skills, experience
+    World,      // object updates, queries, world states, NPC interaction
+    Gm,
+    Misc,
+    Count
+};
+
+struct OpcodeInfo
+{
+    const char*     name       = nullptr;   // null: not an opcode of this build
+    uint32_t        nameHash   = 0;
+    OpcodeDirection direction  = OpcodeDirection::Unknown;
+    OpcodeCategory  category   = OpcodeCategory::None;
+    OpcodeSizeClass sizeClass  = OpcodeSizeClass::Variable;
+    bool            compressed = false;
+    uint8_t         zlibAt     = 0;         // compressed: offset of the [4] raw size field
+    uint16_t        fixedSize  = 0;         // sizeClass == Fixed
+
+    constexpr bool Known() const { return name != nullptr; }
+    constexpr bool SizeFits(uint32_t size) const { return sizeClass != OpcodeSizeClass::Fixed || size == fixedSize; }
+};
+
+namespace OpcodeMeta
+{
+    constexpr uint16_t kOpcodeSpace = 0x520;
+
+    namespace detail
+    {
+        struct CategoryWord { const char* word; OpcodeCategory category; };
+        struct FixedSize    { const char* name; uint16_t size; };
+        struct ZlibBody     { const char* name; uint8_t rawSizeAt; };
+
+        // Matched against the start of each '_'-separated word of the
+        // name (prefix stripped), in order: the first hit wins, so
+        // narrower words come before the ones they would lose to
+        // (PETITION before PET, CHANNEL_START before CHANNEL).
+        constexpr CategoryWord kCategoryWords[] = {
+            { "GUILD", OpcodeCategory::Guild },       { "PETITION", OpcodeCategory::Guild },
+            { "TABARD", OpcodeCategory::Guild },      { "CHARTER", OpcodeCategory::Guild },
+            { "PET", OpcodeCategory::Pet },           { "STABLE", OpcodeCategory::Pet },
+            { "GM", OpcodeCategory::Gm },             { "DEBUG", OpcodeCategory::Gm },
+            { "CHEAT", OpcodeCategory::Gm },          { "DBLOOKUP", OpcodeCategory::Gm },
+            { "GODMODE", OpcodeCategory::Gm },        { "DEV", OpcodeCategory::Gm },
+            { "LOOT", OpcodeCategory::Loot },         { "ROLL", OpcodeCategory::Loot },
+            { "TRADE", OpcodeCategory::Trade },       { "AUCTION", OpcodeCategory::Trade },
+            { "MAIL", OpcodeCategory::Trade },        { "BUY", OpcodeCategory::Trade },
+            { "SELL", OpcodeCategory::Trade },        { "VENDOR", OpcodeCategory::Trade },
+            { "REPAIR", OpcodeCategory::Trade },      { "LIST_INVENTORY", OpcodeCategory::Trade },
+            { "QUEST", OpcodeCategory::Quest },       { "PUSHQUEST", OpcodeCategory::Quest },
+            { "CHANNEL_START", OpcodeCategory::Spell },
+            { "CHANNEL_UPDATE", OpcodeCategory::Spell },
+            { "SPELL", OpcodeCategory::Spell },       { "CAST", OpcodeCategory::Spell },
+            { "AURA", OpcodeCategory::Spell },        { "COOLDOWN", OpcodeCategory::Spell },
+            { "TALENT", OpcodeCategory::Spell },      { "TRAINER", OpcodeCategory::Spell },
+            { "GLYPH", OpcodeCategory::Spell },       { "TOTEM", OpcodeCategory::Spell },
+            { "LEARNED", OpcodeCategory::Spell },     { "UNLEARN", OpcodeCategory::Spell },
+            { "PERIODICAURALOG", OpcodeCategory::Spell },{ "DISPEL", OpcodeCategory::Spell },
+            { "RUNE", OpcodeCategory::Spell },        { "CONVERT_RUNE", OpcodeCategory::Spell },
+            { "RESYNC_RUNES", OpcodeCategory::Spell },{ "ACTION_BUTTON", OpcodeCategory::Spell },
+            { "MESSAGECHAT", OpcodeCategory::Chat },  { "CHAT", OpcodeCategory::Chat },
+            { "CHANNEL", OpcodeCategory::Chat },      { "EMOTE", OpcodeCategory::Chat },
+            { "TEXT_EMOTE", OpcodeCategory::Chat },   { "WHISPER", OpcodeCategory::Chat },
+            { "MESSAGE", OpcodeCategory::Chat },      { "NOTIFICATION", OpcodeCategory::Chat },
+            { "MOVE", OpcodeCategory::Movement },     { "MONSTER_MOVE", OpcodeCategory::Movement },
+            { "SPLINE", OpcodeCategory::Movement },   { "FORCE_", OpcodeCategory::Movement },
+            { "TELEPORT", OpcodeCategory::Movement }, { "TRANSFER", OpcodeCategory::Movement },
+            { "NEW_WORLD", OpcodeCategory::Movement },{ "FLIGHT", OpcodeCategory::Movement },
+            { "TAXI", OpcodeCategory::Movement },     { "MOVER", OpcodeCategory::Movement },
+            { "SET_FACING", OpcodeCategory::Movement },{ "MOUNT", OpcodeCategory::Movement },
+            { "DISMOUNT", OpcodeCategory::Movement }, { "ACTIVATETAXI", OpcodeCategory::Movement },
+            { "SHOWTAXINODES", OpcodeCategory::Movement },{ "ENABLETAXI", OpcodeCategory::Movement },
+            { "VEHICLE", OpcodeCategory::Movement },  { "STANDSTATE", OpcodeCategory::Movement },
+            { "SUMMON", OpcodeCategory::Movement },
+            { "ATTACK", OpcodeCategory::Combat },     { "DAMAGE", OpcodeCategory::Combat },
+            { "COMBAT", OpcodeCategory::Combat },     { "THREAT", OpcodeCategory::Combat },
+            { "DUEL", OpcodeCategory::Combat },       { "PVP", OpcodeCategory::Combat },
+            { "HONOR", OpcodeCategory::Combat },      { "KILL", OpcodeCategory::Combat },
+            { "DEATH", OpcodeCategory::Combat },      { "REPOP", OpcodeCategory::Combat },
+            { "RESURRECT", OpcodeCategory::Combat },  { "CORPSE", OpcodeCategory::Combat },
+            { "SPIRIT", OpcodeCategory::Combat },     { "ENVIRONMENTAL", OpcodeCategory::Combat },
+            { "AI_REACTION", OpcodeCategory::Combat },{ "HEALTH", OpcodeCategory::Combat },
+            { "POWER", OpcodeCategory::Combat },      { "BREAK_TARGET", OpcodeCategory::Combat },
+            { "RESISTLOG", OpcodeCategory::Combat },  { "PROCRESIST", OpcodeCategory::Combat },
+            { "UPDATE_COMBO", OpcodeCategory::Combat },{ "SET_SHEATHED", OpcodeCategory::Combat },
+            { "GROUP", OpcodeCategory::Group },       { "PARTY", OpcodeCategory::Group },
+            { "RAID", OpcodeCategory::Group },        { "LFG", OpcodeCategory::Group },
+            { "LFD", OpcodeCategory::Group },         { "BATTLEFIELD", OpcodeCategory::Group },
+            { "BATTLEGROUND", OpcodeCategory::Group },{ "ARENA", OpcodeCategory::Group },
+            { "INSTANCE", OpcodeCategory::Group },    { "READY_CHECK", OpcodeCategory::Group },
+            { "MINIMAP_PING", OpcodeCategory::Group },{ "BATTLEMASTER", OpcodeCategory::Group },
+            { "COMMENTATOR", OpcodeCategory::Group }, { "DIFFICULTY", OpcodeCategory::Group },
+            { "CHANGEPLAYER_DIFFICULTY", OpcodeCategory::Group },
+            { "FRIEND", OpcodeCategory::Social },     { "IGNORE", OpcodeCategory::Social },
+            { "CONTACT", OpcodeCategory::Social },    { "WHO", OpcodeCategory::Social },
+            { "INSPECT", OpcodeCategory::Social },    { "CALENDAR", OpcodeCategory::Social },
+            { "COMPLAIN", OpcodeCategory::Social },   { "VOICE", OpcodeCategory::Social },
+            { "ITEM", OpcodeCategory::Item },         { "INVENTORY", OpcodeCategory::Item },
+            { "EQUIP", OpcodeCategory::Item },        { "BANK", OpcodeCategory::Item },
+            { "SWAP", OpcodeCategory::Item },         { "SPLIT", OpcodeCategory::Item },
+            { "DESTROYITEM", OpcodeCategory::Item },  { "SOCKET", OpcodeCategory::Item },
+            { "ENCHANT", OpcodeCategory::Item },      { "DURABILITY", OpcodeCategory::Item },
+            { "WRAP", OpcodeCategory::Item },         { "AUTOSTORE", OpcodeCategory::Item },
+            { "AUTOEQUIP", OpcodeCategory::Item },    { "AUTOBANK", OpcodeCategory::Item },
+            { "ACHIEVEMENT", OpcodeCategory::Progress },{ "CRITERIA", OpcodeCategory::Progress },
+            { "REPUTATION", OpcodeCategory::Progress },{ "FACTION", OpcodeCategory::Progress },
+            { "XP", OpcodeCategory::Progress },       { "LOG_XPGAIN", OpcodeCategory::Progress },
+            { "LEVELUP", OpcodeCategory::Progress },  { "SKILL", OpcodeCategory::Progress },
+            { "TITLE", OpcodeCategory::Progress },    { "EXPLORATION", OpcodeCategory::Progress },
+            { "AUTH", OpcodeCategory::Session },      { "PING", OpcodeCategory::Session },
+            { "PONG", OpcodeCategory::Session },      { "KEEP_ALIVE", OpcodeCategory::Session },
+            { "LOGOUT", OpcodeCategory::Session },    { "LOGIN", OpcodeCategory::Session },
+            { "PLAYER_LOGIN", OpcodeCategory::Session },{ "CHAR", OpcodeCategory::Session },
+            { "ACCOUNT", OpcodeCategory::Session },   { "REALM", OpcodeCategory::Session },
+            { "WARDEN", OpcodeCategory::Session },    { "ADDON", OpcodeCategory::Session },
+            { "TIME_SYNC", OpcodeCategory::Session }, { "REDIRECT", OpcodeCategory::Session },
+            { "CONNECT", OpcodeCategory::Session },   { "MOTD", OpcodeCategory::Session },
+            { "TUTORIAL", OpcodeCategory::Session },  { "FEATURE", OpcodeCategory::Session },
+            { "CLIENTCACHE", OpcodeCategory::Session },{ "READY_FOR", OpcodeCategory::Session },
+            { "PLAYED_TIME", OpcodeCategory::Session },{ "KICK_REASON", OpcodeCategory::Session },
+            { "SUSPEND_COMMS", OpcodeCategory::Session },{ "MULTIPLE_PACKETS", OpcodeCategory::Session },
+            { "SERVERINFO", OpcodeCategory::Session },{ "SERVER_INFO", OpcodeCategory::Session },
+            { "UPDATE_OBJECT", OpcodeCategory::World },{ "DESTROY_OBJECT", OpcodeCategory::World },
+            { "OBJECT", OpcodeCategory::World },      { "QUERY", OpcodeCategory::World },
+            { "WEATHER", OpcodeCategory::World },     { "WORLD", OpcodeCategory::World },
+            { "TIME", OpcodeCategory::World },        { "AREA", OpcodeCategory::World },
+            { "ZONE", OpcodeCategory::World },        { "GAMEOBJ", OpcodeCategory::World },
+            { "GAMEOBJECT", OpcodeCategory::World },  { "CREATURE", OpcodeCategory::World },
+            { "NPC", OpcodeCategory::World },         { "GOSSIP", OpcodeCategory::World },
+            { "CINEMATIC", OpcodeCategory::World },   { "SOUND", OpcodeCategory::World },
+            { "MUSIC", OpcodeCategory::World },       { "BINDPOINT", OpcodeCategory::World },
+            { "SET_SELECTION", OpcodeCategory::World },{ "MAP", OpcodeCategory::World },
+            { "BIND", OpcodeCategory::World },        { "SETDEATHBINDPOINT", OpcodeCategory::World },
+            { "GETDEATHBINDZONE", OpcodeCategory::World },{ "BINDZONEREPLY", OpcodeCategory::World },
+            { "PLAYERBINDERROR", OpcodeCategory::World },{ "BINDER", OpcodeCategory::World },
+            { "GAMETIME", OpcodeCategory::World },    { "SERVERTIME", OpcodeCategory::World },
+            { "PHASE", OpcodeCategory::World },       { "FAR_SIGHT", OpcodeCategory::World },
+            { "MOVIE", OpcodeCategory::World },       { "CAMERA", OpcodeCategory::World },
+        };
+
+        // 3.3.5a payloads that never vary (bytes after the opcode).
+        constexpr FixedSize kFixedSizes[] = {
+            { "CMSG_PING", 8 },                      { "SMSG_PONG", 4 },
+            { "CMSG_KEEP_ALIVE", 0 },                { "SMSG_AUTH_CHALLENGE", 40 },
+            { "SMSG_TIME_SYNC_REQ", 4 },             { "CMSG_TIME_SYNC_RESP", 8 },
+            { "CMSG_CHAR_ENUM", 0 },                 { "CMSG_PLAYER_LOGIN", 8 },
+            { "CMSG_LOGOUT_REQUEST", 0 },            { "CMSG_LOGOUT_CANCEL", 0 },
+            { "SMSG_LOGOUT_COMPLETE", 0 },           { "SMSG_LOGOUT_CANCEL_ACK", 0 },
+            { "SMSG_LOGIN_VERIFY_WORLD", 20 },
+            { "CMSG_READY_FOR_ACCOUNT_DATA_TIMES", 0 },
+            { "CMSG_REQUEST_ACCOUNT_DATA", 4 },
+            { "CMSG_QUERY_TIME", 0 },                { "SMSG_QUERY_TIME_RESPONSE", 8 },
+            { "CMSG_PLAYED_TIME", 1 },               { "SMSG_PLAYED_TIME", 9 },
+            { "CMSG_NAME_QUERY", 8 },                { "CMSG_CREATURE_QUERY", 12 },
+            { "CMSG_GAMEOBJECT_QUERY", 12 },         { "CMSG_ITEM_QUERY_SINGLE", 4 },
+            { "CMSG_QUEST_QUERY", 4 },               { "CMSG_NPC_TEXT_QUERY", 12 },
+            { "CMSG_PAGE_TEXT_QUERY", 12 },          { "CMSG_PET_NAME_QUERY", 12 },
+            { "CMSG_ITEM_NAME_QUERY", 12 },          { "CMSG_GUILD_QUERY", 4 },
+            { "CMSG_SET_SELECTION", 8 },             { "CMSG_INSPECT", 8 },
+            { "CMSG_GOSSIP_HELLO", 8 },              { "CMSG_BANKER_ACTIVATE", 8 },
+            { "CMSG_LIST_INVENTORY", 8 },            { "CMSG_QUESTGIVER_HELLO", 8 },
+            { "CMSG_QUESTGIVER_STATUS_QUERY", 8 },   { "CMSG_TRAINER_LIST", 8 },
+            { "CMSG_LOOT", 8 },                      { "CMSG_LOOT_RELEASE", 8 },
+            { "CMSG_LOOT_MONEY", 0 },                { "CMSG_AUTOSTORE_LOOT_ITEM", 1 },
+            { "CMSG_CANCEL_CAST", 5 },               { "CMSG_CANCEL_AURA", 4 },
+            { "CMSG_CANCEL_AUTO_REPEAT_SPELL", 0 },  { "CMSG_STANDSTATECHANGE", 4 },
+            { "CMSG_SET_SHEATHED", 4 },              { "CMSG_ZONEUPDATE", 4 },
+            { "CMSG_TUTORIAL_FLAG", 4 },             { "CMSG_TUTORIAL_CLEAR", 0 },
+            { "CMSG_TUTORIAL_RESET", 0 },            { "CMSG_REPOP_REQUEST", 1 },
+            { "CMSG_RECLAIM_CORPSE", 8 },            { "CMSG_SET_ACTIVE_MOVER", 8 },
+            { "SMSG_TRIGGER_CINEMATIC", 4 },
+        };
+
+        // Bodies that carry a zlib stream (see PacketInflater.h).
+        constexpr ZlibBody kZlibBodies[] = {
+            { "SMSG_COMPRESSED_UPDATE_OBJECT", 0 },
+            { "SMSG_COMPRESSED_MOVES", 0 },
+            { "CMSG_UPDATE_ACCOUNT_DATA", 8 },
+            { "SMSG_UPDATE_ACCOUNT_DATA", 16 },
+        };
+
+        constexpr bool Equal(const char* a, const char* b)
+        {
+            while (*a && *a == *b) { ++a; ++b; }
+            return *a == *b;
+        }
+
+        constexpr bool StartsWith(const char* s, const char* prefix)
+        {
+            while (*prefix)
+                if (*s++ != *prefix++) return false;
+            return true;
+        }
+
+        // FNV-1a; also what Find() hashes the query with.
+        constexpr uint32_t HashName(const char* s)
+        {
+            uint32_t h = 2166136261u;
+            while (*s) h = (h ^ static_cast<uint8_t>(*s++)) * 16777619u;
+            return h;
+        }
+
+        constexpr const char* StripPrefix(const char* name, OpcodeDirection& dir)
+        {
+            if (StartsWith(name, "CMSG_")) { dir = OpcodeDirection::Client; return name + 5; }
+            if (StartsWith(name, "SMSG_")) { dir = OpcodeDirection::Server; return name + 5; }
+            if (StartsWith(name, "MSG_"))  { dir = OpcodeDirection::Both;   return name + 4; }
+            dir = OpcodeDirection::Unknown;
+            return name;
+        }
+
+        // Lowest-index word that starts one of the name's words.
+        constexpr OpcodeCategory Classify(const char* body)
+        {
+            constexpr size_t kWords = sizeof(kCategoryWords) / sizeof(kCategoryWords[0]);
+            size_t best = kWords;
+            for (const char* p = body; *p; ++p)
+            {
+                if (p != body && p[-1] != '_') continue;
+                for (size_t w = 0; w < best; ++w)
+                    if (*p == kCategoryWords[w].word[0] && StartsWith(p, kCategoryWords[w].word))
+                    {
+                        best = w;
+                        break;
+                    }
+            }
+            return best < kWords ? kCategoryWords[best].category : OpcodeCategory::Misc;
+        }
+
+        constexpr OpcodeInfo Make(const char* name)
+        {
+            OpcodeInfo i;
+            i.name     = name;
+            i.nameHash = HashName(name);
+            i.category = Classify(StripPrefix(name, i.direction));
+            if (i.direction == OpcodeDirection::Unknown) i.category = OpcodeCategory::Misc;
+            return i;
+        }
+
+#define X(n, v) constexpr OpcodeInfo k_##n = Make(#n);
+#include "OpcodeList.inc"
+#undef X
+
+        // Open addressing on nameHash, linear probing; kNoSlot = empty.
+        constexpr size_t   kNameSlots = 4096;
+        constexpr uint16_t kNoSlot    = 0xFFFF;
+        using NameIndex = std::array<uint16_t, kNameSlots>;
+
+        constexpr NameIndex kByName = [] {
+            NameIndex t{};
+            for (uint16_t& s : t) s = kNoSlot;
+#define X(n, v) { size_t s = k_##n.nameHash & (kNameSlots - 1); \
+                  while (t[s] != kNoSlot) s = (s + 1) & (kNameSlots - 1); \
+                  t[s] = v; }
+#include "OpcodeList.inc"
+#undef X
+            return t;
+        }();
+
+        template <class Table>
+        constexpr uint16_t Probe(const Table& table, const char* name)
+        {
+            const uint32_t h = HashName(name);
+            for (size_t s = h & (kNameSlots - 1); kByName[s] != kNoSlot; s = (s + 1) & (kNameSlots - 1))
+                if (table[kByName[s]].nameHash == h && Equal(table[kByName[s]].name, name)) return kByName[s];
+            return kNoSlot;
+        }
+
+        constexpr std::array<OpcodeInfo, kOpcodeSpace> kTable = [] {
+            std::array<OpcodeInfo, kOpcodeSpace> t{};
+#define X(n, v) t[v] = k_##n;
+#include "OpcodeList.inc"
+#undef X
+            for (const FixedSize& f : kFixedSizes)
+            {
+                const uint16_t op = Probe(t, f.name);
+                if (op == kNoSlot) continue;   // caught by the static_assert below
+                t[op].sizeClass = OpcodeSizeClass::Fixed;
+                t[op].fixedSize = f.size;
+            }
+            for (const ZlibBody& z : kZlibBodies)
+            {
+                const uint16_t op = Probe(t, z.name);
+                if (op == kNoSlot) continue;
+                t[op].compressed = true;
+                t[op].zlibAt     = z.rawSizeAt;
+            }
+            return t;
+        }();
+
+        constexpr OpcodeInfo kNone{};
+    }
+
+    // Entry for `opcode`; an empty one (None, Variable) past the list.
+    constexpr const OpcodeInfo& Get(uint16_t opcode)
+    {
+        return opcode < kOpcodeSpace ? detail::kTable[opcode] : detail::kNone;
+    }
+
+    // Opcode value by exact name.
+    constexpr bool Find(const char* name, uint16_t& out)
+    {
+        const uint16_t op = detail::Probe(detail::kTable, name);
+        if (op == detail::kNoSlot) return false;
+        out = op;
+        return true;
+    }
+
+    namespace detail
+    {
+        constexpr bool AllNamed()
+        {
+            for (const FixedSize& f : kFixedSizes)
+                if (Probe(kTable, f.name) == kNoSlot) return false;
+            for (const ZlibBody& z : kZlibBodies)
+                if (Probe(kTable, z.name) == kNoSlot) return false;
+            return true;
+        }
+    }
+    static_assert(detail::AllNamed(), "kFixedSizes / kZlibBodies name an opcode missing from OpcodeList.inc");
+
+    constexpr const char* CategoryName(OpcodeCategory c)
+    {
+        constexpr const char* kNames[] = { "none",  "session", "movement", "chat",   "combat",   "spell",
+                                           "item",  "loot",    "quest",    "trade",  "group",    "guild",
+                                           "social", "pet",    "progress", "world",  "gm",       "misc" };
+        static_assert(sizeof(kNames) / sizeof(kNames[0]) == static_cast<size_t>(OpcodeCategory::Count),
+                      "one name per category");
+        return c < OpcodeCategory::Count ? kNames[static_cast<size_t>(c)] : "?";
+    }
+
+    // "movement" → Movement; false for an unknown word.
+    constexpr bool ParseCategory(const char* text, OpcodeCategory& out)
+    {
+        for (uint8_t c = 0; c < static_cast<uint8_t>(OpcodeCategory::Count); ++c)
+            if (detail::Equal(CategoryName(static_cast<OpcodeCategory>(c)), text))
+            {
+                out = static_cast<OpcodeCategory>(c);
+                return true;
+            }
+        return false;
+    }
+
+    constexpr const char* DirectionName(OpcodeDirection d)
+    {
+        switch (d)
+        {
+        case OpcodeDirection::Client: return "client";
+        case OpcodeDirection::Server: return "server";
+        case OpcodeDirection::Both:   return "both";
+        default:                      return "unknown";
+        }
+    }
+}
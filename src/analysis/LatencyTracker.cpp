@@ -0,0 +1,502 @@
+#include "LatencyTracker.h"
+#include "../packet/PacketCapture.h"
+#include "../log/Log.h"
+#include "Opcodes.h"
+#include <cstdio>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// ============================================================
+//  LatencyHistogram
+// ============================================================
+
+static inline uint32_t HighestBit(uint32_t v)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanReverse(&idx, v);
+    return static_cast<uint32_t>(idx);
+#else
+    return 31u - static_cast<uint32_t>(__builtin_clz(v));
+#endif
+}
+
+// Values below 2^kSubBits get a bucket each; above, the top kSubBits
+// bits after the leading one pick one of 16 buckets per power of two.
+static inline uint32_t BucketOf(uint32_t v)
+{
+    constexpr uint32_t kSub = 1u << LatencyHistogram::kSubBits;
+    if (v < kSub) return v;
+    const uint32_t shift = HighestBit(v) - LatencyHistogram::kSubBits;
+    return ((shift + 1) << LatencyHistogram::kSubBits) | ((v >> shift) & (kSub - 1));
+}
+
+static inline uint32_t BucketLow(uint32_t b)
+{
+    constexpr uint32_t kSub = 1u << LatencyHistogram::kSubBits;
+    if (b < kSub) return b;
+    const uint32_t shift = (b >> LatencyHistogram::kSubBits) - 1;
+    return (kSub | (b & (kSub - 1))) << shift;
+}
+
+static inline uint32_t BucketWidth(uint32_t b)
+{
+    return b < (1u << LatencyHistogram::kSubBits) ? 1u : 1u << ((b >> LatencyHistogram::kSubBits) - 1);
+}
+
+void LatencyHistogram::Add(uint32_t us)
+{
+    ++m_buckets[BucketOf(us)];
+    ++m_count;
+    m_sum += us;
+    if (us < m_min) m_min = us;
+    if (us > m_max) m_max = us;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+    if (!other.m_count) return;
+    for (uint32_t b = 0; b < kBuckets; ++b)
+        m_buckets[b] += other.m_buckets[b];
+    m_count += other.m_count;
+    m_sum   += other.m_sum;
+    if (other.m_min < m_min) m_min = other.m_min;
+    if (other.m_max > m_max) m_max = other.m_max;
+}
+
+void LatencyHistogram::Clear()
+{
+    *this = LatencyHistogram();
+}
+
+uint32_t LatencyHistogram::Percentile(double q) const
+{
+    if (!m_count) return 0;
+    if (q <= 0.0) return m_min;
+    if (q >= 1.0) return m_max;
+
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(m_count));
+    if (static_cast<double>(rank) < q * static_cast<double>(m_count)) ++rank;   // ceil
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < kBuckets; ++b)
+    {
+        seen += m_buckets[b];
+        if (seen < rank) continue;
+        // Bucket midpoint, clamped to what was actually recorded.
+        const uint64_t mid = static_cast<uint64_t>(BucketLow(b)) + (BucketWidth(b) - 1) / 2;
+        if (mid < m_min) return m_min;
+        if (mid > m_max) return m_max;
+        return static_cast<uint32_t>(mid);
+    }
+    return m_max;
+}
+
+static LatencySummary Summarize(const LatencyHistogram& h)
+{
+    LatencySummary s;
+    s.count = h.Count();
+    s.mean  = h.Mean();
+    s.p50   = h.Percentile(0.50);
+    s.p90   = h.Percentile(0.90);
+    s.p99   = h.Percentile(0.99);
+    s.max   = h.Max();
+    return s;
+}
+
+// ============================================================
+//  Keys
+// ============================================================
+
+const char* LatencyKeyName(LatencyKey key)
+{
+    static const char* kNames[] = { "fifo", "u32", "entry", "guid", "spell" };
+    return static_cast<size_t>(key) < static_cast<size_t>(LatencyKey::Count) ? kNames[static_cast<size_t>(key)] : "?";
+}
+
+static bool ReadPackedGuid(const uint8_t*& p, const uint8_t* end, uint64_t& guid)
+{
+    if (p >= end) return false;
+    const uint8_t mask = *p++;
+    guid = 0;
+    for (int i = 0; i < 8; ++i)
+        if (mask & (1u << i))
+        {
+            if (p >= end) return false;
+            guid |= static_cast<uint64_t>(*p++) << (8 * i);
+        }
+    return true;
+}
+
+// Spell key: cast count in the high byte, spell id below.
+static bool ReadSpellKey(const uint8_t* p, const uint8_t* end, uint64_t& key)
+{
+    if (end - p < 5) return false;
+    uint32_t spell;
+    memcpy(&spell, p + 1, 4);
+    key = (static_cast<uint64_t>(p[0]) << 32) | spell;
+    return true;
+}
+
+// False when the pair is keyless or the bytes holding the key were not stored.
+static bool RequestKey(LatencyKey kind, const CapturedPacket& pkt, uint64_t& key)
+{
+    const uint8_t* p   = pkt.payload.data();
+    const uint8_t* end = p + pkt.payload.size();
+    switch (kind)
+    {
+    case LatencyKey::U32:
+    case LatencyKey::Entry:
+    {
+        if (end - p < 4) return false;
+        uint32_t v;
+        memcpy(&v, p, 4);
+        key = v;
+        return true;
+    }
+    case LatencyKey::Guid:
+        if (end - p < 8) return false;
+        memcpy(&key, p, 8);
+        return true;
+    case LatencyKey::Spell:
+        return ReadSpellKey(p, end, key);
+    default:
+        return false;
+    }
+}
+
+static bool ResponseKey(LatencyKey kind, const CapturedPacket& pkt, uint64_t& key)
+{
+    const uint8_t* p   = pkt.payload.data();
+    const uint8_t* end = p + pkt.payload.size();
+    switch (kind)
+    {
+    case LatencyKey::U32:
+    case LatencyKey::Entry:
+    {
+        if (end - p < 4) return false;
+        uint32_t v;
+        memcpy(&v, p, 4);
+        key = kind == LatencyKey::Entry ? (v & 0x7FFFFFFFu) : v;
+        return true;
+    }
+    case LatencyKey::Guid:
+        return ReadPackedGuid(p, end, key);
+    case LatencyKey::Spell:
+    {
+        uint64_t castItem, caster;
+        return ReadPackedGuid(p, end, castItem) && ReadPackedGuid(p, end, caster) && ReadSpellKey(p, end, key);
+    }
+    default:
+        return false;
+    }
+}
+
+// ============================================================
+//  Pairing table
+// ============================================================
+
+std::vector<LatencyPair> LatencyTracker::DefaultPairs()
+{
+    std::vector<LatencyPair> pairs;
+    pairs.push_back({ CMSG_PING, { SMSG_PONG, 0 }, LatencyKey::U32 });
+
+    // CMSG_<X> with "QUERY" in it, answered by SMSG_<X>_RESPONSE.
+    for (uint16_t op = 0; op < NUM_MSG_TYPES; ++op)
+    {
+        const OpcodeInfo& info = OpcodeMeta::Get(op);
+        if (info.direction != OpcodeDirection::Client || !strstr(info.name, "QUERY")) continue;
+        char want[96];
+        snprintf(want, sizeof(want), "SMSG_%s_RESPONSE", info.name + 5);
+        uint16_t resp;
+        if (OpcodeMeta::Find(want, resp)) pairs.push_back({ op, { resp, 0 }, LatencyKey::Fifo });
+    }
+    pairs.push_back({ CMSG_NPC_TEXT_QUERY, { SMSG_NPC_TEXT_UPDATE, 0 }, LatencyKey::Fifo });
+    pairs.push_back({ CMSG_CAST_SPELL, { SMSG_SPELL_START, SMSG_SPELL_GO }, LatencyKey::Spell });
+
+    // Queries whose first request field comes back first in the response.
+    for (LatencyPair& p : pairs)
+        switch (p.request)
+        {
+        case CMSG_NAME_QUERY:
+            p.key = LatencyKey::Guid;
+            break;
+        case CMSG_CREATURE_QUERY:
+        case CMSG_GAMEOBJECT_QUERY:
+        case CMSG_ITEM_QUERY_SINGLE:
+        case CMSG_ITEM_NAME_QUERY:
+        case CMSG_QUEST_QUERY:
+        case CMSG_PAGE_TEXT_QUERY:
+        case CMSG_NPC_TEXT_QUERY:
+            p.key = LatencyKey::Entry;
+            break;
+        case CMSG_PET_NAME_QUERY:
+        case CMSG_GUILD_QUERY:
+        case CMSG_ARENA_TEAM_QUERY:
+        case CMSG_PETITION_QUERY:
+            p.key = LatencyKey::U32;
+            break;
+        default:
+            break;
+        }
+    return pairs;
+}
+
+bool LatencyTracker::ResetLocked(const std::vector<LatencyPair>& pairs, uint64_t windowMicros)
+{
+    if (pairs.size() > kMaxPairs || windowMicros == 0) return false;
+
+    std::vector<uint8_t> requestOf(65536), responseOf(65536);
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        const LatencyPair& p = pairs[i];
+        if (requestOf[p.request]) return false;
+        requestOf[p.request] = static_cast<uint8_t>(i + 1);
+        for (uint16_t r : p.responses)
+        {
+            if (!r) continue;
+            if (responseOf[r]) return false;
+            responseOf[r] = static_cast<uint8_t>(i + 1);
+        }
+    }
+
+    memcpy(s_requestOf, requestOf.data(), requestOf.size());
+    memcpy(s_responseOf, responseOf.data(), responseOf.size());
+    s_pairs.assign(pairs.size(), PairState());
+    for (size_t i = 0; i < pairs.size(); ++i)
+        s_pairs[i].pair = pairs[i];
+    s_windowUs     = windowMicros;
+    s_latestWindow = 0;
+    s_configured   = true;
+    return true;
+}
+
+bool LatencyTracker::Configure(const std::vector<LatencyPair>& pairs, uint64_t windowMicros)
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    return ResetLocked(pairs, windowMicros);
+}
+
+std::vector<LatencyPair> LatencyTracker::Pairs()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    std::vector<LatencyPair> out;
+    out.reserve(s_pairs.size());
+    for (const PairState& ps : s_pairs)
+        out.push_back(ps.pair);
+    return out;
+}
+
+uint64_t LatencyTracker::WindowMicros()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    return s_windowUs;
+}
+
+// ============================================================
+//  Start / Stop
+// ============================================================
+
+bool LatencyTracker::Start()
+{
+    if (IsRunning()) return true;
+    {
+        std::lock_guard<std::mutex> lk(s_mutex);
+        if (!s_configured) ResetLocked(DefaultPairs(), kDefaultWindowMicros);
+    }
+    if (!PacketCapture::AddSink(&LatencyTracker::Sink))
+    {
+        LOG_WARN(Analysis, "LatencyTracker: no free capture sink slot");
+        return false;
+    }
+    s_running.store(true, std::memory_order_release);
+    LOG_INFO(Analysis, "LatencyTracker: tracking %zu request/response pairs", s_pairs.size());
+    return true;
+}
+
+void LatencyTracker::Stop()
+{
+    if (!IsRunning()) return;
+    PacketCapture::RemoveSink(&LatencyTracker::Sink);
+    s_running.store(false, std::memory_order_release);
+}
+
+// ============================================================
+//  Matching
+// ============================================================
+
+void LatencyTracker::Sink(const CapturedPacket& pkt)
+{
+    // Cheap reject before the lock: most packets are neither side of a pair.
+    const uint8_t* table = pkt.direction == PacketDirection::CMSG ? s_requestOf : s_responseOf;
+    if (!table[pkt.opcode]) return;
+
+    std::lock_guard<std::mutex> lk(s_mutex);
+    ConsumeOne(pkt);
+}
+
+void LatencyTracker::Consume(const std::vector<CapturedPacket>& packets)
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    if (!s_configured) ResetLocked(DefaultPairs(), kDefaultWindowMicros);
+    for (const CapturedPacket& pkt : packets)
+        ConsumeOne(pkt);
+}
+
+// Drops dead slots and expired requests off the head of the ring.
+void LatencyTracker::Retire(PairState& ps, uint64_t now)
+{
+    while (ps.used)
+    {
+        Open& o = ps.open[ps.head];
+        if (o.live)
+        {
+            if (now < o.timestamp_us + kOpenTimeoutMicros) break;
+            o.live = false;
+            --ps.live;
+            ++ps.expired;
+        }
+        ps.head = (ps.head + 1) % kMaxOpen;
+        --ps.used;
+    }
+}
+
+void LatencyTracker::Record(PairState& ps, uint64_t atUs, uint32_t latencyUs)
+{
+    ++ps.matched;
+    ps.total.Add(latencyUs);
+
+    if (ps.windows.empty()) ps.windows.resize(kWindows);
+    const uint64_t index = atUs / s_windowUs;
+    Window& w = ps.windows[index % kWindows];
+    if (w.index != index)
+    {
+        w.index = index;
+        w.hist.Clear();
+    }
+    w.hist.Add(latencyUs);
+    if (index > s_latestWindow) s_latestWindow = index;
+}
+
+void LatencyTracker::ConsumeOne(const CapturedPacket& pkt)
+{
+    if (pkt.direction == PacketDirection::CMSG)
+    {
+        const uint8_t slot = s_requestOf[pkt.opcode];
+        if (!slot) return;
+        PairState& ps = s_pairs[slot - 1];
+        Retire(ps, pkt.timestamp_us);
+        if (ps.used == kMaxOpen)   // head is live: the ring is full of open requests
+        {
+            ps.open[ps.head].live = false;
+            --ps.live;
+            ++ps.evicted;
+            ps.head = (ps.head + 1) % kMaxOpen;
+            --ps.used;
+        }
+        Open& o        = ps.open[(ps.head + ps.used) % kMaxOpen];
+        o.timestamp_us = pkt.timestamp_us;
+        o.connection   = pkt.connection;
+        o.keyed        = RequestKey(ps.pair.key, pkt, o.key);
+        o.live         = true;
+        ++ps.used;
+        ++ps.live;
+        return;
+    }
+
+    const uint8_t slot = s_responseOf[pkt.opcode];
+    if (!slot) return;
+    PairState& ps = s_pairs[slot - 1];
+    Retire(ps, pkt.timestamp_us);
+
+    uint64_t   key   = 0;
+    const bool keyed = ResponseKey(ps.pair.key, pkt, key);
+    for (uint32_t i = 0; i < ps.used; ++i)
+    {
+        Open& o = ps.open[(ps.head + i) % kMaxOpen];
+        if (!o.live || o.connection != pkt.connection) continue;
+        if (keyed && o.keyed && o.key != key) continue;
+
+        const uint64_t rtt = pkt.timestamp_us > o.timestamp_us ? pkt.timestamp_us - o.timestamp_us : 0;
+        Record(ps, pkt.timestamp_us, rtt > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(rtt));
+        o.live = false;
+        --ps.live;
+        Retire(ps, pkt.timestamp_us);
+        return;
+    }
+    ++ps.unmatched;
+}
+
+void LatencyTracker::Clear()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    for (PairState& ps : s_pairs)
+    {
+        const LatencyPair pair = ps.pair;
+        ps      = PairState();
+        ps.pair = pair;
+    }
+    s_latestWindow = 0;
+}
+
+// ============================================================
+//  Queries
+// ============================================================
+
+std::vector<LatencyPairStats> LatencyTracker::Stats(uint32_t recentWindows)
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    std::vector<LatencyPairStats> out(s_pairs.size());
+    if (recentWindows > kWindows) recentWindows = kWindows;
+
+    LatencyHistogram recent;
+    for (size_t i = 0; i < s_pairs.size(); ++i)
+    {
+        const PairState&  ps = s_pairs[i];
+        LatencyPairStats& st = out[i];
+        st.pair      = ps.pair;
+        st.matched   = ps.matched;
+        st.unmatched = ps.unmatched;
+        st.evicted   = ps.evicted;
+        st.expired   = ps.expired;
+        st.open      = ps.live;
+        st.total     = Summarize(ps.total);
+
+        recent.Clear();
+        for (const Window& w : ps.windows)
+            if (w.index != UINT64_MAX && w.index + recentWindows > s_latestWindow)
+                recent.Merge(w.hist);
+        st.recent = Summarize(recent);
+    }
+    return out;
+}
+
+std::vector<LatencyWindow> LatencyTracker::Series(size_t index)
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    std::vector<LatencyWindow> out;
+    if (index >= s_pairs.size()) return out;
+
+    const PairState& ps    = s_pairs[index];
+    const uint64_t   first = s_latestWindow >= kWindows - 1 ? s_latestWindow - (kWindows - 1) : 0;
+    out.resize(static_cast<size_t>(s_latestWindow - first + 1));
+    for (size_t k = 0; k < out.size(); ++k)
+    {
+        LatencyWindow& lw = out[k];
+        const uint64_t wi = first + k;
+        lw.startUs = wi * s_windowUs;
+        if (ps.windows.empty()) continue;
+        const Window& w = ps.windows[wi % kWindows];
+        if (w.index != wi) continue;
+        lw.count = static_cast<uint32_t>(w.hist.Count());
+        lw.p50   = w.hist.Percentile(0.50);
+        lw.p90   = w.hist.Percentile(0.90);
+        lw.p99   = w.hist.Percentile(0.99);
+        lw.max   = w.hist.Max();
+    }
+    return out;
+}
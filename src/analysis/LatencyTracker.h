@@ -0,0 +1,180 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "../wow/WowTypes.h"
+
+// ============================================================
+//  LatencyTracker — request → response round trips per opcode pair
+//
+//  A pairing table maps a CMSG request to up to two SMSG responses
+//  (CMSG_PING → SMSG_PONG, CMSG_*_QUERY → SMSG_*_QUERY_RESPONSE,
+//  CMSG_CAST_SPELL → SMSG_SPELL_START / SMSG_SPELL_GO).  A response
+//  closes the oldest open request of its pair on the same
+//  connection whose key matches.  Keys come from the payloads (ping
+//  counter, entry id, guid, cast count + spell id), so interleaved
+//  queries pair correctly and other players' casts are ignored;
+//  keyless pairs, and packets stored without the key bytes, match
+//  first in, first out.
+//
+//  Memory is fixed: at most kMaxOpen open requests per pair (the
+//  oldest is evicted), dropped after kOpenTimeoutMicros (expired).
+//  Latencies go into log-linear histograms — one since Clear() and
+//  a ring of kWindows time windows per pair — so percentiles are
+//  streaming and cost the same after a day as after a minute.
+//
+//  Runs as a PacketCapture sink on the pipeline worker, like
+//  CaptureMirror; Consume() feeds a saved capture offline.
+// ============================================================
+
+// Microsecond histogram: 16 sub-buckets per power of two, so a
+// percentile is within 1/32 (3.1 %) of the exact value.
+class LatencyHistogram
+{
+public:
+    static constexpr uint32_t kSubBits = 4;
+    static constexpr uint32_t kBuckets = (32 - kSubBits + 1) << kSubBits;
+
+    void Add(uint32_t us);
+    void Merge(const LatencyHistogram& other);
+    void Clear();
+
+    uint64_t Count() const { return m_count; }
+    uint32_t Min()   const { return m_count ? m_min : 0; }
+    uint32_t Max()   const { return m_max; }
+    double   Mean()  const { return m_count ? static_cast<double>(m_sum) / m_count : 0.0; }
+    uint32_t Percentile(double q) const;   // q in [0, 1]; 0 when empty
+
+private:
+    uint32_t m_buckets[kBuckets] = {};
+    uint64_t m_count = 0;
+    uint64_t m_sum   = 0;
+    uint32_t m_min   = UINT32_MAX;
+    uint32_t m_max   = 0;
+};
+
+// How a request and its response are tied together.
+enum class LatencyKey : uint8_t
+{
+    Fifo,    // oldest open request on the connection
+    U32,     // u32 @0 on both sides (ping counter, guild / team id)
+    Entry,   // u32 @0; the response sets bit 31 for "not found"
+    Guid,    // u64 @0 in the request, packed guid @0 in the response
+    Spell,   // cast count + spell id: @0 in the request, after two
+             // packed guids in SMSG_SPELL_START / SMSG_SPELL_GO
+    Count
+};
+
+const char* LatencyKeyName(LatencyKey key);
+
+struct LatencyPair
+{
+    uint16_t   request      = 0;
+    uint16_t   responses[2] = {};   // 0 = unused
+    LatencyKey key          = LatencyKey::Fifo;
+};
+
+struct LatencySummary
+{
+    uint64_t count = 0;
+    double   mean  = 0.0;
+    uint32_t p50 = 0, p90 = 0, p99 = 0, max = 0;   // microseconds
+};
+
+struct LatencyPairStats
+{
+    LatencyPair    pair;
+    uint64_t       matched   = 0;
+    uint64_t       unmatched = 0;   // responses with no open request
+    uint64_t       evicted   = 0;   // open requests pushed out by kMaxOpen
+    uint64_t       expired   = 0;   // open requests older than kOpenTimeoutMicros
+    uint32_t       open      = 0;
+    LatencySummary total;           // since Clear()
+    LatencySummary recent;          // the last `recentWindows` windows
+};
+
+struct LatencyWindow
+{
+    uint64_t startUs = 0;   // capture clock
+    uint32_t count   = 0;
+    uint32_t p50 = 0, p90 = 0, p99 = 0, max = 0;
+};
+
+class LatencyTracker
+{
+public:
+    static constexpr uint32_t kMaxOpen             = 512;  // per pair; login bursts queries by the hundred
+    static constexpr uint64_t kOpenTimeoutMicros   = 30'000'000;
+    static constexpr uint32_t kWindows             = 60;
+    static constexpr uint64_t kDefaultWindowMicros = 10'000'000;
+    static constexpr size_t   kMaxPairs            = 255;
+
+    // PING/PONG, every CMSG_X_QUERY.. with an SMSG_X_QUERY.._RESPONSE,
+    // NPC text, and CAST_SPELL → SPELL_START / SPELL_GO.
+    static std::vector<LatencyPair> DefaultPairs();
+
+    // Replaces the table and clears all state.  False (table kept)
+    // if there are more than kMaxPairs pairs, an opcode is requested
+    // by two pairs, a response belongs to two, or window is 0.
+    static bool Configure(const std::vector<LatencyPair>& pairs,
+                          uint64_t windowMicros = kDefaultWindowMicros);
+    static std::vector<LatencyPair> Pairs();
+    static uint64_t WindowMicros();
+
+    static bool Start();   // registers the capture sink (default table if none set)
+    static void Stop();
+    static bool IsRunning() { return s_running.load(std::memory_order_acquire); }
+
+    // Packets in capture order (the sink path takes them one by one).
+    static void Consume(const std::vector<CapturedPacket>& packets);
+    static void Clear();   // histograms, counters and open requests
+
+    // One entry per configured pair, table order.
+    static std::vector<LatencyPairStats> Stats(uint32_t recentWindows = 6);
+    // kWindows windows of pair `index`, oldest first, ending at the
+    // newest window any pair has seen; empty windows have count 0.
+    static std::vector<LatencyWindow> Series(size_t index);
+
+private:
+    struct Open
+    {
+        uint64_t timestamp_us = 0;
+        uint64_t key          = 0;
+        uint8_t  connection   = 0;
+        bool     keyed        = false;
+        bool     live         = false;
+    };
+
+    struct Window
+    {
+        uint64_t         index = UINT64_MAX;
+        LatencyHistogram hist;
+    };
+
+    struct PairState
+    {
+        LatencyPair         pair;
+        Open                open[kMaxOpen];
+        uint32_t            head = 0, used = 0;   // ring slots, dead ones included
+        uint32_t            live = 0;
+        uint64_t            matched = 0, unmatched = 0, evicted = 0, expired = 0;
+        LatencyHistogram    total;
+        std::vector<Window> windows;              // kWindows once the first match lands
+    };
+
+    static void Sink(const CapturedPacket& pkt);
+    static void ConsumeOne(const CapturedPacket& pkt);   // caller holds s_mutex
+    static void Retire(PairState& ps, uint64_t now);
+    static void Record(PairState& ps, uint64_t atUs, uint32_t latencyUs);
+    static bool ResetLocked(const std::vector<LatencyPair>& pairs, uint64_t windowMicros);
+
+    static inline std::mutex             s_mutex;
+    static inline std::vector<PairState> s_pairs;
+    static inline uint8_t                s_requestOf[65536]  = {};   // opcode → pair + 1
+    static inline uint8_t                s_responseOf[65536] = {};
+    static inline uint64_t               s_windowUs     = kDefaultWindowMicros;
+    static inline uint64_t               s_latestWindow = 0;
+    static inline bool                   s_configured   = false;
+    static inline std::atomic<bool>      s_running{ false };
+};
@@ -0,0 +1,259 @@
+#include "TrafficTimeline.h"
+#include "../packet/PacketCapture.h"
+#include "../packet/PacketColumns.h"
+#include "../log/Log.h"
+#include <algorithm>
+#include <cmath>
+
+// ============================================================
+//  LTTB
+// ============================================================
+
+void LttbDownsample(const TimelinePoint* in, size_t count, size_t threshold, std::vector<TimelinePoint>& out)
+{
+    out.clear();
+    if (threshold < 3) threshold = 3;
+    if (count <= threshold)
+    {
+        out.assign(in, in + count);
+        return;
+    }
+
+    // x relative to the first point keeps the doubles exact.
+    const uint64_t t0 = in[0].timeUs;
+    auto x = [&](size_t i) { return static_cast<double>(in[i].timeUs - t0); };
+
+    out.reserve(threshold);
+    out.push_back(in[0]);
+    const double every = static_cast<double>(count - 2) / static_cast<double>(threshold - 2);
+    size_t a = 0;
+    for (size_t i = 0; i < threshold - 2; ++i)
+    {
+        // Average of the next slice (the last point for the final one).
+        const size_t nextBegin = static_cast<size_t>((i + 1) * every) + 1;
+        const size_t nextEnd   = (std::min)(static_cast<size_t>((i + 2) * every) + 1, count);
+        double avgX = 0.0, avgY = 0.0;
+        if (nextBegin < nextEnd)
+        {
+            for (size_t j = nextBegin; j < nextEnd; ++j)
+            {
+                avgX += x(j);
+                avgY += in[j].value;
+            }
+            avgX /= static_cast<double>(nextEnd - nextBegin);
+            avgY /= static_cast<double>(nextEnd - nextBegin);
+        }
+        else
+        {
+            avgX = x(count - 1);
+            avgY = in[count - 1].value;
+        }
+
+        const size_t begin = static_cast<size_t>(i * every) + 1;
+        const size_t end   = (std::min)(static_cast<size_t>((i + 1) * every) + 1, count - 1);
+        const double ax = x(a), ay = in[a].value;
+        double best = -1.0;
+        size_t pick = begin;
+        for (size_t j = begin; j < end; ++j)
+        {
+            const double area = std::fabs((ax - avgX) * (in[j].value - ay) - (ax - x(j)) * (avgY - ay));
+            if (area > best)
+            {
+                best = area;
+                pick = j;
+            }
+        }
+        out.push_back(in[pick]);
+        a = pick;
+    }
+    out.push_back(in[count - 1]);
+}
+
+// ============================================================
+//  Aggregate
+// ============================================================
+
+bool TrafficTimeline::Start()
+{
+    if (IsRunning()) return true;
+    if (!PacketCapture::AddSink(&TrafficTimeline::Sink))
+    {
+        LOG_WARN(Analysis, "TrafficTimeline: no free capture sink slot");
+        return false;
+    }
+    s_running.store(true, std::memory_order_release);
+    return true;
+}
+
+void TrafficTimeline::Stop()
+{
+    if (!IsRunning()) return;
+    PacketCapture::RemoveSink(&TrafficTimeline::Sink);
+    s_running.store(false, std::memory_order_release);
+}
+
+void TrafficTimeline::Sink(const CapturedPacket& pkt)
+{
+    Add(pkt);
+}
+
+void TrafficTimeline::Reset(Series& s)
+{
+    for (Level& l : s.levels)
+    {
+        std::fill(l.ring.begin(), l.ring.end(), Bucket());
+        l.newest = 0;
+        l.any    = false;
+    }
+}
+
+void TrafficTimeline::AddLocked(Series& s, uint64_t timeUs, PacketDirection dir, uint32_t bytes)
+{
+    const size_t d = static_cast<size_t>(dir) & 1;
+    for (size_t lv = 0; lv < kLevels; ++lv)
+    {
+        Level&         l   = s.levels[lv];
+        const uint32_t cap = kCapacity[lv];
+        const uint64_t idx = timeUs / kResolutionUs[lv];
+        if (l.ring.empty()) l.ring.resize(cap);
+
+        if (!l.any)
+        {
+            l.newest = idx;
+            l.any    = true;
+        }
+        else if (idx > l.newest)
+        {
+            // Buckets the ring wraps onto start over.
+            const uint64_t fresh = (std::min)(idx - l.newest, static_cast<uint64_t>(cap));
+            for (uint64_t k = 1; k <= fresh; ++k)
+                l.ring[(l.newest + k) % cap] = Bucket();
+            l.newest = idx;
+        }
+        else if (l.newest - idx >= cap)
+            continue;   // older than this level keeps
+
+        Bucket& b = l.ring[idx % cap];
+        ++b.packets[d];
+        b.bytes[d] += bytes;
+    }
+}
+
+void TrafficTimeline::Add(const CapturedPacket& pkt)
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    if (!s_oldestUs || pkt.timestamp_us < s_oldestUs) s_oldestUs = pkt.timestamp_us;
+    if (pkt.timestamp_us > s_newestUs) s_newestUs = pkt.timestamp_us;
+    if (pkt.seq > s_lastSeq) s_lastSeq = pkt.seq;
+
+    AddLocked(s_series[0], pkt.timestamp_us, pkt.direction, pkt.size);
+    if (s_selected == pkt.opcode)
+        AddLocked(s_series[1], pkt.timestamp_us, pkt.direction, pkt.size);
+}
+
+void TrafficTimeline::Clear()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    Reset(s_series[0]);
+    Reset(s_series[1]);
+    s_oldestUs = s_newestUs = 0;
+}
+
+void TrafficTimeline::Select(int opcode)
+{
+    uint64_t upTo;
+    {
+        std::lock_guard<std::mutex> lk(s_mutex);
+        s_selected = opcode;
+        Reset(s_series[1]);
+        upTo = s_lastSeq;
+    }
+    if (opcode < 0) return;
+
+    // Packets after `upTo` reach the channel through Add() already.
+    PacketColumns history;
+    PacketCapture::SnapshotColumns(history);
+    std::lock_guard<std::mutex> lk(s_mutex);
+    if (s_selected != opcode) return;
+    const uint64_t* seq  = history.Seq();
+    const uint64_t* time = history.Timestamp();
+    const uint16_t* op   = history.Opcode();
+    const uint8_t*  dir  = history.Direction();
+    const uint32_t* size = history.Size();
+    for (size_t r = 0; r < history.Rows() && seq[r] <= upTo; ++r)
+        if (op[r] == opcode)
+            AddLocked(s_series[1], time[r], static_cast<PacketDirection>(dir[r]), size[r]);
+}
+
+int TrafficTimeline::Selected()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    return s_selected;
+}
+
+uint64_t TrafficTimeline::OldestUs()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    return s_oldestUs;
+}
+
+uint64_t TrafficTimeline::NewestUs()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    return s_newestUs;
+}
+
+// ============================================================
+//  Query
+// ============================================================
+
+uint64_t TrafficTimeline::Query(TimelineChannel channel, PacketDirection direction, TimelineMetric metric,
+                                uint64_t fromUs, uint64_t toUs, size_t points, std::vector<TimelinePoint>& out)
+{
+    out.clear();
+    if (toUs <= fromUs) return 0;
+
+    static thread_local std::vector<TimelinePoint> s_raw;
+    const size_t d = static_cast<size_t>(direction) & 1;
+    uint64_t     res;
+    {
+        std::lock_guard<std::mutex> lk(s_mutex);
+        const Series& s = s_series[static_cast<size_t>(channel) & 1];
+
+        // Finest level that still holds `fromUs` and spans the range in few enough buckets.
+        size_t lv = kLevels - 1;
+        for (size_t i = 0; i < kLevels; ++i)
+        {
+            const Level&   l     = s.levels[i];
+            const uint64_t first = fromUs / kResolutionUs[i];
+            const uint64_t last  = (toUs - 1) / kResolutionUs[i];
+            if (l.any && last - first < kMaxRawBuckets && first + kCapacity[i] > l.newest)
+            {
+                lv = i;
+                break;
+            }
+        }
+
+        const Level& l = s.levels[lv];
+        if (!l.any) return 0;
+        res = kResolutionUs[lv];
+        uint64_t       first = fromUs / res;
+        const uint64_t last  = (toUs - 1) / res;
+        if (last - first >= kMaxRawBuckets) first = last - (kMaxRawBuckets - 1);
+
+        const double perSecond = 1e6 / static_cast<double>(res);
+        s_raw.resize(static_cast<size_t>(last - first + 1));
+        for (uint64_t idx = first; idx <= last; ++idx)
+        {
+            TimelinePoint& p = s_raw[static_cast<size_t>(idx - first)];
+            p.timeUs = idx * res;
+            p.value  = 0.0f;
+            if (idx > l.newest || l.newest - idx >= kCapacity[lv]) continue;
+            const Bucket& b = l.ring[idx % kCapacity[lv]];
+            const uint32_t v = metric == TimelineMetric::Packets ? b.packets[d] : b.bytes[d];
+            p.value = static_cast<float>(v * perSecond);
+        }
+    }
+    LttbDownsample(s_raw.data(), s_raw.size(), points, out);
+    return res;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "../wow/WowTypes.h"
+
+// ============================================================
+//  TrafficTimeline — packets/s and bytes/s per direction over time
+//
+//  A pyramid of bucket rings, 1 ms → 10 ms → 100 ms → 1 s → 10 s
+//  → 1 min, each level a fixed ring (kCapacity buckets).  Every
+//  stored packet adds its count and wire bytes to one bucket per
+//  level, so the aggregate is always current and never rescans
+//  history.  Two channels are kept: all traffic, and one selected
+//  opcode (backfilled from the capture history on Select).
+//
+//  Query() reads the finest level that covers the range in at most
+//  kMaxRawBuckets buckets and reduces them to the requested number
+//  of points with LTTB (largest triangle three buckets), so
+//  plotting six hours costs the same as plotting one minute.
+//
+//  Runs as a PacketCapture sink on the pipeline worker, like
+//  CaptureMirror; Add() feeds packets directly (saved captures).
+// ============================================================
+
+enum class TimelineChannel : uint8_t { All, Selected };
+enum class TimelineMetric  : uint8_t { Packets, Bytes };
+
+struct TimelinePoint
+{
+    uint64_t timeUs = 0;     // bucket start, capture clock
+    float    value  = 0.0f;  // per second
+};
+
+// Largest-triangle-three-buckets: keeps the first and last point and,
+// from each of `threshold - 2` equal slices in between, the point
+// forming the largest triangle with its neighbours' picks.  Copies
+// `in` unchanged when it has no more than `threshold` points.
+void LttbDownsample(const TimelinePoint* in, size_t count, size_t threshold, std::vector<TimelinePoint>& out);
+
+class TrafficTimeline
+{
+public:
+    static constexpr size_t   kLevels = 6;
+    static constexpr uint64_t kResolutionUs[kLevels] = { 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 60'000'000 };
+    // 16 s, 2.7 min, 27 min, 6 h, 24 h, 7 days
+    static constexpr uint32_t kCapacity[kLevels]     = { 16384, 16384, 16384, 21600, 8640, 10080 };
+    static constexpr uint32_t kMaxRawBuckets         = 4096;
+
+    static bool Start();
+    static void Stop();
+    static bool IsRunning() { return s_running.load(std::memory_order_acquire); }
+
+    static void Add(const CapturedPacket& pkt);
+    static void Clear();
+
+    // Opcode of the Selected channel, -1 = none.  Refills it from the
+    // packets still in PacketCapture's history.
+    static void Select(int opcode);
+    static int  Selected();
+
+    static uint64_t OldestUs();   // first packet seen, 0 = none yet
+    static uint64_t NewestUs();   // last packet seen
+
+    // Rates over [fromUs, toUs), at most `points` of them.  Returns the
+    // bucket width used (0 = nothing to show).
+    static uint64_t Query(TimelineChannel channel, PacketDirection direction, TimelineMetric metric,
+                          uint64_t fromUs, uint64_t toUs, size_t points, std::vector<TimelinePoint>& out);
+
+private:
+    struct Bucket
+    {
+        uint32_t packets[2] = {};   // by PacketDirection
+        uint32_t bytes[2]   = {};
+    };
+
+    // No member initializers: s_series is a static (zeroed) and GCC
+    // rejects them in a nested type used by an inline static member.
+    struct Level
+    {
+        std::vector<Bucket> ring;
+        uint64_t            newest;   // bucket index (time / resolution)
+        bool                any;      // newest is valid
+    };
+
+    struct Series
+    {
+        Level levels[kLevels];
+    };
+
+    static void Sink(const CapturedPacket& pkt);
+    static void AddLocked(Series& s, uint64_t timeUs, PacketDirection dir, uint32_t bytes);
+    static void Reset(Series& s);
+
+    static inline std::mutex        s_mutex;
+    static inline Series            s_series[2];   // by TimelineChannel
+    static inline int               s_selected = -1;
+    static inline uint64_t          s_oldestUs = 0;
+    static inline uint64_t          s_newestUs = 0;
+    static inline uint64_t          s_lastSeq  = 0;
+    static inline std::atomic<bool> s_running{ false };
+};
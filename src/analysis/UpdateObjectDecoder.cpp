@@ -0,0 +1,276 @@
+#include "UpdateObjectDecoder.h"
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// ============================================================
+//  Flag values (build 12340)
+// ============================================================
+
+// Object update flags (movement block header)
+constexpr uint16_t UPDATEFLAG_TRANSPORT           = 0x0002;
+constexpr uint16_t UPDATEFLAG_HAS_TARGET          = 0x0004;
+constexpr uint16_t UPDATEFLAG_UNKNOWN             = 0x0008;
+constexpr uint16_t UPDATEFLAG_LOWGUID             = 0x0010;
+constexpr uint16_t UPDATEFLAG_LIVING              = 0x0020;
+constexpr uint16_t UPDATEFLAG_STATIONARY_POSITION = 0x0040;
+constexpr uint16_t UPDATEFLAG_VEHICLE             = 0x0080;
+constexpr uint16_t UPDATEFLAG_POSITION            = 0x0100;
+constexpr uint16_t UPDATEFLAG_ROTATION            = 0x0200;
+
+// MovementInfo flags
+constexpr uint32_t MOVEMENTFLAG_ONTRANSPORT       = 0x00000200;
+constexpr uint32_t MOVEMENTFLAG_FALLING           = 0x00001000;
+constexpr uint32_t MOVEMENTFLAG_SWIMMING          = 0x00200000;
+constexpr uint32_t MOVEMENTFLAG_FLYING            = 0x02000000;
+constexpr uint32_t MOVEMENTFLAG_SPLINE_ELEVATION  = 0x04000000;
+constexpr uint32_t MOVEMENTFLAG_SPLINE_ENABLED    = 0x08000000;
+
+constexpr uint16_t MOVEMENTFLAG2_ALWAYS_ALLOW_PITCHING = 0x0020;
+constexpr uint16_t MOVEMENTFLAG2_INTERPOLATED_MOVEMENT = 0x0400;
+
+// MoveSpline flags
+constexpr uint32_t SPLINEFLAG_FINAL_POINT  = 0x00008000;
+constexpr uint32_t SPLINEFLAG_FINAL_TARGET = 0x00010000;
+constexpr uint32_t SPLINEFLAG_FINAL_ANGLE  = 0x00020000;
+
+constexpr uint32_t kMaxSplinePoints = 1000;   // sanity bound on a corrupt count
+
+// ============================================================
+//  Bounds-checked little-endian reader
+// ============================================================
+
+namespace
+{
+    struct Reader
+    {
+        const uint8_t* p;
+        const uint8_t* end;
+        bool           ok = true;
+
+        bool Need(size_t n)
+        {
+            if (ok && static_cast<size_t>(end - p) >= n) return true;
+            ok = false;
+            return false;
+        }
+
+        void Skip(size_t n) { if (Need(n)) p += n; }
+
+        uint8_t U8()
+        {
+            if (!Need(1)) return 0;
+            return *p++;
+        }
+
+        uint16_t U16()
+        {
+            if (!Need(2)) return 0;
+            uint16_t v; memcpy(&v, p, 2); p += 2;
+            return v;
+        }
+
+        uint32_t U32()
+        {
+            if (!Need(4)) return 0;
+            uint32_t v; memcpy(&v, p, 4); p += 4;
+            return v;
+        }
+
+        float F32()
+        {
+            if (!Need(4)) return 0.0f;
+            float v; memcpy(&v, p, 4); p += 4;
+            return v;
+        }
+
+        uint64_t PackedGuid()
+        {
+            const uint8_t mask = U8();
+            uint64_t guid = 0;
+            for (int i = 0; i < 8; ++i)
+                if (mask & (1u << i))
+                    guid |= static_cast<uint64_t>(U8()) << (8 * i);
+            return guid;
+        }
+    };
+
+    inline uint32_t LowestBit(uint32_t m)
+    {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward(&idx, m);
+        return static_cast<uint32_t>(idx);
+#else
+        return static_cast<uint32_t>(__builtin_ctz(m));
+#endif
+    }
+}
+
+const char* UpdateObjectDecoder::UpdateTypeName(uint8_t type)
+{
+    static const char* kNames[] = {
+        "VALUES", "MOVEMENT", "CREATE_OBJECT", "CREATE_OBJECT2", "OUT_OF_RANGE", "NEAR_OBJECTS"
+    };
+    return type < 6 ? kNames[type] : "?";
+}
+
+// ============================================================
+//  Block parsers
+// ============================================================
+
+static void ReadMovementBlock(Reader& r, uint64_t guid, WorldState& world)
+{
+    const uint16_t flags = r.U16();
+
+    if (flags & UPDATEFLAG_LIVING)
+    {
+        const uint32_t moveFlags  = r.U32();
+        const uint16_t moveFlags2 = r.U16();
+        r.Skip(4);                                      // time
+        const float x = r.F32(), y = r.F32(), z = r.F32(), o = r.F32();
+        if (r.ok) world.SetPosition(guid, x, y, z, o);
+
+        if (moveFlags & MOVEMENTFLAG_ONTRANSPORT)
+        {
+            r.PackedGuid();
+            r.Skip(4 * 4 + 4 + 1);                      // x y z o, time, seat
+            if (moveFlags2 & MOVEMENTFLAG2_INTERPOLATED_MOVEMENT)
+                r.Skip(4);                              // time2
+        }
+        if ((moveFlags & (MOVEMENTFLAG_SWIMMING | MOVEMENTFLAG_FLYING)) ||
+            (moveFlags2 & MOVEMENTFLAG2_ALWAYS_ALLOW_PITCHING))
+            r.Skip(4);                                  // pitch
+        r.Skip(4);                                      // fall time
+        if (moveFlags & MOVEMENTFLAG_FALLING)
+            r.Skip(4 * 4);                              // z speed, sin, cos, xy speed
+        if (moveFlags & MOVEMENTFLAG_SPLINE_ELEVATION)
+            r.Skip(4);
+
+        r.Skip(9 * 4);                                  // walk..pitch rate speeds
+
+        if (moveFlags & MOVEMENTFLAG_SPLINE_ENABLED)
+        {
+            const uint32_t splineFlags = r.U32();
+            if      (splineFlags & SPLINEFLAG_FINAL_ANGLE)  r.Skip(4);
+            else if (splineFlags & SPLINEFLAG_FINAL_TARGET) r.Skip(8);
+            else if (splineFlags & SPLINEFLAG_FINAL_POINT)  r.Skip(12);
+            r.Skip(4 * 3 + 4 * 3 + 4);                  // passed, duration, id, 2×mod, vert accel, effect start
+            const uint32_t points = r.U32();
+            if (points > kMaxSplinePoints) { r.ok = false; return; }
+            r.Skip(points * 12 + 1 + 12);               // points, mode, final destination
+        }
+    }
+    else if (flags & UPDATEFLAG_POSITION)
+    {
+        r.PackedGuid();                                 // transport
+        const float x = r.F32(), y = r.F32(), z = r.F32();
+        r.Skip(12);                                     // transport offset
+        const float o = r.F32();
+        r.Skip(4);                                      // corpse orientation
+        if (r.ok) world.SetPosition(guid, x, y, z, o);
+    }
+    else if (flags & UPDATEFLAG_STATIONARY_POSITION)
+    {
+        const float x = r.F32(), y = r.F32(), z = r.F32(), o = r.F32();
+        if (r.ok) world.SetPosition(guid, x, y, z, o);
+    }
+
+    if (flags & UPDATEFLAG_UNKNOWN)    r.Skip(4);
+    if (flags & UPDATEFLAG_LOWGUID)    r.Skip(4);
+    if (flags & UPDATEFLAG_HAS_TARGET) r.PackedGuid();
+    if (flags & UPDATEFLAG_TRANSPORT)  r.Skip(4);
+    if (flags & UPDATEFLAG_VEHICLE)    r.Skip(8);
+    if (flags & UPDATEFLAG_ROTATION)   r.Skip(8);
+}
+
+static void ReadValuesBlock(Reader& r, uint64_t guid, WorldState& world, UpdateDecodeStats* stats)
+{
+    const uint8_t words = r.U8();
+    if (!r.Need(static_cast<size_t>(words) * 4)) return;
+
+    // Masks are read in place; values follow them contiguously.
+    const uint8_t* masks = r.p;
+    r.p += static_cast<size_t>(words) * 4;
+
+    for (uint32_t w = 0; w < words && r.ok; ++w)
+    {
+        uint32_t m;
+        memcpy(&m, masks + w * 4, 4);
+        while (m)
+        {
+            const uint32_t bit = LowestBit(m);
+            m &= m - 1;
+            const uint32_t value = r.U32();
+            if (!r.ok) return;
+            world.SetField(guid, static_cast<uint16_t>(w * 32 + bit), value);
+            if (stats) ++stats->fields;
+        }
+    }
+}
+
+// ============================================================
+//  Decode
+// ============================================================
+
+bool UpdateObjectDecoder::Decode(uint64_t seq, const uint8_t* data, uint32_t size, WorldState& world, UpdateDecodeStats* stats)
+{
+    if (stats) ++stats->packets;
+
+    Reader r{ data, data + size };
+    world.BeginPacket(seq);
+
+    const uint32_t blockCount = r.U32();
+    for (uint32_t b = 0; b < blockCount && r.ok; ++b)
+    {
+        const uint8_t type = r.U8();
+        if (!r.ok || type > UPDATETYPE_NEAR_OBJECTS) { r.ok = false; break; }
+        if (stats) ++stats->blocks[type];
+
+        switch (type)
+        {
+        case UPDATETYPE_VALUES:
+        {
+            const uint64_t guid = r.PackedGuid();
+            ReadValuesBlock(r, guid, world, stats);
+            break;
+        }
+        case UPDATETYPE_MOVEMENT:
+        {
+            const uint64_t guid = r.PackedGuid();
+            ReadMovementBlock(r, guid, world);
+            break;
+        }
+        case UPDATETYPE_CREATE_OBJECT:
+        case UPDATETYPE_CREATE_OBJECT2:
+        {
+            const uint64_t guid   = r.PackedGuid();
+            const uint8_t  typeId = r.U8();
+            if (!r.ok) break;
+            world.Create(guid, typeId);
+            ReadMovementBlock(r, guid, world);
+            ReadValuesBlock(r, guid, world, stats);
+            break;
+        }
+        case UPDATETYPE_OUT_OF_RANGE_OBJECTS:
+        case UPDATETYPE_NEAR_OBJECTS:
+        {
+            const uint32_t count = r.U32();
+            for (uint32_t i = 0; i < count && r.ok; ++i)
+            {
+                const uint64_t guid = r.PackedGuid();
+                if (r.ok && type == UPDATETYPE_OUT_OF_RANGE_OBJECTS)
+                    world.Destroy(guid);
+            }
+            break;
+        }
+        }
+    }
+
+    world.EndPacket();
+
+    if (!r.ok && stats) ++stats->failed;
+    return r.ok;
+}
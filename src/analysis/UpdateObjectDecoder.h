@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include "WorldState.h"
+
+// ============================================================
+//  UpdateObjectDecoder — SMSG_UPDATE_OBJECT block parser (3.3.5a)
+//
+//  Body (also the inflated form of SMSG_COMPRESSED_UPDATE_OBJECT):
+//    [4] blockCount
+//    blockCount × { [1] updateType, ... }
+//
+//    0 VALUES          packedGuid, valuesBlock
+//    1 MOVEMENT        packedGuid, movementBlock
+//    2 CREATE_OBJECT   packedGuid, [1] typeId, movementBlock, valuesBlock
+//    3 CREATE_OBJECT2  (same as 2; object spawned, not just in range)
+//    4 OUT_OF_RANGE    [4] count, count × packedGuid
+//    5 NEAR_OBJECTS    [4] count, count × packedGuid
+//
+//    valuesBlock = [1] maskWords, maskWords × [4] mask,
+//                  one [4] value per set mask bit (ascending index)
+//
+//  Decodes straight into a WorldState; a truncated or malformed
+//  body stops at the bad block and reports failure, keeping the
+//  blocks applied before it.
+// ============================================================
+
+struct UpdateDecodeStats
+{
+    uint64_t packets   = 0;
+    uint64_t failed    = 0;
+    uint64_t blocks[6] = {};   // by update type
+    uint64_t fields    = 0;
+};
+
+namespace UpdateObjectDecoder
+{
+    enum UpdateType : uint8_t
+    {
+        UPDATETYPE_VALUES               = 0,
+        UPDATETYPE_MOVEMENT             = 1,
+        UPDATETYPE_CREATE_OBJECT        = 2,
+        UPDATETYPE_CREATE_OBJECT2       = 3,
+        UPDATETYPE_OUT_OF_RANGE_OBJECTS = 4,
+        UPDATETYPE_NEAR_OBJECTS         = 5,
+    };
+
+    const char* UpdateTypeName(uint8_t type);
+
+    // Decode one update body as packet `seq`.  Returns false on malformed input.
+    bool Decode(uint64_t seq, const uint8_t* data, uint32_t size, WorldState& world, UpdateDecodeStats* stats = nullptr);
+}
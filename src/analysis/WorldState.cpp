@@ -0,0 +1,383 @@
+#include "WorldState.h"
+#include "../packet/PacketHash.h"
+#include <algorithm>
+#include <cstring>
+
+// ============================================================
+//  Type metadata (build 12340 *_END values)
+// ============================================================
+
+const char* ObjectTypeName(uint8_t typeId)
+{
+    static const char* kNames[] = {
+        "Object", "Item", "Container", "Unit", "Player", "GameObject", "DynamicObject", "Corpse"
+    };
+    return typeId < static_cast<uint8_t>(ObjectTypeId::Count) ? kNames[typeId] : "Unknown";
+}
+
+uint16_t ObjectFieldCount(uint8_t typeId)
+{
+    static const uint16_t kCounts[] = {
+        0x0006,   // OBJECT_END
+        0x0040,   // ITEM_END
+        0x008A,   // CONTAINER_END
+        0x0094,   // UNIT_END
+        0x052E,   // PLAYER_END
+        0x0012,   // GAMEOBJECT_END
+        0x000C,   // DYNAMICOBJECT_END
+        0x0024,   // CORPSE_END
+    };
+    return typeId < static_cast<uint8_t>(ObjectTypeId::Count) ? kCounts[typeId] : 0;
+}
+
+static uint32_t HashGuid(uint64_t guid) { return static_cast<uint32_t>(PacketHash::Avalanche(guid)); }
+
+static bool ValidType(uint8_t typeId) { return typeId < static_cast<uint8_t>(ObjectTypeId::Count); }
+
+// ============================================================
+//  ObjectTable — GUID map
+// ============================================================
+
+void ObjectTable::Clear()
+{
+    m_keys.clear();
+    m_vals.clear();
+    m_used = 0;
+    m_objects.clear();
+    m_freeSlots.clear();
+    m_fields.clear();
+    m_freeFields.clear();
+    m_live = 0;
+}
+
+void ObjectTable::Rehash(size_t newCapacity)
+{
+    std::vector<uint64_t> oldKeys;
+    std::vector<uint32_t> oldVals;
+    oldKeys.swap(m_keys);
+    oldVals.swap(m_vals);
+
+    m_keys.assign(newCapacity, 0);
+    m_vals.assign(newCapacity, 0);
+    const size_t mask = newCapacity - 1;
+
+    for (size_t i = 0; i < oldKeys.size(); ++i)
+    {
+        if (!oldKeys[i]) continue;
+        size_t p = HashGuid(oldKeys[i]) & mask;
+        while (m_keys[p]) p = (p + 1) & mask;
+        m_keys[p] = oldKeys[i];
+        m_vals[p] = oldVals[i];
+    }
+}
+
+uint32_t ObjectTable::Find(uint64_t guid) const
+{
+    if (m_keys.empty() || !guid) return UINT32_MAX;
+    const size_t mask = m_keys.size() - 1;
+    for (size_t p = HashGuid(guid) & mask; m_keys[p]; p = (p + 1) & mask)
+        if (m_keys[p] == guid) return m_vals[p];
+    return UINT32_MAX;
+}
+
+uint32_t ObjectTable::Upsert(uint64_t guid, uint8_t typeId)
+{
+    if (!guid) return UINT32_MAX;
+    if ((m_used + 1) * 2 > m_keys.size())
+        Rehash((std::max)(static_cast<size_t>(64), m_keys.size() * 2));
+
+    const size_t mask = m_keys.size() - 1;
+    size_t p = HashGuid(guid) & mask;
+    for (; m_keys[p]; p = (p + 1) & mask)
+    {
+        if (m_keys[p] != guid) continue;
+
+        // Known object; learn its type if a VALUES update came first.
+        WorldObject& obj = m_objects[m_vals[p]];
+        if (obj.typeId == kUnknownType && ValidType(typeId))
+        {
+            obj.typeId = typeId;
+            if (obj.fieldCount < ObjectFieldCount(typeId))
+                GrowFields(obj, ObjectFieldCount(typeId));
+        }
+        return m_vals[p];
+    }
+
+    uint32_t slot;
+    if (!m_freeSlots.empty())
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_objects.size());
+        m_objects.emplace_back();
+    }
+
+    const uint16_t count = ValidType(typeId) ? ObjectFieldCount(typeId) : 0;
+    WorldObject& obj = m_objects[slot];
+    obj = {};
+    obj.guid        = guid;
+    obj.typeId      = ValidType(typeId) ? typeId : kUnknownType;
+    obj.fieldOffset = AllocFields(count);
+    obj.fieldCount  = count;
+
+    m_keys[p] = guid;
+    m_vals[p] = slot;
+    ++m_used;
+    ++m_live;
+    return slot;
+}
+
+bool ObjectTable::Remove(uint64_t guid)
+{
+    if (m_keys.empty() || !guid) return false;
+    const size_t mask = m_keys.size() - 1;
+
+    size_t i = HashGuid(guid) & mask;
+    while (m_keys[i] && m_keys[i] != guid) i = (i + 1) & mask;
+    if (!m_keys[i]) return false;
+
+    const uint32_t slot = m_vals[i];
+
+    // Backward-shift deletion: pull later entries of the probe run into
+    // the hole unless their home bucket lies cyclically in (i, j].
+    for (size_t j = (i + 1) & mask; m_keys[j]; j = (j + 1) & mask)
+    {
+        const size_t home = HashGuid(m_keys[j]) & mask;
+        const bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (stays) continue;
+        m_keys[i] = m_keys[j];
+        m_vals[i] = m_vals[j];
+        i = j;
+    }
+    m_keys[i] = 0;
+    --m_used;
+
+    WorldObject& obj = m_objects[slot];
+    FreeFields(obj.fieldOffset, obj.fieldCount);
+    obj.guid = 0;
+    m_freeSlots.push_back(slot);
+    --m_live;
+    return true;
+}
+
+// ============================================================
+//  ObjectTable — field pool
+// ============================================================
+
+uint32_t ObjectTable::AllocFields(uint16_t count)
+{
+    if (count == 0) return 0;
+
+    auto it = m_freeFields.find(count);
+    if (it != m_freeFields.end() && !it->second.empty())
+    {
+        const uint32_t off = it->second.back();
+        it->second.pop_back();
+        std::fill_n(m_fields.begin() + off, count, 0u);
+        return off;
+    }
+
+    const uint32_t off = static_cast<uint32_t>(m_fields.size());
+    m_fields.resize(m_fields.size() + count, 0u);
+    return off;
+}
+
+void ObjectTable::FreeFields(uint32_t offset, uint16_t count)
+{
+    if (count) m_freeFields[count].push_back(offset);
+}
+
+void ObjectTable::GrowFields(WorldObject& obj, uint16_t needed)
+{
+    // Unknown-type objects grow in 16-field steps to limit relocations.
+    uint32_t want = (std::max)(static_cast<uint32_t>(needed), static_cast<uint32_t>(ObjectFieldCount(obj.typeId)));
+    want = (want + 15) & ~15u;
+    const uint16_t newCount = static_cast<uint16_t>((std::min)(want, 0xFFFFu));
+
+    const uint32_t newOff = AllocFields(newCount);
+    if (obj.fieldCount)
+        std::copy_n(m_fields.begin() + obj.fieldOffset, obj.fieldCount, m_fields.begin() + newOff);
+    FreeFields(obj.fieldOffset, obj.fieldCount);
+
+    obj.fieldOffset = newOff;
+    obj.fieldCount  = newCount;
+}
+
+void ObjectTable::SetField(uint32_t slot, uint16_t index, uint32_t value)
+{
+    WorldObject& obj = m_objects[slot];
+    if (index >= obj.fieldCount)
+        GrowFields(obj, static_cast<uint16_t>(index + 1));
+    m_fields[obj.fieldOffset + index] = value;
+}
+
+void ObjectTable::SetPosition(uint32_t slot, float x, float y, float z, float o)
+{
+    WorldObject& obj = m_objects[slot];
+    obj.x = x; obj.y = y; obj.z = z; obj.o = o;
+    obj.hasPosition = 1;
+}
+
+uint32_t ObjectTable::GetField(uint32_t slot, uint16_t index) const
+{
+    const WorldObject& obj = m_objects[slot];
+    return index < obj.fieldCount ? m_fields[obj.fieldOffset + index] : 0;
+}
+
+// ============================================================
+//  WorldState — live updates + delta log
+// ============================================================
+
+static uint32_t FloatBits(float f)   { uint32_t u; memcpy(&u, &f, 4); return u; }
+static float    BitsFloat(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+
+void WorldState::Record(uint64_t guid, DeltaKind kind, uint16_t index, uint32_t value)
+{
+    m_deltas.push_back({ m_seq, guid, value, index, kind });
+    ++m_sinceCheckpoint;
+}
+
+void WorldState::Create(uint64_t guid, uint8_t typeId)
+{
+    Delta d = { m_seq, guid, typeId, 0, DeltaKind::Create };
+    Apply(m_live, d);
+    Record(guid, DeltaKind::Create, 0, typeId);
+}
+
+void WorldState::SetField(uint64_t guid, uint16_t index, uint32_t value)
+{
+    const uint32_t slot = m_live.Upsert(guid, ObjectTable::kUnknownType);
+    if (slot == UINT32_MAX) return;
+    m_live.SetField(slot, index, value);
+    m_live.MutableObjects()[slot].lastSeq = m_seq;
+    Record(guid, DeltaKind::Field, index, value);
+}
+
+void WorldState::SetPosition(uint64_t guid, float x, float y, float z, float o)
+{
+    const uint32_t slot = m_live.Upsert(guid, ObjectTable::kUnknownType);
+    if (slot == UINT32_MAX) return;
+    m_live.SetPosition(slot, x, y, z, o);
+    m_live.MutableObjects()[slot].lastSeq = m_seq;
+    Record(guid, DeltaKind::PosX, 0, FloatBits(x));
+    Record(guid, DeltaKind::PosY, 0, FloatBits(y));
+    Record(guid, DeltaKind::PosZ, 0, FloatBits(z));
+    Record(guid, DeltaKind::PosO, 0, FloatBits(o));
+}
+
+void WorldState::Destroy(uint64_t guid)
+{
+    if (m_live.Remove(guid))
+        Record(guid, DeltaKind::Destroy, 0, 0);
+}
+
+void WorldState::EndPacket()
+{
+    if (m_sinceCheckpoint >= kCheckpointDeltas)
+        TakeCheckpoint();
+}
+
+void WorldState::Apply(ObjectTable& t, const Delta& d)
+{
+    switch (d.kind)
+    {
+    case DeltaKind::Create:
+    {
+        // A create for a known GUID starts it over (re-entered visibility).
+        t.Remove(d.guid);
+        const uint32_t slot = t.Upsert(d.guid, static_cast<uint8_t>(d.value));
+        if (slot != UINT32_MAX) t.MutableObjects()[slot].lastSeq = d.seq;
+        break;
+    }
+    case DeltaKind::Field:
+    {
+        const uint32_t slot = t.Upsert(d.guid, ObjectTable::kUnknownType);
+        if (slot == UINT32_MAX) break;
+        t.SetField(slot, d.index, d.value);
+        t.MutableObjects()[slot].lastSeq = d.seq;
+        break;
+    }
+    case DeltaKind::PosX: case DeltaKind::PosY: case DeltaKind::PosZ: case DeltaKind::PosO:
+    {
+        const uint32_t slot = t.Upsert(d.guid, ObjectTable::kUnknownType);
+        if (slot == UINT32_MAX) break;
+        WorldObject& obj = t.MutableObjects()[slot];
+        const float v = BitsFloat(d.value);
+        if      (d.kind == DeltaKind::PosX) obj.x = v;
+        else if (d.kind == DeltaKind::PosY) obj.y = v;
+        else if (d.kind == DeltaKind::PosZ) obj.z = v;
+        else                                obj.o = v;
+        obj.hasPosition = 1;
+        obj.lastSeq     = d.seq;
+        break;
+    }
+    case DeltaKind::Destroy:
+        t.Remove(d.guid);
+        break;
+    }
+}
+
+// ============================================================
+//  Checkpoints
+// ============================================================
+
+void WorldState::TakeCheckpoint()
+{
+    m_checkpoints.push_back({ m_seq, m_deltaBase + m_deltas.size(), m_live });
+    m_sinceCheckpoint = 0;
+
+    if (m_checkpoints.size() <= kMaxCheckpoints) return;
+
+    // Drop the oldest checkpoint and every delta only it could reach.
+    m_checkpoints.erase(m_checkpoints.begin());
+    const size_t keepFrom = m_checkpoints.front().deltaIndex;
+    m_deltas.erase(m_deltas.begin(), m_deltas.begin() + (keepFrom - m_deltaBase));
+    m_deltaBase = keepFrom;
+}
+
+uint64_t WorldState::OldestSeq() const
+{
+    if (m_deltaBase == 0) return 0;   // full history retained
+    return m_checkpoints.empty() ? m_seq : m_checkpoints.front().seq;
+}
+
+bool WorldState::Reconstruct(uint64_t seq, ObjectTable& out) const
+{
+    size_t from;
+    const Checkpoint* base = nullptr;
+    for (const Checkpoint& cp : m_checkpoints)
+    {
+        if (cp.seq > seq) break;
+        base = &cp;
+    }
+
+    if (base)
+    {
+        out  = base->table;
+        from = base->deltaIndex;
+    }
+    else if (m_deltaBase == 0)
+    {
+        out.Clear();
+        from = 0;
+    }
+    else
+        return false;
+
+    for (size_t i = from - m_deltaBase; i < m_deltas.size() && m_deltas[i].seq <= seq; ++i)
+        Apply(out, m_deltas[i]);
+    return true;
+}
+
+void WorldState::Clear()
+{
+    m_live.Clear();
+    m_deltas.clear();
+    m_deltaBase = 0;
+    m_checkpoints.clear();
+    m_seq = 0;
+    m_sinceCheckpoint = 0;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+// ============================================================
+//  WorldState — incrementally updated table of world objects
+//
+//  Fed by UpdateObjectDecoder.  Storage is laid out for scans:
+//    - GUID → slot lookup is an open-addressing (linear probe)
+//      hash map with backward-shift deletion, no tombstones.
+//    - Object records live in one dense array.
+//    - Update fields of every object live in one shared uint32
+//      pool; each object owns a contiguous [offset, offset+count).
+//
+//  Every mutation is also appended to a delta log.  Every
+//  kCheckpointDeltas deltas the whole table is checkpointed, so
+//  the state as of any packet seq is rebuilt from the nearest
+//  earlier checkpoint plus a bounded delta replay.
+// ============================================================
+
+// 3.3.5a object type ids (SMSG_UPDATE_OBJECT create blocks)
+enum class ObjectTypeId : uint8_t
+{
+    Object        = 0,
+    Item          = 1,
+    Container     = 2,
+    Unit          = 3,
+    Player        = 4,
+    GameObject    = 5,
+    DynamicObject = 6,
+    Corpse        = 7,
+    Count
+};
+
+const char* ObjectTypeName(uint8_t typeId);
+
+// Total update-field count per type (OBJECT_END .. PLAYER_END etc., build 12340)
+uint16_t ObjectFieldCount(uint8_t typeId);
+
+// A few well-known field indices for display
+namespace UpdateFields
+{
+    constexpr uint16_t OBJECT_FIELD_ENTRY   = 0x0003;
+    constexpr uint16_t OBJECT_FIELD_SCALE_X = 0x0004;
+    constexpr uint16_t UNIT_FIELD_HEALTH    = 0x0018;
+    constexpr uint16_t UNIT_FIELD_MAXHEALTH = 0x0020;
+    constexpr uint16_t UNIT_FIELD_LEVEL     = 0x0036;
+}
+
+struct WorldObject
+{
+    uint64_t guid;
+    uint32_t fieldOffset;    // into ObjectTable::Fields()
+    uint16_t fieldCount;
+    uint8_t  typeId;         // ObjectTypeId, 0xFF = only seen in VALUES updates
+    uint8_t  hasPosition;
+    float    x, y, z, o;
+    uint64_t lastSeq;        // packet that last touched this object
+};
+
+// ------------------------------------------------------------
+//  ObjectTable — the live (or reconstructed) set of objects
+// ------------------------------------------------------------
+class ObjectTable
+{
+public:
+    static constexpr uint8_t kUnknownType = 0xFF;
+
+    void Clear();
+
+    // Returns the slot for guid, creating it if needed.
+    uint32_t Upsert(uint64_t guid, uint8_t typeId);
+    // Slot index or UINT32_MAX.
+    uint32_t Find(uint64_t guid) const;
+    bool     Remove(uint64_t guid);
+
+    void SetField(uint32_t slot, uint16_t index, uint32_t value);
+    void SetPosition(uint32_t slot, float x, float y, float z, float o);
+
+    uint32_t GetField(uint32_t slot, uint16_t index) const;
+
+    // Dense views.  Slots of removed objects have guid == 0.
+    const std::vector<WorldObject>& Objects() const { return m_objects; }
+    const std::vector<uint32_t>&    Fields()  const { return m_fields; }
+    size_t LiveCount() const { return m_live; }
+
+    std::vector<WorldObject>& MutableObjects() { return m_objects; }
+
+private:
+    void     Rehash(size_t newCapacity);
+    uint32_t AllocFields(uint16_t count);
+    void     FreeFields(uint32_t offset, uint16_t count);
+    void     GrowFields(WorldObject& obj, uint16_t needed);
+
+    // Open addressing: parallel key/value arrays, capacity is a power of two.
+    std::vector<uint64_t> m_keys;    // 0 = empty (GUID 0 is never a real object)
+    std::vector<uint32_t> m_vals;    // slot index
+    size_t                m_used = 0;
+
+    std::vector<WorldObject> m_objects;
+    std::vector<uint32_t>    m_freeSlots;
+    std::vector<uint32_t>    m_fields;
+    std::unordered_map<uint16_t, std::vector<uint32_t>> m_freeFields;  // count → offsets
+    size_t                   m_live = 0;
+};
+
+// ------------------------------------------------------------
+//  WorldState — live table + delta log + checkpoints
+// ------------------------------------------------------------
+class WorldState
+{
+public:
+    static constexpr size_t kCheckpointDeltas = 16384;  // deltas between checkpoints
+    static constexpr size_t kMaxCheckpoints   = 16;     // oldest dropped beyond this
+
+    // Decoder callbacks ——————————————————————————————————————————
+    void BeginPacket(uint64_t seq) { m_seq = seq; }
+    void Create(uint64_t guid, uint8_t typeId);
+    void SetField(uint64_t guid, uint16_t index, uint32_t value);
+    void SetPosition(uint64_t guid, float x, float y, float z, float o);
+    void Destroy(uint64_t guid);
+    void EndPacket();
+
+    const ObjectTable& Live() const { return m_live; }
+
+    // Rebuild the table as it was right after packet `seq`.
+    // Fails if seq predates the oldest retained checkpoint.
+    bool Reconstruct(uint64_t seq, ObjectTable& out) const;
+
+    uint64_t OldestSeq() const;   // earliest seq Reconstruct accepts
+    uint64_t LastSeq() const { return m_seq; }
+    size_t   DeltaCount() const { return m_deltas.size(); }
+    size_t   CheckpointCount() const { return m_checkpoints.size(); }
+
+    void Clear();
+
+private:
+    enum class DeltaKind : uint8_t { Create, Field, PosX, PosY, PosZ, PosO, Destroy };
+
+    struct Delta
+    {
+        uint64_t  seq;
+        uint64_t  guid;
+        uint32_t  value;     // field value, float bits, or typeId
+        uint16_t  index;
+        DeltaKind kind;
+    };
+
+    struct Checkpoint
+    {
+        uint64_t    seq;          // state includes every packet <= seq
+        size_t      deltaIndex;   // first delta after the checkpoint (absolute)
+        ObjectTable table;
+    };
+
+    static void Apply(ObjectTable& t, const Delta& d);
+    void Record(uint64_t guid, DeltaKind kind, uint16_t index, uint32_t value);
+    void TakeCheckpoint();
+
+    ObjectTable             m_live;
+    std::vector<Delta>      m_deltas;
+    size_t                  m_deltaBase = 0;   // absolute index of m_deltas[0]
+    std::vector<Checkpoint> m_checkpoints;
+    uint64_t                m_seq = 0;
+    size_t                  m_sinceCheckpoint = 0;
+};
@@ -0,0 +1,128 @@
+#include "WorldTracker.h"
+#include "../packet/PacketCapture.h"
+#include "../packet/PacketInflater.h"
+#include "../log/Log.h"
+#include "Opcodes.h"
+
+static bool IsUpdate(const CapturedPacket& pkt)
+{
+    return pkt.direction == PacketDirection::SMSG &&
+           (pkt.opcode == SMSG_UPDATE_OBJECT || pkt.opcode == SMSG_COMPRESSED_UPDATE_OBJECT);
+}
+
+bool WorldTracker::Start()
+{
+    if (IsRunning()) return true;
+    if (!PacketCapture::AddSink(&WorldTracker::Sink))
+    {
+        LOG_WARN(Analysis, "WorldTracker: no free capture sink slot");
+        return false;
+    }
+    s_running.store(true, std::memory_order_release);
+    return true;
+}
+
+void WorldTracker::Stop()
+{
+    if (!IsRunning()) return;
+    PacketCapture::RemoveSink(&WorldTracker::Sink);
+    s_running.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lk(s_pendingMutex);
+    s_pending.clear();
+}
+
+void WorldTracker::Sink(const CapturedPacket& pkt)
+{
+    if (!IsUpdate(pkt)) return;
+    std::lock_guard<std::mutex> lk(s_pendingMutex);
+    s_pending.push_back(pkt.seq);
+}
+
+void WorldTracker::Poll()
+{
+    const uint64_t now = PacketCapture::NowMicros();
+    std::lock_guard<std::mutex> lk(s_mutex);
+
+    CapturedPacket pkt;
+    for (;;)
+    {
+        uint64_t seq;
+        {
+            std::lock_guard<std::mutex> plk(s_pendingMutex);
+            if (s_pending.empty()) return;
+            seq = s_pending.front();
+        }
+        if (seq > s_cursor.load(std::memory_order_relaxed))   // else already fed through Consume()
+        {
+            if (!PacketCapture::CopyPacket(seq, pkt))
+                ++s_stats.evicted;
+            else if (!ConsumeOne(pkt, now))
+                return;   // still inflating: stays at the front
+            else
+                s_cursor = seq;
+        }
+
+        std::lock_guard<std::mutex> plk(s_pendingMutex);
+        s_pending.pop_front();
+    }
+}
+
+void WorldTracker::Consume(const std::vector<CapturedPacket>& packets)
+{
+    const uint64_t now = PacketCapture::NowMicros();
+    std::lock_guard<std::mutex> lk(s_mutex);
+
+    for (const auto& pkt : packets)
+    {
+        if (pkt.seq <= s_cursor.load(std::memory_order_relaxed)) continue;
+        if (!ConsumeOne(pkt, now)) break;
+        s_cursor = pkt.seq;
+    }
+}
+
+bool WorldTracker::ConsumeOne(const CapturedPacket& pkt, uint64_t now)
+{
+    if (!IsUpdate(pkt)) return true;
+    if (pkt.Truncated())   // metadata-only / snaplen capture mode
+    {
+        ++s_stats.truncated;
+        return true;
+    }
+
+    switch (pkt.opcode)
+    {
+    case SMSG_UPDATE_OBJECT:
+        UpdateObjectDecoder::Decode(pkt.seq, pkt.payload.data(),
+                                    static_cast<uint32_t>(pkt.payload.size()), s_world, &s_stats.decode);
+        return true;
+
+    case SMSG_COMPRESSED_UPDATE_OBJECT:
+        if (!pkt.inflated)
+        {
+            if (PacketInflater::IsRunning() && now - pkt.timestamp_us < kInflateWaitMicros)
+                return false;
+            ++s_stats.skipped;
+            return true;
+        }
+        UpdateObjectDecoder::Decode(pkt.seq, pkt.inflated->data(),
+                                    static_cast<uint32_t>(pkt.inflated->size()), s_world, &s_stats.decode);
+        return true;
+
+    default:
+        return true;
+    }
+}
+
+void WorldTracker::Clear()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    s_world.Clear();
+    s_stats = {};
+    // Keep s_cursor: packets already seen are not replayed into the fresh table.
+}
+
+WorldTrackerStats WorldTracker::Stats()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    return s_stats;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "WorldState.h"
+#include "UpdateObjectDecoder.h"
+#include "../wow/WowTypes.h"
+
+// ============================================================
+//  WorldTracker — feeds captured update packets into a WorldState
+//
+//  Consumes SMSG_UPDATE_OBJECT and the inflated body of
+//  SMSG_COMPRESSED_UPDATE_OBJECT strictly in capture order.  A
+//  compressed packet whose inflate job has not finished yet holds
+//  the cursor until it is kInflateWaitMicros old, then it is
+//  skipped (counted in Stats().skipped).
+//
+//  Start() registers a capture sink that queues the seq of every
+//  SMSG update packet; Poll() fetches the queued packets one by one
+//  (PacketCapture::CopyPacket), so a packet waiting on its inflate
+//  costs one copy per poll, not a copy of everything behind it.
+//
+//  Driven by the PacketPipeline worker (Poll after every batch
+//  and while idle).  Readers take Lock() while walking World().
+// ============================================================
+
+struct WorldTrackerStats
+{
+    UpdateDecodeStats decode;
+    uint64_t          skipped   = 0;   // compressed packets never inflated
+    uint64_t          truncated = 0;   // stored without their payload (capture mode)
+    uint64_t          evicted   = 0;   // left the history before they were decoded
+};
+
+class WorldTracker
+{
+public:
+    static constexpr uint64_t kInflateWaitMicros = 1000000;
+
+    static bool Start();   // registers the capture sink
+    static void Stop();
+    static bool IsRunning() { return s_running.load(std::memory_order_acquire); }
+
+    // Decode queued packets, in capture order, up to the first
+    // compressed one that is still being inflated.
+    static void Poll();
+
+    // Process every new packet in `packets` (capture order).
+    static void Consume(const std::vector<CapturedPacket>& packets);
+
+    static void Clear();
+
+    static std::unique_lock<std::mutex> Lock() { return std::unique_lock<std::mutex>(s_mutex); }
+    static const WorldState& World() { return s_world; }   // caller holds Lock()
+
+    static WorldTrackerStats Stats();
+
+private:
+    static void Sink(const CapturedPacket& pkt);
+    // Returns false if the cursor must stop at this packet for now.
+    static bool ConsumeOne(const CapturedPacket& pkt, uint64_t now);
+
+    static inline std::mutex           s_pendingMutex;   // sink (under a partition lock) vs Poll
+    static inline std::deque<uint64_t> s_pending;        // seqs of queued update packets
+    static inline std::atomic<bool>    s_running{ false };
+
+    static inline std::mutex        s_mutex;
+    static inline WorldState        s_world;
+    static inline WorldTrackerStats s_stats;
+    static inline std::atomic<uint64_t> s_cursor{ 0 };   // last seq consumed
+};
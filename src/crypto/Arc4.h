@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+//  Arc4 — RC4 keystream, same state layout as SARC4State
+//
+//  The client runs one state per direction over SMSG/CMSG
+//  headers only; the keystream continues from header to header.
+// ============================================================
+
+class Arc4
+{
+public:
+    void Init(const uint8_t* key, size_t keyLen, size_t drop = 0)
+    {
+        for (int i = 0; i < 256; ++i)
+            m_s[i] = static_cast<uint8_t>(i);
+        uint8_t j = 0;
+        for (int i = 0; i < 256; ++i)
+        {
+            j = static_cast<uint8_t>(j + m_s[i] + key[i % keyLen]);
+            Swap(m_s[i], m_s[j]);
+        }
+        m_i = m_j = 0;
+
+        uint8_t sink[64];
+        for (; drop >= sizeof(sink); drop -= sizeof(sink))
+            Process(sink, sizeof(sink));
+        Process(sink, drop);
+    }
+
+    void Process(uint8_t* data, size_t len)
+    {
+        uint8_t i = m_i, j = m_j;
+        for (size_t n = 0; n < len; ++n)
+        {
+            i = static_cast<uint8_t>(i + 1);
+            j = static_cast<uint8_t>(j + m_s[i]);
+            Swap(m_s[i], m_s[j]);
+            data[n] ^= m_s[static_cast<uint8_t>(m_s[i] + m_s[j])];
+        }
+        m_i = i;
+        m_j = j;
+    }
+
+private:
+    static void Swap(uint8_t& a, uint8_t& b) { const uint8_t t = a; a = b; b = t; }
+
+    uint8_t m_s[256];
+    uint8_t m_i = 0;
+    uint8_t m_j = 0;
+};
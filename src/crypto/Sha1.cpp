@@ -0,0 +1,118 @@
+#include "Sha1.h"
+#include <cstring>
+
+static inline uint32_t Rol(uint32_t v, int r) { return (v << r) | (v >> (32 - r)); }
+
+void Sha1::Reset()
+{
+    m_state[0] = 0x67452301;
+    m_state[1] = 0xEFCDAB89;
+    m_state[2] = 0x98BADCFE;
+    m_state[3] = 0x10325476;
+    m_state[4] = 0xC3D2E1F0;
+    m_length   = 0;
+    m_buffered = 0;
+}
+
+void Sha1::Block(const uint8_t* p)
+{
+    uint32_t w[80];
+    for (int i = 0; i < 16; ++i)
+        w[i] = (uint32_t(p[i * 4]) << 24) | (uint32_t(p[i * 4 + 1]) << 16) |
+               (uint32_t(p[i * 4 + 2]) << 8) | uint32_t(p[i * 4 + 3]);
+    for (int i = 16; i < 80; ++i)
+        w[i] = Rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3], e = m_state[4];
+    for (int i = 0; i < 80; ++i)
+    {
+        uint32_t f, k;
+        if      (i < 20) { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+        const uint32_t t = Rol(a, 5) + f + e + k + w[i];
+        e = d; d = c; c = Rol(b, 30); b = a; a = t;
+    }
+    m_state[0] += a; m_state[1] += b; m_state[2] += c; m_state[3] += d; m_state[4] += e;
+}
+
+void Sha1::Update(const void* data, size_t len)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    m_length += len;
+
+    if (m_buffered)
+    {
+        const size_t take = (len < kBlockSize - m_buffered) ? len : kBlockSize - m_buffered;
+        memcpy(m_buffer + m_buffered, p, take);
+        m_buffered += take; p += take; len -= take;
+        if (m_buffered < kBlockSize) return;
+        Block(m_buffer);
+        m_buffered = 0;
+    }
+    for (; len >= kBlockSize; p += kBlockSize, len -= kBlockSize)
+        Block(p);
+    if (len)
+    {
+        memcpy(m_buffer, p, len);
+        m_buffered = len;
+    }
+}
+
+void Sha1::Final(uint8_t out[kDigestSize])
+{
+    const uint64_t bits = m_length * 8;
+    const uint8_t  pad  = 0x80;
+    const uint8_t  zero = 0;
+    Update(&pad, 1);
+    while (m_buffered != kBlockSize - 8)
+        Update(&zero, 1);
+
+    uint8_t len[8];
+    for (int i = 0; i < 8; ++i)
+        len[i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    Update(len, 8);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        out[i * 4]     = static_cast<uint8_t>(m_state[i] >> 24);
+        out[i * 4 + 1] = static_cast<uint8_t>(m_state[i] >> 16);
+        out[i * 4 + 2] = static_cast<uint8_t>(m_state[i] >> 8);
+        out[i * 4 + 3] = static_cast<uint8_t>(m_state[i]);
+    }
+    Reset();
+}
+
+void Sha1::Digest(const void* data, size_t len, uint8_t out[kDigestSize])
+{
+    Sha1 h;
+    h.Update(data, len);
+    h.Final(out);
+}
+
+void Sha1::Hmac(const uint8_t* key, size_t keyLen, const void* data, size_t len, uint8_t out[kDigestSize])
+{
+    uint8_t k[kBlockSize] = {};
+    if (keyLen > kBlockSize)
+        Digest(key, keyLen, k);
+    else
+        memcpy(k, key, keyLen);
+
+    uint8_t ipad[kBlockSize], opad[kBlockSize];
+    for (size_t i = 0; i < kBlockSize; ++i)
+    {
+        ipad[i] = k[i] ^ 0x36;
+        opad[i] = k[i] ^ 0x5C;
+    }
+
+    uint8_t inner[kDigestSize];
+    Sha1 h;
+    h.Update(ipad, kBlockSize);
+    h.Update(data, len);
+    h.Final(inner);
+
+    h.Update(opad, kBlockSize);
+    h.Update(inner, kDigestSize);
+    h.Final(out);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================
+//  Sha1 — portable SHA-1 and HMAC-SHA1
+//
+//  Only used to rebuild the client's header-cipher keys
+//  (HMAC-SHA1 over the SRP6 session key), never for anything
+//  security-relevant.  Streaming: Update() any number of times,
+//  then Final().
+// ============================================================
+
+class Sha1
+{
+public:
+    static constexpr size_t kDigestSize = 20;
+    static constexpr size_t kBlockSize  = 64;
+
+    Sha1() { Reset(); }
+
+    void Reset();
+    void Update(const void* data, size_t len);
+    void Final(uint8_t out[kDigestSize]);
+
+    // One-shot helpers
+    static void Digest(const void* data, size_t len, uint8_t out[kDigestSize]);
+    static void Hmac(const uint8_t* key, size_t keyLen,
+                     const void* data, size_t len, uint8_t out[kDigestSize]);
+
+private:
+    void Block(const uint8_t* p);
+
+    uint32_t m_state[5];
+    uint64_t m_length;               // bytes hashed so far
+    uint8_t  m_buffer[kBlockSize];
+    size_t   m_buffered;
+};
@@ -0,0 +1,27 @@
+#include "WorldCrypt.h"
+#include "Sha1.h"
+
+const uint8_t WorldCrypt::kSmsgSeed[16] = {
+    0xCC, 0x98, 0xAE, 0x04, 0xE8, 0x97, 0xEA, 0xCA, 0x12, 0xDD, 0xC0, 0x93, 0x42, 0x91, 0x53, 0x57
+};
+const uint8_t WorldCrypt::kCmsgSeed[16] = {
+    0xC2, 0xB3, 0x72, 0x3C, 0xC6, 0xAE, 0xD9, 0xB5, 0x34, 0x3C, 0x53, 0xEE, 0x2F, 0x43, 0x67, 0xCE
+};
+
+void WorldCrypt::DeriveKey(PacketDirection dir, const uint8_t* sessionKey, size_t keyLen, uint8_t out[20])
+{
+    const uint8_t* seed = (dir == PacketDirection::SMSG) ? kSmsgSeed : kCmsgSeed;
+    Sha1::Hmac(seed, sizeof(kSmsgSeed), sessionKey, keyLen, out);
+}
+
+void HeaderCipher::Init(PacketDirection dir, const uint8_t* sessionKey, size_t keyLen)
+{
+    uint8_t key[20];
+    WorldCrypt::DeriveKey(dir, sessionKey, keyLen, key);
+    InitDerived(key);
+}
+
+void HeaderCipher::InitDerived(const uint8_t key[20])
+{
+    m_arc4.Init(key, 20, WorldCrypt::kDropBytes);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "Arc4.h"
+#include "../wow/WowTypes.h"
+
+// ============================================================
+//  WorldCrypt — 3.3.5a world-connection header cipher
+//
+//  After CMSG_AUTH_SESSION both sides key one ARC4 state per
+//  direction from the 40-byte SRP6 session key K:
+//
+//    SMSG  ARC4( HMAC-SHA1(CC98AE04E897EACA12DDC09342915357, K) )
+//    CMSG  ARC4( HMAC-SHA1(C2B3723CC6AED9B5343C53EE2F4367CE, K) )
+//
+//  with the first 1024 keystream bytes discarded.  The derived
+//  20-byte HMAC digests are what WowConnection keeps in
+//  m_recvKey / m_sendKey.  Only headers are enciphered:
+//  6 bytes per CMSG, 4 or 5 bytes per SMSG.
+// ============================================================
+
+namespace WorldCrypt
+{
+    constexpr size_t kSessionKeySize = 40;
+    constexpr size_t kDropBytes      = 1024;
+
+    extern const uint8_t kSmsgSeed[16];
+    extern const uint8_t kCmsgSeed[16];
+
+    // HMAC-SHA1(seed for dir, sessionKey) → the 20-byte ARC4 key.
+    void DeriveKey(PacketDirection dir, const uint8_t* sessionKey, size_t keyLen, uint8_t out[20]);
+}
+
+class HeaderCipher
+{
+public:
+    // Key from the session key (derives the direction's HMAC key).
+    void Init(PacketDirection dir, const uint8_t* sessionKey, size_t keyLen);
+    // Key from an already derived 20-byte key (m_sendKey / m_recvKey).
+    void InitDerived(const uint8_t key[20]);
+
+    void Process(uint8_t* data, size_t len) { m_arc4.Process(data, len); }
+
+private:
+    Arc4 m_arc4;
+};
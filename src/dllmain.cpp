@@ -1,12 +1,23 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <thread>
+#include <cstring>
 
-#include "DebugLog.h"
+#include "log/Log.h"
 #include "hooks/HookManager.h"
 #include "hooks/PacketHooks.h"
 #include "hooks/D3DHooks.h"
 #include "packet/PacketCapture.h"
+#include "packet/PacketFuzzer.h"
+#include "packet/PacketInflater.h"
+#include "packet/PacketPipeline.h"
+#include "analysis/LatencyTracker.h"
+#include "analysis/TrafficTimeline.h"
+#include "analysis/WorldTracker.h"
+#include "ipc/CaptureMirror.h"
+#include "ipc/ControlServer.h"
+#include "wow/Offsets.h"
+#include "wow/OffsetResolver.h"
 
 // ============================================================
 //  PacketGod — WoW 3.3.5a (build 12340) packet tool
@@ -14,56 +25,147 @@
 //
 //  Boot sequence:
 //    1. DLL_PROCESS_ATTACH fires on a new thread
-//    2. MinHook is initialized
-//    3. D3D9 hooks installed (ImGui rendering)
-//    4. Packet hooks installed (ARC4, SetEncryptionKey, AuthChallenge)
-//    5. All hooks enabled
+//    2. Offsets resolved (PacketGod.sigs, cached in PacketGod.offsets)
+//    3. MinHook is initialized
+//    4. D3D9 hooks installed (ImGui rendering)
+//    5. Packet hooks installed (ARC4, SetEncryptionKey, AuthChallenge)
+//    6. Background stages started (shared-memory mirror, latency tracker,
+//       world tracker, traffic timeline, capture pipeline, zlib inflate
+//       pool, control endpoint)
+//    7. All hooks enabled
 //
 //  Shutdown (DLL_PROCESS_DETACH or eject hotkey):
-//    6. Hooks disabled + removed
-//    7. ImGui torn down
-//    8. MinHook uninitialized
+//    8. Fuzzer stopped, control endpoint closed, hooks disabled + removed
+//    9. Background stages stopped (pipeline drains first, then the mirror)
+//   10. ImGui torn down
+//   11. MinHook uninitialized
 // ============================================================
 
 static HMODULE s_hSelf = nullptr;
 
+// `name` in PacketGod.dll's directory; false if the path is unknown.
+static bool SiblingPath(HMODULE hModule, const char* name, char (&path)[MAX_PATH])
+{
+    if (!hModule || GetModuleFileNameA(hModule, path, MAX_PATH) == 0) return false;
+    char* lastSlash = strrchr(path, '\\');
+    if (!lastSlash) return false;
+    lastSlash[1] = '\0';
+    return strcat_s(path, name) == 0;
+}
+
+// debuglog.txt next to PacketGod.dll; falls back to the working directory.
+static void StartLog(HMODULE hModule)
+{
+    char path[MAX_PATH] = {};
+    if (SiblingPath(hModule, "debuglog.txt", path) && Log::Start(path)) return;
+    Log::Start("debuglog.txt");
+}
+
+// Places Offsets:: in this wow.exe before anything is hooked.  The
+// first run on a reference client (Offsets::kReferenceHashes) writes
+// PacketGod.sigs from the build 12340 addresses; later runs (and
+// other builds) scan with it, and the result is cached per module
+// hash in PacketGod.offsets.  Without the file, any other client
+// keeps the 12340 addresses and writes nothing.
+static void ResolveOffsets(HMODULE hModule)
+{
+    ModuleImage image;
+    if (!ModuleImage::FromPe(reinterpret_cast<const uint8_t*>(GetModuleHandleA(nullptr)), image))
+    {
+        LOG_ERROR(Core, "Offsets: wow.exe headers unreadable, using build 12340 addresses");
+        return;
+    }
+
+    char sigsPath[MAX_PATH] = {}, cachePath[MAX_PATH] = {};
+    if (!SiblingPath(hModule, "PacketGod.sigs", sigsPath) || !SiblingPath(hModule, "PacketGod.offsets", cachePath))
+        return;
+
+    std::vector<OffsetSignature> sigs;
+    std::string error;
+    if (GetFileAttributesA(sigsPath) == INVALID_FILE_ATTRIBUTES)
+    {
+        const uint64_t hash = OffsetResolver::ModuleHash(image);
+        if (!Offsets::IsReferenceBuild(hash))
+        {
+            // Signatures taken at unchecked addresses would be saved for good.
+            LOG_ERROR(Core, "Offsets: no PacketGod.sigs and wow.exe (code hash %016llX) is not a known build 12340 "
+                      "client; not generating signatures, using build 12340 addresses",
+                      static_cast<unsigned long long>(hash));
+            return;
+        }
+        std::vector<std::string> failed;
+        sigs = OffsetResolver::Generate(image, {}, &failed);
+        OffsetResolver::SaveSignatures(sigsPath, sigs);
+        LOG_INFO(Core, "Offsets: wrote %zu signatures from the build 12340 addresses to PacketGod.sigs", sigs.size());
+        for (const std::string& name : failed)
+            LOG_WARN(Core, "Offsets: no unique signature for %s", name.c_str());
+        return;   // the addresses they came from are already in place
+    }
+    if (!OffsetResolver::LoadSignatures(sigsPath, sigs, error))
+    {
+        LOG_ERROR(Core, "Offsets: PacketGod.sigs: %s", error.c_str());
+        return;
+    }
+
+    OffsetReport report;
+    OffsetResolver::Resolve(image, sigs, cachePath, report);
+    LOG_INFO(Core, "Offsets: %u / %zu placed (%s), hash %.1f ms, scan %.1f ms (%s)", report.placed,
+             report.results.size(), report.cacheHit ? "cached" : "scanned", report.hashMs, report.scanMs,
+             ScanIsaName(report.isa));
+    for (const OffsetResult& r : report.results)
+        if (r.source == OffsetSource::Default)
+            LOG_WARN(Core, "Offsets: %s %s (%u matches), keeping the build 12340 address", r.name.c_str(),
+                     r.matches ? "ambiguous" : "not found", r.matches);
+}
+
 // ============================================================
 //  Worker thread — runs while DLL is loaded
 // ============================================================
 static DWORD WINAPI WorkerThread(LPVOID)
 {
-    DebugLog_Init(s_hSelf);
-    DebugLog_Log("[PacketGod] WorkerThread started");
+    StartLog(s_hSelf);
+    LOG_INFO(Core, "WorkerThread started");
 
     Sleep(500);
-    DebugLog_Log("[PacketGod] After Sleep(500)");
+    LOG_DEBUG(Core, "After Sleep(500)");
 
-    DebugLog_Log("[PacketGod] HookManager::Init ...");
+    ResolveOffsets(s_hSelf);
+
+    LOG_DEBUG(Core, "HookManager::Init ...");
     if (!HookManager::Init())
     {
-        DebugLog_Log("[PacketGod] HookManager::Init FAILED");
+        LOG_ERROR(Core, "HookManager::Init FAILED");
         MessageBoxW(nullptr, L"HookManager::Init failed", L"PacketGod", MB_ICONERROR);
         return 1;
     }
-    DebugLog_Log("[PacketGod] HookManager::Init OK");
+    LOG_INFO(Core, "HookManager::Init OK");
 
-    DebugLog_Log("[PacketGod] D3DHooks::Install ...");
+    LOG_DEBUG(Core, "D3DHooks::Install ...");
     if (!D3DHooks::Install())
     {
-        DebugLog_Log("[PacketGod] D3DHooks::Install failed (ImGui disabled)");
+        LOG_ERROR(Core, "D3DHooks::Install failed (ImGui disabled)");
     }
     else
-        DebugLog_Log("[PacketGod] D3DHooks::Install OK");
+        LOG_INFO(Core, "D3DHooks::Install OK");
 
-    DebugLog_Log("[PacketGod] PacketHooks::Install ...");
+    LOG_DEBUG(Core, "PacketHooks::Install ...");
     if (!PacketHooks::Install())
-        DebugLog_Log("[PacketGod] PacketHooks::Install failed");
+        LOG_ERROR(Core, "PacketHooks::Install failed");
     else
-        DebugLog_Log("[PacketGod] PacketHooks::Install OK");
+        LOG_INFO(Core, "PacketHooks::Install OK");
+
+    CaptureMirror::Start();
+    LatencyTracker::Start();
+    WorldTracker::Start();
+    TrafficTimeline::Start();
+    PacketPipeline::Start();
+    PacketInflater::Start(2);
+    LOG_INFO(Core, "PacketInflater %s", PacketInflater::IsRunning() ? "started" : "unavailable (no zlib)");
+    ControlServer::Start();
 
-    DebugLog_Log("[PacketGod] HookManager::EnableAll ...");
+    LOG_DEBUG(Core, "HookManager::EnableAll ...");
     HookManager::EnableAll();
-    DebugLog_Log("[PacketGod] EnableAll done - Loaded. Press INSERT to toggle UI.");
+    LOG_INFO(Core, "EnableAll done - Loaded. Press INSERT to toggle UI.");
 
     while (true)
     {
@@ -72,12 +174,20 @@ static DWORD WINAPI WorkerThread(LPVOID)
             break;
     }
 
-    DebugLog_Log("[PacketGod] Ejecting...");
+    LOG_INFO(Core, "Ejecting...");
+    PacketFuzzer::Stop();    // joins the worker; its mutants go through the Send trampoline
+    ControlServer::Stop();   // replays go through the Send trampoline
     HookManager::DisableAll();
     PacketHooks::Remove();
+    PacketPipeline::Stop();
+    LatencyTracker::Stop();
+    WorldTracker::Stop();
+    TrafficTimeline::Stop();
+    CaptureMirror::Stop();
+    PacketInflater::Stop();
     D3DHooks::Remove();
     HookManager::Shutdown();
-    DebugLog_Shutdown();
+    Log::Stop();
     FreeLibraryAndExitThread(s_hSelf, 0);
 }
 
@@ -0,0 +1,330 @@
+#include "ConnectionTracker.h"
+#include "HookManager.h"
+#include "../wow/Offsets.h"
+#include "../log/Log.h"
+#include <mutex>
+
+// WowConn_Init is still marked "TODO: verify" in Offsets.h.
+#ifndef PACKETGOD_ENABLE_WOWCONN_INIT_HOOK
+#define PACKETGOD_ENABLE_WOWCONN_INIT_HOOK 0
+#endif
+
+// ============================================================
+//  Live set
+//
+//  Lookups are lock-free.  Slots change owner only under
+//  s_slotMutex, so lifecycle hooks may run on any thread: the
+//  duplicate check and the claim are one step, and a slot's id
+//  and state are stored before its pointer is published.
+// ============================================================
+
+static std::atomic<WowConnection*> s_conns[ConnectionTracker::kMaxConnections];
+static std::atomic<uint8_t>        s_states[ConnectionTracker::kMaxConnections];
+static std::atomic<uint8_t>        s_ids[ConnectionTracker::kMaxConnections];
+static std::atomic<WowConnection*> s_active{ nullptr };
+static std::atomic<uint32_t>       s_generation{ 0 };
+static std::atomic<uint8_t>        s_nextId{ 0 };
+static std::mutex                  s_slotMutex;   // claims and releases of s_conns
+
+// Last role seen per id, kept after close so replay can follow the role.
+static std::atomic<uint8_t>        s_idRoles[256];
+static std::atomic<NetClient*>     s_netClient{ nullptr };
+
+static int FindSlot(const WowConnection* conn)
+{
+    for (int i = 0; i < ConnectionTracker::kMaxConnections; ++i)
+        if (s_conns[i].load(std::memory_order_acquire) == conn)
+            return i;
+    return -1;
+}
+
+// Caller holds s_slotMutex.
+static int FreeSlot()
+{
+    for (int i = 0; i < ConnectionTracker::kMaxConnections; ++i)
+        if (!s_conns[i].load(std::memory_order_relaxed))
+            return i;
+    return -1;
+}
+
+// ============================================================
+//  Original function trampolines
+// ============================================================
+
+// WowConnection::SetStatus(this, int)
+using fn_SetStatus = void(__thiscall*)(WowConnection*, int32_t);
+static fn_SetStatus orig_SetStatus = nullptr;
+
+// WowConnection::Disconnect(this)
+using fn_Disconnect = void(__thiscall*)(WowConnection*);
+static fn_Disconnect orig_Disconnect = nullptr;
+
+// WowConnection::Init(this, handler) — unverified signature, opt-in only
+using fn_WowConnInit = void(__thiscall*)(WowConnection*, void*);
+static fn_WowConnInit orig_WowConnInit = nullptr;
+
+// Wrapper so __thiscall detours are static members (MSVC allows __thiscall only on member functions)
+struct LifecycleDetours
+{
+    static void __thiscall SetStatus(WowConnection* self, int32_t status);
+    static void __thiscall Disconnect(WowConnection* self);
+    static void __thiscall Init(WowConnection* self, void* handler);
+};
+
+// Closing: leave the live set first, so nothing races the teardown.
+void __thiscall LifecycleDetours::SetStatus(WowConnection* self, int32_t status)
+{
+    if (status == ConnectionTracker::kStatusClosing)
+        ConnectionTracker::OnClosed(self);
+
+    orig_SetStatus(self, status);
+
+    if (status == ConnectionTracker::kStatusConnected)
+        ConnectionTracker::OnOpen(self);
+}
+
+void __thiscall LifecycleDetours::Disconnect(WowConnection* self)
+{
+    ConnectionTracker::OnClosed(self);
+    orig_Disconnect(self);
+}
+
+void __thiscall LifecycleDetours::Init(WowConnection* self, void* handler)
+{
+    orig_WowConnInit(self, handler);
+    ConnectionTracker::OnOpen(self);
+}
+
+// ============================================================
+//  Public API
+// ============================================================
+namespace ConnectionTracker
+{
+    // Pinned: with a lifecycle hook off, closes go unseen and the live
+    // set keeps pointers the game has already freed.
+    bool Install()
+    {
+        bool ok = true;
+
+        ok &= HookManager::Add(
+            Offsets::WowConn_SetStatus,
+            reinterpret_cast<void*>(&LifecycleDetours::SetStatus),
+            reinterpret_cast<void**>(&orig_SetStatus),
+            "WowConn_SetStatus", true);
+
+        ok &= HookManager::Add(
+            Offsets::WowConn_Disconnect,
+            reinterpret_cast<void*>(&LifecycleDetours::Disconnect),
+            reinterpret_cast<void**>(&orig_Disconnect),
+            "WowConn_Disconnect", true);
+
+#if PACKETGOD_ENABLE_WOWCONN_INIT_HOOK
+        ok &= HookManager::Add(
+            Offsets::WowConn_Init,
+            reinterpret_cast<void*>(&LifecycleDetours::Init),
+            reinterpret_cast<void**>(&orig_WowConnInit),
+            "WowConn_Init", true);
+#endif
+
+        return ok;
+    }
+
+    void OnOpen(WowConnection* conn)
+    {
+        if (!conn || FindSlot(conn) >= 0) return;
+
+        int     slot;
+        uint8_t id = 0;
+        {
+            std::lock_guard<std::mutex> lock(s_slotMutex);
+            if (FindSlot(conn) >= 0) return;   // registered by another thread meanwhile
+            slot = FreeSlot();
+            if (slot >= 0)
+            {
+                id = static_cast<uint8_t>(s_nextId.fetch_add(1, std::memory_order_relaxed) + 1);
+                if (!id) id = static_cast<uint8_t>(s_nextId.fetch_add(1, std::memory_order_relaxed) + 1);   // 0 = untracked
+                s_idRoles[id].store(static_cast<uint8_t>(ConnectionRole::Unknown), std::memory_order_relaxed);
+                s_ids[slot].store(id, std::memory_order_relaxed);
+                s_states[slot].store(static_cast<uint8_t>(ConnState::Open), std::memory_order_relaxed);
+                s_conns[slot].store(conn, std::memory_order_release);
+                s_generation.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (slot < 0)
+        {
+            LOG_WARN(Hooks, "ConnectionTracker: no free slot for conn=%p", (void*)conn);
+            return;
+        }
+        LOG_DEBUG(Hooks, "ConnectionTracker: open conn=%p slot=%d id=%u", (void*)conn, slot, id);
+    }
+
+    void OnEncrypted(WowConnection* conn)
+    {
+        if (!conn) return;
+        std::lock_guard<std::mutex> lock(s_slotMutex);
+        const int slot = FindSlot(conn);
+        if (slot >= 0)
+            s_states[slot].store(static_cast<uint8_t>(ConnState::Encrypted), std::memory_order_release);
+    }
+
+    void OnClosed(WowConnection* conn)
+    {
+        if (!conn) return;
+
+        int slot;
+        {
+            std::lock_guard<std::mutex> lock(s_slotMutex);
+            WowConnection* expected = conn;
+            s_active.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+
+            slot = FindSlot(conn);
+            if (slot < 0) return;
+            RoleOf(conn);   // remember the role for ReplayTarget
+            s_conns[slot].store(nullptr, std::memory_order_release);
+            s_states[slot].store(static_cast<uint8_t>(ConnState::Free), std::memory_order_relaxed);
+            s_ids[slot].store(0, std::memory_order_relaxed);
+            s_generation.fetch_add(1, std::memory_order_relaxed);
+        }
+        LOG_DEBUG(Hooks, "ConnectionTracker: closed conn=%p slot=%d", (void*)conn, slot);
+    }
+
+    bool IsLive(const WowConnection* conn)
+    {
+        return conn && FindSlot(conn) >= 0;
+    }
+
+    WowConnection* Active()
+    {
+        return s_active.load(std::memory_order_acquire);
+    }
+
+    // Under s_slotMutex, so a close cannot slip between the check and the store.
+    void SetActive(WowConnection* conn)
+    {
+        std::lock_guard<std::mutex> lock(s_slotMutex);
+        if (!conn || FindSlot(conn) >= 0)
+            s_active.store(conn, std::memory_order_release);
+    }
+
+    uint8_t IdOf(const WowConnection* conn)
+    {
+        const int slot = conn ? FindSlot(conn) : -1;
+        return slot >= 0 ? s_ids[slot].load(std::memory_order_relaxed) : 0;
+    }
+
+    WowConnection* Lookup(uint8_t id)
+    {
+        if (!id) return nullptr;
+        for (int i = 0; i < kMaxConnections; ++i)
+            if (s_ids[i].load(std::memory_order_relaxed) == id)
+                if (WowConnection* conn = s_conns[i].load(std::memory_order_acquire))
+                    return conn;
+        return nullptr;
+    }
+
+    WowConnection* MatchRecvCrypto(const SARC4State* src, const SARC4State* dst, uint8_t* outId)
+    {
+        for (int i = 0; i < kMaxConnections; ++i)
+        {
+            WowConnection* conn = s_conns[i].load(std::memory_order_acquire);
+            if (conn && (src == &conn->m_recvCrypto || dst == &conn->m_recvCrypto))
+            {
+                if (outId) *outId = s_ids[i].load(std::memory_order_relaxed);
+                return conn;
+            }
+        }
+        return nullptr;
+    }
+
+    WowConnection* ForSocket(uintptr_t sock, uint8_t* outId)
+    {
+        for (int i = 0; i < kMaxConnections; ++i)
+        {
+            WowConnection* conn = s_conns[i].load(std::memory_order_acquire);
+            if (conn && static_cast<uintptr_t>(conn->m_socket) == sock)
+            {
+                if (outId) *outId = s_ids[i].load(std::memory_order_relaxed);
+                return conn;
+            }
+        }
+        return nullptr;
+    }
+
+    void SetNetClient(NetClient* client)
+    {
+        s_netClient.store(client, std::memory_order_release);
+    }
+
+    ConnectionRole RoleOf(const WowConnection* conn)
+    {
+        NetClient* client = s_netClient.load(std::memory_order_acquire);
+        if (!client || !conn) return ConnectionRole::Unknown;
+
+        ConnectionRole role = ConnectionRole::Unknown;
+        if      (client->m_clientConnection == conn) role = ConnectionRole::World;
+        else if (client->m_realmConnection  == conn) role = ConnectionRole::Realm;
+
+        const int slot = FindSlot(conn);
+        if (slot >= 0 && role != ConnectionRole::Unknown)
+            s_idRoles[s_ids[slot].load(std::memory_order_relaxed)].store(static_cast<uint8_t>(role), std::memory_order_relaxed);
+        return role;
+    }
+
+    ConnectionRole RoleOf(uint8_t id)
+    {
+        if (WowConnection* conn = Lookup(id))
+        {
+            const ConnectionRole role = RoleOf(conn);
+            if (role != ConnectionRole::Unknown) return role;
+        }
+        return static_cast<ConnectionRole>(s_idRoles[id].load(std::memory_order_relaxed));
+    }
+
+    const char* RoleName(ConnectionRole role)
+    {
+        switch (role)
+        {
+        case ConnectionRole::Realm: return "realm";
+        case ConnectionRole::World: return "world";
+        default:                    return "?";
+        }
+    }
+
+    WowConnection* ReplayTarget(uint8_t id)
+    {
+        if (WowConnection* conn = Lookup(id))
+            return conn;
+
+        ConnectionRole role = id ? RoleOf(id) : ConnectionRole::World;
+        if (role == ConnectionRole::Unknown) role = ConnectionRole::World;
+
+        if (NetClient* client = s_netClient.load(std::memory_order_acquire))
+        {
+            WowConnection* conn = role == ConnectionRole::Realm ? client->m_realmConnection
+                                                                : client->m_clientConnection;
+            if (conn) return conn;
+        }
+        return Active();
+    }
+
+    uint32_t Generation()
+    {
+        return s_generation.load(std::memory_order_relaxed);
+    }
+
+    int Snapshot(ConnInfo* out, int max)
+    {
+        int n = 0;
+        for (int i = 0; i < kMaxConnections && n < max; ++i)
+        {
+            WowConnection* conn = s_conns[i].load(std::memory_order_acquire);
+            if (!conn) continue;
+            out[n].conn  = conn;
+            out[n].state = static_cast<ConnState>(s_states[i].load(std::memory_order_acquire));
+            out[n].id    = s_ids[i].load(std::memory_order_relaxed);
+            out[n].role  = RoleOf(conn);
+            ++n;
+        }
+        return n;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include "../wow/WowTypes.h"
+
+// ============================================================
+//  ConnectionTracker — authoritative set of live WowConnections
+//
+//  Lifecycle hooks publish connection state so the packet hooks
+//  never have to probe memory:
+//    WowConnection::Init        → Open      (opt-in, see below)
+//    WowConnection::SetStatus   → Open on 5 (connected), Closed on 7
+//    WowConnection::Disconnect  → Closed, before the original runs
+//  Only these register or drop a connection.  SetEncryptionKey
+//  marks a tracked one Encrypted and AuthChallenge makes it active;
+//  neither (nor a send) registers a connection, so a pointer that
+//  was closed never gets back into the set.  A connection opened
+//  before the hooks went in stays untracked until it reconnects.
+//
+//  The set is a fixed array of atomic slots.  IsLive() and Active()
+//  are a handful of relaxed/acquire loads and a pointer compare —
+//  cheap enough for ARC4_Process.  Open / Closed take a short lock
+//  so a connection seen by two hooks at once gets one slot.  A
+//  connection is dropped from the set before the game tears it
+//  down, so a pointer that IsLive() accepted was not yet
+//  disconnected when it was checked.
+//
+//  Each tracked connection gets a one-byte id (1..255, reused only
+//  after wrapping) that tags its captured packets, and a role read
+//  from NetClient::m_realmConnection / m_clientConnection once the
+//  AuthChallenge hook has seen the NetClient.
+//
+//  WowConn_Init's signature is unverified; its hook is only built
+//  with -DPACKETGOD_ENABLE_WOWCONN_INIT_HOOK=ON.
+// ============================================================
+
+enum class ConnState : uint8_t
+{
+    Free      = 0,
+    Open      = 1,   // constructed / connected, no session key yet
+    Encrypted = 2,   // SetEncryptionKey seen
+};
+
+struct ConnInfo
+{
+    WowConnection* conn  = nullptr;
+    ConnState      state = ConnState::Free;
+    uint8_t        id    = 0;
+    ConnectionRole role  = ConnectionRole::Unknown;
+};
+
+namespace ConnectionTracker
+{
+    constexpr int kMaxConnections = 8;
+
+    // WowConnection::m_status values (see WowTypes.h)
+    constexpr int32_t kStatusConnected = 5;
+    constexpr int32_t kStatusClosing   = 7;
+
+    // Add the lifecycle hooks, pinned (call after HookManager::Init).
+    bool Install();
+
+    // State transitions — called from the hooks.  Only the lifecycle
+    // hooks call OnOpen; OnEncrypted ignores untracked connections.
+    void OnOpen(WowConnection* conn);
+    void OnEncrypted(WowConnection* conn);
+    void OnClosed(WowConnection* conn);
+
+    // Hot-path queries: no locks, no memory probing.
+    bool           IsLive(const WowConnection* conn);
+    WowConnection* Active();          // last connection keyed or challenged, if still live
+    void           SetActive(WowConnection* conn);   // ignored unless conn is tracked
+
+    // Ids —————————————————————————————————————————————————————————
+    // Id of conn; 0 if untracked (never registers it).
+    uint8_t        IdOf(const WowConnection* conn);
+    WowConnection* Lookup(uint8_t id);   // nullptr once closed
+
+    // Live connection whose recv ARC4 state is src or dst (address compare).
+    WowConnection* MatchRecvCrypto(const SARC4State* src, const SARC4State* dst, uint8_t* outId);
+    // Live connection reading from `sock`.
+    WowConnection* ForSocket(uintptr_t sock, uint8_t* outId);
+
+    // Roles ———————————————————————————————————————————————————————
+    void           SetNetClient(NetClient* client);   // from the AuthChallenge hook
+    ConnectionRole RoleOf(const WowConnection* conn);
+    ConnectionRole RoleOf(uint8_t id);
+    const char*    RoleName(ConnectionRole role);
+
+    // Where replayed CMSGs for packets captured on `id` should go: that
+    // connection while live, else NetClient's current connection of the
+    // same role.  id 0 means the world connection.
+    WowConnection* ReplayTarget(uint8_t id);
+
+    // Bumped on every open/close; lets readers detect churn cheaply.
+    uint32_t Generation();
+
+    // Copy of the live set for the UI; returns the number written.
+    int Snapshot(ConnInfo* out, int max);
+}
@@ -1,7 +1,9 @@
 #include "D3DHooks.h"
 #include "HookManager.h"
 #include "../ui/PacketUI.h"
-#include "../DebugLog.h"
+#include "../ipc/ControlServer.h"
+#include "../packet/PacketFuzzer.h"
+#include "../log/Log.h"
 
 #include <Windows.h>
 #include <d3d9.h>
@@ -124,11 +126,11 @@ static HRESULT __stdcall Detour_Present(
             if (ctx.out)
                 s_gameWnd = ctx.out;
         }
-        DebugLog_Log("[D3D] Present: chosen wnd=%p", (void*)s_gameWnd);
+        LOG_INFO(D3D, "Present: chosen wnd=%p", (void*)s_gameWnd);
 
         if (s_gameWnd)
         {
-            DebugLog_Log("[D3D] Present: init ImGui, wnd=%p", (void*)s_gameWnd);
+            LOG_INFO(D3D, "Present: init ImGui, wnd=%p", (void*)s_gameWnd);
             IMGUI_CHECKVERSION();
             ImGui::CreateContext();
             ImGuiIO& io = ImGui::GetIO();
@@ -143,15 +145,15 @@ static HRESULT __stdcall Detour_Present(
                                   reinterpret_cast<LONG_PTR>(HookedWndProc)));
 
             s_imguiReady = true;
-            DebugLog_Log("[D3D] Present: ImGui ready");
+            LOG_INFO(D3D, "Present: ImGui ready");
         }
         else
-            DebugLog_Log("[D3D] Present: no valid window, skipping ImGui");
+            LOG_WARN(D3D, "Present: no valid window, skipping ImGui");
     }
 
     if (s_imguiReady && (!s_gameWnd || !IsWindow(s_gameWnd)))
     {
-        DebugLog_Log("[D3D] Present: window stale, re-attach");
+        LOG_WARN(D3D, "Present: window stale, re-attach");
         HWND newWnd = FindWindowW(L"GxWindowClass", nullptr);
         if (!newWnd && hDestWindowOverride && IsWindow(hDestWindowOverride))
             newWnd = hDestWindowOverride;
@@ -173,15 +175,19 @@ static HRESULT __stdcall Detour_Present(
             s_origWndProc = reinterpret_cast<WNDPROC>(
                 SetWindowLongPtrW(s_gameWnd, GWLP_WNDPROC,
                                   reinterpret_cast<LONG_PTR>(HookedWndProc)));
-            DebugLog_Log("[D3D] Present: re-attached to %p", (void*)s_gameWnd);
+            LOG_INFO(D3D, "Present: re-attached to %p", (void*)s_gameWnd);
         }
     }
 
+    // Main thread, once per frame, with or without the overlay.
+    ControlServer::RunQueuedSends();
+    PacketFuzzer::RunQueuedSends();
+
     if (!s_imguiReady)
     {
         static int s_skipCount = 0;
         if (s_skipCount < 5 || (s_skipCount % 60) == 0)
-            DebugLog_Log("[D3D] Present: bypass (no ImGui) frame %d", s_skipCount);
+            LOG_DEBUG(D3D, "Present: bypass (no ImGui) frame %d", s_skipCount);
         s_skipCount++;
         return orig_Present(device, pSourceRect, pDestRect, hDestWindowOverride, pDirtyRegion);
     }
@@ -206,7 +212,6 @@ static HRESULT __stdcall Detour_Present(
 
     ImGui::EndFrame();
     ImGui::Render();
-    DebugLog_Flush();
     ImGui_ImplDX9_RenderDrawData(ImGui::GetDrawData());
     HRESULT hr = orig_Present(device, pSourceRect, pDestRect, hDestWindowOverride, pDirtyRegion);
     return hr;
@@ -240,7 +245,7 @@ static HWND                s_dummyWnd  = nullptr;
 
 static bool GetD3D9VTable(void**& outVtable)
 {
-    DebugLog_Log("[D3D] GetD3D9VTable: start");
+    LOG_DEBUG(D3D, "GetD3D9VTable: start");
     WNDCLASSEXW wc   = { sizeof(wc) };
     wc.lpfnWndProc   = DefWindowProcW;
     wc.hInstance     = GetModuleHandleW(nullptr);
@@ -278,7 +283,7 @@ static bool GetD3D9VTable(void**& outVtable)
     }
 
     outVtable = *reinterpret_cast<void***>(s_dummyDev);
-    DebugLog_Log("[D3D] GetD3D9VTable: OK vtable=%p (dummy device kept alive)", (void*)outVtable);
+    LOG_INFO(D3D, "GetD3D9VTable: OK vtable=%p (dummy device kept alive)", (void*)outVtable);
     return true;
 }
 
@@ -289,11 +294,11 @@ namespace D3DHooks
 {
     bool Install()
     {
-        DebugLog_Log("[D3D] Install: start");
+        LOG_DEBUG(D3D, "Install: start");
         void** vtable = nullptr;
         if (!GetD3D9VTable(vtable))
         {
-            DebugLog_Log("[D3D] Install: GetD3D9VTable failed");
+            LOG_ERROR(D3D, "Install: GetD3D9VTable failed");
             return false;
         }
 
@@ -302,15 +307,15 @@ namespace D3DHooks
             reinterpret_cast<uintptr_t>(vtable[kPresent_Slot]),
             reinterpret_cast<void*>(&Detour_Present),
             reinterpret_cast<void**>(&orig_Present),
-            "IDirect3DDevice9::Present");
+            "IDirect3DDevice9::Present", true);
 
         ok &= HookManager::Add(
             reinterpret_cast<uintptr_t>(vtable[kReset_Slot]),
             reinterpret_cast<void*>(&Detour_Reset),
             reinterpret_cast<void**>(&orig_Reset),
-            "IDirect3DDevice9::Reset");
+            "IDirect3DDevice9::Reset", true);
 
-        DebugLog_Log("[D3D] Install: %s", ok ? "OK" : "FAIL");
+        LOG_INFO(D3D, "Install: %s", ok ? "OK" : "FAIL");
         return ok;
     }
 
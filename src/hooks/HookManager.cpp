@@ -1,13 +1,13 @@
 #include "HookManager.h"
-#include "../DebugLog.h"
+#include "../log/Log.h"
 #include <stdexcept>
 
 bool HookManager::Init()
 {
-    if (s_initialized) { DebugLog_Log("[HookManager] Init (already inited)"); return true; }
-    DebugLog_Log("[HookManager] MH_Initialize ...");
+    if (s_initialized) { LOG_DEBUG(Hooks, "Init (already inited)"); return true; }
+    LOG_DEBUG(Hooks, "MH_Initialize ...");
     MH_STATUS st = MH_Initialize();
-    DebugLog_Log("[HookManager] MH_Initialize => %d", (int)st);
+    LOG_INFO(Hooks, "MH_Initialize => %d", (int)st);
     if (st != MH_OK && st != MH_ERROR_ALREADY_INITIALIZED)
         return false;
     s_initialized = true;
@@ -16,40 +16,87 @@ bool HookManager::Init()
 
 void HookManager::Shutdown()
 {
-    DebugLog_Log("[HookManager] Shutdown");
+    LOG_INFO(Hooks, "Shutdown");
     DisableAll();
     MH_Uninitialize();
     s_hooks.clear();
     s_initialized = false;
 }
 
-bool HookManager::Add(uintptr_t targetVA, void* detour, void** outOriginal, const char* debugName)
+bool HookManager::Add(uintptr_t targetVA, void* detour, void** outOriginal, const char* debugName,
+                      bool pinned)
 {
     void* target = reinterpret_cast<void*>(targetVA);
     MH_STATUS st = MH_CreateHook(target, detour, outOriginal);
-    DebugLog_Log("[HookManager] Add %s va=0x%08X => %d", debugName ? debugName : "(null)", (unsigned)targetVA, (int)st);
+    LOG_INFO(Hooks, "Add %s va=0x%08X => %d", debugName ? debugName : "(null)", (unsigned)targetVA, (int)st);
     if (st != MH_OK) return false;
-    s_hooks.push_back({ target, debugName ? debugName : "" });
+    s_hooks.push_back({ target, debugName ? debugName : "", false, pinned });
     return true;
 }
 
 bool HookManager::EnableAll()
 {
-    DebugLog_Log("[HookManager] EnableAll ...");
+    LOG_DEBUG(Hooks, "EnableAll ...");
     bool ok = MH_EnableHook(MH_ALL_HOOKS) == MH_OK;
-    DebugLog_Log("[HookManager] EnableAll => %s", ok ? "OK" : "FAIL");
+    LOG_INFO(Hooks, "EnableAll => %s", ok ? "OK" : "FAIL");
+    if (ok)
+        for (auto& h : s_hooks) h.enabled = true;
     return ok;
 }
 
 bool HookManager::DisableAll()
 {
-    DebugLog_Log("[HookManager] DisableAll");
-    return MH_DisableHook(MH_ALL_HOOKS) == MH_OK;
+    LOG_INFO(Hooks, "DisableAll");
+    bool ok = MH_DisableHook(MH_ALL_HOOKS) == MH_OK;
+    if (ok)
+        for (auto& h : s_hooks) h.enabled = false;
+    return ok;
+}
+
+HookManager::HookEntry* HookManager::Find(const char* name)
+{
+    if (!name) return nullptr;
+    for (auto& h : s_hooks)
+        if (h.name == name) return &h;
+    return nullptr;
+}
+
+bool HookManager::SetEnabled(const char* name, bool enable)
+{
+    HookEntry* h = Find(name);
+    if (!h || h->pinned) return false;
+    if (h->enabled == enable) return true;
+
+    MH_STATUS st = enable ? MH_EnableHook(h->target) : MH_DisableHook(h->target);
+    LOG_INFO(Hooks, "%s %s => %d", enable ? "Enable" : "Disable", name, (int)st);
+    if (st != MH_OK) return false;
+    h->enabled = enable;
+    return true;
+}
+
+bool HookManager::IsEnabled(const char* name)
+{
+    const HookEntry* h = Find(name);
+    return h && h->enabled;
+}
+
+bool HookManager::Has(const char* name)
+{
+    return Find(name) != nullptr;
+}
+
+std::vector<HookManager::HookInfo> HookManager::List()
+{
+    std::vector<HookInfo> out;
+    out.reserve(s_hooks.size());
+    for (const auto& h : s_hooks)
+        out.push_back({ h.name.c_str(), h.enabled, h.pinned });
+    return out;
 }
 
 void HookManager::RemoveAll()
 {
-    DebugLog_Log("[HookManager] RemoveAll (%zu hooks)", s_hooks.size());
+    LOG_INFO(Hooks, "RemoveAll (%zu hooks)", s_hooks.size());
     for (auto& h : s_hooks)
         MH_RemoveHook(h.target);
     s_hooks.clear();
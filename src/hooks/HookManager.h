@@ -12,6 +12,10 @@
 //    HookManager::EnableAll();
 //    ...
 //    HookManager::RemoveAll();  // call before FreeLibrary
+//
+//  Single hooks can be switched at runtime by debug name.  A
+//  disabled hook has its original prologue restored, so the game
+//  runs none of our code there; its trampoline stays valid.
 // ============================================================
 
 class HookManager
@@ -21,18 +25,39 @@ public:
     static void Shutdown();
 
     // Register a hook.  outOriginal receives the trampoline pointer.
-    static bool Add(uintptr_t targetVA, void* detour, void** outOriginal, const char* debugName = nullptr);
+    // pinned: the hook keeps something we rely on running (the UI's own
+    // Present, connection lifetime), so SetEnabled refuses it; EnableAll /
+    // DisableAll still apply.
+    static bool Add(uintptr_t targetVA, void* detour, void** outOriginal, const char* debugName = nullptr,
+                    bool pinned = false);
 
     static bool EnableAll();
     static bool DisableAll();
     static void RemoveAll();
 
+    // By debug name.  False if unknown, pinned or MinHook refuses.
+    static bool SetEnabled(const char* name, bool enable);
+    static bool IsEnabled(const char* name);
+    static bool Has(const char* name);
+
+    struct HookInfo
+    {
+        const char* name;   // valid until RemoveAll
+        bool        enabled;
+        bool        pinned;
+    };
+    static std::vector<HookInfo> List();
+
 private:
     struct HookEntry
     {
         void* target;
         std::string name;
+        bool  enabled = false;
+        bool  pinned  = false;
     };
+    static HookEntry* Find(const char* name);
+
     static inline std::vector<HookEntry> s_hooks;
     static inline bool                   s_initialized = false;
 };
@@ -1,12 +1,17 @@
 #include "PacketHooks.h"
 #include "HookManager.h"
+#include "ConnectionTracker.h"
 #include "../wow/Offsets.h"
 #include "../wow/WowTypes.h"
-#include "../packet/PacketCapture.h"
+#include "../packet/PacketPipeline.h"
 #include "../packet/PacketReplay.h"
-#include "../DebugLog.h"
+#include "../packet/PacketRewriter.h"
+#include "../packet/StreamReassembler.h"
+#include "../log/Log.h"
+#include <atomic>
 #include <cstring>
 #include <cstdio>
+#include <mutex>
 
 #include <Windows.h>
 
@@ -16,8 +21,8 @@
 #define PACKETGOD_DISABLE_AUTH_CHALLENGE_HOOK 0
 #endif
 
-// Best-effort: avoid dereferencing obviously bad pointers (stale/freed).
-// IsBadReadPtr is deprecated but still useful for defensive checks here.
+// Best-effort check on game-owned packet buffers (handshake can pass transient ones).
+// Connections are never probed — ConnectionTracker knows which ones are live.
 static bool IsReadable(const void* ptr, size_t len)
 {
     if (!ptr) return false;
@@ -28,8 +33,6 @@ static bool IsReadable(const void* ptr, size_t len)
 //  Module-level state
 // ============================================================
 
-static WowConnection* s_activeConn = nullptr;
-
 // Captured session key (logged at SetEncryptionKey time)
 static uint8_t s_sessionKey[40]  = {};
 static uint8_t s_sessionKeyLen   = 0;
@@ -54,6 +57,10 @@ static fn_AuthChallenge orig_AuthChallenge = nullptr;
 using fn_WowConn_Send = int(__thiscall*)(WowConnection*, CDataStore*, int);
 static fn_WowConn_Send orig_WowConn_Send = nullptr;
 
+// Layer E: ws2_32!recv — SOCKET is UINT_PTR; avoid pulling in winsock2.h
+using fn_recv = int(__stdcall*)(uintptr_t sock, char* buf, int len, int flags);
+static fn_recv orig_recv = nullptr;
+
 // Wrapper so __thiscall detours are static members (MSVC allows __thiscall only on member functions)
 struct Detours
 {
@@ -64,17 +71,14 @@ struct Detours
 };
 
 // ============================================================
-//  Helper: parse a WoW 3.3.5a packet header from a raw buffer
+//  Helper: parse a WoW 3.3.5a CMSG header from a raw buffer
 //
 //  CMSG plaintext layout (before encryption):
 //    [2] size BE  (= 4 + payloadLen)
 //    [4] opcode LE
 //    [N] payload
 //
-//  SMSG plaintext layout (after decryption):
-//    [2] size BE  (= 2 + payloadLen)
-//    [2] opcode LE
-//    [N] payload
+//  SMSG headers (4- or 5-byte form) are parsed by StreamReassembler.
 // ============================================================
 static bool ParseCMSG(const uint8_t* data, int len, uint16_t& outOpcode, uint32_t& outPayloadLen)
 {
@@ -85,15 +89,96 @@ static bool ParseCMSG(const uint8_t* data, int len, uint16_t& outOpcode, uint32_
     return true;
 }
 
-static bool ParseSMSG(const uint8_t* data, int len, uint16_t& outOpcode, uint32_t& outPayloadLen)
+// ============================================================
+//  Per-connection SMSG streams
+//
+//  One StreamReassembler per WowConnection we have seen encrypt.
+//  Realm + world is two; the extra slots absorb reconnects.
+//
+//  The recv / ARC4 hooks, SetEncKey and the UI's stats reach a
+//  stream from different threads.  Each slot has its own lock,
+//  held for the whole use of the stream; a slot changes owner only
+//  under s_claimMutex and its own lock, so a lookup re-checks the
+//  owner once it holds the slot.
+// ============================================================
+struct ConnStream
 {
-    if (len < 4) return false;
-    uint16_t sizeField = static_cast<uint16_t>((data[0] << 8) | data[1]);
-    outOpcode          = static_cast<uint16_t>( data[2]       | (data[3] << 8));
-    outPayloadLen      = static_cast<uint32_t>(sizeField)   - 2;
-    return true;
+    std::atomic<WowConnection*> conn{ nullptr };
+    std::mutex                  lock;
+    StreamReassembler           stream;
+    uint32_t                    armGen = 0;   // s_armGen when the stream was last reset
+};
+
+static constexpr int kMaxStreams = 4;
+static ConnStream    s_streams[kMaxStreams];
+static std::mutex    s_claimMutex;            // slot owner changes; s_nextStreamSlot
+static int           s_nextStreamSlot = 0;
+
+// Bumped by Arm(): while disarmed the streams missed bytes, so each
+// one is reset the next time a hook touches it (on the hook's thread,
+// never under a detour still running on it).
+static std::atomic<uint32_t> s_armGen{ 0 };
+static std::atomic<bool>     s_armed{ true };   // WowConn_Send captures only while set
+
+// Caller holds s.lock.  create: hook-side call; may also reset a
+// stream that predates Arm().
+static StreamReassembler* Touch(ConnStream& s, bool create)
+{
+    if (create)
+    {
+        const uint32_t gen = s_armGen.load(std::memory_order_acquire);
+        if (s.armGen != gen) { s.stream.Reset(); s.armGen = gen; }
+    }
+    return &s.stream;
+}
+
+// The stream of `conn`, locked through `held` until it goes out of scope.
+static StreamReassembler* StreamFor(WowConnection* conn, bool create, std::unique_lock<std::mutex>& held)
+{
+    for (auto& s : s_streams)
+    {
+        if (s.conn.load(std::memory_order_acquire) != conn) continue;
+        held = std::unique_lock<std::mutex>(s.lock);
+        if (s.conn.load(std::memory_order_relaxed) == conn) return Touch(s, create);
+        held.unlock();   // reclaimed between the scan and the lock
+        break;
+    }
+    if (!create) return nullptr;
+
+    std::lock_guard<std::mutex> claim(s_claimMutex);
+    for (auto& s : s_streams)   // another thread may have claimed it meanwhile
+        if (s.conn.load(std::memory_order_relaxed) == conn)
+        {
+            held = std::unique_lock<std::mutex>(s.lock);
+            return Touch(s, create);
+        }
+
+    ConnStream& slot = s_streams[s_nextStreamSlot];
+    s_nextStreamSlot = (s_nextStreamSlot + 1) % kMaxStreams;
+    held = std::unique_lock<std::mutex>(slot.lock);
+    slot.conn.store(conn, std::memory_order_release);
+    slot.stream.Reset();
+    slot.armGen = s_armGen.load(std::memory_order_acquire);
+    return &slot.stream;
+}
+
+// The SMSG data path: every packet crosses these.  Lifecycle hooks
+// (SetEncKey, AuthChallenge, ConnectionTracker) fire a few times per
+// session and stay enabled, so connections are known when re-armed.
+// WowConn_Send is not one of them: it also runs the rewrite rules, so
+// it stays installed and only skips capture while disarmed.
+static const char* const kCaptureLayers[] = { "ARC4_Process", "ws2_32!recv" };
+
+// Hooks only hand bytes to the pipeline; filtering and storage run on its worker.
+// `user` carries the ConnectionTracker id of the stream.
+static void OnFramedSMSG(const SmsgView& pkt, void* user)
+{
+    PacketPipeline::Enqueue(PacketDirection::SMSG, pkt.opcode, pkt.payload, pkt.size,
+                            static_cast<uint8_t>(reinterpret_cast<uintptr_t>(user)));
 }
 
+static void* ConnTag(uint8_t id) { return reinterpret_cast<void*>(static_cast<uintptr_t>(id)); }
+
 // ============================================================
 //  Layer A: WowConnection::Send detour
 //
@@ -108,10 +193,11 @@ static bool ParseSMSG(const uint8_t* data, int len, uint16_t& outOpcode, uint32_
 int __thiscall Detours::WowConn_Send(WowConnection* self, CDataStore* packet, int priority)
 {
     static int s_first = 1;
-    if (s_first) { DebugLog_Log("[PacketHooks] WowConn_Send first call self=%p packet=%p", (void*)self, (void*)packet); s_first = 0; }
+    if (s_first) { LOG_DEBUG(Hooks, "WowConn_Send first call self=%p packet=%p", (void*)self, (void*)packet); s_first = 0; }
 
-    // Register original Send + connection so Replay can inject packets
-    PacketReplay::SetSendFn(orig_WowConn_Send, self);
+    // Realm and world sends both land here; the id keeps them apart.
+    const bool    armed  = s_armed.load(std::memory_order_relaxed);
+    const uint8_t connId = armed ? ConnectionTracker::IdOf(self) : 0;   // lookup only
 
     // Safely peek packet buffer (handshake can pass transient buffers; avoid AV in our code).
     bool safeCapture = false;
@@ -125,6 +211,23 @@ int __thiscall Detours::WowConn_Send(WowConnection* self, CDataStore* packet, in
         {
             if (IsReadable(packet->m_buffer, static_cast<size_t>(packet->m_size)))
             {
+                // Rewrite before capture so the store shows what is actually sent.
+                // m_alloc is ~0 for buffers the store does not own; never grow those.
+                // The store's own capacity is the only bound; a buffer that
+                // cannot be written faults out of Apply() and is sent as it is.
+                if (PacketRewriter::IsActive())
+                {
+                    const uint32_t cap = (packet->m_alloc != ~0u && packet->m_alloc > packet->m_size) ? packet->m_alloc : packet->m_size;
+                    __try
+                    {
+                        PacketRewriter::Apply(packet->m_buffer, packet->m_size, cap);
+                    }
+                    __except (EXCEPTION_EXECUTE_HANDLER)
+                    {
+                        PacketRewriter::AbortApply();
+                    }
+                }
+
                 opcode     = *reinterpret_cast<const uint16_t*>(packet->m_buffer);
                 payloadLen = packet->m_size - 4;
                 payloadPtr = (payloadLen > 0) ? (packet->m_buffer + 4) : nullptr;
@@ -137,8 +240,8 @@ int __thiscall Detours::WowConn_Send(WowConnection* self, CDataStore* packet, in
         }
     }
 
-    if (safeCapture && PacketCapture::ShouldCapture(PacketDirection::CMSG, opcode))
-        PacketCapture::Push(PacketDirection::CMSG, opcode, payloadPtr, payloadLen);
+    if (safeCapture && armed)
+        PacketPipeline::Enqueue(PacketDirection::CMSG, opcode, payloadPtr, payloadLen, connId);
 
     return orig_WowConn_Send(self, packet, priority);
 }
@@ -147,45 +250,55 @@ int __thiscall Detours::WowConn_Send(WowConnection* self, CDataStore* packet, in
 //  Layer B: ARC4_Process detour  (SMSG only — CMSG handled by Layer A)
 //
 //  RE signature: SARC4State* __cdecl ARC4_Process(data, len, srcState, dstState)
-//  ARC4 only encrypts/decrypts the packet HEADER (SMSG: 4 bytes).
-//  Direction: recv when srcState or dstState is &s_activeConn->m_recvCrypto.
+//  ARC4 only encrypts/decrypts the packet HEADER (SMSG: 4 or 5 bytes).
+//  Direction: recv when srcState or dstState is &conn->m_recvCrypto of
+//  any tracked live connection (address compare only, nothing is read).
 // ============================================================
 static SARC4State* __cdecl Detour_ARC4_Process(uint8_t* data, uint32_t len, SARC4State* srcState, SARC4State* dstState)
 {
     static int s_first = 1;
-    if (s_first) { DebugLog_Log("[PacketHooks] ARC4_Process first call data=%p len=%u src=%p dst=%p", (void*)data, (unsigned)len, (void*)srcState, (void*)dstState); s_first = 0; }
+    if (s_first) { LOG_DEBUG(Hooks, "ARC4_Process first call data=%p len=%u src=%p dst=%p", (void*)data, (unsigned)len, (void*)srcState, (void*)dstState); s_first = 0; }
 
-    bool isRecv = false;
-
-    if (s_activeConn)
-    {
-        if (!IsReadable(s_activeConn, sizeof(WowConnection)))
-        {
-            s_activeConn = nullptr;
-            PacketHooks::SetActiveConnection(nullptr);
-        }
-        else if (len > 0 && (srcState == &s_activeConn->m_recvCrypto || dstState == &s_activeConn->m_recvCrypto))
-            isRecv = true;
-    }
+    uint8_t connId = 0;
+    WowConnection* conn = len > 0 ? ConnectionTracker::MatchRecvCrypto(srcState, dstState, &connId) : nullptr;
+    const bool isRecv = conn != nullptr;
 
     SARC4State* result = orig_ARC4_Process(data, len, srcState, dstState);
 
-    // RECV: capture AFTER header decryption.
-    if (isRecv && len >= 4)
+    // RECV: header bytes are plaintext now.  The reassembler decides
+    // whether the payload is already in the recv buffer or still owed
+    // by later recv() chunks, and handles the 5-byte large header.
+    if (isRecv)
     {
-        uint16_t opcode     = 0;
-        uint32_t payloadLen = 0;
-        if (ParseSMSG(data, static_cast<int>(len), opcode, payloadLen)
-            && PacketCapture::ShouldCapture(PacketDirection::SMSG, opcode))
-        {
-            const uint8_t* payloadPtr = (payloadLen > 0) ? (data + 4) : nullptr;
-            PacketCapture::Push(PacketDirection::SMSG, opcode, payloadPtr, payloadLen);
-        }
+        std::unique_lock<std::mutex> held;
+        if (StreamReassembler* stream = StreamFor(conn, true, held))
+            stream->OnHeader(data, len, &OnFramedSMSG, ConnTag(connId));
     }
 
     return result;
 }
 
+// ============================================================
+//  Layer E: ws2_32!recv detour — feeds recv chunk boundaries
+//
+//  Only chunks for a connection we already track are forwarded;
+//  everything else (realm list, HTTP, voice) passes untouched.
+// ============================================================
+static int __stdcall Detour_recv(uintptr_t sock, char* buf, int len, int flags)
+{
+    int n = orig_recv(sock, buf, len, flags);
+    if (n <= 0 || (flags & 0x2 /*MSG_PEEK*/)) return n;
+
+    uint8_t connId = 0;
+    if (WowConnection* conn = ConnectionTracker::ForSocket(sock, &connId))
+    {
+        std::unique_lock<std::mutex> held;
+        if (StreamReassembler* stream = StreamFor(conn, true, held))
+            stream->OnRecv(reinterpret_cast<const uint8_t*>(buf), static_cast<uint32_t>(n), &OnFramedSMSG, ConnTag(connId));
+    }
+    return n;
+}
+
 // ============================================================
 //  Layer C: SetEncryptionKey detour — snapshot keys at login
 // ============================================================
@@ -196,13 +309,20 @@ void __thiscall Detours::SetEncKey(
     const uint8_t* seed, uint8_t seedLen)
 {
     static int s_first = 1;
-    if (s_first) { DebugLog_Log("[PacketHooks] SetEncKey first call self=%p", (void*)self); s_first = 0; }
+    if (s_first) { LOG_DEBUG(Hooks, "SetEncKey first call self=%p", (void*)self); s_first = 0; }
 
-    // Record the connection for ARC4 direction tracking
-    s_activeConn = self;
-    PacketHooks::SetActiveConnection(self);
+    // Mark the connection (registered by SetStatus) keyed and active for ARC4 direction tracking
+    ConnectionTracker::OnEncrypted(self);
+    ConnectionTracker::SetActive(self);
 
-    // Snapshot the session key for display in the UI
+    // Fresh key = fresh stream; drop any framing state from a previous session.
+    {
+        std::unique_lock<std::mutex> held;
+        if (StreamReassembler* stream = StreamFor(self, true, held))
+            stream->Reset();
+    }
+
+    // Snapshot the session key for the UI and for offline decryption (tools/decrypt)
     if (sessionKey && sessionKeyLen <= 40)
     {
         memcpy(s_sessionKey, sessionKey, sessionKeyLen);
@@ -222,11 +342,12 @@ void __thiscall Detours::SetEncKey(
 void __thiscall Detours::AuthChallenge(void* netClient, WowConnection* conn, CDataStore** packet)
 {
     static int s_first = 1;
-    if (s_first) { DebugLog_Log("[PacketHooks] AuthChallenge first call netClient=%p conn=%p", (void*)netClient, (void*)conn); s_first = 0; }
+    if (s_first) { LOG_DEBUG(Hooks, "AuthChallenge first call netClient=%p conn=%p", (void*)netClient, (void*)conn); s_first = 0; }
 
-    // Record this connection too (may differ from the world conn)
-    s_activeConn = conn;
-    PacketHooks::SetActiveConnection(conn);
+    // Record this connection too (may differ from the world conn), and the
+    // NetClient whose realm/client slots give every connection its role.
+    ConnectionTracker::SetNetClient(static_cast<NetClient*>(netClient));
+    ConnectionTracker::SetActive(conn);
 
     orig_AuthChallenge(netClient, conn, packet);
 }
@@ -238,7 +359,7 @@ namespace PacketHooks
 {
     bool Install()
     {
-        DebugLog_Log("[PacketHooks] Install: start");
+        LOG_DEBUG(Hooks, "Install: start");
         bool ok = true;
 
         // Layer A — WowConnection::Send (CMSG capture: opcode + full payload)
@@ -255,7 +376,7 @@ namespace PacketHooks
             reinterpret_cast<void**>(&orig_ARC4_Process),
             "ARC4_Process");
 
-        // Layer C — SetEncryptionKey (snapshots session keys, sets s_activeConn)
+        // Layer C — SetEncryptionKey (snapshots session keys, marks the connection active)
         ok &= HookManager::Add(
             Offsets::WowConn_SetEncKey,
             reinterpret_cast<void*>(&Detours::SetEncKey),
@@ -271,7 +392,27 @@ namespace PacketHooks
             "NetClient_AuthChallenge");
 #endif
 
-        DebugLog_Log("[PacketHooks] Install: %s", ok ? "OK" : "FAIL");
+        // Connection lifecycle (SetStatus / Disconnect, optionally Init)
+        ok &= ConnectionTracker::Install();
+
+        // Replay sends through the original Send, to the connection a
+        // packet was captured on (or NetClient's current one of that role).
+        PacketReplay::SetSendFn(orig_WowConn_Send, nullptr);
+        PacketReplay::SetTargetResolver(&ConnectionTracker::ReplayTarget);
+
+        // Layer E — ws2_32!recv (recv chunk boundaries for SMSG reassembly).
+        // Optional: without it the reassembler assumes contiguous payloads.
+        if (HMODULE ws2 = GetModuleHandleA("ws2_32.dll"))
+        {
+            if (void* recvVA = reinterpret_cast<void*>(GetProcAddress(ws2, "recv")))
+                HookManager::Add(
+                    reinterpret_cast<uintptr_t>(recvVA),
+                    reinterpret_cast<void*>(&Detour_recv),
+                    reinterpret_cast<void**>(&orig_recv),
+                    "ws2_32!recv");
+        }
+
+        LOG_INFO(Hooks, "Install: %s", ok ? "OK" : "FAIL");
         return ok;
     }
 
@@ -280,6 +421,43 @@ namespace PacketHooks
         HookManager::RemoveAll();
     }
 
-    void SetActiveConnection(WowConnection* conn) { s_activeConn = conn; }
-    WowConnection* GetActiveConnection()          { return s_activeConn; }
+    bool SetArmed(bool armed)
+    {
+        if (armed && !s_armed.load())
+            s_armGen.fetch_add(1, std::memory_order_release);
+
+        // recv is optional (no ws2_32 at install): unknown names are not failures.
+        bool ok = true;
+        for (const char* name : kCaptureLayers)
+            if (HookManager::Has(name))
+                ok &= HookManager::SetEnabled(name, armed);
+        s_armed.store(armed);
+        LOG_INFO(Hooks, "%s: %s", armed ? "Armed" : "Disarmed", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    bool IsArmed() { return s_armed.load(); }
+
+    bool IsCaptureLayer(const char* hookName)
+    {
+        for (const char* name : kCaptureLayers)
+            if (!strcmp(name, hookName)) return true;
+        return false;
+    }
+
+    void SetActiveConnection(WowConnection* conn) { ConnectionTracker::SetActive(conn); }
+    WowConnection* GetActiveConnection()          { return ConnectionTracker::Active(); }
+
+    StreamStats GetStreamStats(WowConnection* conn)
+    {
+        std::unique_lock<std::mutex> held;
+        StreamReassembler* stream = StreamFor(conn, false, held);
+        return stream ? stream->Stats() : StreamStats{};
+    }
+
+    uint8_t GetSessionKey(uint8_t out[40])
+    {
+        memcpy(out, s_sessionKey, s_sessionKeyLen);
+        return s_sessionKeyLen;
+    }
 }
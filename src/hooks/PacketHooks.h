@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include "../wow/WowTypes.h"
+#include "../packet/StreamReassembler.h"
 
 // ============================================================
 //  PacketHooks — MinHook detours for packet interception
@@ -11,18 +12,29 @@
 //      layout: m_buffer[0..3]=opcode(LE), m_buffer[4..m_size-1]=payload.
 //
 //  Layer B: ARC4_Process (0x00774EA0)  ← IMPLEMENTED (SMSG only)
-//    → Only encrypts/decrypts the 4-byte SMSG header (or 6-byte CMSG
-//      header). On recv, data+4 points to the plaintext payload in the
-//      same recv buffer. CMSG capture removed — Layer A is used instead.
+//    → Only encrypts/decrypts the SMSG header (4 bytes, or 5 for the
+//      large form with bit 7 of the first byte set) or 6-byte CMSG
+//      header. Decrypted header bytes feed the per-connection
+//      StreamReassembler, which works out where the payload is.
+//      CMSG capture removed — Layer A is used instead.
 //
 //  Layer C: WowConnection::SetEncryptionKey (0x00466BF0)  ← IMPLEMENTED
-//    → Fired once at login. Snapshots session key + sets s_activeConn
-//      so Layer B can identify send vs recv SARC4State by pointer comparison.
+//    → Fired once at login. Snapshots session key + marks the connection
+//      active in ConnectionTracker so Layer B can identify send vs recv
+//      SARC4State by pointer comparison.
 //
 //  Layer D: NetClient::AuthChallengeHandler (0x00632730)  ← IMPLEMENTED
 //    → Fires during login handshake. Secondary conn tracking / timing.
 //    → If login crashes at 0x00467C0B (AV read 0x436DECA2), try building with
 //      -DPACKETGOD_DISABLE_AUTH_CHALLENGE_HOOK=1 to test.
+//
+//  Layer E: ws2_32!recv  ← IMPLEMENTED (optional)
+//    → Reports recv chunk boundaries for the tracked connection so
+//      SMSGs that span chunks are reassembled instead of truncated.
+//
+//  Connection lifetime (SetStatus / Disconnect) is tracked by
+//  ConnectionTracker; Layers B and E only act on its active,
+//  still-live connection.
 // ============================================================
 
 namespace PacketHooks
@@ -33,8 +45,29 @@ namespace PacketHooks
     // Remove all hooks (call before FreeLibrary / shutdown)
     void Remove();
 
+    // Armed (the default once HookManager::EnableAll has run): Layers A,
+    // B and E capture.  Disarmed: B and E are disabled in MinHook, so
+    // header decryption and recv run the game's own code only, and
+    // Layer A stays installed but stores nothing — installed CMSG
+    // rewrite rules keep applying.  Layers C / D and ConnectionTracker
+    // keep tracking sessions; replay still works (it calls the Send
+    // trampoline).  Re-arming resets SMSG framing per stream.
+    bool SetArmed(bool armed);
+    bool IsArmed();
+
+    // True for the hooks SetArmed switches.  They are switched only as a
+    // group: recv without the ARC4 hook (or the reverse) leaves the
+    // streams' recv window stale and every SMSG pending.
+    bool IsCaptureLayer(const char* hookName);
+
     // Set the active WowConnection* so ARC4 hook can identify direction.
-    // Call this from the SetEncryptionKey hook.
+    // Forwards to ConnectionTracker; Get returns nullptr once it disconnects.
     void SetActiveConnection(WowConnection* conn);
     WowConnection* GetActiveConnection();
+
+    // SMSG framing counters for a connection (zeroed if never seen).
+    StreamStats GetStreamStats(WowConnection* conn);
+
+    // Session key passed to the last SetEncryptionKey; returns its length (0 = none yet).
+    uint8_t GetSessionKey(uint8_t out[40]);
 }
@@ -0,0 +1,66 @@
+#include "CaptureMirror.h"
+#include "../packet/PacketCapture.h"
+#include "../log/Log.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static uint32_t CurrentPid()
+{
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+bool CaptureMirror::Start(uint32_t dataBytes)
+{
+    if (IsRunning()) return true;
+
+    const uint32_t pid = CurrentPid();
+    ShmRing::DefaultName(pid, s_name, sizeof(s_name));
+    if (!s_writer.Create(s_name, dataBytes, pid))
+    {
+        LOG_WARN(Capture, "CaptureMirror: could not create shared ring %s", s_name);
+        s_name[0] = 0;
+        return false;
+    }
+    s_records = s_bytes = s_overwritten = s_dropped = 0;
+    s_running.store(true, std::memory_order_release);
+    PacketCapture::AddSink(&CaptureMirror::Sink);
+    LOG_INFO(Capture, "CaptureMirror: publishing to %s (%u KiB)", s_name, dataBytes >> 10);
+    return true;
+}
+
+void CaptureMirror::Stop()
+{
+    if (!IsRunning()) return;
+    PacketCapture::RemoveSink(&CaptureMirror::Sink);
+    s_running.store(false, std::memory_order_release);
+    s_writer.Close();
+    LOG_INFO(Capture, "CaptureMirror: closed %s", s_name);
+}
+
+void CaptureMirror::Sink(const CapturedPacket& pkt)
+{
+    s_writer.Append(pkt);
+    const ShmWriterStats st = s_writer.Stats();
+    s_records.store(st.records, std::memory_order_relaxed);
+    s_bytes.store(st.bytes, std::memory_order_relaxed);
+    s_overwritten.store(st.overwritten, std::memory_order_relaxed);
+    s_dropped.store(st.dropped, std::memory_order_relaxed);
+}
+
+ShmWriterStats CaptureMirror::Stats()
+{
+    ShmWriterStats st;
+    st.records     = s_records.load(std::memory_order_relaxed);
+    st.bytes       = s_bytes.load(std::memory_order_relaxed);
+    st.overwritten = s_overwritten.load(std::memory_order_relaxed);
+    st.dropped     = s_dropped.load(std::memory_order_relaxed);
+    return st;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include "ShmRing.h"
+
+// ============================================================
+//  CaptureMirror — publishes stored packets into a ShmRing
+//
+//  Registers itself as the PacketCapture sink, so it runs on the
+//  pipeline worker after filtering and sequencing; the hooks are
+//  not involved.  The ring is named after the current process
+//  (ShmRing::DefaultName) so an analyzer only needs the game's pid.
+//
+//  Start before PacketPipeline::Start, stop after PacketPipeline::Stop
+//  (the worker is the only writer and must be gone before Close).
+// ============================================================
+
+class CaptureMirror
+{
+public:
+    static constexpr uint32_t kDefaultBytes = 16u << 20;
+
+    static bool Start(uint32_t dataBytes = kDefaultBytes);
+    static void Stop();
+    static bool IsRunning() { return s_running.load(std::memory_order_acquire); }
+
+    static const char*    Name() { return s_name; }
+    // Safe from any thread (copied out by the worker after each append).
+    static ShmWriterStats Stats();
+
+private:
+    static void Sink(const CapturedPacket& pkt);
+
+    static inline ShmRingWriter         s_writer;
+    static inline char                  s_name[64] = {};
+    static inline std::atomic<bool>     s_running{ false };
+    static inline std::atomic<uint64_t> s_records{ 0 };
+    static inline std::atomic<uint64_t> s_bytes{ 0 };
+    static inline std::atomic<uint64_t> s_overwritten{ 0 };
+    static inline std::atomic<uint64_t> s_dropped{ 0 };
+};
@@ -0,0 +1,40 @@
+#include "ControlClient.h"
+
+bool ControlClient::Flush()
+{
+    const bool ok = m_send.empty() || m_ipc.Write(m_send.data(), m_send.size());
+    m_send.clear();
+    return ok;
+}
+
+bool ControlClient::ReadFrame(ControlProtocol::FrameHeader& h, std::vector<uint8_t>& body)
+{
+    using namespace ControlProtocol;
+    for (;;)
+    {
+        const size_t have = m_recv.size() - m_recvPos;
+        if (have >= kHeaderSize)
+        {
+            memcpy(&h, m_recv.data() + m_recvPos, sizeof(h));
+            if (have >= kHeaderSize + h.length)
+            {
+                const uint8_t* p = m_recv.data() + m_recvPos + kHeaderSize;
+                body.assign(p, p + h.length);
+                m_recvPos += kHeaderSize + h.length;
+                return true;
+            }
+        }
+
+        // Compact, then read more.
+        if (m_recvPos)
+        {
+            m_recv.erase(m_recv.begin(), m_recv.begin() + static_cast<ptrdiff_t>(m_recvPos));
+            m_recvPos = 0;
+        }
+        const size_t old = m_recv.size();
+        m_recv.resize(old + IpcServer::kReadChunk);
+        const size_t got = m_ipc.Read(m_recv.data() + old, IpcServer::kReadChunk);
+        m_recv.resize(old + got);
+        if (!got) return false;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ControlProtocol.h"
+#include "IpcTransport.h"
+
+// ============================================================
+//  ControlClient — blocking client for ControlServer
+//
+//  Requests are built into a send buffer and leave together on
+//  Flush(), so a harness pipelines by queueing many before it
+//  reads any response:
+//
+//      const uint32_t id = client.Begin(ControlProtocol::Stats);
+//      client.End();
+//      ... more requests ...
+//      client.Flush();
+//      while (client.ReadFrame(h, body)) { match h.id ... }
+//
+//  ReadFrame may run on another thread than Begin/Flush.
+// ============================================================
+
+class ControlClient
+{
+public:
+    ControlClient() : m_writer(m_send) {}
+
+    bool Connect(const char* endpoint) { return m_ipc.Connect(endpoint); }
+    void Close()                       { m_ipc.Close(); }
+
+    // Starts a request frame and returns its id; fill it through Body().
+    uint32_t Begin(uint16_t type)
+    {
+        const uint32_t id = ++m_nextId;
+        m_writer.Begin(type, id);
+        return id;
+    }
+    ControlProtocol::Writer& Body() { return m_writer; }
+    void End()                      { m_writer.End(); }
+
+    size_t Queued() const { return m_send.size(); }
+    bool   Flush();
+
+    // Next frame from the server (response or batch); false when disconnected.
+    bool ReadFrame(ControlProtocol::FrameHeader& h, std::vector<uint8_t>& body);
+
+private:
+    IpcClient               m_ipc;
+    std::vector<uint8_t>    m_send;
+    ControlProtocol::Writer m_writer;
+    uint32_t                m_nextId = 0;
+    std::vector<uint8_t>    m_recv;
+    size_t                  m_recvPos = 0;
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "../packet/PacketCapture.h"
+
+// ============================================================
+//  ControlProtocol — wire format of the local control endpoint
+//
+//  A stream of little-endian frames, each
+//    [4] body length  [2] type  [2] status  [4] request id  [body]
+//
+//  Clients may send any number of requests without waiting;
+//  the server executes them in order and answers each with a
+//  frame of type (request type | kResponse) carrying the same id.
+//  Responses to everything read in one go leave in one write.
+//  Replay and Inject are answered once the game's main thread has
+//  sent their packets, so their responses may overtake later ones.
+//
+//  Subscriptions additionally produce kPacketBatch frames, tagged
+//  with the id of the Subscribe request, until Unsubscribe.
+//
+//  Bodies (→ request, ← response):
+//    Hello            → -                           ← [2] version [4] pid [8] last seq
+//    SetCaptureFilters→ [2] n, n × rule            ← [2] installed
+//    Subscribe        → [2] maxBatch [2] maxDelayMs [2] n, n × rule
+//                                                    ← [8] last seq at subscription
+//    Unsubscribe      → -                           ← -
+//    Replay           → [2] n, n × [8] seq          ← [2] sent [2] failed
+//    Inject           → [2] n, n × ([1] connection [1] 0 [2] opcode [4] size [size])
+//                                                    ← [2] sent [2] failed
+//    Stats            → -                           ← [8] captured [8] dropped
+//                                                      [8] requests [8] streamed [8] streamDropped
+//  rule:   [2] opcode [1] direction | category << 1 [1] flags (kRule*)
+//          (category 0 = none, as older clients send)
+//  batch:  [2] n [2] 0 [4] packets lost since the last batch,
+//          n × ([8] seq [8] timestamp_us [4] size [2] opcode [1] dir [1] conn [size])
+// ============================================================
+
+namespace ControlProtocol
+{
+    constexpr uint16_t kVersion        = 1;
+    constexpr uint32_t kHeaderSize     = 12;
+    constexpr uint32_t kMaxBody        = 4u << 20;   // larger frames close the connection
+
+    enum MessageType : uint16_t
+    {
+        Hello             = 0x0001,
+        SetCaptureFilters = 0x0002,
+        Subscribe         = 0x0003,
+        Unsubscribe       = 0x0004,
+        Replay            = 0x0005,
+        Inject            = 0x0006,
+        Stats             = 0x0007,
+
+        PacketBatch       = 0x4001,   // server → client, unsolicited
+        kResponse         = 0x8000,
+    };
+
+    enum Status : uint16_t
+    {
+        Ok          = 0,
+        BadRequest  = 1,   // body did not parse
+        UnknownType = 2,
+        Unavailable = 3,   // e.g. no send function yet
+        Busy        = 4,   // send queue full; nothing was sent, retry later
+    };
+
+    constexpr uint8_t kRuleEnabled  = 0x1;
+    constexpr uint8_t kRuleAnyDir   = 0x2;
+    constexpr uint8_t kRuleBlock    = 0x4;
+
+    constexpr uint32_t kRuleSize         = 4;
+    constexpr uint32_t kBatchHeaderSize  = 8;
+    constexpr uint32_t kBatchRecordSize  = 24;
+    constexpr uint32_t kInjectRecordSize = 8;
+
+    struct FrameHeader
+    {
+        uint32_t length;
+        uint16_t type;
+        uint16_t status;
+        uint32_t id;
+    };
+    static_assert(sizeof(FrameHeader) == kHeaderSize, "frame header is sent as-is");
+
+    // ------------------------------------------------------------
+    //  Encoding — appends to a byte vector
+    // ------------------------------------------------------------
+    class Writer
+    {
+    public:
+        explicit Writer(std::vector<uint8_t>& out) : m_out(out) {}
+
+        // Starts a frame; its length is patched by End().
+        void Begin(uint16_t type, uint32_t id, uint16_t status = Ok)
+        {
+            m_frame = m_out.size();
+            const FrameHeader h = { 0, type, status, id };
+            Bytes(&h, sizeof(h));
+        }
+        void End()
+        {
+            const uint32_t len = static_cast<uint32_t>(m_out.size() - m_frame - kHeaderSize);
+            memcpy(m_out.data() + m_frame, &len, sizeof(len));
+        }
+
+        void U8(uint8_t v)   { m_out.push_back(v); }
+        void U16(uint16_t v) { Bytes(&v, sizeof(v)); }
+        void U32(uint32_t v) { Bytes(&v, sizeof(v)); }
+        void U64(uint64_t v) { Bytes(&v, sizeof(v)); }
+        void Bytes(const void* p, size_t n)
+        {
+            const auto* b = static_cast<const uint8_t*>(p);
+            m_out.insert(m_out.end(), b, b + n);
+        }
+
+        void Rule(const FilterRule& r)
+        {
+            U16(r.opcode);
+            U8(static_cast<uint8_t>(static_cast<uint8_t>(r.direction) | static_cast<uint8_t>(r.category) << 1));
+            U8(static_cast<uint8_t>((r.enabled ? kRuleEnabled : 0) | (r.matchAny ? kRuleAnyDir : 0) |
+                                    (r.blockPacket ? kRuleBlock : 0)));
+        }
+
+    private:
+        std::vector<uint8_t>& m_out;
+        size_t                m_frame = 0;
+    };
+
+    // ------------------------------------------------------------
+    //  Decoding — bounds-checked; Ok() turns false on overrun
+    // ------------------------------------------------------------
+    class Reader
+    {
+    public:
+        Reader(const uint8_t* data, size_t size) : m_p(data), m_end(data + size) {}
+
+        bool   Ok() const        { return m_ok; }
+        size_t Remaining() const { return static_cast<size_t>(m_end - m_p); }
+
+        uint8_t  U8()  { uint8_t  v = 0; Bytes(&v, sizeof(v)); return v; }
+        uint16_t U16() { uint16_t v = 0; Bytes(&v, sizeof(v)); return v; }
+        uint32_t U32() { uint32_t v = 0; Bytes(&v, sizeof(v)); return v; }
+        uint64_t U64() { uint64_t v = 0; Bytes(&v, sizeof(v)); return v; }
+
+        // Points at the next n bytes and skips them (nullptr on overrun).
+        const uint8_t* Take(size_t n)
+        {
+            if (!m_ok || Remaining() < n) { m_ok = false; return nullptr; }
+            const uint8_t* p = m_p;
+            m_p += n;
+            return p;
+        }
+        void Bytes(void* out, size_t n)
+        {
+            if (const uint8_t* p = Take(n)) memcpy(out, p, n);
+        }
+
+        FilterRule Rule()
+        {
+            FilterRule r;
+            r.opcode      = U16();
+            const uint8_t dir = U8();
+            r.direction   = static_cast<PacketDirection>(dir & 1);
+            r.category    = (dir >> 1) < static_cast<uint8_t>(OpcodeCategory::Count)
+                                ? static_cast<OpcodeCategory>(dir >> 1) : OpcodeCategory::None;
+            const uint8_t flags = U8();
+            r.enabled     = (flags & kRuleEnabled) != 0;
+            r.matchAny    = (flags & kRuleAnyDir)  != 0;
+            r.blockPacket = (flags & kRuleBlock)   != 0;
+            return r;
+        }
+
+    private:
+        const uint8_t* m_p;
+        const uint8_t* m_end;
+        bool           m_ok = true;
+    };
+}
@@ -0,0 +1,599 @@
+#include "ControlServer.h"
+#include "ControlProtocol.h"
+#include "IpcTransport.h"
+#include "../packet/PacketCapture.h"
+#include "../packet/PacketReplay.h"
+#include "../packet/OpcodeFilter.h"
+#include "../log/Log.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace ControlProtocol;
+
+// ============================================================
+//  State
+//
+//  Everything in Session is owned by the server thread.  The sink
+//  side shares only s_stream (under s_streamMutex) and counters;
+//  the main thread only the send queue (under s_sendMutex).
+// ============================================================
+
+struct Session
+{
+    bool                 used   = false;
+    uint32_t             serial = 0;   // tells a reconnect on the same slot apart
+    std::vector<uint8_t> in;    // bytes not yet parsed into frames
+    std::vector<uint8_t> out;   // responses of the current round
+
+    bool                 subscribed = false;
+    uint32_t             subId      = 0;
+    uint16_t             maxBatch   = 0;
+    uint16_t             maxDelayMs = 0;
+    OpcodeFilter         filter;
+    std::vector<uint8_t> batch;        // encoded records
+    uint16_t             batchCount = 0;
+    uint64_t             batchStart = 0;   // NowMicros() of the first record
+    uint32_t             lost       = 0;   // since the last batch
+};
+
+static IpcServer            s_server;
+static Session              s_clients[IpcServer::kMaxClients];
+static std::thread          s_thread;
+static std::atomic<bool>    s_running{ false };
+static char                 s_endpoint[128] = {};
+
+static std::mutex           s_streamMutex;
+static std::vector<uint8_t> s_stream;            // encoded records from the sink
+static std::atomic<uint32_t> s_subscribers{ 0 };
+static std::atomic<uint64_t> s_sinkLost{ 0 };
+
+static std::atomic<uint32_t> s_clientCount{ 0 };
+static std::atomic<uint64_t> s_requests{ 0 };
+static std::atomic<uint64_t> s_sent{ 0 };
+static std::atomic<uint64_t> s_streamed{ 0 };
+static std::atomic<uint64_t> s_streamDropped{ 0 };
+static std::atomic<uint64_t> s_busy{ 0 };
+static std::atomic<uint64_t> s_kicked{ 0 };
+static uint32_t              s_nextSerial = 0;   // server thread
+
+// Replay / inject requests waiting for the main thread, and the
+// responses it posts back.  An answer carries the session serial
+// so it never reaches a later client on the same slot.
+struct SendJob
+{
+    int                         client  = 0;
+    uint32_t                    serial  = 0;
+    uint16_t                    type    = 0;
+    uint32_t                    id      = 0;
+    uint16_t                    status  = Ok;   // Inject: BadRequest if a record after these was malformed
+    uint16_t                    missing = 0;    // Replay: seqs no longer stored
+    size_t                      bytes   = 0;
+    std::vector<CapturedPacket> packets;
+};
+
+struct Answer
+{
+    int                  client = 0;
+    uint32_t             serial = 0;
+    std::vector<uint8_t> frame;
+};
+
+static std::mutex           s_sendMutex;
+static std::vector<SendJob> s_sendQueue;
+static size_t               s_sendQueueBytes = 0;
+static std::vector<Answer>  s_answers;
+
+// ============================================================
+//  Capture sink  (pipeline worker)
+// ============================================================
+
+static void StreamSink(const CapturedPacket& pkt)
+{
+    if (!s_subscribers.load(std::memory_order_relaxed)) return;
+
+    const uint32_t size = static_cast<uint32_t>(pkt.payload.size());
+    std::lock_guard<std::mutex> lk(s_streamMutex);
+    if (!s_running.load(std::memory_order_relaxed)) return;
+    if (s_stream.size() + kBatchRecordSize + size > ControlServer::kMaxPendingStream)
+    {
+        s_sinkLost.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const bool wasEmpty = s_stream.empty();
+    Writer w(s_stream);
+    w.U64(pkt.seq);
+    w.U64(pkt.timestamp_us);
+    w.U32(size);
+    w.U16(pkt.opcode);
+    w.U8(static_cast<uint8_t>(pkt.direction));
+    w.U8(pkt.connection);
+    w.Bytes(pkt.payload.data(), size);
+    if (wasEmpty) s_server.Wake();
+}
+
+// ============================================================
+//  Streaming  (server thread)
+// ============================================================
+
+static void FlushBatch(Session& c)
+{
+    if (!c.batchCount && !c.lost) return;
+    Writer w(c.out);
+    w.Begin(PacketBatch, c.subId);
+    w.U16(c.batchCount);
+    w.U16(0);
+    w.U32(c.lost);
+    w.Bytes(c.batch.data(), c.batch.size());
+    w.End();
+    s_streamed.fetch_add(c.batchCount, std::memory_order_relaxed);
+    c.batch.clear();
+    c.batchCount = 0;
+    c.lost       = 0;
+}
+
+static void Distribute(const std::vector<uint8_t>& records, uint64_t sinkLost)
+{
+    for (int i = 0; i < IpcServer::kMaxClients; ++i)
+        if (s_clients[i].subscribed) s_clients[i].lost += static_cast<uint32_t>(sinkLost);
+
+    const uint64_t now = PacketCapture::NowMicros();
+    Reader r(records.data(), records.size());
+    while (r.Remaining() >= kBatchRecordSize)
+    {
+        const uint8_t* rec = r.Take(kBatchRecordSize);
+        uint32_t size;
+        uint16_t opcode;
+        memcpy(&size,   rec + 16, sizeof(size));
+        memcpy(&opcode, rec + 20, sizeof(opcode));
+        const PacketDirection dir = static_cast<PacketDirection>(rec[22] & 1);
+        const uint8_t* payload = r.Take(size);
+        if (!payload) break;
+
+        for (int i = 0; i < IpcServer::kMaxClients; ++i)
+        {
+            Session& c = s_clients[i];
+            if (!c.subscribed || !c.filter.Test(dir, opcode)) continue;
+            if (s_server.Pending(i) + c.out.size() + c.batch.size() > ControlServer::kMaxClientBacklog)
+            {
+                ++c.lost;
+                s_streamDropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (!c.batchCount) c.batchStart = now;
+            c.batch.insert(c.batch.end(), rec, rec + kBatchRecordSize);
+            c.batch.insert(c.batch.end(), payload, payload + size);
+            if (++c.batchCount >= c.maxBatch) FlushBatch(c);
+        }
+    }
+}
+
+// Milliseconds until the earliest partial batch is due (or `idle`).
+static uint32_t NextDeadline(uint32_t idle)
+{
+    const uint64_t now = PacketCapture::NowMicros();
+    uint64_t wait = static_cast<uint64_t>(idle) * 1000;
+    for (int i = 0; i < IpcServer::kMaxClients; ++i)
+    {
+        Session& c = s_clients[i];
+        if (!c.subscribed || (!c.batchCount && !c.lost)) continue;
+        const uint64_t due = c.batchStart + static_cast<uint64_t>(c.maxDelayMs) * 1000;
+        if (due <= now) return 0;
+        if (due - now < wait) wait = due - now;
+    }
+    return static_cast<uint32_t>((wait + 999) / 1000);
+}
+
+static void FlushDueBatches()
+{
+    const uint64_t now = PacketCapture::NowMicros();
+    for (int i = 0; i < IpcServer::kMaxClients; ++i)
+    {
+        Session& c = s_clients[i];
+        if (!c.subscribed || (!c.batchCount && !c.lost)) continue;
+        if (now >= c.batchStart + static_cast<uint64_t>(c.maxDelayMs) * 1000)
+            FlushBatch(c);
+    }
+}
+
+// ============================================================
+//  Requests  (server thread)
+// ============================================================
+
+static void EndSubscription(Session& c)
+{
+    if (!c.subscribed) return;
+    c.subscribed = false;
+    c.batch.clear();
+    c.batchCount = 0;
+    c.lost       = 0;
+    s_subscribers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+static void DropClient(int id)
+{
+    Session& c = s_clients[id];
+    EndSubscription(c);
+    c = Session();
+    s_server.Disconnect(id);
+    s_clientCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Unsent responses past kMaxClientPending: the client is not reading them.
+static bool OverPending(int id)
+{
+    if (s_server.Pending(id) + s_clients[id].out.size() <= ControlServer::kMaxClientPending) return false;
+    LOG_WARN(Core, "ControlServer: client %d is not reading its responses, closing", id);
+    s_kicked.fetch_add(1, std::memory_order_relaxed);
+    DropClient(id);
+    return true;
+}
+
+// Hands a replay / inject to the main thread; false when the queue is full.
+static bool QueueSend(const Session& c, SendJob&& job)
+{
+    job.client = static_cast<int>(&c - s_clients);
+    job.serial = c.serial;
+    for (const CapturedPacket& p : job.packets) job.bytes += p.payload.size();
+
+    std::lock_guard<std::mutex> lk(s_sendMutex);
+    if (s_sendQueue.size() >= ControlServer::kMaxQueuedSends ||
+        s_sendQueueBytes + job.bytes > ControlServer::kMaxQueuedBytes)
+    {
+        s_busy.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    s_sendQueueBytes += job.bytes;
+    s_sendQueue.push_back(std::move(job));
+    return true;
+}
+
+static bool ReadRules(Reader& r, std::vector<FilterRule>& rules)
+{
+    const uint16_t n = r.U16();
+    if (!r.Ok() || r.Remaining() < static_cast<size_t>(n) * kRuleSize) return false;
+    rules.resize(n);
+    for (FilterRule& rule : rules) rule = r.Rule();
+    return r.Ok();
+}
+
+static void Handle(Session& c, const FrameHeader& h, const uint8_t* body)
+{
+    static thread_local std::vector<FilterRule> rules;
+
+    s_requests.fetch_add(1, std::memory_order_relaxed);
+    Reader r(body, h.length);
+    Writer w(c.out);
+    const uint16_t type = static_cast<uint16_t>(h.type | kResponse);
+
+    switch (h.type)
+    {
+    case Hello:
+        w.Begin(type, h.id);
+        w.U16(kVersion);
+#ifdef _WIN32
+        w.U32(static_cast<uint32_t>(GetCurrentProcessId()));
+#else
+        w.U32(static_cast<uint32_t>(getpid()));
+#endif
+        w.U64(PacketCapture::LastSeq());
+        break;
+
+    case SetCaptureFilters:
+        if (!ReadRules(r, rules) || r.Remaining()) { w.Begin(type, h.id, BadRequest); break; }
+        PacketCapture::SetFilters(rules);
+        w.Begin(type, h.id);
+        w.U16(static_cast<uint16_t>(rules.size()));
+        break;
+
+    case Subscribe:
+    {
+        const uint16_t maxBatch   = r.U16();
+        const uint16_t maxDelayMs = r.U16();
+        if (!ReadRules(r, rules) || r.Remaining() || !maxBatch) { w.Begin(type, h.id, BadRequest); break; }
+        FlushBatch(c);   // a re-subscribe must not mix ids within a batch
+        if (!c.subscribed) s_subscribers.fetch_add(1, std::memory_order_relaxed);
+        c.subscribed = true;
+        c.subId      = h.id;
+        c.maxBatch   = maxBatch;
+        c.maxDelayMs = maxDelayMs;
+        c.filter     = OpcodeFilter::Compile(rules.data(), rules.size());
+        w.Begin(type, h.id);
+        w.U64(PacketCapture::LastSeq());
+        break;
+    }
+
+    case Unsubscribe:
+        FlushBatch(c);
+        EndSubscription(c);
+        w.Begin(type, h.id);
+        break;
+
+    case Replay:
+    {
+        const uint16_t n = r.U16();
+        if (!r.Ok() || r.Remaining() != static_cast<size_t>(n) * 8) { w.Begin(type, h.id, BadRequest); break; }
+        if (!PacketReplay::IsReady()) { w.Begin(type, h.id, Unavailable); break; }
+        SendJob job;
+        job.type = Replay;
+        job.id   = h.id;
+        job.packets.reserve(n);
+        for (uint16_t i = 0; i < n; ++i)
+        {
+            job.packets.emplace_back();
+            if (!PacketCapture::CopyPacket(r.U64(), job.packets.back()))
+            {
+                job.packets.pop_back();
+                ++job.missing;
+            }
+        }
+        if (!QueueSend(c, std::move(job))) { w.Begin(type, h.id, Busy); break; }
+        return;   // answered by RunQueuedSends
+    }
+
+    case Inject:
+    {
+        if (!PacketReplay::IsReady()) { w.Begin(type, h.id, Unavailable); break; }
+        const uint16_t n = r.U16();
+        SendJob job;
+        job.type = Inject;
+        job.id   = h.id;
+        for (uint16_t i = 0; i < n && r.Ok(); ++i)
+        {
+            const uint8_t  conn   = r.U8();
+            r.U8();
+            const uint16_t opcode = r.U16();
+            const uint32_t size   = r.U32();
+            const uint8_t* data   = r.Take(size);
+            if (!r.Ok()) break;
+            CapturedPacket p;
+            p.connection = conn;
+            p.direction  = PacketDirection::CMSG;
+            p.opcode     = opcode;
+            p.payload.assign(data, data + size);
+            p.size       = size;
+            job.packets.push_back(std::move(p));
+        }
+        // Records before a malformed one are still sent; the counts say so.
+        job.status = (r.Ok() && !r.Remaining()) ? Ok : BadRequest;
+        if (!QueueSend(c, std::move(job))) { w.Begin(type, h.id, Busy); break; }
+        return;   // answered by RunQueuedSends
+    }
+
+    case Stats:
+        w.Begin(type, h.id);
+        w.U64(PacketCapture::TotalCaptured());
+        w.U64(PacketCapture::TotalDropped());
+        w.U64(s_requests.load(std::memory_order_relaxed));
+        w.U64(s_streamed.load(std::memory_order_relaxed));
+        w.U64(s_streamDropped.load(std::memory_order_relaxed));
+        break;
+
+    default:
+        w.Begin(type, h.id, UnknownType);
+        break;
+    }
+    w.End();
+}
+
+// ============================================================
+//  Transport callbacks  (server thread)
+// ============================================================
+
+static void OnConnect(int id, bool connected, void*)
+{
+    Session& c = s_clients[id];
+    EndSubscription(c);
+    c = Session();
+    c.used = connected;
+    if (connected) c.serial = ++s_nextSerial;
+    if (connected) s_clientCount.fetch_add(1, std::memory_order_relaxed);
+    else           s_clientCount.fetch_sub(1, std::memory_order_relaxed);
+    LOG_DEBUG(Core, "ControlServer: client %d %s", id, connected ? "connected" : "disconnected");
+}
+
+static void OnReceive(int id, const uint8_t* data, size_t size, void*)
+{
+    Session& c = s_clients[id];
+    c.in.insert(c.in.end(), data, data + size);
+
+    size_t off = 0;
+    while (c.in.size() - off >= kHeaderSize)
+    {
+        FrameHeader h;
+        memcpy(&h, c.in.data() + off, sizeof(h));
+        if (h.length > kMaxBody)
+        {
+            LOG_WARN(Core, "ControlServer: client %d sent a %u-byte frame, closing", id, h.length);
+            DropClient(id);
+            return;
+        }
+        if (c.in.size() - off - kHeaderSize < h.length) break;
+        Handle(c, h, c.in.data() + off + kHeaderSize);
+        off += kHeaderSize + h.length;
+        if (OverPending(id)) return;
+    }
+    c.in.erase(c.in.begin(), c.in.begin() + static_cast<ptrdiff_t>(off));
+}
+
+// ============================================================
+//  Server thread
+// ============================================================
+
+static void Run()
+{
+    std::vector<uint8_t> records;
+    std::vector<Answer>  answers;
+    while (s_running.load(std::memory_order_acquire))
+    {
+        s_server.Poll(NextDeadline(100), &OnConnect, &OnReceive, nullptr);
+
+        {
+            std::lock_guard<std::mutex> lk(s_sendMutex);
+            answers.swap(s_answers);
+        }
+        for (const Answer& a : answers)
+        {
+            Session& c = s_clients[a.client];
+            if (c.used && c.serial == a.serial) c.out.insert(c.out.end(), a.frame.begin(), a.frame.end());
+        }
+        answers.clear();
+
+        {
+            std::lock_guard<std::mutex> lk(s_streamMutex);
+            records.swap(s_stream);
+        }
+        const uint64_t sinkLost = s_sinkLost.exchange(0, std::memory_order_relaxed);
+        s_streamDropped.fetch_add(sinkLost, std::memory_order_relaxed);
+        if (!records.empty() || sinkLost) Distribute(records, sinkLost);
+        records.clear();
+        FlushDueBatches();
+
+        // One write per client per round: every response and batch produced above.
+        for (int i = 0; i < IpcServer::kMaxClients; ++i)
+        {
+            Session& c = s_clients[i];
+            if (c.out.empty() || OverPending(i)) continue;
+            s_server.Send(i, c.out.data(), c.out.size());
+            c.out.clear();
+        }
+    }
+}
+
+namespace ControlServer
+{
+    bool Start(const char* endpoint)
+    {
+        if (IsRunning()) return true;
+
+        if (endpoint)
+            snprintf(s_endpoint, sizeof(s_endpoint), "%s", endpoint);
+        else
+        {
+#ifdef _WIN32
+            Ipc::DefaultEndpoint(static_cast<uint32_t>(GetCurrentProcessId()), s_endpoint, sizeof(s_endpoint));
+#else
+            Ipc::DefaultEndpoint(static_cast<uint32_t>(getpid()), s_endpoint, sizeof(s_endpoint));
+#endif
+        }
+        if (!s_server.Listen(s_endpoint))
+        {
+            LOG_WARN(Core, "ControlServer: cannot listen on %s", s_endpoint);
+            s_endpoint[0] = 0;
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(s_sendMutex);
+            s_sendQueue.clear();
+            s_sendQueueBytes = 0;
+            s_answers.clear();
+        }
+        s_running.store(true, std::memory_order_release);
+        PacketCapture::AddSink(&StreamSink);
+        s_thread = std::thread(&Run);
+        LOG_INFO(Core, "ControlServer: listening on %s", s_endpoint);
+        return true;
+    }
+
+    void Stop()
+    {
+        if (!IsRunning()) return;
+        PacketCapture::RemoveSink(&StreamSink);
+        {
+            // A sink call already in flight sees !s_running and leaves the server alone.
+            std::lock_guard<std::mutex> lk(s_streamMutex);
+            s_running.store(false, std::memory_order_release);
+            s_stream.clear();
+        }
+        s_server.Wake();
+        if (s_thread.joinable()) s_thread.join();
+
+        for (Session& c : s_clients)
+        {
+            EndSubscription(c);
+            c = Session();
+        }
+        {
+            std::lock_guard<std::mutex> lk(s_sendMutex);
+            s_sendQueue.clear();
+            s_sendQueueBytes = 0;
+            s_answers.clear();
+        }
+        s_server.Close();
+        s_clientCount = 0;
+        LOG_INFO(Core, "ControlServer: closed %s", s_endpoint);
+    }
+
+    bool IsRunning()
+    {
+        return s_running.load(std::memory_order_acquire);
+    }
+
+    void RunQueuedSends()
+    {
+        std::vector<SendJob> jobs;
+        {
+            std::lock_guard<std::mutex> lk(s_sendMutex);
+            if (s_sendQueue.empty()) return;
+            jobs.swap(s_sendQueue);
+            s_sendQueueBytes = 0;
+        }
+
+        std::vector<Answer> answers(jobs.size());
+        for (size_t j = 0; j < jobs.size(); ++j)
+        {
+            const SendJob& job = jobs[j];
+            uint16_t sent = 0;
+            for (const CapturedPacket& p : job.packets)
+            {
+                const bool ok = job.type == Replay
+                    ? PacketReplay::ReplayCaptured(p)
+                    : PacketReplay::SendTo(p.connection, p.opcode, p.payload.data(), static_cast<uint32_t>(p.payload.size()));
+                if (ok) ++sent;
+            }
+            s_sent.fetch_add(sent, std::memory_order_relaxed);
+
+            Answer& a = answers[j];
+            a.client = job.client;
+            a.serial = job.serial;
+            Writer w(a.frame);
+            w.Begin(static_cast<uint16_t>(job.type | kResponse), job.id, job.status);
+            w.U16(sent);
+            w.U16(static_cast<uint16_t>(job.packets.size() + job.missing - sent));
+            w.End();
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(s_sendMutex);
+            for (Answer& a : answers) s_answers.push_back(std::move(a));
+        }
+        if (IsRunning()) s_server.Wake();
+    }
+
+    const char* Endpoint()
+    {
+        return s_endpoint;
+    }
+
+    ControlStats Stats()
+    {
+        ControlStats st;
+        st.clients       = s_clientCount.load(std::memory_order_relaxed);
+        st.subscribers   = s_subscribers.load(std::memory_order_relaxed);
+        st.requests      = s_requests.load(std::memory_order_relaxed);
+        st.sent          = s_sent.load(std::memory_order_relaxed);
+        st.streamed      = s_streamed.load(std::memory_order_relaxed);
+        st.streamDropped = s_streamDropped.load(std::memory_order_relaxed);
+        st.busy          = s_busy.load(std::memory_order_relaxed);
+        st.kicked        = s_kicked.load(std::memory_order_relaxed);
+        return st;
+    }
+}
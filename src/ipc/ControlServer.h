@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+
+// ============================================================
+//  ControlServer — local automation endpoint
+//
+//  Exposes what the UI does (capture filters, replay, sending
+//  crafted CMSGs) plus a live packet stream over IpcTransport,
+//  speaking ControlProtocol.  One thread owns the endpoint:
+//    - requests are parsed and executed in arrival order, and all
+//      responses produced by one read leave in one write, so a
+//      client can pipeline thousands of requests per second;
+//    - stored packets reach it through a PacketCapture sink that
+//      only appends to a byte buffer (bounded; overflow is counted
+//      and reported to subscribers as lost packets);
+//    - each subscriber gets kPacketBatch frames of up to maxBatch
+//      packets, at most maxDelayMs after the first one, filtered by
+//      its own compiled OpcodeFilter.
+//
+//  Replay and inject must not call WowConnection::Send from the
+//  server thread: the server copies their packets onto a bounded
+//  queue and the game's main thread sends them from the render
+//  hook (RunQueuedSends), as the UI's replay does; the response
+//  follows once they are sent.  A full queue answers Busy.
+//
+//  A client whose unsent responses pass kMaxClientPending (it is
+//  not reading them) is disconnected.  Stop the server before the
+//  packet hooks are removed.
+// ============================================================
+
+struct ControlStats
+{
+    uint32_t clients       = 0;
+    uint32_t subscribers   = 0;
+    uint64_t requests      = 0;
+    uint64_t sent          = 0;   // replayed + injected CMSGs
+    uint64_t streamed      = 0;   // packets delivered in batches
+    uint64_t streamDropped = 0;   // lost to a full buffer or a slow client
+    uint64_t busy          = 0;   // replay / inject refused: send queue full
+    uint64_t kicked        = 0;   // clients dropped for not reading their responses
+};
+
+namespace ControlServer
+{
+    constexpr uint32_t kMaxPendingStream = 8u << 20;    // sink buffer
+    constexpr uint32_t kMaxClientBacklog = 16u << 20;   // beyond this a client's batches are dropped
+    constexpr uint32_t kMaxClientPending = 32u << 20;   // beyond this the client is disconnected
+    constexpr uint32_t kMaxQueuedSends   = 64;          // replay / inject requests awaiting the main thread
+    constexpr uint32_t kMaxQueuedBytes   = 8u << 20;    // their payload bytes
+
+    // Listen on `endpoint`, or on Ipc::DefaultEndpoint(current pid) when null.
+    bool Start(const char* endpoint = nullptr);
+    void Stop();
+    bool IsRunning();
+
+    // Sends queued replay / inject requests and posts their responses.
+    // Game main thread (render hook), once per frame; a host without
+    // the game calls it from its own loop.
+    void RunQueuedSends();
+
+    const char*  Endpoint();
+    ControlStats Stats();
+}
@@ -0,0 +1,626 @@
+#include "IpcTransport.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+void Ipc::DefaultEndpoint(uint32_t pid, char* out, size_t outSize)
+{
+#ifdef _WIN32
+    snprintf(out, outSize, "\\\\.\\pipe\\PacketGod_%u", pid);
+#else
+    snprintf(out, outSize, "/tmp/PacketGod_%u.sock", pid);
+#endif
+}
+
+#ifdef _WIN32
+
+// ============================================================
+//  Windows — overlapped named pipe instances
+//
+//  One instance is always waiting in ConnectNamedPipe; when a
+//  client arrives it becomes that client's pipe and a new
+//  instance is created.  Each client has one read and at most
+//  one write in flight; only events of operations actually in
+//  flight are waited on (they are manual-reset).
+// ============================================================
+
+struct PipeClient
+{
+    HANDLE     pipe    = INVALID_HANDLE_VALUE;
+    OVERLAPPED rd      = {};
+    OVERLAPPED wr      = {};
+    bool       reading = false;
+    bool       writing = false;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;        // queued
+    std::vector<uint8_t> inflight;   // owned by the pending WriteFile
+};
+
+struct IpcServer::Impl
+{
+    char       name[128] = {};
+    bool       listening = false;
+    HANDLE     wake      = nullptr;
+    HANDLE     next      = INVALID_HANDLE_VALUE;   // instance waiting for a client
+    OVERLAPPED connect   = {};
+    bool       connected = false;   // client arrived before ConnectNamedPipe was called
+    bool       first     = true;
+    PipeClient clients[kMaxClients];
+
+    bool NewInstance()
+    {
+        DWORD open = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED;
+        if (first) open |= FILE_FLAG_FIRST_PIPE_INSTANCE;
+        next = CreateNamedPipeA(name, open,
+                                PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                PIPE_UNLIMITED_INSTANCES, static_cast<DWORD>(kReadChunk),
+                                static_cast<DWORD>(kReadChunk), 0, nullptr);
+        if (next == INVALID_HANDLE_VALUE) return false;
+        first = false;
+
+        ResetEvent(connect.hEvent);
+        connected = false;
+        if (!ConnectNamedPipe(next, &connect))
+        {
+            const DWORD err = GetLastError();
+            if (err == ERROR_PIPE_CONNECTED)
+            {
+                connected = true;
+                SetEvent(connect.hEvent);
+            }
+            else if (err != ERROR_IO_PENDING)
+            {
+                CloseHandle(next);
+                next = INVALID_HANDLE_VALUE;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool StartRead(PipeClient& c)
+    {
+        c.in.resize(kReadChunk);
+        if (!ReadFile(c.pipe, c.in.data(), static_cast<DWORD>(c.in.size()), nullptr, &c.rd) &&
+            GetLastError() != ERROR_IO_PENDING)
+            return false;
+        c.reading = true;   // completion (even synchronous) is reported through the event
+        return true;
+    }
+
+    bool StartWrite(PipeClient& c)
+    {
+        if (c.writing || c.out.empty()) return true;
+        c.inflight.swap(c.out);
+        c.out.clear();
+        if (!WriteFile(c.pipe, c.inflight.data(), static_cast<DWORD>(c.inflight.size()), nullptr, &c.wr) &&
+            GetLastError() != ERROR_IO_PENDING)
+            return false;
+        c.writing = true;
+        return true;
+    }
+
+    void Drop(PipeClient& c)
+    {
+        if (c.pipe == INVALID_HANDLE_VALUE) return;
+        CancelIo(c.pipe);
+        DWORD n = 0;
+        if (c.reading) GetOverlappedResult(c.pipe, &c.rd, &n, TRUE);
+        if (c.writing) GetOverlappedResult(c.pipe, &c.wr, &n, TRUE);
+        DisconnectNamedPipe(c.pipe);
+        CloseHandle(c.pipe);
+        CloseHandle(c.rd.hEvent);
+        CloseHandle(c.wr.hEvent);
+        c = PipeClient();
+    }
+};
+
+IpcServer::IpcServer() : m_impl(new Impl) {}
+IpcServer::~IpcServer() { Close(); }
+
+bool IpcServer::Listen(const char* name)
+{
+    Close();
+    Impl& s = *m_impl;
+    snprintf(s.name, sizeof(s.name), "%s", name);
+    s.first          = true;
+    s.wake           = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+    s.connect.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    if (!s.wake || !s.connect.hEvent || !s.NewInstance())
+    {
+        Close();
+        return false;
+    }
+    s.listening = true;
+    return true;
+}
+
+void IpcServer::Close()
+{
+    Impl& s = *m_impl;
+    for (PipeClient& c : s.clients) s.Drop(c);
+    if (s.next != INVALID_HANDLE_VALUE)
+    {
+        CancelIo(s.next);
+        DWORD n = 0;
+        GetOverlappedResult(s.next, &s.connect, &n, TRUE);
+        CloseHandle(s.next);
+        s.next = INVALID_HANDLE_VALUE;
+    }
+    if (s.connect.hEvent) CloseHandle(s.connect.hEvent);
+    if (s.wake)           CloseHandle(s.wake);
+    s.connect   = {};
+    s.wake      = nullptr;
+    s.listening = false;
+}
+
+bool IpcServer::IsListening() const { return m_impl->listening; }
+
+void IpcServer::Poll(uint32_t timeoutMs, ConnectFn onConnect, ReceiveFn onReceive, void* user)
+{
+    Impl& s = *m_impl;
+    if (!s.listening) return;
+
+    HANDLE handles[2 + 2 * kMaxClients];
+    DWORD  n = 0;
+    handles[n++] = s.wake;
+    if (s.next != INVALID_HANDLE_VALUE) handles[n++] = s.connect.hEvent;
+    for (PipeClient& c : s.clients)
+    {
+        if (c.pipe == INVALID_HANDLE_VALUE) continue;
+        if (c.reading) handles[n++] = c.rd.hEvent;
+        if (c.writing) handles[n++] = c.wr.hEvent;
+    }
+    if (WaitForMultipleObjects(n, handles, FALSE, timeoutMs) == WAIT_TIMEOUT) return;
+
+    // New client
+    if (s.next != INVALID_HANDLE_VALUE && WaitForSingleObject(s.connect.hEvent, 0) == WAIT_OBJECT_0)
+    {
+        DWORD dummy = 0;
+        const bool ok = s.connected || GetOverlappedResult(s.next, &s.connect, &dummy, FALSE);
+        int slot = -1;
+        for (int i = 0; i < kMaxClients && slot < 0; ++i)
+            if (s.clients[i].pipe == INVALID_HANDLE_VALUE) slot = i;
+
+        if (ok && slot >= 0)
+        {
+            PipeClient& c = s.clients[slot];
+            c.pipe      = s.next;
+            c.rd.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+            c.wr.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+            s.next      = INVALID_HANDLE_VALUE;
+            if (c.rd.hEvent && c.wr.hEvent && s.StartRead(c))
+                onConnect(slot, true, user);
+            else
+                s.Drop(c);
+        }
+        else
+        {
+            DisconnectNamedPipe(s.next);
+            CloseHandle(s.next);
+            s.next = INVALID_HANDLE_VALUE;
+        }
+        s.NewInstance();
+    }
+
+    for (int i = 0; i < kMaxClients; ++i)
+    {
+        PipeClient& c = s.clients[i];
+        if (c.pipe == INVALID_HANDLE_VALUE) continue;
+        bool alive = true;
+
+        if (c.writing && WaitForSingleObject(c.wr.hEvent, 0) == WAIT_OBJECT_0)
+        {
+            DWORD written = 0;
+            alive = GetOverlappedResult(c.pipe, &c.wr, &written, FALSE) != 0;
+            c.writing = false;
+            c.inflight.clear();
+            ResetEvent(c.wr.hEvent);
+            alive = alive && s.StartWrite(c);
+        }
+        if (alive && c.reading && WaitForSingleObject(c.rd.hEvent, 0) == WAIT_OBJECT_0)
+        {
+            DWORD got = 0;
+            c.reading = false;
+            alive = GetOverlappedResult(c.pipe, &c.rd, &got, FALSE) != 0 && got > 0;
+            if (alive)
+            {
+                onReceive(i, c.in.data(), got, user);
+                // onReceive may have dropped the client
+                if (c.pipe == INVALID_HANDLE_VALUE) continue;
+                alive = s.StartRead(c);
+            }
+        }
+        if (!alive)
+        {
+            s.Drop(c);
+            onConnect(i, false, user);
+        }
+    }
+}
+
+void IpcServer::Send(int client, const uint8_t* data, size_t size)
+{
+    Impl& s = *m_impl;
+    if (client < 0 || client >= kMaxClients) return;
+    PipeClient& c = s.clients[client];
+    if (c.pipe == INVALID_HANDLE_VALUE) return;
+    c.out.insert(c.out.end(), data, data + size);
+    if (!s.StartWrite(c))
+        c.out.clear();   // broken; Poll reports the disconnect on the pending read
+}
+
+size_t IpcServer::Pending(int client) const
+{
+    if (client < 0 || client >= kMaxClients) return 0;
+    const PipeClient& c = m_impl->clients[client];
+    return c.out.size() + c.inflight.size();
+}
+
+void IpcServer::Disconnect(int client)
+{
+    if (client >= 0 && client < kMaxClients)
+        m_impl->Drop(m_impl->clients[client]);
+}
+
+void IpcServer::Wake()
+{
+    if (m_impl->wake) SetEvent(m_impl->wake);
+}
+
+// ------------------------------------------------------------
+//  Client — overlapped handle so Read and Write may overlap
+// ------------------------------------------------------------
+
+struct IpcClient::Impl
+{
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+
+    bool Wait(OVERLAPPED& ov, BOOL started, DWORD& n)
+    {
+        if (!started && GetLastError() != ERROR_IO_PENDING) return false;
+        return GetOverlappedResult(pipe, &ov, &n, TRUE) != 0;
+    }
+};
+
+IpcClient::IpcClient() : m_impl(new Impl) {}
+IpcClient::~IpcClient() { Close(); }
+
+bool IpcClient::Connect(const char* name)
+{
+    Close();
+    HANDLE h = CreateFileA(name, GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                           FILE_FLAG_OVERLAPPED, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    m_impl->pipe = h;
+    return true;
+}
+
+void IpcClient::Close()
+{
+    if (m_impl->pipe != INVALID_HANDLE_VALUE) CloseHandle(m_impl->pipe);
+    m_impl->pipe = INVALID_HANDLE_VALUE;
+}
+
+bool IpcClient::IsOpen() const { return m_impl->pipe != INVALID_HANDLE_VALUE; }
+
+bool IpcClient::Write(const void* data, size_t size)
+{
+    const auto* p = static_cast<const uint8_t*>(data);
+    OVERLAPPED ov = {};
+    ov.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    bool ok = ov.hEvent != nullptr;
+    while (ok && size)
+    {
+        DWORD n = 0;
+        ok = m_impl->Wait(ov, WriteFile(m_impl->pipe, p, static_cast<DWORD>(size), nullptr, &ov), n) && n;
+        p    += n;
+        size -= n;
+    }
+    if (ov.hEvent) CloseHandle(ov.hEvent);
+    return ok;
+}
+
+size_t IpcClient::Read(void* buf, size_t cap)
+{
+    OVERLAPPED ov = {};
+    ov.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    if (!ov.hEvent) return 0;
+    DWORD n = 0;
+    if (!m_impl->Wait(ov, ReadFile(m_impl->pipe, buf, static_cast<DWORD>(cap), nullptr, &ov), n)) n = 0;
+    CloseHandle(ov.hEvent);
+    return n;
+}
+
+#else
+
+// ============================================================
+//  POSIX — non-blocking Unix domain sockets and poll()
+// ============================================================
+
+struct SocketClient
+{
+    int                  fd = -1;
+    std::vector<uint8_t> out;
+    size_t               sent = 0;   // bytes of `out` already written
+};
+
+struct IpcServer::Impl
+{
+    int          listenFd = -1;
+    int          wake[2]  = { -1, -1 };
+    char         path[sizeof(sockaddr_un::sun_path)] = {};
+    SocketClient clients[kMaxClients];
+    std::vector<uint8_t> in;
+
+    // Write as much as the socket takes.  False if the peer is gone.
+    bool Flush(SocketClient& c)
+    {
+        while (c.sent < c.out.size())
+        {
+            const ssize_t n = send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+            if (n > 0) { c.sent += static_cast<size_t>(n); continue; }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                if (c.sent >= (1u << 20))   // a slow reader: keep only what is left
+                {
+                    c.out.erase(c.out.begin(), c.out.begin() + static_cast<ptrdiff_t>(c.sent));
+                    c.sent = 0;
+                }
+                return true;
+            }
+            return false;
+        }
+        c.out.clear();
+        c.sent = 0;
+        return true;
+    }
+
+    void Drop(SocketClient& c)
+    {
+        if (c.fd >= 0) close(c.fd);
+        c = SocketClient();
+    }
+};
+
+static void SetNonBlocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+IpcServer::IpcServer() : m_impl(new Impl) {}
+IpcServer::~IpcServer() { Close(); }
+
+bool IpcServer::Listen(const char* name)
+{
+    Close();
+    Impl& s = *m_impl;
+    if (strlen(name) >= sizeof(s.path)) return false;
+    snprintf(s.path, sizeof(s.path), "%s", name);
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, s.path, strlen(s.path) + 1);
+
+    s.listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s.listenFd < 0) return false;
+    unlink(s.path);   // stale socket of an earlier process with this pid
+    if (bind(s.listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(s.listenFd, kMaxClients) != 0 || pipe(s.wake) != 0)
+    {
+        Close();
+        return false;
+    }
+    SetNonBlocking(s.listenFd);
+    SetNonBlocking(s.wake[0]);
+    SetNonBlocking(s.wake[1]);
+    s.in.resize(kReadChunk);
+    return true;
+}
+
+void IpcServer::Close()
+{
+    Impl& s = *m_impl;
+    for (SocketClient& c : s.clients) s.Drop(c);
+    if (s.listenFd >= 0)
+    {
+        close(s.listenFd);
+        unlink(s.path);
+    }
+    for (int& fd : s.wake)
+    {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+    s.listenFd = -1;
+    s.path[0]  = 0;
+}
+
+bool IpcServer::IsListening() const { return m_impl->listenFd >= 0; }
+
+void IpcServer::Poll(uint32_t timeoutMs, ConnectFn onConnect, ReceiveFn onReceive, void* user)
+{
+    Impl& s = *m_impl;
+    if (s.listenFd < 0) return;
+
+    pollfd fds[2 + kMaxClients];
+    int    slotOf[2 + kMaxClients];
+    nfds_t n = 0;
+    fds[n] = { s.listenFd, POLLIN, 0 }; slotOf[n++] = -1;
+    fds[n] = { s.wake[0],  POLLIN, 0 }; slotOf[n++] = -1;
+    for (int i = 0; i < kMaxClients; ++i)
+    {
+        const SocketClient& c = s.clients[i];
+        if (c.fd < 0) continue;
+        fds[n] = { c.fd, static_cast<short>(POLLIN | (c.out.empty() ? 0 : POLLOUT)), 0 };
+        slotOf[n++] = i;
+    }
+    if (poll(fds, n, static_cast<int>(timeoutMs)) <= 0) return;
+
+    if (fds[1].revents & POLLIN)
+    {
+        uint8_t drain[64];
+        while (read(s.wake[0], drain, sizeof(drain)) > 0) {}
+    }
+
+    for (nfds_t k = 2; k < n; ++k)
+    {
+        const int     i = slotOf[k];
+        SocketClient& c = s.clients[i];
+        if (c.fd != fds[k].fd || !fds[k].revents) continue;
+
+        bool alive = true;
+        if (fds[k].revents & POLLOUT) alive = s.Flush(c);
+        if (alive && (fds[k].revents & (POLLIN | POLLHUP | POLLERR)))
+        {
+            for (;;)
+            {
+                const ssize_t got = recv(c.fd, s.in.data(), s.in.size(), 0);
+                if (got > 0)
+                {
+                    onReceive(i, s.in.data(), static_cast<size_t>(got), user);
+                    if (c.fd != fds[k].fd) break;   // dropped by the callback
+                    continue;
+                }
+                if (got < 0 && errno == EINTR) continue;
+                alive = got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+                break;
+            }
+            if (c.fd != fds[k].fd) continue;
+        }
+        if (!alive)
+        {
+            s.Drop(c);
+            onConnect(i, false, user);
+        }
+    }
+
+    if (fds[0].revents & POLLIN)
+    {
+        for (;;)
+        {
+            const int fd = accept(s.listenFd, nullptr, nullptr);
+            if (fd < 0) break;
+            int slot = -1;
+            for (int i = 0; i < kMaxClients && slot < 0; ++i)
+                if (s.clients[i].fd < 0) slot = i;
+            if (slot < 0) { close(fd); continue; }
+            SetNonBlocking(fd);
+            s.clients[slot].fd = fd;
+            onConnect(slot, true, user);
+        }
+    }
+}
+
+void IpcServer::Send(int client, const uint8_t* data, size_t size)
+{
+    Impl& s = *m_impl;
+    if (client < 0 || client >= kMaxClients) return;
+    SocketClient& c = s.clients[client];
+    if (c.fd < 0) return;
+    c.out.insert(c.out.end(), data, data + size);
+    if (!s.Flush(c))
+    {
+        c.out.clear();   // broken; the next Poll sees the hangup
+        c.sent = 0;
+    }
+}
+
+size_t IpcServer::Pending(int client) const
+{
+    if (client < 0 || client >= kMaxClients) return 0;
+    const SocketClient& c = m_impl->clients[client];
+    return c.out.size() - c.sent;
+}
+
+void IpcServer::Disconnect(int client)
+{
+    if (client >= 0 && client < kMaxClients)
+        m_impl->Drop(m_impl->clients[client]);
+}
+
+void IpcServer::Wake()
+{
+    const uint8_t b = 1;
+    if (m_impl->wake[1] >= 0)
+        (void)!write(m_impl->wake[1], &b, 1);
+}
+
+// ------------------------------------------------------------
+//  Client
+// ------------------------------------------------------------
+
+struct IpcClient::Impl
+{
+    int fd = -1;
+};
+
+IpcClient::IpcClient() : m_impl(new Impl) {}
+IpcClient::~IpcClient() { Close(); }
+
+bool IpcClient::Connect(const char* name)
+{
+    Close();
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (strlen(name) >= sizeof(addr.sun_path)) return false;
+    memcpy(addr.sun_path, name, strlen(name) + 1);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    m_impl->fd = fd;
+    return true;
+}
+
+void IpcClient::Close()
+{
+    if (m_impl->fd >= 0) close(m_impl->fd);
+    m_impl->fd = -1;
+}
+
+bool IpcClient::IsOpen() const { return m_impl->fd >= 0; }
+
+bool IpcClient::Write(const void* data, size_t size)
+{
+    const auto* p = static_cast<const uint8_t*>(data);
+    while (size)
+    {
+        const ssize_t n = send(m_impl->fd, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p    += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+size_t IpcClient::Read(void* buf, size_t cap)
+{
+    for (;;)
+    {
+        const ssize_t n = recv(m_impl->fd, buf, cap, 0);
+        if (n < 0 && errno == EINTR) continue;
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+}
+
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+// ============================================================
+//  IpcTransport — local byte-stream endpoint
+//
+//  Windows: overlapped named pipe "\\.\pipe\PacketGod_<pid>",
+//           remote clients rejected.
+//  POSIX:   Unix domain socket "/tmp/PacketGod_<pid>.sock".
+//
+//  IpcServer is driven by a single thread: Poll() waits for I/O
+//  on the listener and every client, then reports connects,
+//  disconnects and received bytes through plain callbacks.
+//  Send() only queues — bytes leave as the peer drains them, so
+//  a slow client never stalls the thread driving the server.
+//  Wake() interrupts Poll() from any other thread.
+//
+//  IpcClient is the blocking counterpart for tools and test
+//  harnesses; one thread may Write while another Reads.
+// ============================================================
+
+namespace Ipc
+{
+    // Endpoint of the client running as process `pid`.
+    void DefaultEndpoint(uint32_t pid, char* out, size_t outSize);
+}
+
+class IpcServer
+{
+public:
+    static constexpr int    kMaxClients = 8;
+    static constexpr size_t kReadChunk  = 64u << 10;
+
+    using ConnectFn = void(*)(int client, bool connected, void* user);
+    using ReceiveFn = void(*)(int client, const uint8_t* data, size_t size, void* user);
+
+    IpcServer();
+    ~IpcServer();
+    IpcServer(const IpcServer&) = delete;
+    IpcServer& operator=(const IpcServer&) = delete;
+
+    bool Listen(const char* name);
+    void Close();
+    bool IsListening() const;
+
+    // Waits up to timeoutMs, then dispatches every ready event.
+    void Poll(uint32_t timeoutMs, ConnectFn onConnect, ReceiveFn onReceive, void* user);
+
+    // Queue bytes for `client` (no-op if it is gone).
+    void   Send(int client, const uint8_t* data, size_t size);
+    // Bytes queued and not yet taken by the peer.
+    size_t Pending(int client) const;
+    // Drop a client; no disconnect callback is made for it.
+    void   Disconnect(int client);
+
+    void Wake();   // thread-safe
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+class IpcClient
+{
+public:
+    IpcClient();
+    ~IpcClient();
+    IpcClient(const IpcClient&) = delete;
+    IpcClient& operator=(const IpcClient&) = delete;
+
+    bool Connect(const char* name);
+    void Close();
+    bool IsOpen() const;
+
+    // Blocks until every byte is written.  False if the connection broke.
+    bool   Write(const void* data, size_t size);
+    // Blocks until some bytes arrive; 0 when the connection closed.
+    size_t Read(void* buf, size_t cap);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
@@ -0,0 +1,412 @@
+#include "ShmRing.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static_assert(offsetof(ShmRingHeader, lock) == 64 && offsetof(ShmRingHeader, head) == 72,
+              "header layout must not depend on the build's pointer size");
+
+static constexpr uint64_t kAlign = 8;
+static uint64_t RoundUp(uint64_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+void ShmRing::DefaultName(uint32_t pid, char* out, size_t outSize)
+{
+#ifdef _WIN32
+    snprintf(out, outSize, "Local\\PacketGod_%u", pid);
+#else
+    snprintf(out, outSize, "/PacketGod_%u", pid);
+#endif
+}
+
+// ============================================================
+//  SharedMemory
+// ============================================================
+
+#ifdef _WIN32
+
+bool SharedMemory::Create(const char* name, size_t bytes)
+{
+    Close();
+    const uint64_t size = bytes;
+    HANDLE h = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), name);
+    if (!h) return false;
+    // A reader may still hold the mapping of an earlier process with this
+    // pid; it is reused (and re-initialised by the writer) if big enough.
+    const bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+    void* base = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!base) { CloseHandle(h); return false; }
+    if (existed)
+    {
+        MEMORY_BASIC_INFORMATION mbi = {};
+        if (!VirtualQuery(base, &mbi, sizeof(mbi)) || mbi.RegionSize < bytes)
+        {
+            UnmapViewOfFile(base);
+            CloseHandle(h);
+            return false;
+        }
+    }
+    m_handle = h;
+    m_base   = static_cast<uint8_t*>(base);
+    m_size   = bytes;
+    m_owner  = true;
+    return true;
+}
+
+bool SharedMemory::Open(const char* name)
+{
+    Close();
+    HANDLE h = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+    if (!h) return false;
+    void* base = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!base) { CloseHandle(h); return false; }
+
+    MEMORY_BASIC_INFORMATION mbi = {};
+    VirtualQuery(base, &mbi, sizeof(mbi));
+    m_handle = h;
+    m_base   = static_cast<uint8_t*>(base);
+    m_size   = mbi.RegionSize;
+    m_owner  = false;
+    return true;
+}
+
+void SharedMemory::Close()
+{
+    if (m_base)   UnmapViewOfFile(m_base);
+    if (m_handle) CloseHandle(m_handle);
+    m_base   = nullptr;
+    m_handle = nullptr;
+    m_size   = 0;
+    m_owner  = false;
+}
+
+#else
+
+bool SharedMemory::Create(const char* name, size_t bytes)
+{
+    Close();
+    shm_unlink(name);   // a crashed writer may have left one behind
+    const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    m_fd    = fd;
+    m_base  = static_cast<uint8_t*>(base);
+    m_size  = bytes;
+    m_owner = true;
+    snprintf(m_name, sizeof(m_name), "%s", name);
+    return true;
+}
+
+bool SharedMemory::Open(const char* name)
+{
+    Close();
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+    m_fd    = fd;
+    m_base  = static_cast<uint8_t*>(base);
+    m_size  = static_cast<size_t>(st.st_size);
+    m_owner = false;
+    return true;
+}
+
+void SharedMemory::Close()
+{
+    if (m_base)  munmap(m_base, m_size);
+    if (m_fd >= 0) close(m_fd);
+    if (m_owner && m_name[0]) shm_unlink(m_name);
+    m_base    = nullptr;
+    m_fd      = -1;
+    m_size    = 0;
+    m_owner   = false;
+    m_name[0] = 0;
+}
+
+#endif
+
+// ============================================================
+//  Writer
+// ============================================================
+
+bool ShmRingWriter::Create(const char* name, uint32_t dataBytes, uint32_t writerPid)
+{
+    Close();
+    if (dataBytes < 4096 || (dataBytes & (dataBytes - 1))) return false;
+    if (!m_shm.Create(name, sizeof(ShmRingHeader) + dataBytes)) return false;
+
+    m_hdr  = new (m_shm.Data()) ShmRingHeader();
+    m_data = m_shm.Data() + sizeof(ShmRingHeader);
+    m_mask = dataBytes - 1;
+    m_head = m_tail = 0;
+    m_stats = {};
+
+    m_hdr->version     = ShmRing::kVersion;
+    m_hdr->headerBytes = sizeof(ShmRingHeader);
+    m_hdr->dataBytes   = dataBytes;
+    m_hdr->writerPid   = writerPid;
+    m_hdr->lock.store(0, std::memory_order_relaxed);
+    m_hdr->head.store(0, std::memory_order_relaxed);
+    m_hdr->tail.store(0, std::memory_order_relaxed);
+    m_hdr->records.store(0, std::memory_order_relaxed);
+    m_hdr->lastSeq.store(0, std::memory_order_relaxed);
+    m_hdr->dropped.store(0, std::memory_order_relaxed);
+    // Magic last: readers refuse a header that is not fully initialised.
+    std::atomic_thread_fence(std::memory_order_release);
+    m_hdr->magic = ShmRing::kMagic;
+    return true;
+}
+
+void ShmRingWriter::Close()
+{
+    m_hdr  = nullptr;
+    m_data = nullptr;
+    m_shm.Close();
+}
+
+void ShmRingWriter::Publish(uint64_t head, uint64_t tail, uint64_t lastSeq)
+{
+    const uint32_t s = m_hdr->lock.load(std::memory_order_relaxed);
+    m_hdr->lock.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_hdr->head.store(head, std::memory_order_relaxed);
+    m_hdr->tail.store(tail, std::memory_order_relaxed);
+    m_hdr->records.store(m_stats.records, std::memory_order_relaxed);
+    m_hdr->lastSeq.store(lastSeq, std::memory_order_relaxed);
+    m_hdr->lock.store(s + 2, std::memory_order_release);
+}
+
+bool ShmRingWriter::Append(const CapturedPacket& pkt)
+{
+    return Append(pkt.seq, pkt.timestamp_us, pkt.direction, pkt.opcode, pkt.connection,
+                  pkt.payload.data(), static_cast<uint32_t>(pkt.payload.size()), pkt.size);
+}
+
+bool ShmRingWriter::Append(uint64_t seq, uint64_t timestamp_us, PacketDirection dir, uint16_t opcode,
+                           uint8_t connection, const uint8_t* payload, uint32_t size, uint32_t wireSize)
+{
+    if (!m_hdr) return false;
+    const bool     snapped = wireSize > size;
+    const uint64_t extra   = snapped ? sizeof(wireSize) : 0;
+    const uint64_t cap = m_mask + 1;
+    const uint64_t len = RoundUp(sizeof(ShmRecord) + extra + static_cast<uint64_t>(size));
+    if (len > cap / 4)
+    {
+        ++m_stats.dropped;
+        m_hdr->dropped.store(m_stats.dropped, std::memory_order_relaxed);
+        return false;
+    }
+
+    const uint64_t off = m_head & m_mask;
+    const uint64_t pad = (off + len > cap) ? cap - off : 0;
+    const uint64_t newHead = m_head + pad + len;
+
+    // Reclaim whole records from the tail, and publish the new tail
+    // before any of their bytes are overwritten.
+    if (newHead - m_tail > cap)
+    {
+        while (newHead - m_tail > cap)
+        {
+            const uint64_t t    = m_tail & m_mask;
+            const uint64_t left = cap - t;
+            if (left < sizeof(ShmRecord)) { m_tail += left; continue; }
+            ShmRecord old;
+            memcpy(&old, m_data + t, sizeof(old));
+            m_tail += old.length;
+            if (!(old.flags & ShmRing::kRecordPad)) ++m_stats.overwritten;
+        }
+        Publish(m_head, m_tail, m_hdr->lastSeq.load(std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    if (pad >= sizeof(ShmRecord))
+    {
+        ShmRecord marker = {};
+        marker.length = static_cast<uint32_t>(pad);
+        marker.flags  = ShmRing::kRecordPad;
+        memcpy(m_data + off, &marker, sizeof(marker));
+    }
+
+    ShmRecord rec = {};
+    rec.length       = static_cast<uint32_t>(len);
+    rec.flags        = snapped ? ShmRing::kRecordSnapped : 0;
+    rec.seq          = seq;
+    rec.timestamp_us = timestamp_us;
+    rec.size         = size;
+    rec.opcode       = opcode;
+    rec.direction    = static_cast<uint8_t>(dir);
+    rec.connection   = connection;
+
+    uint8_t* dst = m_data + ((m_head + pad) & m_mask);
+    memcpy(dst, &rec, sizeof(rec));
+    if (snapped) memcpy(dst + sizeof(rec), &wireSize, sizeof(wireSize));
+    if (size) memcpy(dst + sizeof(rec) + extra, payload, size);
+
+    m_head = newHead;
+    ++m_stats.records;
+    m_stats.bytes += len;
+    Publish(m_head, m_tail, seq);
+    return true;
+}
+
+// ============================================================
+//  Reader
+// ============================================================
+
+bool ShmRingReader::Open(const char* name)
+{
+    Close();
+    if (!m_shm.Open(name)) return false;
+    if (m_shm.Size() < sizeof(ShmRingHeader)) { Close(); return false; }
+
+    const auto* hdr = reinterpret_cast<const ShmRingHeader*>(m_shm.Data());
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (hdr->magic != ShmRing::kMagic || hdr->version != ShmRing::kVersion ||
+        hdr->headerBytes != sizeof(ShmRingHeader) ||
+        m_shm.Size() < sizeof(ShmRingHeader) + static_cast<size_t>(hdr->dataBytes))
+    {
+        Close();
+        return false;
+    }
+    m_hdr  = hdr;
+    m_data = m_shm.Data() + sizeof(ShmRingHeader);
+    m_cap  = hdr->dataBytes;
+    m_stats = {};
+    SeekOldest();
+    return true;
+}
+
+void ShmRingReader::Close()
+{
+    m_hdr  = nullptr;
+    m_data = nullptr;
+    m_shm.Close();
+}
+
+ShmRingReader::HeaderSnapshot ShmRingReader::ReadHeader() const
+{
+    HeaderSnapshot s = {};
+    if (!m_hdr) return s;
+    uint32_t spins = 0;
+    std::chrono::steady_clock::time_point since;
+    for (;;)
+    {
+        const uint32_t s1 = m_hdr->lock.load(std::memory_order_acquire);
+        if (s1 & 1)
+        {
+            // Spin briefly, then yield (the writer may be preempted) until
+            // the lock has been odd for kStaleWriterMicros.
+            if (++spins < 64) continue;
+            const auto now = std::chrono::steady_clock::now();
+            if (spins == 64) since = now;
+            else if (now - since > std::chrono::microseconds(ShmRing::kStaleWriterMicros))
+            {
+                s.stale = true;
+                return s;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        s.head    = m_hdr->head.load(std::memory_order_relaxed);
+        s.tail    = m_hdr->tail.load(std::memory_order_relaxed);
+        s.records = m_hdr->records.load(std::memory_order_relaxed);
+        s.lastSeq = m_hdr->lastSeq.load(std::memory_order_relaxed);
+        s.dropped = m_hdr->dropped.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_hdr->lock.load(std::memory_order_relaxed) == s1) return s;
+    }
+}
+
+void ShmRingReader::SeekOldest() { m_pos = ReadHeader().tail; }
+void ShmRingReader::SeekNewest() { m_pos = ReadHeader().head; }
+
+bool ShmRingReader::Validate(const ShmPacketView& view)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_hdr && m_hdr->tail.load(std::memory_order_relaxed) <= view.pos) return true;
+    ++m_stats.torn;
+    return false;
+}
+
+bool ShmRingReader::Next(ShmPacketView& out)
+{
+    if (!m_hdr) return false;
+    for (;;)
+    {
+        const HeaderSnapshot s = ReadHeader();
+        if (s.stale) { ++m_stats.stale; return false; }
+        if (m_pos < s.tail)
+        {
+            ++m_stats.overruns;
+            m_stats.lostBytes += s.tail - m_pos;
+            m_pos = s.tail;
+        }
+        if (m_pos >= s.head) return false;
+
+        const uint64_t off  = m_pos & (m_cap - 1);
+        const uint64_t left = m_cap - off;
+        if (left < sizeof(ShmRecord)) { m_pos += left; continue; }
+
+        ShmRecord rec;
+        memcpy(&rec, m_data + off, sizeof(rec));
+        ShmPacketView probe;
+        probe.pos = m_pos;
+        if (!Validate(probe)) continue;   // lapped while copying the header
+
+        if (rec.length < sizeof(ShmRecord) || rec.length > left || (rec.length & (kAlign - 1)))
+        {
+            m_pos = s.head;               // cannot happen with an intact header; resync
+            continue;
+        }
+        if (rec.flags & ShmRing::kRecordPad) { m_pos += rec.length; continue; }
+
+        const uint64_t extra = (rec.flags & ShmRing::kRecordSnapped) ? sizeof(uint32_t) : 0;
+        if (sizeof(ShmRecord) + extra + rec.size > rec.length)
+        {
+            m_pos = s.head;               // as above
+            continue;
+        }
+        out.pos      = m_pos;
+        out.rec      = rec;
+        out.wireSize = rec.size;
+        if (extra) memcpy(&out.wireSize, m_data + off + sizeof(ShmRecord), sizeof(out.wireSize));
+        out.payload  = m_data + off + sizeof(ShmRecord) + extra;
+        m_pos += rec.length;
+        ++m_stats.read;
+        return true;
+    }
+}
@@ -0,0 +1,212 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "../wow/WowTypes.h"
+
+// ============================================================
+//  ShmRing — capture ring in named shared memory
+//
+//  One writer (the DLL's pipeline worker) appends every stored
+//  packet; any number of reader processes tail it.  The layout
+//  uses fixed-width fields only, so a 64-bit analyzer reads what
+//  the 32-bit game process wrote.
+//
+//  Mapping:  [ShmRingHeader, 128 bytes] [data, dataBytes (2^n)]
+//  Record:   [ShmRecord, 32 bytes] [payload] padded to 8 bytes.
+//            kRecordSnapped: [4] wire size sits between the header
+//            and the payload (the packet was stored truncated).
+//            A record never wraps; the tail of the data area is
+//            skipped with a pad record, or implicitly when fewer
+//            than sizeof(ShmRecord) bytes are left.
+//
+//  Positions are monotonic byte counts.  The header publishes
+//  head (end of the newest record) and tail (start of the oldest
+//  one still intact) under a seqlock.  The writer never waits:
+//  when the ring is full it moves tail forward past old records,
+//  publishes that, and only then overwrites them.
+//
+//  Readers keep their own position and read payloads in place.
+//  A view is only trustworthy if Validate() still holds after
+//  the reader is done with it (tail has not passed it) — the
+//  seqlock rule applied per record.  A reader that falls behind
+//  skips to tail and counts the gap.  A writer that dies while
+//  publishing leaves the seqlock odd; readers give up on it after
+//  kStaleWriterMicros instead of spinning forever.
+// ============================================================
+
+namespace ShmRing
+{
+    constexpr uint32_t kMagic   = 0x52534750;   // "PGSR"
+    constexpr uint16_t kVersion = 2;
+
+    constexpr uint32_t kRecordPad     = 0x1;    // ShmRecord::flags
+    constexpr uint32_t kRecordSnapped = 0x2;
+
+    // A publish is a handful of stores; an odd lock held this long
+    // belongs to a writer that died (or is frozen) mid-publish.
+    constexpr uint32_t kStaleWriterMicros = 100000;
+
+    // Platform name for the ring of process `pid`
+    // (Windows "Local\PacketGod_<pid>", POSIX "/PacketGod_<pid>").
+    void DefaultName(uint32_t pid, char* out, size_t outSize);
+}
+
+struct alignas(8) ShmRecord
+{
+    uint32_t length;        // record bytes including this header and padding
+    uint32_t flags;         // kRecordPad: skip `length` bytes
+    uint64_t seq;           // PacketCapture seq
+    uint64_t timestamp_us;
+    uint32_t size;          // payload bytes stored
+    uint16_t opcode;
+    uint8_t  direction;     // PacketDirection
+    uint8_t  connection;
+};
+static_assert(sizeof(ShmRecord) == 32, "record header layout is shared across processes");
+
+struct alignas(64) ShmRingHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerBytes;
+    uint32_t dataBytes;
+    uint32_t writerPid;
+    uint8_t  _pad0[48];
+
+    // Seqlock-protected — odd `lock` while the writer updates the fields below.
+    std::atomic<uint32_t> lock;
+    uint32_t              _pad1;
+    std::atomic<uint64_t> head;       // bytes written
+    std::atomic<uint64_t> tail;       // oldest intact byte
+    std::atomic<uint64_t> records;    // records appended
+    std::atomic<uint64_t> lastSeq;    // seq of the newest record
+    std::atomic<uint64_t> dropped;    // payloads too large for the ring
+    uint8_t               _pad2[16];
+};
+static_assert(sizeof(ShmRingHeader) == 128, "header layout is shared across processes");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock-free");
+
+// ============================================================
+//  SharedMemory — named mapping (CreateFileMapping / shm_open)
+// ============================================================
+
+class SharedMemory
+{
+public:
+    SharedMemory() = default;
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+    ~SharedMemory() { Close(); }
+
+    bool Create(const char* name, size_t bytes);   // replaces (POSIX) or reuses (Win32) a stale mapping
+    bool Open(const char* name);                   // read-write view of an existing mapping
+    void Close();                                  // creator also unlinks the name (POSIX)
+
+    uint8_t* Data() const { return m_base; }
+    size_t   Size() const { return m_size; }
+
+private:
+    uint8_t* m_base  = nullptr;
+    size_t   m_size  = 0;
+    bool     m_owner = false;
+#ifdef _WIN32
+    void*    m_handle = nullptr;
+#else
+    int      m_fd = -1;
+    char     m_name[64] = {};
+#endif
+};
+
+// ============================================================
+//  Writer  (single thread)
+// ============================================================
+
+struct ShmWriterStats
+{
+    uint64_t records     = 0;
+    uint64_t bytes       = 0;   // record bytes written
+    uint64_t overwritten = 0;   // records reclaimed before every reader may have seen them
+    uint64_t dropped     = 0;   // larger than a quarter of the ring
+};
+
+class ShmRingWriter
+{
+public:
+    bool Create(const char* name, uint32_t dataBytes, uint32_t writerPid);
+    void Close();
+    bool IsOpen() const { return m_hdr != nullptr; }
+
+    // Never blocks; reclaims the oldest records when full.
+    bool Append(const CapturedPacket& pkt);
+    // `wireSize` > `size`: the payload was kept truncated (0 = size).
+    bool Append(uint64_t seq, uint64_t timestamp_us, PacketDirection dir, uint16_t opcode,
+                uint8_t connection, const uint8_t* payload, uint32_t size, uint32_t wireSize = 0);
+
+    ShmWriterStats Stats() const { return m_stats; }
+
+private:
+    void Publish(uint64_t head, uint64_t tail, uint64_t lastSeq);
+
+    SharedMemory   m_shm;
+    ShmRingHeader* m_hdr  = nullptr;
+    uint8_t*       m_data = nullptr;
+    uint64_t       m_mask = 0;
+    uint64_t       m_head = 0;
+    uint64_t       m_tail = 0;
+    ShmWriterStats m_stats;
+};
+
+// ============================================================
+//  Reader  (any process, any number)
+// ============================================================
+
+struct ShmPacketView
+{
+    uint64_t         pos = 0;          // ring position of the record (for Validate)
+    ShmRecord        rec = {};         // copied header
+    uint32_t         wireSize = 0;     // payload bytes on the wire (>= rec.size)
+    const uint8_t*   payload = nullptr;   // points into shared memory
+};
+
+struct ShmReaderStats
+{
+    uint64_t read     = 0;
+    uint64_t overruns = 0;   // times the writer lapped this reader
+    uint64_t lostBytes = 0;  // ring bytes skipped because of overruns
+    uint64_t torn     = 0;   // views that failed Validate()
+    uint64_t stale    = 0;   // Next() calls refused: writer stuck mid-publish
+};
+
+class ShmRingReader
+{
+public:
+    bool Open(const char* name);
+    void Close();
+    bool IsOpen() const { return m_hdr != nullptr; }
+
+    // Start at the oldest intact record (default) or at the newest position.
+    void SeekOldest();
+    void SeekNewest();
+
+    // Next record, or false when caught up.  The view points into the ring.
+    bool Next(ShmPacketView& out);
+    // True if the writer has not reclaimed the view's bytes.  Call after use.
+    bool Validate(const ShmPacketView& view);
+
+    // Consistent header snapshot (seqlock read).  `stale`: the lock stayed
+    // odd for kStaleWriterMicros; the other fields are not to be trusted.
+    struct HeaderSnapshot { uint64_t head, tail, records, lastSeq, dropped; bool stale; };
+    HeaderSnapshot ReadHeader() const;
+
+    uint32_t       WriterPid() const { return m_hdr ? m_hdr->writerPid : 0; }
+    ShmReaderStats Stats() const { return m_stats; }
+
+private:
+    SharedMemory         m_shm;
+    const ShmRingHeader* m_hdr  = nullptr;
+    const uint8_t*       m_data = nullptr;
+    uint64_t             m_cap  = 0;
+    uint64_t             m_pos  = 0;
+    ShmReaderStats       m_stats;
+};
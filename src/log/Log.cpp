@@ -0,0 +1,419 @@
+#include "Log.h"
+#include <cstdio>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <condition_variable>
+
+using LogClock = std::chrono::steady_clock;
+
+// ============================================================
+//  Per-thread rings
+//
+//  Single producer (the owning thread), single consumer (the
+//  writer).  Positions are monotonic byte counts; a record never
+//  wraps — the tail of the ring is skipped instead, marked by a
+//  zero length when at least two bytes are left.
+// ============================================================
+
+namespace
+{
+    constexpr size_t kRingMask = Log::kRingBytes - 1;
+    static_assert((Log::kRingBytes & kRingMask) == 0, "ring size must be a power of two");
+
+    struct ThreadRing
+    {
+        uint8_t               data[Log::kRingBytes];
+        std::atomic<uint64_t> head{ 0 };        // written by the owner
+        std::atomic<uint64_t> tail{ 0 };        // written by the writer thread
+        std::atomic<bool>     retired{ false }; // owner thread exited
+    };
+
+    struct RingOwner
+    {
+        ThreadRing* ring = nullptr;
+        ~RingOwner() { if (ring) ring->retired.store(true, std::memory_order_release); }
+    };
+
+    std::mutex               s_registryMutex;
+    std::vector<ThreadRing*> s_rings;
+    thread_local RingOwner   t_owner;
+
+    std::atomic<uint64_t> s_dropped{ 0 };
+    std::atomic<uint64_t> s_truncated{ 0 };
+    std::atomic<uint64_t> s_written{ 0 };
+
+    // Writer state
+    std::mutex              s_wakeMutex;
+    std::condition_variable s_wakeCv;
+    std::thread             s_writer;
+    std::atomic<bool>       s_running{ false };
+    bool                    s_flushRequested = false;
+    FILE*                   s_file = nullptr;
+    LogClock::rep           s_epoch = 0;
+
+    constexpr auto kWriterTick = std::chrono::milliseconds(5);
+
+    ThreadRing* RegisterThread()
+    {
+        ThreadRing* r = new ThreadRing();
+        {
+            std::lock_guard<std::mutex> lk(s_registryMutex);
+            s_rings.push_back(r);
+        }
+        t_owner.ring = r;
+        return r;
+    }
+}
+
+// ============================================================
+//  Producer side
+// ============================================================
+
+void Log::EncodeString(uint8_t* rec, size_t& n, const char* s)
+{
+    if (!s) s = "(null)";
+    size_t len = strlen(s);
+    size_t room = (n + 3 < kMaxRecord) ? kMaxRecord - n - 3 : 0;
+    if (room > kMaxString) room = kMaxString;
+    if (len > room)
+    {
+        len = room;
+        s_truncated.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    rec[n++] = TagStr;
+    const uint16_t l16 = static_cast<uint16_t>(len);
+    memcpy(rec + n, &l16, 2);
+    memcpy(rec + n + 2, s, len);
+    n += 2 + len;
+}
+
+void Log::Commit(LogLevel level, LogCategory cat, const char* fmt, uint8_t argc, uint8_t* rec, size_t n)
+{
+    const uint16_t total = static_cast<uint16_t>(n);
+    const int64_t  ts    = LogClock::now().time_since_epoch().count();
+    memcpy(rec, &total, 2);
+    rec[2] = static_cast<uint8_t>(level);
+    rec[3] = static_cast<uint8_t>(cat);
+    rec[4] = argc;
+    rec[5] = rec[6] = rec[7] = 0;
+    const uint64_t fmtBits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(fmt));
+    memcpy(rec + 8, &fmtBits, 8);
+    memcpy(rec + 16, &ts, 8);
+
+    ThreadRing* r = t_owner.ring ? t_owner.ring : RegisterThread();
+    const uint64_t head = r->head.load(std::memory_order_relaxed);
+    const uint64_t tail = r->tail.load(std::memory_order_acquire);
+    const size_t   off  = static_cast<size_t>(head & kRingMask);
+    const size_t   skip = (off + n > kRingBytes) ? kRingBytes - off : 0;
+
+    if (head + skip + n - tail > kRingBytes)
+    {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (skip >= 2)
+        r->data[off] = r->data[off + 1] = 0;
+    memcpy(&r->data[(head + skip) & kRingMask], rec, n);
+    r->head.store(head + skip + n, std::memory_order_release);
+}
+
+// ============================================================
+//  Formatting  (writer thread)
+// ============================================================
+
+namespace
+{
+    struct ArgReader
+    {
+        const uint8_t* p;
+        const uint8_t* end;
+        unsigned       left;
+
+        bool Next(uint8_t& tag, uint64_t& bits, const char*& str, uint16_t& len)
+        {
+            if (!left || p >= end) return false;
+            --left;
+            tag = *p++;
+            if ((tag & 0x0F) == Log::TagStr)
+            {
+                memcpy(&len, p, 2);
+                str = reinterpret_cast<const char*>(p + 2);
+                p += 2 + len;
+            }
+            else
+            {
+                memcpy(&bits, p, 8);
+                p += 8;
+            }
+            return true;
+        }
+    };
+
+    // Sign-correct value of an integer argument narrowed back to its source width.
+    uint64_t Narrow(uint8_t tag, uint64_t bits)
+    {
+        const unsigned size = tag >> 4;
+        return (size && size < 8) ? bits & ((1ULL << (size * 8)) - 1) : bits;
+    }
+
+    void Format(const char* fmt, ArgReader args, std::string& out)
+    {
+        char buf[512];
+        for (const char* p = fmt; *p; )
+        {
+            if (*p != '%') { out += *p++; continue; }
+            if (p[1] == '%') { out += '%'; p += 2; continue; }
+
+            // %[flags][width][.precision][length]conv — length is re-derived from the stored type.
+            std::string spec = "%";
+            ++p;
+            while (*p && strchr("-+ #0", *p)) spec += *p++;
+            while (isdigit(static_cast<unsigned char>(*p))) spec += *p++;
+            if (*p == '.')
+            {
+                spec += *p++;
+                while (isdigit(static_cast<unsigned char>(*p))) spec += *p++;
+            }
+            while (*p && strchr("hlLqjzt", *p)) ++p;
+            if (p[0] == 'I' && ((p[1] == '6' && p[2] == '4') || (p[1] == '3' && p[2] == '2'))) p += 3;
+            const char conv = *p;
+            if (!conv) break;
+            ++p;
+
+            uint8_t tag; uint64_t bits = 0; const char* str = nullptr; uint16_t len = 0;
+            if (!args.Next(tag, bits, str, len))
+            {
+                out += "<missing>";
+                continue;
+            }
+            const uint8_t kind = tag & 0x0F;
+
+            buf[0] = 0;
+            switch (conv)
+            {
+            case 'd': case 'i':
+                if (kind == Log::TagInt || kind == Log::TagUInt)
+                    snprintf(buf, sizeof(buf), (spec + "lld").c_str(), static_cast<long long>(bits));
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                if (kind == Log::TagInt || kind == Log::TagUInt)
+                    snprintf(buf, sizeof(buf), (spec + "ll" + conv).c_str(),
+                             static_cast<unsigned long long>(Narrow(tag, bits)));
+                break;
+            case 'c':
+                if (kind == Log::TagInt || kind == Log::TagUInt)
+                    snprintf(buf, sizeof(buf), (spec + 'c').c_str(), static_cast<int>(bits));
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                if (kind == Log::TagDouble)
+                {
+                    double d;
+                    memcpy(&d, &bits, 8);
+                    snprintf(buf, sizeof(buf), (spec + conv).c_str(), d);
+                }
+                break;
+            case 'p':
+                if (kind == Log::TagPtr || kind == Log::TagUInt)
+                    snprintf(buf, sizeof(buf), (spec + 'p').c_str(), reinterpret_cast<void*>(static_cast<uintptr_t>(bits)));
+                break;
+            case 's':
+                if (kind == Log::TagStr)
+                {
+                    if (spec.size() == 1)
+                        out.append(str, len);
+                    else
+                    {
+                        snprintf(buf, sizeof(buf), (spec + 's').c_str(), std::string(str, len).c_str());
+                        out += buf;
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+            }
+            out += buf[0] ? buf : "<?>";
+        }
+    }
+
+    struct Pending
+    {
+        int64_t ts;
+        size_t  offset;   // into the batch arena
+    };
+
+    std::vector<uint8_t> s_arena;
+    std::vector<Pending> s_batch;
+    std::string          s_text;
+
+    // Copy every committed record out of every ring; free rings of exited threads.
+    void Collect()
+    {
+        std::lock_guard<std::mutex> lk(s_registryMutex);
+        for (size_t i = 0; i < s_rings.size(); )
+        {
+            ThreadRing* r = s_rings[i];
+            const bool     retired = r->retired.load(std::memory_order_acquire);
+            const uint64_t head    = r->head.load(std::memory_order_acquire);
+            uint64_t       tail    = r->tail.load(std::memory_order_relaxed);
+
+            while (tail < head)
+            {
+                const size_t off  = static_cast<size_t>(tail & kRingMask);
+                const size_t left = Log::kRingBytes - off;
+                uint16_t total = 0;
+                if (left >= 2) memcpy(&total, &r->data[off], 2);
+                if (left < 2 || total == 0)
+                {
+                    tail += left;   // wrap marker
+                    continue;
+                }
+
+                int64_t ts;
+                memcpy(&ts, &r->data[off + 16], 8);
+                s_batch.push_back({ ts, s_arena.size() });
+                s_arena.insert(s_arena.end(), &r->data[off], &r->data[off] + total);
+                tail += total;
+            }
+            r->tail.store(tail, std::memory_order_release);
+
+            if (retired && tail == r->head.load(std::memory_order_acquire))
+            {
+                delete r;
+                s_rings.erase(s_rings.begin() + static_cast<ptrdiff_t>(i));
+                continue;
+            }
+            ++i;
+        }
+    }
+
+    void WriteBatch()
+    {
+        s_arena.clear();
+        s_batch.clear();
+        Collect();
+        if (s_batch.empty() || !s_file) return;
+
+        std::stable_sort(s_batch.begin(), s_batch.end(),
+                         [](const Pending& a, const Pending& b) { return a.ts < b.ts; });
+
+        s_text.clear();
+        for (const Pending& pd : s_batch)
+        {
+            const uint8_t* rec = &s_arena[pd.offset];
+            uint16_t total;
+            uint64_t fmtBits;
+            memcpy(&total, rec, 2);
+            memcpy(&fmtBits, rec + 8, 8);
+
+            const double secs = std::chrono::duration<double>(LogClock::duration(pd.ts - s_epoch)).count();
+            char prefix[64];
+            snprintf(prefix, sizeof(prefix), "[%11.6f] %-5s %-8s ", secs,
+                     Log::LevelName(static_cast<LogLevel>(rec[2])),
+                     Log::CategoryName(static_cast<LogCategory>(rec[3])));
+            s_text += prefix;
+
+            ArgReader args{ rec + 24, rec + total, rec[4] };
+            Format(reinterpret_cast<const char*>(static_cast<uintptr_t>(fmtBits)), args, s_text);
+            s_text += '\n';
+        }
+
+        fwrite(s_text.data(), 1, s_text.size(), s_file);
+        fflush(s_file);
+        s_written.fetch_add(s_batch.size(), std::memory_order_relaxed);
+    }
+
+    void WriterMain()
+    {
+        while (s_running.load())
+        {
+            {
+                std::unique_lock<std::mutex> lk(s_wakeMutex);
+                s_wakeCv.wait_for(lk, kWriterTick, [] { return s_flushRequested || !s_running.load(); });
+                s_flushRequested = false;
+            }
+            WriteBatch();
+        }
+        WriteBatch();
+    }
+}
+
+// ============================================================
+//  Lifetime / control
+// ============================================================
+
+bool Log::Start(const char* path)
+{
+    if (s_running.load()) return true;
+    s_file = fopen(path, "w");
+    if (!s_file) return false;
+
+    s_epoch = LogClock::now().time_since_epoch().count();
+    fprintf(s_file, "========== PacketGod session ==========\n");
+    fflush(s_file);
+
+    s_running.store(true);
+    s_writer = std::thread(&WriterMain);
+    return true;
+}
+
+void Log::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(s_wakeMutex);
+        s_running.store(false);
+    }
+    s_wakeCv.notify_all();
+    if (s_writer.joinable()) s_writer.join();
+    if (s_file)
+    {
+        fclose(s_file);
+        s_file = nullptr;
+    }
+}
+
+void Log::Flush()
+{
+    {
+        std::lock_guard<std::mutex> lk(s_wakeMutex);
+        s_flushRequested = true;
+    }
+    s_wakeCv.notify_one();
+}
+
+void Log::SetCategoryEnabled(LogCategory cat, bool on)
+{
+    const uint32_t bit = 1u << static_cast<unsigned>(cat);
+    if (on) s_categoryMask.fetch_or(bit, std::memory_order_relaxed);
+    else    s_categoryMask.fetch_and(~bit, std::memory_order_relaxed);
+}
+
+const char* Log::LevelName(LogLevel level)
+{
+    static const char* kNames[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+    const auto i = static_cast<size_t>(level);
+    return i < 4 ? kNames[i] : "?";
+}
+
+const char* Log::CategoryName(LogCategory cat)
+{
+    static const char* kNames[] = { "Core", "Hooks", "D3D", "Capture", "Analysis", "UI" };
+    const auto i = static_cast<size_t>(cat);
+    return i < static_cast<size_t>(LogCategory::Count) ? kNames[i] : "?";
+}
+
+LogStats Log::Stats()
+{
+    LogStats st;
+    st.written   = s_written.load();
+    st.dropped   = s_dropped.load();
+    st.truncated = s_truncated.load();
+    std::lock_guard<std::mutex> lk(s_registryMutex);
+    st.threads = static_cast<uint32_t>(s_rings.size());
+    return st;
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+
+// ============================================================
+//  Log — asynchronous binary logger
+//
+//  LOG_INFO(Hooks, "Add %s va=0x%08X => %d", name, va, st);
+//
+//  The caller never formats or touches a file.  It appends one
+//  compact record to its own thread's ring:
+//    [2] total  [1] level  [1] category  [1] argc  [3] 0
+//    [8] format pointer  [8] timestamp (steady ticks)
+//    argc × { [1] tag | size << 4, [8] value | [2] len + bytes }
+//  The format string must be a literal: only its pointer is kept.
+//  String arguments are copied (truncated to kMaxString).
+//
+//  A background thread drains every thread's ring every few ms,
+//  orders the batch by timestamp, formats it and writes it with
+//  one fflush per batch.  A full ring drops the record (counted);
+//  callers never block.
+//
+//  Levels below PACKETGOD_LOG_LEVEL are compiled out entirely
+//  (default: Debug kept in debug builds, stripped with NDEBUG).
+//  Above that, SetMinLevel / SetCategoryEnabled filter at run
+//  time before any argument is encoded.
+// ============================================================
+
+enum class LogLevel : uint8_t
+{
+    Debug = 0,
+    Info  = 1,
+    Warn  = 2,
+    Error = 3,
+};
+
+enum class LogCategory : uint8_t
+{
+    Core     = 0,   // boot / shutdown sequence
+    Hooks    = 1,   // MinHook management + packet detours
+    D3D      = 2,   // Present/Reset hooks, ImGui lifetime
+    Capture  = 3,   // pipeline, store, inflate
+    Analysis = 4,   // decoders, world state
+    UI       = 5,
+    Count
+};
+
+#ifndef PACKETGOD_LOG_LEVEL
+#  ifdef NDEBUG
+#    define PACKETGOD_LOG_LEVEL 1
+#  else
+#    define PACKETGOD_LOG_LEVEL 0
+#  endif
+#endif
+
+#define PG_LOG_AT(lvl, cat, ...)                                                 \
+    do {                                                                         \
+        if (Log::Enabled(LogLevel::lvl, LogCategory::cat))                       \
+            Log::Write(LogLevel::lvl, LogCategory::cat, __VA_ARGS__);            \
+    } while (0)
+
+#if PACKETGOD_LOG_LEVEL <= 0
+#  define LOG_DEBUG(cat, ...) PG_LOG_AT(Debug, cat, __VA_ARGS__)
+#else
+#  define LOG_DEBUG(cat, ...) ((void)0)
+#endif
+#define LOG_INFO(cat, ...)  PG_LOG_AT(Info,  cat, __VA_ARGS__)
+#define LOG_WARN(cat, ...)  PG_LOG_AT(Warn,  cat, __VA_ARGS__)
+#define LOG_ERROR(cat, ...) PG_LOG_AT(Error, cat, __VA_ARGS__)
+
+struct LogStats
+{
+    uint64_t written   = 0;   // records formatted to the file
+    uint64_t dropped   = 0;   // ring full
+    uint64_t truncated = 0;   // string argument cut to kMaxString
+    uint32_t threads   = 0;   // rings registered
+};
+
+class Log
+{
+public:
+    static constexpr size_t kRingBytes   = 64u << 10;   // per thread
+    static constexpr size_t kMaxRecord   = 1024;
+    static constexpr size_t kMaxString   = 256;
+    static constexpr size_t kMaxArgs     = 16;
+
+    // Opens (truncates) the log file and starts the writer thread.
+    static bool Start(const char* path);
+    // Drains everything already logged, then closes the file.
+    static void Stop();
+    // Ask the writer to drain now instead of at its next tick.
+    static void Flush();
+
+    static void SetMinLevel(LogLevel level) { s_minLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+    static LogLevel MinLevel() { return static_cast<LogLevel>(s_minLevel.load(std::memory_order_relaxed)); }
+    static void SetCategoryEnabled(LogCategory cat, bool on);
+    static bool CategoryEnabled(LogCategory cat)
+    {
+        return (s_categoryMask.load(std::memory_order_relaxed) >> static_cast<unsigned>(cat)) & 1u;
+    }
+
+    static bool Enabled(LogLevel level, LogCategory cat)
+    {
+        return static_cast<uint8_t>(level) >= s_minLevel.load(std::memory_order_relaxed) && CategoryEnabled(cat);
+    }
+
+    static const char* LevelName(LogLevel level);
+    static const char* CategoryName(LogCategory cat);
+
+    static LogStats Stats();
+
+    template <typename... Args>
+    static void Write(LogLevel level, LogCategory cat, const char* fmt, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= kMaxArgs, "too many log arguments");
+        uint8_t rec[kMaxRecord + kMaxArgs * 9];   // strings stop at kMaxRecord; scalars fit the tail
+        size_t  n = kHeaderSize;
+        (Encode(rec, n, args), ...);
+        Commit(level, cat, fmt, static_cast<uint8_t>(sizeof...(Args)), rec, n);
+    }
+
+    // Argument tags —————————————————————————————————————————————
+    enum ArgTag : uint8_t { TagInt, TagUInt, TagDouble, TagPtr, TagStr };
+
+private:
+    static constexpr size_t kHeaderSize = 24;
+
+    static void Put(uint8_t* rec, size_t& n, uint8_t tag, const void* v, size_t len)
+    {
+        rec[n++] = tag;
+        memcpy(rec + n, v, len);
+        n += len;
+    }
+
+    template <typename T>
+    static void Encode(uint8_t* rec, size_t& n, const T& v)
+    {
+        if constexpr (std::is_enum_v<T>)
+            Encode(rec, n, static_cast<std::underlying_type_t<T>>(v));
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            const double d = static_cast<double>(v);
+            Put(rec, n, TagDouble, &d, 8);
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            const int64_t i = static_cast<int64_t>(v);
+            Put(rec, n, static_cast<uint8_t>(TagInt | (sizeof(T) << 4)), &i, 8);   // size lets %x print -1 as ffffffff
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            const uint64_t u = static_cast<uint64_t>(v);
+            Put(rec, n, static_cast<uint8_t>(TagUInt | (sizeof(T) << 4)), &u, 8);
+        }
+        else if constexpr (std::is_pointer_v<T> || std::is_array_v<T> || std::is_null_pointer_v<T>)
+        {
+            using Elem = std::remove_cv_t<std::remove_pointer_t<std::decay_t<T>>>;
+            if constexpr (std::is_same_v<Elem, char>)
+                EncodeString(rec, n, v);
+            else
+            {
+                const uint64_t p = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(static_cast<const void*>(v)));
+                Put(rec, n, TagPtr, &p, 8);
+            }
+        }
+        else
+            static_assert(std::is_pointer_v<T>, "unsupported log argument type");
+    }
+
+    static void EncodeString(uint8_t* rec, size_t& n, const char* s);
+    static void Commit(LogLevel level, LogCategory cat, const char* fmt, uint8_t argc,
+                       uint8_t* rec, size_t n);
+
+    static inline std::atomic<uint8_t>  s_minLevel{ static_cast<uint8_t>(LogLevel::Debug) };
+    static inline std::atomic<uint32_t> s_categoryMask{ 0xFFFFFFFFu };
+};
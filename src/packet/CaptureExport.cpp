@@ -0,0 +1,627 @@
+#include "CaptureExport.h"
+#include "Opcodes.h"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+static constexpr uint32_t kColumnsMagic = 0x4C434750;   // "PGCL"
+
+const char* ExportFormatExtension(ExportFormat format)
+{
+    switch (format)
+    {
+    case ExportFormat::Csv:       return "csv";
+    case ExportFormat::JsonLines: return "jsonl";
+    case ExportFormat::Columns:   return "pgcol";
+    }
+    return "";
+}
+
+// ============================================================
+//  Field formatting — raw writes into a buffer sized for the
+//  worst case, so no per-field bounds checks or allocation
+// ============================================================
+
+static const char kHexPairs[] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+static const char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static char* PutU64(char* p, uint64_t v)
+{
+    char tmp[20];
+    int  n = 0;
+    do { tmp[n++] = static_cast<char>('0' + v % 10); v /= 10; } while (v);
+    while (n) *p++ = tmp[--n];
+    return p;
+}
+
+static char* PutStr(char* p, const char* s, size_t n)
+{
+    memcpy(p, s, n);
+    return p + n;
+}
+
+template <size_t N>
+static char* PutLit(char* p, const char (&s)[N]) { return PutStr(p, s, N - 1); }
+
+static char* PutHex(char* p, const uint8_t* d, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        memcpy(p, &kHexPairs[d[i] * 2], 2);
+        p += 2;
+    }
+    return p;
+}
+
+static char* PutBase64(char* p, const uint8_t* d, size_t n)
+{
+    size_t i = 0;
+    for (; i + 3 <= n; i += 3)
+    {
+        const uint32_t v = (d[i] << 16) | (d[i + 1] << 8) | d[i + 2];
+        p[0] = kBase64[v >> 18];
+        p[1] = kBase64[(v >> 12) & 63];
+        p[2] = kBase64[(v >> 6) & 63];
+        p[3] = kBase64[v & 63];
+        p += 4;
+    }
+    if (n - i == 1)
+    {
+        const uint32_t v = d[i] << 16;
+        p[0] = kBase64[v >> 18];
+        p[1] = kBase64[(v >> 12) & 63];
+        p[2] = p[3] = '=';
+        p += 4;
+    }
+    else if (n - i == 2)
+    {
+        const uint32_t v = (d[i] << 16) | (d[i + 1] << 8);
+        p[0] = kBase64[v >> 18];
+        p[1] = kBase64[(v >> 12) & 63];
+        p[2] = kBase64[(v >> 6) & 63];
+        p[3] = '=';
+        p += 4;
+    }
+    return p;
+}
+
+static size_t EncodedSize(PayloadEncoding enc, size_t n)
+{
+    switch (enc)
+    {
+    case PayloadEncoding::Hex:    return n * 2;
+    case PayloadEncoding::Base64: return (n + 2) / 3 * 4;
+    default:                      return 0;
+    }
+}
+
+static char* PutPayload(char* p, PayloadEncoding enc, const uint8_t* d, size_t n)
+{
+    if (enc == PayloadEncoding::Hex)    return PutHex(p, d, n);
+    if (enc == PayloadEncoding::Base64) return PutBase64(p, d, n);
+    return p;
+}
+
+// Rows are CapturedPacket (owned / caller's) or SharedPacket (shared blocks).
+static const uint8_t* StoredData(const CapturedPacket& r) { return r.payload.data(); }
+static uint32_t       StoredSize(const CapturedPacket& r) { return static_cast<uint32_t>(r.payload.size()); }
+static const uint8_t* StoredData(const SharedPacket& r)   { return r.payload.Data(); }
+static uint32_t       StoredSize(const SharedPacket& r)   { return r.payload.Size(); }
+
+// Longest line without the payload: 3 x u64 + 4 x u32-ish numbers,
+// the opcode name and the JSON keys.
+static constexpr size_t kLineOverhead = 256;
+
+template <typename Row>
+static void FormatText(const Row* rows, size_t count, ExportFormat fmt, PayloadEncoding enc,
+                       std::string& out)
+{
+    size_t bound = 0;
+    for (size_t i = 0; i < count; ++i)
+        bound += kLineOverhead + EncodedSize(enc, StoredSize(rows[i]));
+    out.resize(bound);
+
+    char* const base = &out[0];
+    char*       p    = base;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Row&  r    = rows[i];
+        const char* name = OpcodeToString(r.opcode);
+        const char* dir  = r.direction == PacketDirection::SMSG ? "SMSG" : "CMSG";
+
+        if (fmt == ExportFormat::Csv)
+        {
+            p = PutU64(p, r.seq);          *p++ = ',';
+            p = PutU64(p, r.timestamp_us); *p++ = ',';
+            p = PutU64(p, r.connection);   *p++ = ',';
+            p = PutStr(p, dir, 4);         *p++ = ',';
+            p = PutU64(p, r.opcode);       *p++ = ',';
+            p = PutStr(p, name, strlen(name)); *p++ = ',';
+            p = PutU64(p, r.size);         *p++ = ',';
+            p = PutU64(p, StoredSize(r));
+            if (enc != PayloadEncoding::None)
+            {
+                *p++ = ',';
+                p = PutPayload(p, enc, StoredData(r), StoredSize(r));
+            }
+        }
+        else
+        {
+            p = PutLit(p, "{\"seq\":");           p = PutU64(p, r.seq);
+            p = PutLit(p, ",\"timestamp_us\":");  p = PutU64(p, r.timestamp_us);
+            p = PutLit(p, ",\"connection\":");    p = PutU64(p, r.connection);
+            p = PutLit(p, ",\"direction\":\"");   p = PutStr(p, dir, 4);
+            p = PutLit(p, "\",\"opcode\":");      p = PutU64(p, r.opcode);
+            p = PutLit(p, ",\"name\":\"");        p = PutStr(p, name, strlen(name));
+            p = PutLit(p, "\",\"size\":");        p = PutU64(p, r.size);
+            p = PutLit(p, ",\"stored\":");        p = PutU64(p, StoredSize(r));
+            if (enc != PayloadEncoding::None)
+            {
+                p = PutLit(p, ",\"payload\":\"");
+                p = PutPayload(p, enc, StoredData(r), StoredSize(r));
+                *p++ = '"';
+            }
+            *p++ = '}';
+        }
+        *p++ = '\n';
+    }
+    out.resize(static_cast<size_t>(p - base));
+}
+
+// ============================================================
+//  Columns
+// ============================================================
+
+struct ColumnDef
+{
+    char        type;
+    const char* name;
+};
+
+static const ColumnDef kColumns[] = {
+    { 'Q', "seq" },
+    { 'Q', "timestamp_us" },
+    { 'I', "size" },
+    { 'I', "stored" },
+    { 'D', "opcode" },
+    { 'B', "direction" },
+    { 'B', "connection" },
+};
+static constexpr size_t kColumnCount = sizeof(kColumns) / sizeof(kColumns[0]);
+static constexpr size_t kRowBytes    = 8 + 8 + 4 + 4 + 2 + 1 + 1;
+static constexpr size_t kOpcodeAt    = 8 + 8 + 4 + 4;   // opcode column offset, in bytes per row
+
+template <typename T, typename Row, typename Get>
+static uint8_t* PutColumn(uint8_t* p, const Row* rows, size_t n, Get get)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const T v = get(rows[i]);
+        memcpy(p, &v, sizeof(T));
+        p += sizeof(T);
+    }
+    return p;
+}
+
+// Opcodes are written raw; Flush() swaps in dictionary codes, in file order.
+template <typename Row>
+static void FormatColumns(const Row* rows, size_t n, std::string& out)
+{
+    out.resize(4 + n * kRowBytes);
+    uint8_t* p = reinterpret_cast<uint8_t*>(&out[0]);
+    const uint32_t rowCount = static_cast<uint32_t>(n);
+    memcpy(p, &rowCount, 4);
+    p += 4;
+    p = PutColumn<uint64_t>(p, rows, n, [](const Row& r) { return r.seq; });
+    p = PutColumn<uint64_t>(p, rows, n, [](const Row& r) { return r.timestamp_us; });
+    p = PutColumn<uint32_t>(p, rows, n, [](const Row& r) { return r.size; });
+    p = PutColumn<uint32_t>(p, rows, n, [](const Row& r) { return StoredSize(r); });
+    p = PutColumn<uint16_t>(p, rows, n, [](const Row& r) { return r.opcode; });
+    p = PutColumn<uint8_t>(p, rows, n, [](const Row& r) { return static_cast<uint8_t>(r.direction); });
+    PutColumn<uint8_t>(p, rows, n, [](const Row& r) { return r.connection; });
+}
+
+// ============================================================
+//  Exporter
+// ============================================================
+
+bool CaptureExporter::Open(const char* path, const ExportOptions& options)
+{
+    Close();
+    m_file = fopen(path, "wb");
+    if (!m_file) return false;
+
+    m_opt = options;
+    if (m_opt.chunkRows == 0) m_opt.chunkRows = 8192;
+    if (m_opt.threads == 0)   m_opt.threads = (std::max)(1u, std::thread::hardware_concurrency());
+    m_ok = true;
+    m_rows = m_bytes = 0;
+    m_submitted = m_taken = m_flushed = 0;
+    m_stop = false;
+    m_groups = 0;
+    m_dictCode.assign(0x10000, 0);
+    m_dictOpcodes.clear();
+
+    // Ring of two chunks per worker (one without workers), plus the fill chunk.
+    m_chunks.assign(m_opt.threads > 1 ? m_opt.threads * 2 + 1 : 2, Chunk{});
+    if (m_opt.threads > 1)
+        for (unsigned t = 0; t < m_opt.threads; ++t)
+            m_workers.emplace_back(&CaptureExporter::WorkerMain, this);
+
+    switch (m_opt.format)
+    {
+    case ExportFormat::Csv:
+    {
+        static const char kHeader[] = "seq,timestamp_us,connection,direction,opcode,name,size,stored";
+        WriteBytes(kHeader, sizeof(kHeader) - 1);
+        if (m_opt.payload != PayloadEncoding::None) WriteBytes(",payload", 8);
+        WriteBytes("\n", 1);
+        break;
+    }
+    case ExportFormat::Columns:
+    {
+        const uint16_t version = kColumnsVersion;
+        const uint16_t columns = static_cast<uint16_t>(kColumnCount);
+        WriteBytes(&kColumnsMagic, 4);
+        WriteBytes(&version, 2);
+        WriteBytes(&columns, 2);
+        for (const ColumnDef& c : kColumns)
+        {
+            const uint8_t len = static_cast<uint8_t>(strlen(c.name));
+            WriteBytes(&c.type, 1);
+            WriteBytes(&len, 1);
+            WriteBytes(c.name, len);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return m_ok;
+}
+
+void CaptureExporter::WriteBytes(const void* data, size_t size)
+{
+    if (m_ok && size && fwrite(data, 1, size, m_file) != size) m_ok = false;
+    m_bytes += size;
+}
+
+void CaptureExporter::Format(Chunk& c) const
+{
+    if (m_opt.format == ExportFormat::Columns)
+    {
+        if (c.shared) FormatColumns(c.shared, c.count, c.out);
+        else          FormatColumns(c.rows, c.count, c.out);
+    }
+    else if (c.shared)
+        FormatText(c.shared, c.count, m_opt.format, m_opt.payload, c.out);
+    else
+        FormatText(c.rows, c.count, m_opt.format, m_opt.payload, c.out);
+}
+
+void CaptureExporter::WorkerMain()
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    for (;;)
+    {
+        m_workCv.wait(lk, [this] { return m_stop || m_taken < m_submitted; });
+        if (m_taken == m_submitted) return;   // stopping, nothing left
+
+        Chunk& c = m_chunks[m_taken++ % Ring()];
+        lk.unlock();
+        Format(c);
+        lk.lock();
+        c.done = true;
+        m_doneCv.notify_all();
+    }
+}
+
+// Writer side, in submission order.
+void CaptureExporter::Flush(Chunk& c)
+{
+    if (m_opt.format == ExportFormat::Columns)
+    {
+        uint8_t* col = reinterpret_cast<uint8_t*>(&c.out[0]) + 4 + c.count * kOpcodeAt;
+        for (size_t i = 0; i < c.count; ++i, col += 2)
+        {
+            uint16_t op;
+            memcpy(&op, col, 2);
+            uint16_t& code = m_dictCode[op];
+            if (!code)
+            {
+                m_dictOpcodes.push_back(op);
+                code = static_cast<uint16_t>(m_dictOpcodes.size());
+            }
+            const uint16_t v = static_cast<uint16_t>(code - 1);
+            memcpy(col, &v, 2);
+        }
+        ++m_groups;
+    }
+    WriteBytes(c.out.data(), c.out.size());
+    m_rows += c.count;
+
+    c.owned.clear();
+    c.ownedShared.clear();   // drops the block references
+    c.rows   = nullptr;
+    c.shared = nullptr;
+    c.count  = 0;
+    c.done  = false;
+}
+
+// Writes out the oldest chunk in flight once a worker has finished it.
+void CaptureExporter::FlushOldest(std::unique_lock<std::mutex>& lk)
+{
+    Chunk& oldest = m_chunks[m_flushed % Ring()];
+    m_doneCv.wait(lk, [&] { return oldest.done; });
+    lk.unlock();
+    Flush(oldest);
+    lk.lock();
+    ++m_flushed;
+}
+
+// ============================================================
+//  Chunks in
+//
+//  Ring slots are m_chunks[0 .. Ring()); the last element is the
+//  fill chunk Write() collects rows in.  A full fill chunk trades
+//  its vector with the ring slot it is submitted in, so rows are
+//  moved once and vectors are recycled.  It holds one kind of row
+//  at a time; switching kinds submits what it has.
+//
+//  Without workers the single ring slot is formatted and flushed
+//  on the spot.
+// ============================================================
+
+CaptureExporter::Chunk& CaptureExporter::Reserve()
+{
+    if (!m_workers.empty())
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        if (m_submitted - m_flushed == Ring())
+            FlushOldest(lk);
+    }
+    return m_chunks[m_submitted % Ring()];
+}
+
+void CaptureExporter::Publish(Chunk& c)
+{
+    if (m_workers.empty())
+    {
+        Format(c);
+        Flush(c);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        ++m_submitted;
+    }
+    m_workCv.notify_one();
+}
+
+void CaptureExporter::SubmitOwned()
+{
+    Chunk& fill = m_chunks.back();
+    if (fill.owned.empty() && fill.ownedShared.empty()) return;
+
+    Chunk& slot = Reserve();
+    if (!fill.owned.empty())
+    {
+        slot.owned.swap(fill.owned);   // fill gets the slot's emptied vector back
+        slot.rows  = slot.owned.data();
+        slot.count = slot.owned.size();
+    }
+    else
+    {
+        slot.ownedShared.swap(fill.ownedShared);
+        slot.shared = slot.ownedShared.data();
+        slot.count  = slot.ownedShared.size();
+    }
+    Publish(slot);
+}
+
+void CaptureExporter::Write(const CapturedPacket& pkt)
+{
+    CapturedPacket copy = pkt;
+    Write(std::move(copy));
+}
+
+void CaptureExporter::Write(CapturedPacket&& pkt)
+{
+    if (!m_file) return;
+    if (!m_chunks.back().ownedShared.empty()) SubmitOwned();
+    Chunk& fill = m_chunks.back();
+    fill.owned.push_back(std::move(pkt));
+    if (fill.owned.size() >= m_opt.chunkRows)
+        SubmitOwned();
+}
+
+void CaptureExporter::Write(const SharedPacket& pkt)
+{
+    if (!m_file) return;
+    if (!m_chunks.back().owned.empty()) SubmitOwned();
+    Chunk& fill = m_chunks.back();
+    fill.ownedShared.push_back(pkt);
+    if (fill.ownedShared.size() >= m_opt.chunkRows)
+        SubmitOwned();
+}
+
+template <typename Row>
+void CaptureExporter::SubmitRange(const Row* rows, size_t count)
+{
+    if (!m_file) return;
+    SubmitOwned();
+    for (size_t i = 0; i < count; i += m_opt.chunkRows)
+    {
+        Chunk& slot = Reserve();
+        if constexpr (std::is_same_v<Row, SharedPacket>) slot.shared = rows + i;
+        else                                             slot.rows   = rows + i;
+        slot.count = (std::min)(static_cast<size_t>(m_opt.chunkRows), count - i);
+        Publish(slot);
+    }
+}
+
+void CaptureExporter::WriteRange(const CapturedPacket* rows, size_t count)
+{
+    SubmitRange(rows, count);
+}
+
+void CaptureExporter::WriteRange(const SharedPacket* rows, size_t count)
+{
+    SubmitRange(rows, count);
+}
+
+bool CaptureExporter::Close()
+{
+    if (!m_file) return m_ok;
+
+    SubmitOwned();
+    if (!m_workers.empty())
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (m_flushed < m_submitted)
+            FlushOldest(lk);
+        m_stop = true;
+        lk.unlock();
+        m_workCv.notify_all();
+        for (auto& t : m_workers) t.join();
+        m_workers.clear();
+    }
+
+    if (m_opt.format == ExportFormat::Columns)
+    {
+        const uint64_t footerAt = m_bytes;
+        const uint32_t entries  = static_cast<uint32_t>(m_dictOpcodes.size());
+        WriteBytes(&entries, 4);
+        for (uint16_t op : m_dictOpcodes)
+        {
+            const char*   name = OpcodeToString(op);
+            const uint8_t len  = static_cast<uint8_t>(strlen(name));
+            WriteBytes(&op, 2);
+            WriteBytes(&len, 1);
+            WriteBytes(name, len);
+        }
+        WriteBytes(&m_rows, 8);
+        WriteBytes(&m_groups, 4);
+        WriteBytes(&footerAt, 8);
+        WriteBytes(&kColumnsMagic, 4);
+    }
+
+    if (fclose(m_file) != 0) m_ok = false;
+    m_file = nullptr;
+    m_chunks.clear();
+    return m_ok;
+}
+
+template <typename Row>
+static bool ExportRows(const char* path, const std::vector<Row>& packets, const ExportOptions& options,
+                       uint64_t* bytesOut)
+{
+    CaptureExporter ex;
+    if (!ex.Open(path, options)) return false;
+    ex.WriteRange(packets.data(), packets.size());
+    const bool ok = ex.Close();
+    if (bytesOut) *bytesOut = ex.Bytes();
+    return ok;
+}
+
+bool ExportCapture(const char* path, const std::vector<CapturedPacket>& packets, const ExportOptions& options,
+                   uint64_t* bytesOut)
+{
+    return ExportRows(path, packets, options, bytesOut);
+}
+
+bool ExportCapture(const char* path, const std::vector<SharedPacket>& packets, const ExportOptions& options,
+                   uint64_t* bytesOut)
+{
+    return ExportRows(path, packets, options, bytesOut);
+}
+
+// ============================================================
+//  Reading columns back
+// ============================================================
+
+template <typename T>
+static bool ReadColumn(FILE* f, std::vector<T>& col, uint32_t rows)
+{
+    const size_t at = col.size();
+    col.resize(at + rows);
+    return fread(col.data() + at, sizeof(T), rows, f) == rows;
+}
+
+bool LoadColumns(const char* path, ColumnTable& out)
+{
+    out = ColumnTable{};
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+
+    bool ok = false;
+    do
+    {
+        uint32_t magic = 0;
+        uint16_t version = 0, columns = 0;
+        if (fread(&magic, 4, 1, f) != 1 || magic != kColumnsMagic) break;
+        if (fread(&version, 2, 1, f) != 1 || version != CaptureExporter::kColumnsVersion) break;
+        if (fread(&columns, 2, 1, f) != 1 || columns != kColumnCount) break;
+
+        bool schema = true;
+        for (const ColumnDef& c : kColumns)
+        {
+            char    type = 0, name[256];
+            uint8_t len  = 0;
+            schema = schema && fread(&type, 1, 1, f) == 1 && fread(&len, 1, 1, f) == 1 &&
+                     fread(name, 1, len, f) == len && type == c.type &&
+                     len == strlen(c.name) && memcmp(name, c.name, len) == 0;
+        }
+        if (!schema) break;
+
+        // Footer first: it says how many groups follow the header.
+        const long groupsAt = ftell(f);
+        uint64_t rows = 0, footerAt = 0;
+        uint32_t groups = 0;
+        if (fseek(f, -24, SEEK_END) != 0 || fread(&rows, 8, 1, f) != 1 || fread(&groups, 4, 1, f) != 1 ||
+            fread(&footerAt, 8, 1, f) != 1 || fread(&magic, 4, 1, f) != 1 || magic != kColumnsMagic)
+            break;
+
+        if (fseek(f, static_cast<long>(footerAt), SEEK_SET) != 0) break;
+        uint32_t entries = 0;
+        if (fread(&entries, 4, 1, f) != 1 || entries > 0x10000) break;
+        bool dict = true;
+        for (uint32_t e = 0; e < entries && dict; ++e)
+        {
+            uint16_t op = 0;
+            uint8_t  len = 0;
+            char     name[256];
+            dict = fread(&op, 2, 1, f) == 1 && fread(&len, 1, 1, f) == 1 && fread(name, 1, len, f) == len;
+            out.dictOpcode.push_back(op);
+            out.dictName.emplace_back(name, len);
+        }
+        if (!dict) break;
+
+        if (fseek(f, groupsAt, SEEK_SET) != 0) break;
+        bool body = true;
+        for (uint32_t g = 0; g < groups && body; ++g)
+        {
+            uint32_t n = 0;
+            body = fread(&n, 4, 1, f) == 1 &&
+                   ReadColumn(f, out.seq, n) && ReadColumn(f, out.timestamp_us, n) &&
+                   ReadColumn(f, out.size, n) && ReadColumn(f, out.stored, n) &&
+                   ReadColumn(f, out.opcode, n) && ReadColumn(f, out.direction, n) &&
+                   ReadColumn(f, out.connection, n);
+        }
+        ok = body && out.seq.size() == rows && static_cast<uint64_t>(ftell(f)) == footerAt;
+        for (uint16_t code : out.opcode)
+            ok = ok && code < entries;
+    } while (false);
+
+    fclose(f);
+    return ok;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../wow/WowTypes.h"
+#include "SharedPacket.h"
+
+// ============================================================
+//  CaptureExport — captures as CSV, JSON Lines or columns
+//
+//  Text formats, one packet per line, fields in this order:
+//    seq, timestamp_us, connection, direction (CMSG / SMSG),
+//    opcode (decimal), name, size (wire payload bytes),
+//    stored (payload bytes kept), payload (hex / base64 / absent)
+//  CSV has a header line; no field ever needs quoting.
+//
+//  Columnar (.pgcol), little-endian, metadata only:
+//    header  [4] "PGCL"  [2] version  [2] column count
+//            per column: [1] type  [1] name length  [n] name
+//              type is the numpy / struct letter: B H I Q (u8..u64),
+//              'D' = u16 code into the footer dictionary
+//    groups  [4] rows, then each column's values for those rows,
+//            column after column
+//    footer  [4] entries, each [2] opcode  [1] length  [n] name
+//            [8] rows  [4] groups  [8] footer offset  [4] "PGCL"
+//  Dictionary codes follow first appearance in the file.
+//
+//  Rows are formatted in chunks by a worker pool and written in
+//  order by the thread calling Write / Close; at most two chunks
+//  per worker are in flight, so memory stays bounded whatever the
+//  capture size.
+// ============================================================
+
+enum class ExportFormat : uint8_t { Csv, JsonLines, Columns };
+enum class PayloadEncoding : uint8_t { None, Hex, Base64 };
+
+const char* ExportFormatExtension(ExportFormat format);   // "csv", "jsonl", "pgcol"
+
+struct ExportOptions
+{
+    ExportFormat    format    = ExportFormat::Csv;
+    PayloadEncoding payload   = PayloadEncoding::Hex;   // text formats only
+    unsigned        threads   = 0;                      // 0 = all cores, 1 = inline
+    uint32_t        chunkRows = 8192;
+};
+
+class CaptureExporter
+{
+public:
+    static constexpr uint16_t kColumnsVersion = 1;
+
+    ~CaptureExporter() { Close(); }
+
+    bool Open(const char* path, const ExportOptions& options);
+    void Write(const CapturedPacket& pkt);
+    void Write(CapturedPacket&& pkt);
+    void Write(const SharedPacket& pkt);   // keeps a reference, no byte copy
+    // Formats `rows` in place: they must stay unchanged until Close().
+    void WriteRange(const CapturedPacket* rows, size_t count);
+    void WriteRange(const SharedPacket* rows, size_t count);
+    bool Close();   // false if any write failed
+
+    uint64_t Rows()  const { return m_rows; }
+    uint64_t Bytes() const { return m_bytes; }   // written to the file
+
+private:
+    struct Chunk
+    {
+        std::vector<CapturedPacket> owned;
+        std::vector<SharedPacket>   ownedShared;
+        const CapturedPacket*       rows   = nullptr;   // owned.data(), or the caller's array
+        const SharedPacket*         shared = nullptr;   // ownedShared.data(), or the caller's array
+        size_t                      count  = 0;
+        std::string                 out;
+        bool                        done   = false;
+    };
+
+    size_t Ring() const { return m_chunks.size() - 1; }
+    Chunk& Reserve();
+    void   Publish(Chunk& c);
+    void   SubmitOwned();
+    template <typename Row>
+    void   SubmitRange(const Row* rows, size_t count);
+    void   Format(Chunk& c) const;
+    void   Flush(Chunk& c);
+    void   FlushOldest(std::unique_lock<std::mutex>& lk);
+    void   WorkerMain();
+    void   WriteBytes(const void* data, size_t size);
+
+    FILE*         m_file = nullptr;
+    bool          m_ok   = true;
+    ExportOptions m_opt;
+    uint64_t      m_rows  = 0;
+    uint64_t      m_bytes = 0;
+
+    // Chunk ring: [m_flushed, m_submitted) in flight, workers take
+    // m_taken; m_chunks.back() is the fill chunk for Write().
+    std::vector<Chunk>       m_chunks;
+    uint64_t                 m_submitted = 0;
+    uint64_t                 m_taken     = 0;
+    uint64_t                 m_flushed   = 0;
+    std::vector<std::thread> m_workers;
+    std::mutex               m_mutex;
+    std::condition_variable  m_workCv;
+    std::condition_variable  m_doneCv;
+    bool                     m_stop = false;
+
+    // Columns: opcode → dictionary code + 1 (0 = not yet seen)
+    std::vector<uint16_t>    m_dictCode;
+    std::vector<uint16_t>    m_dictOpcodes;
+    uint32_t                 m_groups = 0;
+};
+
+// Whole capture in one call; rows are formatted in place (no copy).
+// `bytesOut` receives the file size.
+bool ExportCapture(const char* path, const std::vector<CapturedPacket>& packets, const ExportOptions& options,
+                   uint64_t* bytesOut = nullptr);
+bool ExportCapture(const char* path, const std::vector<SharedPacket>& packets, const ExportOptions& options,
+                   uint64_t* bytesOut = nullptr);
+
+// .pgcol read back, one vector per column.
+struct ColumnTable
+{
+    std::vector<uint64_t>    seq;
+    std::vector<uint64_t>    timestamp_us;
+    std::vector<uint32_t>    size;
+    std::vector<uint32_t>    stored;
+    std::vector<uint16_t>    opcode;       // dictionary codes
+    std::vector<uint8_t>     direction;
+    std::vector<uint8_t>     connection;
+    std::vector<uint16_t>    dictOpcode;   // code → opcode
+    std::vector<std::string> dictName;     // code → name
+};
+
+bool LoadColumns(const char* path, ColumnTable& out);
@@ -0,0 +1,189 @@
+#include "CaptureFile.h"
+#include "PacketPipeline.h"
+#include <algorithm>
+
+struct FileHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+};
+static_assert(sizeof(FileHeader) == 8, "file header is written as-is");
+
+// ============================================================
+//  Writer
+// ============================================================
+
+bool CaptureWriter::Open(const char* path, bool deltaMovement)
+{
+    Close();
+    m_file  = fopen(path, "wb");
+    m_ok    = m_file != nullptr;
+    m_count = 0;
+    m_delta = deltaMovement;
+    m_codec.Reset();
+    if (!m_file) return false;
+
+    const FileHeader hdr = { CaptureFile::kMagic, CaptureFile::kVersion, 0 };
+    m_ok = fwrite(&hdr, sizeof(hdr), 1, m_file) == 1;
+    return m_ok;
+}
+
+bool CaptureWriter::Write(PacketDirection dir, uint16_t opcode, uint64_t timestamp_us,
+                          const uint8_t* payload, uint32_t size, uint8_t connection, uint32_t wireSize)
+{
+    if (!m_file) return false;
+
+    // Readers refuse larger records; keep the head, like a snapped packet.
+    if (payload && size > PacketPipeline::kMaxPayload)
+    {
+        wireSize = (std::max)(wireSize, size);
+        size     = PacketPipeline::kMaxPayload;
+    }
+
+    CaptureFile::Record rec;
+    rec.timestamp_us = timestamp_us;
+    rec.size         = payload ? size : 0;
+    rec.opcode       = opcode;
+    rec.direction    = dir;
+    rec.connection   = connection;
+
+    m_encoded.clear();
+    if (m_delta && m_codec.Encode(connection, dir, opcode, payload, rec.size, m_encoded))
+    {
+        rec.size      = static_cast<uint32_t>(m_encoded.size());
+        rec.direction = static_cast<PacketDirection>(static_cast<uint8_t>(dir) | CaptureFile::kMovementDelta);
+        payload       = m_encoded.data();
+    }
+
+    const bool snapped = wireSize > (payload ? size : 0);
+    if (snapped)
+        rec.direction = static_cast<PacketDirection>(static_cast<uint8_t>(rec.direction) | CaptureFile::kWireSize);
+
+    bool ok = fwrite(&rec, sizeof(rec), 1, m_file) == 1;
+    if (ok && snapped)
+        ok = fwrite(&wireSize, sizeof(wireSize), 1, m_file) == 1;
+    if (ok && rec.size)
+        ok = fwrite(payload, rec.size, 1, m_file) == 1;
+    m_ok &= ok;
+    if (ok) ++m_count;
+    return ok;
+}
+
+bool CaptureWriter::Write(const CapturedPacket& pkt)
+{
+    return Write(pkt.direction, pkt.opcode, pkt.timestamp_us,
+                 pkt.payload.data(), static_cast<uint32_t>(pkt.payload.size()), pkt.connection, pkt.size);
+}
+
+bool CaptureWriter::Close()
+{
+    if (!m_file) return m_ok;
+    m_ok &= fclose(m_file) == 0;
+    m_file = nullptr;
+    return m_ok;
+}
+
+// ============================================================
+//  Reader
+// ============================================================
+
+bool CaptureReader::Open(const char* path)
+{
+    Close();
+    m_file = fopen(path, "rb");
+    if (!m_file) return false;
+
+#ifdef _WIN32
+    const bool sized = _fseeki64(m_file, 0, SEEK_END) == 0;
+    const int64_t end = sized ? _ftelli64(m_file) : -1;
+    const bool rewound = _fseeki64(m_file, 0, SEEK_SET) == 0;
+#else
+    const bool sized = fseeko(m_file, 0, SEEK_END) == 0;
+    const int64_t end = sized ? static_cast<int64_t>(ftello(m_file)) : -1;
+    const bool rewound = fseeko(m_file, 0, SEEK_SET) == 0;
+#endif
+    m_left = end > 0 ? static_cast<uint64_t>(end) : 0;
+
+    FileHeader hdr;
+    if (!rewound || !Read(&hdr, sizeof(hdr)) ||
+        hdr.magic != CaptureFile::kMagic || hdr.version < 1 || hdr.version > CaptureFile::kVersion)
+    {
+        Close();
+        return false;
+    }
+    m_codec.Reset();
+    return true;
+}
+
+bool CaptureReader::Read(void* dst, uint64_t size)
+{
+    if (size > m_left || fread(dst, static_cast<size_t>(size), 1, m_file) != 1) return false;
+    m_left -= size;
+    return true;
+}
+
+bool CaptureReader::Next(CapturedPacket& out)
+{
+    if (!m_file) return false;
+
+    CaptureFile::Record rec;
+    if (!Read(&rec, sizeof(rec))) return false;
+
+    const uint8_t dir = static_cast<uint8_t>(rec.direction);
+    out.seq          = 0;
+    out.connection   = rec.connection;
+    out.direction    = static_cast<PacketDirection>(dir & 1);
+    out.opcode       = rec.opcode;
+    out.timestamp_us = rec.timestamp_us;
+    out.inflated.reset();
+
+    uint32_t wireSize = 0;
+    if ((dir & CaptureFile::kWireSize) && !Read(&wireSize, sizeof(wireSize))) return false;
+
+    // The size field is not trusted: a corrupt record must not make
+    // us allocate more than the pipeline would ever have stored.
+    if (rec.size > PacketPipeline::kMaxPayload || rec.size > m_left) return false;
+    std::vector<uint8_t>& body = (dir & CaptureFile::kMovementDelta) ? m_encoded : out.payload;
+    body.resize(rec.size);
+    if (rec.size && !Read(body.data(), rec.size)) return false;
+    if ((dir & CaptureFile::kMovementDelta) &&
+        !m_codec.Decode(rec.connection, out.direction, rec.opcode, m_encoded.data(), rec.size, out.payload))
+        return false;
+    out.size = (std::max)(wireSize, static_cast<uint32_t>(out.payload.size()));
+    return true;
+}
+
+void CaptureReader::Close()
+{
+    if (m_file) fclose(m_file);
+    m_file = nullptr;
+    m_left = 0;
+}
+
+// ============================================================
+//  Whole-file helpers
+// ============================================================
+
+bool CaptureFile::Save(const char* path, const std::vector<CapturedPacket>& packets)
+{
+    CaptureWriter w;
+    if (!w.Open(path)) return false;
+    for (const auto& pkt : packets)
+        w.Write(pkt);
+    return w.Close();
+}
+
+bool CaptureFile::Load(const char* path, std::vector<CapturedPacket>& out)
+{
+    CaptureReader r;
+    if (!r.Open(path)) return false;
+    CapturedPacket pkt;
+    uint64_t seq = 0;
+    while (r.Next(pkt))
+    {
+        pkt.seq = ++seq;
+        out.push_back(std::move(pkt));
+    }
+    return true;
+}
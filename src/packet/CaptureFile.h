@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "../wow/WowTypes.h"
+#include "MovementCodec.h"
+
+// ============================================================
+//  CaptureFile — PacketGod on-disk capture format (.pgcap)
+//
+//  Little-endian, append-only:
+//    header  [4] "PGCP"  [2] version  [2] reserved
+//    record  [8] timestamp_us  [4] size  [2] opcode
+//            [1] direction (0 = CMSG, 1 = SMSG)  [1] connection
+//            [size] payload (opcode stripped, as captured)
+//
+//  Version 2: direction | 0x80 marks a MovementCodec record — the
+//  payload is a delta against the same mover's previous record
+//  and `size` is the encoded size.
+//
+//  Version 3: direction | 0x40 marks a packet stored truncated
+//  (metadata-only, snaplen): [4] wire size follows the record
+//  header, before the payload.  Readers accept versions 1 and 2.
+//
+//  `connection` tells sessions apart when one file holds more
+//  than one connection: the ConnectionTracker id for live
+//  captures, the session index for the offline decryptor.
+// ============================================================
+
+namespace CaptureFile
+{
+    constexpr uint32_t kMagic   = 0x50434750;   // "PGCP"
+    constexpr uint16_t kVersion = 3;
+    constexpr uint8_t  kMovementDelta = 0x80;   // Record::direction flags
+    constexpr uint8_t  kWireSize      = 0x40;
+
+    struct Record
+    {
+        uint64_t        timestamp_us;
+        uint32_t        size;
+        uint16_t        opcode;
+        PacketDirection direction;
+        uint8_t         connection;
+    };
+    static_assert(sizeof(Record) == 16, "record header is written as-is");
+
+    // Whole-capture convenience wrappers.
+    bool Save(const char* path, const std::vector<CapturedPacket>& packets);
+    bool Load(const char* path, std::vector<CapturedPacket>& out);
+}
+
+class CaptureWriter
+{
+public:
+    ~CaptureWriter() { Close(); }
+
+    // `deltaMovement` stores MSG_MOVE_* payloads through MovementCodec.
+    bool Open(const char* path, bool deltaMovement = true);
+    // `wireSize` > `size`: the payload was kept truncated (0 = size).
+    // Payloads above PacketPipeline::kMaxPayload are stored truncated.
+    bool Write(PacketDirection dir, uint16_t opcode, uint64_t timestamp_us,
+               const uint8_t* payload, uint32_t size, uint8_t connection = 0, uint32_t wireSize = 0);
+    bool Write(const CapturedPacket& pkt);   // uses pkt.connection and pkt.size
+    bool Close();   // false if any write failed
+
+    uint64_t Count() const { return m_count; }
+
+private:
+    FILE*                m_file  = nullptr;
+    bool                 m_ok    = true;
+    uint64_t             m_count = 0;
+    bool                 m_delta = true;
+    MovementCodec        m_codec;
+    std::vector<uint8_t> m_encoded;
+};
+
+class CaptureReader
+{
+public:
+    ~CaptureReader() { Close(); }
+
+    bool Open(const char* path);
+    // False at end of file or on a truncated / undecodable record,
+    // including one whose size exceeds PacketPipeline::kMaxPayload
+    // or the bytes left in the file (checked before allocating).
+    // Fills out.connection; out.size is the wire size.
+    bool Next(CapturedPacket& out);
+    void Close();
+
+private:
+    bool Read(void* dst, uint64_t size);   // counts against m_left
+
+    FILE*                m_file = nullptr;
+    uint64_t             m_left = 0;   // unread bytes of the file
+    MovementCodec        m_codec;
+    std::vector<uint8_t> m_encoded;
+};
@@ -0,0 +1,187 @@
+#include "CapturePolicy.h"
+#include "PacketCapture.h"
+#include <algorithm>
+
+static constexpr size_t kSlots = 2u << 16;
+
+const char* CaptureModeName(CaptureMode mode)
+{
+    switch (mode)
+    {
+    case CaptureMode::Full:           return "full";
+    case CaptureMode::Metadata:       return "metadata";
+    case CaptureMode::Snaplen:        return "snaplen";
+    case CaptureMode::SampleEvery:    return "1-in-N";
+    case CaptureMode::SampleInterval: return "every N ms";
+    default:                          return "?";
+    }
+}
+
+// ============================================================
+//  Compile
+// ============================================================
+
+void CapturePolicy::Install(const FilterRule* rules, size_t count)
+{
+    // Later passes overwrite earlier ones: wildcards, then categories,
+    // then specific opcodes, then blocks.  Within a pass the table is
+    // walked backwards so the first matching rule is written last.
+    std::vector<uint32_t> table(kSlots, 0);
+    for (int pass = 0; pass < 4; ++pass)
+        for (size_t i = count; i-- > 0;)
+        {
+            const FilterRule& r = rules[i];
+            if (!r.enabled) continue;
+            const int rank = r.blockPacket ? 3 : r.opcode ? 2 : r.IsWildcard() ? 0 : 1;
+            if (rank != pass) continue;
+            // A wildcard Full rule adds nothing; a narrower one may override a wildcard.
+            if (pass == 0 && r.mode == CaptureMode::Full) continue;
+
+            const uint32_t word = pass == 3 ? Encode(kBlock, 0)
+                                            : Encode(static_cast<uint32_t>(r.mode), (std::min)(r.param, kMaxParam));
+            for (int d = 0; d < 2; ++d)
+            {
+                const PacketDirection dir = static_cast<PacketDirection>(d);
+                if (!r.matchAny && r.direction != dir) continue;
+                if (r.opcode)
+                    table[Index(dir, r.opcode)] = word;
+                else if (!r.IsWildcard())
+                    for (uint16_t op = 0; op < OpcodeMeta::kOpcodeSpace; ++op)
+                    {
+                        if (OpcodeMeta::Get(op).category == r.category) table[Index(dir, op)] = word;
+                    }
+                else
+                    for (uint32_t op = 0; op < 0x10000; ++op)
+                        table[Index(dir, static_cast<uint16_t>(op))] = word;
+            }
+        }
+
+    const bool any = std::any_of(table.begin(), table.end(), [](uint32_t w) { return w != 0; });
+    if (!any && !s_policy) return;
+    if (!s_policy)
+    {
+        s_policy.reset(new std::atomic<uint32_t>[kSlots]);
+        for (size_t i = 0; i < kSlots; ++i) s_policy[i].store(0, std::memory_order_relaxed);
+        s_slots.reset(new Slot[kSlots]);
+    }
+    for (size_t i = 0; i < kSlots; ++i)
+        if (s_policy[i].load(std::memory_order_relaxed) != table[i])
+        {
+            s_policy[i].store(table[i], std::memory_order_relaxed);
+            s_slots[i].sample.store(0, std::memory_order_relaxed);
+        }
+    s_active.store(any, std::memory_order_release);
+}
+
+// ============================================================
+//  Hook side
+// ============================================================
+
+bool CapturePolicy::Decide(PacketDirection dir, uint16_t opcode, uint32_t size, uint64_t nowUs, uint32_t& keep)
+{
+    const size_t   i     = Index(dir, opcode);
+    const uint32_t word  = s_policy[i].load(std::memory_order_relaxed);
+    const uint32_t mode  = word >> 29;
+    const uint32_t param = word & kMaxParam;
+    keep = size;
+    if (mode == static_cast<uint32_t>(CaptureMode::Full)) return true;
+    if (mode == kBlock) { keep = 0; return true; }
+
+    Slot& slot = s_slots[i];
+    slot.packets.fetch_add(1, std::memory_order_relaxed);
+    slot.bytes.fetch_add(size, std::memory_order_relaxed);
+    s_packets.fetch_add(1, std::memory_order_relaxed);
+
+    bool store = true;
+    switch (static_cast<CaptureMode>(mode))
+    {
+    case CaptureMode::Metadata:
+        keep = 0;
+        break;
+    case CaptureMode::Snaplen:
+        keep = (std::min)(size, param);
+        break;
+    case CaptureMode::SampleEvery:
+        store = param <= 1 || slot.sample.fetch_add(1, std::memory_order_relaxed) % param == 0;
+        break;
+    case CaptureMode::SampleInterval:
+    {
+        // Stored as ms + 1 so 0 means "nothing stored yet".
+        const uint32_t nowMs = static_cast<uint32_t>(nowUs / 1000) + 1;
+        uint32_t last = slot.sample.load(std::memory_order_relaxed);
+        store = (last == 0 || nowMs - last >= param) &&
+                slot.sample.compare_exchange_strong(last, nowMs, std::memory_order_relaxed);
+        break;
+    }
+    default:
+        break;
+    }
+
+    if (!store)
+    {
+        slot.skipped.fetch_add(1, std::memory_order_relaxed);
+        s_skipped.fetch_add(1, std::memory_order_relaxed);
+        s_skippedBytes.fetch_add(size, std::memory_order_relaxed);
+        return false;
+    }
+    if (keep < size)
+    {
+        slot.trimmed.fetch_add(1, std::memory_order_relaxed);
+        s_trimmed.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+// ============================================================
+//  Counters  (UI)
+// ============================================================
+
+void CapturePolicy::Snapshot(std::vector<OpcodeCounters>& out)
+{
+    out.clear();
+    if (!s_policy) return;
+    for (size_t i = 0; i < kSlots; ++i)
+    {
+        const uint32_t word    = s_policy[i].load(std::memory_order_relaxed);
+        const uint64_t packets = s_slots[i].packets.load(std::memory_order_relaxed);
+        const uint32_t mode    = word >> 29;
+        if (!packets && (mode == static_cast<uint32_t>(CaptureMode::Full) || mode == kBlock)) continue;
+
+        OpcodeCounters c;
+        c.direction = static_cast<PacketDirection>(i >> 16);
+        c.opcode    = static_cast<uint16_t>(i);
+        c.mode      = mode == kBlock ? CaptureMode::Full : static_cast<CaptureMode>(mode);
+        c.param     = word & kMaxParam;
+        c.packets   = packets;
+        c.bytes     = s_slots[i].bytes.load(std::memory_order_relaxed);
+        c.trimmed   = s_slots[i].trimmed.load(std::memory_order_relaxed);
+        c.skipped   = s_slots[i].skipped.load(std::memory_order_relaxed);
+        out.push_back(c);
+    }
+}
+
+PolicyTotals CapturePolicy::Totals()
+{
+    PolicyTotals t;
+    t.packets      = s_packets.load(std::memory_order_relaxed);
+    t.trimmed      = s_trimmed.load(std::memory_order_relaxed);
+    t.skipped      = s_skipped.load(std::memory_order_relaxed);
+    t.skippedBytes = s_skippedBytes.load(std::memory_order_relaxed);
+    return t;
+}
+
+void CapturePolicy::ResetCounters()
+{
+    if (s_slots)
+        for (size_t i = 0; i < kSlots; ++i)
+        {
+            s_slots[i].packets.store(0, std::memory_order_relaxed);
+            s_slots[i].bytes.store(0, std::memory_order_relaxed);
+            s_slots[i].trimmed.store(0, std::memory_order_relaxed);
+            s_slots[i].skipped.store(0, std::memory_order_relaxed);
+        }
+    s_packets      = 0;
+    s_trimmed      = 0;
+    s_skipped      = 0;
+    s_skippedBytes = 0;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "../wow/WowTypes.h"
+
+struct FilterRule;
+
+// ============================================================
+//  CapturePolicy — per-opcode capture modes, decided in the hook
+//
+//  Filter rules may carry a mode besides capture / block:
+//    Metadata        header only — no payload copy
+//    Snaplen N       first N payload bytes
+//    SampleEvery N   store 1 packet in N, count the rest
+//    SampleInterval  store at most 1 packet per N ms, count the rest
+//
+//  PacketCapture compiles its rule list into one 32-bit word per
+//  (direction, opcode) whenever the rules change.  The pipeline
+//  asks Decide() before reserving ring space, so a skipped packet
+//  costs a table load and a few relaxed increments, and a
+//  metadata-only one a 16-byte record.  Opcodes left in Full mode
+//  are not counted here (the store counts them).
+//
+//  Precedence: rules naming an opcode beat category rules, which
+//  beat wildcard rules; among equals the first in the table wins;
+//  block rules always win
+//  (blocked packets are enqueued as metadata only — the store
+//  still drops and counts them).
+// ============================================================
+
+enum class CaptureMode : uint8_t
+{
+    Full,
+    Metadata,
+    Snaplen,          // param = payload bytes kept
+    SampleEvery,      // param = N
+    SampleInterval,   // param = milliseconds
+    Count
+};
+
+const char* CaptureModeName(CaptureMode mode);
+
+struct OpcodeCounters
+{
+    PacketDirection direction = PacketDirection::CMSG;
+    uint16_t        opcode    = 0;
+    CaptureMode     mode      = CaptureMode::Full;
+    uint32_t        param     = 0;
+    uint64_t        packets   = 0;   // seen by the hook under this mode
+    uint64_t        bytes     = 0;   // their payload bytes on the wire
+    uint64_t        trimmed   = 0;   // stored without (all of) the payload
+    uint64_t        skipped   = 0;   // sampled out, not stored at all
+};
+
+struct PolicyTotals
+{
+    uint64_t packets = 0;
+    uint64_t trimmed = 0;
+    uint64_t skipped = 0;
+    uint64_t skippedBytes = 0;
+};
+
+class CapturePolicy
+{
+public:
+    static constexpr uint32_t kMaxParam = (1u << 29) - 1;
+
+    // Recompile from the filter table (PacketCapture, under its lock).
+    static void Install(const FilterRule* rules, size_t count);
+
+    static bool IsActive() { return s_active.load(std::memory_order_acquire); }
+
+    // Hook side.  False: skip the packet (already counted).  True:
+    // enqueue it with `keep` payload bytes (0 = metadata only).
+    static bool Decide(PacketDirection dir, uint16_t opcode, uint32_t size, uint64_t nowUs, uint32_t& keep);
+
+    // One entry per (direction, opcode) that has a mode or has counts.
+    static void         Snapshot(std::vector<OpcodeCounters>& out);
+    static PolicyTotals Totals();
+    static void         ResetCounters();
+
+private:
+    enum : uint32_t { kBlock = 7 };   // internal mode: enqueue header only, store drops it
+
+    struct Slot
+    {
+        std::atomic<uint32_t> sample{ 0 };   // SampleEvery counter / SampleInterval last ms + 1
+        std::atomic<uint64_t> packets{ 0 };
+        std::atomic<uint64_t> bytes{ 0 };
+        std::atomic<uint64_t> trimmed{ 0 };
+        std::atomic<uint64_t> skipped{ 0 };
+    };
+
+    static uint32_t Encode(uint32_t mode, uint32_t param) { return (mode << 29) | (param & kMaxParam); }
+    static size_t   Index(PacketDirection dir, uint16_t opcode) { return (static_cast<size_t>(dir) & 1) << 16 | opcode; }
+
+    // Allocated on the first install with a mode and never freed:
+    // a hook may still be reading while the rules change.
+    static inline std::unique_ptr<std::atomic<uint32_t>[]> s_policy;   // mode << 29 | param
+    static inline std::unique_ptr<Slot[]>                  s_slots;
+    static inline std::atomic<bool>                        s_active{ false };
+
+    static inline std::atomic<uint64_t> s_packets{ 0 };
+    static inline std::atomic<uint64_t> s_trimmed{ 0 };
+    static inline std::atomic<uint64_t> s_skipped{ 0 };
+    static inline std::atomic<uint64_t> s_skippedBytes{ 0 };
+};
@@ -0,0 +1,346 @@
+#include "MovementCodec.h"
+#include "PacketHash.h"
+#include "Opcodes.h"
+#include <cstring>
+
+// MovementInfo flags (build 12340) that change the packet layout.
+constexpr uint32_t MOVEMENTFLAG_ONTRANSPORT = 0x00000200;
+constexpr uint32_t MOVEMENTFLAG_SWIMMING    = 0x00200000;
+constexpr uint32_t MOVEMENTFLAG_FLYING      = 0x02000000;
+
+constexpr uint16_t MOVEMENTFLAG2_ALWAYS_ALLOW_PITCHING = 0x0020;
+constexpr uint16_t MOVEMENTFLAG2_INTERPOLATED_MOVEMENT = 0x0400;
+
+// Record tag bits
+constexpr uint8_t kTagFlags    = 0x01;
+constexpr uint8_t kTagFlags2   = 0x02;
+constexpr uint8_t kTagMid      = 0x04;
+constexpr uint8_t kTagFallTime = 0x08;
+constexpr uint8_t kTagTail     = 0x10;
+constexpr uint8_t kTagFacing   = 0x20;
+constexpr uint8_t kTagPosition = 0x40;
+constexpr uint8_t kTagKeyframe = 0x80;   // verbatim packet follows
+
+constexpr size_t kHeadBytes = 4 + 2 + 4 + 16;   // flags, flags2, time, x y z o
+
+// ============================================================
+//  Varints
+// ============================================================
+
+static uint32_t ZigZag(int32_t v)    { return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31); }
+static int32_t  UnZigZag(uint32_t v) { return static_cast<int32_t>((v >> 1) ^ (0u - (v & 1))); }
+
+static void PutVarint(std::vector<uint8_t>& out, uint32_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static void PutBytes(std::vector<uint8_t>& out, const std::vector<uint8_t>& bytes)
+{
+    PutVarint(out, static_cast<uint32_t>(bytes.size()));
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+namespace
+{
+    struct Reader
+    {
+        const uint8_t* p;
+        const uint8_t* end;
+        bool           ok = true;
+
+        uint32_t Varint()
+        {
+            uint32_t v = 0;
+            for (int shift = 0; shift < 35; shift += 7)
+            {
+                if (p == end) break;
+                const uint8_t b = *p++;
+                v |= static_cast<uint32_t>(b & 0x7F) << shift;
+                if (!(b & 0x80)) return v;
+            }
+            ok = false;
+            return 0;
+        }
+
+        void Bytes(std::vector<uint8_t>& out)
+        {
+            const uint32_t n = Varint();
+            if (!ok || static_cast<size_t>(end - p) < n) { ok = false; return; }
+            out.assign(p, p + n);
+            p += n;
+        }
+    };
+}
+
+// ============================================================
+//  Layout
+// ============================================================
+
+bool MovementCodec::IsMovement(uint16_t opcode)
+{
+    switch (opcode)
+    {
+    case MSG_MOVE_START_FORWARD:      case MSG_MOVE_START_BACKWARD:    case MSG_MOVE_STOP:
+    case MSG_MOVE_START_STRAFE_LEFT:  case MSG_MOVE_START_STRAFE_RIGHT: case MSG_MOVE_STOP_STRAFE:
+    case MSG_MOVE_JUMP:
+    case MSG_MOVE_START_TURN_LEFT:    case MSG_MOVE_START_TURN_RIGHT:  case MSG_MOVE_STOP_TURN:
+    case MSG_MOVE_START_PITCH_UP:     case MSG_MOVE_START_PITCH_DOWN:  case MSG_MOVE_STOP_PITCH:
+    case MSG_MOVE_SET_RUN_MODE:       case MSG_MOVE_SET_WALK_MODE:
+    case MSG_MOVE_FALL_LAND:          case MSG_MOVE_START_SWIM:        case MSG_MOVE_STOP_SWIM:
+    case MSG_MOVE_SET_FACING:         case MSG_MOVE_SET_PITCH:         case MSG_MOVE_HEARTBEAT:
+    case MSG_MOVE_START_ASCEND:       case MSG_MOVE_STOP_ASCEND:       case MSG_MOVE_START_DESCEND:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static uint32_t PackedGuidBytes(const uint8_t* p, uint32_t size)
+{
+    if (!size) return 0;
+    uint32_t n = 1;
+    for (uint8_t mask = p[0]; mask; mask &= mask - 1) ++n;
+    return n <= size ? n : 0;
+}
+
+// Splits a MovementInfo into the fields the codec tracks.  The
+// transport block and pitch are kept raw (mid), as is everything
+// after the fall time (tail).
+bool MovementCodec::Parse(const uint8_t* p, uint32_t size, Mover& m, uint64_t& guid)
+{
+    const uint32_t guidLen = PackedGuidBytes(p, size);
+    if (!guidLen || size - guidLen < kHeadBytes + 4) return false;
+
+    memcpy(m.guid, p, guidLen);
+    m.guidLen = static_cast<uint8_t>(guidLen);
+    guid = 0;
+    for (uint32_t i = 0, b = 1; i < 8; ++i)
+        if (p[0] & (1u << i))
+            guid |= static_cast<uint64_t>(p[b++]) << (8 * i);
+
+    const uint8_t* head = p + guidLen;
+    memcpy(&m.flags,  head,      4);
+    memcpy(&m.flags2, head + 4,  2);
+    memcpy(&m.time,   head + 6,  4);
+    memcpy(m.pos,     head + 10, 16);
+    m.dTime = 0;
+    memset(m.dPos, 0, sizeof(m.dPos));
+
+    const size_t midAt = guidLen + kHeadBytes;
+    size_t       off   = midAt;
+    if (m.flags & MOVEMENTFLAG_ONTRANSPORT)
+    {
+        const uint32_t tguid = PackedGuidBytes(p + off, static_cast<uint32_t>(size - off));
+        if (!tguid) return false;
+        off += tguid + 16 + 4 + 1;   // x y z o, time, seat
+        if (m.flags2 & MOVEMENTFLAG2_INTERPOLATED_MOVEMENT)
+            off += 4;                // time2
+    }
+    if ((m.flags & (MOVEMENTFLAG_SWIMMING | MOVEMENTFLAG_FLYING)) ||
+        (m.flags2 & MOVEMENTFLAG2_ALWAYS_ALLOW_PITCHING))
+        off += 4;                    // pitch
+    if (off + 4 > size) return false;
+    m.mid.assign(p + midAt, p + off);
+
+    memcpy(&m.fallTime, p + off, 4);
+    m.tail.assign(p + off + 4, p + size);
+    return true;
+}
+
+void MovementCodec::Write(const Mover& m, std::vector<uint8_t>& out)
+{
+    out.clear();
+    out.reserve(m.guidLen + kHeadBytes + m.mid.size() + 4 + m.tail.size());
+    out.insert(out.end(), m.guid, m.guid + m.guidLen);
+    const uint8_t* f = reinterpret_cast<const uint8_t*>(&m.flags);
+    out.insert(out.end(), f, f + 4);
+    f = reinterpret_cast<const uint8_t*>(&m.flags2);
+    out.insert(out.end(), f, f + 2);
+    f = reinterpret_cast<const uint8_t*>(&m.time);
+    out.insert(out.end(), f, f + 4);
+    f = reinterpret_cast<const uint8_t*>(m.pos);
+    out.insert(out.end(), f, f + 16);
+    out.insert(out.end(), m.mid.begin(), m.mid.end());
+    f = reinterpret_cast<const uint8_t*>(&m.fallTime);
+    out.insert(out.end(), f, f + 4);
+    out.insert(out.end(), m.tail.begin(), m.tail.end());
+}
+
+// ============================================================
+//  Contexts
+// ============================================================
+
+size_t MovementCodec::KeyHash::operator()(const Key& k) const
+{
+    return static_cast<size_t>(PacketHash::Avalanche(k.guid ^ (static_cast<uint64_t>(k.stream) << 48)));
+}
+
+void MovementCodec::Reset()
+{
+    m_movers.clear();
+    m_slots.clear();
+}
+
+void MovementCodec::Admit(const Key& key, const Mover& m)
+{
+    if (m_movers.size() == kMaxMovers) Reset();
+    m_slots[key] = static_cast<uint32_t>(m_movers.size());
+    m_movers.push_back(m);
+}
+
+// ============================================================
+//  Encode
+//
+//  Keyframe: [tag 0x80] [varint slot] [verbatim packet]
+//            slot == Movers() adds a mover (after a reset when
+//            full); a smaller slot replaces one whose packed GUID
+//            bytes changed.
+//  Delta:    [tag] [varint slot] [zz time residual]
+//            then, as tagged: zz x y z residuals, zz facing delta,
+//            flags xor, flags2 xor, zz fall time delta,
+//            [varint n] mid, [varint n] tail
+// ============================================================
+
+bool MovementCodec::Encode(uint8_t connection, PacketDirection dir, uint16_t opcode,
+                           const uint8_t* payload, uint32_t size, std::vector<uint8_t>& out)
+{
+    if (!IsMovement(opcode) || !payload) return false;
+
+    Mover&   cur = m_scratch;
+    uint64_t guid;
+    if (!Parse(payload, size, cur, guid)) return false;
+
+    const Key key = { guid, static_cast<uint16_t>(connection << 1 | (static_cast<uint8_t>(dir) & 1)) };
+    auto it = m_slots.find(key);
+    if (it == m_slots.end() || m_movers[it->second].guidLen != cur.guidLen ||
+        memcmp(m_movers[it->second].guid, cur.guid, cur.guidLen) != 0)
+    {
+        uint32_t slot;
+        if (it != m_slots.end())
+        {
+            slot = it->second;
+            m_movers[slot] = cur;
+        }
+        else
+        {
+            slot = static_cast<uint32_t>(m_movers.size());
+            Admit(key, cur);
+        }
+        out.push_back(kTagKeyframe);
+        PutVarint(out, slot);
+        out.insert(out.end(), payload, payload + size);
+        return true;
+    }
+
+    const uint32_t slot = it->second;
+    Mover&         prev = m_movers[slot];
+
+    const int32_t dTime = static_cast<int32_t>(cur.time - prev.time);
+    int32_t       dPos[3], rPos[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        dPos[i] = static_cast<int32_t>(cur.pos[i] - prev.pos[i]);
+        rPos[i] = static_cast<int32_t>(static_cast<uint32_t>(dPos[i]) - static_cast<uint32_t>(prev.dPos[i]));
+    }
+
+    uint8_t tag = 0;
+    if (rPos[0] | rPos[1] | rPos[2])   tag |= kTagPosition;
+    if (cur.pos[3]   != prev.pos[3])   tag |= kTagFacing;
+    if (cur.flags    != prev.flags)    tag |= kTagFlags;
+    if (cur.flags2   != prev.flags2)   tag |= kTagFlags2;
+    if (cur.fallTime != prev.fallTime) tag |= kTagFallTime;
+    if (cur.mid      != prev.mid)      tag |= kTagMid;
+    if (cur.tail     != prev.tail)     tag |= kTagTail;
+
+    out.push_back(tag);
+    PutVarint(out, slot);
+    PutVarint(out, ZigZag(static_cast<int32_t>(static_cast<uint32_t>(dTime) - static_cast<uint32_t>(prev.dTime))));
+    if (tag & kTagPosition)
+        for (int i = 0; i < 3; ++i) PutVarint(out, ZigZag(rPos[i]));
+    if (tag & kTagFacing)   PutVarint(out, ZigZag(static_cast<int32_t>(cur.pos[3] - prev.pos[3])));
+    if (tag & kTagFlags)    PutVarint(out, cur.flags ^ prev.flags);
+    if (tag & kTagFlags2)   PutVarint(out, static_cast<uint32_t>(cur.flags2 ^ prev.flags2));
+    if (tag & kTagFallTime) PutVarint(out, ZigZag(static_cast<int32_t>(cur.fallTime - prev.fallTime)));
+    if (tag & kTagMid)      PutBytes(out, cur.mid);
+    if (tag & kTagTail)     PutBytes(out, cur.tail);
+
+    prev.flags    = cur.flags;
+    prev.flags2   = cur.flags2;
+    prev.time     = cur.time;
+    prev.fallTime = cur.fallTime;
+    memcpy(prev.pos, cur.pos, sizeof(prev.pos));
+    prev.dTime = dTime;
+    memcpy(prev.dPos, dPos, sizeof(prev.dPos));
+    if (tag & kTagMid)  prev.mid.swap(cur.mid);
+    if (tag & kTagTail) prev.tail.swap(cur.tail);
+    return true;
+}
+
+// ============================================================
+//  Decode
+// ============================================================
+
+bool MovementCodec::Decode(uint8_t connection, PacketDirection dir, uint16_t /*opcode*/,
+                           const uint8_t* data, uint32_t size, std::vector<uint8_t>& out)
+{
+    if (!size) return false;
+    Reader r{ data + 1, data + size };
+    const uint8_t  tag  = data[0];
+    const uint32_t slot = r.Varint();
+    if (!r.ok) return false;
+
+    if (tag & kTagKeyframe)
+    {
+        Mover&   m = m_scratch;
+        uint64_t guid;
+        if (!Parse(r.p, static_cast<uint32_t>(r.end - r.p), m, guid)) return false;
+        const Key key = { guid, static_cast<uint16_t>(connection << 1 | (static_cast<uint8_t>(dir) & 1)) };
+        if (slot < m_movers.size())
+            m_movers[slot] = m;
+        else if (slot == m_movers.size() || (slot == kMaxMovers && m_movers.size() == kMaxMovers))
+            Admit(key, m);
+        else
+            return false;
+        out.assign(r.p, r.end);
+        return true;
+    }
+
+    if (slot >= m_movers.size()) return false;
+    Mover& m = m_movers[slot];
+
+    const int32_t dTime = static_cast<int32_t>(static_cast<uint32_t>(m.dTime) + static_cast<uint32_t>(UnZigZag(r.Varint())));
+    int32_t dPos[3] = { m.dPos[0], m.dPos[1], m.dPos[2] };
+    if (tag & kTagPosition)
+        for (int i = 0; i < 3; ++i)
+            dPos[i] = static_cast<int32_t>(static_cast<uint32_t>(dPos[i]) + static_cast<uint32_t>(UnZigZag(r.Varint())));
+    const uint32_t facing   = (tag & kTagFacing)   ? m.pos[3] + static_cast<uint32_t>(UnZigZag(r.Varint())) : m.pos[3];
+    const uint32_t flags    = (tag & kTagFlags)    ? m.flags ^ r.Varint() : m.flags;
+    const uint16_t flags2   = (tag & kTagFlags2)   ? static_cast<uint16_t>(m.flags2 ^ r.Varint()) : m.flags2;
+    const uint32_t fallTime = (tag & kTagFallTime) ? m.fallTime + static_cast<uint32_t>(UnZigZag(r.Varint())) : m.fallTime;
+    std::vector<uint8_t>& mid  = m_scratch.mid;
+    std::vector<uint8_t>& tail = m_scratch.tail;
+    if (tag & kTagMid)  r.Bytes(mid);
+    if (tag & kTagTail) r.Bytes(tail);
+    if (!r.ok || r.p != r.end) return false;
+
+    m.time    += static_cast<uint32_t>(dTime);
+    m.dTime    = dTime;
+    for (int i = 0; i < 3; ++i)
+        m.pos[i] += static_cast<uint32_t>(dPos[i]);
+    memcpy(m.dPos, dPos, sizeof(m.dPos));
+    m.pos[3]   = facing;
+    m.flags    = flags;
+    m.flags2   = flags2;
+    m.fallTime = fallTime;
+    if (tag & kTagMid)  m.mid.swap(mid);
+    if (tag & kTagTail) m.tail.swap(tail);
+
+    Write(m, out);
+    return true;
+}
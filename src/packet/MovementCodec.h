@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "../wow/WowTypes.h"
+
+// ============================================================
+//  MovementCodec — delta storage for MSG_MOVE_* packets
+//
+//  A movement packet is a packed GUID and a MovementInfo, and the
+//  next packet of the same mover usually differs in little more
+//  than time and position.  The encoder keeps the last packet of
+//  each mover (connection, direction, GUID) and writes:
+//    time, x y z        delta of delta (zigzag varint), so steady
+//                       heartbeats cost about a byte per field
+//    orientation        delta, only when changed
+//    flags, flags2      XOR, only when changed
+//    fall time          delta, only when changed
+//    transport / pitch  raw, only when changed
+//    rest of packet     raw, only when changed (jump, elevation,
+//                       opcode-specific trailing fields)
+//  Floats are differenced as IEEE bit patterns, so decoding is
+//  exact.  A mover's first packet is stored verbatim.
+//
+//  Stateful: the decoder must see the encoder's records in the
+//  same order (one CaptureWriter / CaptureReader stream).  Packets
+//  that do not parse as MovementInfo are left to the caller.
+// ============================================================
+
+class MovementCodec
+{
+public:
+    static constexpr size_t kMaxMovers = 4096;   // all contexts are dropped when full
+
+    static bool IsMovement(uint16_t opcode);
+
+    // Appends the encoding to `out`.  False: not a movement packet or
+    // it does not parse — store it raw; nothing is appended.
+    bool Encode(uint8_t connection, PacketDirection dir, uint16_t opcode,
+                const uint8_t* payload, uint32_t size, std::vector<uint8_t>& out);
+
+    // Rebuilds the payload into `out` (replaced).  False on corrupt input.
+    bool Decode(uint8_t connection, PacketDirection dir, uint16_t opcode,
+                const uint8_t* data, uint32_t size, std::vector<uint8_t>& out);
+
+    void Reset();
+
+    size_t Movers() const { return m_movers.size(); }
+
+private:
+    // Last packet of one mover, fields as parsed.
+    struct Mover
+    {
+        uint8_t              guid[9] = {};   // packed GUID as it was on the wire
+        uint8_t              guidLen = 0;
+        uint32_t             flags   = 0;
+        uint16_t             flags2  = 0;
+        uint32_t             time    = 0;
+        uint32_t             pos[4]  = {};   // x y z o bit patterns
+        uint32_t             fallTime = 0;
+        int32_t              dTime    = 0;   // last deltas, the prediction for the next packet
+        int32_t              dPos[3]  = {};
+        std::vector<uint8_t> mid;            // transport block + pitch
+        std::vector<uint8_t> tail;           // after fall time
+    };
+
+    struct Key
+    {
+        uint64_t guid;
+        uint16_t stream;   // connection << 1 | direction
+        bool operator==(const Key& o) const { return guid == o.guid && stream == o.stream; }
+    };
+    struct KeyHash { size_t operator()(const Key& k) const; };
+
+    static bool Parse(const uint8_t* p, uint32_t size, Mover& m, uint64_t& guid);
+    static void Write(const Mover& m, std::vector<uint8_t>& out);
+    void        Admit(const Key& key, const Mover& m);   // keyframe: new context
+
+    std::vector<Mover>                         m_movers;   // index = context slot
+    std::unordered_map<Key, uint32_t, KeyHash> m_slots;    // encoder side
+    Mover                                      m_scratch;
+};
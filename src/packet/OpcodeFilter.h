@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "PacketCapture.h"
+
+// ============================================================
+//  OpcodeFilter — FilterRule list compiled to a bitmap
+//
+//  One bit per (direction, opcode): 2 × 65536 bits = 16 KiB.
+//  Test() is a shift and a mask, so per-packet filtering does not
+//  depend on how many rules were installed.
+//
+//  Compile() semantics match a pass list with block overrides:
+//    - no enabled pass rule  → everything passes
+//    - otherwise             → only what some pass rule matches
+//    - block rules           → removed afterwards, always win
+//  Opcode 0 in a rule means any opcode (of its category, if it
+//  names one), matchAny any direction.
+// ============================================================
+
+class OpcodeFilter
+{
+public:
+    OpcodeFilter() { Fill(true); }
+
+    static OpcodeFilter Compile(const FilterRule* rules, size_t count)
+    {
+        OpcodeFilter f;
+        bool anyPass = false;
+        for (size_t i = 0; i < count; ++i)
+            anyPass |= rules[i].enabled && !rules[i].blockPacket;
+        if (anyPass) f.Fill(false);
+
+        for (int pass = 0; pass < 2; ++pass)   // pass rules first, then blocks
+            for (size_t i = 0; i < count; ++i)
+            {
+                const FilterRule& r = rules[i];
+                if (!r.enabled || r.blockPacket != (pass == 1)) continue;
+                for (int d = 0; d < 2; ++d)
+                {
+                    const PacketDirection dir = static_cast<PacketDirection>(d);
+                    if (!r.matchAny && r.direction != dir) continue;
+                    if (r.IsWildcard())
+                        memset(f.m_bits[d], pass == 0 ? 0xFF : 0x00, sizeof(f.m_bits[d]));
+                    else if (r.opcode)
+                        f.Set(dir, r.opcode, pass == 0);
+                    else
+                        for (uint16_t op = 0; op < OpcodeMeta::kOpcodeSpace; ++op)
+                            if (OpcodeMeta::Get(op).category == r.category) f.Set(dir, op, pass == 0);
+                }
+            }
+        return f;
+    }
+
+    bool Test(PacketDirection dir, uint16_t opcode) const
+    {
+        return (m_bits[static_cast<int>(dir) & 1][opcode >> 6] >> (opcode & 63)) & 1;
+    }
+
+    void Set(PacketDirection dir, uint16_t opcode, bool pass)
+    {
+        uint64_t& word = m_bits[static_cast<int>(dir) & 1][opcode >> 6];
+        const uint64_t bit = uint64_t(1) << (opcode & 63);
+        word = pass ? (word | bit) : (word & ~bit);
+    }
+
+    void Fill(bool pass) { memset(m_bits, pass ? 0xFF : 0x00, sizeof(m_bits)); }
+
+private:
+    uint64_t m_bits[2][65536 / 64];
+};
@@ -1,10 +1,16 @@
 #include "PacketCapture.h"
+#include "PacketInflater.h"
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#else
+#include <chrono>
+#endif
 #include <algorithm>
 
 // ============================================================
 
+#ifdef _WIN32
 static uint64_t s_qpcFreq = 0;
 
 uint64_t PacketCapture::NowMicros()
@@ -25,67 +31,297 @@ uint64_t PacketCapture::NowMicros()
     uint64_t delta = static_cast<uint64_t>(now.QuadPart) - s_startTime;
     return delta * 1'000'000ULL / s_qpcFreq;
 }
+#else
+// Portable build (tools / Linux): steady_clock stands in for QPC.
+uint64_t PacketCapture::NowMicros()
+{
+    const uint64_t now = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    if (!s_startTime)
+    {
+        s_startTime = now;
+        return 0;
+    }
+    return now - s_startTime;
+}
+#endif
 
 // ============================================================
 //  Filter helpers
 // ============================================================
 
-bool PacketCapture::ShouldCapture(PacketDirection dir, uint16_t opcode)
+bool PacketCapture::Blocked(PacketDirection dir, uint16_t opcode)
 {
-    std::lock_guard<std::mutex> lk(s_mutex);
     for (const auto& f : s_filters)
     {
-        if (!f.enabled) continue;
+        if (!f.enabled || !f.blockPacket) continue;
         bool dirMatch = f.matchAny || (f.direction == dir);
-        bool opcodeMatch = (f.opcode == 0) || (f.opcode == opcode);
+        bool opcodeMatch = f.MatchesOpcode(opcode);
         if (dirMatch && opcodeMatch)
+            return true;
+    }
+    return false;
+}
+
+bool PacketCapture::ShouldCapture(PacketDirection dir, uint16_t opcode)
+{
+    std::lock_guard<std::mutex> lk(s_filterMutex);
+    if (!Blocked(dir, opcode)) return true;
+    ++s_totalDropped;
+    return false;
+}
+
+// ============================================================
+//  Partitions
+//
+//  Only the pipeline worker assigns partitions, so it may read
+//  `used` / `stats.connection` without the partition lock.  A new
+//  connection takes a free partition, else the one written to
+//  least recently (the oldest connection's history is dropped).
+// ============================================================
+
+PacketCapture::Partition& PacketCapture::PartitionFor(uint8_t connection)
+{
+    Partition* free   = nullptr;
+    Partition* oldest = nullptr;
+    for (auto& part : s_parts)
+    {
+        if (part.used && part.stats.connection == connection) return part;
+        if (!part.used) { if (!free) free = &part; continue; }
+        if (!oldest || part.stats.lastSeq < oldest->stats.lastSeq) oldest = &part;
+    }
+
+    Partition& part = free ? *free : *oldest;
+    std::lock_guard<std::mutex> lk(part.mutex);
+    part.ring.Clear();
+    part.stats            = ConnectionStats{};
+    part.stats.connection = connection;
+    part.used             = true;
+    return part;
+}
+
+// ============================================================
+//  PushBatch  (called from the pipeline worker)
+// ============================================================
+
+void PacketCapture::PushBatch(std::vector<CapturedPacket>& batch)
+{
+    // Seqs of compressed packets, queued for inflating after the locks are released.
+    static thread_local std::vector<uint64_t> s_inflateSeqs;
+    static thread_local std::vector<uint8_t>  s_blocked;
+    s_inflateSeqs.clear();
+
+    {
+        std::lock_guard<std::mutex> lk(s_filterMutex);
+        s_blocked.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i)
+            s_blocked[i] = Blocked(batch[i].direction, batch[i].opcode);
+    }
+
+    // Consecutive packets of one connection share a single lock hold.
+    const bool                   mirror = s_sinkCount.load(std::memory_order_acquire) != 0;
+    Partition*                   part = nullptr;
+    std::unique_lock<std::mutex> lk;
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        CapturedPacket& pkt = batch[i];
+        if (!part || part->stats.connection != pkt.connection)
+        {
+            if (lk.owns_lock()) lk.unlock();
+            part = &PartitionFor(pkt.connection);
+            lk   = std::unique_lock<std::mutex>(part->mutex);
+        }
+
+        if (s_blocked[i])
+        {
+            ++part->stats.blocked;
+            ++s_totalDropped;
+            continue;
+        }
+        if (part->ring.Rows() >= kMaxHistory)
+            part->ring.DropOldest(1);
+
+        pkt.seq = s_nextSeq.fetch_add(1, std::memory_order_relaxed);
+        if (PacketInflater::IsCompressed(pkt.opcode) && !pkt.Truncated())
+            s_inflateSeqs.push_back(pkt.seq);
+
+        ConnectionStats& st = part->stats;
+        ++st.captured;
+        ++(pkt.direction == PacketDirection::CMSG ? st.cmsg : st.smsg);
+        st.bytes  += pkt.payload.size();
+        st.lastSeq = pkt.seq;
+        if (mirror)
+            for (auto& slot : s_sinks)
+                if (CaptureSink sink = slot.load(std::memory_order_acquire))
+                    sink(pkt);
+        part->ring.Append(pkt);
+        ++s_totalCaptured;
+    }
+    if (lk.owns_lock()) lk.unlock();
+    batch.clear();
+
+    for (uint64_t seq : s_inflateSeqs)
+        PacketInflater::Enqueue(seq);
+}
+
+bool PacketCapture::AddSink(CaptureSink sink)
+{
+    for (auto& slot : s_sinks)
+    {
+        CaptureSink expected = nullptr;
+        if (slot.compare_exchange_strong(expected, sink, std::memory_order_acq_rel))
         {
-            if (f.blockPacket)
-            {
-                ++s_totalDropped;
-                return false;
-            }
+            s_sinkCount.fetch_add(1, std::memory_order_release);
+            return true;
         }
     }
-    return true;
+    return false;
+}
+
+void PacketCapture::RemoveSink(CaptureSink sink)
+{
+    for (auto& slot : s_sinks)
+    {
+        CaptureSink expected = sink;
+        if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+            s_sinkCount.fetch_sub(1, std::memory_order_release);
+    }
 }
 
 // ============================================================
-//  Push  (called from game thread)
+//  Lookup by sequence number  (background stages)
+//
+//  Seqs increase inside each partition but are interleaved with
+//  other connections, so the row is a binary search away.
 // ============================================================
 
-void PacketCapture::Push(PacketDirection dir, uint16_t opcode,
-                         const uint8_t* payload, uint32_t size)
+bool PacketCapture::CopyPayload(uint64_t seq, uint16_t& outOpcode, std::vector<uint8_t>& out)
+{
+    for (auto& part : s_parts)
+    {
+        std::lock_guard<std::mutex> lk(part.mutex);
+        const size_t row = part.ring.Find(seq);
+        if (row == PacketColumns::npos) continue;
+        outOpcode = part.ring.Opcode()[row];
+        out.assign(part.ring.Payload(row), part.ring.Payload(row) + part.ring.Stored()[row]);
+        return true;
+    }
+    return false;
+}
+
+bool PacketCapture::CopyPacket(uint64_t seq, CapturedPacket& out)
 {
-    CapturedPacket pkt;
-    pkt.direction    = dir;
-    pkt.opcode       = opcode;
-    pkt.size         = size;
-    pkt.timestamp_us = NowMicros();
-    if (payload && size > 0)
-        pkt.payload.assign(payload, payload + size);
+    for (auto& part : s_parts)
+    {
+        std::lock_guard<std::mutex> lk(part.mutex);
+        const size_t row = part.ring.Find(seq);
+        if (row == PacketColumns::npos) continue;
+        out = part.ring.Packet(row);
+        return true;
+    }
+    return false;
+}
 
-    std::lock_guard<std::mutex> lk(s_mutex);
-    if (s_ring.size() >= kMaxHistory)
-        s_ring.pop_front();
-    s_ring.push_back(std::move(pkt));
-    ++s_totalCaptured;
+bool PacketCapture::AttachInflated(uint64_t seq, std::shared_ptr<const std::vector<uint8_t>> inflated)
+{
+    for (auto& part : s_parts)
+    {
+        std::lock_guard<std::mutex> lk(part.mutex);
+        const size_t row = part.ring.Find(seq);
+        if (row == PacketColumns::npos) continue;
+        part.ring.SetInflated(row, std::move(inflated));
+        return true;
+    }
+    return false;
 }
 
 // ============================================================
 //  Snapshot  (called from render thread)
 // ============================================================
 
+static void SortBySeq(std::vector<CapturedPacket>& v)
+{
+    std::sort(v.begin(), v.end(),
+              [](const CapturedPacket& a, const CapturedPacket& b) { return a.seq < b.seq; });
+}
+
 std::vector<CapturedPacket> PacketCapture::Snapshot()
 {
-    std::lock_guard<std::mutex> lk(s_mutex);
-    return { s_ring.begin(), s_ring.end() };
+    return SnapshotSince(0);
+}
+
+std::vector<CapturedPacket> PacketCapture::Snapshot(uint8_t connection)
+{
+    std::vector<CapturedPacket> out;
+    for (auto& part : s_parts)
+    {
+        std::lock_guard<std::mutex> lk(part.mutex);
+        if (part.used && part.stats.connection == connection)
+        {
+            part.ring.ToPackets(0, out);
+            break;
+        }
+    }
+    return out;
+}
+
+std::vector<CapturedPacket> PacketCapture::SnapshotSince(uint64_t afterSeq)
+{
+    std::vector<CapturedPacket> out;
+    size_t partsWithData = 0;
+    for (auto& part : s_parts)
+    {
+        std::lock_guard<std::mutex> lk(part.mutex);
+        const size_t first = part.ring.UpperBound(afterSeq);
+        if (first == part.ring.Rows()) continue;
+        part.ring.ToPackets(first, out);
+        ++partsWithData;
+    }
+    if (partsWithData > 1)
+        SortBySeq(out);
+    return out;
+}
+
+void PacketCapture::SnapshotColumns(PacketColumns& out, int connection)
+{
+    out.Clear();
+    size_t partsWithData = 0;
+    for (auto& part : s_parts)
+    {
+        std::lock_guard<std::mutex> lk(part.mutex);
+        if (!part.used || part.ring.Empty()) continue;
+        if (connection >= 0 && part.stats.connection != connection) continue;
+        out.AppendRows(part.ring, 0, part.ring.Rows());
+        ++partsWithData;
+    }
+    if (partsWithData > 1)
+        out.SortBySeq();
+}
+
+std::vector<ConnectionStats> PacketCapture::PerConnection()
+{
+    std::vector<ConnectionStats> out;
+    for (auto& part : s_parts)
+    {
+        std::lock_guard<std::mutex> lk(part.mutex);
+        if (part.used) out.push_back(part.stats);
+    }
+    std::sort(out.begin(), out.end(),
+              [](const ConnectionStats& a, const ConnectionStats& b) { return a.connection < b.connection; });
+    return out;
 }
 
 void PacketCapture::Clear()
 {
-    std::lock_guard<std::mutex> lk(s_mutex);
-    s_ring.clear();
+    for (auto& part : s_parts)
+    {
+        std::lock_guard<std::mutex> lk(part.mutex);
+        part.ring.Clear();
+        const uint8_t conn = part.stats.connection;
+        part.stats            = ConnectionStats{};
+        part.stats.connection = conn;
+    }
     s_totalCaptured = 0;
     s_totalDropped  = 0;
 }
@@ -96,28 +332,49 @@ void PacketCapture::Clear()
 
 void PacketCapture::AddFilter(const FilterRule& rule)
 {
-    std::lock_guard<std::mutex> lk(s_mutex);
+    std::lock_guard<std::mutex> lk(s_filterMutex);
     s_filters.push_back(rule);
+    CapturePolicy::Install(s_filters.data(), s_filters.size());
 }
 
 void PacketCapture::RemoveFilter(size_t index)
 {
-    std::lock_guard<std::mutex> lk(s_mutex);
+    std::lock_guard<std::mutex> lk(s_filterMutex);
     if (index < s_filters.size())
         s_filters.erase(s_filters.begin() + index);
+    CapturePolicy::Install(s_filters.data(), s_filters.size());
 }
 
 void PacketCapture::ClearFilters()
 {
-    std::lock_guard<std::mutex> lk(s_mutex);
+    std::lock_guard<std::mutex> lk(s_filterMutex);
     s_filters.clear();
+    CapturePolicy::Install(s_filters.data(), s_filters.size());
+}
+
+void PacketCapture::SetFilters(const std::vector<FilterRule>& rules)
+{
+    std::lock_guard<std::mutex> lk(s_filterMutex);
+    s_filters = rules;
+    CapturePolicy::Install(s_filters.data(), s_filters.size());
 }
 
-const std::vector<FilterRule>& PacketCapture::GetFilters()
+std::vector<FilterRule> PacketCapture::GetFilters()
 {
-    // Caller must hold their own lock if needed; safe for single-threaded UI read
+    std::lock_guard<std::mutex> lk(s_filterMutex);
     return s_filters;
 }
 
-uint64_t PacketCapture::TotalCaptured() { return s_totalCaptured; }
-uint64_t PacketCapture::TotalDropped()  { return s_totalDropped;  }
+uint64_t PacketCapture::TotalCaptured() { return s_totalCaptured.load(); }
+uint64_t PacketCapture::TotalDropped()  { return s_totalDropped.load();  }
+
+PoolStats PacketCapture::PayloadStats()
+{
+    PoolStats st;
+    for (auto& part : s_parts)
+    {
+        std::lock_guard<std::mutex> lk(part.mutex);
+        if (part.used) st += part.ring.Pool().Stats();
+    }
+    return st;
+}
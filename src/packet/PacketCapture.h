@@ -1,20 +1,50 @@
 #pragma once
 #include <cstdint>
 #include <vector>
-#include <deque>
 #include <mutex>
 #include <string>
 #include <functional>
+#include <atomic>
 #include "../wow/WowTypes.h"
+#include "../OpcodeInfo.h"
+#include "PacketColumns.h"
+#include "CapturePolicy.h"
 
 // ============================================================
-//  PacketCapture — thread-safe ring buffer for captured packets
+//  PacketCapture — thread-safe ring buffers for captured packets
 //
-//  Hooks call PacketCapture::Push() from the game thread.
-//  The ImGui UI reads via PacketCapture::Snapshot() on the
-//  render thread.  A mutex protects the shared deque.
+//  Hooks never touch this directly: they hand raw bytes to
+//  PacketPipeline, whose worker calls PushBatch().  The ImGui UI
+//  reads via PacketCapture::Snapshot() on the render thread.
+//
+//  Packets are partitioned by connection id (realm, world, ...):
+//  each partition has its own ring, statistics and mutex, so a
+//  reader of one connection never waits on another.  Seqs are
+//  global and increasing, so merged views sort back into capture
+//  order.  Filter rules have their own lock.
+//
+//  Each ring is a PacketColumns store: metadata in dense columns,
+//  payloads deduplicated in a PayloadPool.  Scans (UI list,
+//  per-opcode counts) take a column snapshot; Snapshot() still
+//  materializes packets for consumers that want whole
+//  CapturedPackets.
 // ============================================================
 
+struct ConnectionStats
+{
+    uint8_t  connection = 0;   // ConnectionTracker id, 0 = untracked
+    uint64_t captured   = 0;
+    uint64_t blocked    = 0;   // dropped by a block rule
+    uint64_t cmsg       = 0;
+    uint64_t smsg       = 0;
+    uint64_t bytes      = 0;   // payload bytes stored
+    uint64_t lastSeq    = 0;
+};
+
+// Sees every stored packet, on the pipeline worker, after its seq is
+// assigned.  Must not block (e.g. the shared-memory mirror).
+using CaptureSink = void(*)(const CapturedPacket& pkt);
+
 struct FilterRule
 {
     bool        enabled      = false;
@@ -22,44 +52,96 @@ struct FilterRule
     PacketDirection direction = PacketDirection::CMSG;
     bool        matchAny     = true;         // true = wildcard direction
     bool        blockPacket  = false;        // true = drop instead of log
+    CaptureMode mode         = CaptureMode::Full;   // what a non-block rule stores (CapturePolicy)
+    uint32_t    param        = 0;            // snaplen bytes / N / interval ms
+    OpcodeCategory category  = OpcodeCategory::None;   // with opcode 0: only this category
+
+    bool IsWildcard() const { return !opcode && category == OpcodeCategory::None; }
+    bool MatchesOpcode(uint16_t op) const
+    {
+        if (opcode) return op == opcode;
+        return category == OpcodeCategory::None || OpcodeMeta::Get(op).category == category;
+    }
 };
 
 class PacketCapture
 {
 public:
-    static constexpr size_t kMaxHistory = 2048;
+    static constexpr size_t kMaxHistory    = 2048;   // per connection
+    static constexpr size_t kMaxPartitions = 8;      // least recently used is recycled
 
-    // Called by hooks —————————————————————————————————————————
-    static void Push(PacketDirection dir, uint16_t opcode,
-                     const uint8_t* payload, uint32_t size);
+    // Called by the pipeline worker ——————————————————————————————
+    // Applies filter rules, assigns seqs and stores the batch under
+    // one lock.  Packets are moved out of `batch`; it is left empty.
+    static void PushBatch(std::vector<CapturedPacket>& batch);
 
     // UI accessors ————————————————————————————————————————————
-    // Returns a stable snapshot (copy) for the UI thread.
+    // Returns a stable snapshot (copy) for the UI thread, all connections in seq order.
     static std::vector<CapturedPacket> Snapshot();
+    // One connection only — touches only that partition's lock.
+    static std::vector<CapturedPacket> Snapshot(uint8_t connection);
+    // Only packets with seq > afterSeq (incremental consumers).
+    static std::vector<CapturedPacket> SnapshotSince(uint64_t afterSeq);
+    // Column copy for scans: all connections in seq order, or one (`connection` >= 0).
+    // `out` is reused, so a per-frame caller does not reallocate.
+    static void SnapshotColumns(PacketColumns& out, int connection = -1);
+
+    // One entry per partition in use.
+    static std::vector<ConnectionStats> PerConnection();
 
     static void Clear();
 
+    // Mirror stored packets elsewhere (shared-memory ring, IPC streams).
+    static constexpr size_t kMaxSinks = 8;
+    static bool AddSink(CaptureSink sink);      // false if all slots are taken
+    static void RemoveSink(CaptureSink sink);
+
+    // Background stages (inflate, decode) —————————————————————————
+    // Copy a packet still in the ring out by sequence number.
+    static bool CopyPayload(uint64_t seq, uint16_t& outOpcode, std::vector<uint8_t>& out);
+    // Whole packet (direction, connection, payload) by sequence number.
+    static bool CopyPacket(uint64_t seq, CapturedPacket& out);
+    // Attach the inflated form to a packet still in the ring.
+    static bool AttachInflated(uint64_t seq, std::shared_ptr<const std::vector<uint8_t>> inflated);
+
     // Filter management ———————————————————————————————————————
     static void         AddFilter(const FilterRule& rule);
     static void         RemoveFilter(size_t index);
     static void         ClearFilters();
-    static const std::vector<FilterRule>& GetFilters();
+    static void         SetFilters(const std::vector<FilterRule>& rules);   // replaces all, atomically
+    static std::vector<FilterRule> GetFilters();   // copy: the control server may replace them
 
-    // Returns false if a "block" rule matches (hook should drop the packet)
+    // Returns false if a "block" rule matches (packet is not logged)
     static bool ShouldCapture(PacketDirection dir, uint16_t opcode);
 
     // Stats ———————————————————————————————————————————————————
     static uint64_t TotalCaptured();
     static uint64_t TotalDropped();
+    static PoolStats PayloadStats();   // dedup over all partitions
+    static uint64_t LastSeq() { return s_nextSeq.load(std::memory_order_relaxed) - 1; }   // newest stored
 
     // Microsecond timestamp relative to DLL load
     static uint64_t NowMicros();
 
 private:
-    static inline std::mutex                s_mutex;
-    static inline std::deque<CapturedPacket> s_ring;
+    struct Partition
+    {
+        std::mutex                 mutex;
+        bool                       used;   // written by the worker under `mutex` (static storage: starts false)
+        PacketColumns              ring;
+        ConnectionStats            stats;
+    };
+
+    static bool       Blocked(PacketDirection dir, uint16_t opcode);   // caller holds s_filterMutex
+    static Partition& PartitionFor(uint8_t connection);                // worker only
+
+    static inline Partition                  s_parts[kMaxPartitions];
+    static inline std::mutex                 s_filterMutex;
     static inline std::vector<FilterRule>    s_filters;
-    static inline uint64_t                   s_totalCaptured = 0;
-    static inline uint64_t                   s_totalDropped  = 0;
+    static inline std::atomic<uint64_t>      s_totalCaptured{ 0 };
+    static inline std::atomic<uint64_t>      s_totalDropped{ 0 };
+    static inline std::atomic<uint64_t>      s_nextSeq{ 1 };
+    static inline std::atomic<CaptureSink>   s_sinks[kMaxSinks];
+    static inline std::atomic<uint32_t>      s_sinkCount{ 0 };
     static inline uint64_t                   s_startTime     = 0;  // QueryPerformanceCounter epoch
 };
@@ -0,0 +1,313 @@
+#include "PacketColumns.h"
+#include "OpcodeFilter.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+// ============================================================
+//  Row access
+// ============================================================
+
+const uint8_t* PacketColumns::Content(size_t row, uint32_t& size) const
+{
+    if (const InflatedBytes& inf = Inflated(row))
+    {
+        size = static_cast<uint32_t>(inf->size());
+        return inf->data();
+    }
+    size = Stored()[row];
+    return Payload(row);
+}
+
+size_t PacketColumns::Find(uint64_t seq) const
+{
+    const uint64_t* first = Seq();
+    const uint64_t* last  = first + Rows();
+    const uint64_t* it    = std::lower_bound(first, last, seq);
+    return (it != last && *it == seq) ? static_cast<size_t>(it - first) : npos;
+}
+
+size_t PacketColumns::UpperBound(uint64_t seq) const
+{
+    const uint64_t* first = Seq();
+    return static_cast<size_t>(std::upper_bound(first, first + Rows(), seq) - first);
+}
+
+CapturedPacket PacketColumns::Packet(size_t row) const
+{
+    CapturedPacket pkt;
+    pkt.seq          = Seq()[row];
+    pkt.connection   = Connection()[row];
+    pkt.direction    = static_cast<PacketDirection>(Direction()[row]);
+    pkt.opcode       = Opcode()[row];
+    pkt.size         = Size()[row];
+    pkt.timestamp_us = Timestamp()[row];
+    pkt.payload.assign(Payload(row), Payload(row) + Stored()[row]);
+    pkt.inflated     = Inflated(row);
+    return pkt;
+}
+
+SharedPacket PacketColumns::Shared(size_t row) const
+{
+    SharedPacket pkt;
+    pkt.seq          = Seq()[row];
+    pkt.connection   = Connection()[row];
+    pkt.direction    = static_cast<PacketDirection>(Direction()[row]);
+    pkt.opcode       = Opcode()[row];
+    pkt.size         = Size()[row];
+    pkt.timestamp_us = Timestamp()[row];
+    pkt.payload      = m_pool.Share(m_blob[m_head + row]);
+    pkt.inflated     = Inflated(row);
+    return pkt;
+}
+
+void PacketColumns::ToPackets(size_t firstRow, std::vector<CapturedPacket>& out) const
+{
+    out.reserve(out.size() + (Rows() - firstRow));
+    for (size_t r = firstRow; r < Rows(); ++r)
+        out.push_back(Packet(r));
+}
+
+void PacketColumns::ToShared(size_t firstRow, std::vector<SharedPacket>& out) const
+{
+    out.reserve(out.size() + (Rows() - firstRow));
+    for (size_t r = firstRow; r < Rows(); ++r)
+        out.push_back(Shared(r));
+}
+
+// ============================================================
+//  Writers
+// ============================================================
+
+void PacketColumns::Append(const CapturedPacket& pkt)
+{
+    m_seq.push_back(pkt.seq);
+    m_timestamp.push_back(pkt.timestamp_us);
+    m_opcode.push_back(pkt.opcode);
+    m_direction.push_back(static_cast<uint8_t>(pkt.direction));
+    m_connection.push_back(pkt.connection);
+    m_size.push_back((std::max)(pkt.size, static_cast<uint32_t>(pkt.payload.size())));
+    m_stored.push_back(static_cast<uint32_t>(pkt.payload.size()));
+    m_blob.push_back(m_pool.Intern(pkt.payload.data(), static_cast<uint32_t>(pkt.payload.size())));
+    m_inflated.push_back(pkt.inflated);
+}
+
+void PacketColumns::Append(const SharedPacket& pkt)
+{
+    m_seq.push_back(pkt.seq);
+    m_timestamp.push_back(pkt.timestamp_us);
+    m_opcode.push_back(pkt.opcode);
+    m_direction.push_back(static_cast<uint8_t>(pkt.direction));
+    m_connection.push_back(pkt.connection);
+    m_size.push_back((std::max)(pkt.size, pkt.payload.Size()));
+    m_stored.push_back(pkt.payload.Size());
+    m_blob.push_back(pkt.payload ? m_pool.Adopt(pkt.payload) : m_pool.Intern(nullptr, 0));
+    m_inflated.push_back(pkt.inflated);
+}
+
+// Copies the source rows' columns; the pool shares the source blocks.
+// Payloads equal across the two stores stay separate blobs.
+void PacketColumns::AppendRows(const PacketColumns& src, size_t firstRow, size_t count)
+{
+    if (!count) return;
+    const size_t s = src.m_head + firstRow;
+    const size_t e = s + count;
+    const size_t first = m_blob.size();
+
+    m_seq.insert(m_seq.end(),               src.m_seq.begin() + s,        src.m_seq.begin() + e);
+    m_timestamp.insert(m_timestamp.end(),   src.m_timestamp.begin() + s,  src.m_timestamp.begin() + e);
+    m_opcode.insert(m_opcode.end(),         src.m_opcode.begin() + s,     src.m_opcode.begin() + e);
+    m_direction.insert(m_direction.end(),   src.m_direction.begin() + s,  src.m_direction.begin() + e);
+    m_connection.insert(m_connection.end(), src.m_connection.begin() + s, src.m_connection.begin() + e);
+    m_size.insert(m_size.end(),             src.m_size.begin() + s,       src.m_size.begin() + e);
+    m_stored.insert(m_stored.end(),         src.m_stored.begin() + s,     src.m_stored.begin() + e);
+    m_blob.insert(m_blob.end(),             src.m_blob.begin() + s,       src.m_blob.begin() + e);
+    m_inflated.insert(m_inflated.end(),     src.m_inflated.begin() + s,   src.m_inflated.begin() + e);
+
+    m_pool.Merge(src.m_pool, m_blob.data() + first, count);
+}
+
+void PacketColumns::DropOldest(size_t count)
+{
+    count = (std::min)(count, Rows());
+    for (size_t i = m_head; i < m_head + count; ++i)
+        m_pool.Release(m_blob[i]);
+    m_head += count;
+    Compact();
+}
+
+// Once the dead prefix is at least as long as the live rows, move
+// the live rows to the front: each row is moved about once over
+// its lifetime, and the columns stay contiguous.  Released blobs
+// free their blocks in the pool.
+void PacketColumns::Compact()
+{
+    if (m_head < 64 || m_head < Rows()) return;
+
+    const size_t dead = m_head;
+
+    m_seq.erase(m_seq.begin(), m_seq.begin() + dead);
+    m_timestamp.erase(m_timestamp.begin(), m_timestamp.begin() + dead);
+    m_opcode.erase(m_opcode.begin(), m_opcode.begin() + dead);
+    m_direction.erase(m_direction.begin(), m_direction.begin() + dead);
+    m_connection.erase(m_connection.begin(), m_connection.begin() + dead);
+    m_size.erase(m_size.begin(), m_size.begin() + dead);
+    m_stored.erase(m_stored.begin(), m_stored.begin() + dead);
+    m_blob.erase(m_blob.begin(), m_blob.begin() + dead);
+    m_inflated.erase(m_inflated.begin(), m_inflated.begin() + dead);
+    m_head = 0;
+}
+
+// Swaps with a per-type scratch column, so repeated sorts keep both buffers.
+template <typename T>
+static void Gather(std::vector<T>& col, size_t head, const std::vector<uint32_t>& order)
+{
+    static thread_local std::vector<T> s_scratch;
+    s_scratch.resize(order.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        s_scratch[i] = std::move(col[head + order[i]]);
+    col.swap(s_scratch);
+    s_scratch.clear();
+}
+
+void PacketColumns::SortBySeq()
+{
+    if (std::is_sorted(Seq(), Seq() + Rows())) return;
+
+    // Merged stores are a few sorted runs: merge them pairwise.
+    static thread_local std::vector<uint32_t> order;
+    order.resize(Rows());
+    std::iota(order.begin(), order.end(), 0u);
+    const uint64_t* seq  = Seq();
+    auto            less = [seq](uint32_t a, uint32_t b) { return seq[a] < seq[b]; };
+    size_t sortedEnd = 1;
+    while (sortedEnd < order.size() && seq[sortedEnd - 1] < seq[sortedEnd]) ++sortedEnd;
+    while (sortedEnd < order.size())
+    {
+        size_t runEnd = sortedEnd + 1;
+        while (runEnd < order.size() && seq[runEnd - 1] < seq[runEnd]) ++runEnd;
+        std::inplace_merge(order.begin(), order.begin() + sortedEnd, order.begin() + runEnd, less);
+        sortedEnd = runEnd;
+    }
+
+    // Payload bytes stay where they are; only the blob ids move.
+    Gather(m_seq, m_head, order);
+    Gather(m_timestamp, m_head, order);
+    Gather(m_opcode, m_head, order);
+    Gather(m_direction, m_head, order);
+    Gather(m_connection, m_head, order);
+    Gather(m_size, m_head, order);
+    Gather(m_stored, m_head, order);
+    Gather(m_blob, m_head, order);
+    Gather(m_inflated, m_head, order);
+    m_head = 0;
+}
+
+void PacketColumns::Clear()
+{
+    m_head = 0;
+    m_seq.clear();
+    m_timestamp.clear();
+    m_opcode.clear();
+    m_direction.clear();
+    m_connection.clear();
+    m_size.clear();
+    m_stored.clear();
+    m_blob.clear();
+    m_inflated.clear();
+    m_pool.Clear();
+}
+
+// ============================================================
+//  ColumnScan
+// ============================================================
+
+size_t ColumnScan::Select(const PacketColumns& cols, const ColumnQuery& q, std::vector<uint32_t>& rows)
+{
+    constexpr size_t kBlock = 512;
+    const size_t n = cols.Rows();
+    rows.resize(n);
+
+    const uint8_t*  dir  = cols.Direction();
+    const uint64_t* ts   = cols.Timestamp();
+    const uint8_t*  conn = cols.Connection();
+    const uint16_t* op   = cols.Opcode();
+
+    const uint8_t  passCmsg  = q.cmsg ? 1 : 0;
+    const uint8_t  passSmsg  = q.smsg ? 1 : 0;
+    const bool     timed     = q.fromUs != 0 || q.toUs != ~uint64_t(0);
+    const uint8_t  connId    = static_cast<uint8_t>(q.connection);
+
+    uint8_t keep[kBlock];
+    size_t  out = 0;
+    for (size_t base = 0; base < n; base += kBlock)
+    {
+        const size_t len = (std::min)(kBlock, n - base);
+
+        for (size_t i = 0; i < len; ++i)
+            keep[i] = dir[base + i] == 0 ? passCmsg : passSmsg;
+        if (timed)
+            for (size_t i = 0; i < len; ++i)
+                keep[i] &= static_cast<uint8_t>((ts[base + i] >= q.fromUs) & (ts[base + i] <= q.toUs));
+        if (q.connection >= 0)
+            for (size_t i = 0; i < len; ++i)
+                keep[i] &= static_cast<uint8_t>(conn[base + i] == connId);
+        if (q.opcodes)
+            for (size_t i = 0; i < len; ++i)
+                keep[i] &= static_cast<uint8_t>(q.opcodes->Test(static_cast<PacketDirection>(dir[base + i]), op[base + i]));
+
+        for (size_t i = 0; i < len; ++i)
+        {
+            rows[out] = static_cast<uint32_t>(base + i);
+            out += keep[i];
+        }
+    }
+    rows.resize(out);
+    return out;
+}
+
+void ColumnScan::CountByOpcode(const PacketColumns& cols, const std::vector<uint32_t>* rows, std::vector<OpcodeCount>& out)
+{
+    // Indexed by direction << 16 | opcode; only touched slots are reset.
+    static thread_local std::vector<uint32_t> s_packets;
+    static thread_local std::vector<uint64_t> s_bytes;
+    static thread_local std::vector<uint32_t> s_touched;
+    if (s_packets.empty())
+    {
+        s_packets.assign(2u << 16, 0);
+        s_bytes.assign(2u << 16, 0);
+    }
+    s_touched.clear();
+
+    const uint16_t* op   = cols.Opcode();
+    const uint8_t*  dir  = cols.Direction();
+    const uint32_t* size = cols.Size();
+    auto count = [&](size_t r)
+    {
+        const uint32_t key = (static_cast<uint32_t>(dir[r] & 1) << 16) | op[r];
+        if (s_packets[key]++ == 0) s_touched.push_back(key);
+        s_bytes[key] += size[r];
+    };
+    if (rows) for (uint32_t r : *rows) count(r);
+    else      for (size_t r = 0; r < cols.Rows(); ++r) count(r);
+
+    out.clear();
+    out.reserve(s_touched.size());
+    for (uint32_t key : s_touched)
+    {
+        OpcodeCount c;
+        c.opcode    = static_cast<uint16_t>(key);
+        c.direction = static_cast<PacketDirection>(key >> 16);
+        c.packets   = s_packets[key];
+        c.bytes     = s_bytes[key];
+        out.push_back(c);
+        s_packets[key] = 0;
+        s_bytes[key]   = 0;
+    }
+    std::sort(out.begin(), out.end(), [](const OpcodeCount& a, const OpcodeCount& b)
+    {
+        if (a.packets != b.packets) return a.packets > b.packets;
+        if (a.direction != b.direction) return a.direction < b.direction;
+        return a.opcode < b.opcode;
+    });
+}
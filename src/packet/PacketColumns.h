@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "../wow/WowTypes.h"
+#include "PayloadPool.h"
+#include "SharedPacket.h"
+
+class OpcodeFilter;
+
+// ============================================================
+//  PacketColumns — captured packets as a struct of arrays
+//
+//  Metadata lives in dense per-field columns (seq, timestamp,
+//  opcode, direction, connection, wire size, stored size, payload
+//  id) and the payload bytes in a content-addressed PayloadPool,
+//  so a scan over opcodes or times walks a few contiguous arrays
+//  instead of dragging payload vectors through cache, and a
+//  packet repeating an earlier one byte-for-byte costs one row.
+//  The inflated form is a cold column.
+//
+//  Used both as PacketCapture's per-connection ring (rows are
+//  dropped from the front, storage is compacted once half of it
+//  is dead) and as the snapshot the UI scans each frame.
+//
+//  Rows with equal PayloadId() carry identical bytes.  A merged
+//  snapshot may hold equal bytes under several ids; compare
+//  Pool().Hash() to group across connections.
+//
+//  Shared() hands a row out as a SharedPacket holding the stored
+//  block, so views outlive the row without copying its bytes;
+//  Packet() copies them into a CapturedPacket.
+// ============================================================
+
+using InflatedBytes = std::shared_ptr<const std::vector<uint8_t>>;
+
+class PacketColumns
+{
+public:
+    static constexpr size_t npos = ~size_t(0);
+
+    size_t Rows()  const { return m_seq.size() - m_head; }
+    bool   Empty() const { return Rows() == 0; }
+
+    // Dense columns, Rows() entries each, oldest first.
+    const uint64_t* Seq()        const { return m_seq.data()        + m_head; }
+    const uint64_t* Timestamp()  const { return m_timestamp.data()  + m_head; }   // µs since DLL load
+    const uint16_t* Opcode()     const { return m_opcode.data()     + m_head; }
+    const uint8_t*  Direction()  const { return m_direction.data()  + m_head; }   // PacketDirection
+    const uint8_t*  Connection() const { return m_connection.data() + m_head; }
+    const uint32_t* Size()       const { return m_size.data()       + m_head; }   // payload bytes on the wire
+    const uint32_t* Stored()     const { return m_stored.data()     + m_head; }   // payload bytes kept (<= Size)
+    const uint32_t* PayloadId()  const { return m_blob.data()       + m_head; }   // PayloadPool blob
+
+    const uint8_t*       Payload(size_t row)  const { return m_pool.Data(m_blob[m_head + row]); }
+    const InflatedBytes& Inflated(size_t row) const { return m_inflated[m_head + row]; }
+    // What analysis should look at: inflated bytes when present.
+    const uint8_t*       Content(size_t row, uint32_t& size) const;
+
+    // Rows are kept in seq order by the store; Find / UpperBound rely on it.
+    size_t Find(uint64_t seq) const;         // row, or npos
+    size_t UpperBound(uint64_t seq) const;   // first row with seq > `seq`
+
+    CapturedPacket Packet(size_t row) const;
+    SharedPacket   Shared(size_t row) const;
+    void           ToPackets(size_t firstRow, std::vector<CapturedPacket>& out) const;   // appends
+    void           ToShared(size_t firstRow, std::vector<SharedPacket>& out) const;      // appends
+
+    // Writers ————————————————————————————————————————————————————
+    void Append(const CapturedPacket& pkt);
+    void Append(const SharedPacket& pkt);   // keeps the block unless the pool has the bytes
+    void AppendRows(const PacketColumns& src, size_t firstRow, size_t count);
+    void SetInflated(size_t row, InflatedBytes inflated) { m_inflated[m_head + row] = std::move(inflated); }
+    void DropOldest(size_t count);
+    void SortBySeq();   // after merging several stores
+    void Clear();
+
+    size_t             PayloadBytes() const { return m_pool.Stats().uniqueBytes; }
+    const PayloadPool& Pool()         const { return m_pool; }
+
+private:
+    void Compact();
+
+    size_t                     m_head = 0;   // first live row
+    std::vector<uint64_t>      m_seq;
+    std::vector<uint64_t>      m_timestamp;
+    std::vector<uint16_t>      m_opcode;
+    std::vector<uint8_t>       m_direction;
+    std::vector<uint8_t>       m_connection;
+    std::vector<uint32_t>      m_size;
+    std::vector<uint32_t>      m_stored;
+    std::vector<uint32_t>      m_blob;
+    std::vector<InflatedBytes> m_inflated;
+    PayloadPool                m_pool;
+};
+
+// ============================================================
+//  ColumnScan — queries over PacketColumns
+//
+//  Each predicate is one branch-free pass over one column, in
+//  blocks that stay in L1, so the compiler vectorizes the
+//  direction / time / connection compares; matching rows are
+//  then compressed into an index list without branches.
+// ============================================================
+
+struct ColumnQuery
+{
+    bool                cmsg       = true;
+    bool                smsg       = true;
+    int                 connection = -1;            // -1 = any
+    uint64_t            fromUs     = 0;             // inclusive time range
+    uint64_t            toUs       = ~uint64_t(0);
+    const OpcodeFilter* opcodes    = nullptr;       // null = any opcode
+};
+
+struct OpcodeCount
+{
+    uint16_t        opcode    = 0;
+    PacketDirection direction = PacketDirection::CMSG;
+    uint32_t        packets   = 0;
+    uint64_t        bytes     = 0;
+};
+
+namespace ColumnScan
+{
+    // Row indices matching `q`, in row order.  Returns the count.
+    size_t Select(const PacketColumns& cols, const ColumnQuery& q, std::vector<uint32_t>& rows);
+
+    // Packets and payload bytes per (direction, opcode) over `rows`
+    // (all rows when null), most packets first.
+    void CountByOpcode(const PacketColumns& cols, const std::vector<uint32_t>* rows, std::vector<OpcodeCount>& out);
+}
@@ -0,0 +1,450 @@
+#include "PacketFuzzer.h"
+#include "PacketCapture.h"
+#include "PacketReplay.h"
+#include "PacketHash.h"
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+// ============================================================
+//  Helpers
+// ============================================================
+
+const char* MutationKindName(MutationKind k)
+{
+    switch (k)
+    {
+    case MutationKind::BitFlip:     return "BitFlip";
+    case MutationKind::IntBoundary: return "IntBoundary";
+    case MutationKind::LengthSkew:  return "LengthSkew";
+    case MutationKind::Splice:      return "Splice";
+    default:                        return "?";
+    }
+}
+
+static uint32_t ReadLE(const uint8_t* p, uint32_t width)
+{
+    uint32_t v = 0;
+    for (uint32_t i = 0; i < width; ++i)
+        v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+static void WriteLE(uint8_t* p, uint32_t width, uint32_t v)
+{
+    for (uint32_t i = 0; i < width; ++i)
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+// ============================================================
+//  FuzzCorpus
+// ============================================================
+
+bool FuzzCorpus::Add(uint16_t opcode, const uint8_t* payload, uint32_t size)
+{
+    if (size > PacketMutator::kMaxPacket) return false;
+    if (size > 0 && !payload) return false;
+
+    const uint64_t hash = PacketHash::HashPacket(opcode, payload, size);
+    if (!m_hashes.insert(hash).second) return false;
+
+    Seed s;
+    s.hash   = hash;
+    s.opcode = opcode;
+    s.offset = static_cast<uint32_t>(m_arena.size());
+    s.size   = size;
+    if (size > 0)
+        m_arena.insert(m_arena.end(), payload, payload + size);
+
+    m_byOpcode[opcode].push_back(static_cast<uint32_t>(m_seeds.size()));
+    m_seeds.push_back(s);
+    return true;
+}
+
+void FuzzCorpus::Clear()
+{
+    m_seeds.clear();
+    m_arena.clear();
+    m_hashes.clear();
+    m_byOpcode.clear();
+}
+
+const std::vector<uint32_t>* FuzzCorpus::WithOpcode(uint16_t opcode) const
+{
+    auto it = m_byOpcode.find(opcode);
+    return it != m_byOpcode.end() ? &it->second : nullptr;
+}
+
+// ============================================================
+//  PacketMutator
+// ============================================================
+
+PacketMutator::PacketMutator(uint64_t seed)
+    : m_state(seed ? seed : 0x2545F4914F6CDD1DULL)
+{
+}
+
+// xorshift64*
+uint64_t PacketMutator::Next()
+{
+    m_state ^= m_state >> 12;
+    m_state ^= m_state << 25;
+    m_state ^= m_state >> 27;
+    return m_state * 0x2545F4914F6CDD1DULL;
+}
+
+uint32_t PacketMutator::Below(uint32_t bound)
+{
+    // Lemire's multiply-shift reduction; bias is irrelevant for fuzzing.
+    return static_cast<uint32_t>(((Next() >> 32) * static_cast<uint64_t>(bound)) >> 32);
+}
+
+void PacketMutator::BitFlip(uint8_t* buf, uint32_t size)
+{
+    if (size == 0) return;
+    const uint32_t bit = Below(size * 8);
+    buf[bit >> 3] ^= static_cast<uint8_t>(1u << (bit & 7));
+}
+
+void PacketMutator::IntBoundary(uint8_t* buf, uint32_t size)
+{
+    static constexpr uint32_t kWidths[3] = { 1, 2, 4 };
+    uint32_t width = kWidths[Below(3)];
+    while (width > size) width >>= 1;
+    if (width == 0) return;
+
+    const uint32_t bits = width * 8;
+    const uint32_t umax = (bits == 32) ? 0xFFFFFFFFu : ((1u << bits) - 1);
+    const uint32_t smin = 1u << (bits - 1);
+    const uint32_t values[7] = { 0, 1, umax, umax - 1, smin, smin - 1, smin + 1 };
+
+    const uint32_t off = Below(size - width + 1);
+    WriteLE(buf + off, width, values[Below(7)]);
+}
+
+// Structure-aware length mutation.  WoW packets carry lots of
+// uint8/uint16/uint32 length prefixes (strings, arrays, addon blobs);
+// a field whose value equals the number of bytes that follow it is
+// almost certainly one.  Skew it so the server parses past/short of
+// the real data.  Without a candidate, change the real length instead.
+uint32_t PacketMutator::LengthSkew(uint8_t* buf, uint32_t size)
+{
+    if (size > 1)
+    {
+        const uint32_t start = Below(size);
+        for (uint32_t n = 0; n < size; ++n)
+        {
+            const uint32_t off = (start + n) % size;
+            for (uint32_t width = 4; width >= 1; width >>= 1)
+            {
+                if (off + width > size) continue;
+                const uint32_t remaining = size - off - width;
+                if (remaining == 0 || ReadLE(buf + off, width) != remaining) continue;
+
+                const uint32_t umax = (width == 4) ? 0xFFFFFFFFu : ((1u << (width * 8)) - 1);
+                uint32_t skewed;
+                switch (Below(4))
+                {
+                case 0:  skewed = remaining + 1;          break;
+                case 1:  skewed = remaining - 1;          break;
+                case 2:  skewed = remaining + 1 + Below(64); break;
+                default: skewed = umax;                   break;
+                }
+                WriteLE(buf + off, width, skewed & umax);
+                return size;
+            }
+        }
+    }
+
+    // No length prefix found: truncate or extend the payload itself.
+    if (size > 0 && (Next() & 1))
+        return Below(size);
+
+    const uint32_t grow = std::min<uint32_t>(1 + Below(16), kMaxPacket - size);
+    for (uint32_t i = 0; i < grow; ++i)
+        buf[size + i] = static_cast<uint8_t>(Next());
+    return size + grow;
+}
+
+uint32_t PacketMutator::Splice(const FuzzCorpus& corpus, size_t seedIndex, uint8_t* buf, uint32_t size)
+{
+    const FuzzCorpus::Seed& self = corpus.At(seedIndex);
+    const std::vector<uint32_t>* peers = corpus.WithOpcode(self.opcode);
+    if (!peers || peers->size() < 2) return size;
+
+    const uint32_t n = static_cast<uint32_t>(peers->size());
+    uint32_t pick = Below(n);
+    if ((*peers)[pick] == seedIndex)
+        pick = (pick + 1) % n;
+
+    const FuzzCorpus::Seed& donor = corpus.At((*peers)[pick]);
+    const uint32_t cutA = Below(size + 1);
+    const uint32_t cutB = Below(donor.size + 1);
+    const uint32_t tail = std::min(donor.size - cutB, kMaxPacket - cutA);
+
+    memcpy(buf + cutA, corpus.Bytes(donor) + cutB, tail);
+    return cutA + tail;
+}
+
+uint32_t PacketMutator::Mutate(const FuzzCorpus& corpus, size_t seedIndex, const FuzzConfig& cfg,
+                               uint8_t* out, uint32_t& outKinds)
+{
+    const FuzzCorpus::Seed& seed = corpus.At(seedIndex);
+    uint32_t size = seed.size;
+    memcpy(out, corpus.Bytes(seed), size);
+
+    outKinds = 0;
+    const uint32_t mask = cfg.kindMask & ((1u << static_cast<uint32_t>(MutationKind::Count)) - 1);
+    if (mask == 0) return size;
+
+    const uint32_t count = 1 + Below(std::max<uint32_t>(cfg.maxMutations, 1));
+    for (uint32_t m = 0; m < count; ++m)
+    {
+        // Pick an enabled kind: rotate from a random start until a set bit.
+        uint32_t k = Below(static_cast<uint32_t>(MutationKind::Count));
+        while (!(mask & (1u << k)))
+            k = (k + 1) % static_cast<uint32_t>(MutationKind::Count);
+
+        switch (static_cast<MutationKind>(k))
+        {
+        case MutationKind::BitFlip:     BitFlip(out, size);                     break;
+        case MutationKind::IntBoundary: IntBoundary(out, size);                 break;
+        case MutationKind::LengthSkew:  size = LengthSkew(out, size);           break;
+        case MutationKind::Splice:      size = Splice(corpus, seedIndex, out, size); break;
+        default: break;
+        }
+        outKinds |= 1u << k;
+    }
+    return size;
+}
+
+// ============================================================
+//  PacketFuzzer — corpus management
+// ============================================================
+
+size_t PacketFuzzer::SeedFromCapture(uint16_t opcode)
+{
+    std::vector<CapturedPacket> pkts = PacketCapture::Snapshot();
+
+    std::lock_guard<std::mutex> lk(s_mutex);
+    size_t added = 0;
+    for (const auto& p : pkts)
+    {
+        if (p.direction != PacketDirection::CMSG) continue;
+        if (opcode != 0 && p.opcode != opcode)   continue;
+        if (s_corpus.Add(p.opcode, p.payload.data(), static_cast<uint32_t>(p.payload.size())))
+            ++added;
+    }
+    return added;
+}
+
+bool PacketFuzzer::AddSeed(uint16_t opcode, const uint8_t* payload, uint32_t size)
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    return s_corpus.Add(opcode, payload, size);
+}
+
+void PacketFuzzer::ClearCorpus()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    s_corpus.Clear();
+}
+
+size_t PacketFuzzer::CorpusSize()
+{
+    std::lock_guard<std::mutex> lk(s_mutex);
+    return s_corpus.Size();
+}
+
+// Picks a seed index honoring cfg.opcode.  Caller holds s_mutex.
+static bool PickSeed(const FuzzCorpus& corpus, const FuzzConfig& cfg, PacketMutator& rng, size_t& outIndex)
+{
+    if (cfg.opcode != 0)
+    {
+        const std::vector<uint32_t>* list = corpus.WithOpcode(cfg.opcode);
+        if (!list || list->empty()) return false;
+        outIndex = (*list)[rng.Below(static_cast<uint32_t>(list->size()))];
+        return true;
+    }
+    if (corpus.Size() == 0) return false;
+    outIndex = rng.Below(static_cast<uint32_t>(corpus.Size()));
+    return true;
+}
+
+static uint64_t ClockSeed()
+{
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) | 1;
+}
+
+// ============================================================
+//  PacketFuzzer — send loop
+// ============================================================
+
+bool PacketFuzzer::Start(const FuzzConfig& cfg)
+{
+    if (s_running.load()) return false;
+    if (cfg.packetsPerSecond == 0) return false;
+    if (s_worker.joinable()) s_worker.join();   // previous run ended on maxPackets
+
+    {
+        std::lock_guard<std::mutex> lk(s_wakeMutex);
+        s_ringHead  = 0;
+        s_ringCount = 0;
+    }
+    s_running.store(true);
+    s_worker = std::thread(&PacketFuzzer::WorkerMain, cfg);
+    return true;
+}
+
+void PacketFuzzer::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(s_wakeMutex);
+        s_running.store(false);
+    }
+    s_wake.notify_all();
+    if (s_worker.joinable() && s_worker.get_id() != std::this_thread::get_id())
+        s_worker.join();
+
+    std::lock_guard<std::mutex> lk(s_wakeMutex);
+    s_ringCount = 0;
+}
+
+void PacketFuzzer::RunQueuedSends()
+{
+    static uint8_t buf[PacketMutator::kMaxPacket];   // main thread only
+    for (size_t n = 0; n < kMaxQueuedSends; ++n)
+    {
+        uint16_t opcode;
+        uint32_t size;
+        {
+            std::lock_guard<std::mutex> lk(s_wakeMutex);
+            if (!s_ringCount) return;
+            const QueuedMutant& m = s_ring[s_ringHead];
+            opcode = m.opcode;
+            size   = m.size;
+            memcpy(buf, m.bytes, size);
+            s_ringHead = (s_ringHead + 1) % kMaxQueuedSends;
+            --s_ringCount;
+        }
+        s_wake.notify_all();
+
+        if (PacketReplay::Send(opcode, buf, size))
+            s_sent.fetch_add(1, std::memory_order_relaxed);
+        else
+            s_sendFailed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void PacketFuzzer::WorkerMain(FuzzConfig cfg)
+{
+    using clock = std::chrono::steady_clock;
+
+    PacketMutator mutator(cfg.rngSeed ? cfg.rngSeed : ClockSeed());
+    static uint8_t buf[PacketMutator::kMaxPacket];   // one worker at a time
+
+    const auto interval = std::chrono::nanoseconds(1'000'000'000LL / cfg.packetsPerSecond);
+    auto next = clock::now();
+    uint64_t produced = 0;
+
+    while (s_running.load(std::memory_order_relaxed))
+    {
+        uint16_t opcode = 0;
+        uint32_t size   = 0;
+        uint32_t kinds  = 0;
+        bool     have   = false;
+        {
+            std::lock_guard<std::mutex> lk(s_mutex);
+            size_t idx = 0;
+            if (PickSeed(s_corpus, cfg, mutator, idx))
+            {
+                opcode = s_corpus.At(idx).opcode;
+                size   = mutator.Mutate(s_corpus, idx, cfg, buf, kinds);
+                have   = true;
+            }
+        }
+
+        if (have)
+        {
+            s_generated.fetch_add(1, std::memory_order_relaxed);
+            for (uint32_t k = 0; k < static_cast<uint32_t>(MutationKind::Count); ++k)
+                if (kinds & (1u << k))
+                    s_byKind[k].fetch_add(1, std::memory_order_relaxed);
+
+            // Wait for the main thread to free a slot rather than drop the mutant.
+            std::unique_lock<std::mutex> lk(s_wakeMutex);
+            s_wake.wait(lk, [] { return !s_running.load() || s_ringCount < kMaxQueuedSends; });
+            if (!s_running.load()) break;
+            QueuedMutant& m = s_ring[(s_ringHead + s_ringCount) % kMaxQueuedSends];
+            m.opcode = opcode;
+            m.size   = size;
+            memcpy(m.bytes, buf, size);
+            ++s_ringCount;
+
+            if (cfg.maxPackets && ++produced >= cfg.maxPackets)
+            {
+                // The run is over once the main thread has sent the last one.
+                s_wake.wait(lk, [] { return !s_running.load() || s_ringCount == 0; });
+                break;
+            }
+        }
+
+        // Fixed-rate schedule; after a long stall resync instead of bursting.
+        next += interval;
+        const auto now = clock::now();
+        if (next < now - std::chrono::seconds(1))
+            next = now;
+
+        std::unique_lock<std::mutex> lk(s_wakeMutex);
+        s_wake.wait_until(lk, next, [] { return !s_running.load(); });
+    }
+
+    s_running.store(false);
+}
+
+FuzzStats PacketFuzzer::Stats()
+{
+    FuzzStats st;
+    st.generated  = s_generated.load();
+    st.sent       = s_sent.load();
+    st.sendFailed = s_sendFailed.load();
+    for (size_t k = 0; k < static_cast<size_t>(MutationKind::Count); ++k)
+        st.byKind[k] = s_byKind[k].load();
+    return st;
+}
+
+void PacketFuzzer::ResetStats()
+{
+    s_generated  = 0;
+    s_sent       = 0;
+    s_sendFailed = 0;
+    for (auto& k : s_byKind) k = 0;
+}
+
+// ============================================================
+//  Benchmark — raw mutation throughput, nothing is sent
+// ============================================================
+
+double PacketFuzzer::Benchmark(uint32_t iterations, const FuzzConfig& cfg)
+{
+    using clock = std::chrono::steady_clock;
+    static uint8_t buf[PacketMutator::kMaxPacket];
+
+    std::lock_guard<std::mutex> lk(s_mutex);
+    PacketMutator mutator(cfg.rngSeed ? cfg.rngSeed : ClockSeed());
+
+    size_t idx = 0;
+    if (iterations == 0 || !PickSeed(s_corpus, cfg, mutator, idx)) return 0.0;
+
+    uint64_t sink = 0;   // keep the optimizer honest
+    const auto t0 = clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        PickSeed(s_corpus, cfg, mutator, idx);
+        uint32_t kinds = 0;
+        sink += mutator.Mutate(s_corpus, idx, cfg, buf, kinds);
+    }
+    const double secs = std::chrono::duration<double>(clock::now() - t0).count();
+    buf[0] ^= static_cast<uint8_t>(sink);
+    return secs > 0.0 ? iterations / secs : 0.0;
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
+#include "../wow/WowTypes.h"
+
+// ============================================================
+//  PacketFuzzer — structure-aware CMSG mutation fuzzer
+//
+//  Seeds are captured CMSG packets, deduplicated by payload hash.
+//  Each iteration picks a seed, stacks 1..maxMutations mutations
+//  into a fixed scratch buffer and queues the mutant, paced to
+//  packetsPerSecond on a worker thread.  The worker never calls
+//  WowConnection::Send: the game's main thread sends the queued
+//  mutants through PacketReplay::Send from the render hook
+//  (RunQueuedSends), like control replays.  A full queue (no frames
+//  drawn) stalls the worker instead of dropping mutants.
+//
+//  Mutation generation never touches the heap: seeds live in an
+//  append-only byte arena, mutants are built in place and queued
+//  into a fixed ring of kMaxQueuedSends slots.
+//  Point PacketReplay::SetSendFn at a stand-in sink to run the
+//  whole thing without a game client (see tools/bench).  Stop() joins
+//  the worker; call it before the hooks are removed.
+// ============================================================
+
+enum class MutationKind : uint8_t
+{
+    BitFlip     = 0,  // flip one random bit
+    IntBoundary = 1,  // overwrite an 8/16/32-bit field with 0, 1, -1, INT_MIN, INT_MAX...
+    LengthSkew  = 2,  // skew a detected length prefix, or truncate/extend the payload
+    Splice      = 3,  // head of this mutant + tail of another seed with the same opcode
+    Count
+};
+
+const char* MutationKindName(MutationKind k);
+
+struct FuzzConfig
+{
+    uint32_t packetsPerSecond = 10;
+    uint32_t maxMutations     = 3;      // 1..N mutations stacked per packet
+    uint32_t kindMask         = 0xF;    // bit (1 << MutationKind) enables a kind
+    uint16_t opcode           = 0;      // 0 = fuzz every opcode in the corpus
+    uint64_t rngSeed          = 0;      // 0 = derive from the clock
+    uint64_t maxPackets       = 0;      // 0 = run until Stop()
+};
+
+struct FuzzStats
+{
+    uint64_t generated  = 0;
+    uint64_t sent       = 0;
+    uint64_t sendFailed = 0;
+    uint64_t byKind[static_cast<size_t>(MutationKind::Count)] = {};
+};
+
+// ------------------------------------------------------------
+//  FuzzCorpus — append-only, hash-deduplicated seed store
+// ------------------------------------------------------------
+class FuzzCorpus
+{
+public:
+    struct Seed
+    {
+        uint64_t hash;
+        uint16_t opcode;
+        uint32_t offset;   // into the byte arena
+        uint32_t size;
+    };
+
+    // Returns false for duplicates (same opcode + payload) and oversized seeds.
+    bool   Add(uint16_t opcode, const uint8_t* payload, uint32_t size);
+    void   Clear();
+
+    size_t         Size() const                 { return m_seeds.size(); }
+    const Seed&    At(size_t i) const           { return m_seeds[i]; }
+    const uint8_t* Bytes(const Seed& s) const   { return m_arena.data() + s.offset; }
+
+    // Indices of every seed with this opcode, or nullptr if none.
+    const std::vector<uint32_t>* WithOpcode(uint16_t opcode) const;
+
+private:
+    std::vector<Seed>                                   m_seeds;
+    std::vector<uint8_t>                                m_arena;
+    std::unordered_set<uint64_t>                        m_hashes;
+    std::unordered_map<uint16_t, std::vector<uint32_t>> m_byOpcode;
+};
+
+// ------------------------------------------------------------
+//  PacketMutator — deterministic, allocation-free mutation engine
+// ------------------------------------------------------------
+class PacketMutator
+{
+public:
+    static constexpr uint32_t kMaxPacket = 8192;  // largest mutant payload
+
+    explicit PacketMutator(uint64_t seed);
+
+    // Builds a mutant of corpus.At(seedIndex) into out (kMaxPacket bytes).
+    // Returns the mutant size; outKinds receives a (1 << MutationKind) mask.
+    uint32_t Mutate(const FuzzCorpus& corpus, size_t seedIndex, const FuzzConfig& cfg,
+                    uint8_t* out, uint32_t& outKinds);
+
+    uint64_t Next();
+    uint32_t Below(uint32_t bound);   // uniform-ish in [0, bound); bound > 0
+
+private:
+    void     BitFlip(uint8_t* buf, uint32_t size);
+    void     IntBoundary(uint8_t* buf, uint32_t size);
+    uint32_t LengthSkew(uint8_t* buf, uint32_t size);
+    uint32_t Splice(const FuzzCorpus& corpus, size_t seedIndex, uint8_t* buf, uint32_t size);
+
+    uint64_t m_state;
+};
+
+// ------------------------------------------------------------
+//  PacketFuzzer — corpus + paced send loop
+// ------------------------------------------------------------
+class PacketFuzzer
+{
+public:
+    static constexpr size_t kMaxQueuedSends = 64;   // mutants waiting for the main thread
+
+    // Pull CMSG packets out of PacketCapture into the corpus.
+    // opcode 0 = every opcode.  Returns the number of new (unique) seeds.
+    static size_t SeedFromCapture(uint16_t opcode = 0);
+    static bool   AddSeed(uint16_t opcode, const uint8_t* payload, uint32_t size);
+    static void   ClearCorpus();
+    static size_t CorpusSize();
+
+    // A run ends on Stop() or once maxPackets mutants were sent; queued
+    // mutants that were not sent yet are discarded by Stop().
+    static bool Start(const FuzzConfig& cfg);
+    static void Stop();
+    static bool IsRunning() { return s_running.load(std::memory_order_relaxed); }
+
+    // Main thread, once per frame: sends the queued mutants.
+    static void RunQueuedSends();
+
+    static FuzzStats Stats();
+    static void      ResetStats();
+
+    // Generate `iterations` mutants without sending.  Returns mutants/sec
+    // (0 if the corpus has no eligible seed).
+    static double Benchmark(uint32_t iterations, const FuzzConfig& cfg);
+
+private:
+    struct QueuedMutant
+    {
+        uint16_t opcode;
+        uint32_t size;
+        uint8_t  bytes[PacketMutator::kMaxPacket];
+    };
+
+    static void WorkerMain(FuzzConfig cfg);
+
+    static inline std::mutex              s_mutex;      // guards s_corpus
+    static inline FuzzCorpus              s_corpus;
+    static inline std::thread             s_worker;
+    static inline std::mutex              s_wakeMutex;  // guards the send ring
+    static inline std::condition_variable s_wake;       // stop, or a ring slot freed
+    static inline QueuedMutant            s_ring[kMaxQueuedSends];
+    static inline size_t                  s_ringHead = 0;
+    static inline size_t                  s_ringCount = 0;
+    static inline std::atomic<bool>       s_running{ false };
+
+    static inline std::atomic<uint64_t>   s_generated{ 0 };
+    static inline std::atomic<uint64_t>   s_sent{ 0 };
+    static inline std::atomic<uint64_t>   s_sendFailed{ 0 };
+    static inline std::atomic<uint64_t>   s_byKind[static_cast<size_t>(MutationKind::Count)] = {};
+};
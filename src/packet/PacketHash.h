@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// ============================================================
+//  PacketHash — fast non-cryptographic 64-bit payload hash
+//
+//  8 bytes per step (multiply/rotate, xxHash64 primes) with a
+//  MurmurHash3 fmix64 finalizer.  Good enough to key dedup sets
+//  and caches; not collision-resistant against a hostile server.
+//  Byte-order dependent, so only use it for in-process keys.
+// ============================================================
+
+namespace PacketHash
+{
+    constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+
+    inline uint64_t Rotl(uint64_t v, int r) { return (v << r) | (v >> (64 - r)); }
+
+    inline uint64_t Avalanche(uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    inline uint64_t Hash(const uint8_t* data, size_t len, uint64_t seed = 0)
+    {
+        uint64_t h = seed ^ (static_cast<uint64_t>(len) * kPrime1);
+        size_t i = 0;
+        for (; i + 8 <= len; i += 8)
+        {
+            uint64_t k;
+            memcpy(&k, data + i, 8);
+            k *= kPrime2;
+            k  = Rotl(k, 31);
+            k *= kPrime1;
+            h ^= k;
+            h  = Rotl(h, 27) * kPrime1 + 0x52DCE729;
+        }
+
+        uint64_t tail = 0;
+        for (int shift = 0; i < len; ++i, shift += 8)
+            tail |= static_cast<uint64_t>(data[i]) << shift;
+        h ^= Rotl(tail * kPrime2, 31) * kPrime1;
+
+        return Avalanche(h);
+    }
+
+    // Identity of a whole packet: two packets with equal payloads but
+    // different opcodes must not collapse into one entry.
+    inline uint64_t HashPacket(uint16_t opcode, const uint8_t* payload, uint32_t size)
+    {
+        return Hash(payload, size, (static_cast<uint64_t>(opcode) + 1) * kPrime2);
+    }
+}
@@ -0,0 +1,213 @@
+#include "PacketInflater.h"
+#include "PacketCapture.h"
+#include "PacketHash.h"
+#include "Opcodes.h"
+#include <cstring>
+
+#if PACKETGOD_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// ============================================================
+//  Compressed opcodes (OpcodeInfo kZlibBodies)
+// ============================================================
+
+int PacketInflater::RawSizeOffset(uint16_t opcode)
+{
+    const OpcodeInfo& info = OpcodeMeta::Get(opcode);
+    return info.compressed ? info.zlibAt : -1;
+}
+
+bool PacketInflater::Available()
+{
+#if PACKETGOD_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ============================================================
+//  Inflate one payload
+// ============================================================
+
+bool PacketInflater::Inflate(uint16_t opcode, const uint8_t* payload, uint32_t size, std::vector<uint8_t>& out)
+{
+#if PACKETGOD_HAVE_ZLIB
+    const int off = RawSizeOffset(opcode);
+    if (off < 0 || !payload || size < static_cast<uint32_t>(off) + 4) return false;
+
+    uint32_t rawSize;
+    memcpy(&rawSize, payload + off, 4);
+    if (rawSize == 0 || rawSize > kMaxInflated) return false;
+
+    const uint32_t zlen = size - static_cast<uint32_t>(off) - 4;
+    out.resize(rawSize);
+
+    z_stream zs = {};
+    zs.next_in   = const_cast<Bytef*>(payload + off + 4);
+    zs.avail_in  = zlen;
+    zs.next_out  = out.data();
+    zs.avail_out = rawSize;
+    if (inflateInit(&zs) != Z_OK) return false;
+
+    const int rc = inflate(&zs, Z_FINISH);
+    const uLong produced = zs.total_out;
+    inflateEnd(&zs);
+
+    // A short stream would leave the tail of `out` unwritten; a long
+    // one is cut off (Z_BUF_ERROR above).  Either way rawSize lied.
+    if (rc != Z_STREAM_END || produced != rawSize) return false;
+    return true;
+#else
+    (void)opcode; (void)payload; (void)size; (void)out;
+    return false;
+#endif
+}
+
+// ============================================================
+//  Worker pool
+// ============================================================
+
+void PacketInflater::Start(unsigned threads)
+{
+    if (!Available() || s_running.load()) return;
+    if (threads == 0) threads = 1;
+
+    s_running.store(true);
+    for (unsigned i = 0; i < threads; ++i)
+        s_workers.emplace_back(&PacketInflater::WorkerMain);
+}
+
+void PacketInflater::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(s_queueMutex);
+        s_running.store(false);
+        s_queue.clear();
+    }
+    s_queueCv.notify_all();
+    for (auto& t : s_workers)
+        if (t.joinable()) t.join();
+    s_workers.clear();
+}
+
+void PacketInflater::Enqueue(uint64_t seq)
+{
+    if (!s_running.load(std::memory_order_relaxed)) return;
+    {
+        std::lock_guard<std::mutex> lk(s_queueMutex);
+        if (s_queue.size() >= kMaxPendingJobs)
+        {
+            s_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        s_queue.push_back(seq);
+    }
+    s_queued.fetch_add(1, std::memory_order_relaxed);
+    s_queueCv.notify_one();
+}
+
+void PacketInflater::WorkerMain()
+{
+    std::vector<uint8_t> payload;   // reused across jobs
+    uint16_t opcode = 0;
+
+    while (true)
+    {
+        uint64_t seq;
+        {
+            std::unique_lock<std::mutex> lk(s_queueMutex);
+            s_queueCv.wait(lk, [] { return !s_running.load() || !s_queue.empty(); });
+            if (!s_running.load()) return;
+            seq = s_queue.front();
+            s_queue.pop_front();
+        }
+
+        if (!PacketCapture::CopyPayload(seq, opcode, payload))
+        {
+            s_evicted.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        const uint32_t size = static_cast<uint32_t>(payload.size());
+        const uint64_t key  = PacketHash::HashPacket(opcode, payload.data(), size);
+
+        std::shared_ptr<const std::vector<uint8_t>> result = CacheFind(key);
+        if (result)
+            s_cacheHits.fetch_add(1, std::memory_order_relaxed);
+        else
+        {
+            auto out = std::make_shared<std::vector<uint8_t>>();
+            if (!Inflate(opcode, payload.data(), size, *out))
+            {
+                s_failed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            s_inflated.fetch_add(1, std::memory_order_relaxed);
+            s_bytesIn.fetch_add(size, std::memory_order_relaxed);
+            s_bytesOut.fetch_add(out->size(), std::memory_order_relaxed);
+            result = std::move(out);
+            CacheInsert(key, result);
+        }
+
+        PacketCapture::AttachInflated(seq, result);
+    }
+}
+
+// ============================================================
+//  LRU cache
+// ============================================================
+
+std::shared_ptr<const std::vector<uint8_t>> PacketInflater::CacheFind(uint64_t key)
+{
+    std::lock_guard<std::mutex> lk(s_cacheMutex);
+    auto it = s_cache.find(key);
+    if (it == s_cache.end()) return nullptr;
+    s_lru.splice(s_lru.begin(), s_lru, it->second.lru);
+    return it->second.data;
+}
+
+void PacketInflater::CacheInsert(uint64_t key, const std::shared_ptr<const std::vector<uint8_t>>& data)
+{
+    if (data->size() > kCacheBudget) return;
+
+    std::lock_guard<std::mutex> lk(s_cacheMutex);
+    if (s_cache.count(key)) return;   // another worker won the race
+
+    s_lru.push_front(key);
+    s_cache[key] = { data, s_lru.begin() };
+    s_cacheBytes += data->size();
+
+    while (s_cacheBytes > kCacheBudget && !s_lru.empty())
+    {
+        auto victim = s_cache.find(s_lru.back());
+        s_cacheBytes -= victim->second.data->size();
+        s_cache.erase(victim);
+        s_lru.pop_back();
+    }
+}
+
+// ============================================================
+//  Stats
+// ============================================================
+
+InflateStats PacketInflater::Stats()
+{
+    InflateStats st;
+    st.queued    = s_queued.load();
+    st.inflated  = s_inflated.load();
+    st.failed    = s_failed.load();
+    st.cacheHits = s_cacheHits.load();
+    st.evicted   = s_evicted.load();
+    st.dropped   = s_dropped.load();
+    st.bytesIn   = s_bytesIn.load();
+    st.bytesOut  = s_bytesOut.load();
+    return st;
+}
+
+size_t PacketInflater::PendingJobs()
+{
+    std::lock_guard<std::mutex> lk(s_queueMutex);
+    return s_queue.size();
+}
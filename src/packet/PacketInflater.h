@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <unordered_map>
+
+// ============================================================
+//  PacketInflater — background zlib stage for compressed packets
+//
+//  PacketCapture::PushBatch only enqueues the packet's sequence number
+//  for compressed opcodes; a small worker pool copies the payload
+//  out of the store, inflates it and attaches the result back to
+//  the CapturedPacket (CapturedPacket::inflated).  Inflating never
+//  runs on the game's network thread.
+//
+//  Results are cached by payload hash (LRU, byte-bounded), so
+//  repeated blobs (account data, identical update bursts) are
+//  inflated once and shared between packets.  The job queue is
+//  bounded too: past kMaxPendingJobs a packet stays opaque and is
+//  counted as dropped.  A stream whose output does not match its
+//  rawSize claim is rejected.
+//
+//  Compressed layouts (3.3.5a):
+//    SMSG_COMPRESSED_UPDATE_OBJECT  [4] rawSize  [N] zlib   → SMSG_UPDATE_OBJECT body
+//    SMSG_COMPRESSED_MOVES          [4] rawSize  [N] zlib   → [1 size][2 opcode][...]*
+//    CMSG_UPDATE_ACCOUNT_DATA       [4] type [4] time [4] rawSize [N] zlib
+//    SMSG_UPDATE_ACCOUNT_DATA       [8] guid [4] type [4] time [4] rawSize [N] zlib
+//
+//  Built without zlib (PACKETGOD_HAVE_ZLIB unset) the stage stays
+//  idle and compressed packets remain opaque.
+// ============================================================
+
+struct InflateStats
+{
+    uint64_t queued    = 0;
+    uint64_t inflated  = 0;
+    uint64_t failed    = 0;
+    uint64_t cacheHits = 0;
+    uint64_t evicted   = 0;   // packet left the ring before its job ran
+    uint64_t dropped   = 0;   // not queued: kMaxPendingJobs already waiting
+    uint64_t bytesIn   = 0;
+    uint64_t bytesOut  = 0;
+};
+
+class PacketInflater
+{
+public:
+    static constexpr uint32_t kMaxInflated  = 8u << 20;   // reject larger rawSize claims
+    static constexpr size_t   kCacheBudget  = 16u << 20;  // bytes of inflated output kept
+    static constexpr size_t   kMaxPendingJobs = 8192;     // queued seqs; further ones are dropped
+
+    static bool Available();   // compiled with zlib
+
+    // Byte offset of the uint32 rawSize field, or -1 if not compressed.
+    static int  RawSizeOffset(uint16_t opcode);
+    static bool IsCompressed(uint16_t opcode) { return RawSizeOffset(opcode) >= 0; }
+
+    // Inflate one payload synchronously.  Used by the workers and tools.
+    static bool Inflate(uint16_t opcode, const uint8_t* payload, uint32_t size, std::vector<uint8_t>& out);
+
+    static void Start(unsigned threads = 2);
+    static void Stop();
+    static bool IsRunning() { return s_running.load(std::memory_order_relaxed); }
+
+    // Called from PacketCapture::PushBatch — O(1), no inflating.
+    static void Enqueue(uint64_t seq);
+
+    static InflateStats Stats();
+    static size_t       PendingJobs();
+
+private:
+    static void WorkerMain();
+    static std::shared_ptr<const std::vector<uint8_t>> CacheFind(uint64_t key);
+    static void CacheInsert(uint64_t key, const std::shared_ptr<const std::vector<uint8_t>>& data);
+
+    // Job queue
+    static inline std::mutex               s_queueMutex;
+    static inline std::condition_variable  s_queueCv;
+    static inline std::deque<uint64_t>     s_queue;
+    static inline std::vector<std::thread> s_workers;
+    static inline std::atomic<bool>        s_running{ false };
+
+    // LRU cache: hash → inflated bytes
+    struct CacheEntry
+    {
+        std::shared_ptr<const std::vector<uint8_t>> data;
+        std::list<uint64_t>::iterator               lru;
+    };
+    static inline std::mutex                              s_cacheMutex;
+    static inline std::unordered_map<uint64_t, CacheEntry> s_cache;
+    static inline std::list<uint64_t>                     s_lru;        // front = most recent
+    static inline size_t                                  s_cacheBytes = 0;
+
+    static inline std::atomic<uint64_t> s_queued{ 0 };
+    static inline std::atomic<uint64_t> s_inflated{ 0 };
+    static inline std::atomic<uint64_t> s_failed{ 0 };
+    static inline std::atomic<uint64_t> s_cacheHits{ 0 };
+    static inline std::atomic<uint64_t> s_evicted{ 0 };
+    static inline std::atomic<uint64_t> s_dropped{ 0 };
+    static inline std::atomic<uint64_t> s_bytesIn{ 0 };
+    static inline std::atomic<uint64_t> s_bytesOut{ 0 };
+};
@@ -0,0 +1,240 @@
+#include "PacketPipeline.h"
+#include "PacketCapture.h"
+#include "CapturePolicy.h"
+#include "../analysis/WorldTracker.h"
+#include <cstring>
+#include <chrono>
+
+static constexpr size_t kRingMask  = PacketPipeline::kRingBytes - 1;
+static constexpr auto   kIdleWait  = std::chrono::milliseconds(2);
+
+static_assert((PacketPipeline::kRingBytes & kRingMask) == 0, "ring size must be a power of two");
+
+static size_t RoundUp(size_t n) { return (n + PacketPipeline::kAlign - 1) & ~(PacketPipeline::kAlign - 1); }
+
+// ============================================================
+//  Lifetime
+//
+//  The ring is allocated once and never freed, so a hook racing
+//  with Stop() still writes into valid memory.
+// ============================================================
+
+void PacketPipeline::Allocate()
+{
+    if (s_ring) return;
+    s_ring.reset(new uint8_t[kRingBytes]);
+    s_commit.reset(new std::atomic<uint32_t>[kRingBytes / kAlign]);
+    for (size_t i = 0; i < kRingBytes / kAlign; ++i)
+        s_commit[i].store(0, std::memory_order_relaxed);
+}
+
+void PacketPipeline::Start()
+{
+    if (s_running.load()) return;
+    Allocate();
+    PacketCapture::NowMicros();   // fix the clock epoch before hooks race to set it
+    s_running.store(true);
+    s_worker = std::thread(&PacketPipeline::WorkerMain);
+}
+
+void PacketPipeline::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(s_wakeMutex);
+        s_running.store(false);
+    }
+    s_wakeCv.notify_all();
+    if (s_worker.joinable()) s_worker.join();
+}
+
+// ============================================================
+//  Producer side  (hooks, any thread)
+// ============================================================
+
+bool PacketPipeline::Enqueue(PacketDirection dir, uint16_t opcode, const uint8_t* payload, uint32_t size,
+                             uint8_t connection)
+{
+    if (!s_commit) return false;
+    if (!payload) size = 0;
+
+    // Capture mode: a skipped packet is only counted; metadata-only and
+    // snaplen records carry fewer payload bytes than the wire size.
+    const uint64_t now  = PacketCapture::NowMicros();
+    uint32_t       keep = size;
+    if (CapturePolicy::IsActive() && !CapturePolicy::Decide(dir, opcode, size, now, keep))
+        return true;
+
+    if (keep > kMaxPayload)
+    {
+        s_droppedLarge.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const uint8_t  flags    = keep == size ? 0 : keep == 0 ? kRecordMetadata : kRecordSnapped;
+    const uint32_t body     = keep + (flags == kRecordSnapped ? 4 : 0);
+    const uint64_t recBytes = kAlign + RoundUp(body);
+
+    // Reserve [pos + pad, pos + pad + recBytes).  A record never wraps:
+    // if it would, the tail of the ring is claimed as padding as well.
+    uint64_t pos = s_write.load(std::memory_order_relaxed);
+    uint64_t pad;
+    for (;;)
+    {
+        const size_t off = static_cast<size_t>(pos & kRingMask);
+        pad = (off + recBytes > kRingBytes) ? kRingBytes - off : 0;
+        if (pos + pad + recBytes - s_read.load(std::memory_order_acquire) > kRingBytes)
+        {
+            s_droppedFull.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (s_write.compare_exchange_weak(pos, pos + pad + recBytes,
+                                          std::memory_order_relaxed, std::memory_order_relaxed))
+            break;
+    }
+
+    if (pad)
+        s_commit[(pos & kRingMask) / kAlign].store(kCommitReady | kCommitPad | static_cast<uint32_t>(pad),
+                                                   std::memory_order_release);
+
+    const size_t off = static_cast<size_t>((pos + pad) & kRingMask);
+    RecordHeader hdr;
+    hdr.timestamp_us = now;
+    hdr.size         = flags == kRecordSnapped ? keep : size;
+    hdr.opcode       = opcode;
+    hdr.direction    = static_cast<uint8_t>(static_cast<uint8_t>(dir) | flags);
+    hdr.connection   = connection;
+    memcpy(&s_ring[off], &hdr, sizeof(hdr));
+    if (flags == kRecordSnapped)
+    {
+        memcpy(&s_ring[off + kAlign], &size, 4);
+        memcpy(&s_ring[off + kAlign + 4], payload, keep);
+    }
+    else if (keep)
+        memcpy(&s_ring[off + kAlign], payload, keep);
+
+    s_commit[off / kAlign].store(kCommitReady | static_cast<uint32_t>(recBytes), std::memory_order_release);
+    s_enqueued.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// ============================================================
+//  Consumer side  (worker)
+// ============================================================
+
+size_t PacketPipeline::DrainBatch(std::vector<CapturedPacket>& batch)
+{
+    if (!s_commit) return 0;
+
+    uint64_t r = s_read.load(std::memory_order_relaxed);
+    const uint64_t used = s_write.load(std::memory_order_relaxed) - r;
+    if (used > s_peakBytes.load(std::memory_order_relaxed))
+        s_peakBytes.store(used, std::memory_order_relaxed);
+
+    size_t taken = 0;
+    while (taken < kMaxBatch)
+    {
+        const size_t   off    = static_cast<size_t>(r & kRingMask);
+        const uint32_t commit = s_commit[off / kAlign].load(std::memory_order_acquire);
+        if (!(commit & kCommitReady)) break;   // empty, or next producer still copying
+
+        if (!(commit & kCommitPad))
+        {
+            RecordHeader hdr;
+            memcpy(&hdr, &s_ring[off], sizeof(hdr));
+
+            CapturedPacket pkt;
+            pkt.connection   = hdr.connection;
+            pkt.direction    = static_cast<PacketDirection>(hdr.direction & 1);
+            pkt.opcode       = hdr.opcode;
+            pkt.size         = hdr.size;
+            pkt.timestamp_us = hdr.timestamp_us;
+            const uint8_t* body = &s_ring[off + kAlign];
+            if (hdr.direction & kRecordSnapped)
+            {
+                memcpy(&pkt.size, body, 4);
+                body += 4;
+            }
+            if (!(hdr.direction & kRecordMetadata))
+                pkt.payload.assign(body, body + hdr.size);
+            batch.push_back(std::move(pkt));
+            ++taken;
+        }
+
+        s_commit[off / kAlign].store(0, std::memory_order_relaxed);
+        r += commit & kLengthMask;
+        s_read.store(r, std::memory_order_release);
+    }
+    return taken;
+}
+
+void PacketPipeline::Publish(std::vector<CapturedPacket>& batch)
+{
+    const uint64_t n = batch.size();
+    s_processed.fetch_add(n, std::memory_order_relaxed);
+    s_batches.fetch_add(1, std::memory_order_relaxed);
+    if (n > s_maxBatch.load(std::memory_order_relaxed))
+        s_maxBatch.store(n, std::memory_order_relaxed);
+
+    PacketCapture::PushBatch(batch);
+}
+
+size_t PacketPipeline::Drain()
+{
+    std::vector<CapturedPacket> batch;
+    size_t total = 0;
+    while (size_t n = DrainBatch(batch))
+    {
+        total += n;
+        Publish(batch);
+    }
+    WorldTracker::Poll();
+    return total;
+}
+
+void PacketPipeline::WorkerMain()
+{
+    std::vector<CapturedPacket> batch;
+    batch.reserve(kMaxBatch);
+
+    while (s_running.load())
+    {
+        if (DrainBatch(batch))
+        {
+            Publish(batch);
+            WorldTracker::Poll();
+            continue;
+        }
+
+        // Idle: late inflate results may unblock the world decoder.
+        WorldTracker::Poll();
+
+        std::unique_lock<std::mutex> lk(s_wakeMutex);
+        s_wakeCv.wait_for(lk, kIdleWait, [] { return !s_running.load(); });
+    }
+
+    // Hooks are removed before Stop(); flush what they left behind.
+    while (DrainBatch(batch))
+        Publish(batch);
+}
+
+// ============================================================
+//  Stats
+// ============================================================
+
+PipelineStats PacketPipeline::Stats()
+{
+    PipelineStats st;
+    st.enqueued     = s_enqueued.load();
+    st.droppedFull  = s_droppedFull.load();
+    st.droppedLarge = s_droppedLarge.load();
+    st.processed    = s_processed.load();
+    st.batches      = s_batches.load();
+    st.maxBatch     = s_maxBatch.load();
+    st.peakBytes    = s_peakBytes.load();
+    return st;
+}
+
+size_t PacketPipeline::PendingBytes()
+{
+    return static_cast<size_t>(s_write.load() - s_read.load());
+}
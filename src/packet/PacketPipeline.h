@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include "../wow/WowTypes.h"
+
+// ============================================================
+//  PacketPipeline — hook → worker hand-off
+//
+//  Hooks call Enqueue(): one CAS to reserve space in a
+//  preallocated byte ring, one timestamp, one memcpy, one release
+//  store to publish.  Nothing else runs on the game's threads.
+//
+//  A single worker drains the ring in batches and runs every
+//  later stage off-thread: filter rules, sequencing and storage
+//  (PacketCapture), inflate scheduling, world-state decoding and
+//  statistics.  The UI only ever reads what the worker published.
+//
+//  Ring layout (kRingBytes, power of two, kAlign-aligned records):
+//    [8] timestamp_us  [4] size  [2] opcode  [1] dir  [1] connection
+//    [N] payload, padded to kAlign
+//  dir carries the CapturePolicy outcome in its high bits: metadata
+//  (size is the wire size, no payload follows) or snapped (size is
+//  the bytes kept, preceded by [4] wire size).
+//  A record that would straddle the end is preceded by a pad
+//  record that fills the tail.  Each record slot has a commit
+//  word in a parallel array; producers publish by storing it,
+//  the worker clears it after consuming.
+//
+//  Full ring or oversize payload → the packet is dropped and
+//  counted; the hook never waits.
+// ============================================================
+
+struct PipelineStats
+{
+    uint64_t enqueued     = 0;
+    uint64_t droppedFull  = 0;   // ring had no room
+    uint64_t droppedLarge = 0;   // payload > kMaxPayload
+    uint64_t processed    = 0;   // records handed to the store
+    uint64_t batches      = 0;
+    uint64_t maxBatch     = 0;
+    uint64_t peakBytes    = 0;   // ring high-water mark
+};
+
+class PacketPipeline
+{
+public:
+    static constexpr size_t   kRingBytes  = 4u << 20;
+    static constexpr size_t   kAlign      = 16;
+    static constexpr uint32_t kMaxPayload = 256u << 10;
+    static constexpr size_t   kMaxBatch   = 256;
+
+    static void Start();
+    static void Stop();       // drains what is already in the ring
+    static bool IsRunning() { return s_running.load(std::memory_order_relaxed); }
+
+    // Called by hooks — bounded copy, never blocks.  False if dropped
+    // (a packet CapturePolicy samples out is counted there, returns true).
+    // `connection` is the ConnectionTracker id (0 = untracked).
+    static bool Enqueue(PacketDirection dir, uint16_t opcode, const uint8_t* payload, uint32_t size,
+                        uint8_t connection = 0);
+
+    // Process everything currently in the ring on the calling thread.
+    // For tools running without Start(); not safe alongside the worker.
+    static size_t Drain();
+
+    static PipelineStats Stats();
+    static size_t        PendingBytes();
+
+private:
+    struct RecordHeader
+    {
+        uint64_t timestamp_us;
+        uint32_t size;
+        uint16_t opcode;
+        uint8_t  direction;
+        uint8_t  connection;
+    };
+    static_assert(sizeof(RecordHeader) == kAlign, "record header must be one slot");
+
+    static constexpr uint8_t  kRecordMetadata = 0x80;   // RecordHeader::direction flags
+    static constexpr uint8_t  kRecordSnapped  = 0x40;
+
+    static constexpr uint32_t kCommitReady = 0x80000000u;
+    static constexpr uint32_t kCommitPad   = 0x40000000u;
+    static constexpr uint32_t kLengthMask  = 0x3FFFFFFFu;
+
+    static void   Allocate();
+    static void   WorkerMain();
+    static size_t DrainBatch(std::vector<CapturedPacket>& batch);
+    static void   Publish(std::vector<CapturedPacket>& batch);
+
+    static inline std::unique_ptr<uint8_t[]>               s_ring;
+    static inline std::unique_ptr<std::atomic<uint32_t>[]> s_commit;   // one per kAlign slot
+    static inline std::atomic<uint64_t> s_write{ 0 };                   // reserved bytes (monotonic)
+    static inline std::atomic<uint64_t> s_read{ 0 };                    // consumed bytes (monotonic)
+
+    static inline std::thread             s_worker;
+    static inline std::mutex              s_wakeMutex;
+    static inline std::condition_variable s_wakeCv;
+    static inline std::atomic<bool>       s_running{ false };
+
+    static inline std::atomic<uint64_t> s_enqueued{ 0 };
+    static inline std::atomic<uint64_t> s_droppedFull{ 0 };
+    static inline std::atomic<uint64_t> s_droppedLarge{ 0 };
+    static inline std::atomic<uint64_t> s_processed{ 0 };
+    static inline std::atomic<uint64_t> s_batches{ 0 };
+    static inline std::atomic<uint64_t> s_maxBatch{ 0 };
+    static inline std::atomic<uint64_t> s_peakBytes{ 0 };
+};
@@ -1,7 +1,20 @@
 #include "PacketReplay.h"
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
 #include <cstring>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+using ReplayClock = std::chrono::steady_clock;
+
+// Sleeps stop this far short of a deadline and the rest is yielded
+// away: Windows sleeps in whole scheduler ticks.
+#ifdef _WIN32
+static constexpr auto kSleepSlack = std::chrono::milliseconds(2);
+#else
+static constexpr auto kSleepSlack = std::chrono::microseconds(200);
+#endif
+// Longest single sleep, so Cancel() is seen promptly.
+static constexpr auto kCancelSlice = std::chrono::milliseconds(10);
 
 void PacketReplay::SetSendFn(fn_WowConn_Send fn, WowConnection* conn)
 {
@@ -9,6 +22,11 @@ void PacketReplay::SetSendFn(fn_WowConn_Send fn, WowConnection* conn)
     s_conn   = conn;
 }
 
+void PacketReplay::SetTargetResolver(fn_ReplayTarget resolver)
+{
+    s_resolver = resolver;
+}
+
 // ============================================================
 //  Low-level: build a packet and send via WowConnection::Send.
 //
@@ -20,21 +38,32 @@ void PacketReplay::SetSendFn(fn_WowConn_Send fn, WowConnection* conn)
 // ============================================================
 bool PacketReplay::Send(uint16_t opcode, const std::vector<uint8_t>& payload)
 {
-    if (!s_sendFn || !s_conn) return false;
+    return Send(opcode, payload.data(), static_cast<uint32_t>(payload.size()));
+}
 
-    const uint32_t payloadLen = static_cast<uint32_t>(payload.size());
+bool PacketReplay::Send(uint16_t opcode, const uint8_t* payload, uint32_t payloadLen)
+{
+    return SendTo(0, opcode, payload, payloadLen);
+}
+
+bool PacketReplay::SendTo(uint8_t connection, uint16_t opcode, const uint8_t* payload, uint32_t payloadLen)
+{
+    WowConnection* conn = Target(connection);
+    if (!s_sendFn || !conn) return false;
 
-    // Build what the game expects: 4-byte opcode LE + payload only
-    std::vector<uint8_t> raw;
-    raw.reserve(4 + payloadLen);
+    // Build what the game expects: 4-byte opcode LE + payload only.
+    // The scratch buffer only ever grows, so repeated sends are allocation-free.
+    thread_local std::vector<uint8_t> raw;
+    raw.resize(4 + static_cast<size_t>(payloadLen));
 
     // 4-byte little-endian opcode (low 2 bytes = opcode, high 2 = 0)
-    raw.push_back(static_cast<uint8_t>( opcode        & 0xFF));
-    raw.push_back(static_cast<uint8_t>((opcode >> 8)  & 0xFF));
-    raw.push_back(0x00);
-    raw.push_back(0x00);
+    raw[0] = static_cast<uint8_t>( opcode        & 0xFF);
+    raw[1] = static_cast<uint8_t>((opcode >> 8)  & 0xFF);
+    raw[2] = 0x00;
+    raw[3] = 0x00;
 
-    raw.insert(raw.end(), payload.begin(), payload.end());
+    if (payloadLen > 0)
+        memcpy(raw.data() + 4, payload, payloadLen);
 
     CDataStore ds = {};
     ds.m_buffer = raw.data();
@@ -43,24 +72,107 @@ bool PacketReplay::Send(uint16_t opcode, const std::vector<uint8_t>& payload)
     ds.m_size   = static_cast<uint32_t>(raw.size());
     ds.m_readPos = 0;
 
-    int result = s_sendFn(s_conn, &ds, 0);
+    int result = s_sendFn(conn, &ds, 0);
     return result != 0;
 }
 
 bool PacketReplay::ReplayCaptured(const CapturedPacket& pkt)
 {
     if (pkt.direction != PacketDirection::CMSG) return false;
-    return Send(pkt.opcode, pkt.payload);
+    if (pkt.Truncated()) return false;   // stored without its full payload
+    return SendTo(pkt.connection, pkt.opcode, pkt.payload.data(), static_cast<uint32_t>(pkt.payload.size()));
 }
 
-bool PacketReplay::ReplaySequence(const std::vector<CapturedPacket>& pkts, uint32_t delayMs)
+bool PacketReplay::ReplayCaptured(const SharedPacket& pkt)
+{
+    if (pkt.direction != PacketDirection::CMSG) return false;
+    if (pkt.Truncated()) return false;
+    return SendTo(pkt.connection, pkt.opcode, pkt.payload.Data(), pkt.payload.Size());
+}
+
+// ============================================================
+//  Sequences
+// ============================================================
+
+// Waits for `deadline`; false if Cancel() was called since `gen` was read.
+static bool WaitUntil(ReplayClock::time_point deadline, const std::atomic<uint32_t>& cancelGen, uint32_t gen)
+{
+    for (;;)
+    {
+        if (cancelGen.load(std::memory_order_relaxed) != gen) return false;
+        const auto now = ReplayClock::now();
+        if (now >= deadline) return true;
+        const auto left = deadline - now;
+        if (left > kSleepSlack)
+            std::this_thread::sleep_for((std::min)(std::chrono::duration_cast<ReplayClock::duration>(left - kSleepSlack),
+                                                   std::chrono::duration_cast<ReplayClock::duration>(kCancelSlice)));
+        else
+            std::this_thread::yield();
+    }
+}
+
+template <typename Packet>
+bool PacketReplay::RunSequence(const std::vector<Packet>& pkts, uint32_t delayMs)
 {
+    const uint32_t gen = s_cancelGen.load(std::memory_order_relaxed);
     bool ok = true;
     for (const auto& pkt : pkts)
     {
         if (pkt.direction != PacketDirection::CMSG) continue;
+        if (s_cancelGen.load(std::memory_order_relaxed) != gen) return false;
         if (!ReplayCaptured(pkt)) ok = false;
-        if (delayMs > 0) Sleep(delayMs);
+        if (delayMs > 0 &&
+            !WaitUntil(ReplayClock::now() + std::chrono::milliseconds(delayMs), s_cancelGen, gen))
+            return false;
     }
     return ok;
 }
+
+bool PacketReplay::ReplaySequence(const std::vector<CapturedPacket>& pkts, uint32_t delayMs)
+{
+    return RunSequence(pkts, delayMs);
+}
+
+bool PacketReplay::ReplaySequence(const std::vector<SharedPacket>& pkts, uint32_t delayMs)
+{
+    return RunSequence(pkts, delayMs);
+}
+
+ReplayResult PacketReplay::ReplayTimed(const std::vector<CapturedPacket>& pkts, double speed)
+{
+    ReplayResult res;
+    if (pkts.empty()) return res;
+
+    const uint32_t gen   = s_cancelGen.load(std::memory_order_relaxed);
+    const uint64_t base  = pkts.front().timestamp_us;
+    const auto     start = ReplayClock::now();
+
+    for (const auto& pkt : pkts)
+    {
+        if (pkt.direction != PacketDirection::CMSG || pkt.Truncated())
+        {
+            ++res.skipped;
+            continue;
+        }
+
+        bool due = s_cancelGen.load(std::memory_order_relaxed) == gen;
+        if (due && speed > 0 && pkt.timestamp_us > base)
+        {
+            const double us = static_cast<double>(pkt.timestamp_us - base) / speed;
+            due = WaitUntil(start + std::chrono::duration_cast<ReplayClock::duration>(
+                                        std::chrono::duration<double, std::micro>(us)),
+                            s_cancelGen, gen);
+        }
+        if (!due)
+        {
+            res.cancelled = true;
+            break;
+        }
+
+        if (SendTo(pkt.connection, pkt.opcode, pkt.payload.data(), static_cast<uint32_t>(pkt.payload.size())))
+            ++res.sent;
+        else
+            ++res.failed;
+    }
+    return res;
+}
@@ -2,7 +2,9 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <atomic>
 #include "../wow/WowTypes.h"
+#include "SharedPacket.h"
 
 // ============================================================
 //  PacketReplay — send stored packets back to the server
@@ -13,30 +15,79 @@
 //
 //  The caller must set the send function pointer before use.
 //  Set it in PacketHooks once WowConnection::Send is found.
+//
+//  Target connection: a resolver maps the connection id a packet
+//  was captured on to the WowConnection to send it to (in the DLL,
+//  ConnectionTracker::ReplayTarget).  Without one, everything goes
+//  to the fixed connection given to SetSendFn.
+//
+//  Sequences run on the calling thread.  Cancel() stops every
+//  sequence in progress, on any thread, before its next packet.
 // ============================================================
 
 // Game signature: int __thiscall WowConnection::Send(WowConnection* this, CDataStore* packet, int priority)
 using fn_WowConn_Send = int(__thiscall*)(WowConnection*, CDataStore*, int);
 
+// Connection id (CapturedPacket::connection, 0 = default/world) → send target.
+using fn_ReplayTarget = WowConnection*(*)(uint8_t connection);
+
+struct ReplayResult
+{
+    uint32_t sent      = 0;
+    uint32_t failed    = 0;       // no target, or Send returned 0
+    uint32_t skipped   = 0;       // SMSG, or stored without its full payload
+    bool     cancelled = false;
+};
+
 class PacketReplay
 {
 public:
     // Must be called with the real WowConnection::Send address before replaying.
+    // `conn` is the fallback target when no resolver is set.
     static void SetSendFn(fn_WowConn_Send fn, WowConnection* conn);
+    static void SetTargetResolver(fn_ReplayTarget resolver);
 
     // Build a raw packet buffer from an opcode + payload and transmit it.
     // Returns false if send function is not set or transmission fails.
     static bool Send(uint16_t opcode, const std::vector<uint8_t>& payload);
 
-    // Replay a previously captured packet (CMSG only).
+    // Same as above from a raw buffer.  Reuses a per-thread scratch buffer,
+    // so steady-state sends (fuzzer, sequences) do not allocate.
+    static bool Send(uint16_t opcode, const uint8_t* payload, uint32_t size);
+
+    // Send on a specific connection id instead of the default one.
+    static bool SendTo(uint8_t connection, uint16_t opcode, const uint8_t* payload, uint32_t size);
+
+    // Replay a previously captured packet (CMSG only) on the connection it came from.
     static bool ReplayCaptured(const CapturedPacket& pkt);
+    static bool ReplayCaptured(const SharedPacket& pkt);
 
     // Replay multiple packets in sequence with an optional delay between each (ms).
     static bool ReplaySequence(const std::vector<CapturedPacket>& pkts, uint32_t delayMs = 0);
+    static bool ReplaySequence(const std::vector<SharedPacket>& pkts, uint32_t delayMs = 0);
+
+    // Replay with the capture's own spacing: packet i is sent at
+    // start + (timestamp_i - timestamp_0) / speed.  speed <= 0 sends
+    // back to back.  Deadlines are absolute, so send cost and sleep
+    // overshoot do not accumulate over the sequence.
+    static ReplayResult ReplayTimed(const std::vector<CapturedPacket>& pkts, double speed = 1.0);
+
+    static void Cancel() { s_cancelGen.fetch_add(1, std::memory_order_relaxed); }
 
-    static bool IsReady() { return s_sendFn != nullptr && s_conn != nullptr; }
+    static bool IsReady() { return s_sendFn != nullptr && Target(0) != nullptr; }
+
+    static WowConnection* Target(uint8_t connection)
+    {
+        return s_resolver ? s_resolver(connection) : s_conn;
+    }
 
 private:
-    static inline fn_WowConn_Send  s_sendFn = nullptr;
-    static inline WowConnection*   s_conn   = nullptr;
+    template <typename Packet>
+    static bool RunSequence(const std::vector<Packet>& pkts, uint32_t delayMs);
+
+    static inline fn_WowConn_Send  s_sendFn   = nullptr;
+    static inline WowConnection*   s_conn     = nullptr;
+    static inline fn_ReplayTarget  s_resolver = nullptr;
+
+    static inline std::atomic<uint32_t> s_cancelGen{ 0 };   // bumped by Cancel()
 };
@@ -0,0 +1,597 @@
+#include "PacketRewriter.h"
+#include "../OpcodeInfo.h"
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <memory>
+#include <thread>
+
+// ============================================================
+//  Compiled form
+//
+//  index[opcode] is 1 + the first op of that opcode's block, or 0.
+//  A block is a sequence of rules ending in End:
+//    Rule(skip → next Rule)  Test...  Commit  Action...
+//  A failed test jumps to the next rule; Commit counts the hit.
+// ============================================================
+
+enum PatchCode : uint8_t
+{
+    OpEnd,
+    OpRule,          // arg = op index of the next rule / End, value = rule index
+    OpTestSize,      // arg = RewriteCmp
+    OpTestField,     // arg = RewriteCmp, mask applied before compare
+    OpCommit,
+    OpWriteField,
+    OpWriteBytes,    // arg = offset into bytes, value = length
+    OpInsert,        // arg = offset into bytes, value = length
+    OpErase,         // value = count
+    OpResize,        // value = new payload size, mask = fill byte
+    OpSetOpcode,     // value = opcode
+};
+
+struct PatchOp
+{
+    uint8_t  code;
+    uint8_t  width;
+    uint16_t offset;
+    uint32_t arg;
+    uint64_t value;
+    uint64_t mask;
+};
+static_assert(sizeof(PatchOp) == 24, "keep ops small; the hook walks them linearly");
+
+struct PacketRewriter::Program
+{
+    std::vector<uint32_t>                    index;   // 65536 entries
+    std::vector<PatchOp>                     ops;
+    std::vector<uint8_t>                     bytes;
+    size_t                                   ruleCount = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> hits;
+};
+
+static uint64_t LoadLE(const uint8_t* p, uint8_t width)
+{
+    uint64_t v = 0;
+    memcpy(&v, p, width);
+    return v;
+}
+
+static void StoreLE(uint8_t* p, uint8_t width, uint64_t v)
+{
+    memcpy(p, &v, width);
+}
+
+static bool Compare(uint64_t a, uint32_t cmp, uint64_t b)
+{
+    switch (static_cast<RewriteCmp>(cmp))
+    {
+    case RewriteCmp::Equal:        return a == b;
+    case RewriteCmp::NotEqual:     return a != b;
+    case RewriteCmp::Less:         return a <  b;
+    case RewriteCmp::Greater:      return a >  b;
+    case RewriteCmp::LessEqual:    return a <= b;
+    case RewriteCmp::GreaterEqual: return a >= b;
+    }
+    return false;
+}
+
+static bool ValidWidth(uint8_t w) { return w == 1 || w == 2 || w == 4 || w == 8; }
+
+// ============================================================
+//  Hot path
+// ============================================================
+
+bool PacketRewriter::Apply(uint8_t* buf, uint32_t& size, uint32_t capacity)
+{
+    if (size < 4) return false;
+
+    s_readers.fetch_add(1, std::memory_order_seq_cst);
+    const Program* prog = s_program.load(std::memory_order_seq_cst);
+    const uint16_t opcode = static_cast<uint16_t>(buf[0] | (buf[1] << 8));
+    bool changed = false;
+    if (prog && prog->index[opcode])
+    {
+        // Reading the clock costs more than most rules; time a sample.
+        const uint64_t n = s_inspected.fetch_add(1, std::memory_order_relaxed);
+        if (n % kTimingSample == 0)
+        {
+            const auto t0 = std::chrono::steady_clock::now();
+            changed = Run(*prog, buf, size, capacity < size ? size : capacity);
+            const uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - t0).count());
+
+            s_timed.fetch_add(1, std::memory_order_relaxed);
+            s_totalNs.fetch_add(ns, std::memory_order_relaxed);
+            uint64_t prev = s_maxNs.load(std::memory_order_relaxed);
+            while (ns > prev && !s_maxNs.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+        }
+        else
+            changed = Run(*prog, buf, size, capacity < size ? size : capacity);
+
+        if (changed) s_rewritten.fetch_add(1, std::memory_order_relaxed);
+    }
+    s_readers.fetch_sub(1, std::memory_order_release);
+    return changed;
+}
+
+bool PacketRewriter::Run(const Program& prog, uint8_t* buf, uint32_t& size, uint32_t capacity)
+{
+    uint8_t*       p       = buf + 4;
+    uint32_t       len     = size - 4;
+    const uint32_t cap     = capacity - 4;
+    uint32_t       next    = 0;
+    bool           changed = false;
+    uint64_t       skipped = 0;
+
+    for (uint32_t pc = prog.index[static_cast<uint16_t>(buf[0] | (buf[1] << 8))] - 1;;)
+    {
+        const PatchOp& op = prog.ops[pc];
+        switch (op.code)
+        {
+        case OpEnd:
+            size = len + 4;
+            if (skipped) s_skipped.fetch_add(skipped, std::memory_order_relaxed);
+            return changed;
+
+        case OpRule:
+            next = op.arg;
+            ++pc;
+            break;
+
+        case OpTestSize:
+            pc = Compare(len, op.arg, op.value) ? pc + 1 : next;
+            break;
+
+        case OpTestField:
+            pc = (op.offset + op.width <= len && Compare(LoadLE(p + op.offset, op.width) & op.mask, op.arg, op.value))
+               ? pc + 1 : next;
+            break;
+
+        case OpCommit:
+            prog.hits[op.value].fetch_add(1, std::memory_order_relaxed);
+            ++pc;
+            break;
+
+        case OpWriteField:
+            if (op.offset + op.width <= len) { StoreLE(p + op.offset, op.width, op.value); changed = true; }
+            else ++skipped;
+            ++pc;
+            break;
+
+        case OpWriteBytes:
+            if (op.offset + op.value <= len) { memcpy(p + op.offset, &prog.bytes[op.arg], op.value); changed = true; }
+            else ++skipped;
+            ++pc;
+            break;
+
+        case OpInsert:
+            if (op.offset <= len && len + op.value <= cap)
+            {
+                memmove(p + op.offset + op.value, p + op.offset, len - op.offset);
+                memcpy(p + op.offset, &prog.bytes[op.arg], op.value);
+                len += static_cast<uint32_t>(op.value);
+                changed = true;
+            }
+            else ++skipped;
+            ++pc;
+            break;
+
+        case OpErase:
+            if (op.offset < len)
+            {
+                const uint32_t n = static_cast<uint32_t>(op.value < len - op.offset ? op.value : len - op.offset);
+                memmove(p + op.offset, p + op.offset + n, len - op.offset - n);
+                len -= n;
+                changed = true;
+            }
+            else ++skipped;
+            ++pc;
+            break;
+
+        case OpResize:
+            if (op.value <= cap)
+            {
+                if (op.value > len) memset(p + len, static_cast<uint8_t>(op.mask), op.value - len);
+                changed |= len != op.value;
+                len = static_cast<uint32_t>(op.value);
+            }
+            else ++skipped;
+            ++pc;
+            break;
+
+        case OpSetOpcode:
+            buf[0] = static_cast<uint8_t>(op.value);
+            buf[1] = static_cast<uint8_t>(op.value >> 8);
+            changed = true;
+            ++pc;
+            break;
+        }
+    }
+}
+
+// ============================================================
+//  Compiler
+// ============================================================
+
+bool PacketRewriter::Compile(const std::vector<RewriteRule>& rules, Program& prog, std::string& error)
+{
+    prog.index.assign(65536, 0);
+    prog.ops.clear();
+    prog.bytes.clear();
+
+    // One block per opcode, rules in their given order within it.
+    std::vector<bool> done(rules.size(), false);
+    for (size_t first = 0; first < rules.size(); ++first)
+    {
+        if (done[first]) continue;
+        const uint16_t opcode = rules[first].opcode;
+        prog.index[opcode] = static_cast<uint32_t>(prog.ops.size()) + 1;
+
+        for (size_t r = first; r < rules.size(); ++r)
+        {
+            const RewriteRule& rule = rules[r];
+            if (done[r] || rule.opcode != opcode) continue;
+            done[r] = true;
+
+            const std::string where = "rule " + std::to_string(r + 1) + (rule.name.empty() ? "" : " (" + rule.name + ")");
+            const size_t ruleOp = prog.ops.size();
+            prog.ops.push_back({ OpRule, 0, 0, 0, r, 0 });
+            for (const RewritePredicate& pr : rule.where)
+            {
+                if (!pr.size && !ValidWidth(pr.width)) { error = where + ": field width must be 1, 2, 4 or 8"; return false; }
+                prog.ops.push_back({ static_cast<uint8_t>(pr.size ? OpTestSize : OpTestField), pr.width, pr.offset,
+                                     static_cast<uint32_t>(pr.cmp), pr.value, pr.mask });
+            }
+            prog.ops.push_back({ OpCommit, 0, 0, 0, r, 0 });
+
+            for (const RewriteAction& a : rule.actions)
+            {
+                PatchOp op = { OpEnd, a.width, a.offset, 0, a.value, 0 };
+                switch (a.kind)
+                {
+                case RewriteActionKind::WriteField:
+                    if (!ValidWidth(a.width)) { error = where + ": field width must be 1, 2, 4 or 8"; return false; }
+                    op.code = OpWriteField;
+                    break;
+                case RewriteActionKind::WriteBytes:
+                case RewriteActionKind::Insert:
+                    if (a.bytes.empty()) { error = where + ": empty byte string"; return false; }
+                    op.code  = a.kind == RewriteActionKind::Insert ? OpInsert : OpWriteBytes;
+                    op.arg   = static_cast<uint32_t>(prog.bytes.size());
+                    op.value = a.bytes.size();
+                    prog.bytes.insert(prog.bytes.end(), a.bytes.begin(), a.bytes.end());
+                    break;
+                case RewriteActionKind::Erase:
+                    op.code = OpErase;
+                    break;
+                case RewriteActionKind::Resize:
+                    op.code = OpResize;
+                    op.mask = a.fill;
+                    break;
+                case RewriteActionKind::SetOpcode:
+                    if (a.value > 0xFFFF) { error = where + ": opcode out of range"; return false; }
+                    op.code = OpSetOpcode;
+                    break;
+                }
+                prog.ops.push_back(op);
+            }
+            prog.ops[ruleOp].arg = static_cast<uint32_t>(prog.ops.size());   // next rule, or End
+        }
+        prog.ops.push_back({ OpEnd, 0, 0, 0, 0, 0 });
+    }
+
+    prog.ruleCount = rules.size();
+    prog.hits.reset(new std::atomic<uint64_t>[rules.size() ? rules.size() : 1]);
+    for (size_t i = 0; i < rules.size(); ++i) prog.hits[i].store(0, std::memory_order_relaxed);
+    return true;
+}
+
+// ============================================================
+//  Install  (UI / control thread)
+//
+//  The hook brackets its use of the program with s_readers, so
+//  once the pointer is swapped and the count has been seen at
+//  zero, no hook can still hold the old program.
+// ============================================================
+
+void PacketRewriter::Swap(Program* prog)
+{
+    Program* old = s_program.exchange(prog, std::memory_order_seq_cst);
+    if (!old) return;
+    while (s_readers.load(std::memory_order_seq_cst) != 0)
+        std::this_thread::yield();
+    delete old;
+}
+
+bool PacketRewriter::Install(const std::vector<RewriteRule>& rules, std::string& error)
+{
+    std::unique_ptr<Program> prog;
+    if (!rules.empty())
+    {
+        prog.reset(new Program);
+        if (!Compile(rules, *prog, error)) return false;
+    }
+
+    std::lock_guard<std::mutex> lk(s_installMutex);
+    Swap(prog.release());
+    s_rules = rules;
+    s_source.clear();
+    return true;
+}
+
+bool PacketRewriter::InstallText(const char* text, std::string& error)
+{
+    std::vector<RewriteRule> rules;
+    if (!Parse(text, rules, error) || !Install(rules, error)) return false;
+    std::lock_guard<std::mutex> lk(s_installMutex);
+    s_source = text;
+    return true;
+}
+
+void PacketRewriter::Clear()
+{
+    std::lock_guard<std::mutex> lk(s_installMutex);
+    Swap(nullptr);
+    s_rules.clear();
+    s_source.clear();
+}
+
+std::string PacketRewriter::Source()
+{
+    std::lock_guard<std::mutex> lk(s_installMutex);
+    return s_source;
+}
+
+std::vector<RewriteRule> PacketRewriter::Rules()
+{
+    std::lock_guard<std::mutex> lk(s_installMutex);
+    return s_rules;
+}
+
+std::vector<uint64_t> PacketRewriter::RuleHits()
+{
+    // Holding the install lock keeps the program alive while it is read.
+    std::lock_guard<std::mutex> lk(s_installMutex);
+    std::vector<uint64_t> out;
+    if (const Program* prog = s_program.load(std::memory_order_acquire))
+        for (size_t i = 0; i < prog->ruleCount; ++i)
+            out.push_back(prog->hits[i].load(std::memory_order_relaxed));
+    return out;
+}
+
+RewriteStats PacketRewriter::Stats()
+{
+    RewriteStats st;
+    st.inspected = s_inspected.load(std::memory_order_relaxed);
+    st.rewritten = s_rewritten.load(std::memory_order_relaxed);
+    st.skipped   = s_skipped.load(std::memory_order_relaxed);
+    st.timed     = s_timed.load(std::memory_order_relaxed);
+    st.totalNs   = s_totalNs.load(std::memory_order_relaxed);
+    st.maxNs     = s_maxNs.load(std::memory_order_relaxed);
+    return st;
+}
+
+void PacketRewriter::ResetStats()
+{
+    s_inspected = 0;
+    s_rewritten = 0;
+    s_skipped   = 0;
+    s_timed     = 0;
+    s_totalNs   = 0;
+    s_maxNs     = 0;
+}
+
+// ============================================================
+//  Text form
+// ============================================================
+
+namespace
+{
+    // Minimal cursor over one line.
+    struct Lexer
+    {
+        const char* p;
+
+        void Skip() { while (*p == ' ' || *p == '\t' || *p == '\r') ++p; }
+        bool AtEnd() { Skip(); return !*p || *p == '#'; }
+
+        bool Eat(const char* tok)
+        {
+            Skip();
+            const size_t n = strlen(tok);
+            if (strncmp(p, tok, n) != 0) return false;
+            // Keywords must not run into an identifier ("if" vs "ifx").
+            if (isalpha(static_cast<unsigned char>(tok[0])) && (isalnum(static_cast<unsigned char>(p[n])) || p[n] == '_'))
+                return false;
+            p += n;
+            return true;
+        }
+
+        bool Ident(std::string& out)
+        {
+            Skip();
+            if (!isalpha(static_cast<unsigned char>(*p)) && *p != '_') return false;
+            const char* s = p;
+            while (isalnum(static_cast<unsigned char>(*p)) || *p == '_') ++p;
+            out.assign(s, p);
+            return true;
+        }
+
+        bool Number(uint64_t& out)
+        {
+            Skip();
+            if (!isdigit(static_cast<unsigned char>(*p))) return false;
+            char* end = nullptr;
+            out = strtoull(p, &end, 0);
+            p = end;
+            return true;
+        }
+
+        bool Hex(std::vector<uint8_t>& out)
+        {
+            Skip();
+            if (*p != '"') return false;
+            ++p;
+            out.clear();
+            int hi = -1;
+            for (; *p && *p != '"'; ++p)
+            {
+                if (*p == ' ') continue;
+                if (!isxdigit(static_cast<unsigned char>(*p))) return false;
+                const int v = isdigit(static_cast<unsigned char>(*p)) ? *p - '0' : (tolower(*p) - 'a' + 10);
+                if (hi < 0) hi = v;
+                else { out.push_back(static_cast<uint8_t>((hi << 4) | v)); hi = -1; }
+            }
+            if (*p != '"' || hi >= 0) return false;
+            ++p;
+            return true;
+        }
+
+        bool Cmp(RewriteCmp& out)
+        {
+            if (Eat("==")) { out = RewriteCmp::Equal;        return true; }
+            if (Eat("!=")) { out = RewriteCmp::NotEqual;     return true; }
+            if (Eat("<=")) { out = RewriteCmp::LessEqual;    return true; }
+            if (Eat(">=")) { out = RewriteCmp::GreaterEqual; return true; }
+            if (Eat("<"))  { out = RewriteCmp::Less;         return true; }
+            if (Eat(">"))  { out = RewriteCmp::Greater;      return true; }
+            return false;
+        }
+
+        bool Opcode(uint16_t& out)
+        {
+            uint64_t v;
+            if (Number(v)) { out = static_cast<uint16_t>(v); return v <= 0xFFFF; }
+            std::string name;
+            return Ident(name) && OpcodeMeta::Find(name.c_str(), out);
+        }
+
+        // u8 / u16 / u32 / u64 → width
+        bool FieldType(uint8_t& width)
+        {
+            if (Eat("u8"))  { width = 1; return true; }
+            if (Eat("u16")) { width = 2; return true; }
+            if (Eat("u32")) { width = 4; return true; }
+            if (Eat("u64")) { width = 8; return true; }
+            return false;
+        }
+
+        bool Offset(uint16_t& out)
+        {
+            uint64_t v;
+            if (!Eat("@") || !Number(v) || v > 0xFFFF) return false;
+            out = static_cast<uint16_t>(v);
+            return true;
+        }
+    };
+
+    bool ParsePredicate(Lexer& lx, RewritePredicate& pr)
+    {
+        if (lx.Eat("size"))
+        {
+            pr.size = true;
+            return lx.Cmp(pr.cmp) && lx.Number(pr.value);
+        }
+        if (!lx.FieldType(pr.width) || !lx.Offset(pr.offset)) return false;
+        if (lx.Eat("&") && !lx.Number(pr.mask)) return false;
+        return lx.Cmp(pr.cmp) && lx.Number(pr.value);
+    }
+
+    bool ParseAction(Lexer& lx, RewriteAction& a)
+    {
+        if (lx.Eat("bytes"))
+        {
+            a.kind = RewriteActionKind::WriteBytes;
+            return lx.Offset(a.offset) && lx.Eat("=") && lx.Hex(a.bytes);
+        }
+        if (lx.Eat("insert"))
+        {
+            a.kind = RewriteActionKind::Insert;
+            return lx.Offset(a.offset) && lx.Hex(a.bytes);
+        }
+        if (lx.Eat("erase"))
+        {
+            a.kind = RewriteActionKind::Erase;
+            return lx.Offset(a.offset) && lx.Number(a.value);
+        }
+        if (lx.Eat("resize"))
+        {
+            a.kind = RewriteActionKind::Resize;
+            if (!lx.Number(a.value)) return false;
+            uint64_t fill = 0;
+            if (lx.Eat("fill") && (!lx.Number(fill) || fill > 0xFF)) return false;
+            a.fill = static_cast<uint8_t>(fill);
+            return true;
+        }
+        if (lx.Eat("opcode"))
+        {
+            a.kind = RewriteActionKind::SetOpcode;
+            uint16_t op;
+            if (!lx.Eat("=") || !lx.Opcode(op)) return false;
+            a.value = op;
+            return true;
+        }
+        a.kind = RewriteActionKind::WriteField;
+        return lx.FieldType(a.width) && lx.Offset(a.offset) && lx.Eat("=") && lx.Number(a.value);
+    }
+
+    bool ParseLine(Lexer& lx, RewriteRule& rule, std::string& why)
+    {
+        // Optional "name:" — an identifier directly followed by ':'.
+        const char* save = lx.p;
+        std::string name;
+        if (lx.Ident(name) && lx.Eat(":")) rule.name = name;
+        else lx.p = save;
+
+        if (!lx.Opcode(rule.opcode)) { why = "expected an opcode name or number"; return false; }
+
+        if (lx.Eat("if"))
+        {
+            do
+            {
+                RewritePredicate pr;
+                if (!ParsePredicate(lx, pr)) { why = "bad predicate"; return false; }
+                rule.where.push_back(pr);
+            } while (lx.Eat("and"));
+        }
+
+        if (!lx.Eat("->")) { why = "expected '->'"; return false; }
+        do
+        {
+            RewriteAction a;
+            if (!ParseAction(lx, a)) { why = "bad action"; return false; }
+            rule.actions.push_back(a);
+        } while (lx.Eat(";"));
+
+        if (!lx.AtEnd()) { why = "unexpected text after the actions"; return false; }
+        return true;
+    }
+}
+
+bool PacketRewriter::Parse(const char* text, std::vector<RewriteRule>& out, std::string& error)
+{
+    out.clear();
+    int lineNo = 0;
+    for (const char* line = text; line && *line;)
+    {
+        ++lineNo;
+        const char* eol = strchr(line, '\n');
+        std::string copy(line, eol ? eol : line + strlen(line));
+        line = eol ? eol + 1 : nullptr;
+
+        Lexer lx = { copy.c_str() };
+        if (lx.AtEnd()) continue;
+
+        RewriteRule rule;
+        std::string why;
+        if (!ParseLine(lx, rule, why))
+        {
+            error = "line " + std::to_string(lineNo) + ": " + why + " near \"" + std::string(lx.p).substr(0, 24) + "\"";
+            return false;
+        }
+        out.push_back(std::move(rule));
+    }
+    return true;
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+
+// ============================================================
+//  PacketRewriter — match-and-rewrite rules for outgoing CMSGs
+//
+//  Rules match an opcode plus payload predicates, then overwrite
+//  fields, insert / erase / resize bytes or substitute the opcode.
+//  Install() compiles them into one flat patch program indexed
+//  by opcode; the WowConnection::Send hook runs the program for
+//  its opcode in place on the CDataStore buffer — no allocation,
+//  no lock, one table load for opcodes without rules.
+//
+//  Text form (one rule per line, '#' starts a comment):
+//
+//    [name:] <opcode> [if <pred> {and <pred>}] -> <action> {; <action>}
+//
+//    opcode  CMSG_... name or number (0x1DC)
+//    pred    size <cmp> N
+//            u8|u16|u32|u64 @off [& mask] <cmp> N        cmp: == != < > <= >=
+//    action  u8|u16|u32|u64 @off = N
+//            bytes @off = "0A 0B ..."
+//            insert @off "0A 0B ..."
+//            erase @off N
+//            resize N [fill B]
+//            opcode = <opcode>
+//
+//  Offsets are payload offsets (after the 4-byte opcode).  Fields
+//  are little-endian.  All rules of the packet's original opcode
+//  run in order; a field outside the payload fails the predicate
+//  or skips the action (counted).  Growth is limited to the
+//  buffer's capacity (CDataStore::m_alloc).
+//
+//  Replays and injected packets bypass the hook, so they are sent
+//  exactly as given.
+// ============================================================
+
+enum class RewriteCmp : uint8_t { Equal, NotEqual, Less, Greater, LessEqual, GreaterEqual };
+
+struct RewritePredicate
+{
+    bool       size   = false;   // compare the payload size instead of a field
+    uint16_t   offset = 0;
+    uint8_t    width  = 4;       // 1, 2, 4 or 8
+    RewriteCmp cmp    = RewriteCmp::Equal;
+    uint64_t   mask   = ~0ull;
+    uint64_t   value  = 0;
+};
+
+enum class RewriteActionKind : uint8_t { WriteField, WriteBytes, Insert, Erase, Resize, SetOpcode };
+
+struct RewriteAction
+{
+    RewriteActionKind    kind   = RewriteActionKind::WriteField;
+    uint16_t             offset = 0;
+    uint8_t              width  = 4;     // WriteField
+    uint64_t             value  = 0;     // field value / erase count / new size / opcode
+    uint8_t              fill   = 0;     // Resize growth
+    std::vector<uint8_t> bytes;          // WriteBytes / Insert
+};
+
+struct RewriteRule
+{
+    std::string                   name;
+    uint16_t                      opcode = 0;
+    std::vector<RewritePredicate> where;
+    std::vector<RewriteAction>    actions;
+};
+
+struct RewriteStats
+{
+    uint64_t inspected = 0;   // packets whose opcode has rules
+    uint64_t rewritten = 0;   // packets changed by at least one rule
+    uint64_t skipped   = 0;   // actions out of bounds / over capacity
+    uint64_t timed     = 0;   // inspected packets whose cost was sampled
+    uint64_t totalNs   = 0;   // time spent running rules, over `timed` packets
+    uint64_t maxNs     = 0;
+};
+
+class PacketRewriter
+{
+public:
+    static constexpr uint64_t kTimingSample = 16;   // every Nth inspected packet is timed
+
+    // Parse the text form.  On failure `error` names the line.
+    static bool Parse(const char* text, std::vector<RewriteRule>& out, std::string& error);
+
+    // Compile and swap in atomically; the previous program is freed once
+    // no hook is running it.  An empty list removes all rules.
+    static bool Install(const std::vector<RewriteRule>& rules, std::string& error);
+    static bool InstallText(const char* text, std::string& error);   // Parse + Install, keeps the text
+    static void Clear();
+
+    static bool IsActive() { return s_program.load(std::memory_order_relaxed) != nullptr; }
+
+    // Hot path.  `buf` holds [4] opcode LE + payload; `size` is updated
+    // when the length changes.  True if anything was rewritten.
+    static bool Apply(uint8_t* buf, uint32_t& size, uint32_t capacity);
+    // From the caller's fault handler when Apply() faulted on `buf`: closes
+    // the reader bracket Apply() opened (it touches `buf` only inside it).
+    static void AbortApply() { s_readers.fetch_sub(1, std::memory_order_release); }
+
+    // UI accessors ————————————————————————————————————————————
+    static std::string              Source();   // text last installed with InstallText
+    static std::vector<RewriteRule> Rules();
+    static std::vector<uint64_t>    RuleHits(); // per installed rule
+    static RewriteStats             Stats();
+    static void                     ResetStats();
+
+private:
+    struct Program;
+    static bool Compile(const std::vector<RewriteRule>& rules, Program& prog, std::string& error);
+    static bool Run(const Program& prog, uint8_t* buf, uint32_t& size, uint32_t capacity);
+    static void Swap(Program* prog);   // caller holds s_installMutex
+
+    static inline std::atomic<Program*> s_program{ nullptr };
+    static inline std::atomic<uint32_t> s_readers{ 0 };
+
+    static inline std::mutex               s_installMutex;   // Install / Clear / source accessors
+    static inline std::vector<RewriteRule> s_rules;
+    static inline std::string              s_source;
+
+    static inline std::atomic<uint64_t> s_inspected{ 0 };
+    static inline std::atomic<uint64_t> s_rewritten{ 0 };
+    static inline std::atomic<uint64_t> s_skipped{ 0 };
+    static inline std::atomic<uint64_t> s_timed{ 0 };
+    static inline std::atomic<uint64_t> s_totalNs{ 0 };
+    static inline std::atomic<uint64_t> s_maxNs{ 0 };
+};
@@ -0,0 +1,222 @@
+#include "PayloadPool.h"
+#include "PacketHash.h"
+#include <algorithm>
+#include <cstring>
+
+PoolStats& PoolStats::operator+=(const PoolStats& o)
+{
+    lookups     += o.lookups;
+    hits        += o.hits;
+    blobs       += o.blobs;
+    uniqueBytes += o.uniqueBytes;
+    refBytes    += o.refBytes;
+    return *this;
+}
+
+// ============================================================
+//  Intern / Release
+// ============================================================
+
+uint32_t PayloadPool::Intern(const uint8_t* data, uint32_t size)
+{
+    return Intern(data, size, PacketHash::Hash(data, size));
+}
+
+uint32_t PayloadPool::Intern(const uint8_t* data, uint32_t size, uint64_t hash)
+{
+    const uint32_t id = Lookup(data, size, hash);
+    return id != UINT32_MAX ? id : Insert(SharedBytes::Copy(data, size, hash));
+}
+
+uint32_t PayloadPool::Adopt(const SharedBytes& bytes)
+{
+    const uint32_t id = Lookup(bytes.Data(), bytes.Size(), bytes.Hash());
+    return id != UINT32_MAX ? id : Insert(bytes);
+}
+
+uint32_t PayloadPool::Lookup(const uint8_t* data, uint32_t size, uint64_t hash)
+{
+    ++m_lookups;
+    if (m_indexStale) RebuildIndex();
+    if (m_keys.empty()) return UINT32_MAX;
+
+    const uint64_t key  = Key(hash);
+    const size_t   mask = m_keys.size() - 1;
+    for (size_t p = key & mask; m_keys[p]; p = (p + 1) & mask)
+    {
+        if (m_keys[p] != key) continue;
+        const uint32_t id = m_vals[p];
+        if (m_blobs[id].size != size || (size && memcmp(Data(id), data, size) != 0))
+            continue;   // hash collision
+        ++m_hits;
+        AddRef(id);
+        return id;
+    }
+    return UINT32_MAX;
+}
+
+uint32_t PayloadPool::NewId()
+{
+    if (!m_freeIds.empty())
+    {
+        const uint32_t id = m_freeIds.back();
+        m_freeIds.pop_back();
+        return id;
+    }
+    m_blobs.emplace_back();
+    return static_cast<uint32_t>(m_blobs.size() - 1);
+}
+
+uint32_t PayloadPool::Insert(SharedBytes bytes)
+{
+    if ((m_used + 1) * 2 > m_keys.size())
+        Rehash((std::max)(static_cast<size_t>(256), m_keys.size() * 2));
+
+    const uint32_t id   = NewId();
+    Blob&          blob = m_blobs[id];
+    blob.size  = bytes.Size();
+    blob.refs  = 1;
+    blob.bytes = std::move(bytes);
+    m_liveBytes += blob.size;
+    m_refBytes  += blob.size;
+
+    const uint64_t key  = Key(blob.bytes.Hash());
+    const size_t   mask = m_keys.size() - 1;
+    size_t p = key & mask;
+    while (m_keys[p]) p = (p + 1) & mask;
+    m_keys[p] = key;
+    m_vals[p] = id;
+    ++m_used;
+    return id;
+}
+
+void PayloadPool::Release(uint32_t id)
+{
+    Blob& blob = m_blobs[id];
+    m_refBytes -= blob.size;
+    if (--blob.refs) return;
+
+    if (!m_indexStale) Unlink(id);
+    m_liveBytes -= blob.size;
+    blob.bytes.Reset();
+    m_freeIds.push_back(id);
+}
+
+// Keeps the index capacity: a snapshot store is cleared and refilled every frame.
+void PayloadPool::Clear()
+{
+    m_blobs.clear();
+    m_freeIds.clear();
+    std::fill(m_keys.begin(), m_keys.end(), 0);
+    m_used       = 0;
+    m_indexStale = false;
+    m_liveBytes = 0;
+    m_refBytes  = 0;
+    m_lookups   = 0;
+    m_hits      = 0;
+}
+
+// One blob per distinct source blob the rows use, sharing its block.
+void PayloadPool::Merge(const PayloadPool& src, uint32_t* ids, size_t count)
+{
+    static thread_local std::vector<uint32_t> s_remap;
+    s_remap.assign(src.m_blobs.size(), UINT32_MAX);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t& mine = s_remap[ids[i]];
+        if (mine == UINT32_MAX)
+        {
+            const Blob& from = src.m_blobs[ids[i]];
+            mine = NewId();
+            Blob& blob = m_blobs[mine];
+            blob.bytes = from.bytes;
+            blob.size  = from.size;
+            blob.refs  = 0;
+            m_liveBytes += blob.size;
+        }
+        ids[i] = mine;
+        AddRef(mine);
+    }
+    m_indexStale = true;
+}
+
+PoolStats PayloadPool::Stats() const
+{
+    PoolStats st;
+    st.lookups     = m_lookups;
+    st.hits        = m_hits;
+    st.blobs       = m_blobs.size() - m_freeIds.size();
+    st.uniqueBytes = m_liveBytes;
+    st.refBytes    = m_refBytes;
+    return st;
+}
+
+// ============================================================
+//  Index
+// ============================================================
+
+void PayloadPool::Rehash(size_t newCapacity)
+{
+    std::vector<uint64_t> oldKeys;
+    std::vector<uint32_t> oldVals;
+    oldKeys.swap(m_keys);
+    oldVals.swap(m_vals);
+
+    m_keys.assign(newCapacity, 0);
+    m_vals.assign(newCapacity, 0);
+    const size_t mask = newCapacity - 1;
+
+    for (size_t i = 0; i < oldKeys.size(); ++i)
+    {
+        if (!oldKeys[i]) continue;
+        size_t p = oldKeys[i] & mask;
+        while (m_keys[p]) p = (p + 1) & mask;
+        m_keys[p] = oldKeys[i];
+        m_vals[p] = oldVals[i];
+    }
+}
+
+void PayloadPool::RebuildIndex()
+{
+    m_indexStale = false;
+    m_used       = 0;
+    size_t capacity = 256;
+    while ((m_blobs.size() - m_freeIds.size() + 1) * 2 > capacity) capacity *= 2;
+    m_keys.assign(capacity, 0);
+    m_vals.assign(capacity, 0);
+
+    const size_t mask = capacity - 1;
+    for (uint32_t id = 0; id < m_blobs.size(); ++id)
+    {
+        if (!m_blobs[id].refs) continue;
+        const uint64_t key = Key(Hash(id));
+        size_t p = key & mask;
+        while (m_keys[p]) p = (p + 1) & mask;
+        m_keys[p] = key;
+        m_vals[p] = id;
+        ++m_used;
+    }
+}
+
+// Colliding blobs share a key, so the bucket is found by id.
+void PayloadPool::Unlink(uint32_t id)
+{
+    const size_t mask = m_keys.size() - 1;
+    size_t i = Key(Hash(id)) & mask;
+    while (m_vals[i] != id || !m_keys[i]) i = (i + 1) & mask;
+
+    // Backward-shift deletion: pull later entries of the probe run into
+    // the hole unless their home bucket lies cyclically in (i, j].
+    for (size_t j = (i + 1) & mask; m_keys[j]; j = (j + 1) & mask)
+    {
+        const size_t home = m_keys[j] & mask;
+        const bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (stays) continue;
+        m_keys[i] = m_keys[j];
+        m_vals[i] = m_vals[j];
+        i = j;
+    }
+    m_keys[i] = 0;
+    --m_used;
+}
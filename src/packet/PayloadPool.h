@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "SharedPacket.h"
+
+// ============================================================
+//  PayloadPool — content-addressed, refcounted payload storage
+//
+//  Each distinct byte string is stored once, in a SharedBytes
+//  block named by a blob id; Intern() of bytes already present
+//  only bumps the blob's reference count.  Pings, time syncs and
+//  other repeated packets then cost their row metadata and
+//  nothing else.
+//
+//  Lookup is an open-addressing table keyed by PacketHash (equal
+//  hashes are confirmed with memcmp).  A blob whose last row is
+//  released drops its block handle; the block itself lives on
+//  while a snapshot, staged packet or export still shares it.
+//  Data() stays valid as long as the blob does.
+//
+//  Merge() takes another pool's blobs by sharing their blocks
+//  (snapshots copy no payload bytes): blobs are not deduplicated
+//  across the two, and the index is rebuilt only if something is
+//  interned afterwards.
+// ============================================================
+
+struct PoolStats
+{
+    uint64_t lookups     = 0;   // Intern() calls
+    uint64_t hits        = 0;   // ... that found the bytes already stored
+    uint64_t blobs       = 0;   // live distinct payloads
+    uint64_t uniqueBytes = 0;   // their bytes (blocks shared with other pools included)
+    uint64_t refBytes    = 0;   // bytes the references would take without dedup
+
+    uint64_t SavedBytes() const { return refBytes - uniqueBytes; }
+    double   HitRate()    const { return lookups ? static_cast<double>(hits) / lookups : 0.0; }
+
+    PoolStats& operator+=(const PoolStats& o);
+};
+
+class PayloadPool
+{
+public:
+    uint32_t Intern(const uint8_t* data, uint32_t size);
+    uint32_t Intern(const uint8_t* data, uint32_t size, uint64_t hash);   // hash = PacketHash::Hash(data, size)
+    void     AddRef(uint32_t id) { ++m_blobs[id].refs; m_refBytes += m_blobs[id].size; }
+    void     Release(uint32_t id);
+    void     Clear();
+
+    // Interns a block as is: an equal blob already stored is
+    // referenced instead, otherwise the block is kept (no copy).
+    uint32_t Adopt(const SharedBytes& bytes);
+
+    // Take the blobs `ids` (of `src`, one entry per referencing row)
+    // refer to; each id is rewritten to ours.
+    void     Merge(const PayloadPool& src, uint32_t* ids, size_t count);
+
+    const uint8_t*     Data(uint32_t id)  const { return m_blobs[id].bytes.Data(); }
+    uint32_t           Size(uint32_t id)  const { return m_blobs[id].size; }
+    uint32_t           Refs(uint32_t id)  const { return m_blobs[id].refs; }   // rows of this pool
+    uint64_t           Hash(uint32_t id)  const { return m_blobs[id].bytes.Hash(); }
+    const SharedBytes& Share(uint32_t id) const { return m_blobs[id].bytes; }  // copy to keep the bytes
+    size_t             IdLimit()          const { return m_blobs.size(); }     // ids are < IdLimit()
+
+    PoolStats Stats() const;
+
+private:
+    struct Blob
+    {
+        SharedBytes bytes;
+        uint32_t    size = 0;
+        uint32_t    refs = 0;   // 0 = free id
+    };
+
+    static uint64_t Key(uint64_t hash) { return hash ? hash : 1; }   // 0 marks an empty bucket
+
+    uint32_t Lookup(const uint8_t* data, uint32_t size, uint64_t hash);   // referenced id, or UINT32_MAX
+    uint32_t Insert(SharedBytes bytes);
+    uint32_t NewId();
+    void     Rehash(size_t newCapacity);
+    void     RebuildIndex();
+    void     Unlink(uint32_t id);
+
+    std::vector<Blob>     m_blobs;
+    std::vector<uint32_t> m_freeIds;
+
+    // Open addressing: parallel key/value arrays, capacity is a power of two.
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_vals;   // blob id
+    size_t                m_used = 0;
+    bool                  m_indexStale = false;   // after Merge
+
+    uint64_t m_liveBytes = 0;   // bytes of live blobs
+    uint64_t m_refBytes  = 0;
+    uint64_t m_lookups   = 0;
+    uint64_t m_hits      = 0;
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include "../wow/WowTypes.h"
+#include "PacketHash.h"
+
+// ============================================================
+//  SharedBytes / SharedPacket — immutable, refcounted packets
+//
+//  A SharedBytes block is one allocation: a 16-byte header with an
+//  intrusive atomic reference count, size and PacketHash, then the
+//  bytes.  Copying a handle bumps the count, so the capture store,
+//  every UI snapshot, the staging list and exports hold the same
+//  bytes; memory follows the distinct payloads captured, not the
+//  number of views onto them.  The bytes never change once written:
+//  an edit builds a new block (copy on write), and views of the
+//  original keep seeing the original.
+//
+//  Handles are not synchronized — give each thread its own — but
+//  the count is atomic, so blocks may be shared across threads
+//  (pipeline store ↔ UI snapshot) and released on either.
+//
+//  SharedPacket is CapturedPacket with a SharedBytes payload: what
+//  views of stored packets hand around.  CapturedPacket stays the
+//  mutable form the hooks, pipeline and file reader build.
+// ============================================================
+
+class SharedBytes
+{
+public:
+    SharedBytes() = default;
+    SharedBytes(const SharedBytes& o) : m_block(o.m_block) { if (m_block) m_block->refs.fetch_add(1, std::memory_order_relaxed); }
+    SharedBytes(SharedBytes&& o) noexcept : m_block(o.m_block) { o.m_block = nullptr; }
+    SharedBytes& operator=(SharedBytes o) noexcept { std::swap(m_block, o.m_block); return *this; }
+    ~SharedBytes() { Reset(); }
+
+    static SharedBytes Copy(const uint8_t* data, uint32_t size) { return Copy(data, size, PacketHash::Hash(data, size)); }
+    static SharedBytes Copy(const uint8_t* data, uint32_t size, uint64_t hash);
+
+    const uint8_t* Data()     const { return m_block ? reinterpret_cast<const uint8_t*>(m_block + 1) : nullptr; }
+    uint32_t       Size()     const { return m_block ? m_block->size : 0; }
+    uint64_t       Hash()     const { return m_block ? m_block->hash : 0; }
+    uint32_t       RefCount() const { return m_block ? m_block->refs.load(std::memory_order_relaxed) : 0; }
+    bool           Empty()    const { return Size() == 0; }
+    explicit operator bool()  const { return m_block != nullptr; }
+
+    void Reset();
+
+    // Process-wide: blocks alive and their payload bytes.
+    static uint64_t LiveBlocks() { return s_liveBlocks.load(std::memory_order_relaxed); }
+    static uint64_t LiveBytes()  { return s_liveBytes.load(std::memory_order_relaxed); }
+
+private:
+    struct Block
+    {
+        std::atomic<uint32_t> refs;
+        uint32_t              size;
+        uint64_t              hash;
+        // `size` bytes follow
+    };
+    static_assert(sizeof(Block) == 16, "payload follows the header 8-byte aligned");
+
+    Block* m_block = nullptr;
+
+    static inline std::atomic<uint64_t> s_liveBlocks{ 0 };
+    static inline std::atomic<uint64_t> s_liveBytes{ 0 };
+};
+
+inline SharedBytes SharedBytes::Copy(const uint8_t* data, uint32_t size, uint64_t hash)
+{
+    SharedBytes out;
+    void* mem = ::operator new(sizeof(Block) + size);
+    out.m_block = new (mem) Block{ { 1 }, size, hash };
+    if (size) memcpy(reinterpret_cast<uint8_t*>(out.m_block + 1), data, size);
+    s_liveBlocks.fetch_add(1, std::memory_order_relaxed);
+    s_liveBytes.fetch_add(size, std::memory_order_relaxed);
+    return out;
+}
+
+inline void SharedBytes::Reset()
+{
+    if (!m_block) return;
+    if (m_block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        s_liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+        s_liveBytes.fetch_sub(m_block->size, std::memory_order_relaxed);
+        m_block->~Block();
+        ::operator delete(m_block);
+    }
+    m_block = nullptr;
+}
+
+struct SharedPacket
+{
+    uint64_t        seq          = 0;
+    uint8_t         connection   = 0;
+    PacketDirection direction    = PacketDirection::CMSG;
+    uint16_t        opcode       = 0;
+    uint32_t        size         = 0;   // payload size on the wire
+    uint64_t        timestamp_us = 0;
+    SharedBytes     payload;            // as stored; may be shorter than `size`
+    std::shared_ptr<const std::vector<uint8_t>> inflated;
+
+    bool Truncated() const { return payload.Size() < size; }
+
+    // Copies the payload once, into a new block.
+    static SharedPacket From(const CapturedPacket& pkt)
+    {
+        SharedPacket s;
+        s.seq          = pkt.seq;
+        s.connection   = pkt.connection;
+        s.direction    = pkt.direction;
+        s.opcode       = pkt.opcode;
+        s.size         = pkt.size;
+        s.timestamp_us = pkt.timestamp_us;
+        s.payload      = SharedBytes::Copy(pkt.payload.data(), static_cast<uint32_t>(pkt.payload.size()));
+        s.inflated     = pkt.inflated;
+        return s;
+    }
+
+    // For APIs that take CapturedPacket: copies the payload out.
+    CapturedPacket ToCaptured() const
+    {
+        CapturedPacket pkt;
+        pkt.seq          = seq;
+        pkt.connection   = connection;
+        pkt.direction    = direction;
+        pkt.opcode       = opcode;
+        pkt.size         = size;
+        pkt.timestamp_us = timestamp_us;
+        pkt.payload.assign(payload.Data(), payload.Data() + payload.Size());
+        pkt.inflated     = inflated;
+        return pkt;
+    }
+
+    // Copy on write: this packet gets new bytes, other views keep the old ones.
+    void Edit(const uint8_t* data, uint32_t newSize)
+    {
+        payload  = SharedBytes::Copy(data, newSize);
+        size     = newSize;
+        inflated = nullptr;
+    }
+};
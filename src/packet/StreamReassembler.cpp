@@ -0,0 +1,173 @@
+#include "StreamReassembler.h"
+#include <cstring>
+#include <algorithm>
+
+// ============================================================
+//  Header parsing
+// ============================================================
+
+bool StreamReassembler::ParseHeader(const uint8_t* hdr, uint32_t len,
+                                    uint16_t& outOpcode, uint32_t& outPayloadLen, uint32_t& outHeaderLen)
+{
+    if (len < 1) return false;
+    const uint32_t hlen = HeaderLength(hdr[0]);
+    if (len < hlen) return false;
+
+    uint32_t sizeField;
+    if (hlen == 5)
+        sizeField = (static_cast<uint32_t>(hdr[0] & 0x7F) << 16) | (hdr[1] << 8) | hdr[2];
+    else
+        sizeField = (static_cast<uint32_t>(hdr[0]) << 8) | hdr[1];
+
+    if (sizeField < 2) return false;   // must at least cover the opcode
+
+    outOpcode     = static_cast<uint16_t>(hdr[hlen - 2] | (hdr[hlen - 1] << 8));
+    outPayloadLen = sizeField - 2;
+    outHeaderLen  = hlen;
+    return true;
+}
+
+// ============================================================
+//  State
+// ============================================================
+
+void StreamReassembler::Reset()
+{
+    m_hdrHave     = 0;
+    m_hdrNeed     = 0;
+    m_pending     = false;
+    m_scatterHave = 0;
+    m_winBase     = nullptr;
+    m_winEnd      = nullptr;
+    m_haveWindow  = false;
+}
+
+uint32_t StreamReassembler::Available(const uint8_t* p) const
+{
+    const uintptr_t pos  = reinterpret_cast<uintptr_t>(p);
+    const uintptr_t base = reinterpret_cast<uintptr_t>(m_winBase);
+    const uintptr_t end  = reinterpret_cast<uintptr_t>(m_winEnd);
+
+    if (pos >= base && pos <= end)
+        return static_cast<uint32_t>(end - pos);
+    // Header sits in carried-over bytes just in front of the latest chunk.
+    if (pos < base && base - pos <= kMaxCarry)
+        return static_cast<uint32_t>(end - pos);
+    return 0;
+}
+
+void StreamReassembler::Emit(const uint8_t* payload, uint32_t size, bool copied, Sink sink, void* user)
+{
+    SmsgView v;
+    v.opcode  = m_opcode;
+    v.payload = size ? payload : nullptr;
+    v.size    = size;
+    v.copied  = copied;
+    v.large   = m_large;
+
+    if (copied) ++m_stats.reassembled;
+    else        ++m_stats.zeroCopy;
+
+    sink(v, user);
+}
+
+// ============================================================
+//  Layer B feed — decrypted header bytes
+// ============================================================
+
+void StreamReassembler::OnHeader(const uint8_t* data, uint32_t len, Sink sink, void* user)
+{
+    if (m_pending)
+    {
+        // A new header while payload bytes were still owed: a recv was
+        // missed or the client dropped the packet.  Abandon the partial.
+        m_pending     = false;
+        m_scatterHave = 0;
+        ++m_stats.resyncs;
+    }
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if (m_hdrHave == 0)
+            m_hdrNeed = HeaderLength(data[i]);
+        m_hdr[m_hdrHave++] = data[i];
+        if (m_hdrHave < m_hdrNeed) continue;
+
+        uint32_t hlen = 0;
+        const bool ok = ParseHeader(m_hdr, m_hdrHave, m_opcode, m_payloadLen, hlen);
+        m_hdrHave = 0;
+        if (!ok)
+        {
+            ++m_stats.resyncs;
+            continue;
+        }
+
+        m_large = (hlen == 5);
+        if (m_large) ++m_stats.largeHeader;
+
+        // Payload starts right after the last header byte in the client buffer.
+        BeginPayload(data + i + 1, sink, user);
+    }
+}
+
+void StreamReassembler::BeginPayload(const uint8_t* payload, Sink sink, void* user)
+{
+    if (m_payloadLen == 0)
+    {
+        Emit(nullptr, 0, false, sink, user);
+        return;
+    }
+
+    // No recv window known (Layer E unavailable): fall back to the
+    // contiguous-buffer assumption the client makes itself.
+    if (!m_haveWindow)
+    {
+        Emit(payload, m_payloadLen, false, sink, user);
+        return;
+    }
+
+    const uint32_t avail = Available(payload);
+    if (avail >= m_payloadLen)
+    {
+        Emit(payload, m_payloadLen, false, sink, user);
+        return;
+    }
+
+    if (m_payloadLen > kMaxPayload)
+    {
+        ++m_stats.resyncs;
+        return;
+    }
+
+    // Spans recv chunks: copy what is here, the rest arrives via OnRecv.
+    if (m_scatter.size() < m_payloadLen)
+        m_scatter.resize(m_payloadLen);
+    if (avail > 0)
+        memcpy(m_scatter.data(), payload, avail);
+    m_scatterHave = avail;
+    m_pending     = true;
+}
+
+// ============================================================
+//  Layer E feed — raw recv chunks (payload bytes are plaintext)
+// ============================================================
+
+void StreamReassembler::OnRecv(const uint8_t* buf, uint32_t len, Sink sink, void* user)
+{
+    m_winBase    = buf;
+    m_winEnd     = buf + len;
+    m_haveWindow = true;
+
+    if (!m_pending || len == 0) return;
+
+    const uint32_t take = (std::min)(len, m_payloadLen - m_scatterHave);
+    memcpy(m_scatter.data() + m_scatterHave, buf, take);
+    m_scatterHave += take;
+
+    if (m_scatterHave == m_payloadLen)
+    {
+        m_pending = false;
+        Emit(m_scatter.data(), m_payloadLen, true, sink, user);
+        m_scatterHave = 0;
+    }
+}
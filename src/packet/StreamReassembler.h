@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// ============================================================
+//  StreamReassembler — per-connection SMSG framing
+//
+//  The client decrypts SMSG headers in place inside its recv
+//  buffer (Layer B), but nothing guarantees the payload has
+//  arrived when that happens.  The reassembler tracks the byte
+//  stream instead of trusting `data + 4`:
+//
+//    OnRecv(buf, n)      — recv() just filled [buf, buf+n)   (Layer E)
+//    OnHeader(data, len) — ARC4 just decrypted header bytes    (Layer B)
+//
+//  3.3.5a SMSG header forms (size counts opcode + payload):
+//    normal: [2] size BE              [2] opcode LE   (4 bytes)
+//    large : [3] size BE, bit 23 set  [2] opcode LE   (5 bytes)
+//
+//  A packet fully inside the current recv window is handed out
+//  as a view into the game's buffer (zero copy).  Only a packet
+//  that spans recv chunks is assembled in the scatter buffer.
+//  Views are valid for the duration of the sink call only.
+//
+//  Not thread-safe.  Recv and header decryption both run on the
+//  client's network thread; PacketHooks locks each stream because
+//  SetEncKey and the UI's stats reach it from other threads.
+// ============================================================
+
+struct SmsgView
+{
+    uint16_t       opcode;
+    const uint8_t* payload;   // nullptr when size == 0
+    uint32_t       size;
+    bool           copied;    // true = assembled in the scatter buffer
+    bool           large;     // true = 5-byte header form
+};
+
+struct StreamStats
+{
+    uint64_t zeroCopy    = 0;  // emitted straight from the recv buffer
+    uint64_t reassembled = 0;  // spanned recv chunks, copied once
+    uint64_t largeHeader = 0;  // 5-byte header form seen
+    uint64_t resyncs     = 0;  // partial packet abandoned (lost framing)
+};
+
+class StreamReassembler
+{
+public:
+    using Sink = void(*)(const SmsgView& pkt, void* user);
+
+    // Largest size the 23-bit large-header field can describe.
+    static constexpr uint32_t kMaxPayload = 0x7FFFFF;
+    // How far before the current recv chunk a header may sit and still be
+    // treated as contiguous with it (the client compacts unread bytes to
+    // the front of its buffer before the next recv).
+    static constexpr uint32_t kMaxCarry   = 0x10000;
+
+    static uint32_t HeaderLength(uint8_t firstByte) { return (firstByte & 0x80) ? 5u : 4u; }
+
+    // Parse a complete plaintext SMSG header (either form).
+    static bool ParseHeader(const uint8_t* hdr, uint32_t len,
+                            uint16_t& outOpcode, uint32_t& outPayloadLen, uint32_t& outHeaderLen);
+
+    void Reset();
+
+    void OnRecv(const uint8_t* buf, uint32_t len, Sink sink, void* user);
+    void OnHeader(const uint8_t* data, uint32_t len, Sink sink, void* user);
+
+    const StreamStats& Stats() const { return m_stats; }
+
+private:
+    void     BeginPayload(const uint8_t* payload, Sink sink, void* user);
+    uint32_t Available(const uint8_t* p) const;
+    void     Emit(const uint8_t* payload, uint32_t size, bool copied, Sink sink, void* user);
+
+    // Header accumulation (the client may decrypt it in pieces)
+    uint8_t  m_hdr[5]    = {};
+    uint32_t m_hdrHave   = 0;
+    uint32_t m_hdrNeed   = 0;
+
+    // Current packet
+    uint16_t m_opcode     = 0;
+    uint32_t m_payloadLen = 0;
+    bool     m_large      = false;
+    bool     m_pending    = false;   // payload still arriving via OnRecv
+
+    // Scatter buffer for packets spanning recv chunks (grows, never shrinks)
+    std::vector<uint8_t> m_scatter;
+    uint32_t             m_scatterHave = 0;
+
+    // Most recent recv window
+    const uint8_t* m_winBase   = nullptr;
+    const uint8_t* m_winEnd    = nullptr;
+    bool           m_haveWindow = false;
+
+    StreamStats m_stats;
+};
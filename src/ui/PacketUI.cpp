@@ -1,8 +1,25 @@
 #include "PacketUI.h"
 #include "../packet/PacketCapture.h"
 #include "../packet/PacketReplay.h"
+#include "../packet/PacketFuzzer.h"
+#include "../packet/PacketInflater.h"
+#include "../packet/PacketPipeline.h"
+#include "../packet/PacketRewriter.h"
+#include "../packet/PacketColumns.h"
+#include "../packet/OpcodeFilter.h"
+#include "../packet/CaptureFile.h"
+#include "../packet/CaptureExport.h"
+#include "../analysis/WorldTracker.h"
+#include "../analysis/LatencyTracker.h"
+#include "../analysis/TrafficTimeline.h"
 #include "../hooks/PacketHooks.h"
+#include "../hooks/ConnectionTracker.h"
+#include "../hooks/HookManager.h"
+#include "../log/Log.h"
+#include "../ipc/CaptureMirror.h"
+#include "../ipc/ControlServer.h"
 #include "../wow/WowTypes.h"
+#include "../wow/OffsetResolver.h"
 
 #include <Windows.h>
 
@@ -24,6 +41,15 @@ static const char* DirectionStr(PacketDirection d)
     return d == PacketDirection::CMSG ? "CMSG" : "SMSG";
 }
 
+// "#3 world" — id plus the role ConnectionTracker last saw for it.
+static void FormatConnection(uint8_t id, char* out, size_t outSize)
+{
+    if (!id)
+        snprintf(out, outSize, "-");
+    else
+        snprintf(out, outSize, "#%u %s", id, ConnectionTracker::RoleName(ConnectionTracker::RoleOf(id)));
+}
+
 // Render a 16-column hex+ASCII dump of arbitrary bytes
 static void HexDump(const uint8_t* data, uint32_t size)
 {
@@ -65,14 +91,19 @@ static void HexDump(const uint8_t* data, uint32_t size)
 //  Module-level UI state
 // ============================================================
 
-static int  s_selected     = -1;          // selected row in packet list
+static uint64_t s_selectedSeq = 0;        // selected packet in the list, 0 = none
 static bool s_autoScroll   = true;
 static char s_filterText[64] = {};        // opcode name/number filter
+static char s_findHex[64]    = {};        // byte pattern search (hex) over packet content
+static std::vector<uint8_t> s_findBytes;  // parsed s_findHex
+static bool s_showInflated   = true;      // detail panel: inflated vs raw bytes
 static bool s_showCMSG     = true;
 static bool s_showSMSG     = true;
+static int  s_connFilter   = -1;          // connection id shown in the list, -1 = all
 
 // Replay / edit state
-static std::vector<CapturedPacket> s_editBuffer;  // packets staged for replay
+static std::vector<SharedPacket> s_editBuffer;    // packets staged for replay; share the capture's bytes
+static int  s_editIndex = -1;                      // staged packet loaded into the editor
 static char s_editHex[4096] = {};                  // hex editor text
 static char s_replayDelayMs[8] = "0";
 
@@ -81,9 +112,56 @@ static char s_ruleOpcode[8]   = {};
 static bool s_ruleBlock       = false;
 static bool s_ruleCMSG        = true;
 static bool s_ruleSMSG        = true;
-
-// Snapshot updated once per frame
-static std::vector<CapturedPacket> s_snapshot;
+static int  s_ruleMode        = 0;       // CaptureMode
+static int  s_ruleParam       = 64;
+static int  s_ruleCategory    = 0;       // OpcodeCategory, with opcode 0
+
+// Fuzzer controls
+static char s_fuzzOpcode[8]   = {};
+static int  s_fuzzRate        = 10;
+static int  s_fuzzMaxMut      = 3;
+static bool s_fuzzKinds[static_cast<size_t>(MutationKind::Count)] = { true, true, true, true };
+static double s_fuzzBenchPps  = 0.0;
+
+// Rewrite rules editor
+static char        s_rewriteText[4096] = {};
+static std::string s_rewriteError;
+
+// World objects tab
+static char        s_worldSeq[24] = {};      // empty = live table
+static bool        s_worldSeekOk  = false;
+static ObjectTable s_worldSeek;              // reconstructed table for s_worldSeq
+static int         s_worldType    = -1;      // -1 = all types
+
+// Column snapshot updated once per frame; the list shows s_rows of it.
+static PacketColumns         s_columns;
+static std::vector<uint32_t> s_rows;
+static SharedPacket          s_selectedPkt;   // selection; holds the row's payload block
+static bool                  s_hasSelection = false;
+static uint64_t              s_samePayload  = 0;   // list shows only this payload hash, 0 = off
+
+// Opcodes matching s_filterText, decided once per opcode seen.
+static OpcodeFilter s_textOpcodes;
+static uint8_t      s_textKnown[65536];
+static char         s_textFor[64] = {};
+
+// Stats tab: per-opcode table window
+static int s_countWindow = 0;   // index into kCountWindows
+
+// Timeline tab
+static int      s_timelineSpan   = 0;       // index into kTimelineSpans
+static int      s_timelineMetric = 0;       // TimelineMetric
+static bool     s_timelineFollow = true;    // window ends at the newest packet
+static uint64_t s_timelineEndUs  = 0;       // window end when not following
+static char     s_timelineOpcode[48] = {};  // selected-opcode channel (name or number)
+static int      s_scrollToRow    = -1;      // s_rows index the packet list scrolls to next frame
+
+// Latency tree: pair whose windows are plotted, -1 = none
+static int s_latencyPair = -1;
+
+// Export popup
+static int s_exportFormat   = 0;   // ExportFormat
+static int s_exportEncoding = 1;   // PayloadEncoding
 
 // ============================================================
 //  Sub-windows
@@ -94,86 +172,187 @@ static constexpr float kListFraction   = 0.48f;  // packet list
 static constexpr float kDetailFraction = 0.20f;  // hex detail panel
 // remaining fraction goes to the tab bar area
 
+// Parse "DE AD be ef" / "deadbeef" into bytes; stops at the first non-hex pair.
+static void ParseHexPattern(const char* text, std::vector<uint8_t>& out)
+{
+    out.clear();
+    int nibbles = 0;
+    uint8_t cur = 0;
+    for (const char* p = text; *p; ++p)
+    {
+        char c = *p;
+        int v;
+        if      (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else continue;
+        cur = static_cast<uint8_t>((cur << 4) | v);
+        if (++nibbles == 2)
+        {
+            out.push_back(cur);
+            nibbles = 0;
+            cur = 0;
+        }
+    }
+}
+
+// Searches inflated content when available, so compressed packets match too.
+static bool ContainsBytes(size_t row, const std::vector<uint8_t>& pattern)
+{
+    if (pattern.empty()) return true;
+    uint32_t size = 0;
+    const uint8_t* c = s_columns.Content(row, size);
+    return std::search(c, c + size, pattern.begin(), pattern.end()) != c + size;
+}
+
+// Text filter: opcode hex, decimal, or name substring.
+static bool OpcodeMatchesText(uint16_t opcode)
+{
+    char opcodeStr[16];
+    snprintf(opcodeStr, sizeof(opcodeStr), "%04X", opcode);
+    char opcodeDecStr[16];
+    snprintf(opcodeDecStr, sizeof(opcodeDecStr), "%u", opcode);
+    return strstr(opcodeStr, s_filterText) ||
+           strstr(opcodeDecStr, s_filterText) ||
+           strstr(OpcodeToString(opcode), s_filterText);
+}
+
+// Rows of s_columns shown in the list: a column scan for direction and
+// opcode text, then the byte search over the survivors only.
+static void SelectRows()
+{
+    ColumnQuery q;
+    q.cmsg = s_showCMSG;
+    q.smsg = s_showSMSG;
+    if (s_filterText[0] != '\0')
+    {
+        if (strcmp(s_textFor, s_filterText) != 0)
+        {
+            strncpy_s(s_textFor, sizeof(s_textFor), s_filterText, sizeof(s_textFor) - 1);
+            memset(s_textKnown, 0, sizeof(s_textKnown));
+            s_textOpcodes.Fill(false);
+        }
+        const uint16_t* op = s_columns.Opcode();
+        for (size_t r = 0; r < s_columns.Rows(); ++r)
+        {
+            if (s_textKnown[op[r]]) continue;
+            s_textKnown[op[r]] = 1;
+            const bool match = OpcodeMatchesText(op[r]);
+            s_textOpcodes.Set(PacketDirection::CMSG, op[r], match);
+            s_textOpcodes.Set(PacketDirection::SMSG, op[r], match);
+        }
+        q.opcodes = &s_textOpcodes;
+    }
+    ColumnScan::Select(s_columns, q, s_rows);
+
+    if (s_samePayload)
+    {
+        const PayloadPool& pool = s_columns.Pool();
+        const uint32_t*    ids  = s_columns.PayloadId();
+        s_rows.erase(std::remove_if(s_rows.begin(), s_rows.end(),
+                                    [&](uint32_t r) { return pool.Hash(ids[r]) != s_samePayload; }),
+                     s_rows.end());
+    }
+    if (!s_findBytes.empty())
+        s_rows.erase(std::remove_if(s_rows.begin(), s_rows.end(),
+                                    [](uint32_t r) { return !ContainsBytes(r, s_findBytes); }),
+                     s_rows.end());
+}
+
+static void LoadEditorHex(const SharedPacket& pkt)
+{
+    std::string hexStr;
+    for (uint32_t i = 0; i < pkt.payload.Size(); ++i)
+    {
+        char h[4];
+        snprintf(h, sizeof(h), "%02X ", pkt.payload.Data()[i]);
+        hexStr += h;
+    }
+    size_t copyLen = (std::min)(hexStr.size(), sizeof(s_editHex) - 1);
+    strncpy_s(s_editHex, sizeof(s_editHex), hexStr.c_str(), copyLen);
+}
+
 static void DrawPacketList(float height)
 {
     ImGui::BeginChild("##PacketList", ImVec2(0, height), false);
 
     // Column headers
-    ImGui::Columns(5, "pkt_cols", true);
+    ImGui::Columns(6, "pkt_cols", true);
     ImGui::SetColumnWidth(0, 75);   // Time
     ImGui::SetColumnWidth(1, 58);   // Dir
-    ImGui::SetColumnWidth(2, 72);   // Opcode
-    ImGui::SetColumnWidth(3, 210);  // Name
-    ImGui::SetColumnWidth(4, 62);   // Size
+    ImGui::SetColumnWidth(2, 72);   // Conn
+    ImGui::SetColumnWidth(3, 72);   // Opcode
+    ImGui::SetColumnWidth(4, 210);  // Name
+    ImGui::SetColumnWidth(5, 62);   // Size
 
     ImGui::TextDisabled("Time(ms)"); ImGui::NextColumn();
     ImGui::TextDisabled("Dir");      ImGui::NextColumn();
+    ImGui::TextDisabled("Conn");     ImGui::NextColumn();
     ImGui::TextDisabled("Opcode");   ImGui::NextColumn();
     ImGui::TextDisabled("Name");     ImGui::NextColumn();
     ImGui::TextDisabled("Size");     ImGui::NextColumn();
     ImGui::Separator();
 
-    for (int i = 0; i < static_cast<int>(s_snapshot.size()); ++i)
-    {
-        const auto& pkt = s_snapshot[i];
+    const uint64_t* seqCol  = s_columns.Seq();
+    const uint64_t* timeCol = s_columns.Timestamp();
+    const uint16_t* opCol   = s_columns.Opcode();
+    const uint8_t*  dirCol  = s_columns.Direction();
+    const uint8_t*  connCol = s_columns.Connection();
+    const uint32_t* sizeCol = s_columns.Size();
 
-        // Direction filter
-        if (!s_showCMSG && pkt.direction == PacketDirection::CMSG) continue;
-        if (!s_showSMSG && pkt.direction == PacketDirection::SMSG) continue;
+    if (s_scrollToRow >= 0)   // timeline click
+    {
+        ImGui::SetScrollY(ImGui::GetCursorPosY() + s_scrollToRow * ImGui::GetTextLineHeightWithSpacing());
+        s_scrollToRow = -1;
+    }
 
-        // Text filter (opcode hex, decimal, or name substring match)
-        if (s_filterText[0] != '\0')
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(s_rows.size()));
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
         {
-            char opcodeStr[16];
-            snprintf(opcodeStr, sizeof(opcodeStr), "%04X", pkt.opcode);
-            char opcodeDecStr[16];
-            snprintf(opcodeDecStr, sizeof(opcodeDecStr), "%u", pkt.opcode);
-            const char* name = OpcodeToString(pkt.opcode);
-            if (!strstr(opcodeStr, s_filterText) &&
-                !strstr(opcodeDecStr, s_filterText) &&
-                !strstr(name, s_filterText))
-                continue;
-        }
+            const uint32_t row    = s_rows[i];
+            const uint16_t opcode = opCol[row];
+            const PacketDirection dir = static_cast<PacketDirection>(dirCol[row]);
 
-        char timeStr[16];
-        snprintf(timeStr, sizeof(timeStr), "%.3f", pkt.timestamp_us / 1000.0);
+            char timeStr[16];
+            snprintf(timeStr, sizeof(timeStr), "%.3f", timeCol[row] / 1000.0);
 
-        char opcodeStr[10];
-        snprintf(opcodeStr, sizeof(opcodeStr), "0x%04X", pkt.opcode);
+            char opcodeStr[10];
+            snprintf(opcodeStr, sizeof(opcodeStr), "0x%04X", opcode);
 
-        bool isCMSG = pkt.direction == PacketDirection::CMSG;
-        ImVec4 color = isCMSG ? ImVec4(0.4f, 0.8f, 1.0f, 1.0f)
-                               : ImVec4(0.55f, 1.0f, 0.55f, 1.0f);
+            bool isCMSG = dir == PacketDirection::CMSG;
+            ImVec4 color = isCMSG ? ImVec4(0.4f, 0.8f, 1.0f, 1.0f)
+                                  : ImVec4(0.55f, 1.0f, 0.55f, 1.0f);
 
-        bool isSelected = (s_selected == i);
-        ImGui::PushID(i);
-        ImGui::PushStyleColor(ImGuiCol_Text, color);
+            bool isSelected = (s_selectedSeq == seqCol[row]);
+            ImGui::PushID(i);
+            ImGui::PushStyleColor(ImGuiCol_Text, color);
 
-        ImGui::Text("%s", timeStr); ImGui::NextColumn();
+            ImGui::Text("%s", timeStr); ImGui::NextColumn();
 
-        if (ImGui::Selectable(DirectionStr(pkt.direction),
-                               isSelected,
-                               ImGuiSelectableFlags_SpanAllColumns, ImVec2(0, 0)))
-        {
-            s_selected = i;
-            std::string hexStr;
-            for (uint8_t b : pkt.payload)
+            if (ImGui::Selectable(DirectionStr(dir),
+                                  isSelected,
+                                  ImGuiSelectableFlags_SpanAllColumns, ImVec2(0, 0)))
             {
-                char h[4];
-                snprintf(h, sizeof(h), "%02X ", b);
-                hexStr += h;
+                s_selectedSeq  = seqCol[row];
+                s_selectedPkt  = s_columns.Shared(row);
+                s_hasSelection = true;
+                LoadEditorHex(s_selectedPkt);
             }
-            size_t copyLen = (std::min)(hexStr.size(), sizeof(s_editHex) - 1);
-            strncpy_s(s_editHex, sizeof(s_editHex), hexStr.c_str(), copyLen);
-        }
-        ImGui::NextColumn();
+            ImGui::NextColumn();
 
-        ImGui::Text("%s", opcodeStr); ImGui::NextColumn();
-        ImGui::Text("%s", OpcodeToString(static_cast<Opcodes>(pkt.opcode))); ImGui::NextColumn();
-        ImGui::Text("%u", pkt.size);  ImGui::NextColumn();
+            char connStr[24];
+            FormatConnection(connCol[row], connStr, sizeof(connStr));
+            ImGui::Text("%s", connStr);   ImGui::NextColumn();
+            ImGui::Text("%s", opcodeStr); ImGui::NextColumn();
+            ImGui::Text("%s", OpcodeToString(static_cast<Opcodes>(opcode))); ImGui::NextColumn();
+            ImGui::Text("%u", sizeCol[row]); ImGui::NextColumn();
 
-        ImGui::PopStyleColor();
-        ImGui::PopID();
+            ImGui::PopStyleColor();
+            ImGui::PopID();
+        }
     }
 
     ImGui::Columns(1);
@@ -186,7 +365,7 @@ static void DrawPacketList(float height)
 
 static void DrawDetailPanel(float height)
 {
-    if (s_selected < 0 || s_selected >= static_cast<int>(s_snapshot.size()))
+    if (!s_hasSelection)
     {
         ImGui::BeginChild("##DetailEmpty", ImVec2(0, height), true);
         ImGui::TextDisabled("Select a packet to inspect.");
@@ -194,7 +373,7 @@ static void DrawDetailPanel(float height)
         return;
     }
 
-    const CapturedPacket& pkt = s_snapshot[s_selected];
+    const SharedPacket& pkt = s_selectedPkt;
 
     // One-line summary bar
     ImGui::TextColored(ImVec4(1.0f, 0.85f, 0.3f, 1.0f),
@@ -203,12 +382,61 @@ static void DrawDetailPanel(float height)
                        DirectionStr(pkt.direction),
                        pkt.size,
                        pkt.timestamp_us / 1000.0);
+    const OpcodeInfo& info = OpcodeMeta::Get(pkt.opcode);
+    ImGui::SameLine();
+    ImGui::TextDisabled("[%s]", OpcodeMeta::CategoryName(info.category));
+    if (!info.SizeFits(pkt.size))
+    {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "(expected %u bytes)", info.fixedSize);
+    }
+    if (pkt.Truncated())
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%u bytes kept by capture mode)", pkt.payload.Size());
+    }
+    if (pkt.inflated)
+    {
+        ImGui::SameLine();
+        ImGui::Checkbox("inflated##detail", &s_showInflated);
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%zu bytes)", pkt.inflated->size());
+    }
+    else if (PacketInflater::IsCompressed(pkt.opcode))
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(compressed, not inflated)");
+    }
+
+    // Identical payloads share a pool blob; offer them as a group.
+    const size_t row = s_columns.Find(pkt.seq);
+    if (!s_samePayload && row != PacketColumns::npos && s_columns.Stored()[row])
+    {
+        const PayloadPool& pool = s_columns.Pool();
+        const uint32_t*    ids  = s_columns.PayloadId();
+        const uint64_t     hash = pool.Hash(ids[row]);
+        uint32_t same = 0;
+        for (size_t r = 0; r < s_columns.Rows(); ++r)
+            same += pool.Hash(ids[r]) == hash;
+        if (same > 1)
+        {
+            char label[48];
+            snprintf(label, sizeof(label), "%u identical##same", same);
+            ImGui::SameLine();
+            if (ImGui::SmallButton(label))
+                s_samePayload = hash;
+        }
+    }
+
+    const bool     inflated = pkt.inflated && s_showInflated;
+    const uint8_t* bytes    = inflated ? pkt.inflated->data() : pkt.payload.Data();
+    const uint32_t count    = inflated ? static_cast<uint32_t>(pkt.inflated->size()) : pkt.payload.Size();
 
     // Hex dump fills the remaining height
     float dumpHeight = height - ImGui::GetFrameHeightWithSpacing() - ImGui::GetStyle().ItemSpacing.y;
     ImGui::BeginChild("##HexDump", ImVec2(0, dumpHeight), true);
-    if (!pkt.payload.empty())
-        HexDump(pkt.payload.data(), static_cast<uint32_t>(pkt.payload.size()));
+    if (count)
+        HexDump(bytes, count);
     else
         ImGui::TextDisabled("(empty payload)");
     ImGui::EndChild();
@@ -230,15 +458,17 @@ static void DrawReplayTab(float availHeight)
     const float editorH   = (std::max)(remaining * 0.55f, 48.0f);
 
     // Buttons
-    if (s_selected >= 0 && s_selected < static_cast<int>(s_snapshot.size()))
+    if (s_hasSelection)
     {
-        const CapturedPacket& pkt = s_snapshot[s_selected];
         if (ImGui::Button("Stage Selected"))
-            s_editBuffer.push_back(pkt);
+            s_editBuffer.push_back(s_selectedPkt);
         ImGui::SameLine();
     }
     if (ImGui::Button("Clear Staged"))
+    {
         s_editBuffer.clear();
+        s_editIndex = -1;
+    }
 
     ImGui::Separator();
 
@@ -250,17 +480,10 @@ static void DrawReplayTab(float availHeight)
         char label[64];
         snprintf(label, sizeof(label), "[%d] %s 0x%04X (%u bytes)##staged%d",
                  i, DirectionStr(p.direction), p.opcode, p.size, i);
-        if (ImGui::Selectable(label, false))
+        if (ImGui::Selectable(label, s_editIndex == i))
         {
-            std::string hexStr;
-            for (uint8_t b : p.payload)
-            {
-                char h[4];
-                snprintf(h, sizeof(h), "%02X ", b);
-                hexStr += h;
-            }
-            size_t copyLen = (std::min)(hexStr.size(), sizeof(s_editHex) - 1);
-            strncpy_s(s_editHex, sizeof(s_editHex), hexStr.c_str(), copyLen);
+            s_editIndex = i;
+            LoadEditorHex(p);
         }
     }
     ImGui::EndChild();
@@ -270,6 +493,20 @@ static void DrawReplayTab(float availHeight)
     ImGui::InputTextMultiline("##hexeditor", s_editHex, sizeof(s_editHex),
                                ImVec2(-1, editorH));
 
+    // Copy on write: the staged packet gets its own bytes, the capture keeps the original.
+    if (s_editIndex >= 0 && s_editIndex < static_cast<int>(s_editBuffer.size()))
+    {
+        char label[48];
+        snprintf(label, sizeof(label), "Apply to [%d]", s_editIndex);
+        if (ImGui::Button(label))
+        {
+            std::vector<uint8_t> bytes;
+            ParseHexPattern(s_editHex, bytes);
+            s_editBuffer[s_editIndex].Edit(bytes.data(), static_cast<uint32_t>(bytes.size()));
+        }
+        ImGui::SameLine();
+    }
+
     ImGui::AlignTextToFramePadding();
     ImGui::Text("Delay (ms):"); ImGui::SameLine();
     ImGui::SetNextItemWidth(70);
@@ -306,12 +543,39 @@ static void DrawFiltersTab(float /*availHeight*/)
     ImGui::SetNextItemWidth(80);
     ImGui::InputText("Opcode (hex, 0=any)##rule", s_ruleOpcode, sizeof(s_ruleOpcode),
                      ImGuiInputTextFlags_CharsHexadecimal);
+    if (strtol(s_ruleOpcode, nullptr, 16) == 0)
+    {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100);
+        if (ImGui::BeginCombo("Category##rule", s_ruleCategory ? OpcodeMeta::CategoryName(static_cast<OpcodeCategory>(s_ruleCategory)) : "any"))
+        {
+            for (int i = 0; i < static_cast<int>(OpcodeCategory::Count); ++i)
+                if (ImGui::Selectable(i ? OpcodeMeta::CategoryName(static_cast<OpcodeCategory>(i)) : "any", s_ruleCategory == i))
+                    s_ruleCategory = i;
+            ImGui::EndCombo();
+        }
+    }
     ImGui::SameLine();
     ImGui::Checkbox("CMSG##rule", &s_ruleCMSG);
     ImGui::SameLine();
     ImGui::Checkbox("SMSG##rule", &s_ruleSMSG);
     ImGui::SameLine();
     ImGui::Checkbox("Block##rule", &s_ruleBlock);
+    if (!s_ruleBlock)
+    {
+        // Capture mode for what the rule lets through (CapturePolicy).
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(110);
+        ImGui::Combo("Mode##rule", &s_ruleMode, "full\0metadata\0snaplen\0" "1-in-N\0every N ms\0");
+        if (s_ruleMode >= static_cast<int>(CaptureMode::Snaplen))
+        {
+            static const char* kParamLabel[] = { "", "", "bytes##rule", "N##rule", "ms##rule" };
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(80);
+            ImGui::InputInt(kParamLabel[s_ruleMode], &s_ruleParam);
+            s_ruleParam = (std::max)(s_ruleParam, 1);
+        }
+    }
     ImGui::SameLine();
 
     if (ImGui::Button("Add Rule"))
@@ -319,25 +583,38 @@ static void DrawFiltersTab(float /*availHeight*/)
         FilterRule r;
         r.enabled     = true;
         r.opcode      = static_cast<uint16_t>(strtol(s_ruleOpcode, nullptr, 16));
+        r.category    = r.opcode ? OpcodeCategory::None : static_cast<OpcodeCategory>(s_ruleCategory);
         r.blockPacket = s_ruleBlock;
         r.matchAny    = (s_ruleCMSG && s_ruleSMSG);
         r.direction   = s_ruleCMSG ? PacketDirection::CMSG : PacketDirection::SMSG;
+        r.mode        = s_ruleBlock ? CaptureMode::Full : static_cast<CaptureMode>(s_ruleMode);
+        r.param       = static_cast<uint32_t>(s_ruleParam);
         PacketCapture::AddFilter(r);
     }
 
     ImGui::Separator();
 
-    const auto& filters = PacketCapture::GetFilters();
+    const std::vector<FilterRule> filters = PacketCapture::GetFilters();
     ImGui::Text("%zu active rules:", filters.size());
     for (size_t i = 0; i < filters.size(); ++i)
     {
         const auto& f = filters[i];
+        char mode[32];
+        if (f.blockPacket || f.mode < CaptureMode::Snaplen)
+            snprintf(mode, sizeof(mode), "%s", f.blockPacket ? "block" : CaptureModeName(f.mode));
+        else
+            snprintf(mode, sizeof(mode), "%s (%u)", CaptureModeName(f.mode), f.param);
         char label[128];
-        snprintf(label, sizeof(label), "[%zu] opcode=0x%04X dir=%s block=%s##f%zu",
+        char what[48];
+        if (f.opcode || f.IsWildcard())
+            snprintf(what, sizeof(what), "opcode=0x%04X", f.opcode);
+        else
+            snprintf(what, sizeof(what), "category=%s", OpcodeMeta::CategoryName(f.category));
+        snprintf(label, sizeof(label), "[%zu] %s dir=%s mode=%s##f%zu",
                  i,
-                 f.opcode,
+                 what,
                  f.matchAny ? "ANY" : DirectionStr(f.direction),
-                 f.blockPacket ? "YES" : "no",
+                 mode,
                  i);
         ImGui::TextUnformatted(label);
         ImGui::SameLine();
@@ -346,6 +623,431 @@ static void DrawFiltersTab(float /*availHeight*/)
         if (ImGui::SmallButton(btn))
             PacketCapture::RemoveFilter(i);
     }
+
+    // Accurate counts for opcodes under a mode, including packets never stored.
+    const PolicyTotals pt = CapturePolicy::Totals();
+    ImGui::Separator();
+    ImGui::Text("Capture modes: %llu packets seen, %llu stored trimmed, %llu skipped (%llu KiB)",
+                pt.packets, pt.trimmed, pt.skipped, pt.skippedBytes >> 10);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Reset counts"))
+        CapturePolicy::ResetCounters();
+
+    static std::vector<OpcodeCounters> s_policyCounts;
+    CapturePolicy::Snapshot(s_policyCounts);
+    s_policyCounts.erase(std::remove_if(s_policyCounts.begin(), s_policyCounts.end(),
+                                        [](const OpcodeCounters& c) { return c.packets == 0; }),
+                         s_policyCounts.end());
+    if (!s_policyCounts.empty() &&
+        ImGui::BeginTable("##policy_counts", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY,
+                          ImVec2(0, 160)))
+    {
+        ImGui::TableSetupColumn("Dir", ImGuiTableColumnFlags_WidthFixed, 40);
+        ImGui::TableSetupColumn("Opcode");
+        ImGui::TableSetupColumn("Mode", ImGuiTableColumnFlags_WidthFixed, 90);
+        ImGui::TableSetupColumn("Seen", ImGuiTableColumnFlags_WidthFixed, 70);
+        ImGui::TableSetupColumn("Bytes", ImGuiTableColumnFlags_WidthFixed, 80);
+        ImGui::TableSetupColumn("Skipped", ImGuiTableColumnFlags_WidthFixed, 70);
+        ImGui::TableHeadersRow();
+        for (const OpcodeCounters& c : s_policyCounts)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(DirectionStr(c.direction));
+            ImGui::TableNextColumn(); ImGui::Text("0x%04X %s", c.opcode, OpcodeToString(c.opcode));
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(CaptureModeName(c.mode));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", c.packets);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", c.bytes);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", c.skipped);
+        }
+        ImGui::EndTable();
+    }
+}
+
+// ============================================================
+//  Fuzzer tab
+// ============================================================
+static FuzzConfig BuildFuzzConfig()
+{
+    FuzzConfig cfg;
+    cfg.opcode           = static_cast<uint16_t>(strtol(s_fuzzOpcode, nullptr, 16));
+    cfg.packetsPerSecond = static_cast<uint32_t>((std::max)(s_fuzzRate, 1));
+    cfg.maxMutations     = static_cast<uint32_t>((std::max)(s_fuzzMaxMut, 1));
+    cfg.kindMask         = 0;
+    for (size_t k = 0; k < static_cast<size_t>(MutationKind::Count); ++k)
+        if (s_fuzzKinds[k]) cfg.kindMask |= 1u << k;
+    return cfg;
+}
+
+static void DrawFuzzerTab(float /*availHeight*/)
+{
+    const bool running = PacketFuzzer::IsRunning();
+
+    ImGui::Text("Corpus: %zu unique CMSG seeds", PacketFuzzer::CorpusSize());
+    ImGui::SameLine();
+    if (ImGui::Button("Seed from capture"))
+        PacketFuzzer::SeedFromCapture(static_cast<uint16_t>(strtol(s_fuzzOpcode, nullptr, 16)));
+    ImGui::SameLine();
+    if (ImGui::Button("Clear corpus") && !running)
+        PacketFuzzer::ClearCorpus();
+
+    ImGui::SetNextItemWidth(80);
+    ImGui::InputText("Opcode (hex, 0=all)##fuzz", s_fuzzOpcode, sizeof(s_fuzzOpcode),
+                     ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(90);
+    ImGui::InputInt("pkts/s##fuzz", &s_fuzzRate);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(90);
+    ImGui::SliderInt("max mutations##fuzz", &s_fuzzMaxMut, 1, 8);
+
+    for (size_t k = 0; k < static_cast<size_t>(MutationKind::Count); ++k)
+    {
+        if (k) ImGui::SameLine();
+        ImGui::Checkbox(MutationKindName(static_cast<MutationKind>(k)), &s_fuzzKinds[k]);
+    }
+
+    if (!running)
+    {
+        if (ImGui::Button("Start fuzzing"))
+        {
+            if (PacketReplay::IsReady())
+                PacketFuzzer::Start(BuildFuzzConfig());
+            else
+                ImGui::OpenPopup("fuzz_notready");
+        }
+    }
+    else if (ImGui::Button("Stop fuzzing"))
+        PacketFuzzer::Stop();
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark mutator"))
+        s_fuzzBenchPps = PacketFuzzer::Benchmark(200000, BuildFuzzConfig());
+    if (s_fuzzBenchPps > 0.0)
+    {
+        ImGui::SameLine();
+        ImGui::Text("%.0f mutants/s", s_fuzzBenchPps);
+    }
+
+    if (ImGui::BeginPopupModal("fuzz_notready", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        ImGui::Text("WowConnection::Send not yet hooked.\nConnect to world server first.");
+        if (ImGui::Button("OK")) ImGui::CloseCurrentPopup();
+        ImGui::EndPopup();
+    }
+
+    ImGui::Separator();
+    const FuzzStats st = PacketFuzzer::Stats();
+    ImGui::Text("Generated : %llu", st.generated);
+    ImGui::Text("Sent      : %llu   failed: %llu", st.sent, st.sendFailed);
+    for (size_t k = 0; k < static_cast<size_t>(MutationKind::Count); ++k)
+        ImGui::Text("  %-12s %llu", MutationKindName(static_cast<MutationKind>(k)), st.byKind[k]);
+}
+
+// ============================================================
+//  Rewrite tab
+// ============================================================
+static void DrawRewriteTab(float availHeight)
+{
+    ImGui::TextDisabled("[name:] <opcode> [if <pred> {and <pred>}] -> <action> {; <action>}   # see PacketRewriter.h");
+    ImGui::InputTextMultiline("##rewrite", s_rewriteText, sizeof(s_rewriteText),
+                              ImVec2(-1.0f, availHeight * 0.35f));
+
+    if (ImGui::Button("Install"))
+    {
+        s_rewriteError.clear();
+        PacketRewriter::InstallText(s_rewriteText, s_rewriteError);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear rules"))
+    {
+        PacketRewriter::Clear();
+        s_rewriteError.clear();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset stats"))
+        PacketRewriter::ResetStats();
+    if (!s_rewriteError.empty())
+    {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", s_rewriteError.c_str());
+    }
+
+    const RewriteStats st = PacketRewriter::Stats();
+    ImGui::Text("Inspected: %llu   rewritten: %llu   skipped actions: %llu   cost: %.0f ns/pkt avg, %llu ns max",
+                st.inspected, st.rewritten, st.skipped,
+                st.timed ? static_cast<double>(st.totalNs) / st.timed : 0.0, st.maxNs);
+
+    ImGui::Separator();
+    const std::vector<RewriteRule> rules = PacketRewriter::Rules();
+    const std::vector<uint64_t>    hits  = PacketRewriter::RuleHits();
+    if (rules.empty())
+    {
+        ImGui::TextDisabled("No rules installed — CMSGs are sent unchanged.");
+        return;
+    }
+    if (ImGui::BeginTable("##rewriteRules", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY))
+    {
+        ImGui::TableSetupColumn("#",       ImGuiTableColumnFlags_WidthFixed, 30);
+        ImGui::TableSetupColumn("Name",    ImGuiTableColumnFlags_WidthFixed, 120);
+        ImGui::TableSetupColumn("Opcode",  ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Shape",   ImGuiTableColumnFlags_WidthFixed, 120);
+        ImGui::TableSetupColumn("Hits",    ImGuiTableColumnFlags_WidthFixed, 80);
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < rules.size(); ++i)
+        {
+            const RewriteRule& r = rules[i];
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%zu", i + 1);
+            ImGui::TableSetColumnIndex(1); ImGui::TextUnformatted(r.name.empty() ? "-" : r.name.c_str());
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%s (0x%03X)", OpcodeToString(r.opcode), r.opcode);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%zu tests, %zu actions", r.where.size(), r.actions.size());
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%llu", i < hits.size() ? hits[i] : 0ull);
+        }
+        ImGui::EndTable();
+    }
+}
+
+// ============================================================
+//  Objects tab
+// ============================================================
+static void DrawObjectsTab(float availHeight)
+{
+    // Reserve space for: history line + seek row + warning + type row + counts line
+    const float fixedRows = ImGui::GetFrameHeightWithSpacing() * 5.0f;
+    const float listH     = (std::max)(availHeight - fixedRows, 80.0f);
+
+    auto lock = WorldTracker::Lock();
+    const WorldState& world = WorldTracker::World();
+
+    ImGui::Text("History: seq %llu .. %llu   (%zu deltas, %zu checkpoints)",
+                world.OldestSeq(), world.LastSeq(), world.DeltaCount(), world.CheckpointCount());
+
+    ImGui::SetNextItemWidth(120);
+    ImGui::InputText("Seek seq", s_worldSeq, sizeof(s_worldSeq));
+    ImGui::SameLine();
+    if (ImGui::Button("Rebuild"))
+        s_worldSeekOk = s_worldSeq[0] && world.Reconstruct(strtoull(s_worldSeq, nullptr, 10), s_worldSeek);
+    ImGui::SameLine();
+    if (ImGui::Button("Live"))
+    {
+        s_worldSeq[0] = 0;
+        s_worldSeekOk = false;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+    {
+        WorldTracker::Clear();
+        s_worldSeekOk = false;
+    }
+    if (s_worldSeq[0] && !s_worldSeekOk)
+        ImGui::TextColored(ImVec4(1,0.4f,0,1), "(seq not rebuilt or older than retained history)");
+
+    const ObjectTable& table = s_worldSeekOk ? s_worldSeek : world.Live();
+
+    // Per-type counts double as a type filter
+    size_t byType[static_cast<size_t>(ObjectTypeId::Count)] = {};
+    for (const auto& obj : table.Objects())
+        if (obj.guid && obj.typeId < static_cast<uint8_t>(ObjectTypeId::Count))
+            ++byType[obj.typeId];
+
+    if (ImGui::RadioButton("All", s_worldType < 0)) s_worldType = -1;
+    for (int t = 0; t < static_cast<int>(ObjectTypeId::Count); ++t)
+    {
+        char label[48];
+        snprintf(label, sizeof(label), "%s (%zu)", ObjectTypeName(static_cast<uint8_t>(t)), byType[t]);
+        ImGui::SameLine();
+        if (ImGui::RadioButton(label, s_worldType == t)) s_worldType = t;
+    }
+
+    const WorldTrackerStats st = WorldTracker::Stats();
+    ImGui::Text("Objects: %zu   packets: %llu (%llu bad, %llu not inflated, %llu truncated, %llu evicted)   fields: %llu",
+                table.LiveCount(), st.decode.packets, st.decode.failed, st.skipped, st.truncated, st.evicted,
+                st.decode.fields);
+
+    ImGui::BeginChild("##objects", ImVec2(0, listH), true);
+
+    ImGui::Columns(5, "objcols");
+    ImGui::SetColumnWidth(0, 150);
+    ImGui::SetColumnWidth(1, 90);
+    ImGui::SetColumnWidth(2, 70);
+    ImGui::SetColumnWidth(3, 220);
+    ImGui::Text("GUID");     ImGui::NextColumn();
+    ImGui::Text("Type");     ImGui::NextColumn();
+    ImGui::Text("Entry");    ImGui::NextColumn();
+    ImGui::Text("Position"); ImGui::NextColumn();
+    ImGui::Text("Last seq"); ImGui::NextColumn();
+    ImGui::Separator();
+
+    const auto& objects = table.Objects();
+    for (uint32_t slot = 0; slot < static_cast<uint32_t>(objects.size()); ++slot)
+    {
+        const WorldObject& obj = objects[slot];
+        if (!obj.guid) continue;
+        if (s_worldType >= 0 && obj.typeId != s_worldType) continue;
+
+        ImGui::Text("%016llX", obj.guid);                                         ImGui::NextColumn();
+        ImGui::Text("%s", ObjectTypeName(obj.typeId));                            ImGui::NextColumn();
+        ImGui::Text("%u", table.GetField(slot, UpdateFields::OBJECT_FIELD_ENTRY)); ImGui::NextColumn();
+        if (obj.hasPosition)
+            ImGui::Text("%.1f %.1f %.1f", obj.x, obj.y, obj.z);
+        else
+            ImGui::TextDisabled("-");
+        ImGui::NextColumn();
+        ImGui::Text("%llu", obj.lastSeq);                                         ImGui::NextColumn();
+    }
+
+    ImGui::Columns(1);
+    ImGui::EndChild();
+}
+
+// ============================================================
+//  Timeline tab
+// ============================================================
+
+// First list row at or after `timeUs`; selects it and scrolls the list there.
+static void JumpToTime(uint64_t timeUs)
+{
+    const uint64_t* timeCol = s_columns.Timestamp();
+    const auto it = std::lower_bound(s_rows.begin(), s_rows.end(), timeUs,
+                                     [&](uint32_t row, uint64_t t) { return timeCol[row] < t; });
+    if (it == s_rows.end()) return;
+    const uint32_t row = *it;
+    s_scrollToRow  = static_cast<int>(it - s_rows.begin());
+    s_autoScroll   = false;
+    s_selectedSeq  = s_columns.Seq()[row];
+    s_selectedPkt  = s_columns.Shared(row);
+    s_hasSelection = true;
+    LoadEditorHex(s_selectedPkt);
+}
+
+// Rate lines over [fromUs, toUs); a click jumps the packet list to that time.
+static void DrawTimelinePlot(const char* id, const std::vector<TimelinePoint>* lines, const ImU32* colors,
+                             size_t count, uint64_t fromUs, uint64_t toUs, float height)
+{
+    const ImVec2 size(ImGui::GetContentRegionAvail().x, height);
+    const ImVec2 p0 = ImGui::GetCursorScreenPos();
+    const ImVec2 p1(p0.x + size.x, p0.y + size.y);
+    ImGui::InvisibleButton(id, size);
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    dl->AddRectFilled(p0, p1, ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+    float top = 1.0f;
+    for (size_t k = 0; k < count; ++k)
+        for (const TimelinePoint& p : lines[k])
+            top = (std::max)(top, p.value);
+
+    const double span = static_cast<double>(toUs - fromUs);
+    auto at = [&](const TimelinePoint& p) {
+        return ImVec2(p0.x + static_cast<float>((p.timeUs - fromUs) / span) * size.x,
+                      p1.y - p.value / top * (size.y - 2.0f));
+    };
+    static std::vector<ImVec2> s_poly;
+    for (size_t k = 0; k < count; ++k)
+    {
+        s_poly.clear();
+        for (const TimelinePoint& p : lines[k])
+            if (p.timeUs >= fromUs) s_poly.push_back(at(p));
+        if (s_poly.size() > 1)
+            dl->AddPolyline(s_poly.data(), static_cast<int>(s_poly.size()), colors[k], 0, 1.5f);
+    }
+
+    char scale[32];
+    snprintf(scale, sizeof(scale), "%.0f/s", top);
+    dl->AddText(ImVec2(p0.x + 4, p0.y + 2), ImGui::GetColorU32(ImGuiCol_TextDisabled), scale);
+
+    if (ImGui::IsItemHovered())
+    {
+        const float    fx = (ImGui::GetIO().MousePos.x - p0.x) / size.x;
+        const uint64_t t  = fromUs + static_cast<uint64_t>((std::max)(0.0f, fx) * span);
+        dl->AddLine(ImVec2(ImGui::GetIO().MousePos.x, p0.y), ImVec2(ImGui::GetIO().MousePos.x, p1.y),
+                    ImGui::GetColorU32(ImGuiCol_TextDisabled));
+        ImGui::SetTooltip("%.3f s  (click: show in list)", t / 1e6);
+        if (ImGui::IsItemClicked())
+            JumpToTime(t);
+    }
+}
+
+static void DrawTimelineTab(float availHeight)
+{
+    static const struct { const char* label; uint64_t seconds; } kTimelineSpans[] = {
+        { "1 min", 60 }, { "10 min", 600 }, { "1 h", 3600 }, { "6 h", 21600 }, { "all", 0 },
+    };
+    ImGui::SetNextItemWidth(90);
+    if (ImGui::BeginCombo("Span", kTimelineSpans[s_timelineSpan].label))
+    {
+        for (int i = 0; i < static_cast<int>(sizeof(kTimelineSpans) / sizeof(kTimelineSpans[0])); ++i)
+            if (ImGui::Selectable(kTimelineSpans[i].label, s_timelineSpan == i)) s_timelineSpan = i;
+        ImGui::EndCombo();
+    }
+    ImGui::SameLine();
+    ImGui::RadioButton("packets/s", &s_timelineMetric, static_cast<int>(TimelineMetric::Packets));
+    ImGui::SameLine();
+    ImGui::RadioButton("bytes/s", &s_timelineMetric, static_cast<int>(TimelineMetric::Bytes));
+    ImGui::SameLine();
+    ImGui::Checkbox("Follow", &s_timelineFollow);
+
+    const uint64_t oldest = TrafficTimeline::OldestUs();
+    const uint64_t newest = TrafficTimeline::NewestUs();
+    if (!newest)
+    {
+        ImGui::TextDisabled(TrafficTimeline::IsRunning() ? "no traffic yet" : "timeline off");
+        return;
+    }
+    const uint64_t spanUs = kTimelineSpans[s_timelineSpan].seconds
+                          ? kTimelineSpans[s_timelineSpan].seconds * 1'000'000 : newest - oldest + 1;
+    if (s_timelineFollow || !s_timelineEndUs)
+        s_timelineEndUs = newest + 1;
+    else
+    {
+        // Scroll back through the session.
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(200);
+        double endS = s_timelineEndUs / 1e6;
+        const double minS = oldest / 1e6, maxS = (newest + 1) / 1e6;
+        if (ImGui::SliderScalar("End (s)", ImGuiDataType_Double, &endS, &minS, &maxS, "%.1f"))
+            s_timelineEndUs = static_cast<uint64_t>(endS * 1e6);
+    }
+    const uint64_t toUs   = s_timelineEndUs;
+    const uint64_t fromUs = toUs > spanUs ? toUs - spanUs : 0;
+
+    ImGui::SetNextItemWidth(80);
+    ImGui::InputText("Opcode (hex)##timeline", s_timelineOpcode, sizeof(s_timelineOpcode),
+                     ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::SameLine();
+    if (ImGui::Button("Track"))
+        TrafficTimeline::Select(s_timelineOpcode[0] ? static_cast<int>(strtol(s_timelineOpcode, nullptr, 16) & 0xFFFF) : -1);
+    ImGui::SameLine();
+    if (ImGui::Button("Track selected packet") && s_hasSelection)
+    {
+        snprintf(s_timelineOpcode, sizeof(s_timelineOpcode), "%X", s_selectedPkt.opcode);
+        TrafficTimeline::Select(s_selectedPkt.opcode);
+    }
+    const int tracked = TrafficTimeline::Selected();
+    ImGui::SameLine();
+    if (tracked >= 0)
+        ImGui::Text("tracking %s", OpcodeToString(static_cast<uint16_t>(tracked)));
+    else
+        ImGui::TextDisabled("no opcode tracked");
+
+    const TimelineMetric metric = static_cast<TimelineMetric>(s_timelineMetric);
+    const size_t         points = static_cast<size_t>((std::max)(ImGui::GetContentRegionAvail().x, 64.0f));
+    static std::vector<TimelinePoint> s_lines[2];
+    static const ImU32 kColors[2] = { IM_COL32(100, 200, 255, 255), IM_COL32(140, 255, 140, 255) };   // list colors
+
+    const int    plots = tracked >= 0 ? 2 : 1;
+    const float  plotH = (std::max)((availHeight - ImGui::GetFrameHeightWithSpacing() * 3.0f) / plots -
+                                    ImGui::GetTextLineHeightWithSpacing(), 40.0f);
+    for (int c = 0; c < plots; ++c)
+    {
+        const TimelineChannel channel = c ? TimelineChannel::Selected : TimelineChannel::All;
+        uint64_t res = 0;
+        for (int d = 0; d < 2; ++d)
+            res = TrafficTimeline::Query(channel, static_cast<PacketDirection>(d), metric, fromUs, toUs, points,
+                                         s_lines[d]);
+        ImGui::TextDisabled("%s  CMSG / SMSG  (%llu ms buckets)",
+                            c ? OpcodeToString(static_cast<uint16_t>(tracked)) : "all traffic",
+                            static_cast<unsigned long long>(res / 1000));
+        DrawTimelinePlot(c ? "##timeline_sel" : "##timeline_all", s_lines, kColors, 2, fromUs, toUs, plotH);
+    }
 }
 
 // ============================================================
@@ -357,12 +1059,282 @@ static void DrawStatsTab(float /*availHeight*/)
 
     ImGui::Text("Packets captured : %llu", PacketCapture::TotalCaptured());
     ImGui::Text("Packets dropped  : %llu", PacketCapture::TotalDropped());
+    const PoolStats pool = PacketCapture::PayloadStats();
+    ImGui::Text("Payload dedup    : %.1f%% hits, %llu KiB saved (%llu distinct payloads, %llu KiB stored)",
+                pool.HitRate() * 100.0, pool.SavedBytes() >> 10, pool.blobs, pool.uniqueBytes >> 10);
+    ImGui::Text("Payload memory   : %llu KiB in %llu blocks (capture, snapshot and staged views share them)",
+                static_cast<unsigned long long>(SharedBytes::LiveBytes() >> 10),
+                static_cast<unsigned long long>(SharedBytes::LiveBlocks()));
     ImGui::Text("Replay ready     : %s",   PacketReplay::IsReady() ? "YES" : "no");
+    ImGui::Text("Capture hooks    : %s",   PacketHooks::IsArmed() ? "armed" : "DISARMED");
+    const OffsetReport& offsets = OffsetResolver::LastReport();
+    if (offsets.results.empty())
+        ImGui::Text("Offsets          : build 12340 defaults");
+    else
+        ImGui::Text("Offsets          : %u / %zu by signature (%s, hash %.1f ms, scan %.1f ms, %s)", offsets.placed,
+                    offsets.results.size(), offsets.cacheHit ? "cached" : "scanned", offsets.hashMs, offsets.scanMs,
+                    ScanIsaName(offsets.isa));
+
+    if (ImGui::TreeNode("Hooks"))
+    {
+        for (const HookManager::HookInfo& h : HookManager::List())
+        {
+            bool on = h.enabled;
+            const bool layer = PacketHooks::IsCaptureLayer(h.name);
+            ImGui::BeginDisabled(h.pinned || layer);
+            if (ImGui::Checkbox(h.name, &on))
+                HookManager::SetEnabled(h.name, on);
+            ImGui::EndDisabled();
+            if (layer && ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+                ImGui::SetTooltip("Capture layer: switched with Armed");
+            else if (h.pinned && ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+                ImGui::SetTooltip("Pinned: always on while loaded");
+        }
+        ImGui::TreePop();
+    }
+
+    if (!offsets.results.empty() && ImGui::TreeNode("Offsets"))
+    {
+        static const char* const kSource[] = { "default", "cache", "scan" };
+        for (const OffsetResult& r : offsets.results)
+        {
+            if (r.source == OffsetSource::Default)
+                ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.3f, 1.0f), "%-26s %s (%u matches)", r.name.c_str(),
+                                   kSource[static_cast<int>(r.source)], r.matches);
+            else
+                ImGui::Text("%-26s 0x%08X  %s", r.name.c_str(), static_cast<unsigned>(r.address),
+                            kSource[static_cast<int>(r.source)]);
+        }
+        ImGui::TreePop();
+    }
+
+    const std::vector<ConnectionStats> perConn = PacketCapture::PerConnection();
+    if (!perConn.empty() && ImGui::BeginTable("##conn_stats", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+    {
+        ImGui::TableSetupColumn("Conn");
+        ImGui::TableSetupColumn("Captured");
+        ImGui::TableSetupColumn("CMSG");
+        ImGui::TableSetupColumn("SMSG");
+        ImGui::TableSetupColumn("Bytes");
+        ImGui::TableSetupColumn("Blocked");
+        ImGui::TableSetupColumn("Replay target");
+        ImGui::TableHeadersRow();
+        for (const ConnectionStats& cs : perConn)
+        {
+            char connStr[24];
+            FormatConnection(cs.connection, connStr, sizeof(connStr));
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(connStr);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", cs.captured);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", cs.cmsg);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", cs.smsg);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", cs.bytes);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", cs.blocked);
+            ImGui::TableNextColumn(); ImGui::Text("%p", (void*)PacketReplay::Target(cs.connection));
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::TreeNode("Opcodes in history"))
+    {
+        // Column scans: time window over the timestamp column, then a histogram.
+        static const struct { const char* label; uint64_t seconds; } kCountWindows[] = {
+            { "all", 0 }, { "last 10 s", 10 }, { "last 60 s", 60 },
+        };
+        ImGui::SetNextItemWidth(110);
+        if (ImGui::BeginCombo("Window##counts", kCountWindows[s_countWindow].label))
+        {
+            for (int w = 0; w < static_cast<int>(sizeof(kCountWindows) / sizeof(kCountWindows[0])); ++w)
+                if (ImGui::Selectable(kCountWindows[w].label, s_countWindow == w)) s_countWindow = w;
+            ImGui::EndCombo();
+        }
+
+        ColumnQuery q;
+        if (const uint64_t secs = kCountWindows[s_countWindow].seconds)
+        {
+            const uint64_t now = PacketCapture::NowMicros();
+            q.fromUs = now > secs * 1'000'000 ? now - secs * 1'000'000 : 0;
+        }
+        static std::vector<uint32_t>    s_windowRows;
+        static std::vector<OpcodeCount> s_counts;
+        ColumnScan::Select(s_columns, q, s_windowRows);
+        ColumnScan::CountByOpcode(s_columns, &s_windowRows, s_counts);
+
+        ImGui::SameLine();
+        ImGui::TextDisabled("%zu packets, %zu opcodes", s_windowRows.size(), s_counts.size());
+        if (ImGui::BeginTable("##opcode_counts", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                              ImGuiTableFlags_ScrollY, ImVec2(0, 180)))
+        {
+            ImGui::TableSetupColumn("Dir", ImGuiTableColumnFlags_WidthFixed, 40);
+            ImGui::TableSetupColumn("Opcode");
+            ImGui::TableSetupColumn("Packets", ImGuiTableColumnFlags_WidthFixed, 70);
+            ImGui::TableSetupColumn("Bytes", ImGuiTableColumnFlags_WidthFixed, 80);
+            ImGui::TableHeadersRow();
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(s_counts.size()));
+            while (clipper.Step())
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+                {
+                    const OpcodeCount& c = s_counts[i];
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(DirectionStr(c.direction));
+                    ImGui::TableNextColumn(); ImGui::Text("0x%04X %s", c.opcode, OpcodeToString(c.opcode));
+                    ImGui::TableNextColumn(); ImGui::Text("%u", c.packets);
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", c.bytes);
+                }
+            ImGui::EndTable();
+        }
+        ImGui::TreePop();
+    }
+
+    if (ImGui::TreeNode("Request latency"))
+    {
+        // Pairs that have seen traffic; "recent" is the last minute of windows.
+        const uint64_t windowUs = LatencyTracker::WindowMicros();
+        const uint32_t recent   = static_cast<uint32_t>((60'000'000 + windowUs - 1) / windowUs);
+        const std::vector<LatencyPairStats> lat = LatencyTracker::Stats(recent);
+        if (!LatencyTracker::IsRunning())
+        {
+            ImGui::TextDisabled("tracker off");
+            ImGui::SameLine();
+        }
+        if (ImGui::SmallButton("Reset##latency"))
+            LatencyTracker::Clear();
+
+        if (ImGui::BeginTable("##latency", 8, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                              ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Request");
+            ImGui::TableSetupColumn("Matched");
+            ImGui::TableSetupColumn("Open");
+            ImGui::TableSetupColumn("p50 ms (1 min)");
+            ImGui::TableSetupColumn("p90 ms (1 min)");
+            ImGui::TableSetupColumn("p99 ms (1 min)");
+            ImGui::TableSetupColumn("p90 ms (all)");
+            ImGui::TableSetupColumn("Lost / unmatched");
+            ImGui::TableHeadersRow();
+            for (size_t i = 0; i < lat.size(); ++i)
+            {
+                const LatencyPairStats& ls = lat[i];
+                if (!ls.matched && !ls.open && !ls.evicted && !ls.expired) continue;
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                if (ImGui::Selectable(OpcodeToString(ls.pair.request), s_latencyPair == static_cast<int>(i),
+                                      ImGuiSelectableFlags_SpanAllColumns))
+                    s_latencyPair = s_latencyPair == static_cast<int>(i) ? -1 : static_cast<int>(i);
+                ImGui::TableNextColumn(); ImGui::Text("%llu", ls.matched);
+                ImGui::TableNextColumn(); ImGui::Text("%u", ls.open);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", ls.recent.p50 / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", ls.recent.p90 / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", ls.recent.p99 / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", ls.total.p90 / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%llu / %llu", ls.evicted + ls.expired, ls.unmatched);
+            }
+            ImGui::EndTable();
+        }
+
+        if (s_latencyPair >= 0 && s_latencyPair < static_cast<int>(lat.size()))
+        {
+            const std::vector<LatencyWindow> series = LatencyTracker::Series(static_cast<size_t>(s_latencyPair));
+            std::vector<float> p90(series.size());
+            for (size_t k = 0; k < series.size(); ++k)
+                p90[k] = series[k].p90 / 1000.0f;
+            char label[96];
+            snprintf(label, sizeof(label), "%s p90 ms / %llu s",
+                     OpcodeToString(lat[s_latencyPair].pair.request),
+                     static_cast<unsigned long long>(windowUs / 1'000'000));
+            ImGui::PlotLines("##latency_p90", p90.data(), static_cast<int>(p90.size()), 0, label,
+                             0.0f, FLT_MAX, ImVec2(0, 80));
+        }
+        ImGui::TreePop();
+    }
+
+    const PipelineStats pl = PacketPipeline::Stats();
+    ImGui::Text("Pipeline         : %llu queued, %llu stored in %llu batches (max %llu)",
+                pl.enqueued, pl.processed, pl.batches, pl.maxBatch);
+    ImGui::Text("Pipeline ring    : %zu KiB pending, peak %llu KiB, dropped %llu full / %llu oversize",
+                PacketPipeline::PendingBytes() >> 10, pl.peakBytes >> 10, pl.droppedFull, pl.droppedLarge);
+
+    const InflateStats inf = PacketInflater::Stats();
+    if (PacketInflater::IsRunning())
+    {
+        ImGui::Text("Inflated         : %llu  (%llu cache hits, %llu failed, %zu pending, %llu dropped)",
+                    inf.inflated, inf.cacheHits, inf.failed, PacketInflater::PendingJobs(), inf.dropped);
+        ImGui::Text("Inflate bytes    : %llu -> %llu", inf.bytesIn, inf.bytesOut);
+    }
+    else
+        ImGui::TextDisabled("Inflate stage    : off (built without zlib)");
+
+    if (CaptureMirror::IsRunning())
+    {
+        const ShmWriterStats sh = CaptureMirror::Stats();
+        ImGui::Text("Shared ring      : %s  %llu records, %llu KiB, %llu overwritten, %llu oversize",
+                    CaptureMirror::Name(), sh.records, sh.bytes >> 10, sh.overwritten, sh.dropped);
+    }
+    else
+        ImGui::TextDisabled("Shared ring      : off");
+
+    if (ControlServer::IsRunning())
+    {
+        const ControlStats cs = ControlServer::Stats();
+        ImGui::Text("Control          : %s  %u clients (%u streaming), %llu requests, %llu sent",
+                    ControlServer::Endpoint(), cs.clients, cs.subscribers, cs.requests, cs.sent);
+        ImGui::Text("Control stream   : %llu packets, %llu dropped", cs.streamed, cs.streamDropped);
+        ImGui::Text("Control limits   : %llu sends refused (queue full), %llu clients dropped (not reading)",
+                    cs.busy, cs.kicked);
+    }
+    else
+        ImGui::TextDisabled("Control          : off");
+
+    const LogStats lg = Log::Stats();
+    ImGui::Text("Log              : %llu written, %llu dropped, %llu truncated, %u threads",
+                lg.written, lg.dropped, lg.truncated, lg.threads);
+    if (ImGui::TreeNode("Log filter"))
+    {
+        int level = static_cast<int>(Log::MinLevel());
+        if (ImGui::Combo("Min level", &level, "Debug\0Info\0Warn\0Error\0"))
+            Log::SetMinLevel(static_cast<LogLevel>(level));
+        for (int c = 0; c < static_cast<int>(LogCategory::Count); ++c)
+        {
+            const LogCategory cat = static_cast<LogCategory>(c);
+            bool on = Log::CategoryEnabled(cat);
+            if (c) ImGui::SameLine();
+            if (ImGui::Checkbox(Log::CategoryName(cat), &on))
+                Log::SetCategoryEnabled(cat, on);
+        }
+        ImGui::TreePop();
+    }
     ImGui::Separator();
     ImGui::Text("WowConnection*   : %p", conn);
 
-    // Only dereference conn if it's still readable (avoids AV if connection was closed/freed).
-    if (conn && IsBadReadPtr(conn, sizeof(WowConnection)) == 0)
+    // Session key export for tools/decrypt (offline pcap decryption)
+    uint8_t key[40];
+    const uint8_t keyLen = PacketHooks::GetSessionKey(key);
+    if (keyLen)
+    {
+        if (ImGui::Button("Export session key"))
+        {
+            if (FILE* f = fopen("PacketGod_session.key", "a"))
+            {
+                for (uint8_t i = 0; i < keyLen; ++i) fprintf(f, "%02X", key[i]);
+                fprintf(f, "\n");
+                fclose(f);
+            }
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("appends to PacketGod_session.key");
+    }
+
+    ConnInfo live[ConnectionTracker::kMaxConnections];
+    const int liveCount = ConnectionTracker::Snapshot(live, ConnectionTracker::kMaxConnections);
+    ImGui::Text("Live connections : %d  (generation %u)", liveCount, ConnectionTracker::Generation());
+    for (int i = 0; i < liveCount; ++i)
+        ImGui::BulletText("#%u %-5s %p  %s%s", live[i].id, ConnectionTracker::RoleName(live[i].role), (void*)live[i].conn,
+                          live[i].state == ConnState::Encrypted ? "encrypted" : "open",
+                          live[i].conn == conn ? "  (active)" : "");
+
+    // Only dereference conn while the tracker still has it live (not yet disconnected).
+    if (conn && ConnectionTracker::IsLive(conn))
     {
         ImGui::Text("Encrypted        : %u", static_cast<unsigned>(conn->m_isEncrypted));
         ImGui::Text("Header send/recv : %u / %u",
@@ -381,6 +1353,16 @@ static void DrawStatsTab(float /*availHeight*/)
     }
     else if (conn)
         ImGui::TextColored(ImVec4(1,0.4f,0,1), "(connection pointer stale)");
+
+    if (conn)
+    {
+        const StreamStats ss = PacketHooks::GetStreamStats(conn);
+        ImGui::Separator();
+        ImGui::Text("SMSG zero-copy   : %llu", ss.zeroCopy);
+        ImGui::Text("SMSG reassembled : %llu", ss.reassembled);
+        ImGui::Text("Large headers    : %llu", ss.largeHeader);
+        ImGui::Text("Framing resyncs  : %llu", ss.resyncs);
+    }
 }
 
 // ============================================================
@@ -388,7 +1370,19 @@ static void DrawStatsTab(float /*availHeight*/)
 // ============================================================
 void PacketUI::Render()
 {
-    s_snapshot = PacketCapture::Snapshot();
+    PacketCapture::SnapshotColumns(s_columns, s_connFilter);
+    SelectRows();
+
+    // Keep the selection while its packet is in the ring; refresh it
+    // so a late-attached inflated form shows up.
+    if (s_hasSelection)
+    {
+        const size_t row = s_columns.Find(s_selectedSeq);
+        if (row != PacketColumns::npos)
+            s_selectedPkt.inflated = s_columns.Inflated(row);
+        else
+            s_hasSelection = false;
+    }
 
     ImGui::SetNextWindowSize(ImVec2(820, 640), ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowPos(ImVec2(20, 20),    ImGuiCond_FirstUseEver);
@@ -403,18 +1397,101 @@ void PacketUI::Render()
     }
 
     // ── Toolbar ────────────────────────────────────────────────
+    {
+        bool armed = PacketHooks::IsArmed();
+        if (ImGui::Checkbox("Armed", &armed))
+            PacketHooks::SetArmed(armed);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Off: nothing is captured; the decrypt / recv hooks are disabled.\n"
+                              "The send hook stays in, so rewrite rules keep applying.");
+        ImGui::SameLine();
+        ImGui::TextDisabled("|"); ImGui::SameLine();
+    }
     ImGui::Checkbox("CMSG", &s_showCMSG); ImGui::SameLine();
     ImGui::Checkbox("SMSG", &s_showSMSG); ImGui::SameLine();
+    ImGui::SetNextItemWidth(110);
+    {
+        char preview[24] = "all";
+        if (s_connFilter >= 0) FormatConnection(static_cast<uint8_t>(s_connFilter), preview, sizeof(preview));
+        if (ImGui::BeginCombo("Conn", preview))
+        {
+            if (ImGui::Selectable("all", s_connFilter < 0)) { s_connFilter = -1; s_hasSelection = false; }
+            for (const ConnectionStats& cs : PacketCapture::PerConnection())
+            {
+                char label[24];
+                FormatConnection(cs.connection, label, sizeof(label));
+                ImGui::PushID(cs.connection);
+                if (ImGui::Selectable(label, s_connFilter == cs.connection))
+                {
+                    s_connFilter = cs.connection;
+                    s_hasSelection = false;
+                }
+                ImGui::PopID();
+            }
+            ImGui::EndCombo();
+        }
+    }
+    ImGui::SameLine();
     ImGui::TextDisabled("|"); ImGui::SameLine();
     ImGui::SetNextItemWidth(160);
     ImGui::InputText("Filter", s_filterText, sizeof(s_filterText));
     ImGui::SameLine();
+    ImGui::SetNextItemWidth(140);
+    if (ImGui::InputText("Bytes", s_findHex, sizeof(s_findHex)))
+        ParseHexPattern(s_findHex, s_findBytes);
+    if (s_samePayload)
+    {
+        ImGui::SameLine();
+        if (ImGui::SmallButton("identical only  x"))
+            s_samePayload = 0;
+    }
+    ImGui::SameLine();
     ImGui::Checkbox("Auto-scroll", &s_autoScroll);
     ImGui::SameLine();
+    if (ImGui::Button("Save"))
+    {
+        // Straight from the snapshot's columns: no per-packet copies.
+        CaptureWriter w;
+        if (w.Open("PacketGod_capture.pgcap"))
+            for (size_t r = 0; r < s_columns.Rows(); ++r)
+                w.Write(static_cast<PacketDirection>(s_columns.Direction()[r]), s_columns.Opcode()[r],
+                        s_columns.Timestamp()[r], s_columns.Payload(r), s_columns.Stored()[r],
+                        s_columns.Connection()[r], s_columns.Size()[r]);
+        w.Close();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export..."))
+        ImGui::OpenPopup("ExportPopup");
+    if (ImGui::BeginPopup("ExportPopup"))
+    {
+        ImGui::Combo("Format", &s_exportFormat, "CSV\0JSON Lines\0Columns (.pgcol)\0");
+        if (s_exportFormat != static_cast<int>(ExportFormat::Columns))
+            ImGui::Combo("Payload", &s_exportEncoding, "none\0hex\0base64\0");
+        if (ImGui::Button("Export"))
+        {
+            ExportOptions opt;
+            opt.format  = static_cast<ExportFormat>(s_exportFormat);
+            opt.payload = static_cast<PayloadEncoding>(s_exportEncoding);
+
+            std::vector<SharedPacket> packets;
+            s_columns.ToShared(0, packets);
+            char path[64];
+            snprintf(path, sizeof(path), "PacketGod_capture.%s", ExportFormatExtension(opt.format));
+            uint64_t bytes = 0;
+            if (ExportCapture(path, packets, opt, &bytes))
+                LOG_INFO(UI, "Exported %zu packets to %s (%llu KB)", packets.size(), path,
+                         static_cast<unsigned long long>(bytes >> 10));
+            else
+                LOG_ERROR(UI, "Export to %s failed", path);
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndPopup();
+    }
+    ImGui::SameLine();
     if (ImGui::Button("Clear Log"))
     {
         PacketCapture::Clear();
-        s_selected = -1;
+        s_hasSelection = false;
     }
     ImGui::Separator();
 
@@ -453,6 +1530,26 @@ void PacketUI::Render()
             DrawFiltersTab(tabBodyH);
             ImGui::EndTabItem();
         }
+        if (ImGui::BeginTabItem("Fuzzer"))
+        {
+            DrawFuzzerTab(tabBodyH);
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("Rewrite"))
+        {
+            DrawRewriteTab(tabBodyH);
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("Objects"))
+        {
+            DrawObjectsTab(tabBodyH);
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("Timeline"))
+        {
+            DrawTimelineTab(tabBodyH);
+            ImGui::EndTabItem();
+        }
         if (ImGui::BeginTabItem("Stats / Keys"))
         {
             DrawStatsTab(tabBodyH);
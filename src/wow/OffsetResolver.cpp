@@ -0,0 +1,510 @@
+#include "OffsetResolver.h"
+#include "Offsets.h"
+#include "../packet/PacketHash.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static constexpr size_t   kChunkBytes    = 256 * 1024;   // per scan task: stays in L2 across the signature set
+static constexpr size_t   kHashChunk     = 1024 * 1024;
+static constexpr size_t   kMinSigBytes   = 16;
+static constexpr size_t   kMaxSigBytes   = 128;
+static constexpr size_t   kMaxGlobalRefs = 16;           // references tried per global in Generate()
+static constexpr size_t   kOperandSlack  = 5;            // bytes either side of a window that may hold its operands
+
+using ResolveClock = std::chrono::steady_clock;
+
+static double MsSince(ResolveClock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(ResolveClock::now() - t0).count();
+}
+
+static uintptr_t* SlotFor(const std::string& name)
+{
+    for (const Offsets::Slot& s : Offsets::kSlots)
+        if (name == s.name) return s.address;
+    return nullptr;
+}
+
+static uint32_t ReadU32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// Runs fn(task) for task in [0, count) on up to `threads` threads (0 = all cores).
+template <typename Fn>
+static void ParallelFor(size_t count, unsigned threads, Fn fn)
+{
+    if (threads == 0) threads = (std::max)(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>((std::min)(static_cast<size_t>(threads), count));
+    if (threads <= 1)
+    {
+        for (size_t t = 0; t < count; ++t) fn(t);
+        return;
+    }
+    std::atomic<size_t>      next{ 0 };
+    std::vector<std::thread> pool;
+    auto worker = [&] { for (size_t t; (t = next.fetch_add(1)) < count;) fn(t); };
+    for (unsigned i = 1; i < threads; ++i) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+}
+
+// ============================================================
+//  ModuleImage
+// ============================================================
+
+const uint8_t* ModuleImage::At(uintptr_t va, size_t n) const
+{
+    for (const ModuleSection& s : sections)
+        if (va >= s.va && va - s.va + n <= s.size) return s.data + (va - s.va);
+    return nullptr;
+}
+
+bool ModuleImage::FromPe(const uint8_t* base, ModuleImage& out)
+{
+    out = ModuleImage{};
+    if (!base || base[0] != 'M' || base[1] != 'Z') return false;
+
+    const uint8_t* nt = base + ReadU32(base + 0x3C);
+    if (memcmp(nt, "PE\0\0", 4) != 0) return false;
+    uint16_t sectionCount, optSize, magic;
+    memcpy(&sectionCount, nt + 6, 2);
+    memcpy(&optSize, nt + 20, 2);
+    const uint8_t* opt = nt + 24;
+    memcpy(&magic, opt, 2);
+    if (magic != 0x10B && magic != 0x20B) return false;   // PE32 / PE32+
+
+    out.base = reinterpret_cast<uintptr_t>(base);
+    out.size = ReadU32(opt + 56);
+    const uint8_t* sh = opt + optSize;
+    for (uint16_t i = 0; i < sectionCount; ++i, sh += 40)
+    {
+        ModuleSection s;
+        memcpy(s.name, sh, 8);
+        const uint32_t virtualSize = ReadU32(sh + 8);
+        const uint32_t rva         = ReadU32(sh + 12);
+        const uint32_t rawSize     = ReadU32(sh + 16);
+        const uint32_t flags       = ReadU32(sh + 36);
+        s.va   = out.base + rva;
+        s.data = base + rva;
+        s.size = virtualSize ? virtualSize : rawSize;
+        s.code = (flags & (0x00000020u | 0x20000000u)) != 0;   // CNT_CODE | MEM_EXECUTE
+        if (rva + s.size > out.size) return false;
+        out.sections.push_back(s);
+    }
+    return true;
+}
+
+// ============================================================
+//  Signature files
+// ============================================================
+
+bool OffsetResolver::ParseSignatures(const char* text, std::vector<OffsetSignature>& out, std::string& error)
+{
+    out.clear();
+    error.clear();
+    int lineNo = 0;
+    for (const char* line = text; *line;)
+    {
+        const char* end = strchr(line, '\n');
+        if (!end) end = line + strlen(line);
+        std::string l(line, end);
+        line = *end ? end + 1 : end;
+        ++lineNo;
+
+        if (const size_t hash = l.find('#'); hash != std::string::npos) l.resize(hash);
+        if (!l.empty() && l.back() == '\r') l.pop_back();
+        char name[64] = {}, delta[16] = {};
+        int  used = 0;
+        if (sscanf(l.c_str(), " %63s %15s %n", name, delta, &used) < 2)
+        {
+            if (l.find_first_not_of(" \t") == std::string::npos) continue;   // blank / comment
+            error = "line " + std::to_string(lineNo) + ": expected name, offset and pattern";
+            return false;
+        }
+
+        OffsetSignature s;
+        s.name  = name;
+        s.deref = delta[0] == '*';
+        char* stop;
+        s.delta = static_cast<int32_t>(strtol(delta + (s.deref ? 1 : 0), &stop, 0));
+        if (*stop)
+        {
+            error = "line " + std::to_string(lineNo) + ": bad offset '" + delta + "'";
+            return false;
+        }
+        if (!SlotFor(s.name))
+        {
+            error = "line " + std::to_string(lineNo) + ": no Offsets slot '" + s.name + "'";
+            return false;
+        }
+        if (!Signature::Parse(l.c_str() + used, s.sig))
+        {
+            error = "line " + std::to_string(lineNo) + ": bad pattern for " + s.name;
+            return false;
+        }
+        out.push_back(std::move(s));
+    }
+    return true;
+}
+
+std::string OffsetResolver::FormatSignatures(const std::vector<OffsetSignature>& sigs)
+{
+    std::string text = "# PacketGod signatures: Offsets slot, [*]offset from the match, pattern\n"
+                       "# '*' = the slot is the u32 stored at match + offset\n";
+    for (const OffsetSignature& s : sigs)
+    {
+        char head[96];
+        snprintf(head, sizeof(head), "%-26s %s%-4d ", s.name.c_str(), s.deref ? "*" : " ", s.delta);
+        text += head;
+        text += s.sig.ToString();
+        text += '\n';
+    }
+    return text;
+}
+
+bool OffsetResolver::LoadSignatures(const char* path, std::vector<OffsetSignature>& out, std::string& error)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+    {
+        error = std::string("cannot open ") + path;
+        return false;
+    }
+    std::string text;
+    char buf[4096];
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;) text.append(buf, n);
+    fclose(f);
+    return ParseSignatures(text.c_str(), out, error);
+}
+
+bool OffsetResolver::SaveSignatures(const char* path, const std::vector<OffsetSignature>& sigs)
+{
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    const std::string text = FormatSignatures(sigs);
+    const bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+    return (fclose(f) == 0) && ok;
+}
+
+// ============================================================
+//  Hash / scan
+// ============================================================
+
+uint64_t OffsetResolver::ModuleHash(const ModuleImage& image, unsigned threads)
+{
+    struct Piece { const uint8_t* data; size_t size; };
+    std::vector<Piece> pieces;
+    for (const ModuleSection& s : image.sections)
+        if (s.code)
+            for (size_t at = 0; at < s.size; at += kHashChunk)
+                pieces.push_back({ s.data + at, (std::min)(kHashChunk, s.size - at) });
+
+    std::vector<uint64_t> hashes(pieces.size() + 1);
+    ParallelFor(pieces.size(), threads,
+                [&](size_t i) { hashes[i] = PacketHash::Hash(pieces[i].data, pieces[i].size, i); });
+    hashes.back() = image.size;
+    return PacketHash::Hash(reinterpret_cast<const uint8_t*>(hashes.data()), hashes.size() * 8);
+}
+
+std::vector<OffsetResult> OffsetResolver::Scan(const ModuleImage& image, const std::vector<OffsetSignature>& sigs,
+                                               unsigned threads, ScanIsa isa)
+{
+    struct Task { const ModuleSection* section; size_t begin, end; };   // owns match starts in [begin, end)
+    struct Hit  { uint32_t count; uintptr_t first; };
+
+    size_t longest = 0;
+    for (const OffsetSignature& s : sigs) longest = (std::max)(longest, s.sig.Size());
+
+    std::vector<Task> tasks;
+    for (const ModuleSection& s : image.sections)
+        if (s.code)
+            for (size_t at = 0; at < s.size; at += kChunkBytes)
+                tasks.push_back({ &s, at, (std::min)(at + kChunkBytes, s.size) });
+
+    // Tasks are in address order, so merging them in order keeps the first match.
+    std::vector<Hit> hits(tasks.size() * sigs.size(), Hit{ 0, 0 });
+    ParallelFor(tasks.size(), threads, [&](size_t t)
+    {
+        const Task&    task = tasks[t];
+        const uint8_t* data = task.section->data + task.begin;
+        const size_t   span = (std::min)(task.end + longest - 1, task.section->size) - task.begin;
+        std::vector<size_t> found;
+        for (size_t i = 0; i < sigs.size(); ++i)
+        {
+            found.clear();
+            SigScan::FindAll(data, span, sigs[i].sig, found, 2, isa);
+            Hit& h = hits[t * sigs.size() + i];
+            for (size_t at : found)
+            {
+                if (at >= task.end - task.begin) break;   // the next task's
+                if (!h.count++) h.first = task.section->va + task.begin + at;
+            }
+        }
+    });
+
+    std::vector<OffsetResult> out(sigs.size());
+    for (size_t i = 0; i < sigs.size(); ++i)
+    {
+        OffsetResult& r = out[i];
+        r.name = sigs[i].name;
+        uintptr_t match = 0;
+        for (size_t t = 0; t < tasks.size(); ++t)
+        {
+            const Hit& h = hits[t * sigs.size() + i];
+            if (h.count && !r.matches) match = h.first;
+            r.matches += h.count;
+        }
+        if (r.matches != 1) continue;
+
+        const uintptr_t at = match + sigs[i].delta;
+        if (sigs[i].deref)
+        {
+            const uint8_t* p = image.At(at, 4);
+            if (!p) continue;
+            r.address = ReadU32(p);
+        }
+        else
+            r.address = at;
+        r.source = OffsetSource::Scan;
+    }
+    return out;
+}
+
+// ============================================================
+//  Cache — text lines "key name address matches"; key mixes the
+//  module hash with the signature set, so editing PacketGod.sigs
+//  rescans.  Addresses are stored relative to the module base.
+// ============================================================
+
+static bool LoadCache(const char* path, uint64_t key, uintptr_t base, const std::vector<OffsetSignature>& sigs,
+                      std::vector<OffsetResult>& out)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    out.assign(sigs.size(), OffsetResult{});
+    std::vector<bool> seen(sigs.size(), false);
+    char line[256];
+    while (fgets(line, sizeof(line), f))
+    {
+        unsigned long long k, rva;
+        unsigned           matches;
+        char               name[64];
+        if (sscanf(line, "%llx %63s %llx %u", &k, name, &rva, &matches) != 4 || k != key) continue;
+        for (size_t i = 0; i < sigs.size(); ++i)
+        {
+            if (sigs[i].name != name) continue;
+            OffsetResult& r = out[i];
+            r.name    = name;
+            r.matches = matches;
+            if (matches == 1)
+            {
+                r.address = base + static_cast<uintptr_t>(rva);
+                r.source  = OffsetSource::Cache;
+            }
+            seen[i] = true;
+        }
+    }
+    fclose(f);
+    return std::all_of(seen.begin(), seen.end(), [](bool b) { return b; });
+}
+
+// Rewrites the file with this key's lines replaced.
+static void SaveCache(const char* path, uint64_t key, uintptr_t base, const std::vector<OffsetResult>& results)
+{
+    std::string keep;
+    if (FILE* f = fopen(path, "r"))
+    {
+        char line[256];
+        while (fgets(line, sizeof(line), f))
+        {
+            unsigned long long k;
+            if (line[0] == '#' || (sscanf(line, "%llx", &k) == 1 && k == key)) continue;
+            keep += line;
+        }
+        fclose(f);
+    }
+
+    FILE* f = fopen(path, "w");
+    if (!f) return;
+    fputs("# PacketGod offset cache: key (module + signatures), slot, address - module base, matches\n", f);
+    fputs(keep.c_str(), f);
+    for (const OffsetResult& r : results)
+        fprintf(f, "%016llx %s %llx %u\n", static_cast<unsigned long long>(key), r.name.c_str(),
+                static_cast<unsigned long long>(r.matches == 1 ? r.address - base : 0), r.matches);
+    fclose(f);
+}
+
+// ============================================================
+//  Resolve
+// ============================================================
+
+static OffsetReport s_lastReport;
+
+bool OffsetResolver::Resolve(const ModuleImage& image, const std::vector<OffsetSignature>& sigs, const char* cachePath,
+                             OffsetReport& report, unsigned threads)
+{
+    report     = OffsetReport{};
+    report.isa = SigScan::BestIsa();
+
+    auto t0 = ResolveClock::now();
+    report.moduleHash = ModuleHash(image, threads);
+    report.hashMs     = MsSince(t0);
+
+    const std::string sigText = FormatSignatures(sigs);
+    const uint64_t    key     = PacketHash::Hash(reinterpret_cast<const uint8_t*>(sigText.data()), sigText.size(),
+                                                 report.moduleHash);
+
+    report.cacheHit = cachePath && LoadCache(cachePath, key, image.base, sigs, report.results);
+    if (!report.cacheHit)
+    {
+        t0 = ResolveClock::now();
+        report.results = Scan(image, sigs, threads);
+        report.scanMs  = MsSince(t0);
+        report.scanned = static_cast<uint32_t>(sigs.size());
+        if (cachePath) SaveCache(cachePath, key, image.base, report.results);
+    }
+
+    for (const OffsetResult& r : report.results)
+    {
+        uintptr_t* slot = SlotFor(r.name);
+        if (r.source == OffsetSource::Default || !slot) continue;
+        *slot = r.address;
+        ++report.placed;
+    }
+    s_lastReport = report;
+    return report.placed == report.results.size();
+}
+
+const OffsetReport& OffsetResolver::LastReport()
+{
+    return s_lastReport;
+}
+
+// ============================================================
+//  Generate
+// ============================================================
+
+// Wildcards what a rebuild moves: rel32 branch / call displacements
+// landing in the module, and any u32 that is an address inside it.
+// Instruction boundaries are unknown, so every window that looks like
+// one is masked (overlaps included): a stray hit only costs a few
+// fixed bytes, a skipped one breaks the signature on the next build.
+static void MaskMovable(const ModuleImage& image, uintptr_t va, const uint8_t* p, size_t n, uint8_t* mask)
+{
+    memset(mask, 0xFF, n);
+    for (size_t j = 0; j < n; ++j)
+    {
+        size_t rel = 0;   // offset of a rel32 operand
+        if ((p[j] == 0xE8 || p[j] == 0xE9) && j + 5 <= n)                  rel = j + 1;
+        else if (p[j] == 0x0F && j + 6 <= n && (p[j + 1] & 0xF0) == 0x80)   rel = j + 2;
+        if (rel)
+        {
+            const int32_t  d      = static_cast<int32_t>(ReadU32(p + rel));
+            const uint64_t target = static_cast<uint64_t>(va + rel + 4) + static_cast<int64_t>(d);
+            if (image.Contains(target)) memset(mask + rel, 0, 4);
+        }
+        if (j + 4 <= n && image.Contains(ReadU32(p + j))) memset(mask + j, 0, 4);
+    }
+}
+
+static size_t CountMatches(const ModuleImage& image, const Signature& sig, uintptr_t& first)
+{
+    size_t count = 0;
+    std::vector<size_t> found;
+    for (const ModuleSection& s : image.sections)
+    {
+        if (!s.code) continue;
+        found.clear();
+        SigScan::FindAll(s.data, s.size, sig, found, 2);
+        if (!count && !found.empty()) first = s.va + found[0];
+        count += found.size();
+        if (count > 1) break;
+    }
+    return count;
+}
+
+// Shortest window at `start` (16, 24, ... bytes) that matches only
+// there.  Masking sees a few bytes either side, so an operand cut by
+// the window's edge is still recognised.
+static bool GrowUnique(const ModuleImage& image, uintptr_t start, Signature& out)
+{
+    uint8_t mask[kOperandSlack + kMaxSigBytes + kOperandSlack];
+    for (size_t n = kMinSigBytes; n <= kMaxSigBytes; n += 8)
+    {
+        const uint8_t* p = image.At(start, n);
+        if (!p) return false;
+        const size_t lead = image.At(start - kOperandSlack, kOperandSlack + n) ? kOperandSlack : 0;
+        const size_t tail = image.At(start, n + kOperandSlack) ? kOperandSlack : 0;
+        MaskMovable(image, start - lead, p - lead, lead + n + tail, mask);
+        uintptr_t first = 0;
+        if (Signature::Build(p, mask + lead, n, out) && CountMatches(image, out, first) == 1 && first == start)
+            return true;
+    }
+    return false;
+}
+
+static bool InCode(const ModuleImage& image, uintptr_t va)
+{
+    for (const ModuleSection& s : image.sections)
+        if (s.code && va >= s.va && va - s.va < s.size) return true;
+    return false;
+}
+
+std::vector<OffsetSignature> OffsetResolver::Generate(const ModuleImage& image, const std::vector<std::string>& names,
+                                                      std::vector<std::string>* failed)
+{
+    std::vector<std::string> wanted = names;
+    if (wanted.empty())
+        for (const Offsets::Slot& s : Offsets::kSlots) wanted.push_back(s.name);
+
+    std::vector<OffsetSignature> out;
+    for (const std::string& name : wanted)
+    {
+        const uintptr_t* slot = SlotFor(name);
+        OffsetSignature  s;
+        s.name = name;
+        bool ok = false;
+        if (slot && InCode(image, *slot))
+        {
+            ok = GrowUnique(image, *slot, s.sig);   // the function's own first bytes
+        }
+        else if (slot && image.Contains(*slot))
+        {
+            // A global: an instruction that references it, opcode + ModRM before the address.
+            uint8_t raw[4];
+            const uint32_t addr = static_cast<uint32_t>(*slot);
+            memcpy(raw, &addr, 4);
+            static const uint8_t kFull[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+            Signature exact;
+            Signature::Build(raw, kFull, 4, exact);
+            std::vector<size_t> refs;
+            for (const ModuleSection& sec : image.sections)
+            {
+                if (!sec.code || ok) continue;
+                refs.clear();
+                SigScan::FindAll(sec.data, sec.size, exact, refs, kMaxGlobalRefs);
+                for (size_t ref : refs)
+                {
+                    if (ref < 2) continue;
+                    if ((ok = GrowUnique(image, sec.va + ref - 2, s.sig)))
+                    {
+                        s.delta = 2;
+                        s.deref = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (ok) out.push_back(std::move(s));
+        else if (failed) failed->push_back(name);
+    }
+    return out;
+}
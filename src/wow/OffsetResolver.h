@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "SigScan.h"
+
+// ============================================================
+//  OffsetResolver — places Offsets:: in the running client
+//
+//  Each Offsets slot may have a signature: a masked byte pattern,
+//  the distance from the match to the target, and whether the
+//  target is the match address itself (functions) or the 32-bit
+//  absolute address stored there (globals, via an instruction that
+//  references them).  A signature must match exactly once across
+//  the module's code sections to be used.
+//
+//  Resolve() first hashes the code sections; a cache file entry
+//  for that hash (and this signature set) is applied without
+//  scanning.  Otherwise every signature is searched over the code
+//  in parallel (sections split into chunks, one worker per core),
+//  and the result is cached for the next launch.  Slots that no
+//  signature places keep their build 12340 address.
+//
+//  Generate() writes signatures for the current Offsets values
+//  from a client they are known to be right for: the bytes at
+//  each function (or around an instruction referencing each
+//  global), with absolute addresses into the module and rel32
+//  branch displacements wildcarded, grown until unique.
+//
+//  Portable: works on any ModuleImage, so the bench runs it over
+//  synthetic images on Linux.  FromPe() maps a loaded PE module.
+// ============================================================
+
+struct ModuleSection
+{
+    char           name[9] = {};
+    uintptr_t      va      = 0;         // address of data[0] in the module
+    const uint8_t* data    = nullptr;
+    size_t         size    = 0;
+    bool           code    = false;     // IMAGE_SCN_CNT_CODE / MEM_EXECUTE
+};
+
+struct ModuleImage
+{
+    uintptr_t                  base = 0;
+    size_t                     size = 0;   // SizeOfImage
+    std::vector<ModuleSection> sections;
+
+    bool Contains(uint64_t va) const { return va >= base && va < base + size; }
+    // `n` readable bytes at `va`, or null if no section holds them.
+    const uint8_t* At(uintptr_t va, size_t n) const;
+
+    // Section table of a PE image mapped at `base` (headers included).
+    static bool FromPe(const uint8_t* base, ModuleImage& out);
+};
+
+struct OffsetSignature
+{
+    std::string name;          // Offsets::kSlots name
+    Signature   sig;
+    int32_t     delta = 0;     // target = match + delta ...
+    bool        deref = false; // ... or the u32 stored at match + delta
+};
+
+enum class OffsetSource : uint8_t { Default, Cache, Scan };
+
+struct OffsetResult
+{
+    std::string  name;
+    uintptr_t    address = 0;
+    OffsetSource source  = OffsetSource::Default;
+    uint32_t     matches = 0;   // scan: 0 = not found, > 1 = ambiguous (both keep the default)
+};
+
+struct OffsetReport
+{
+    uint64_t                  moduleHash = 0;
+    bool                      cacheHit   = false;
+    uint32_t                  scanned    = 0;     // signatures searched
+    uint32_t                  placed     = 0;     // slots moved off or confirmed by a signature / the cache
+    double                    hashMs     = 0.0;
+    double                    scanMs     = 0.0;
+    ScanIsa                   isa        = ScanIsa::Scalar;
+    std::vector<OffsetResult> results;            // one per slot with a signature
+};
+
+namespace OffsetResolver
+{
+    // One signature per line:  name  [*]delta  pattern
+    //   WowConn_Send     0  55 8B EC 81 EC ?? ?? ?? ?? 53 56 8B F1
+    //   g_DefaultSeed   *3  8B 15 ?? ?? ?? ?? 89 55 ...
+    // '#' starts a comment.  Unknown slot names are errors.
+    bool ParseSignatures(const char* text, std::vector<OffsetSignature>& out, std::string& error);
+    std::string FormatSignatures(const std::vector<OffsetSignature>& sigs);
+    bool LoadSignatures(const char* path, std::vector<OffsetSignature>& out, std::string& error);
+    bool SaveSignatures(const char* path, const std::vector<OffsetSignature>& sigs);
+
+    uint64_t ModuleHash(const ModuleImage& image, unsigned threads = 0);   // code sections only
+
+    // Searches `sigs` over the code sections; results in `sigs` order.
+    // threads 0 = all cores, 1 = inline.
+    std::vector<OffsetResult> Scan(const ModuleImage& image, const std::vector<OffsetSignature>& sigs,
+                                   unsigned threads = 0, ScanIsa isa = SigScan::BestIsa());
+
+    // Hash → cache → scan → write Offsets:: (and the cache, if
+    // `cachePath` is set and the scan ran).
+    bool Resolve(const ModuleImage& image, const std::vector<OffsetSignature>& sigs, const char* cachePath,
+                 OffsetReport& report, unsigned threads = 0);
+
+    // Signatures for the named slots at their current addresses
+    // (all slots when `names` is empty).  Slots none can be built for
+    // are listed in `failed`.
+    std::vector<OffsetSignature> Generate(const ModuleImage& image, const std::vector<std::string>& names,
+                                          std::vector<std::string>* failed = nullptr);
+
+    const OffsetReport& LastReport();   // of the last Resolve()
+}
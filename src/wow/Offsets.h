@@ -1,8 +1,15 @@
 #pragma once
 #include <cstdint>
+#include <initializer_list>
 
 // ============================================================
 //  PacketGod — WoW 3.3.5a Build 12340 — Known Addresses
+//
+//  The values below are build 12340's.  OffsetResolver rewrites
+//  them at startup, before any hook is installed, from byte
+//  signatures (PacketGod.sigs) when the module differs; anything
+//  it cannot place keeps its 12340 address.  Read them only after
+//  that point.
 // ============================================================
 
 namespace Offsets
@@ -10,61 +17,121 @@ namespace Offsets
     // --------------------------------------------------------
     //  Cryptography
     // --------------------------------------------------------
-    constexpr uintptr_t ARC4_Init             = 0x00775040;  // void ARC4_Init(SARC4State*, const uint8_t* key, int keyLen)
-    constexpr uintptr_t ARC4_Process          = 0x00774EA0;  // SARC4State* __cdecl ARC4_Process(data, len, srcState, dstState)
+    inline uintptr_t ARC4_Init                 = 0x00775040;  // void ARC4_Init(SARC4State*, const uint8_t* key, int keyLen)
+    inline uintptr_t ARC4_Process              = 0x00774EA0;  // SARC4State* __cdecl ARC4_Process(data, len, srcState, dstState)
 
-    constexpr uintptr_t SHA1_Prepare          = 0x0077AAA0;  // SHA1::Init
-    constexpr uintptr_t SHA1_Process          = 0x006CA180;  // SHA1::Update
-    constexpr uintptr_t SHA1_Finish           = 0x006CA270;  // SHA1::Final
+    inline uintptr_t SHA1_Prepare              = 0x0077AAA0;  // SHA1::Init
+    inline uintptr_t SHA1_Process              = 0x006CA180;  // SHA1::Update
+    inline uintptr_t SHA1_Finish               = 0x006CA270;  // SHA1::Final
 
     // --------------------------------------------------------
     //  WowConnection
     // --------------------------------------------------------
-    constexpr uintptr_t WowConn_Send          = 0x004675F0;  // ::Send(this, CDataStore*, priority) — Layer A hook target
-    constexpr uintptr_t WowConn_Encrypt       = 0x004665B0;  // ::Encrypt — XORs 6-byte CMSG header with ARC4
-    constexpr uintptr_t WowConn_SetStatus     = 0x004667C0;  // ::SetStatus(this, int) — e.g. 7=error/closing
-    constexpr uintptr_t WowConn_SetEncKey     = 0x00466BF0;  // ::SetEncryptionKey(this, sessionKey, keyLen, serverMode, seed, seedLen)
-    constexpr uintptr_t WowConn_SetEncryption = 0x00466820;  // ::SetEncryption – activates ARC4 on the connection
-    constexpr uintptr_t WowConn_Disconnect    = 0x00466B50;  // ::Disconnect
-    constexpr uintptr_t WowConn_HMAC_Prepare  = 0x004668A0;  // internal HMAC context init
+    inline uintptr_t WowConn_Send              = 0x004675F0;  // ::Send(this, CDataStore*, priority) — Layer A hook target
+    inline uintptr_t WowConn_Encrypt           = 0x004665B0;  // ::Encrypt — XORs 6-byte CMSG header with ARC4
+    inline uintptr_t WowConn_SetStatus         = 0x004667C0;  // ::SetStatus(this, int) — e.g. 7=error/closing
+    inline uintptr_t WowConn_SetEncKey         = 0x00466BF0;  // ::SetEncryptionKey(this, sessionKey, keyLen, serverMode, seed, seedLen)
+    inline uintptr_t WowConn_SetEncryption     = 0x00466820;  // ::SetEncryption – activates ARC4 on the connection
+    inline uintptr_t WowConn_Disconnect        = 0x00466B50;  // ::Disconnect
+    inline uintptr_t WowConn_HMAC_Prepare      = 0x004668A0;  // internal HMAC context init
 
     // WowConnection Init — check here to verify full object size
-    constexpr uintptr_t WowConn_Init          = 0x004669D0;  // TODO: verify
+    inline uintptr_t WowConn_Init              = 0x004669D0;  // TODO: verify
 
     // --------------------------------------------------------
     //  NetClient
     // --------------------------------------------------------
-    constexpr uintptr_t NetClient_AuthChallenge = 0x00632730; // SMSG_AUTH_CHALLENGE handler
-    constexpr uintptr_t NetClient_SolvePoW      = 0x006321B0; // SHA1 proof-of-work solver
-    constexpr uintptr_t NetClient_AddEvent      = 0x00633650; // NETEVENTQUEUE::AddEvent
-    constexpr uintptr_t NetClient_Send          = 0x00632B50; // prepends opcode to CDataStore then calls WowConn_Send
+    inline uintptr_t NetClient_AuthChallenge     = 0x00632730; // SMSG_AUTH_CHALLENGE handler
+    inline uintptr_t NetClient_SolvePoW          = 0x006321B0; // SHA1 proof-of-work solver
+    inline uintptr_t NetClient_AddEvent          = 0x00633650; // NETEVENTQUEUE::AddEvent
+    inline uintptr_t NetClient_Send              = 0x00632B50; // prepends opcode to CDataStore then calls WowConn_Send
 
     // --------------------------------------------------------
     //  CDataStore — key serialization helpers
     // --------------------------------------------------------
-    constexpr uintptr_t CDataStore_Constructor  = 0x00401050; // CDataStore::CDataStore()
-    constexpr uintptr_t CDataStore_Finalize     = 0x00401130; // resets m_read to 0 (write→read mode)
-    constexpr uintptr_t CDataStore_Reset        = 0x004010E0; // clears buffer, m_read = -1
-    constexpr uintptr_t CDataStore_Put_uint8    = 0x0047AFE0;
-    constexpr uintptr_t CDataStore_Put_uint16   = 0x0047B040;
-    constexpr uintptr_t CDataStore_Put_uint32   = 0x0047B0A0;
-    constexpr uintptr_t CDataStore_Put_uint64   = 0x0047B100;
-    constexpr uintptr_t CDataStore_PutArray     = 0x0047B1C0; // raw byte array
-    constexpr uintptr_t CDataStore_PutString    = 0x0047B300; // null-terminated string
-    constexpr uintptr_t CDataStore_Get_uint8    = 0x0047B340;
-    constexpr uintptr_t CDataStore_Get_uint16   = 0x0047B380;
-    constexpr uintptr_t CDataStore_Get_uint32   = 0x0047B3C0;
-    constexpr uintptr_t CDataStore_GetDataInSitu = 0x0047B6B0; // zero-copy read, returns ptr into buffer
+    inline uintptr_t CDataStore_Constructor      = 0x00401050; // CDataStore::CDataStore()
+    inline uintptr_t CDataStore_Finalize         = 0x00401130; // resets m_read to 0 (write→read mode)
+    inline uintptr_t CDataStore_Reset            = 0x004010E0; // clears buffer, m_read = -1
+    inline uintptr_t CDataStore_Put_uint8        = 0x0047AFE0;
+    inline uintptr_t CDataStore_Put_uint16       = 0x0047B040;
+    inline uintptr_t CDataStore_Put_uint32       = 0x0047B0A0;
+    inline uintptr_t CDataStore_Put_uint64       = 0x0047B100;
+    inline uintptr_t CDataStore_PutArray         = 0x0047B1C0; // raw byte array
+    inline uintptr_t CDataStore_PutString        = 0x0047B300; // null-terminated string
+    inline uintptr_t CDataStore_Get_uint8        = 0x0047B340;
+    inline uintptr_t CDataStore_Get_uint16       = 0x0047B380;
+    inline uintptr_t CDataStore_Get_uint32       = 0x0047B3C0;
+    inline uintptr_t CDataStore_GetDataInSitu     = 0x0047B6B0; // zero-copy read, returns ptr into buffer
 
     // --------------------------------------------------------
     //  Globals
     // --------------------------------------------------------
-    constexpr uintptr_t g_DefaultSeed   = 0x009E8A9C;  // 04 AE 98 CC … (static encryption seed)
-    constexpr uintptr_t g_Drop1024Buf   = 0x00B39160;  // 1024-byte zero buffer used for ARC4 Drop1024
-    constexpr uintptr_t g_CDataStore_vt = 0x009E0E24;  // CDataStore vtable
+    inline uintptr_t g_DefaultSeed       = 0x009E8A9C;  // 04 AE 98 CC … (static encryption seed)
+    inline uintptr_t g_Drop1024Buf       = 0x00B39160;  // 1024-byte zero buffer used for ARC4 Drop1024
+    inline uintptr_t g_CDataStore_vt     = 0x009E0E24;  // CDataStore vtable
 
     // --------------------------------------------------------
     //  TODO — Locate via further RE
     // --------------------------------------------------------
     // NetClient::HandlePacket  = ???   incoming SMSG dispatch table
+
+    // --------------------------------------------------------
+    //  OffsetResolver::ModuleHash() of the build 12340 clients the
+    //  addresses above have been checked on.  PacketGod.sigs is only
+    //  generated on one of these; any other client is refused and
+    //  its hash logged, to be added here once checked by hand.
+    // --------------------------------------------------------
+    inline constexpr std::initializer_list<uint64_t> kReferenceHashes = {};
+
+    inline bool IsReferenceBuild(uint64_t moduleHash)
+    {
+        for (uint64_t h : kReferenceHashes)
+            if (h == moduleHash) return true;
+        return false;
+    }
+
+    // --------------------------------------------------------
+    //  By name, for OffsetResolver; table order is the order above.
+    // --------------------------------------------------------
+    struct Slot
+    {
+        const char* name;
+        uintptr_t*  address;
+    };
+
+    inline const Slot kSlots[] = {
+        { "ARC4_Init",                &ARC4_Init },
+        { "ARC4_Process",             &ARC4_Process },
+        { "SHA1_Prepare",             &SHA1_Prepare },
+        { "SHA1_Process",             &SHA1_Process },
+        { "SHA1_Finish",              &SHA1_Finish },
+        { "WowConn_Send",             &WowConn_Send },
+        { "WowConn_Encrypt",          &WowConn_Encrypt },
+        { "WowConn_SetStatus",        &WowConn_SetStatus },
+        { "WowConn_SetEncKey",        &WowConn_SetEncKey },
+        { "WowConn_SetEncryption",    &WowConn_SetEncryption },
+        { "WowConn_Disconnect",       &WowConn_Disconnect },
+        { "WowConn_HMAC_Prepare",     &WowConn_HMAC_Prepare },
+        { "WowConn_Init",             &WowConn_Init },
+        { "NetClient_AuthChallenge",  &NetClient_AuthChallenge },
+        { "NetClient_SolvePoW",       &NetClient_SolvePoW },
+        { "NetClient_AddEvent",       &NetClient_AddEvent },
+        { "NetClient_Send",           &NetClient_Send },
+        { "CDataStore_Constructor",   &CDataStore_Constructor },
+        { "CDataStore_Finalize",      &CDataStore_Finalize },
+        { "CDataStore_Reset",         &CDataStore_Reset },
+        { "CDataStore_Put_uint8",     &CDataStore_Put_uint8 },
+        { "CDataStore_Put_uint16",    &CDataStore_Put_uint16 },
+        { "CDataStore_Put_uint32",    &CDataStore_Put_uint32 },
+        { "CDataStore_Put_uint64",    &CDataStore_Put_uint64 },
+        { "CDataStore_PutArray",      &CDataStore_PutArray },
+        { "CDataStore_PutString",     &CDataStore_PutString },
+        { "CDataStore_Get_uint8",     &CDataStore_Get_uint8 },
+        { "CDataStore_Get_uint16",    &CDataStore_Get_uint16 },
+        { "CDataStore_Get_uint32",    &CDataStore_Get_uint32 },
+        { "CDataStore_GetDataInSitu", &CDataStore_GetDataInSitu },
+        { "g_DefaultSeed",            &g_DefaultSeed },
+        { "g_Drop1024Buf",            &g_Drop1024Buf },
+        { "g_CDataStore_vt",          &g_CDataStore_vt },
+    };
 }
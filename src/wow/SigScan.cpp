@@ -0,0 +1,325 @@
+#include "SigScan.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#    define SIGSCAN_X86 1
+#    include <immintrin.h>
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#    endif
+#else
+#    define SIGSCAN_X86 0
+#endif
+
+// MSVC emits AVX2 intrinsics without /arch; GCC and Clang need the function attribute.
+#if SIGSCAN_X86 && (defined(__GNUC__) || defined(__clang__))
+#    define SIGSCAN_TARGET(isa) __attribute__((target(isa)))
+#else
+#    define SIGSCAN_TARGET(isa)
+#endif
+
+const char* ScanIsaName(ScanIsa isa)
+{
+    switch (isa)
+    {
+    case ScanIsa::Avx2: return "avx2";
+    case ScanIsa::Sse2: return "sse2";
+    default:            return "scalar";
+    }
+}
+
+// ============================================================
+//  Signature
+// ============================================================
+
+// The most frequent bytes in 32-bit MSVC code, most frequent first:
+// ModRM / SIB forms, push / pop, int3 padding, small displacements.
+static const uint8_t kCommonBytes[] = {
+    0x00, 0xFF, 0x8B, 0x89, 0xCC, 0x24, 0x45, 0xE8, 0x04, 0x08, 0x83, 0x0C, 0x10, 0xC4, 0x01, 0x55,
+    0x8D, 0x85, 0xEC, 0x74, 0x75, 0x50, 0x56, 0x57, 0x51, 0x52, 0x53, 0x5E, 0x5F, 0x5D, 0xC3, 0x0F,
+    0x4D, 0x46, 0x44, 0x14, 0x18, 0x1C, 0x20, 0x6A, 0x68, 0x33, 0x3B, 0xC0, 0xF0, 0xF8, 0xFC, 0x90,
+};
+
+static uint8_t Commonness(uint8_t b)
+{
+    for (size_t i = 0; i < sizeof(kCommonBytes); ++i)
+        if (kCommonBytes[i] == b) return static_cast<uint8_t>(sizeof(kCommonBytes) - i);
+    return 0;
+}
+
+bool Signature::Build(const uint8_t* bytesIn, const uint8_t* maskIn, size_t size, Signature& out)
+{
+    out = Signature{};
+    if (!size) return false;
+
+    out.bytes.resize(size);
+    out.mask.assign(maskIn, maskIn + size);
+    int  bestA = 0, bestB = 0;
+    bool haveA = false, haveB = false;
+    for (size_t i = 0; i < size; ++i)
+    {
+        out.bytes[i] = bytesIn[i] & maskIn[i];
+        if (maskIn[i] != 0xFF) continue;
+        const int c = Commonness(bytesIn[i]);
+        if (!haveA || c < bestA)
+        {
+            if (haveA)   // the old best becomes the second anchor
+            {
+                bestB       = bestA;
+                out.anchorB = out.anchorA;
+                haveB       = true;
+            }
+            bestA       = c;
+            out.anchorA = static_cast<uint32_t>(i);
+            haveA       = true;
+        }
+        else if (!haveB || c < bestB)
+        {
+            bestB       = c;
+            out.anchorB = static_cast<uint32_t>(i);
+            haveB       = true;
+        }
+    }
+    if (!haveB) out.anchorB = out.anchorA;
+    return haveA;
+}
+
+bool Signature::Parse(const char* text, Signature& out)
+{
+    std::vector<uint8_t> bytes, mask;
+    const char* p = text;
+    for (;;)
+    {
+        while (*p == ' ' || *p == '\t') ++p;
+        if (!*p) break;
+
+        if (p[0] == '?')
+        {
+            p += (p[1] == '?') ? 2 : 1;
+            bytes.push_back(0);
+            mask.push_back(0);
+        }
+        else
+        {
+            int v = 0;
+            for (int n = 0; n < 2; ++n, ++p)
+            {
+                const char c = *p;
+                int d;
+                if      (c >= '0' && c <= '9') d = c - '0';
+                else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') d = c - 'A' + 10;
+                else return false;
+                v = v * 16 + d;
+            }
+            bytes.push_back(static_cast<uint8_t>(v));
+            mask.push_back(0xFF);
+        }
+        if (*p && *p != ' ' && *p != '\t') return false;   // "8B0D" or "8BX"
+    }
+    return Build(bytes.data(), mask.data(), bytes.size(), out);
+}
+
+std::string Signature::ToString() const
+{
+    static const char kHex[] = "0123456789ABCDEF";
+    std::string s;
+    s.reserve(bytes.size() * 3);
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        if (i) s += ' ';
+        if (mask[i] != 0xFF)
+            s += "??";
+        else
+        {
+            s += kHex[bytes[i] >> 4];
+            s += kHex[bytes[i] & 15];
+        }
+    }
+    return s;
+}
+
+bool Signature::MatchesAt(const uint8_t* p) const
+{
+    const size_t n = bytes.size();
+    for (size_t i = 0; i < n; ++i)
+        if ((p[i] & mask[i]) != bytes[i]) return false;
+    return true;
+}
+
+// ============================================================
+//  CPU dispatch
+// ============================================================
+
+#if SIGSCAN_X86
+static bool CpuHasAvx2()
+{
+#    if defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+    __cpuid(r, 1);
+    const bool osxsave = (r[2] & (1 << 27)) != 0;
+    const bool avx     = (r[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;   // OS saves the YMM state
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#    else
+    return __builtin_cpu_supports("avx2");
+#    endif
+}
+
+static bool CpuHasSse2()
+{
+#    if defined(_M_X64) || defined(__x86_64__)
+    return true;
+#    elif defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 1);
+    return (r[3] & (1 << 26)) != 0;
+#    else
+    return __builtin_cpu_supports("sse2");
+#    endif
+}
+#endif
+
+ScanIsa SigScan::BestIsa()
+{
+#if SIGSCAN_X86
+    static const ScanIsa s_best = CpuHasAvx2() ? ScanIsa::Avx2 : CpuHasSse2() ? ScanIsa::Sse2 : ScanIsa::Scalar;
+    return s_best;
+#else
+    return ScanIsa::Scalar;
+#endif
+}
+
+// ============================================================
+//  Scans
+//
+//  Each returns the offset it stopped at; the caller finishes the
+//  tail (fewer than one vector of candidates left) with the scalar
+//  loop.  Emit() returns false once enough matches are found.
+// ============================================================
+
+struct MatchSink
+{
+    std::vector<size_t>& out;
+    size_t               found;
+    size_t               max;
+
+    bool Emit(size_t at)
+    {
+        out.push_back(at);
+        return ++found < max;
+    }
+};
+
+static inline unsigned LowestBit(uint32_t m)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return static_cast<unsigned>(i);
+#else
+    return static_cast<unsigned>(__builtin_ctz(m));
+#endif
+}
+
+static size_t ScanScalar(const uint8_t* data, size_t size, size_t from, const Signature& sig, MatchSink& sink,
+                         bool& done)
+{
+    const size_t  n     = sig.Size();
+    const uint8_t first = sig.bytes[sig.anchorA];
+    const size_t  a     = sig.anchorA;
+    for (size_t i = from; i + n <= size; ++i)
+    {
+        if (data[i + a] != first || !sig.MatchesAt(data + i)) continue;
+        if (!sink.Emit(i))
+        {
+            done = true;
+            return i + 1;
+        }
+    }
+    return size;
+}
+
+#if SIGSCAN_X86
+SIGSCAN_TARGET("sse2")
+static size_t ScanSse2(const uint8_t* data, size_t size, const Signature& sig, MatchSink& sink, bool& done)
+{
+    const size_t  n = sig.Size();
+    const size_t  a = sig.anchorA, b = sig.anchorB;
+    const __m128i A = _mm_set1_epi8(static_cast<char>(sig.bytes[a]));
+    const __m128i B = _mm_set1_epi8(static_cast<char>(sig.bytes[b]));
+    size_t i = 0;
+    // Candidates i .. i+15 need their full pattern in range: i + 15 + n <= size.
+    for (; i + 15 + n <= size; i += 16)
+    {
+        const __m128i ea = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + a)), A);
+        const __m128i eb = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + b)), B);
+        uint32_t m = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(ea, eb)));
+        while (m)
+        {
+            const size_t at = i + LowestBit(m);
+            m &= m - 1;
+            if (sig.MatchesAt(data + at) && !sink.Emit(at))
+            {
+                done = true;
+                return at + 1;
+            }
+        }
+    }
+    return i;
+}
+
+SIGSCAN_TARGET("avx2")
+static size_t ScanAvx2(const uint8_t* data, size_t size, const Signature& sig, MatchSink& sink, bool& done)
+{
+    const size_t  n = sig.Size();
+    const size_t  a = sig.anchorA, b = sig.anchorB;
+    const __m256i A = _mm256_set1_epi8(static_cast<char>(sig.bytes[a]));
+    const __m256i B = _mm256_set1_epi8(static_cast<char>(sig.bytes[b]));
+    size_t i = 0;
+    for (; i + 31 + n <= size; i += 32)
+    {
+        const __m256i ea = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + a)), A);
+        const __m256i eb = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + b)), B);
+        uint32_t m = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(ea, eb)));
+        while (m)
+        {
+            const size_t at = i + LowestBit(m);
+            m &= m - 1;
+            if (sig.MatchesAt(data + at) && !sink.Emit(at))
+            {
+                done = true;
+                return at + 1;
+            }
+        }
+    }
+    return i;
+}
+#endif
+
+size_t SigScan::FindAll(const uint8_t* data, size_t size, const Signature& sig, std::vector<size_t>& out,
+                        size_t maxMatches, ScanIsa isa)
+{
+    if (sig.bytes.empty() || size < sig.Size() || !maxMatches) return 0;
+    if (isa > BestIsa()) isa = BestIsa();
+
+    MatchSink sink{ out, 0, maxMatches };
+    bool   done = false;
+    size_t from = 0;
+#if SIGSCAN_X86
+    if (isa == ScanIsa::Avx2)      from = ScanAvx2(data, size, sig, sink, done);
+    else if (isa == ScanIsa::Sse2) from = ScanSse2(data, size, sig, sink, done);
+#endif
+    if (!done) ScanScalar(data, size, from, sig, sink, done);
+    return sink.found;
+}
+
+size_t SigScan::Find(const uint8_t* data, size_t size, const Signature& sig, ScanIsa isa)
+{
+    std::vector<size_t> hit;
+    return FindAll(data, size, sig, hit, 1, isa) ? hit[0] : npos;
+}
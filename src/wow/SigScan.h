@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ============================================================
+//  SigScan — masked byte-signature search over code
+//
+//  A signature is a byte pattern with wildcards, written the way
+//  disassemblers print it: "55 8B EC 83 E4 ?? 8B 0D ?? ?? ?? ??".
+//  Wildcards cover what moves between builds: call displacements,
+//  absolute addresses of globals, stack offsets.
+//
+//  The vector scans compare two anchor bytes of the pattern (the
+//  two rarest in x86 code) against 16 / 32 positions at once and
+//  only verify the full masked pattern where both agree, so the
+//  cost is about one load and compare per byte per anchor.  The
+//  widest ISA the CPU supports is picked at run time; the scalar
+//  path is the reference and the fallback on non-x86 hosts.
+// ============================================================
+
+enum class ScanIsa : uint8_t { Scalar, Sse2, Avx2 };
+
+const char* ScanIsaName(ScanIsa isa);
+
+struct Signature
+{
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> mask;   // 0xFF = must match, 0x00 = wildcard
+    uint32_t anchorA = 0;        // fixed positions compared by the vector scans
+    uint32_t anchorB = 0;
+
+    size_t Size() const { return bytes.size(); }
+
+    // "8B 0D ?? ?? ?? ??" ("?" alone is a wildcard too).  False for an
+    // empty pattern, one without a fixed byte, or a malformed token.
+    static bool Parse(const char* text, Signature& out);
+    // From raw bytes + mask; picks the anchors.  Same failures as Parse.
+    static bool Build(const uint8_t* bytes, const uint8_t* mask, size_t size, Signature& out);
+
+    std::string ToString() const;
+
+    bool MatchesAt(const uint8_t* p) const;   // p has Size() readable bytes
+};
+
+namespace SigScan
+{
+    constexpr size_t npos = ~size_t(0);
+
+    ScanIsa BestIsa();   // cached CPU check
+
+    // Match offsets in [0, size - sig.Size()], ascending, at most
+    // `maxMatches` of them appended to `out`.  Returns the count found.
+    size_t FindAll(const uint8_t* data, size_t size, const Signature& sig, std::vector<size_t>& out,
+                   size_t maxMatches = SIZE_MAX, ScanIsa isa = BestIsa());
+
+    size_t Find(const uint8_t* data, size_t size, const Signature& sig, ScanIsa isa = BestIsa());   // first, or npos
+}
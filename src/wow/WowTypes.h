@@ -1,11 +1,24 @@
 #pragma once
 #include <cstdint>
 #include <vector>
+#include <memory>
 
 // ============================================================
 //  PacketGod — WoW 3.3.5a Build 12340 — Reverse-Engineered Types
 // ============================================================
 
+// Calling-convention keywords only exist on x86 MSVC/MinGW.  Blank them
+// elsewhere so the portable core (capture, replay, analysis) builds on
+// Linux with the same signatures the hooks use in-game.
+#if !defined(_MSC_VER) && !defined(__MINGW32__)
+#ifndef __thiscall
+#define __thiscall
+#endif
+#ifndef __cdecl
+#define __cdecl
+#endif
+#endif
+
 // ------------------------------------------------------------
 //  ARC4 stream cipher state  (256-byte S-box + i/j indices)
 // ------------------------------------------------------------
@@ -96,6 +109,14 @@ struct NetClient
     /* +0x2E3C */ WowConnection* m_clientConnection;   // world socket
 };
 
+// Which NetClient slot a connection occupies.
+enum class ConnectionRole : uint8_t
+{
+    Unknown = 0,
+    Realm   = 1,   // NetClient::m_realmConnection
+    World   = 2,   // NetClient::m_clientConnection
+};
+
 // ------------------------------------------------------------
 //  Captured packet record (our own, not game-engine)
 // ------------------------------------------------------------
@@ -107,9 +128,20 @@ enum class PacketDirection : uint8_t
 
 struct CapturedPacket
 {
-    PacketDirection direction;
-    uint16_t        opcode;
-    uint32_t        size;          // payload size (bytes after opcode)
-    uint64_t        timestamp_us;  // microseconds since DLL load
-    std::vector<uint8_t> payload;  // raw payload bytes (opcode stripped)
+    uint64_t        seq = 0;       // capture order, never reused (survives Clear)
+    uint8_t         connection = 0;   // ConnectionTracker id; 0 = untracked
+    PacketDirection direction = PacketDirection::CMSG;
+    uint16_t        opcode = 0;
+    uint32_t        size = 0;      // payload size on the wire (bytes after opcode)
+    uint64_t        timestamp_us = 0;  // microseconds since DLL load
+    std::vector<uint8_t> payload;  // raw payload bytes (opcode stripped); shorter than
+                                   // `size` under a metadata-only / snaplen capture mode
+
+    // Inflated form of a compressed opcode, attached later by PacketInflater.
+    // Shared with the inflate cache; null until (and unless) inflated.
+    std::shared_ptr<const std::vector<uint8_t>> inflated;
+
+    // What analysis should look at: inflated bytes when present.
+    const std::vector<uint8_t>& Content() const { return inflated ? *inflated : payload; }
+    bool Truncated() const { return payload.size() < size; }
 };
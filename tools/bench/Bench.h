@@ -0,0 +1,151 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include "wow/WowTypes.h"
+
+// ============================================================
+//  PacketGodBench — host-side benchmarks for the portable core
+//
+//  Each suite runs against stand-in game functions (fake
+//  WowConnection::Send etc.) so it needs no client and runs on
+//  Linux.  Usage:  PacketGodBench <suite> [options]
+// ============================================================
+
+namespace Bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    inline double SecondsSince(Clock::time_point t0)
+    {
+        return std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+
+    // ------------------------------------------------------------
+    //  Bytes — little-endian, as the client writes them
+    // ------------------------------------------------------------
+
+    inline void PutU16(std::vector<uint8_t>& b, uint16_t v) { for (int i = 0; i < 2; ++i) b.push_back(uint8_t(v >> (8 * i))); }
+    inline void PutU32(std::vector<uint8_t>& b, uint32_t v) { for (int i = 0; i < 4; ++i) b.push_back(uint8_t(v >> (8 * i))); }
+    inline void PutU64(std::vector<uint8_t>& b, uint64_t v) { for (int i = 0; i < 8; ++i) b.push_back(uint8_t(v >> (8 * i))); }
+
+    inline void PutPackedGuid(std::vector<uint8_t>& b, uint64_t guid)
+    {
+        const size_t at = b.size();
+        b.push_back(0);
+        for (int i = 0; i < 8; ++i)
+            if (uint8_t byte = uint8_t(guid >> (8 * i)))
+            {
+                b[at] |= uint8_t(1u << i);
+                b.push_back(byte);
+            }
+    }
+
+    inline void     StoreU32(uint8_t* p, uint32_t v) { memcpy(p, &v, 4); }
+    inline uint32_t GetU32(const uint8_t* p)         { uint32_t v; memcpy(&v, p, 4); return v; }
+
+    // `data` as a zlib stream of stored blocks, so no deflate is needed.
+    // `corrupt`: the last block uses the reserved type, which inflate rejects.
+    inline void PutZlibStored(std::vector<uint8_t>& b, const uint8_t* data, size_t size, bool corrupt = false)
+    {
+        b.push_back(0x78);
+        b.push_back(0x01);
+        size_t at = 0;
+        do
+        {
+            const uint16_t n    = static_cast<uint16_t>(size - at < 0xFFFF ? size - at : 0xFFFF);
+            const bool     last = at + n == size;
+            b.push_back(last ? (corrupt ? 0x07 : 0x01) : 0x00);   // BFINAL, BTYPE 11 (reserved) / 00 (stored)
+            PutU16(b, n);
+            PutU16(b, static_cast<uint16_t>(~n));
+            b.insert(b.end(), data + at, data + at + n);
+            at += n;
+        } while (at < size);
+
+        uint32_t s1 = 1, s2 = 0;   // adler32, big-endian
+        for (size_t i = 0; i < size; ++i) { s1 = (s1 + data[i]) % 65521; s2 = (s2 + s1) % 65521; }
+        const uint32_t adler = (s2 << 16) | s1;
+        for (int i = 3; i >= 0; --i) b.push_back(static_cast<uint8_t>(adler >> (8 * i)));
+    }
+
+    // ------------------------------------------------------------
+    //  Synthetic captures
+    // ------------------------------------------------------------
+
+    // 24 random bits per call; the same LCG everywhere so seeds mean the same thing.
+    inline uint32_t Lcg(uint32_t& s) { s = s * 1664525u + 1013904223u; return s >> 8; }
+
+    struct CaptureShape
+    {
+        uint32_t        seed        = 0x9E3779B9u;
+        uint32_t        cmsgOf16    = 3;         // CMSG share in 16ths (16: all CMSG)
+        const uint16_t* opcodes     = nullptr;   // uniform over this set, or else ...
+        uint32_t        opcodeCount = 0;
+        uint32_t        tailOpcodes = 1200;      // ... 3/4 among the first 40, 1/4 below this
+        uint64_t        firstSeq    = 0;         // 0: seq left for PushBatch to assign
+        uint64_t        startUs     = 0;
+        uint32_t        gapUs       = 250;       // fixed spacing; 0: 0..39 us bursts, 2..4 ms idle every 32
+        uint32_t        minPayload  = 8;
+        uint32_t        maxPayload  = 127;
+        uint32_t        emptyOf8    = 0;         // empty payloads, in 8ths
+        bool            repeats     = false;     // a quarter of payloads constant per opcode (pings, time syncs)
+        uint32_t        snapEvery   = 0;         // every Nth packet stored truncated ...
+        uint32_t        snapBytes   = 100;       // ... this many bytes short of its wire size
+    };
+
+    // A world session: two connections (every 16th packet on 1, the
+    // rest on 2), the direction / opcode / payload mix of `shape`.
+    inline std::vector<CapturedPacket> MakeCapture(uint32_t count, const CaptureShape& shape)
+    {
+        std::vector<CapturedPacket> out(count);
+        uint32_t rng = shape.seed;
+        uint64_t ts  = shape.startUs;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            CapturedPacket& p = out[i];
+            if (shape.firstSeq) p.seq = shape.firstSeq + i;
+            if (i) ts += shape.gapUs ? shape.gapUs : (i % 32 == 31) ? 2000 + Lcg(rng) % 2000 : Lcg(rng) % 40;
+            p.timestamp_us = ts;
+            p.connection   = (i % 16) ? 2 : 1;
+            p.direction    = Lcg(rng) % 16 < shape.cmsgOf16 ? PacketDirection::CMSG : PacketDirection::SMSG;
+            if (shape.opcodeCount)
+                p.opcode = shape.opcodes[Lcg(rng) % shape.opcodeCount];
+            else
+            {
+                const uint32_t r = Lcg(rng);
+                p.opcode = static_cast<uint16_t>((r >> 2) % ((r & 3) ? 40 : shape.tailOpcodes));
+            }
+
+            if (shape.emptyOf8 && Lcg(rng) % 8 < shape.emptyOf8)
+                p.payload.clear();
+            else if (shape.repeats && Lcg(rng) % 4 == 0)
+                p.payload.assign(shape.minPayload + p.opcode % 24, static_cast<uint8_t>(p.opcode));
+            else
+            {
+                p.payload.resize(shape.minPayload + Lcg(rng) % (shape.maxPayload - shape.minPayload + 1));
+                for (uint8_t& b : p.payload) b = static_cast<uint8_t>(Lcg(rng));
+            }
+            const bool snapped = shape.snapEvery && i % shape.snapEvery == shape.snapEvery - 1;
+            p.size = static_cast<uint32_t>(p.payload.size()) + (snapped ? shape.snapBytes : 0);
+        }
+        return out;
+    }
+
+    // Suites — return a process exit code (0 = pass).
+    int RunFuzz(int argc, char** argv);
+    int RunRewrite(int argc, char** argv);
+    int RunColumns(int argc, char** argv);
+    int RunMovement(int argc, char** argv);
+    int RunOverhead(int argc, char** argv);
+    int RunReplay(int argc, char** argv);
+    int RunExport(int argc, char** argv);
+    int RunLatency(int argc, char** argv);
+    int RunTimeline(int argc, char** argv);
+    int RunSigScan(int argc, char** argv);
+    int RunWorld(int argc, char** argv);
+    int RunShm(int argc, char** argv);
+    int RunControl(int argc, char** argv);
+    int RunStream(int argc, char** argv);
+    int RunInflate(int argc, char** argv);
+}
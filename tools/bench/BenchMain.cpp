@@ -0,0 +1,66 @@
+#include "Bench.h"
+#include <cstdio>
+#include <cstring>
+
+// ============================================================
+//  Suite dispatch
+// ============================================================
+
+struct Suite
+{
+    const char* name;
+    int       (*run)(int, char**);
+    const char* help;
+};
+
+static const Suite kSuites[] = {
+    { "fuzz", &Bench::RunFuzz, "mutation throughput + fuzzer send loop against a stand-in sink" },
+    { "rewrite", &Bench::RunRewrite, "CMSG rewrite rules: semantics + ns/packet per rule shape" },
+    { "columns", &Bench::RunColumns, "column snapshot + scans vs materialized packets" },
+    { "movement", &Bench::RunMovement, "MSG_MOVE_* delta codec: round trips + ratio/speed vs zlib" },
+    { "overhead", &Bench::RunOverhead, "hook-side capture cost per stage vs budgets (JSON output)" },
+    { "replay", &Bench::RunReplay, "replay against a recording Send: bytes, order, timing error, cancel" },
+    { "export", &Bench::RunExport, "CSV / JSON Lines / columnar export: MB/s per thread count + round trips" },
+    { "latency", &Bench::RunLatency, "request/response pairing and percentiles against known round trips" },
+    { "timeline", &Bench::RunTimeline, "timeline pyramid: push cost, bucket sums, 1 min vs 6 h query cost" },
+    { "sigscan", &Bench::RunSigScan, "signature scan GB/s per ISA, parallel offset resolve, generate + cache" },
+    { "world", &Bench::RunWorld, "world tracker decode order around inflate: held, attached, timeout, poll cost" },
+    { "shm", &Bench::RunShm, "forked ring writer + readers: seq continuity, overrun / drop accounting, stale writer" },
+    { "control", &Bench::RunControl, "control endpoint over loopback: framing, main-thread sends, busy, client limits" },
+    { "stream", &Bench::RunStream, "SMSG reassembly of split, coalesced and mid-payload streams against a client model" },
+    { "inflate", &Bench::RunInflate, "zlib bodies: round trips, wrong raw sizes, truncated streams, job queue cap" },
+};
+
+static void Usage()
+{
+    printf("usage: PacketGodBench <suite|all> [options]\n\nsuites:\n");
+    for (const auto& s : kSuites)
+        printf("  %-10s %s\n", s.name, s.help);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        Usage();
+        return 2;
+    }
+
+    const bool all = strcmp(argv[1], "all") == 0;
+    int rc = 0;
+    bool found = false;
+    for (const auto& s : kSuites)
+    {
+        if (!all && strcmp(argv[1], s.name) != 0) continue;
+        found = true;
+        printf("== %s ==\n", s.name);
+        if (int r = s.run(argc - 2, argv + 2)) rc = r;
+    }
+
+    if (!found)
+    {
+        Usage();
+        return 2;
+    }
+    return rc;
+}
@@ -0,0 +1,121 @@
+#include "Bench.h"
+#include "packet/PacketCapture.h"
+#include "packet/PacketColumns.h"
+#include "packet/OpcodeFilter.h"
+#include "packet/SharedPacket.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// ============================================================
+//  History shaped like a world session: two connections, mostly
+//  SMSG, a skewed opcode mix and payloads of a few dozen bytes,
+//  a quarter of them repeats (pings, time syncs, static SMSGs).
+// ============================================================
+
+static void FillCapture(uint32_t packets)
+{
+    PacketCapture::Clear();
+    Bench::CaptureShape shape;
+    shape.repeats = true;
+    std::vector<CapturedPacket> all = Bench::MakeCapture(packets, shape);
+    std::vector<CapturedPacket> batch;
+    for (CapturedPacket& p : all)
+    {
+        batch.push_back(std::move(p));
+        if (batch.size() == 256) PacketCapture::PushBatch(batch);
+    }
+    PacketCapture::PushBatch(batch);
+}
+
+// The same query both ways: SMSG of a 64-opcode set in the newest
+// half of the history, then per-opcode counts of the survivors.
+struct Result { size_t rows; size_t opcodes; };
+
+static Result ScanPackets(const std::vector<CapturedPacket>& pkts, const OpcodeFilter& f, uint64_t fromUs)
+{
+    static std::vector<uint32_t> counts(2u << 16);
+    size_t rows = 0, opcodes = 0;
+    for (const CapturedPacket& p : pkts)
+    {
+        if (p.direction != PacketDirection::SMSG || p.timestamp_us < fromUs || !f.Test(p.direction, p.opcode)) continue;
+        ++rows;
+        if (counts[(1u << 16) | p.opcode]++ == 0) ++opcodes;
+    }
+    std::fill(counts.begin(), counts.end(), 0);
+    return { rows, opcodes };
+}
+
+static Result ScanColumns(const PacketColumns& cols, const OpcodeFilter& f, uint64_t fromUs)
+{
+    static std::vector<uint32_t>    rows;
+    static std::vector<OpcodeCount> counts;
+    ColumnQuery q;
+    q.cmsg    = false;
+    q.fromUs  = fromUs;
+    q.opcodes = &f;
+    ColumnScan::Select(cols, q, rows);
+    ColumnScan::CountByOpcode(cols, &rows, counts);
+    return { rows.size(), counts.size() };
+}
+
+// ============================================================
+//  Suite
+// ============================================================
+
+int Bench::RunColumns(int argc, char** argv)
+{
+    uint32_t iterations = 2000;
+    for (int i = 0; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--iterations")) iterations = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+
+    FillCapture(static_cast<uint32_t>(PacketCapture::kMaxHistory * 4));
+
+    OpcodeFilter f;
+    f.Fill(false);
+    for (uint16_t op = 0; op < 64; ++op) f.Set(PacketDirection::SMSG, static_cast<uint16_t>(op * 3), true);
+
+    // Snapshot cost — what the UI pays every frame.
+    std::vector<CapturedPacket> pkts;
+    PacketColumns               cols;
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) pkts = PacketCapture::Snapshot();
+    const double snapPackets = SecondsSince(t0) * 1e6 / iterations;
+    t0 = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) PacketCapture::SnapshotColumns(cols);
+    const double snapColumns = SecondsSince(t0) * 1e6 / iterations;
+
+    const uint64_t fromUs = cols.Timestamp()[cols.Rows() / 2];
+    Result a{}, b{};
+    t0 = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) a = ScanPackets(pkts, f, fromUs);
+    const double scanPackets = SecondsSince(t0) * 1e6 / iterations;
+    t0 = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) b = ScanColumns(cols, f, fromUs);
+    const double scanColumns = SecondsSince(t0) * 1e6 / iterations;
+
+    const PoolStats pool = PacketCapture::PayloadStats();
+    printf("history            : %zu packets, %zu payload KiB\n", cols.Rows(), cols.PayloadBytes() >> 10);
+    printf("dedup              : %.1f%% hits, %llu KiB referenced, %llu KiB stored\n",
+           pool.HitRate() * 100.0, static_cast<unsigned long long>(pool.refBytes >> 10),
+           static_cast<unsigned long long>(pool.uniqueBytes >> 10));
+    printf("snapshot           : %8.1f us packets   %8.1f us columns\n", snapPackets, snapColumns);
+    printf("filter + counts    : %8.1f us packets   %8.1f us columns   (%zu rows, %zu opcodes)\n",
+           scanPackets, scanColumns, b.rows, b.opcodes);
+
+    // Another snapshot and every row staged as a SharedPacket add views, not payload bytes.
+    const uint64_t liveBefore = SharedBytes::LiveBytes();
+    PacketColumns             again;
+    std::vector<SharedPacket> staged;
+    PacketCapture::SnapshotColumns(again);
+    again.ToShared(0, staged);
+    const bool shared = SharedBytes::LiveBytes() == liveBefore;
+    printf("shared payloads    : %llu KiB live for store + 2 snapshots + %zu staged  %s\n",
+           static_cast<unsigned long long>(SharedBytes::LiveBytes() >> 10), staged.size(), shared ? "ok" : "FAIL");
+
+    PacketCapture::Clear();
+    return (a.rows == b.rows && a.opcodes == b.opcodes && pkts.size() == cols.Rows() && shared) ? 0 : 1;
+}
@@ -0,0 +1,294 @@
+#include "Bench.h"
+#include "ipc/ControlClient.h"
+#include "ipc/ControlServer.h"
+#include "packet/PacketCapture.h"
+#include "packet/PacketReplay.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// ============================================================
+//  Control endpoint — request / response framing over loopback
+//
+//  A ControlServer on this process's default endpoint, with a
+//  counting stand-in for WowConnection::Send:
+//    pipelined  Hello + many Stats + bad requests in one write,
+//               answered in order with matching ids and statuses
+//    split      a header cut in two, then several frames
+//               in one write, on a raw connection
+//    main       Inject / Replay answers wait for RunQueuedSends,
+//               whose thread (this one) does the sending
+//    busy       a full send queue answers Busy at once
+//    oversize   a frame above kMaxBody closes the connection
+//    unread     a client that never reads its responses is
+//               disconnected at kMaxClientPending
+//
+//  Options:  --pipelined N   Stats requests in the first write (default 2000)
+// ============================================================
+
+using namespace ControlProtocol;
+
+static std::atomic<uint64_t>  s_sends{ 0 };
+static std::thread::id        s_sendThread;
+
+struct ControlSend
+{
+    static int __thiscall Send(WowConnection*, CDataStore*, int)
+    {
+        s_sends.fetch_add(1, std::memory_order_relaxed);
+        s_sendThread = std::this_thread::get_id();
+        return 1;
+    }
+};
+
+static bool Check(bool ok, const char* what)
+{
+    printf("%-18s: %s\n", what, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Next whole frame off a raw connection; false when it closed.
+static bool ReadRaw(IpcClient& c, std::vector<uint8_t>& buf, FrameHeader& h, std::vector<uint8_t>& body)
+{
+    for (;;)
+    {
+        if (buf.size() >= kHeaderSize)
+        {
+            memcpy(&h, buf.data(), kHeaderSize);
+            if (buf.size() - kHeaderSize >= h.length)
+            {
+                body.assign(buf.begin() + kHeaderSize, buf.begin() + kHeaderSize + h.length);
+                buf.erase(buf.begin(), buf.begin() + kHeaderSize + h.length);
+                return true;
+            }
+        }
+        uint8_t chunk[4096];
+        const size_t n = c.Read(chunk, sizeof(chunk));
+        if (!n) return false;
+        buf.insert(buf.end(), chunk, chunk + n);
+    }
+}
+
+static void InjectOne(ControlClient& client, uint16_t records)
+{
+    static const uint8_t payload[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    client.Body().U16(records);
+    for (uint16_t i = 0; i < records; ++i)
+    {
+        client.Body().U8(0);
+        client.Body().U8(0);
+        client.Body().U16(0x01DC);
+        client.Body().U32(sizeof(payload));
+        client.Body().Bytes(payload, sizeof(payload));
+    }
+}
+
+// [2] sent [2] failed of a Replay / Inject response.
+static bool Counts(const std::vector<uint8_t>& body, uint16_t sent, uint16_t failed)
+{
+    Reader r(body.data(), body.size());
+    const uint16_t s = r.U16();
+    const uint16_t f = r.U16();
+    return r.Ok() && s == sent && f == failed;
+}
+
+static bool RunPipelined(ControlClient& client, uint32_t count)
+{
+    client.Begin(Hello);
+    client.End();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        client.Begin(Stats);
+        client.End();
+    }
+    const uint32_t unknownId = client.Begin(0x0077);
+    client.End();
+    const uint32_t badId = client.Begin(Replay);
+    client.Body().U16(2);   // promises two seqs, carries one
+    client.Body().U64(1);
+    client.End();
+    if (!client.Flush()) return false;
+
+    FrameHeader h;
+    std::vector<uint8_t> body;
+    bool ok = client.ReadFrame(h, body) && h.type == (Hello | kResponse) && h.status == Ok && body.size() == 14;
+    uint32_t inOrder = 0;
+    for (uint32_t i = 0; i < count && client.ReadFrame(h, body); ++i)
+        if (h.type == (Stats | kResponse) && h.id == i + 2 && h.status == Ok && body.size() == 40) ++inOrder;
+    ok &= inOrder == count;
+    ok &= client.ReadFrame(h, body) && h.id == unknownId && h.status == UnknownType;
+    ok &= client.ReadFrame(h, body) && h.id == badId && h.status == BadRequest;
+    return Check(ok, "pipelined");
+}
+
+static bool RunSplit(const char* endpoint)
+{
+    IpcClient raw;
+    if (!raw.Connect(endpoint)) return Check(false, "split");
+
+    std::vector<uint8_t> frames;
+    Writer w(frames);
+    for (uint32_t id = 1; id <= 3; ++id)
+    {
+        w.Begin(Stats, id);
+        w.End();
+    }
+    w.Begin(Hello, 4);
+    w.End();
+
+    // 5 + 7 bytes (header cut in two), then the rest: frames 2..4 in one write.
+    bool ok = raw.Write(frames.data(), 5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ok &= raw.Write(frames.data() + 5, 7);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ok &= raw.Write(frames.data() + 12, frames.size() - 12);
+
+    std::vector<uint8_t> buf, body;
+    FrameHeader h;
+    for (uint32_t id = 1; id <= 4 && ok; ++id)
+        ok = ReadRaw(raw, buf, h, body) && h.id == id && h.status == Ok &&
+             h.type == ((id == 4 ? Hello : Stats) | kResponse);
+    return Check(ok, "split");
+}
+
+static bool RunMainThread(ControlClient& client, uint64_t storedSeq)
+{
+    const uint64_t before = s_sends.load();
+    const uint32_t injectId = client.Begin(Inject);
+    InjectOne(client, 3);
+    client.End();
+    const uint32_t replayId = client.Begin(Replay);
+    client.Body().U16(2);
+    client.Body().U64(storedSeq);
+    client.Body().U64(storedSeq + 1000000);   // not stored
+    client.End();
+    const uint32_t statsId = client.Begin(Stats);
+    client.End();
+    if (!client.Flush()) return false;
+
+    // Only Stats can be answered before the main thread runs the sends.
+    FrameHeader h;
+    std::vector<uint8_t> body;
+    bool ok = client.ReadFrame(h, body) && h.id == statsId;
+    ok &= s_sends.load() == before;
+
+    ControlServer::RunQueuedSends();
+    bool gotInject = false, gotReplay = false;
+    for (int i = 0; i < 2 && client.ReadFrame(h, body); ++i)
+    {
+        if (h.id == injectId) gotInject = h.status == Ok && Counts(body, 3, 0);
+        if (h.id == replayId) gotReplay = h.status == Ok && Counts(body, 1, 1);
+    }
+    ok &= gotInject && gotReplay && s_sends.load() == before + 4 && s_sendThread == std::this_thread::get_id();
+    return Check(ok, "main thread");
+}
+
+static bool RunBusy(ControlClient& client)
+{
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; i <= ControlServer::kMaxQueuedSends; ++i)
+    {
+        ids.push_back(client.Begin(Inject));
+        InjectOne(client, 1);
+        client.End();
+    }
+    const uint32_t statsId = client.Begin(Stats);
+    client.End();
+    if (!client.Flush()) return false;
+
+    FrameHeader h;
+    std::vector<uint8_t> body;
+    bool ok = client.ReadFrame(h, body) && h.id == ids.back() && h.status == Busy;
+    ok &= client.ReadFrame(h, body) && h.id == statsId;
+
+    ControlServer::RunQueuedSends();
+    uint32_t answered = 0;
+    for (uint32_t i = 0; i < ControlServer::kMaxQueuedSends && client.ReadFrame(h, body); ++i)
+        if (h.id == ids[i] && h.status == Ok && Counts(body, 1, 0)) ++answered;
+    ok &= answered == ControlServer::kMaxQueuedSends && ControlServer::Stats().busy == 1;
+    return Check(ok, "busy");
+}
+
+static bool RunOversize(const char* endpoint)
+{
+    IpcClient raw;
+    if (!raw.Connect(endpoint)) return Check(false, "oversize");
+    const FrameHeader h = { kMaxBody + 1, Stats, 0, 1 };
+    bool ok = raw.Write(&h, sizeof(h));
+    uint8_t b;
+    ok &= raw.Read(&b, 1) == 0;   // closed without an answer
+    return Check(ok, "oversize");
+}
+
+static bool RunUnread(const char* endpoint)
+{
+    IpcClient raw;
+    if (!raw.Connect(endpoint)) return Check(false, "unread");
+
+    std::vector<uint8_t> chunk;
+    Writer w(chunk);
+    for (uint32_t i = 0; i < 4096; ++i)
+    {
+        w.Begin(Stats, i);
+        w.End();
+    }
+    // Each 12-byte request earns a 52-byte answer that is never read.
+    const uint64_t limit = 4ull * ControlServer::kMaxClientPending;
+    uint64_t written = 0;
+    while (written < limit && ControlServer::Stats().kicked == 0 && raw.Write(chunk.data(), chunk.size()))
+        written += chunk.size();
+    const auto t0 = Bench::Clock::now();
+    while (ControlServer::Stats().kicked == 0 && Bench::SecondsSince(t0) < 2.0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    printf("                    dropped after %.1f MiB of requests\n", written / 1048576.0);
+    return Check(ControlServer::Stats().kicked == 1, "unread");
+}
+
+int Bench::RunControl(int argc, char** argv)
+{
+    uint32_t pipelined = 2000;
+    for (int i = 0; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--pipelined")) pipelined = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+
+    static uint8_t fakeConn[64];
+    PacketReplay::SetSendFn(&ControlSend::Send, reinterpret_cast<WowConnection*>(fakeConn));
+    PacketCapture::Clear();
+    std::vector<CapturedPacket> batch(1);
+    batch[0].direction = PacketDirection::CMSG;
+    batch[0].opcode    = 0x01DC;
+    batch[0].payload.assign(8, 0x5A);
+    batch[0].size      = 8;
+    PacketCapture::PushBatch(batch);
+    const uint64_t storedSeq = PacketCapture::LastSeq();
+
+    if (!ControlServer::Start())
+    {
+        PacketReplay::SetSendFn(nullptr, nullptr);
+        printf("control           : FAIL (cannot listen)\n");
+        return 1;
+    }
+    const char* endpoint = ControlServer::Endpoint();
+    printf("endpoint %s\n", endpoint);
+
+    bool ok = true;
+    {
+        ControlClient client;
+        ok &= Check(client.Connect(endpoint), "connect");
+        ok &= RunPipelined(client, pipelined);
+        ok &= RunSplit(endpoint);
+        ok &= RunMainThread(client, storedSeq);
+        ok &= RunBusy(client);
+        ok &= RunOversize(endpoint);
+        ok &= RunUnread(endpoint);
+        client.Close();
+    }
+
+    ControlServer::Stop();
+    PacketReplay::SetSendFn(nullptr, nullptr);
+    PacketCapture::Clear();
+    printf("control           : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
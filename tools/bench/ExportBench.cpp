@@ -0,0 +1,312 @@
+#include "Bench.h"
+#include "packet/CaptureExport.h"
+#include "Opcodes.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+//  Export — throughput per format / thread count, and every
+//  exported file parsed back and compared with the capture
+//
+//  Options:  --packets N   capture size (default 1000000)
+//            --threads N   parallel runs (default: all cores)
+//            --dir PATH    where the files go (default .; removed after)
+// ============================================================
+
+static std::vector<CapturedPacket> SyntheticCapture(uint32_t count)
+{
+    Bench::CaptureShape shape;
+    shape.seed        = 0x2545F491u;
+    shape.tailOpcodes = 1400;            // some UNKNOWN
+    shape.firstSeq    = 1000;
+    shape.startUs     = 5'000'000'000ull;
+    shape.emptyOf8    = 1;
+    shape.snapEvery   = 50;              // some truncated
+    shape.snapBytes   = 300;
+    return Bench::MakeCapture(count, shape);
+}
+
+// ============================================================
+//  Parsing back
+// ============================================================
+
+static bool ReadFile(const char* path, std::string& out)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[1 << 16];
+    out.clear();
+    while (size_t n = fread(buf, 1, sizeof(buf), f)) out.append(buf, n);
+    fclose(f);
+    return true;
+}
+
+static int HexVal(char c) { return c <= '9' ? c - '0' : c - 'a' + 10; }
+
+static bool DecodeHex(const char* s, size_t n, std::vector<uint8_t>& out)
+{
+    if (n % 2) return false;
+    out.resize(n / 2);
+    for (size_t i = 0; i < n / 2; ++i)
+        out[i] = static_cast<uint8_t>((HexVal(s[2 * i]) << 4) | HexVal(s[2 * i + 1]));
+    return true;
+}
+
+static bool DecodeBase64(const char* s, size_t n, std::vector<uint8_t>& out)
+{
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    if (n % 4) return false;
+    out.clear();
+    for (size_t i = 0; i < n; i += 4)
+    {
+        uint32_t v = 0;
+        int      pad = 0;
+        for (int k = 0; k < 4; ++k)
+        {
+            const char c = s[i + k];
+            const char* at = strchr(kAlphabet, c);
+            if (c == '=') { ++pad; v <<= 6; }
+            else if (at && c) v = (v << 6) | static_cast<uint32_t>(at - kAlphabet);
+            else return false;
+        }
+        out.push_back(static_cast<uint8_t>(v >> 16));
+        if (pad < 2) out.push_back(static_cast<uint8_t>(v >> 8));
+        if (pad < 1) out.push_back(static_cast<uint8_t>(v));
+    }
+    return true;
+}
+
+// One parsed line, fields in the documented order.
+struct Line
+{
+    uint64_t    seq = 0, ts = 0, conn = 0, opcode = 0, size = 0, stored = 0;
+    std::string dir, name;
+    std::vector<uint8_t> payload;
+    bool        hasPayload = false;
+};
+
+static bool Same(const Line& l, const CapturedPacket& p, PayloadEncoding enc)
+{
+    return l.seq == p.seq && l.ts == p.timestamp_us && l.conn == p.connection &&
+           l.dir == (p.direction == PacketDirection::SMSG ? "SMSG" : "CMSG") && l.opcode == p.opcode &&
+           l.name == OpcodeToString(p.opcode) && l.size == p.size && l.stored == p.payload.size() &&
+           l.hasPayload == (enc != PayloadEncoding::None) && (!l.hasPayload || l.payload == p.payload);
+}
+
+static bool DecodePayload(PayloadEncoding enc, const char* s, size_t n, std::vector<uint8_t>& out)
+{
+    return enc == PayloadEncoding::Hex ? DecodeHex(s, n, out) : DecodeBase64(s, n, out);
+}
+
+static bool ParseCsv(const char* s, const char* end, PayloadEncoding enc, Line& l)
+{
+    const char* field[9];
+    size_t      len[9];
+    int         n = 0;
+    const char* f = s;
+    for (const char* p = s; ; ++p)
+    {
+        if (p == end || *p == ',')
+        {
+            if (n == 9) return false;
+            field[n] = f; len[n] = static_cast<size_t>(p - f); ++n;
+            if (p == end) break;
+            f = p + 1;
+        }
+    }
+    if (n != (enc == PayloadEncoding::None ? 8 : 9)) return false;
+    l.seq    = strtoull(field[0], nullptr, 10);
+    l.ts     = strtoull(field[1], nullptr, 10);
+    l.conn   = strtoull(field[2], nullptr, 10);
+    l.dir.assign(field[3], len[3]);
+    l.opcode = strtoull(field[4], nullptr, 10);
+    l.name.assign(field[5], len[5]);
+    l.size   = strtoull(field[6], nullptr, 10);
+    l.stored = strtoull(field[7], nullptr, 10);
+    l.hasPayload = n == 9;
+    return !l.hasPayload || DecodePayload(enc, field[8], len[8], l.payload);
+}
+
+// Value after "key": within [s, end) — a number, or a string without its quotes.
+static bool JsonField(const char* s, const char* end, const char* key, const char*& v, size_t& n)
+{
+    char pat[32];
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    const size_t plen = strlen(pat);
+    for (const char* p = s; p + plen <= end; ++p)
+    {
+        if (memcmp(p, pat, plen) != 0) continue;
+        v = p + plen;
+        if (*v == '"')
+        {
+            ++v;
+            const char* q = static_cast<const char*>(memchr(v, '"', static_cast<size_t>(end - v)));
+            if (!q) return false;
+            n = static_cast<size_t>(q - v);
+        }
+        else
+        {
+            const char* q = v;
+            while (q < end && *q >= '0' && *q <= '9') ++q;
+            n = static_cast<size_t>(q - v);
+        }
+        return true;
+    }
+    return false;
+}
+
+static bool ParseJson(const char* s, const char* end, PayloadEncoding enc, Line& l)
+{
+    if (s == end || *s != '{' || end[-1] != '}') return false;
+    const char* v;
+    size_t      n;
+    auto num = [&](const char* key, uint64_t& out) {
+        if (!JsonField(s, end, key, v, n)) return false;
+        out = strtoull(v, nullptr, 10);
+        return true;
+    };
+    auto str = [&](const char* key, std::string& out) {
+        if (!JsonField(s, end, key, v, n)) return false;
+        out.assign(v, n);
+        return true;
+    };
+    if (!num("seq", l.seq) || !num("timestamp_us", l.ts) || !num("connection", l.conn) ||
+        !str("direction", l.dir) || !num("opcode", l.opcode) || !str("name", l.name) ||
+        !num("size", l.size) || !num("stored", l.stored))
+        return false;
+    l.hasPayload = JsonField(s, end, "payload", v, n);
+    return !l.hasPayload || DecodePayload(enc, v, n, l.payload);
+}
+
+static bool VerifyText(const char* path, const std::vector<CapturedPacket>& src, ExportFormat fmt, PayloadEncoding enc)
+{
+    std::string text;
+    if (!ReadFile(path, text)) return false;
+
+    const char* p   = text.data();
+    const char* end = p + text.size();
+    if (fmt == ExportFormat::Csv)
+    {
+        const char* nl = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!nl || strncmp(p, "seq,timestamp_us,", 17) != 0) return false;
+        p = nl + 1;
+    }
+
+    Line   l;
+    size_t row = 0;
+    while (p < end)
+    {
+        const char* nl = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!nl || row == src.size()) return false;
+        const bool parsed = fmt == ExportFormat::Csv ? ParseCsv(p, nl, enc, l) : ParseJson(p, nl, enc, l);
+        if (!parsed || !Same(l, src[row], enc))
+        {
+            printf("  line %zu differs: %.*s\n", row, static_cast<int>((std::min)(nl - p, ptrdiff_t{ 160 })), p);
+            return false;
+        }
+        ++row;
+        p = nl + 1;
+    }
+    return row == src.size();
+}
+
+static bool VerifyColumns(const char* path, const std::vector<CapturedPacket>& src)
+{
+    ColumnTable t;
+    if (!LoadColumns(path, t) || t.seq.size() != src.size()) return false;
+    for (size_t i = 0; i < t.dictOpcode.size(); ++i)
+        if (t.dictName[i] != OpcodeToString(t.dictOpcode[i])) return false;
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        const CapturedPacket& p = src[i];
+        if (t.seq[i] != p.seq || t.timestamp_us[i] != p.timestamp_us || t.size[i] != p.size ||
+            t.stored[i] != p.payload.size() || t.dictOpcode[t.opcode[i]] != p.opcode ||
+            t.direction[i] != static_cast<uint8_t>(p.direction) || t.connection[i] != p.connection)
+            return false;
+    }
+    return true;
+}
+
+// ============================================================
+//  Suite
+// ============================================================
+
+int Bench::RunExport(int argc, char** argv)
+{
+    uint32_t    packets = 1'000'000;
+    unsigned    threads = (std::max)(1u, std::thread::hardware_concurrency());
+    std::string dir     = ".";
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if      (!strcmp(argv[i], "--packets")) packets = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (!strcmp(argv[i], "--threads")) threads = (std::max)(1u, static_cast<unsigned>(atoi(argv[i + 1])));
+        else if (!strcmp(argv[i], "--dir"))     dir     = argv[i + 1];
+    }
+
+    const std::vector<CapturedPacket> src = SyntheticCapture(packets);
+    uint64_t payloadBytes = 0;
+    for (const CapturedPacket& p : src) payloadBytes += p.payload.size();
+    printf("capture            : %u packets, %.1f MB payload\n", packets, payloadBytes / 1e6);
+
+    static const struct { ExportFormat fmt; PayloadEncoding enc; const char* label; } kRuns[] = {
+        { ExportFormat::Csv,       PayloadEncoding::None,   "csv"           },
+        { ExportFormat::Csv,       PayloadEncoding::Hex,    "csv hex"       },
+        { ExportFormat::Csv,       PayloadEncoding::Base64, "csv base64"    },
+        { ExportFormat::JsonLines, PayloadEncoding::Hex,    "jsonl hex"     },
+        { ExportFormat::JsonLines, PayloadEncoding::Base64, "jsonl base64"  },
+        { ExportFormat::Columns,   PayloadEncoding::None,   "columns"       },
+    };
+
+    std::vector<unsigned> threadCounts = { 1 };
+    if (threads > 1) threadCounts.push_back(threads);
+
+    bool ok = true;
+    for (const auto& run : kRuns)
+    {
+        const std::string path = dir + "/PacketGodBench_export." + ExportFormatExtension(run.fmt);
+        for (unsigned t : threadCounts)
+        {
+            ExportOptions opt;
+            opt.format  = run.fmt;
+            opt.payload = run.enc;
+            opt.threads = t;
+
+            uint64_t bytes = 0;
+            const auto t0 = Clock::now();
+            const bool written = ExportCapture(path.c_str(), src, opt, &bytes);
+            const double secs = SecondsSince(t0);
+
+            // The streaming path (rows copied in one by one), on the widest run.
+            bool streamed = true;
+            if (t == threadCounts.back())
+            {
+                CaptureExporter ex;
+                const std::string spath = path + ".stream";
+                streamed = ex.Open(spath.c_str(), opt);
+                for (size_t i = 0; i < src.size() && i < 50'000; ++i) ex.Write(src[i]);
+                streamed = ex.Close() && streamed;
+                std::vector<CapturedPacket> head(src.begin(), src.begin() + (std::min)(src.size(), size_t{ 50'000 }));
+                streamed = streamed && (run.fmt == ExportFormat::Columns ? VerifyColumns(spath.c_str(), head)
+                                                                         : VerifyText(spath.c_str(), head, run.fmt, run.enc));
+                remove(spath.c_str());
+            }
+
+            const bool same = written && (run.fmt == ExportFormat::Columns ? VerifyColumns(path.c_str(), src)
+                                                                           : VerifyText(path.c_str(), src, run.fmt, run.enc));
+            printf("%-13s x%-3u  : %8.1f MB  %7.0f MB/s  %6.2f M rows/s  %s\n", run.label, t, bytes / 1e6,
+                   bytes / 1e6 / secs, packets / 1e6 / secs,
+                   same && streamed ? "round trip ok" : "ROUND TRIP FAILED");
+            ok &= same && streamed;
+        }
+        remove(path.c_str());
+    }
+
+    printf("export             : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include "Bench.h"
+#include "packet/PacketFuzzer.h"
+#include "packet/PacketReplay.h"
+#include "Opcodes.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// ============================================================
+//  Stand-in for WowConnection::Send — counts what it is handed
+// ============================================================
+
+static std::atomic<uint64_t> s_sinkPackets{ 0 };
+static std::atomic<uint64_t> s_sinkBytes{ 0 };
+static std::atomic<uint64_t> s_sinkOffThread{ 0 };   // sends not on the pumping thread
+static std::thread::id       s_mainThread;
+
+struct StandIn
+{
+    static int __thiscall Send(WowConnection*, CDataStore* packet, int)
+    {
+        s_sinkPackets.fetch_add(1, std::memory_order_relaxed);
+        s_sinkBytes.fetch_add(packet->m_size, std::memory_order_relaxed);
+        if (std::this_thread::get_id() != s_mainThread)
+            s_sinkOffThread.fetch_add(1, std::memory_order_relaxed);
+        return 1;
+    }
+};
+
+// ============================================================
+//  Synthetic seed corpus shaped like real CMSG traffic
+// ============================================================
+
+using Bench::PutU32;
+
+static void SeedCorpus(uint32_t perOpcode)
+{
+    PacketFuzzer::ClearCorpus();
+    for (uint32_t i = 0; i < perOpcode; ++i)
+    {
+        // CMSG_MESSAGECHAT: type, language, length-prefixed-ish text
+        std::vector<uint8_t> chat;
+        PutU32(chat, 1);
+        PutU32(chat, 7);
+        char text[48];
+        int n = snprintf(text, sizeof(text), "fuzz seed message number %u", i);
+        chat.insert(chat.end(), text, text + n + 1);
+        PacketFuzzer::AddSeed(CMSG_MESSAGECHAT, chat.data(), static_cast<uint32_t>(chat.size()));
+
+        // CMSG_NAME_QUERY: 8-byte guid
+        std::vector<uint8_t> nq;
+        PutU32(nq, 0x1000 + i);
+        PutU32(nq, 0);
+        PacketFuzzer::AddSeed(CMSG_NAME_QUERY, nq.data(), static_cast<uint32_t>(nq.size()));
+
+        // CMSG_UPDATE_ACCOUNT_DATA-like: type, time, uint32 size prefix + blob
+        std::vector<uint8_t> blob;
+        PutU32(blob, i % 8);
+        PutU32(blob, 1700000000u + i);
+        const uint32_t len = 32 + (i % 64);
+        PutU32(blob, len);
+        for (uint32_t b = 0; b < len; ++b) blob.push_back(static_cast<uint8_t>(b * 31 + i));
+        PacketFuzzer::AddSeed(CMSG_UPDATE_ACCOUNT_DATA, blob.data(), static_cast<uint32_t>(blob.size()));
+    }
+}
+
+// ============================================================
+//  Suite
+// ============================================================
+
+int Bench::RunFuzz(int argc, char** argv)
+{
+    uint32_t iterations = 2'000'000;
+    uint32_t sends      = 200'000;
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--iterations")) iterations = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        if (!strcmp(argv[i], "--sends"))      sends      = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+    }
+
+    SeedCorpus(64);
+    printf("corpus seeds       : %zu\n", PacketFuzzer::CorpusSize());
+
+    FuzzConfig cfg;
+    cfg.rngSeed = 0x5EED;
+    for (uint32_t k = 0; k < static_cast<uint32_t>(MutationKind::Count); ++k)
+    {
+        FuzzConfig one = cfg;
+        one.kindMask     = 1u << k;
+        one.maxMutations = 1;
+        printf("mutate %-12s: %12.0f pkts/s\n",
+               MutationKindName(static_cast<MutationKind>(k)),
+               PacketFuzzer::Benchmark(iterations, one));
+    }
+    const double mixed = PacketFuzzer::Benchmark(iterations, cfg);
+    printf("mutate mixed       : %12.0f pkts/s\n", mixed);
+
+    // End to end: worker loop -> send ring -> RunQueuedSends on this
+    // thread (the render hook's role) -> PacketReplay::Send -> stand-in sink.
+    s_mainThread = std::this_thread::get_id();
+    static uint8_t fakeConn[sizeof(WowConnection)] = {};
+    PacketReplay::SetSendFn(&StandIn::Send, reinterpret_cast<WowConnection*>(fakeConn));
+
+    FuzzConfig run = cfg;
+    run.packetsPerSecond = 1'000'000'000;   // effectively unthrottled
+    run.maxPackets       = sends;
+    PacketFuzzer::ResetStats();
+
+    const auto t0 = Clock::now();
+    PacketFuzzer::Start(run);
+    while (PacketFuzzer::IsRunning())
+    {
+        PacketFuzzer::RunQueuedSends();
+        std::this_thread::yield();
+    }
+    PacketFuzzer::Stop();
+    const double secs = SecondsSince(t0);
+
+    const FuzzStats st = PacketFuzzer::Stats();
+    printf("send loop          : %12.0f pkts/s (%llu sent, %llu failed, %llu sink bytes, %llu off-thread)\n",
+           secs > 0 ? st.sent / secs : 0.0,
+           static_cast<unsigned long long>(st.sent),
+           static_cast<unsigned long long>(st.sendFailed),
+           static_cast<unsigned long long>(s_sinkBytes.load()),
+           static_cast<unsigned long long>(s_sinkOffThread.load()));
+
+    PacketReplay::SetSendFn(nullptr, nullptr);
+    return (st.sent == sends && s_sinkPackets.load() == sends && !s_sinkOffThread.load() && mixed > 0.0) ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+#include "Bench.h"
+#include "packet/PacketCapture.h"
+#include "packet/PacketInflater.h"
+#include "Opcodes.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if PACKETGOD_BENCH_DEFLATE
+#include <zlib.h>
+#endif
+
+// ============================================================
+//  PacketInflater — zlib bodies in and out
+//
+//  Every compressed layout (rawSize at offset 0, 8 and 16) is
+//  built around bodies of 1 byte .. 1 MiB and must inflate back
+//  to the same bytes:
+//    round trip   deflate output (stored blocks without a system
+//                 zlib), through Inflate()
+//    raw size     a claim one short, one long, 0 and above
+//                 kMaxInflated is rejected
+//    truncated    the stream cut anywhere (header, data, adler)
+//                 is rejected
+//    framing      too short for rawSize, not a compressed opcode
+//    queue cap    Enqueue past kMaxPendingJobs counts the rest as
+//                 dropped and never holds more than the cap
+//  plus the Inflate() throughput of the round-trip bodies.
+//
+//  Options:  --rounds N   throughput passes over the bodies (default 20)
+// ============================================================
+
+using Bench::Clock;
+using Bench::Lcg;
+using Bench::PutU32;
+
+struct InflateLayout
+{
+    const char* name;
+    uint16_t    opcode;
+};
+
+static const InflateLayout kLayouts[] = {
+    { "update object", SMSG_COMPRESSED_UPDATE_OBJECT },
+    { "moves",         SMSG_COMPRESSED_MOVES },
+    { "cmsg account",  CMSG_UPDATE_ACCOUNT_DATA },
+    { "smsg account",  SMSG_UPDATE_ACCOUNT_DATA },
+};
+
+// Compressible: runs of a few byte values, some noise.
+static std::vector<uint8_t> MakeBody(uint32_t size, uint32_t seed)
+{
+    std::vector<uint8_t> b(size);
+    uint32_t rng = seed;
+    for (uint32_t i = 0; i < size; )
+    {
+        const uint32_t r   = Lcg(rng);
+        const uint32_t run = 1 + r % 24;
+        for (uint32_t k = 0; k < run && i < size; ++k, ++i)
+            b[i] = (r & 0x300) ? static_cast<uint8_t>(r >> 12 & 7) : static_cast<uint8_t>(Lcg(rng));
+    }
+    return b;
+}
+
+static std::vector<uint8_t> Zlib(const std::vector<uint8_t>& body)
+{
+    std::vector<uint8_t> z;
+#if PACKETGOD_BENCH_DEFLATE
+    uLongf len = compressBound(static_cast<uLong>(body.size()));
+    z.resize(len);
+    compress2(z.data(), &len, body.data(), static_cast<uLong>(body.size()), Z_DEFAULT_COMPRESSION);
+    z.resize(len);
+#else
+    Bench::PutZlibStored(z, body.data(), body.size());
+#endif
+    return z;
+}
+
+// The opcode's layout: filler up to the rawSize field, `rawSize`, `zlib`.
+static std::vector<uint8_t> Payload(uint16_t opcode, uint32_t rawSize, const std::vector<uint8_t>& zlib)
+{
+    std::vector<uint8_t> p(static_cast<size_t>(PacketInflater::RawSizeOffset(opcode)), 0xA5);
+    PutU32(p, rawSize);
+    p.insert(p.end(), zlib.begin(), zlib.end());
+    return p;
+}
+
+static bool Inflates(uint16_t opcode, const std::vector<uint8_t>& payload, std::vector<uint8_t>& out)
+{
+    return PacketInflater::Inflate(opcode, payload.data(), static_cast<uint32_t>(payload.size()), out);
+}
+
+static bool Check(bool ok, const char* what)
+{
+    printf("%-18s: %s\n", what, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool RunQueueCap()
+{
+    // One large stored body: each job copies and hashes it, so the
+    // single worker falls far behind the enqueues.
+    const std::vector<uint8_t> body = MakeBody(1u << 20, 0xCA9u);
+    std::vector<uint8_t> z;
+    Bench::PutZlibStored(z, body.data(), body.size());
+
+    PacketCapture::Clear();
+    PacketInflater::Start(1);
+    std::vector<CapturedPacket> batch(1);
+    batch[0].direction = PacketDirection::SMSG;
+    batch[0].opcode    = SMSG_COMPRESSED_UPDATE_OBJECT;
+    batch[0].payload   = Payload(SMSG_COMPRESSED_UPDATE_OBJECT, static_cast<uint32_t>(body.size()), z);
+    batch[0].size      = static_cast<uint32_t>(batch[0].payload.size());
+    PacketCapture::PushBatch(batch);   // enqueues it once
+    const uint64_t seq = PacketCapture::LastSeq();
+
+    const InflateStats before = PacketInflater::Stats();
+    const size_t enqueues = 2 * PacketInflater::kMaxPendingJobs;
+    size_t peak = 0;
+    for (size_t i = 0; i < enqueues; ++i)
+    {
+        PacketInflater::Enqueue(seq);
+        if (i % 256 == 0 && PacketInflater::PendingJobs() > peak) peak = PacketInflater::PendingJobs();
+    }
+    if (PacketInflater::PendingJobs() > peak) peak = PacketInflater::PendingJobs();
+    const InflateStats after = PacketInflater::Stats();
+    PacketInflater::Stop();
+    PacketCapture::Clear();
+
+    const uint64_t queued  = after.queued - before.queued;
+    const uint64_t dropped = after.dropped - before.dropped;
+    printf("                    %zu enqueues: %llu queued, %llu dropped, peak %zu pending\n", enqueues,
+           static_cast<unsigned long long>(queued), static_cast<unsigned long long>(dropped), peak);
+    return Check(queued + dropped == enqueues && dropped > 0 && peak <= PacketInflater::kMaxPendingJobs &&
+                 PacketInflater::PendingJobs() == 0, "queue cap");
+}
+
+int Bench::RunInflate(int argc, char** argv)
+{
+    int rounds = 20;
+    for (int i = 0; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--rounds")) rounds = atoi(argv[i + 1]);
+
+    if (!PacketInflater::Available())
+    {
+        printf("inflate           : skipped (built without zlib)\n");
+        return 0;
+    }
+#if PACKETGOD_BENCH_DEFLATE
+    printf("bodies deflated with the system zlib\n");
+#else
+    printf("bodies as stored blocks (no deflate in this build)\n");
+#endif
+
+    const uint32_t sizes[] = { 1, 17, 300, 4096, 65535, 65536, 200000, 1u << 20 };
+    bool ok = true;
+    std::vector<uint8_t> out;
+
+    bool roundTrip = true, rawSize = true, truncated = true;
+    uint64_t inBytes = 0, outBytes = 0;
+    for (const InflateLayout& l : kLayouts)
+        for (uint32_t size : sizes)
+        {
+            const std::vector<uint8_t> body = MakeBody(size, size * 31 + l.opcode);
+            const std::vector<uint8_t> z    = Zlib(body);
+            const std::vector<uint8_t> p    = Payload(l.opcode, size, z);
+            roundTrip &= Inflates(l.opcode, p, out) && out == body;
+            inBytes  += p.size();
+            outBytes += body.size();
+
+            const uint32_t wrong[] = { size - 1, size + 1, 0, PacketInflater::kMaxInflated + 1 };
+            for (uint32_t claim : wrong)
+                rawSize &= !Inflates(l.opcode, Payload(l.opcode, claim, z), out);
+
+            // Cut inside the zlib header, the data, and the adler32 trailer.
+            const size_t cuts[] = { 1, 2, z.size() / 2, z.size() - 4, z.size() - 1 };
+            for (size_t cut : cuts)
+            {
+                if (cut == 0 || cut >= z.size()) continue;
+                std::vector<uint8_t> t = p;
+                t.resize(p.size() - cut);
+                truncated &= !Inflates(l.opcode, t, out);
+            }
+        }
+    ok &= Check(roundTrip, "round trip");
+    ok &= Check(rawSize, "raw size");
+    ok &= Check(truncated, "truncated");
+
+    {
+        const std::vector<uint8_t> body = MakeBody(100, 1);
+        const std::vector<uint8_t> p    = Payload(SMSG_UPDATE_ACCOUNT_DATA, 100, Zlib(body));
+        bool framing = !PacketInflater::Inflate(SMSG_UPDATE_ACCOUNT_DATA, p.data(), 19, out);   // rawSize cut
+        framing &= !PacketInflater::Inflate(SMSG_UPDATE_ACCOUNT_DATA, nullptr, 0, out);
+        framing &= !Inflates(SMSG_UPDATE_OBJECT, p, out);
+        ok &= Check(framing, "framing");
+    }
+
+    ok &= RunQueueCap();
+
+    {
+        std::vector<std::vector<uint8_t>> payloads;
+        for (uint32_t size : sizes)
+            payloads.push_back(Payload(SMSG_COMPRESSED_UPDATE_OBJECT, size, Zlib(MakeBody(size, size))));
+        uint64_t bytes = 0;
+        const auto t0 = Clock::now();
+        for (int r = 0; r < rounds; ++r)
+            for (const std::vector<uint8_t>& p : payloads)
+                if (Inflates(SMSG_COMPRESSED_UPDATE_OBJECT, p, out)) bytes += out.size();
+        const double secs = Bench::SecondsSince(t0);
+        printf("throughput        : %.0f MB/s inflated (%.1fx ratio over all layouts)\n",
+               bytes / secs / 1e6, static_cast<double>(outBytes) / inBytes);
+    }
+
+    printf("inflate           : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+#include "Bench.h"
+#include "analysis/LatencyTracker.h"
+#include "Opcodes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// ============================================================
+//  Latency — LatencyTracker against a capture whose round trips
+//  are known: pairing, percentile error, windows, bounded state
+//
+//  The capture mixes keyed pairs answered out of order (ping,
+//  creature / name queries, spell casts with other players'
+//  SMSG_SPELL_GO in between), a keyless FIFO pair and movement
+//  noise; the server gets three times slower halfway through.
+//
+//  Options:  --packets N   approximate capture size (default 1000000)
+// ============================================================
+
+using Bench::Clock;
+
+// One request with the truth the tracker should recover.
+struct LatRequest
+{
+    uint16_t opcode;
+    uint64_t sentUs;
+    uint32_t rttUs;      // first response; UINT32_MAX = never answered
+};
+
+using Bench::PutU32;
+using Bench::PutU64;
+using Bench::PutPackedGuid;
+
+static CapturedPacket MakePacket(PacketDirection dir, uint16_t opcode, uint64_t ts, uint8_t conn,
+                                 std::vector<uint8_t> payload)
+{
+    CapturedPacket p;
+    p.direction    = dir;
+    p.opcode       = opcode;
+    p.timestamp_us = ts;
+    p.connection   = conn;
+    p.size         = static_cast<uint32_t>(payload.size());
+    p.payload      = std::move(payload);
+    return p;
+}
+
+struct LatCapture
+{
+    std::vector<CapturedPacket> packets;    // timestamp order
+    std::vector<LatRequest>     requests;
+    uint64_t                    unmatched = 0;   // responses that close nothing
+    uint64_t                    halfUs    = 0;   // the slowdown starts here
+};
+
+static LatCapture MakeLatencyCapture(uint32_t target)
+{
+    LatCapture cap;
+    uint32_t rng = 0x1A7E9C3u;
+    auto next  = [&rng] { rng = rng * 1664525u + 1013904223u; return rng; };
+    auto unit  = [&next] { return (next() >> 8) * (1.0 / 16777216.0); };
+
+    // Round trip: 15 ms floor plus an exponential tail, x3 once degraded.
+    auto rtt = [&unit](bool slow) {
+        const double ms = 15.0 + -std::log(1.0 - unit()) * 25.0;
+        return static_cast<uint32_t>(ms * (slow ? 3000.0 : 1000.0));
+    };
+
+    const uint64_t t0       = 1'000'000'000ull;
+    const uint64_t stepUs   = 500;                       // one client event per 0.5 ms
+    const uint32_t events   = target / 3;                // each ~3 packets with responses and noise
+    cap.halfUs              = t0 + uint64_t(events / 2) * stepUs;
+    const uint64_t myGuid   = 0x0000000000012345ull;
+    uint32_t       pingSeq  = 0;
+    uint8_t        castCnt  = 0;
+    uint64_t       lastFifo = 0;                         // QUERY_TIME answers keep request order
+
+    cap.packets.reserve(target + target / 4);
+    for (uint32_t e = 0; e < events; ++e)
+    {
+        const uint64_t ts   = t0 + uint64_t(e) * stepUs;
+        const bool     slow = ts >= cap.halfUs;
+        const uint8_t  conn = (e & 1) ? 2 : 1;
+        const uint32_t r    = next() >> 24;
+        std::vector<uint8_t> req, resp;
+
+        if (r < 110)   // movement noise, no pair
+        {
+            PutU32(req, next());
+            cap.packets.push_back(MakePacket(PacketDirection::CMSG, MSG_MOVE_HEARTBEAT, ts, conn, req));
+            continue;
+        }
+
+        LatRequest lr{ 0, ts, rtt(slow) };
+        if (r < 150)   // ping
+        {
+            lr.opcode = CMSG_PING;
+            PutU32(req, ++pingSeq); PutU32(req, 40);
+            PutU32(resp, pingSeq);
+            cap.packets.push_back(MakePacket(PacketDirection::CMSG, CMSG_PING, ts, conn, req));
+            cap.packets.push_back(MakePacket(PacketDirection::SMSG, SMSG_PONG, ts + lr.rttUs, conn, resp));
+        }
+        else if (r < 190)   // creature query; 1 in 32 entries unknown (bit 31), 1 in 200 never answered
+        {
+            lr.opcode = CMSG_CREATURE_QUERY;
+            const uint32_t entry = 1 + e;   // unique while in flight
+            PutU32(req, entry); PutU64(req, 0xF130000000000000ull | e);
+            PutU32(resp, (next() & 31) ? entry : entry | 0x80000000u);
+            cap.packets.push_back(MakePacket(PacketDirection::CMSG, CMSG_CREATURE_QUERY, ts, conn, req));
+            if (next() % 200 == 0) lr.rttUs = UINT32_MAX;
+            else cap.packets.push_back(MakePacket(PacketDirection::SMSG, SMSG_CREATURE_QUERY_RESPONSE,
+                                                  ts + lr.rttUs, conn, resp));
+        }
+        else if (r < 215)   // name query: u64 in, packed guid out
+        {
+            lr.opcode = CMSG_NAME_QUERY;
+            const uint64_t guid = 0x0000000000100000ull + e;
+            PutU64(req, guid);
+            PutPackedGuid(resp, guid); resp.push_back('A'); resp.push_back(0);
+            cap.packets.push_back(MakePacket(PacketDirection::CMSG, CMSG_NAME_QUERY, ts, conn, req));
+            cap.packets.push_back(MakePacket(PacketDirection::SMSG, SMSG_NAME_QUERY_RESPONSE, ts + lr.rttUs, conn, resp));
+        }
+        else if (r < 240)   // cast: START (cast time) then GO, or GO alone
+        {
+            lr.opcode = CMSG_CAST_SPELL;
+            if (++castCnt == 0) castCnt = 1;
+            const uint32_t spell = 100 + (next() % 8);
+            req.push_back(castCnt); PutU32(req, spell); req.push_back(0);
+            PutPackedGuid(resp, myGuid); PutPackedGuid(resp, myGuid); resp.push_back(castCnt); PutU32(resp, spell);
+            cap.packets.push_back(MakePacket(PacketDirection::CMSG, CMSG_CAST_SPELL, ts, conn, req));
+            const bool castTime = next() & 1;
+            cap.packets.push_back(MakePacket(PacketDirection::SMSG, castTime ? SMSG_SPELL_START : SMSG_SPELL_GO,
+                                             ts + lr.rttUs, conn, resp));
+            if (castTime)
+            {
+                cap.packets.push_back(MakePacket(PacketDirection::SMSG, SMSG_SPELL_GO, ts + lr.rttUs + 1'500'000,
+                                                 conn, resp));
+                ++cap.unmatched;
+            }
+            // Someone else casting the same spell nearby.
+            std::vector<uint8_t> other;
+            PutPackedGuid(other, 0x0000000000054321ull); PutPackedGuid(other, 0x0000000000054321ull);
+            other.push_back(0); PutU32(other, spell);
+            cap.packets.push_back(MakePacket(PacketDirection::SMSG, SMSG_SPELL_GO, ts + 100, conn, other));
+            ++cap.unmatched;
+        }
+        else   // keyless: answers in request order
+        {
+            lr.opcode = CMSG_QUERY_TIME;
+            uint64_t at = ts + lr.rttUs;
+            if (at <= lastFifo) at = lastFifo + 1;
+            lastFifo = at;
+            lr.rttUs = static_cast<uint32_t>(at - ts);
+            PutU32(resp, static_cast<uint32_t>(at / 1'000'000));
+            cap.packets.push_back(MakePacket(PacketDirection::CMSG, CMSG_QUERY_TIME, ts, 1, req));
+            cap.packets.push_back(MakePacket(PacketDirection::SMSG, SMSG_QUERY_TIME_RESPONSE, at, 1, resp));
+        }
+        cap.requests.push_back(lr);
+    }
+
+    std::stable_sort(cap.packets.begin(), cap.packets.end(),
+                     [](const CapturedPacket& a, const CapturedPacket& b) { return a.timestamp_us < b.timestamp_us; });
+    for (size_t i = 0; i < cap.packets.size(); ++i)
+        cap.packets[i].seq = i + 1;
+    return cap;
+}
+
+// Nearest-rank percentile of the true round trips.
+static uint32_t ExactPercentile(std::vector<uint32_t>& v, double q)
+{
+    size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(v.size())));
+    if (rank == 0) rank = 1;
+    std::nth_element(v.begin(), v.begin() + (rank - 1), v.end());
+    return v[rank - 1];
+}
+
+static bool Within(uint32_t got, uint32_t want)
+{
+    const uint32_t diff = got > want ? got - want : want - got;
+    return diff <= want / 32 + 1;
+}
+
+static bool CheckPair(const LatCapture& cap, const LatencyPairStats& st)
+{
+    std::vector<uint32_t> rtts;
+    uint64_t lost = 0;
+    for (const LatRequest& r : cap.requests)
+        if (r.opcode == st.pair.request)
+        {
+            if (r.rttUs == UINT32_MAX) ++lost;
+            else rtts.push_back(r.rttUs);
+        }
+    if (rtts.empty()) return true;
+
+    const uint32_t p50 = ExactPercentile(rtts, 0.50), p90 = ExactPercentile(rtts, 0.90),
+                   p99 = ExactPercentile(rtts, 0.99);
+    const bool ok = st.matched == rtts.size() && st.evicted + st.expired + st.open == lost &&
+                    Within(st.total.p50, p50) && Within(st.total.p90, p90) && Within(st.total.p99, p99);
+    printf("%-28s: %7llu matched  p50 %6.2f / %6.2f  p90 %6.2f / %6.2f  p99 %6.2f / %6.2f ms  lost %llu  %s\n",
+           OpcodeToString(st.pair.request), static_cast<unsigned long long>(st.matched),
+           st.total.p50 / 1e3, p50 / 1e3, st.total.p90 / 1e3, p90 / 1e3, st.total.p99 / 1e3, p99 / 1e3,
+           static_cast<unsigned long long>(st.evicted + st.expired + st.open), ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+// Unanswered requests never hold more than kMaxOpen slots.
+static bool CheckBounded()
+{
+    LatencyTracker::Clear();
+    std::vector<CapturedPacket> pings;
+    for (uint32_t i = 0; i < 100'000; ++i)
+    {
+        std::vector<uint8_t> b;
+        PutU32(b, i); PutU32(b, 0);
+        pings.push_back(MakePacket(PacketDirection::CMSG, CMSG_PING, 1'000'000 + i * 10ull, 1, b));
+    }
+    LatencyTracker::Consume(pings);
+    const LatencyPairStats st = LatencyTracker::Stats().front();   // CMSG_PING is first in the table
+    const bool ok = st.open == LatencyTracker::kMaxOpen && st.evicted == 100'000 - LatencyTracker::kMaxOpen;
+    printf("unanswered pings  : 100000 sent, %u open, %llu evicted  %s\n", st.open,
+           static_cast<unsigned long long>(st.evicted), ok ? "ok" : "FAIL");
+
+    // Long silence: the next request expires them all.
+    pings.resize(1);
+    pings[0].timestamp_us += 1'000'000 + LatencyTracker::kOpenTimeoutMicros + 100'000 * 10ull;
+    LatencyTracker::Consume(pings);
+    const LatencyPairStats after = LatencyTracker::Stats().front();
+    const bool expOk = after.open == 1 && after.expired == LatencyTracker::kMaxOpen;
+    printf("after timeout     : %u open, %llu expired  %s\n", after.open,
+           static_cast<unsigned long long>(after.expired), expOk ? "ok" : "FAIL");
+    return ok && expOk;
+}
+
+int Bench::RunLatency(int argc, char** argv)
+{
+    uint32_t packets = 1'000'000;
+    for (int i = 0; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--packets")) packets = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+    if (packets < 1000)
+    {
+        printf("nothing to run\n");
+        return 2;
+    }
+
+    const LatCapture cap = MakeLatencyCapture(packets);
+    printf("capture           : %zu packets, %zu requests over %.0f s\n", cap.packets.size(), cap.requests.size(),
+           (cap.packets.back().timestamp_us - cap.packets.front().timestamp_us) / 1e6);
+
+    bool ok = LatencyTracker::Configure(LatencyTracker::DefaultPairs());
+    const auto t0 = Clock::now();
+    LatencyTracker::Consume(cap.packets);
+    const double secs = SecondsSince(t0);
+    printf("consume           : %.1f ns/packet (%.1f M packets/s)\n", secs * 1e9 / cap.packets.size(),
+           cap.packets.size() / secs / 1e6);
+
+    const std::vector<LatencyPairStats> stats = LatencyTracker::Stats();
+    uint64_t unmatched = 0;
+    for (const LatencyPairStats& st : stats)
+    {
+        ok &= CheckPair(cap, st);
+        unmatched += st.unmatched;
+    }
+    if (unmatched != cap.unmatched)
+    {
+        printf("FAIL: %llu unmatched responses, expected %llu\n", static_cast<unsigned long long>(unmatched),
+               static_cast<unsigned long long>(cap.unmatched));
+        ok = false;
+    }
+
+    // Windows: p50 before the slowdown vs the recent minute after it.
+    size_t pingIndex = 0;
+    while (pingIndex < stats.size() && stats[pingIndex].pair.request != CMSG_PING) ++pingIndex;
+    const std::vector<LatencyWindow> series = LatencyTracker::Series(pingIndex);
+    uint32_t before = 0;
+    for (const LatencyWindow& w : series)
+        if (w.count && w.startUs + LatencyTracker::WindowMicros() <= cap.halfUs) { before = w.p50; break; }
+    const uint32_t after = stats[pingIndex].recent.p50;
+    const bool degraded = before && after > before * 2;
+    printf("windows           : %zu x %llu s, ping p50 %.1f ms early -> %.1f ms recent  %s\n", series.size(),
+           static_cast<unsigned long long>(LatencyTracker::WindowMicros() / 1'000'000), before / 1e3, after / 1e3,
+           degraded ? "ok" : "FAIL");
+    ok &= degraded;
+
+    ok &= CheckBounded();
+    LatencyTracker::Clear();
+    printf("latency           : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
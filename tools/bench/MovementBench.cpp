@@ -0,0 +1,401 @@
+#include "Bench.h"
+#include "packet/MovementCodec.h"
+#include "packet/CaptureFile.h"
+#include "packet/PacketPipeline.h"
+#include "Opcodes.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if PACKETGOD_BENCH_DEFLATE
+#include <zlib.h>
+#endif
+
+// ============================================================
+//  Movement traffic: players running, turning, jumping, swimming
+//  and riding a boat, heartbeats every 500 ms while moving.  The
+//  own player is CMSG, everyone else SMSG.
+// ============================================================
+
+namespace
+{
+    struct Packet
+    {
+        PacketDirection      dir;
+        uint16_t             opcode;
+        std::vector<uint8_t> payload;
+    };
+
+    struct Mover
+    {
+        uint64_t guid;
+        float    x, y, z, o;
+        uint32_t flags    = 0;
+        uint32_t clock    = 0;   // client time offset
+        uint32_t fallTime = 0;
+        uint32_t nextMs   = 0;
+        uint32_t landAt   = 0;
+        bool     boat     = false;
+    };
+
+    struct Writer
+    {
+        std::vector<uint8_t>& out;
+        template <typename T> void Put(T v) { const uint8_t* p = reinterpret_cast<const uint8_t*>(&v); out.insert(out.end(), p, p + sizeof(T)); }
+        void PackedGuid(uint64_t guid)
+        {
+            const size_t at = out.size();
+            out.push_back(0);
+            for (int i = 0; i < 8; ++i)
+                if (const uint8_t b = static_cast<uint8_t>(guid >> (8 * i)))
+                {
+                    out[at] |= static_cast<uint8_t>(1u << i);
+                    out.push_back(b);
+                }
+        }
+    };
+
+    uint32_t s_rng = 0x2545F491u;
+    uint32_t Rand(uint32_t n) { return Bench::Lcg(s_rng) % n; }
+}
+
+constexpr uint32_t kForward  = 0x00000001;
+constexpr uint32_t kTransport = 0x00000200;
+constexpr uint32_t kFalling  = 0x00001000;
+constexpr uint32_t kSwimming = 0x00200000;
+
+static void Emit(std::vector<Packet>& out, const Mover& m, uint16_t opcode, uint32_t nowMs, bool cmsg)
+{
+    Packet pkt{ cmsg ? PacketDirection::CMSG : PacketDirection::SMSG, opcode, {} };
+    Writer w{ pkt.payload };
+    w.PackedGuid(m.guid);
+    w.Put<uint32_t>(m.flags);
+    w.Put<uint16_t>(0);
+    w.Put<uint32_t>(m.clock + nowMs);
+    w.Put(m.x); w.Put(m.y); w.Put(m.z); w.Put(m.o);
+    if (m.flags & kTransport)
+    {
+        w.PackedGuid(0x1FC0000000000001ull);
+        w.Put(m.x - 1200.0f); w.Put(m.y - 300.0f); w.Put(0.5f); w.Put(m.o);
+        w.Put<uint32_t>(m.clock + nowMs - 40);
+        w.Put<uint8_t>(0xFF);
+    }
+    if (m.flags & kSwimming) w.Put(-0.2f);   // pitch
+    w.Put<uint32_t>(m.fallTime);
+    if (m.flags & kFalling) { w.Put(-7.9f); w.Put(std::sin(m.o)); w.Put(std::cos(m.o)); w.Put(7.0f); }
+    out.push_back(std::move(pkt));
+}
+
+static void Simulate(uint32_t movers, uint32_t seconds, std::vector<Packet>& out)
+{
+    std::vector<Mover> ms(movers);
+    for (uint32_t i = 0; i < movers; ++i)
+    {
+        Mover& m = ms[i];
+        m.guid  = 0x1000 + i * 7;
+        m.x     = -8900.0f + Rand(400);
+        m.y     = 500.0f + Rand(400);
+        m.z     = 95.0f + Rand(10);
+        m.o     = Rand(628) / 100.0f;
+        m.clock = Rand(1u << 30);
+        m.boat  = i % 10 == 9;
+        if (m.boat) m.flags |= kTransport;
+        m.nextMs = Rand(1000);
+    }
+
+    for (uint32_t now = 0; now < seconds * 1000; now += 50)
+        for (uint32_t i = 0; i < movers; ++i)
+        {
+            Mover&     m    = ms[i];
+            const bool cmsg = i == 0;
+            if (m.flags & kForward)
+            {
+                m.x += std::cos(m.o) * 7.0f * 0.05f;
+                m.y += std::sin(m.o) * 7.0f * 0.05f;
+                m.z += (Rand(3) - 1.0f) * 0.01f;
+            }
+            if ((m.flags & kFalling) && now >= m.landAt)
+            {
+                m.flags   &= ~kFalling;
+                m.fallTime = 0;
+                Emit(out, m, MSG_MOVE_FALL_LAND, now, cmsg);
+                continue;
+            }
+            if (now < m.nextMs) continue;
+
+            switch (Rand(16))
+            {
+            case 0: case 1:
+                m.flags |= kForward;
+                Emit(out, m, MSG_MOVE_START_FORWARD, now, cmsg);
+                break;
+            case 2:
+                m.flags &= ~kForward;
+                Emit(out, m, MSG_MOVE_STOP, now, cmsg);
+                break;
+            case 3: case 4:
+                m.o = std::fmod(m.o + (Rand(200) - 100) / 100.0f + 6.283f, 6.283f);
+                Emit(out, m, MSG_MOVE_SET_FACING, now, cmsg);
+                break;
+            case 5:
+                if (m.flags & (kFalling | kTransport)) break;
+                m.flags   |= kFalling;
+                m.fallTime = 0;
+                m.landAt   = now + 600;
+                Emit(out, m, MSG_MOVE_JUMP, now, cmsg);
+                break;
+            case 6:
+                if (m.boat) break;
+                m.flags ^= kSwimming;
+                Emit(out, m, (m.flags & kSwimming) ? MSG_MOVE_START_SWIM : MSG_MOVE_STOP_SWIM, now, cmsg);
+                break;
+            default:
+                if (m.flags & kForward)
+                    Emit(out, m, MSG_MOVE_HEARTBEAT, now, cmsg);
+                break;
+            }
+            if (m.flags & kFalling) m.fallTime += 500;
+            m.nextMs = now + 500;
+        }
+}
+
+// ============================================================
+//  Round trips
+// ============================================================
+
+static bool RoundTrip(const std::vector<Packet>& pkts, size_t& encodedBytes)
+{
+    MovementCodec        enc, dec;
+    std::vector<uint8_t> rec, back;
+    encodedBytes = 0;
+    for (const Packet& p : pkts)
+    {
+        rec.clear();
+        if (!enc.Encode(1, p.dir, p.opcode, p.payload.data(), static_cast<uint32_t>(p.payload.size()), rec))
+            return false;
+        encodedBytes += rec.size();
+        if (!dec.Decode(1, p.dir, p.opcode, rec.data(), static_cast<uint32_t>(rec.size()), back) || back != p.payload)
+            return false;
+    }
+    return true;
+}
+
+static int RunRoundTrips(const std::vector<Packet>& traffic)
+{
+    int failed = 0;
+    auto check = [&](const char* name, bool ok)
+    {
+        printf("  %-34s %s\n", name, ok ? "ok" : "FAILED");
+        failed += ok ? 0 : 1;
+    };
+
+    size_t bytes;
+    check("simulated session", RoundTrip(traffic, bytes));
+
+    // Not movement, or too short to be a MovementInfo: left to the caller.
+    {
+        MovementCodec        c;
+        std::vector<uint8_t> rec;
+        const Packet&        p = traffic.front();
+        check("short / foreign packets refused",
+              !c.Encode(0, p.dir, p.opcode, p.payload.data(), 12, rec) &&
+              !c.Encode(0, p.dir, SMSG_UPDATE_OBJECT, p.payload.data(), static_cast<uint32_t>(p.payload.size()), rec) &&
+              rec.empty());
+    }
+
+    // Same GUID packed with a redundant zero byte: a new keyframe, still exact.
+    {
+        std::vector<Packet> v(traffic.begin(), traffic.begin() + 64);
+        Packet odd = v[0];
+        size_t guidEnd = 1;
+        for (uint8_t mask = odd.payload[0]; mask; mask &= mask - 1) ++guidEnd;
+        odd.payload.insert(odd.payload.begin() + guidEnd, 0);
+        odd.payload[0] |= 0x80;
+        v.push_back(odd);
+        v.push_back(traffic[0]);
+        check("non-canonical packed GUID", RoundTrip(v, bytes));
+    }
+
+    // More movers than contexts: the table resets on both sides.
+    {
+        std::vector<Packet> v;
+        Mover m{};
+        for (uint32_t i = 0; i < MovementCodec::kMaxMovers + 100; ++i)
+        {
+            m.guid = 0x700000 + i;
+            m.x    = static_cast<float>(i);
+            Emit(v, m, MSG_MOVE_HEARTBEAT, i, false);
+        }
+        v.insert(v.end(), traffic.begin(), traffic.begin() + 512);
+        check("context table overflow", RoundTrip(v, bytes));
+    }
+
+    // A truncated or garbage record is rejected, not misread.
+    {
+        MovementCodec        enc, dec;
+        std::vector<uint8_t> rec, back;
+        bool ok = true;
+        for (size_t i = 0; i < 32 && ok; ++i)
+        {
+            const Packet& p = traffic[i];
+            rec.clear();
+            enc.Encode(0, p.dir, p.opcode, p.payload.data(), static_cast<uint32_t>(p.payload.size()), rec);
+            ok = dec.Decode(0, p.dir, p.opcode, rec.data(), static_cast<uint32_t>(rec.size()), back);
+        }
+        const uint8_t bogus[] = { 0x40, 0x7F, 0x00 };   // delta for a slot that does not exist
+        ok = ok && !dec.Decode(0, PacketDirection::SMSG, MSG_MOVE_HEARTBEAT, bogus, sizeof(bogus), back);
+        rec.clear();
+        const Packet& p = traffic[40];
+        enc.Encode(0, p.dir, p.opcode, p.payload.data(), static_cast<uint32_t>(p.payload.size()), rec);
+        ok = ok && !dec.Decode(0, p.dir, p.opcode, rec.data(), static_cast<uint32_t>(rec.size()) - 1, back);
+        check("corrupt records rejected", ok);
+    }
+
+    // Through a .pgcap file, interleaved with non-movement packets.
+    {
+        const char* path = "PacketGodBench_movement.pgcap";
+        CaptureWriter w;
+        bool ok = w.Open(path);
+        const uint8_t other[] = { 1, 2, 3, 4, 5 };
+        for (size_t i = 0; i < 2000 && ok; ++i)
+        {
+            const Packet& p = traffic[i];
+            ok = w.Write(p.dir, p.opcode, i, p.payload.data(), static_cast<uint32_t>(p.payload.size()), 3);
+            if (i % 7 == 0) ok = ok && w.Write(PacketDirection::SMSG, SMSG_UPDATE_OBJECT, i, other, sizeof(other), 3);
+        }
+        ok = w.Close() && ok;
+
+        CaptureReader  r;
+        CapturedPacket pkt;
+        ok = ok && r.Open(path);
+        for (size_t i = 0; i < 2000 && ok; ++i)
+        {
+            ok = r.Next(pkt) && pkt.payload == traffic[i].payload && pkt.opcode == traffic[i].opcode &&
+                 pkt.direction == traffic[i].dir && pkt.connection == 3;
+            if (ok && i % 7 == 0)
+                ok = r.Next(pkt) && pkt.opcode == SMSG_UPDATE_OBJECT && pkt.payload.size() == sizeof(other);
+        }
+        ok = ok && !r.Next(pkt);
+        r.Close();
+        remove(path);
+        check("capture file round trip", ok);
+    }
+
+    // Record sizes come from the file: oversize and past-the-end ones end the read.
+    {
+        const char* path = "PacketGodBench_corrupt.pgcap";
+        const std::vector<uint8_t> big(PacketPipeline::kMaxPayload + 100, 0x3C);
+        const uint8_t small[] = { 9, 8, 7 };
+        CaptureWriter w;
+        bool ok = w.Open(path, false);
+        ok = ok && w.Write(PacketDirection::SMSG, SMSG_UPDATE_OBJECT, 1, big.data(), static_cast<uint32_t>(big.size()));
+        ok = ok && w.Write(PacketDirection::SMSG, SMSG_UPDATE_OBJECT, 2, small, sizeof(small));
+        ok = w.Close() && ok;
+
+        CaptureReader  r;
+        CapturedPacket pkt;
+        ok = ok && r.Open(path) && r.Next(pkt) && pkt.payload.size() == PacketPipeline::kMaxPayload &&
+             pkt.size == big.size() && r.Next(pkt) && pkt.payload.size() == sizeof(small) && !r.Next(pkt);
+        r.Close();
+
+        // Patch the last record's size: above kMaxPayload, then just past the end of the file.
+        const long sizeAt = static_cast<long>(8 + 16 + 4 + PacketPipeline::kMaxPayload + 8);
+        for (uint32_t bad : { 0xFFFFFFF0u, static_cast<uint32_t>(sizeof(small) + 1) })
+        {
+            FILE* f = fopen(path, "r+b");
+            ok = ok && f && fseek(f, sizeAt, SEEK_SET) == 0 && fwrite(&bad, 4, 1, f) == 1;
+            if (f) fclose(f);
+            ok = ok && r.Open(path) && r.Next(pkt) && !r.Next(pkt);
+            r.Close();
+        }
+        remove(path);
+        check("corrupt record sizes refused", ok);
+    }
+    return failed;
+}
+
+// ============================================================
+//  Suite
+// ============================================================
+
+int Bench::RunMovement(int argc, char** argv)
+{
+    uint32_t movers = 40, seconds = 600;
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--movers"))  movers  = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        if (!strcmp(argv[i], "--seconds")) seconds = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+    }
+
+    std::vector<Packet> traffic;
+    Simulate(movers, seconds, traffic);
+    size_t raw = 0;
+    for (const Packet& p : traffic) raw += p.payload.size();
+    printf("traffic            : %zu packets, %zu KiB, %u movers\n", traffic.size(), raw >> 10, movers);
+
+    const int failed = RunRoundTrips(traffic);
+
+    // Codec
+    MovementCodec        enc, dec;
+    std::vector<uint8_t> stream, back;
+    std::vector<size_t>  ends;
+    stream.reserve(raw);
+    auto t0 = Clock::now();
+    for (const Packet& p : traffic)
+    {
+        enc.Encode(0, p.dir, p.opcode, p.payload.data(), static_cast<uint32_t>(p.payload.size()), stream);
+        ends.push_back(stream.size());
+    }
+    const double encSec = SecondsSince(t0);
+    t0 = Clock::now();
+    size_t from = 0;
+    for (size_t i = 0; i < traffic.size(); ++i)
+    {
+        dec.Decode(0, traffic[i].dir, traffic[i].opcode, stream.data() + from, static_cast<uint32_t>(ends[i] - from), back);
+        from = ends[i];
+    }
+    const double decSec = SecondsSince(t0);
+    const double n = static_cast<double>(traffic.size());
+    printf("movement codec     : %6.2fx  (%zu KiB)   encode %6.1f ns/pkt   decode %6.1f ns/pkt\n",
+           static_cast<double>(raw) / stream.size(), stream.size() >> 10, encSec * 1e9 / n, decSec * 1e9 / n);
+
+#if PACKETGOD_BENCH_DEFLATE
+    // Generic path: zlib per record (random access, like the codec's
+    // own records) and over 64 KiB blocks of records.
+    std::vector<uint8_t> z(compressBound(64u << 10));
+    size_t perRecord = 0;
+    t0 = Clock::now();
+    for (const Packet& p : traffic)
+    {
+        uLongf len = static_cast<uLongf>(z.size());
+        compress2(z.data(), &len, p.payload.data(), static_cast<uLong>(p.payload.size()), Z_DEFAULT_COMPRESSION);
+        perRecord += len;
+    }
+    const double recSec = SecondsSince(t0);
+
+    std::vector<uint8_t> block;
+    size_t blocked = 0;
+    t0 = Clock::now();
+    for (size_t i = 0; i < traffic.size(); ++i)
+    {
+        block.insert(block.end(), traffic[i].payload.begin(), traffic[i].payload.end());
+        if (block.size() < (64u << 10) - 256 && i + 1 < traffic.size()) continue;
+        uLongf len = static_cast<uLongf>(z.size());
+        compress2(z.data(), &len, block.data(), static_cast<uLong>(block.size()), Z_DEFAULT_COMPRESSION);
+        blocked += len;
+        block.clear();
+    }
+    const double blockSec = SecondsSince(t0);
+    printf("zlib per record    : %6.2fx  (%zu KiB)   encode %6.1f ns/pkt\n",
+           static_cast<double>(raw) / perRecord, perRecord >> 10, recSec * 1e9 / n);
+    printf("zlib 64 KiB blocks : %6.2fx  (%zu KiB)   encode %6.1f ns/pkt\n",
+           static_cast<double>(raw) / blocked, blocked >> 10, blockSec * 1e9 / n);
+#else
+    printf("zlib               : (not built with a deflate-capable zlib)\n");
+#endif
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,718 @@
+#include "Bench.h"
+#include "packet/PacketCapture.h"
+#include "packet/PacketPipeline.h"
+#include "packet/PacketRewriter.h"
+#include "packet/StreamReassembler.h"
+#include "crypto/Arc4.h"
+#include "wow/WowTypes.h"
+#include "Opcodes.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+//  Capture overhead — what the hooks cost the game's threads
+//
+//  Replays the bodies of the WowConn_Send and ARC4_Process (+ recv)
+//  detours against synthetic CDataStore / SARC4State buffers and
+//  reports ns per packet for each stage:
+//
+//    capture.cmsg   peek the CDataStore (opcode, size, payload)
+//    capture.smsg   SMSG framing: StreamReassembler over recv chunks
+//    filter         CapturePolicy::Decide with a production-like rule set
+//    timestamp      PacketCapture::NowMicros
+//    enqueue        PacketPipeline::Enqueue, no capture modes
+//    hook.cmsg      whole Send detour, rules installed
+//    hook.smsg      whole ARC4 + recv detours, rules installed
+//
+//  capture.smsg and the hook.* stages are net of the game's own
+//  work (stand-in Send, header decryption), measured the same way.
+//  Multi-threaded rows are wall time x min(threads, cores) / packets:
+//  cost per packet per core, contention included.  Each row is the
+//  median of --repeat timings (baseline and stage interleaved), on
+//  one producer pool per thread count.
+//
+//  Every row is checked against a budget file (flat JSON object,
+//  ns per packet), most specific key first:
+//    "stage/size/xT", "stage/xT", "stage/size", "stage"
+//  A row with no budget passes.  A row over budget is measured
+//  again and fails the suite only if it is over both times.  Rows
+//  with more threads than cores are reported but not gated.
+//
+//  Options:  --packets N      per timing (default 40000)
+//            --repeat N       timings per row (default 5)
+//            --sizes a,b,..   payload bytes (default 16,64,256,1024,4096)
+//            --threads a,b,.. producer threads (default 1,2,4)
+//            --budgets PATH   or "none" (default: the checked-in file)
+//            --json PATH      also write the results as JSON
+// ============================================================
+
+#ifndef PACKETGOD_BENCH_BUDGETS
+#define PACKETGOD_BENCH_BUDGETS "tools/bench/overhead_budgets.json"
+#endif
+
+// ============================================================
+//  Stand-ins for the game side
+// ============================================================
+
+struct GameSend
+{
+    static int __thiscall Send(WowConnection*, CDataStore* packet, int)
+    {
+        return static_cast<int>(packet->m_size & 1);
+    }
+};
+
+using SendFn = int(__thiscall*)(WowConnection*, CDataStore*, int);
+static SendFn volatile s_origSend = &GameSend::Send;   // volatile: keep the call a real call
+
+static const uint16_t kCmsgMix[] = { CMSG_PING, CMSG_MESSAGECHAT, CMSG_NAME_QUERY, CMSG_TIME_SYNC_RESP };
+static const uint16_t kSmsgMix[] = { SMSG_PONG, SMSG_MESSAGECHAT, SMSG_TIME_SYNC_REQ, SMSG_ITEM_QUERY_SINGLE_RESPONSE };
+static constexpr uint32_t kMix   = 4;
+
+static constexpr uint32_t kRecvChunk = 8192;   // bytes per simulated recv()
+
+static volatile uint64_t s_observe = 0;        // stage results land here
+
+// Capture modes a user would typically run with: one opcode each
+// metadata-only, sampled and snapped, plus a block rule.
+static std::vector<FilterRule> ProductionRules()
+{
+    std::vector<FilterRule> rules(4);
+    rules[0].enabled = true; rules[0].opcode = CMSG_NAME_QUERY; rules[0].matchAny = false;
+    rules[0].direction = PacketDirection::CMSG; rules[0].mode = CaptureMode::Metadata;
+    rules[1].enabled = true; rules[1].opcode = SMSG_PONG; rules[1].matchAny = false;
+    rules[1].direction = PacketDirection::SMSG; rules[1].mode = CaptureMode::SampleEvery; rules[1].param = 4;
+    rules[2].enabled = true; rules[2].opcode = SMSG_MESSAGECHAT; rules[2].matchAny = false;
+    rules[2].direction = PacketDirection::SMSG; rules[2].mode = CaptureMode::Snaplen; rules[2].param = 64;
+    rules[3].enabled = true; rules[3].opcode = CMSG_BOOTME; rules[3].blockPacket = true;
+    return rules;
+}
+
+// ============================================================
+//  Per-thread state
+// ============================================================
+
+struct Producer
+{
+    // CMSG: one CDataStore per mix opcode, [4] opcode LE + payload
+    std::vector<uint8_t> sendBuf[kMix];
+    CDataStore           store[kMix];
+
+    // SMSG: a round of plaintext packets, re-encrypted into `recv` before each round
+    std::vector<uint8_t>  plain;
+    std::vector<uint32_t> offsets;      // header offset of each packet in `plain`
+    std::vector<uint8_t>  recv;
+    Arc4                  server;
+    Arc4                  client;       // plays SARC4State: decrypts headers in place
+    StreamReassembler     stream;
+
+    uint64_t sink = 0;                  // defeats dead-code elimination
+
+    void Build(uint32_t size, uint32_t perRound)
+    {
+        for (uint32_t k = 0; k < kMix; ++k)
+        {
+            sendBuf[k].assign(4 + size, 0);
+            sendBuf[k][0] = static_cast<uint8_t>(kCmsgMix[k]);
+            sendBuf[k][1] = static_cast<uint8_t>(kCmsgMix[k] >> 8);
+            for (uint32_t b = 0; b < size; ++b) sendBuf[k][4 + b] = static_cast<uint8_t>(b * 7 + k);
+            store[k] = CDataStore{};
+            store[k].m_buffer = sendBuf[k].data();
+            store[k].m_alloc  = static_cast<uint32_t>(sendBuf[k].size());
+            store[k].m_size   = static_cast<uint32_t>(sendBuf[k].size());
+        }
+
+        plain.clear();
+        offsets.clear();
+        for (uint32_t i = 0; i < perRound; ++i)
+        {
+            const uint16_t op = kSmsgMix[i % kMix];
+            const uint32_t sf = size + 2;   // size field counts the opcode
+            offsets.push_back(static_cast<uint32_t>(plain.size()));
+            if (sf > 0x7FFF)
+            {
+                plain.push_back(static_cast<uint8_t>(0x80 | (sf >> 16)));
+                plain.push_back(static_cast<uint8_t>(sf >> 8));
+                plain.push_back(static_cast<uint8_t>(sf));
+            }
+            else
+            {
+                plain.push_back(static_cast<uint8_t>(sf >> 8));
+                plain.push_back(static_cast<uint8_t>(sf));
+            }
+            plain.push_back(static_cast<uint8_t>(op));
+            plain.push_back(static_cast<uint8_t>(op >> 8));
+            for (uint32_t b = 0; b < size; ++b) plain.push_back(static_cast<uint8_t>(b + i));
+        }
+        recv.assign(plain.size(), 0);
+
+        static const uint8_t kKey[20] = { 0x51, 0xA0, 0x3C, 0x9E, 0x07, 0x62, 0xD4, 0x18, 0xBB, 0x2F,
+                                          0x70, 0xC5, 0x8A, 0x13, 0xE9, 0x46, 0x2D, 0xF1, 0x95, 0x0C };
+        server.Init(kKey, sizeof(kKey), 1024);
+        client.Init(kKey, sizeof(kKey), 1024);
+        stream.Reset();
+    }
+
+    // Untimed: what the server put on the wire for this round.
+    void Encrypt(uint32_t count)
+    {
+        memcpy(recv.data(), plain.data(), recv.size());
+        for (uint32_t i = 0; i < count; ++i)
+            server.Process(&recv[offsets[i]], StreamReassembler::HeaderLength(recv[offsets[i]]));
+    }
+
+    uint32_t RecvBytes(uint32_t count) const
+    {
+        return count < offsets.size() ? offsets[count] : static_cast<uint32_t>(recv.size());
+    }
+};
+
+// ============================================================
+//  Stage bodies — each runs `count` packets on one producer
+// ============================================================
+
+enum class Stage { CaptureCmsg, CaptureSmsg, Filter, Timestamp, Enqueue, HookCmsg, HookSmsg, Count };
+
+static const char* const kStageNames[] = {
+    "capture.cmsg", "capture.smsg", "filter", "timestamp", "enqueue", "hook.cmsg", "hook.smsg",
+};
+
+static bool UsesPipeline(Stage s) { return s == Stage::Enqueue || s == Stage::HookCmsg || s == Stage::HookSmsg; }
+static bool IsSmsg(Stage s)       { return s == Stage::CaptureSmsg || s == Stage::HookSmsg; }
+
+// The Send detour without __try / IsReadable (Win32 only; both are
+// a few instructions on the success path).
+static void SendBody(Producer& p, CDataStore* packet, bool enqueue)
+{
+    uint16_t       opcode     = 0;
+    uint32_t       payloadLen = 0;
+    const uint8_t* payloadPtr = nullptr;
+    bool           safe       = false;
+    if (packet && packet->m_buffer && packet->m_size >= 4)
+    {
+        if (PacketRewriter::IsActive())
+            PacketRewriter::Apply(packet->m_buffer, packet->m_size, packet->m_alloc);
+        opcode     = static_cast<uint16_t>(packet->m_buffer[0] | (packet->m_buffer[1] << 8));
+        payloadLen = packet->m_size - 4;
+        payloadPtr = payloadLen ? packet->m_buffer + 4 : nullptr;
+        safe       = true;
+    }
+    if (safe)
+    {
+        if (enqueue)
+            PacketPipeline::Enqueue(PacketDirection::CMSG, opcode, payloadPtr, payloadLen, 1);
+        else
+            p.sink += opcode + payloadLen + (payloadPtr ? payloadPtr[0] : 0);
+    }
+}
+
+static void OnFramed(const SmsgView& pkt, void* user)
+{
+    static_cast<Producer*>(user)->sink += pkt.opcode + pkt.size;
+}
+
+static void OnFramedEnqueue(const SmsgView& pkt, void*)
+{
+    PacketPipeline::Enqueue(PacketDirection::SMSG, pkt.opcode, pkt.payload, pkt.size, 1);
+}
+
+// recv() chunks then header decryption, in the order the client does
+// them.  framing: run the Layer B / E detour bodies too.
+static void RecvBody(Producer& p, uint32_t count, bool framing, StreamReassembler::Sink sink)
+{
+    const uint32_t total   = p.RecvBytes(count);
+    uint32_t       recvEnd = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t off = p.offsets[i];
+        while (recvEnd < off + 5 && recvEnd < total)
+        {
+            const uint32_t n = (std::min)(kRecvChunk, total - recvEnd);
+            if (framing) p.stream.OnRecv(&p.recv[recvEnd], n, sink, &p);
+            recvEnd += n;
+        }
+        uint8_t* hdr = &p.recv[off];
+        p.client.Process(hdr, 1);
+        const uint32_t hlen = StreamReassembler::HeaderLength(hdr[0]);
+        p.client.Process(hdr + 1, hlen - 1);
+        if (framing)
+            p.stream.OnHeader(hdr, hlen, sink, &p);
+        else
+            p.sink += hdr[hlen - 2];
+    }
+    while (recvEnd < total)
+    {
+        const uint32_t n = (std::min)(kRecvChunk, total - recvEnd);
+        if (framing) p.stream.OnRecv(&p.recv[recvEnd], n, sink, &p);
+        recvEnd += n;
+    }
+}
+
+// baseline: the game-side share only (stand-in Send / decryption).
+static void RunStage(Stage stage, bool baseline, Producer& p, uint32_t count)
+{
+    switch (stage)
+    {
+    case Stage::CaptureCmsg:
+    case Stage::HookCmsg:
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            CDataStore* packet = &p.store[i % kMix];
+            if (!baseline) SendBody(p, packet, stage == Stage::HookCmsg);
+            p.sink += s_origSend(nullptr, packet, 0);
+        }
+        break;
+    case Stage::CaptureSmsg:
+        RecvBody(p, count, !baseline, &OnFramed);
+        break;
+    case Stage::HookSmsg:
+        RecvBody(p, count, !baseline, &OnFramedEnqueue);
+        break;
+    case Stage::Filter:
+    {
+        const uint64_t now = PacketCapture::NowMicros();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const bool     smsg = (i & 1) != 0;
+            const uint16_t op   = smsg ? kSmsgMix[(i >> 1) % kMix] : kCmsgMix[(i >> 1) % kMix];
+            uint32_t       keep = 0;
+            const uint32_t size = p.store[0].m_size - 4;
+            p.sink += CapturePolicy::Decide(smsg ? PacketDirection::SMSG : PacketDirection::CMSG, op, size, now, keep) + keep;
+        }
+        break;
+    }
+    case Stage::Timestamp:
+        for (uint32_t i = 0; i < count; ++i)
+            p.sink += PacketCapture::NowMicros();
+        break;
+    case Stage::Enqueue:
+    {
+        const uint8_t* payload = p.store[0].m_buffer + 4;
+        const uint32_t size    = p.store[0].m_size - 4;
+        for (uint32_t i = 0; i < count; ++i)
+            PacketPipeline::Enqueue(PacketDirection::CMSG, kCmsgMix[i % kMix], payload, size, 1);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// ============================================================
+//  Producer pool — one thread per producer, kept for every row
+//  of a thread count; Round() runs one stage round on all of them.
+// ============================================================
+
+class ProducerPool
+{
+public:
+    explicit ProducerPool(std::vector<Producer>& producers) : m_producers(producers)
+    {
+        const size_t n = producers.size();
+        m_t0.resize(n);
+        m_t1.resize(n);
+        for (size_t t = 0; t < n; ++t)
+            m_threads.emplace_back([this, t] { Worker(t); });
+    }
+
+    ~ProducerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_start.notify_all();
+        for (std::thread& th : m_threads) th.join();
+    }
+
+    // Wall seconds from the first producer starting to the last finishing.
+    double Round(Stage stage, bool baseline, uint32_t count)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stage    = stage;
+        m_baseline = baseline;
+        m_count    = count;
+        m_finished = 0;
+        ++m_generation;
+        m_start.notify_all();
+        m_done.wait(lock, [this] { return m_finished == m_threads.size(); });
+
+        const auto first = *std::min_element(m_t0.begin(), m_t0.end());
+        const auto last  = *std::max_element(m_t1.begin(), m_t1.end());
+        return std::chrono::duration<double>(last - first).count();
+    }
+
+private:
+    void Worker(size_t t)
+    {
+        uint64_t seen = 0;
+        for (;;)
+        {
+            Stage    stage;
+            bool     baseline;
+            uint32_t count;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_start.wait(lock, [&] { return m_quit || m_generation != seen; });
+                if (m_quit) return;
+                seen     = m_generation;
+                stage    = m_stage;
+                baseline = m_baseline;
+                count    = m_count;
+            }
+            m_t0[t] = Bench::Clock::now();
+            RunStage(stage, baseline, m_producers[t], count);
+            m_t1[t] = Bench::Clock::now();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_finished;
+            }
+            m_done.notify_one();
+        }
+    }
+
+    std::vector<Producer>&                m_producers;
+    std::vector<std::thread>              m_threads;
+    std::vector<Bench::Clock::time_point> m_t0, m_t1;
+    std::mutex                            m_mutex;
+    std::condition_variable               m_start, m_done;
+    uint64_t                              m_generation = 0;
+    size_t                                m_finished   = 0;
+    bool                                  m_quit       = false;
+    Stage                                 m_stage      = Stage::Timestamp;
+    bool                                  m_baseline   = false;
+    uint32_t                              m_count      = 0;
+};
+
+// ============================================================
+//  Rounds: producers run in lockstep, the ring is drained between
+//  rounds (untimed) so Enqueue never hits a full ring.
+// ============================================================
+
+static double TimeStage(Stage stage, bool baseline, ProducerPool& pool, std::vector<Producer>& producers,
+                        uint32_t perRound, uint64_t packets, unsigned cores)
+{
+    const uint32_t threads = static_cast<uint32_t>(producers.size());
+    double   seconds = 0;
+    uint64_t done    = 0;
+
+    while (done < packets)
+    {
+        if (IsSmsg(stage))
+            for (Producer& p : producers) p.Encrypt(perRound);
+
+        seconds += pool.Round(stage, baseline, perRound);
+        done    += static_cast<uint64_t>(perRound) * threads;
+
+        if (UsesPipeline(stage))
+            PacketPipeline::Drain();
+    }
+    return seconds * 1e9 * (std::min)(threads, cores) / static_cast<double>(done);
+}
+
+static double Median(std::vector<double>& v)
+{
+    std::sort(v.begin(), v.end());
+    const size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+struct Timing
+{
+    double ns;       // median stage time, net of the median baseline (may be < 0 within noise)
+    double baseNs;   // median baseline, 0 if none
+};
+
+// `repeats` baseline / stage timings, interleaved so drift hits both.
+static Timing TimeRow(Stage stage, bool hasBase, ProducerPool& pool, std::vector<Producer>& producers,
+                      uint32_t perRound, uint64_t packets, unsigned cores, uint32_t repeats)
+{
+    std::vector<double> base, total;
+    for (uint32_t i = 0; i < repeats; ++i)
+    {
+        if (hasBase) base.push_back(TimeStage(stage, true, pool, producers, perRound, packets, cores));
+        total.push_back(TimeStage(stage, false, pool, producers, perRound, packets, cores));
+    }
+    Timing t;
+    t.baseNs = hasBase ? Median(base) : 0.0;
+    t.ns     = Median(total) - t.baseNs;
+    return t;
+}
+
+// ============================================================
+//  Budgets — flat JSON object of "key": ns, strings ignored
+// ============================================================
+
+struct Budget
+{
+    std::string key;
+    double      ns;
+};
+
+static void SkipSpace(const char*& s) { while (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r') ++s; }
+
+static bool ParseString(const char*& s, std::string& out)
+{
+    if (*s != '"') return false;
+    out.clear();
+    for (++s; *s && *s != '"'; ++s)
+    {
+        if (*s == '\\' && s[1]) ++s;
+        out.push_back(*s);
+    }
+    if (*s != '"') return false;
+    ++s;
+    return true;
+}
+
+static bool ParseBudgets(const std::string& text, std::vector<Budget>& out, std::string& error)
+{
+    const char* s = text.c_str();
+    SkipSpace(s);
+    if (*s++ != '{') { error = "expected '{'"; return false; }
+    SkipSpace(s);
+    if (*s == '}') return true;
+    for (;;)
+    {
+        std::string key;
+        SkipSpace(s);
+        if (!ParseString(s, key)) { error = "expected a key"; return false; }
+        SkipSpace(s);
+        if (*s++ != ':') { error = "expected ':' after \"" + key + "\""; return false; }
+        SkipSpace(s);
+        if (*s == '"')
+        {
+            std::string ignored;
+            if (!ParseString(s, ignored)) { error = "unterminated string"; return false; }
+        }
+        else
+        {
+            char* end = nullptr;
+            const double ns = strtod(s, &end);
+            if (end == s) { error = "expected a number for \"" + key + "\""; return false; }
+            s = end;
+            out.push_back({ key, ns });
+        }
+        SkipSpace(s);
+        if (*s == ',') { ++s; continue; }
+        if (*s == '}') return true;
+        error = "expected ',' or '}'";
+        return false;
+    }
+}
+
+static bool LoadBudgets(const char* path, std::vector<Budget>& out)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+    {
+        printf("budgets: cannot open %s\n", path);
+        return false;
+    }
+    std::string text;
+    char chunk[4096];
+    while (size_t n = fread(chunk, 1, sizeof(chunk), f))
+        text.append(chunk, n);
+    fclose(f);
+
+    std::string error;
+    if (!ParseBudgets(text, out, error))
+    {
+        printf("budgets: %s: %s\n", path, error.c_str());
+        return false;
+    }
+    return true;
+}
+
+// < 0: no budget for the row.
+static double BudgetFor(const std::vector<Budget>& budgets, const char* stage, uint32_t size, bool sized, uint32_t threads)
+{
+    char keys[4][64];
+    int  n = 0;
+    if (sized) snprintf(keys[n++], sizeof(keys[0]), "%s/%u/x%u", stage, size, threads);
+    snprintf(keys[n++], sizeof(keys[0]), "%s/x%u", stage, threads);
+    if (sized) snprintf(keys[n++], sizeof(keys[0]), "%s/%u", stage, size);
+    snprintf(keys[n++], sizeof(keys[0]), "%s", stage);
+    for (int k = 0; k < n; ++k)
+        for (const Budget& b : budgets)
+            if (b.key == keys[k]) return b.ns;
+    return -1.0;
+}
+
+// ============================================================
+//  Suite
+// ============================================================
+
+struct Row
+{
+    Stage    stage;
+    uint32_t size;      // payload bytes; 0 for the timestamp stage
+    uint32_t threads;
+    double   ns;        // net of baseline where there is one
+    double   baseNs;    // game-side share, 0 if none
+    double   budget;    // < 0: none
+    bool     gated;     // false: more threads than cores, reported only
+    bool     pass;
+};
+
+static std::vector<uint32_t> ParseList(const char* s)
+{
+    std::vector<uint32_t> out;
+    while (*s)
+    {
+        char* end = nullptr;
+        const unsigned long v = strtoul(s, &end, 10);
+        if (end == s) break;
+        if (v) out.push_back(static_cast<uint32_t>(v));
+        s = *end == ',' ? end + 1 : end;
+    }
+    return out;
+}
+
+static bool WriteJson(const char* path, const std::vector<Row>& rows, uint64_t packets, uint32_t repeats,
+                      unsigned cores, bool pass)
+{
+    FILE* f = fopen(path, "w");
+    if (!f)
+    {
+        printf("json: cannot write %s\n", path);
+        return false;
+    }
+    fprintf(f, "{\n  \"suite\": \"overhead\",\n  \"version\": 1,\n");
+    fprintf(f, "  \"cores\": %u,\n  \"packets_per_timing\": %llu,\n  \"repeats\": %u,\n  \"pass\": %s,\n"
+               "  \"results\": [\n",
+            cores, static_cast<unsigned long long>(packets), repeats, pass ? "true" : "false");
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        const Row& r = rows[i];
+        fprintf(f, "    { \"stage\": \"%s\", \"size\": %u, \"threads\": %u, \"ns_per_packet\": %.2f, "
+                   "\"baseline_ns\": %.2f, \"gated\": %s, \"budget_ns\": ",
+                kStageNames[static_cast<int>(r.stage)], r.size, r.threads, r.ns, r.baseNs, r.gated ? "true" : "false");
+        if (r.budget >= 0) fprintf(f, "%.2f", r.budget); else fprintf(f, "null");
+        fprintf(f, ", \"pass\": %s }%s\n", r.pass ? "true" : "false", i + 1 < rows.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+int Bench::RunOverhead(int argc, char** argv)
+{
+    uint64_t              packets     = 40'000;
+    uint32_t              repeats     = 5;
+    std::vector<uint32_t> sizes       = { 16, 64, 256, 1024, 4096 };
+    std::vector<uint32_t> threadsList = { 1, 2, 4 };
+    const char*           budgetsPath = PACKETGOD_BENCH_BUDGETS;
+    const char*           jsonPath    = nullptr;
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if      (!strcmp(argv[i], "--packets")) packets     = strtoull(argv[i + 1], nullptr, 10);
+        else if (!strcmp(argv[i], "--repeat"))  repeats     = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (!strcmp(argv[i], "--sizes"))   sizes       = ParseList(argv[i + 1]);
+        else if (!strcmp(argv[i], "--threads")) threadsList = ParseList(argv[i + 1]);
+        else if (!strcmp(argv[i], "--budgets")) budgetsPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--json"))    jsonPath    = argv[i + 1];
+    }
+    if (!packets || !repeats || sizes.empty() || threadsList.empty())
+    {
+        printf("nothing to run\n");
+        return 2;
+    }
+
+    std::vector<Budget> budgets;
+    if (strcmp(budgetsPath, "none") != 0 && !LoadBudgets(budgetsPath, budgets))
+        return 1;
+
+    const unsigned cores = (std::max)(1u, std::thread::hardware_concurrency());
+    printf("cores %u, %llu packets per timing, median of %u, %zu budgets\n", cores,
+           static_cast<unsigned long long>(packets), repeats, budgets.size());
+
+    // The ring is allocated by Start(); rounds drain it on this thread.
+    PacketPipeline::Start();
+    PacketPipeline::Stop();
+    PacketRewriter::Clear();
+
+    const std::vector<FilterRule> rules = ProductionRules();
+    std::vector<Row> rows;
+    bool pass = true;
+
+    printf("%-13s %6s %3s %10s %10s %10s\n", "stage", "size", "thr", "ns/pkt", "game ns", "budget");
+    for (uint32_t threads : threadsList)
+    {
+        std::vector<Producer> producers(threads);
+        ProducerPool          pool(producers);
+        for (uint32_t size : sizes)
+        {
+            // Keep a round well inside the ring: threads x perRound records.
+            const size_t   rec      = PacketPipeline::kAlign + ((size + 4 + PacketPipeline::kAlign - 1) & ~(PacketPipeline::kAlign - 1));
+            const uint32_t perRound = static_cast<uint32_t>(std::clamp<size_t>(PacketPipeline::kRingBytes / 2 / (threads * rec), 16, 256));
+
+            for (Producer& p : producers) p.Build(size, perRound);
+
+            for (int s = 0; s < static_cast<int>(Stage::Count); ++s)
+            {
+                const Stage stage = static_cast<Stage>(s);
+                const bool  sized = stage != Stage::Timestamp;
+                if (!sized && size != sizes.front()) continue;
+
+                const bool withRules = stage == Stage::Filter || stage == Stage::HookCmsg || stage == Stage::HookSmsg;
+                if (withRules) PacketCapture::SetFilters(rules);
+                else           PacketCapture::ClearFilters();
+
+                const bool hasBase = stage == Stage::CaptureCmsg || stage == Stage::CaptureSmsg ||
+                                     stage == Stage::HookCmsg   || stage == Stage::HookSmsg;
+                Timing t = TimeRow(stage, hasBase, pool, producers, perRound, packets, cores, repeats);
+
+                Row r;
+                r.stage   = stage;
+                r.size    = sized ? size : 0;
+                r.threads = threads;
+                r.budget  = BudgetFor(budgets, kStageNames[s], size, sized, threads);
+                r.gated   = r.budget >= 0 && threads <= cores;
+                if (r.gated && t.ns > r.budget)
+                {
+                    // Confirm before failing: one noisy row is not a regression.
+                    const Timing again = TimeRow(stage, hasBase, pool, producers, perRound, packets, cores, repeats);
+                    if (again.ns < t.ns) t = again;
+                }
+                r.ns      = t.ns;
+                r.baseNs  = t.baseNs;
+                r.pass    = !r.gated || r.ns <= r.budget;
+                pass     &= r.pass;
+                rows.push_back(r);
+
+                char budgetStr[24] = "-";
+                if (r.budget >= 0) snprintf(budgetStr, sizeof(budgetStr), "%.0f", r.budget);
+                printf("%-13s %6u %3u %10.1f %10.1f %10s%s\n", kStageNames[s], r.size, threads, r.ns, r.baseNs,
+                       budgetStr, !r.pass ? "  OVER BUDGET" : r.budget >= 0 && !r.gated ? "  (threads > cores, not gated)" : "");
+            }
+
+            for (const Producer& p : producers) s_observe = s_observe + p.sink;
+        }
+    }
+    PacketCapture::ClearFilters();
+    PacketCapture::Clear();
+
+    const PipelineStats st = PacketPipeline::Stats();
+    printf("pipeline           : %llu enqueued, %llu dropped (ring full), %llu dropped (large)\n",
+           static_cast<unsigned long long>(st.enqueued), static_cast<unsigned long long>(st.droppedFull),
+           static_cast<unsigned long long>(st.droppedLarge));
+    if (st.droppedFull)
+    {
+        printf("FAIL: ring filled during timing\n");
+        pass = false;
+    }
+
+    if (jsonPath && !WriteJson(jsonPath, rows, packets, repeats, cores, pass))
+        return 1;
+    printf("budgets            : %s\n", pass ? "ok" : "EXCEEDED");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+#include "Bench.h"
+#include "packet/PacketReplay.h"
+#include "packet/CaptureFile.h"
+#include "Opcodes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================
+//  Replay harness — PacketReplay against a recording Send
+//
+//  The stand-in WowConnection::Send records, per call, the time,
+//  the target connection, the calling lane (replay thread) and
+//  the exact CDataStore bytes.  Each run is compared with the
+//  source capture:
+//    bytes      every replayable packet, opcode + payload, in order,
+//               on the connection the resolver maps it to
+//    timing     send offset vs capture offset / speed, distribution
+//               of the error (ReplayTimed)
+//    cancel     concurrent replays stopped by Cancel(): latency, and
+//               what was sent is an exact prefix of each sequence
+//    saved      the capture through a .pgcap file: wire sizes kept,
+//               so packets stored truncated are still refused
+//
+//  Options:  --packets N      sequence length (default 100000)
+//            --speeds a,b,..  ReplayTimed multipliers (default 10,100,1000,0;
+//                             0 = back to back)
+// ============================================================
+
+// ============================================================
+//  Recording Send
+// ============================================================
+
+struct SendRecord
+{
+    int64_t        ns;        // since s_epoch
+    WowConnection* conn;
+    uint32_t       lane;
+    uint32_t       offset;    // into s_bytes
+    uint32_t       size;
+};
+
+static std::mutex              s_recMutex;
+static std::vector<SendRecord> s_records;
+static std::vector<uint8_t>    s_bytes;
+static Bench::Clock::time_point s_epoch;
+static thread_local uint32_t   t_lane = 0;
+
+struct RecordingSend
+{
+    static int __thiscall Send(WowConnection* conn, CDataStore* packet, int)
+    {
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Bench::Clock::now() - s_epoch).count();
+        std::lock_guard<std::mutex> lk(s_recMutex);
+        s_records.push_back({ ns, conn, t_lane, static_cast<uint32_t>(s_bytes.size()), packet->m_size });
+        s_bytes.insert(s_bytes.end(), packet->m_buffer, packet->m_buffer + packet->m_size);
+        return 1;
+    }
+};
+
+static void ResetRecorder(size_t expectRecords, size_t expectBytes)
+{
+    s_records.clear();
+    s_bytes.clear();
+    s_records.reserve(expectRecords);
+    s_bytes.reserve(expectBytes);
+    s_epoch = Bench::Clock::now();
+}
+
+// Connection ids 0..3 map to distinct fake connections; others have none.
+static uint8_t s_conns[4];
+
+static WowConnection* Resolve(uint8_t connection)
+{
+    return connection < 4 ? reinterpret_cast<WowConnection*>(&s_conns[connection]) : nullptr;
+}
+
+// ============================================================
+//  Source capture
+//
+//  Mostly short CMSGs in bursts of a few to a few tens of
+//  microseconds with an idle gap every 32 packets; SMSGs, packets
+//  stored truncated and packets on an unmapped connection are
+//  mixed in to exercise skip / fail accounting.
+// ============================================================
+
+static std::vector<CapturedPacket> SyntheticCapture(uint32_t count, uint32_t seed)
+{
+    static const uint16_t kOps[] = { CMSG_PING, CMSG_MESSAGECHAT, CMSG_NAME_QUERY, MSG_MOVE_HEARTBEAT, CMSG_TIME_SYNC_RESP };
+
+    Bench::CaptureShape shape;
+    shape.seed        = seed;
+    shape.cmsgOf16    = 16;
+    shape.opcodes     = kOps;
+    shape.opcodeCount = 5;
+    shape.firstSeq    = 1;
+    shape.startUs     = 1'000'000;
+    shape.gapUs       = 0;             // bursts
+    shape.minPayload  = 4;
+    shape.maxPayload  = 263;
+    shape.snapEvery   = 211;           // snapped: not replayable
+    std::vector<CapturedPacket> out = Bench::MakeCapture(count, shape);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (i % 97 == 50)  out[i].direction  = PacketDirection::SMSG;
+        if (i % 503 == 11) out[i].connection = 9;   // no target: counted as failed
+    }
+    return out;
+}
+
+static bool Replayable(const CapturedPacket& p)
+{
+    return p.direction == PacketDirection::CMSG && !p.Truncated();
+}
+
+// ============================================================
+//  Checks
+// ============================================================
+
+// Records of `lane` must be the first N replayable, routable packets
+// of `src`, byte for byte.  Returns N, or -1 (reported) on mismatch.
+static long MatchPrefix(const std::vector<CapturedPacket>& src, uint32_t lane, const char* what)
+{
+    size_t next = 0;
+    long   n    = 0;
+    for (const SendRecord& r : s_records)
+    {
+        if (r.lane != lane) continue;
+        while (next < src.size() && !(Replayable(src[next]) && Resolve(src[next].connection))) ++next;
+        if (next == src.size())
+        {
+            printf("FAIL: %s: lane %u sent more packets than the capture holds\n", what, lane);
+            return -1;
+        }
+        const CapturedPacket& p = src[next++];
+        const uint8_t* b = &s_bytes[r.offset];
+        const bool same = r.conn == Resolve(p.connection) && r.size == 4 + p.payload.size() &&
+                          b[0] == (p.opcode & 0xFF) && b[1] == (p.opcode >> 8) && b[2] == 0 && b[3] == 0 &&
+                          memcmp(b + 4, p.payload.data(), p.payload.size()) == 0;
+        if (!same)
+        {
+            printf("FAIL: %s: lane %u packet %ld (seq %llu) differs from the capture\n", what, lane, n,
+                   static_cast<unsigned long long>(p.seq));
+            return -1;
+        }
+        ++n;
+    }
+    return n;
+}
+
+struct Expected { uint32_t sent = 0, failed = 0, skipped = 0; };
+
+static Expected Expect(const std::vector<CapturedPacket>& src)
+{
+    Expected e;
+    for (const CapturedPacket& p : src)
+    {
+        if (!Replayable(p))               ++e.skipped;
+        else if (!Resolve(p.connection))  ++e.failed;
+        else                              ++e.sent;
+    }
+    return e;
+}
+
+static double Percentile(std::vector<double>& v, double q)
+{
+    if (v.empty()) return 0;
+    const size_t k = static_cast<size_t>(q * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+// Send offset vs scheduled offset for each record, in microseconds
+// (positive = late).  Offsets are relative to the first send.
+static void TimingError(const std::vector<CapturedPacket>& src, double speed)
+{
+    std::vector<double> err;
+    err.reserve(s_records.size());
+    size_t next = 0;
+    double first = -1, base = 0;
+    for (const SendRecord& r : s_records)
+    {
+        while (next < src.size() && !(Replayable(src[next]) && Resolve(src[next].connection))) ++next;
+        const CapturedPacket& p = src[next++];
+        const double sched = static_cast<double>(p.timestamp_us - src.front().timestamp_us) / speed;
+        if (first < 0) { first = r.ns / 1000.0; base = sched; }
+        err.push_back((r.ns / 1000.0 - first) - (sched - base));
+    }
+    if (err.empty()) return;
+
+    double sum = 0;
+    for (double e : err) sum += e;
+    const double mean = sum / err.size();
+    std::vector<double> absErr(err.size());
+    for (size_t i = 0; i < err.size(); ++i) absErr[i] = std::fabs(err[i]);
+    const double p50 = Percentile(absErr, 0.50), p90 = Percentile(absErr, 0.90), p99 = Percentile(absErr, 0.99);
+    const double mx  = *std::max_element(absErr.begin(), absErr.end());
+    printf("  timing |err| us   : p50 %.1f  p90 %.1f  p99 %.1f  max %.1f  (mean signed %+.1f)\n",
+           p50, p90, p99, mx, mean);
+}
+
+// ============================================================
+//  Runs
+// ============================================================
+
+static bool RunSpeed(const std::vector<CapturedPacket>& src, double speed, const Expected& exp, size_t bytes)
+{
+    ResetRecorder(exp.sent, bytes);
+    const auto t0 = Bench::Clock::now();
+    const ReplayResult res = PacketReplay::ReplayTimed(src, speed);
+    const double secs = Bench::SecondsSince(t0);
+
+    const double spanUs = static_cast<double>(src.back().timestamp_us - src.front().timestamp_us);
+    if (speed > 0)
+        printf("speed %-7gx       : %u sent in %.3f s (schedule %.3f s), %.0f ns/packet\n",
+               speed, res.sent, secs, spanUs / speed / 1e6, secs * 1e9 / (std::max)(res.sent, 1u));
+    else
+        printf("back to back      : %u sent in %.3f s, %.0f ns/packet\n",
+               res.sent, secs, secs * 1e9 / (std::max)(res.sent, 1u));
+
+    bool ok = true;
+    if (res.sent != exp.sent || res.failed != exp.failed || res.skipped != exp.skipped || res.cancelled)
+    {
+        printf("FAIL: counts sent %u/%u failed %u/%u skipped %u/%u%s\n", res.sent, exp.sent,
+               res.failed, exp.failed, res.skipped, exp.skipped, res.cancelled ? " (cancelled)" : "");
+        ok = false;
+    }
+    if (MatchPrefix(src, 0, "replay") != static_cast<long>(exp.sent))
+        ok = false;
+    if (ok && speed > 0)
+        TimingError(src, speed);
+    return ok;
+}
+
+static bool RunSaved(const std::vector<CapturedPacket>& src, const Expected& exp, size_t bytes)
+{
+    const char* path = "replay_bench.pgcap";
+    std::vector<CapturedPacket> loaded;
+    const bool io = CaptureFile::Save(path, src) && CaptureFile::Load(path, loaded);
+    remove(path);
+
+    size_t same = 0, truncated = 0;
+    for (size_t i = 0; io && i < src.size() && i < loaded.size(); ++i)
+    {
+        same      += loaded[i].size == src[i].size && loaded[i].payload == src[i].payload;
+        truncated += loaded[i].Truncated();
+    }
+    bool ok = io && loaded.size() == src.size() && same == src.size();
+
+    ResetRecorder(exp.sent, bytes);
+    const ReplayResult res = PacketReplay::ReplayTimed(loaded, 0);
+    ok &= res.sent == exp.sent && res.skipped == exp.skipped && MatchPrefix(src, 0, "saved") == static_cast<long>(exp.sent);
+    printf("saved capture     : %zu / %zu packets intact, %zu truncated, %u sent, %u skipped  %s\n", same, src.size(),
+           truncated, res.sent, res.skipped, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool RunCancel(const std::vector<CapturedPacket>& src, uint32_t lanes, size_t bytes)
+{
+    ResetRecorder(src.size(), bytes);
+    std::vector<ReplayResult> results(lanes);
+    std::vector<std::thread>  pool;
+    for (uint32_t l = 0; l < lanes; ++l)
+        pool.emplace_back([&, l] {
+            t_lane = l + 1;
+            results[l] = PacketReplay::ReplayTimed(src, 1.0);   // would take the whole capture span
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto t0 = Bench::Clock::now();
+    PacketReplay::Cancel();
+    for (auto& th : pool) th.join();
+    const double latencyMs = Bench::SecondsSince(t0) * 1e3;
+
+    bool ok = latencyMs < 100.0;
+    uint32_t sent = 0;
+    for (uint32_t l = 0; l < lanes; ++l)
+    {
+        const long n = MatchPrefix(src, l + 1, "cancel");
+        sent += results[l].sent;
+        if (!results[l].cancelled || n < 0 || static_cast<uint32_t>(n) != results[l].sent)
+        {
+            printf("FAIL: cancel lane %u: cancelled %d, sent %u, prefix %ld\n", l + 1,
+                   results[l].cancelled, results[l].sent, n);
+            ok = false;
+        }
+    }
+    printf("cancel x%u         : all stopped %.2f ms after Cancel(), %u packets sent before%s\n",
+           lanes, latencyMs, sent, latencyMs < 100.0 ? "" : "  (SLOW)");
+
+    // A Cancel() that predates a replay does not affect it.
+    std::vector<CapturedPacket> head(src.begin(), src.begin() + (std::min)(src.size(), size_t{ 1000 }));
+    ResetRecorder(head.size(), bytes);
+    const ReplayResult after = PacketReplay::ReplayTimed(head, 0);
+    if (after.cancelled || after.sent != Expect(head).sent)
+    {
+        printf("FAIL: replay after Cancel() did not run to completion\n");
+        ok = false;
+    }
+    return ok;
+}
+
+// ============================================================
+//  Suite
+// ============================================================
+
+static std::vector<double> ParseSpeeds(const char* s)
+{
+    std::vector<double> out;
+    while (*s)
+    {
+        char* end = nullptr;
+        const double v = strtod(s, &end);
+        if (end == s) break;
+        out.push_back(v);
+        s = *end == ',' ? end + 1 : end;
+    }
+    return out;
+}
+
+int Bench::RunReplay(int argc, char** argv)
+{
+    uint32_t            packets = 100'000;
+    std::vector<double> speeds  = { 10, 100, 1000, 0 };
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if      (!strcmp(argv[i], "--packets")) packets = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (!strcmp(argv[i], "--speeds"))  speeds  = ParseSpeeds(argv[i + 1]);
+    }
+    if (packets < 2)
+    {
+        printf("nothing to run\n");
+        return 2;
+    }
+
+    PacketReplay::SetSendFn(&RecordingSend::Send, nullptr);
+    PacketReplay::SetTargetResolver(&Resolve);
+
+    const std::vector<CapturedPacket> src = SyntheticCapture(packets, 0x5EED);
+    const Expected exp = Expect(src);
+    size_t bytes = 0;
+    for (const CapturedPacket& p : src) bytes += 4 + p.payload.size();
+    printf("capture           : %u packets over %.2f s, %u replayable, %u skipped, %u without target\n",
+           packets, (src.back().timestamp_us - src.front().timestamp_us) / 1e6, exp.sent, exp.skipped, exp.failed);
+
+    bool ok = true;
+
+    // 1x on a short slice: the full sequence would take as long as it did live.
+    std::vector<CapturedPacket> slice(src.begin(), src.begin() + (std::min)(packets, 2000u));
+    ok &= RunSpeed(slice, 1.0, Expect(slice), bytes);
+    for (double speed : speeds)
+        ok &= RunSpeed(src, speed, exp, bytes);
+
+    // ReplaySequence: same bytes, same order.
+    ResetRecorder(exp.sent, bytes);
+    const auto t0 = Clock::now();
+    const bool seqOk = PacketReplay::ReplaySequence(src, 0);
+    printf("ReplaySequence    : %.0f ns/packet\n", Bench::SecondsSince(t0) * 1e9 / (std::max)(exp.sent, 1u));
+    // False when any CMSG could not be sent, truncated ones included.
+    const bool seqExpect = exp.failed == 0 &&
+        std::none_of(src.begin(), src.end(), [](const CapturedPacket& p) {
+            return p.direction == PacketDirection::CMSG && p.Truncated();
+        });
+    if (seqOk != seqExpect || MatchPrefix(src, 0, "sequence") != static_cast<long>(exp.sent))
+    {
+        printf("FAIL: ReplaySequence\n");
+        ok = false;
+    }
+
+    ok &= RunSaved(src, exp, bytes);
+    ok &= RunCancel(src, 1, bytes);
+    ok &= RunCancel(src, 4, bytes);
+
+    PacketReplay::SetTargetResolver(nullptr);
+    PacketReplay::SetSendFn(nullptr, nullptr);
+    printf("replay            : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
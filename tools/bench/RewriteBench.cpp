@@ -0,0 +1,158 @@
+#include "Bench.h"
+#include "packet/PacketRewriter.h"
+#include "Opcodes.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ============================================================
+//  Rule set — parsed from the text form, as the UI would
+// ============================================================
+
+static const char* kRules =
+    "# chat: force language 0 on say, pad short messages\n"
+    "lang:  CMSG_MESSAGECHAT if u32 @0 == 1 -> u32 @4 = 0\n"
+    "pad:   CMSG_MESSAGECHAT if size < 16 -> resize 16 fill 0x20\n"
+    "guid:  CMSG_NAME_QUERY if u32 @0 & 0xF000 == 0x1000 -> u32 @4 = 0xF1300000\n"
+    "swap:  CMSG_NAME_QUERY if u8 @0 == 0xFF -> opcode = CMSG_BOOTME\n"
+    "blob:  CMSG_UPDATE_ACCOUNT_DATA -> insert @12 \"DE AD\"; erase @12 2; bytes @0 = \"07 00 00 00\"\n";
+
+struct Case
+{
+    const char*          name;
+    uint16_t             opcode;
+    std::vector<uint8_t> payload;
+};
+
+using Bench::PutU32;
+using Bench::GetU32;
+
+// Build [4] opcode LE + payload into `buf`, return the size.
+static uint32_t Load(uint8_t* buf, const Case& c)
+{
+    memset(buf, 0, 4);
+    buf[0] = static_cast<uint8_t>(c.opcode);
+    buf[1] = static_cast<uint8_t>(c.opcode >> 8);
+    memcpy(buf + 4, c.payload.data(), c.payload.size());
+    return static_cast<uint32_t>(4 + c.payload.size());
+}
+
+// ============================================================
+//  Semantics — every rule kind, checked once before timing
+// ============================================================
+
+static bool Validate(const std::vector<Case>& cases)
+{
+    uint8_t  buf[512];
+    bool     ok = true;
+    auto expect = [&](bool cond, const char* what) { if (!cond) { printf("FAIL: %s\n", what); ok = false; } };
+
+    // say: language rewritten, 35-byte payload left at its size
+    uint32_t size = Load(buf, cases[1]);
+    expect(PacketRewriter::Apply(buf, size, sizeof(buf)), "chat say rewritten");
+    expect(GetU32(buf + 8) == 0 && size == 4 + cases[1].payload.size(), "chat language / size");
+
+    // short whisper: not a say, padded to 16 with spaces
+    size = Load(buf, cases[2]);
+    expect(PacketRewriter::Apply(buf, size, sizeof(buf)), "short chat padded");
+    expect(size == 20 && buf[4 + 15] == 0x20 && GetU32(buf + 8) == 7, "pad size / fill / untouched language");
+
+    // padding never exceeds capacity
+    size = Load(buf, cases[2]);
+    expect(!PacketRewriter::Apply(buf, size, size + 4) && size == 4 + cases[2].payload.size(), "resize capped by capacity");
+
+    // name query: masked guid match, then opcode swap
+    size = Load(buf, cases[3]);
+    expect(PacketRewriter::Apply(buf, size, sizeof(buf)) && GetU32(buf + 8) == 0xF1300000, "guid high rewritten");
+    size = Load(buf, cases[4]);
+    expect(PacketRewriter::Apply(buf, size, sizeof(buf)) && (buf[0] | (buf[1] << 8)) == CMSG_BOOTME, "opcode substituted");
+
+    // blob: insert + erase cancel out, header bytes overwritten
+    size = Load(buf, cases[5]);
+    expect(PacketRewriter::Apply(buf, size, sizeof(buf)), "blob rewritten");
+    expect(size == 4 + cases[5].payload.size() && GetU32(buf + 4) == 7
+           && memcmp(buf + 16, cases[5].payload.data() + 12, cases[5].payload.size() - 12) == 0, "blob insert/erase/bytes");
+
+    // opcode without rules is untouched
+    size = Load(buf, cases[0]);
+    expect(!PacketRewriter::Apply(buf, size, sizeof(buf)) && memcmp(buf + 4, cases[0].payload.data(), cases[0].payload.size()) == 0,
+           "unruled opcode untouched");
+    return ok;
+}
+
+// ============================================================
+//  Suite
+// ============================================================
+
+int Bench::RunRewrite(int argc, char** argv)
+{
+    uint32_t iterations = 5'000'000;
+    for (int i = 0; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--iterations")) iterations = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+
+    std::vector<Case> cases(6);
+    cases[0] = { "no rules (CMSG_PING)", CMSG_PING, {} };
+    PutU32(cases[0].payload, 42); PutU32(cases[0].payload, 80);
+
+    cases[1] = { "chat say (match)", CMSG_MESSAGECHAT, {} };
+    PutU32(cases[1].payload, 1); PutU32(cases[1].payload, 7);
+    const char text[] = "hello from the benchmark..";
+    cases[1].payload.insert(cases[1].payload.end(), text, text + sizeof(text));
+
+    cases[2] = { "chat short (pad)", CMSG_MESSAGECHAT, {} };
+    PutU32(cases[2].payload, 6); PutU32(cases[2].payload, 7); cases[2].payload.push_back(0);
+
+    cases[3] = { "name query (mask)", CMSG_NAME_QUERY, {} };
+    PutU32(cases[3].payload, 0x1234); PutU32(cases[3].payload, 0);
+
+    cases[4] = { "name query (swap)", CMSG_NAME_QUERY, {} };
+    PutU32(cases[4].payload, 0x20FF); PutU32(cases[4].payload, 0);
+
+    cases[5] = { "account blob (4 ops)", CMSG_UPDATE_ACCOUNT_DATA, {} };
+    PutU32(cases[5].payload, 3); PutU32(cases[5].payload, 1700000000u); PutU32(cases[5].payload, 200);
+    for (uint32_t b = 0; b < 200; ++b) cases[5].payload.push_back(static_cast<uint8_t>(b * 31));
+
+    std::string error;
+    if (!PacketRewriter::InstallText(kRules, error))
+    {
+        printf("install failed: %s\n", error.c_str());
+        return 1;
+    }
+    printf("rules installed    : %zu\n", PacketRewriter::Rules().size());
+
+    const bool ok = Validate(cases);
+    printf("semantics          : %s\n", ok ? "ok" : "FAILED");
+
+    // Timing reloads the buffer each iteration; subtract that baseline.
+    uint8_t buf[512];
+    for (const Case& c : cases)
+    {
+        volatile uint32_t sink = 0;
+        auto t0 = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+            sink = sink + Load(buf, c) + buf[4];
+        const double base = SecondsSince(t0);
+
+        PacketRewriter::ResetStats();
+        t0 = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            uint32_t size = Load(buf, c);
+            PacketRewriter::Apply(buf, size, sizeof(buf));
+            sink = sink + size + buf[4];
+        }
+        const double secs = SecondsSince(t0) - base;
+        const RewriteStats st = PacketRewriter::Stats();
+        printf("%-21s: %7.1f ns/pkt   (%llu rewritten, in-hook avg %.1f ns, max %llu ns)\n",
+               c.name, secs > 0 ? secs * 1e9 / iterations : 0.0,
+               static_cast<unsigned long long>(st.rewritten),
+               st.timed ? static_cast<double>(st.totalNs) / st.timed : 0.0,
+               static_cast<unsigned long long>(st.maxNs));
+    }
+
+    PacketRewriter::Clear();
+    return ok ? 0 : 1;
+}
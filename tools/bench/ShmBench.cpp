@@ -0,0 +1,248 @@
+#include "Bench.h"
+#include "ipc/ShmRing.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// ============================================================
+//  Shared-memory ring — one writer process, several readers
+//
+//  The writer and the readers are forked processes sharing only
+//  the named ring.  The writer appends seqs 1..N; every 97th is
+//  too large for the ring (dropped), every 13th is stored
+//  snapped.  Each reader checks what it gets:
+//    - seqs strictly increase, oversize ones never appear
+//    - payload bytes and wire size match the seq (validated views)
+//    - appended seqs are only missing across an overrun or a torn view
+//    - it ends at seq N
+//  A late reader opens the ring at once but reads only after the
+//  writer is done: exactly one overrun, losing exactly the bytes
+//  before tail.  The header must report N records and the
+//  oversize drops.  Last, a writer that dies holding the seqlock
+//  must make Next() give up (stale) instead of spinning forever.
+//
+//  Options:  --records N   (default 20000)
+//            --readers N   fast readers (default 3)
+//            --ring KiB    data area (default 64)
+// ============================================================
+
+#ifdef _WIN32
+
+int Bench::RunShm(int, char**)
+{
+    printf("shm               : skipped (needs fork)\n");
+    return 0;
+}
+
+#else
+
+static bool     Oversize(uint64_t seq) { return seq % 97 == 0; }
+static bool     Snapped(uint64_t seq)  { return seq % 13 == 0; }
+static uint32_t PayloadSize(uint64_t seq, uint32_t ring) { return Oversize(seq) ? ring / 4 : 16 + uint32_t(seq * 37 % 400); }
+static uint8_t  PayloadByte(uint64_t seq, uint32_t i)    { return uint8_t(seq * 131 + i); }
+
+// Appended (non-oversize) seqs in (a, b).
+static uint64_t AppendedBetween(uint64_t a, uint64_t b)
+{
+    if (b <= a + 1) return 0;
+    return (b - a - 1) - ((b - 1) / 97 - a / 97);
+}
+
+static void WaitByte(int fd)  { char c; while (read(fd, &c, 1) < 0) {} }
+static void SendByte(int fd)  { const char c = 1; while (write(fd, &c, 1) < 0) {} }
+
+// Child: create the ring, wait for `go`, append, wait for `quit`.
+static int Writer(const char* name, uint32_t ring, uint64_t records, int ready, int go, int quit)
+{
+    ShmRingWriter w;
+    if (!w.Create(name, ring, static_cast<uint32_t>(getpid()))) return 1;
+    SendByte(ready);
+    WaitByte(go);
+
+    std::vector<uint8_t> payload(ring / 4);
+    for (uint64_t seq = 1; seq <= records; ++seq)
+    {
+        const uint32_t size = PayloadSize(seq, ring);
+        for (uint32_t i = 0; i < size; ++i) payload[i] = PayloadByte(seq, i);
+        w.Append(seq, seq * 10, seq & 1 ? PacketDirection::SMSG : PacketDirection::CMSG, uint16_t(seq),
+                 1, payload.data(), size, Snapped(seq) ? size + 1000 : 0);
+    }
+    WaitByte(quit);
+    const ShmWriterStats st = w.Stats();
+    return st.records + st.dropped == records && st.dropped == records / 97 ? 0 : 1;
+}
+
+// Child: follow the ring to seq `records`; `late` waits for the writer to finish first.
+static int Reader(int id, const char* name, uint32_t ring, uint64_t records, bool late)
+{
+    ShmRingReader r;
+    if (!r.Open(name)) { printf("reader %d: cannot open ring\n", id); return 1; }
+    const uint64_t tailAtOpen = r.ReadHeader().tail;
+    if (late)
+        while (r.ReadHeader().lastSeq != records) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const uint64_t tailAtRead = r.ReadHeader().tail;
+
+    uint64_t last = 0, read = 0, unexplained = 0, bad = 0, losses = 0;
+    ShmPacketView v;
+    while (last != records)
+    {
+        if (!r.Next(v))
+        {
+            if (r.Stats().stale) break;
+            std::this_thread::yield();
+            continue;
+        }
+        const uint64_t seq = v.rec.seq;
+        bool match = v.rec.size == PayloadSize(seq, ring) &&
+                     v.wireSize == (Snapped(seq) ? v.rec.size + 1000 : v.rec.size);
+        for (uint32_t i = 0; match && i < v.rec.size; ++i) match = v.payload[i] == PayloadByte(seq, i);
+        if (!r.Validate(v)) continue;   // overwritten under us: Next() counts the overrun
+
+        const ShmReaderStats st = r.Stats();
+        const uint64_t lossesNow = st.overruns + st.torn;
+        if (!match || seq <= last || Oversize(seq)) ++bad;
+        else if (AppendedBetween(last, seq) && lossesNow == losses) ++unexplained;
+        losses = lossesNow;
+        last = seq;
+        ++read;
+    }
+
+    const ShmReaderStats st = r.Stats();
+    bool ok = last == records && !bad && !unexplained;
+    if (late) ok = ok && st.overruns == 1 && st.lostBytes == tailAtRead - tailAtOpen && !st.torn;
+    printf("reader %d%s: read %llu, %llu overruns (%llu KiB), %llu torn, %llu bad, %llu unexplained gaps: %s\n",
+           id, late ? " (late)" : "", (unsigned long long)read, (unsigned long long)st.overruns,
+           (unsigned long long)(st.lostBytes >> 10), (unsigned long long)st.torn, (unsigned long long)bad,
+           (unsigned long long)unexplained, ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+template <typename Fn>
+static pid_t Spawn(Fn fn)
+{
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        const int rc = fn();
+        fflush(stdout);
+        _exit(rc);
+    }
+    return pid;
+}
+
+static bool Reap(pid_t pid)
+{
+    int status = 0;
+    return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static bool RunContinuity(const char* name, uint32_t ring, uint64_t records, int readers)
+{
+    int ready[2], go[2], quit[2];
+    if (pipe(ready) || pipe(go) || pipe(quit)) return false;
+
+    const pid_t writer = Spawn([&] { return Writer(name, ring, records, ready[1], go[0], quit[0]); });
+    WaitByte(ready[0]);
+
+    std::vector<pid_t> pids;
+    for (int i = 0; i <= readers; ++i)
+        pids.push_back(Spawn([&] { return Reader(i, name, ring, records, i == readers); }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));   // let them open and seek
+    const auto t0 = Bench::Clock::now();
+    SendByte(go[1]);
+
+    bool ok = true;
+    for (pid_t p : pids) ok &= Reap(p);
+    const double secs = Bench::SecondsSince(t0);
+
+    ShmRingReader check;
+    const bool opened = check.Open(name);
+    const ShmRingReader::HeaderSnapshot hs = check.ReadHeader();
+    const bool header = opened && hs.lastSeq == records && hs.dropped == records / 97 &&
+                        hs.records == records - records / 97 && !hs.stale;
+    printf("header            : %llu records, %llu dropped, last seq %llu: %s\n",
+           (unsigned long long)hs.records, (unsigned long long)hs.dropped,
+           (unsigned long long)hs.lastSeq, header ? "ok" : "FAIL");
+    check.Close();
+
+    SendByte(quit[1]);
+    const bool writerOk = Reap(writer);
+    printf("writer            : %s (%.3f s for all readers)\n", writerOk ? "ok" : "FAIL", secs);
+    for (int fd : { ready[0], ready[1], go[0], go[1], quit[0], quit[1] }) close(fd);
+    return ok && header && writerOk;
+}
+
+// A writer that dies between the two lock stores of a publish.
+static bool RunStaleWriter(const char* name)
+{
+    int ready[2];
+    if (pipe(ready)) return false;
+    const pid_t writer = Spawn([&] {
+        ShmRingWriter w;
+        if (!w.Create(name, 4096, static_cast<uint32_t>(getpid()))) return 1;
+        const uint8_t byte = 0;
+        for (uint64_t seq = 1; seq <= 10; ++seq) w.Append(seq, 0, PacketDirection::SMSG, 1, 1, &byte, 1);
+        SharedMemory view;
+        if (!view.Open(name)) return 1;
+        reinterpret_cast<ShmRingHeader*>(view.Data())->lock.fetch_add(1);
+        SendByte(ready[1]);
+        _exit(0);   // no Close(): the name and the odd lock stay behind
+    });
+    WaitByte(ready[0]);
+    Reap(writer);
+
+    ShmRingReader r;
+    bool ok = r.Open(name);
+    ShmPacketView v;
+    const auto t0 = Bench::Clock::now();
+    ok = ok && !r.Next(v);
+    const double ms = Bench::SecondsSince(t0) * 1e3;
+    ok = ok && r.Stats().stale == 1 && r.ReadHeader().stale;
+    printf("stale writer      : Next() gave up after %.0f ms: %s\n", ms, ok ? "ok" : "FAIL");
+    r.Close();
+    shm_unlink(name);
+    close(ready[0]);
+    close(ready[1]);
+    return ok;
+}
+
+int Bench::RunShm(int argc, char** argv)
+{
+    uint64_t records = 20000;
+    int      readers = 3;
+    uint32_t ringKiB = 64;
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if      (!strcmp(argv[i], "--records")) records = strtoull(argv[i + 1], nullptr, 10);
+        else if (!strcmp(argv[i], "--readers")) readers = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--ring"))    ringKiB = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+    }
+    if (records % 97 == 0) ++records;   // the last seq must be one a reader can see
+    const uint32_t ring = ringKiB << 10;
+    if (ringKiB < 4 || (ring & (ring - 1)))
+    {
+        printf("shm               : --ring must be a power of two >= 4\n");
+        return 1;
+    }
+    printf("%llu records through a %u KiB ring, %d readers + 1 late\n",
+           (unsigned long long)records, ringKiB, readers);
+
+    char name[64];
+    snprintf(name, sizeof(name), "/PacketGodBench_%d", static_cast<int>(getpid()));
+    bool ok = RunContinuity(name, ring, records, readers);
+    ok &= RunStaleWriter(name);
+    printf("shm               : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,254 @@
+#include "Bench.h"
+#include "wow/Offsets.h"
+#include "wow/OffsetResolver.h"
+#include "wow/SigScan.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ============================================================
+//  SigScan — scan throughput per ISA over a synthetic client,
+//  then the Offsets round trip: signatures generated on one
+//  build place every slot in a relinked one (functions moved,
+//  call displacements and global addresses changed), scanning
+//  in parallel the first time and from the cache the second.
+//
+//  Options:  --mb N   size of .text (default 64)
+// ============================================================
+
+using Bench::Clock;
+
+static constexpr uintptr_t kImageBase = 0x00400000;   // wow.exe's
+static constexpr uint32_t  kTextRva   = 0x1000;
+static constexpr uint32_t  kDataSize  = 0x10000;
+
+struct FakeBuild
+{
+    std::vector<uint8_t>   text, data;
+    ModuleImage            image;
+    std::vector<uintptr_t> slots;   // planted address per Offsets::kSlots entry
+};
+
+using Bench::Lcg;
+using Bench::StoreU32;
+
+// Bytes skewed towards what compiled x86 is made of.
+static uint8_t CodeByte(uint32_t& rng)
+{
+    static const uint8_t kCommon[] = { 0x00, 0xFF, 0x8B, 0x89, 0xCC, 0x24, 0x45, 0xE8, 0x04, 0x08, 0x83, 0x0C,
+                                       0x10, 0xC4, 0x01, 0x55, 0x8D, 0x85, 0xEC, 0x74, 0x75, 0x50, 0x56, 0x57 };
+    const uint32_t r = Lcg(rng);
+    return (r & 1) ? kCommon[(r >> 1) % sizeof(kCommon)] : static_cast<uint8_t>(r >> 9);
+}
+
+static bool IsGlobal(size_t slot) { return Offsets::kSlots[slot].name[0] == 'g'; }
+
+// Same function bodies in every build; `layout` moves them, the
+// globals, and every call / global reference that points at them.
+static void MakeBuild(FakeBuild& b, size_t textBytes, uint32_t layout)
+{
+    const size_t slotCount = sizeof(Offsets::kSlots) / sizeof(Offsets::kSlots[0]);
+    b.text.resize(textBytes);
+    b.data.assign(kDataSize, 0);
+    b.slots.assign(slotCount, 0);
+
+    uint32_t filler = 0xF111u * layout;
+    for (uint8_t& x : b.text) x = CodeByte(filler);
+
+    const uintptr_t dataVa = kImageBase + kTextRva + ((textBytes + 0xFFF) & ~size_t(0xFFF));
+    for (size_t s = 0; s < slotCount; ++s)
+        if (IsGlobal(s)) b.slots[s] = dataVa + 0x100 + s * 0x40 + layout * 0x20;
+
+    uint32_t jitter = 0x7177u * layout;
+    const size_t stride = textBytes / (slotCount + 1);
+    for (size_t s = 0; s < slotCount; ++s)
+        if (!IsGlobal(s)) b.slots[s] = kImageBase + kTextRva + (s + 1) * stride + Lcg(jitter) % (stride / 2);
+
+    // Bodies: prologue, then fixed bytes with a call to the next
+    // function and a load of one global every so often.
+    for (size_t s = 0; s < slotCount; ++s)
+    {
+        if (IsGlobal(s)) continue;
+        uint32_t body = 0xB0D1u + static_cast<uint32_t>(s) * 7919u;
+        const uintptr_t va  = b.slots[s];
+        uint8_t*        p   = b.text.data() + (va - kImageBase - kTextRva);
+        const size_t    len = 64 + Lcg(body) % 64;
+        p[0] = 0x55; p[1] = 0x8B; p[2] = 0xEC;
+        for (size_t i = 3; i < len;)
+        {
+            const uint32_t r = Lcg(body) % 16;
+            if (r == 0 && i + 5 <= len)
+            {
+                const uintptr_t target = b.slots[(s + 1) % slotCount] ? b.slots[(s + 1) % slotCount] : va;
+                p[i] = 0xE8;
+                StoreU32(p + i + 1, static_cast<uint32_t>(target - (va + i + 5)));
+                i += 5;
+            }
+            else if (r == 1 && i + 6 <= len)
+            {
+                // The globals are each referenced from the body after them.
+                const size_t g = slotCount - 1 - s % 3;
+                p[i] = 0x8B; p[i + 1] = 0x0D;
+                StoreU32(p + i + 2, static_cast<uint32_t>(b.slots[g]));
+                i += 6;
+            }
+            else
+                p[i++] = CodeByte(body);
+        }
+    }
+
+    b.image = ModuleImage{};
+    b.image.base = kImageBase;
+    b.image.size = dataVa + kDataSize - kImageBase;
+    ModuleSection text, data;
+    memcpy(text.name, ".text", 5);
+    text.va = kImageBase + kTextRva; text.data = b.text.data(); text.size = b.text.size(); text.code = true;
+    memcpy(data.name, ".rdata", 6);
+    data.va = dataVa; data.data = b.data.data(); data.size = b.data.size();
+    b.image.sections = { text, data };
+}
+
+static void SetSlots(const std::vector<uintptr_t>& values)
+{
+    for (size_t s = 0; s < values.size(); ++s) *Offsets::kSlots[s].address = values[s];
+}
+
+static std::vector<uintptr_t> GetSlots()
+{
+    std::vector<uintptr_t> v;
+    for (const Offsets::Slot& s : Offsets::kSlots) v.push_back(*s.address);
+    return v;
+}
+
+static size_t SlotsMatching(const FakeBuild& b)
+{
+    size_t ok = 0;
+    for (size_t s = 0; s < b.slots.size(); ++s) ok += *Offsets::kSlots[s].address == b.slots[s];
+    return ok;
+}
+
+// A minimal PE32 header: FromPe must find both sections and their kinds.
+static bool CheckPeHeaders()
+{
+    std::vector<uint8_t> img(0x3000, 0);
+    img[0] = 'M'; img[1] = 'Z';
+    StoreU32(&img[0x3C], 0x80);
+    uint8_t* nt = &img[0x80];
+    memcpy(nt, "PE\0\0", 4);
+    nt[6] = 2;              // sections
+    nt[20] = 224;           // optional header size
+    nt[24] = 0x0B; nt[25] = 0x01;
+    StoreU32(nt + 24 + 56, 0x3000);
+    uint8_t* sh = nt + 24 + 224;
+    memcpy(sh, ".text", 5);       StoreU32(sh + 8, 0x800);  StoreU32(sh + 12, 0x1000); StoreU32(sh + 36, 0x60000020);
+    memcpy(sh + 40, ".data", 5);  StoreU32(sh + 48, 0x400); StoreU32(sh + 52, 0x2000); StoreU32(sh + 76, 0xC0000040);
+
+    ModuleImage m;
+    return ModuleImage::FromPe(img.data(), m) && m.sections.size() == 2 && m.sections[0].code &&
+           !m.sections[1].code && m.sections[0].size == 0x800 && m.sections[1].va == m.base + 0x2000;
+}
+
+int Bench::RunSigScan(int argc, char** argv)
+{
+    size_t mb = 64;
+    for (int i = 0; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--mb")) mb = strtoul(argv[i + 1], nullptr, 10);
+    if (mb < 4)
+    {
+        printf("nothing to run\n");
+        return 2;
+    }
+    const std::vector<uintptr_t> saved = GetSlots();
+    bool ok = CheckPeHeaders();
+    printf("pe headers        : %s\n", ok ? "ok" : "FAIL");
+
+    FakeBuild stock, relinked;
+    MakeBuild(stock, mb << 20, 1);
+    MakeBuild(relinked, mb << 20, 2);
+
+    // Raw scan speed: an absent pattern (the full pass) and a frequent one (verify cost).
+    Signature absent, frequent;
+    Signature::Parse("55 8B EC 83 E4 F8 81 EC ?? ?? ?? ?? A1 ?? ?? ?? ?? 33 C4 89", absent);
+    Signature::Parse("8B 45 ?? 89", frequent);
+    size_t expectFreq = 0;
+    for (ScanIsa isa : { ScanIsa::Scalar, ScanIsa::Sse2, ScanIsa::Avx2 })
+    {
+        if (isa > SigScan::BestIsa()) continue;
+        std::vector<size_t> hits;
+        const int reps = 4;
+        auto t0 = Clock::now();
+        for (int r = 0; r < reps; ++r)
+        {
+            hits.clear();
+            SigScan::FindAll(stock.text.data(), stock.text.size(), absent, hits, SIZE_MAX, isa);
+        }
+        const double gbs = stock.text.size() * reps / SecondsSince(t0) / 1e9;
+        const bool   none = hits.empty();
+        hits.clear();
+        t0 = Clock::now();
+        const size_t freq = SigScan::FindAll(stock.text.data(), stock.text.size(), frequent, hits, SIZE_MAX, isa);
+        const double freqGbs = stock.text.size() / SecondsSince(t0) / 1e9;
+        if (isa == ScanIsa::Scalar) expectFreq = freq;
+        const bool same = none && freq == expectFreq;
+        printf("scan %-6s       : %6.2f GB/s absent, %6.2f GB/s frequent (%zu hits)  %s\n", ScanIsaName(isa), gbs,
+               freqGbs, freq, same ? "ok" : "FAIL");
+        ok &= same;
+    }
+
+    // Signatures from the stock build, at its addresses.
+    SetSlots(stock.slots);
+    std::vector<std::string> failed;
+    auto t0 = Clock::now();
+    const std::vector<OffsetSignature> sigs = OffsetResolver::Generate(stock.image, {}, &failed);
+    printf("generate          : %zu signatures in %.1f ms, %zu failed\n", sigs.size(), SecondsSince(t0) * 1e3,
+           failed.size());
+    ok &= failed.empty();
+
+    std::vector<OffsetSignature> reparsed;
+    std::string err;
+    const bool parsed = OffsetResolver::ParseSignatures(OffsetResolver::FormatSignatures(sigs).c_str(), reparsed, err) &&
+                        reparsed.size() == sigs.size();
+    printf("signature file    : %s\n", parsed ? "round trip ok" : ("FAIL " + err).c_str());
+    ok &= parsed;
+
+    // The relinked build: serial vs parallel scan, then from the cache.
+    const std::string cache = "sigscan_bench.offsets";
+    remove(cache.c_str());
+    OffsetReport rep;
+    for (unsigned threads : { 1u, 0u })
+    {
+        SetSlots(stock.slots);
+        OffsetResolver::Resolve(relinked.image, reparsed, nullptr, rep, threads);
+        const size_t placed = SlotsMatching(relinked);
+        printf("resolve x%-3s      : hash %6.1f ms, scan %7.1f ms (%s), %zu / %zu slots placed  %s\n",
+               threads ? "1" : "all", rep.hashMs, rep.scanMs, ScanIsaName(rep.isa), placed, relinked.slots.size(),
+               placed == relinked.slots.size() ? "ok" : "FAIL");
+        ok &= placed == relinked.slots.size();
+    }
+
+    SetSlots(stock.slots);
+    OffsetResolver::Resolve(relinked.image, reparsed, cache.c_str(), rep);
+    const bool firstScanned = !rep.cacheHit;
+    SetSlots(stock.slots);
+    t0 = Clock::now();
+    OffsetResolver::Resolve(relinked.image, reparsed, cache.c_str(), rep);
+    const double cachedMs = SecondsSince(t0) * 1e3;
+    const bool   cached   = firstScanned && rep.cacheHit && rep.scanned == 0 && SlotsMatching(relinked) == relinked.slots.size();
+    printf("resolve cached    : %.1f ms (hash %.1f ms, no scan)  %s\n", cachedMs, rep.hashMs, cached ? "ok" : "FAIL");
+    ok &= cached;
+
+    // The stock build hashes differently: the cache entry is not reused.
+    SetSlots(relinked.slots);
+    OffsetResolver::Resolve(stock.image, reparsed, cache.c_str(), rep);
+    const bool keyed = !rep.cacheHit && SlotsMatching(stock) == stock.slots.size();
+    printf("other build       : %s\n", keyed ? "rescanned, ok" : "FAIL");
+    ok &= keyed;
+
+    remove(cache.c_str());
+    SetSlots(saved);
+    printf("sigscan           : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
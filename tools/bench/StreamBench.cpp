@@ -0,0 +1,225 @@
+#include "Bench.h"
+#include "packet/StreamReassembler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// ============================================================
+//  StreamReassembler — framing against a model of the client
+//
+//  A synthetic SMSG stream (normal and 5-byte large headers,
+//  empty to 40 KB payloads) is played through a model of the
+//  client's network loop: recv() into a buffer after moving any
+//  unread header bytes to its front (OnRecv), decrypt each header
+//  once all of its bytes are in (OnHeader, pointing into the
+//  buffer), consume the payload as it arrives.  Every emitted
+//  frame must match the stream, in order, with no resyncs:
+//    split       recv chunks of 1..64 bytes, headers cut in pieces
+//    mixed       1 byte .. 16 KB chunks
+//    coalesced   64 KB chunks, many packets per recv
+//    garbage     the stream starts inside a payload the hooks never
+//                saw the header of (armed mid-session)
+//    no window   OnHeader only (no recv hook): contiguous buffer
+//  plus the throughput of the coalesced case.
+//
+//  Options:  --packets N   (default 20000)
+// ============================================================
+
+using Bench::Clock;
+using Bench::Lcg;
+
+struct Frame
+{
+    uint16_t opcode;
+    bool     large;
+    uint32_t offset;   // payload position in the wire bytes
+    uint32_t size;
+};
+
+struct Emitted
+{
+    const std::vector<uint8_t>* wire;
+    const std::vector<Frame>*   frames;
+    size_t                      next = 0;
+    uint64_t                    mismatches = 0;
+    uint64_t                    bytes = 0;
+};
+
+static void Collect(const SmsgView& pkt, void* user)
+{
+    Emitted& e = *static_cast<Emitted*>(user);
+    if (e.next >= e.frames->size()) { ++e.mismatches; return; }
+    const Frame& f = (*e.frames)[e.next++];
+    const bool same = pkt.opcode == f.opcode && pkt.large == f.large && pkt.size == f.size &&
+                      (!f.size || !memcmp(pkt.payload, e.wire->data() + f.offset, f.size));
+    if (!same) ++e.mismatches;
+    e.bytes += pkt.size;
+}
+
+// SMSG stream of `count` packets; the header forms the client uses.
+static std::vector<uint8_t> MakeStream(uint32_t count, uint32_t seed, std::vector<Frame>& frames)
+{
+    std::vector<uint8_t> wire;
+    uint32_t rng = seed;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t r    = Lcg(rng);
+        const uint32_t size = r % 97 == 0 ? 32768 + r % 8192   // large header
+                            : r % 11 == 0 ? 0
+                            : r % 5 == 0  ? 200 + r % 3000
+                            : 2 + r % 120;
+        Frame f;
+        f.opcode = static_cast<uint16_t>(Lcg(rng) % 1300);
+        f.large  = size + 2 > 0x7FFF;
+        if (f.large)
+        {
+            wire.push_back(static_cast<uint8_t>(0x80 | ((size + 2) >> 16)));
+            wire.push_back(static_cast<uint8_t>((size + 2) >> 8));
+            wire.push_back(static_cast<uint8_t>(size + 2));
+        }
+        else
+        {
+            wire.push_back(static_cast<uint8_t>((size + 2) >> 8));
+            wire.push_back(static_cast<uint8_t>(size + 2));
+        }
+        wire.push_back(static_cast<uint8_t>(f.opcode));
+        wire.push_back(static_cast<uint8_t>(f.opcode >> 8));
+        f.offset = static_cast<uint32_t>(wire.size());
+        f.size   = size;
+        for (uint32_t k = 0; k < size; ++k) wire.push_back(static_cast<uint8_t>(Lcg(rng)));
+        frames.push_back(f);
+    }
+    return wire;
+}
+
+// The client's loop over `wire`, recv() chunk sizes in [minChunk, maxChunk].
+// `owe`: payload bytes of an unseen packet at the front of the stream.
+static void PlayClient(StreamReassembler& ra, const std::vector<uint8_t>& wire, uint32_t owe,
+                       uint32_t minChunk, uint32_t maxChunk, uint32_t seed, Emitted& out)
+{
+    std::vector<uint8_t> buf(maxChunk + 8);
+    uint32_t have = 0, pos = 0, fed = 0;
+    uint32_t rng  = seed;
+    while (fed < wire.size())
+    {
+        // Unread bytes (a partial header at most) move to the front.
+        memmove(buf.data(), buf.data() + pos, have - pos);
+        have -= pos;
+        pos = 0;
+
+        uint32_t n = minChunk + (maxChunk > minChunk ? Lcg(rng) % (maxChunk - minChunk + 1) : 0);
+        n = (std::min)(n, static_cast<uint32_t>(wire.size()) - fed);
+        memcpy(buf.data() + have, wire.data() + fed, n);
+        ra.OnRecv(buf.data() + have, n, &Collect, &out);
+        have += n;
+        fed  += n;
+
+        for (;;)
+        {
+            if (owe)
+            {
+                const uint32_t take = (std::min)(owe, have - pos);
+                pos += take;
+                owe -= take;
+                if (owe) break;
+                continue;
+            }
+            if (pos == have) break;
+            const uint32_t hlen = StreamReassembler::HeaderLength(buf[pos]);
+            if (have - pos < hlen) break;
+            uint16_t op;
+            uint32_t size, hl;
+            StreamReassembler::ParseHeader(buf.data() + pos, hlen, op, size, hl);
+            ra.OnHeader(buf.data() + pos, hlen, &Collect, &out);
+            pos += hlen;
+            owe  = size;
+        }
+    }
+}
+
+static bool Check(const char* what, const StreamReassembler& ra, const Emitted& e, size_t expected, bool needCopies)
+{
+    const StreamStats& st = ra.Stats();
+    const bool ok = e.next == expected && !e.mismatches && !st.resyncs &&
+                    st.zeroCopy + st.reassembled == expected && (!needCopies || st.reassembled);
+    printf("%-12s: %6zu frames, %6llu zero-copy, %6llu reassembled, %4llu large, %llu resyncs, %llu mismatches: %s\n",
+           what, e.next, (unsigned long long)st.zeroCopy, (unsigned long long)st.reassembled,
+           (unsigned long long)st.largeHeader, (unsigned long long)st.resyncs,
+           (unsigned long long)e.mismatches, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int Bench::RunStream(int argc, char** argv)
+{
+    uint32_t packets = 20000;
+    for (int i = 0; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--packets")) packets = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+
+    std::vector<Frame> frames;
+    const std::vector<uint8_t> wire = MakeStream(packets, 0x51A7E5u, frames);
+    bool ok = true;
+
+    struct Case { const char* name; uint32_t minChunk, maxChunk; bool needCopies; };
+    const Case cases[] = {
+        { "split",     1,     64,    true  },
+        { "mixed",     1,     16384, true  },
+        { "coalesced", 65536, 65536, false },
+    };
+    for (const Case& c : cases)
+    {
+        StreamReassembler ra;
+        Emitted e{ &wire, &frames };
+        PlayClient(ra, wire, 0, c.minChunk, c.maxChunk, 0xC0FFEEu, e);
+        ok &= Check(c.name, ra, e, frames.size(), c.needCopies);
+    }
+
+    // Armed mid-session: the hooks join inside a payload.
+    {
+        std::vector<uint8_t> joined(1500 + wire.size());
+        uint32_t rng = 7;
+        for (uint32_t i = 0; i < 1500; ++i) joined[i] = static_cast<uint8_t>(Lcg(rng));
+        memcpy(joined.data() + 1500, wire.data(), wire.size());
+        std::vector<Frame> shifted = frames;
+        for (Frame& f : shifted) f.offset += 1500;
+
+        StreamReassembler ra;
+        Emitted e{ &joined, &shifted };
+        PlayClient(ra, joined, 1500, 1, 4096, 0xBADu, e);
+        ok &= Check("garbage", ra, e, shifted.size(), true);
+    }
+
+    // No recv hook: headers only, payload contiguous behind them.
+    {
+        StreamReassembler ra;
+        Emitted e{ &wire, &frames };
+        for (const Frame& f : frames)
+        {
+            const uint32_t hlen = f.large ? 5 : 4;
+            ra.OnHeader(wire.data() + f.offset - hlen, hlen, &Collect, &e);
+        }
+        ok &= Check("no window", ra, e, frames.size(), false);
+    }
+
+    // Throughput: coalesced recv chunks, as a busy world connection delivers them.
+    {
+        const int rounds = 20;
+        StreamReassembler ra;
+        uint64_t bytes = 0;
+        const auto t0 = Clock::now();
+        for (int r = 0; r < rounds; ++r)
+        {
+            Emitted e{ &wire, &frames };
+            PlayClient(ra, wire, 0, 65536, 65536, 0xC0FFEEu, e);
+            bytes += e.bytes;
+        }
+        const double secs = Bench::SecondsSince(t0);
+        printf("throughput  : %.0f MB/s payload, %.1f ns/frame (incl. the client model)\n",
+               bytes / secs / 1e6, secs * 1e9 / (static_cast<double>(rounds) * frames.size()));
+    }
+
+    printf("stream            : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
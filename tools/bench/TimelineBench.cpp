@@ -0,0 +1,149 @@
+#include "Bench.h"
+#include "analysis/TrafficTimeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// ============================================================
+//  Timeline — TrafficTimeline over a six-hour session: push cost,
+//  bucket sums against a brute-force count at every level, and
+//  query cost for a one-minute vs a six-hour window
+//
+//  Options:  --packets N   session size (default 2000000)
+// ============================================================
+
+using Bench::Clock;
+
+struct TimelineSample
+{
+    uint64_t        timeUs;
+    PacketDirection dir;
+    uint32_t        size;
+};
+
+// Six hours of traffic: a uniform baseline plus a dense 20 s burst every 5 minutes.
+static std::vector<TimelineSample> MakeSession(uint32_t count, uint64_t startUs)
+{
+    std::vector<TimelineSample> out(count);
+    const uint64_t spanUs = 6ull * 3600 * 1'000'000;
+    uint64_t rng = 0x7A11E5u;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t at = (rng >> 20) % spanUs;
+        if (i % 4 == 0)   // into the burst of its 5-minute slot
+            at = at / 300'000'000 * 300'000'000 + at % 20'000'000;
+        out[i] = { startUs + at, (rng & 0x100) ? PacketDirection::SMSG : PacketDirection::CMSG,
+                   8 + static_cast<uint32_t>(rng >> 40) % 400 };
+    }
+    std::sort(out.begin(), out.end(),
+              [](const TimelineSample& a, const TimelineSample& b) { return a.timeUs < b.timeUs; });
+    return out;
+}
+
+// Sums of the raw buckets against the samples themselves.
+static bool CheckLevel(const std::vector<TimelineSample>& s, uint64_t fromUs, uint64_t toUs)
+{
+    std::vector<TimelinePoint> pts;
+    bool ok = true;
+    for (int d = 0; d < 2; ++d)
+        for (int m = 0; m < 2; ++m)
+        {
+            const uint64_t res = TrafficTimeline::Query(TimelineChannel::All, static_cast<PacketDirection>(d),
+                                                        static_cast<TimelineMetric>(m), fromUs, toUs,
+                                                        TrafficTimeline::kMaxRawBuckets, pts);
+            if (!res || pts.empty()) return false;
+            const uint64_t lo = pts.front().timeUs, hi = pts.back().timeUs + res;
+            double got = 0.0;
+            for (const TimelinePoint& p : pts) got += p.value * (res / 1e6);
+            uint64_t want = 0;
+            for (const TimelineSample& x : s)
+                if (x.timeUs >= lo && x.timeUs < hi && static_cast<int>(x.dir) == d)
+                    want += m == 0 ? 1 : x.size;
+            if (std::fabs(got - static_cast<double>(want)) > 0.5 + want * 1e-6)
+            {
+                printf("FAIL: %llu us buckets, dir %d metric %d: %.0f != %llu\n",
+                       static_cast<unsigned long long>(res), d, m, got, static_cast<unsigned long long>(want));
+                ok = false;
+            }
+        }
+    return ok;
+}
+
+static double QueryMicros(uint64_t fromUs, uint64_t toUs, uint64_t& res)
+{
+    std::vector<TimelinePoint> pts;
+    const int reps = 200;
+    const auto t0 = Clock::now();
+    for (int i = 0; i < reps; ++i)
+        res = TrafficTimeline::Query(TimelineChannel::All, PacketDirection::SMSG, TimelineMetric::Packets,
+                                     fromUs, toUs, 800, pts);
+    return Bench::SecondsSince(t0) * 1e6 / reps;
+}
+
+int Bench::RunTimeline(int argc, char** argv)
+{
+    uint32_t packets = 2'000'000;
+    for (int i = 0; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--packets")) packets = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+    if (packets < 1000)
+    {
+        printf("nothing to run\n");
+        return 2;
+    }
+
+    TrafficTimeline::Clear();
+    const std::vector<TimelineSample> session = MakeSession(packets, 10'000'000);
+    CapturedPacket pkt;
+    const auto t0 = Clock::now();
+    for (size_t i = 0; i < session.size(); ++i)
+    {
+        pkt.seq          = i + 1;
+        pkt.timestamp_us = session[i].timeUs;
+        pkt.direction    = session[i].dir;
+        pkt.size         = session[i].size;
+        TrafficTimeline::Add(pkt);
+    }
+    const double pushS = SecondsSince(t0);
+    const uint64_t newest = TrafficTimeline::NewestUs();
+    printf("session           : %u packets over %.1f h\n", packets,
+           (newest - TrafficTimeline::OldestUs()) / 3.6e9);
+    printf("push              : %.1f ns/packet (%zu levels)\n", pushS * 1e9 / packets, TrafficTimeline::kLevels);
+
+    // Each level against the raw samples, over the newest span it answers.
+    bool ok = true;
+    static const uint64_t kSpans[] = { 3'000'000, 30'000'000, 300'000'000, 3'600'000'000ull, 21'600'000'000ull };
+    for (uint64_t span : kSpans)
+        ok &= CheckLevel(session, newest > span ? newest - span : 0, newest + 1);
+    printf("bucket sums       : %s\n", ok ? "ok" : "FAIL");
+
+    // Same cost for a minute and for the whole session.
+    uint64_t resMin = 0, resAll = 0;
+    const double usMin = QueryMicros(newest - 60'000'000, newest + 1, resMin);
+    const double usAll = QueryMicros(TrafficTimeline::OldestUs(), newest + 1, resAll);
+    printf("query 1 min       : %6.1f us (%llu ms buckets -> 800 points)\n", usMin,
+           static_cast<unsigned long long>(resMin / 1000));
+    printf("query 6 h         : %6.1f us (%llu ms buckets -> 800 points)\n", usAll,
+           static_cast<unsigned long long>(resAll / 1000));
+
+    // LTTB keeps the ends, the point count and an isolated spike.
+    std::vector<TimelinePoint> raw(10'000), down;
+    for (size_t i = 0; i < raw.size(); ++i)
+        raw[i] = { i * 1000ull, static_cast<float>(10 + (i % 7)) };
+    raw[4321].value = 5000.0f;
+    LttbDownsample(raw.data(), raw.size(), 300, down);
+    const bool lttbOk = down.size() == 300 && down.front().timeUs == raw.front().timeUs &&
+                        down.back().timeUs == raw.back().timeUs &&
+                        std::any_of(down.begin(), down.end(), [](const TimelinePoint& p) { return p.value == 5000.0f; });
+    printf("lttb              : 10000 -> %zu points, spike %s  %s\n", down.size(),
+           lttbOk ? "kept" : "lost", lttbOk ? "ok" : "FAIL");
+    ok &= lttbOk;
+
+    TrafficTimeline::Clear();
+    printf("timeline          : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#include "Bench.h"
+#include "analysis/WorldTracker.h"
+#include "analysis/UpdateObjectDecoder.h"
+#include "packet/PacketCapture.h"
+#include "packet/PacketInflater.h"
+#include "Opcodes.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// ============================================================
+//  World tracker — decode order around the inflate stage
+//
+//  Pairs of update packets set the same field of one object: a
+//  compressed one, then a plain one.  The plain one must land
+//  second whatever the inflater does:
+//    held      inflate still pending: nothing behind it is decoded
+//    attached  the result arrives: both decode, in capture order
+//    inflated  a real zlib body through the inflate workers
+//    timeout   never inflated: skipped after kInflateWaitMicros,
+//              and the packet behind it decodes
+//  plus the cost of a Poll() while a packet holds the queue with
+//  traffic piled up behind it.
+//
+//  Compressed bodies are zlib streams of stored blocks, so no
+//  deflate is needed; "corrupt" ones use a reserved block type,
+//  which the inflater rejects and never attaches.
+//
+//  Options:  --behind N   packets queued behind the held one (default 2000)
+// ============================================================
+
+using Bench::Clock;
+using Bench::PutU32;
+
+// SMSG_UPDATE_OBJECT body: one VALUES block setting `guid`'s entry field.
+static std::vector<uint8_t> ValuesBody(uint64_t guid, uint32_t entry)
+{
+    std::vector<uint8_t> b;
+    PutU32(b, 1);   // blocks
+    b.push_back(UpdateObjectDecoder::UPDATETYPE_VALUES);
+    Bench::PutPackedGuid(b, guid);
+    b.push_back(1);   // mask words
+    PutU32(b, 1u << UpdateFields::OBJECT_FIELD_ENTRY);
+    PutU32(b, entry);
+    return b;
+}
+
+// SMSG_COMPRESSED_UPDATE_OBJECT: [4] rawSize, then `body` as one stored
+// zlib block, or (corrupt) a block of the reserved type.
+static std::vector<uint8_t> CompressedBody(const std::vector<uint8_t>& body, bool corrupt = false)
+{
+    std::vector<uint8_t> b;
+    PutU32(b, static_cast<uint32_t>(body.size()));
+    Bench::PutZlibStored(b, body.data(), body.size(), corrupt);
+    return b;
+}
+
+static CapturedPacket Smsg(uint16_t opcode, std::vector<uint8_t> payload)
+{
+    CapturedPacket p;
+    p.connection   = 1;
+    p.direction    = PacketDirection::SMSG;
+    p.opcode       = opcode;
+    p.timestamp_us = PacketCapture::NowMicros();
+    p.payload      = std::move(payload);
+    p.size         = static_cast<uint32_t>(p.payload.size());
+    return p;
+}
+
+// Entry field of `guid`, or 0 if the tracker has not seen it.
+static uint32_t Entry(uint64_t guid)
+{
+    auto lock = WorldTracker::Lock();
+    const ObjectTable& t = WorldTracker::World().Live();
+    const uint32_t slot = t.Find(guid);
+    return slot == UINT32_MAX ? 0 : t.GetField(slot, UpdateFields::OBJECT_FIELD_ENTRY);
+}
+
+// Waits for the inflate workers to reject `failed` jobs in total.
+static bool WaitFailed(uint64_t failed)
+{
+    const auto t0 = Clock::now();
+    while (PacketInflater::Stats().failed < failed)
+    {
+        if (Bench::SecondsSince(t0) > 2.0) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+static bool Check(bool ok, const char* what)
+{
+    printf("%-18s: %s\n", what, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int Bench::RunWorld(int argc, char** argv)
+{
+    uint32_t behind = 2000;
+    for (int i = 0; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--behind")) behind = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+    if (behind == 0) behind = 1;
+
+    if (!PacketInflater::Available())
+    {
+        printf("world             : skipped (built without zlib)\n");
+        return 0;
+    }
+
+    PacketCapture::Clear();
+    PacketCapture::ClearFilters();
+    WorldTracker::Clear();
+    PacketInflater::Start(1);
+    if (!WorldTracker::Start())
+    {
+        PacketInflater::Stop();
+        printf("world             : FAIL (no capture sink slot)\n");
+        return 1;
+    }
+    const uint64_t failed0 = PacketInflater::Stats().failed;
+    bool ok = true;
+
+    // held, then attached
+    std::vector<CapturedPacket> batch;
+    const uint64_t heldSeq = PacketCapture::LastSeq() + 1;
+    batch.push_back(Smsg(SMSG_COMPRESSED_UPDATE_OBJECT, CompressedBody(ValuesBody(0x11, 100), true)));
+    batch.push_back(Smsg(SMSG_UPDATE_OBJECT, ValuesBody(0x11, 101)));
+    batch.push_back(Smsg(SMSG_UPDATE_OBJECT, ValuesBody(0x12, 7)));
+    PacketCapture::PushBatch(batch);
+    ok &= WaitFailed(failed0 + 1);
+    WorldTracker::Poll();
+    ok &= Check(Entry(0x11) == 0 && Entry(0x12) == 0 && WorldTracker::Stats().decode.packets == 0, "held");
+
+    PacketCapture::AttachInflated(heldSeq, std::make_shared<const std::vector<uint8_t>>(ValuesBody(0x11, 100)));
+    WorldTracker::Poll();
+    ok &= Check(Entry(0x11) == 101 && Entry(0x12) == 7 && WorldTracker::Stats().decode.packets == 3, "attached");
+
+    // inflated by the workers
+    batch.push_back(Smsg(SMSG_COMPRESSED_UPDATE_OBJECT, CompressedBody(ValuesBody(0x21, 200))));
+    batch.push_back(Smsg(SMSG_UPDATE_OBJECT, ValuesBody(0x21, 201)));
+    PacketCapture::PushBatch(batch);
+    auto t0 = Clock::now();
+    while (WorldTracker::Stats().decode.packets < 5 && Bench::SecondsSince(t0) < 2.0)
+    {
+        WorldTracker::Poll();
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    ok &= Check(Entry(0x21) == 201 && WorldTracker::Stats().decode.failed == 0, "inflated");
+
+    // timeout, with traffic queued behind the held packet
+    batch.push_back(Smsg(SMSG_COMPRESSED_UPDATE_OBJECT, CompressedBody(ValuesBody(0x31, 300), true)));
+    batch.push_back(Smsg(SMSG_UPDATE_OBJECT, ValuesBody(0x31, 301)));
+    for (uint32_t i = 0; i < behind; ++i)
+    {
+        CapturedPacket p = Smsg(i % 4 ? SMSG_MESSAGECHAT : SMSG_UPDATE_OBJECT, ValuesBody(0x1000 + i, i + 1));
+        p.connection = 2;
+        batch.push_back(std::move(p));
+    }
+    t0 = Clock::now();
+    PacketCapture::PushBatch(batch);
+    ok &= WaitFailed(failed0 + 2);
+
+    const int polls = 1000;
+    const auto p0 = Clock::now();
+    for (int i = 0; i < polls; ++i) WorldTracker::Poll();
+    const double pollNs = Bench::SecondsSince(p0) * 1e9 / polls;
+    const bool stillHeld = Entry(0x31) == 0 && Entry(0x1000) == 0;
+    printf("poll while held   : %.0f ns with %u packets behind\n", pollNs, behind);
+
+    while (Entry(0x31) == 0 && Bench::SecondsSince(t0) < 3.0)
+    {
+        WorldTracker::Poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    const double waitedUs = Bench::SecondsSince(t0) * 1e6;
+    const WorldTrackerStats st = WorldTracker::Stats();
+    ok &= Check(stillHeld && Entry(0x31) == 301 && Entry(0x1000) == 1 && Entry(0x1000 + (behind - 1) / 4 * 4) != 0 &&
+                st.skipped == 1 && waitedUs >= WorldTracker::kInflateWaitMicros * 0.9, "timeout");
+    printf("                    skipped after %.0f ms, %llu packets decoded\n", waitedUs / 1e3,
+           static_cast<unsigned long long>(st.decode.packets));
+
+    WorldTracker::Stop();
+    PacketInflater::Stop();
+    WorldTracker::Clear();
+    PacketCapture::Clear();
+    printf("world             : %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,338 @@
+#include "ipc/ControlClient.h"
+#include "ipc/ControlServer.h"
+#include "packet/PacketPipeline.h"
+#include "packet/PacketReplay.h"
+#include "packet/CaptureFile.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+// ============================================================
+//  PacketGodCtl — drive a client's control endpoint
+//
+//    bench  <pid|endpoint>   pipelined request throughput
+//    stream <pid|endpoint>   subscribe and print packets
+//    serve  [capture.pgcap]  host a ControlServer without the game:
+//                            packets come from the capture (looped),
+//                            replay/inject go to a counting stand-in,
+//                            sent from the main loop as the game's
+//                            render hook would
+//
+//  `serve` + `bench`/`stream` exercise the whole protocol on any
+//  host; against a live client only the endpoint differs.
+// ============================================================
+
+using namespace ControlProtocol;
+using Clock = std::chrono::steady_clock;
+
+static void Usage()
+{
+    printf("usage: PacketGodCtl bench  [-n requests] [-d depth] [-k stats|inject|replay] <pid|endpoint>\n"
+           "       PacketGodCtl stream [-c packets] [-b batch] [-w ms] [-o opcode]... [-g category]... <pid|endpoint>\n"
+           "       PacketGodCtl serve  [-e endpoint] [-r packets/s] [-t seconds] [capture.pgcap]\n"
+           "\n"
+           "  bench  -n  requests to send (default 100000)\n"
+           "         -d  requests in flight (default 256)\n"
+           "         -k  request kind (default stats; inject sends a 16-byte CMSG each)\n"
+           "  stream -c  exit after this many packets\n"
+           "         -b  packets per batch (default 64)  -w  max batch delay (default 10)\n"
+           "         -o  only this opcode (repeatable)  -g  only this category: movement, chat, combat, ...\n"
+           "  serve  -r  capture packets per second (default 10000)  -t  run time (default: forever)\n");
+}
+
+static void ResolveEndpoint(const char* arg, char* out, size_t outSize)
+{
+    const char* p = arg;
+    while (*p && isdigit(static_cast<unsigned char>(*p))) ++p;
+    if (*arg && !*p)
+        Ipc::DefaultEndpoint(static_cast<uint32_t>(strtoul(arg, nullptr, 10)), out, outSize);
+    else
+        snprintf(out, outSize, "%s", arg);
+}
+
+static bool Connect(ControlClient& client, const char* target)
+{
+    char endpoint[128];
+    ResolveEndpoint(target, endpoint, sizeof(endpoint));
+    if (client.Connect(endpoint)) return true;
+    fprintf(stderr, "cannot connect to %s\n", endpoint);
+    return false;
+}
+
+// ============================================================
+//  bench
+// ============================================================
+
+static int Bench(int argc, char** argv)
+{
+    uint64_t    total = 100000;
+    uint32_t    depth = 256;
+    const char* kind  = "stats";
+    const char* target = nullptr;
+    for (int i = 0; i < argc; ++i)
+    {
+        if      (!strcmp(argv[i], "-n") && i + 1 < argc) total = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc) depth = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-k") && i + 1 < argc) kind  = argv[++i];
+        else target = argv[i];
+    }
+    const uint16_t type = !strcmp(kind, "inject") ? Inject : !strcmp(kind, "replay") ? Replay : Stats;
+    if (!target || !depth) { Usage(); return 2; }
+
+    ControlClient client;
+    if (!Connect(client, target)) return 1;
+
+    // Hello first: the newest seq is what replay requests point at.
+    FrameHeader h;
+    std::vector<uint8_t> body;
+    client.Begin(Hello);
+    client.End();
+    if (!client.Flush() || !client.ReadFrame(h, body) || h.status != Ok) return 1;
+    Reader hello(body.data(), body.size());
+    const uint16_t version = hello.U16();
+    const uint32_t pid     = hello.U32();
+    const uint64_t lastSeq = hello.U64();
+    printf("connected: protocol %u, pid %u, last seq %llu\n", version, pid, (unsigned long long)lastSeq);
+
+    std::atomic<uint64_t> answered{ 0 };
+    std::atomic<uint64_t> failed{ 0 };
+    std::atomic<uint64_t> busy{ 0 };      // inject/replay: the main-thread send queue was full
+    std::atomic<uint64_t> notSent{ 0 };   // inject/replay: packets the send path refused
+    std::thread reader([&] {
+        FrameHeader rh;
+        std::vector<uint8_t> rb;
+        while (answered.load(std::memory_order_relaxed) < total && client.ReadFrame(rh, rb))
+        {
+            if (!(rh.type & kResponse)) continue;
+            if (rh.status == Busy)    busy.fetch_add(1, std::memory_order_relaxed);
+            else if (rh.status != Ok) failed.fetch_add(1, std::memory_order_relaxed);
+            if (rh.type == (Inject | kResponse) || rh.type == (Replay | kResponse))
+            {
+                Reader rr(rb.data(), rb.size());
+                rr.U16();
+                notSent.fetch_add(rr.U16(), std::memory_order_relaxed);
+            }
+            answered.fetch_add(1, std::memory_order_release);
+        }
+    });
+
+    const uint8_t payload[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    const auto start = Clock::now();
+    uint64_t issued = 0;
+    bool ok = true;
+    while (ok && issued < total)
+    {
+        // Top up to `depth` in flight, then send them in one write.
+        const uint64_t inFlight = issued - answered.load(std::memory_order_acquire);
+        if (inFlight >= depth) { std::this_thread::yield(); continue; }
+        for (uint64_t n = depth - inFlight; n && issued < total; --n, ++issued)
+        {
+            client.Begin(type);
+            if (type == Inject)
+            {
+                client.Body().U16(1);
+                client.Body().U8(0);
+                client.Body().U8(0);
+                client.Body().U16(0x01DC);   // CMSG_PING-sized stand-in
+                client.Body().U32(sizeof(payload));
+                client.Body().Bytes(payload, sizeof(payload));
+            }
+            else if (type == Replay)
+            {
+                client.Body().U16(1);
+                client.Body().U64(lastSeq);
+            }
+            client.End();
+        }
+        ok = client.Flush();
+    }
+    while (ok && answered.load(std::memory_order_acquire) < total)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+    client.Close();
+    reader.join();
+    printf("%llu %s requests in %.3f s: %.0f req/s, %llu not ok, %llu busy, %llu packets not sent (depth %u)\n",
+           (unsigned long long)answered.load(), kind, secs, answered.load() / secs,
+           (unsigned long long)failed.load(), (unsigned long long)busy.load(),
+           (unsigned long long)notSent.load(), depth);
+    return ok ? 0 : 1;
+}
+
+// ============================================================
+//  stream
+// ============================================================
+
+static int Stream(int argc, char** argv)
+{
+    uint64_t limit = 0;
+    uint16_t batch = 64, delayMs = 10;
+    std::vector<FilterRule> rules;
+    const char* target = nullptr;
+    for (int i = 0; i < argc; ++i)
+    {
+        if      (!strcmp(argv[i], "-c") && i + 1 < argc) limit   = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc) batch   = static_cast<uint16_t>(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc) delayMs = static_cast<uint16_t>(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+        {
+            FilterRule r;
+            r.enabled  = true;
+            r.matchAny = true;
+            r.opcode   = static_cast<uint16_t>(strtoul(argv[++i], nullptr, 0));
+            rules.push_back(r);
+        }
+        else if (!strcmp(argv[i], "-g") && i + 1 < argc)
+        {
+            FilterRule r;
+            r.enabled  = true;
+            r.matchAny = true;
+            if (!OpcodeMeta::ParseCategory(argv[++i], r.category) || r.category == OpcodeCategory::None)
+            {
+                fprintf(stderr, "unknown category '%s'\n", argv[i]);
+                return 2;
+            }
+            rules.push_back(r);
+        }
+        else target = argv[i];
+    }
+    if (!target || !batch) { Usage(); return 2; }
+
+    ControlClient client;
+    if (!Connect(client, target)) return 1;
+    client.Begin(Subscribe);
+    client.Body().U16(batch);
+    client.Body().U16(delayMs);
+    client.Body().U16(static_cast<uint16_t>(rules.size()));
+    for (const FilterRule& r : rules) client.Body().Rule(r);
+    client.End();
+    if (!client.Flush()) return 1;
+
+    FrameHeader h;
+    std::vector<uint8_t> body;
+    uint64_t packets = 0, batches = 0, lost = 0;
+    while ((!limit || packets < limit) && client.ReadFrame(h, body))
+    {
+        if (h.type != PacketBatch) continue;
+        Reader r(body.data(), body.size());
+        const uint16_t n = r.U16();
+        r.U16();
+        lost += r.U32();
+        ++batches;
+        for (uint16_t i = 0; i < n && r.Ok(); ++i)
+        {
+            const uint64_t seq  = r.U64();
+            const uint64_t ts   = r.U64();
+            const uint32_t size = r.U32();
+            const uint16_t op   = r.U16();
+            const uint8_t  dir  = r.U8();
+            const uint8_t  conn = r.U8();
+            r.Take(size);
+            ++packets;
+            printf("%8llu %12.6f %s 0x%04X conn=%u %6u bytes\n", (unsigned long long)seq, ts / 1e6,
+                   dir ? "SMSG" : "CMSG", op, conn, size);
+        }
+    }
+    printf("%llu packets in %llu batches, %llu lost\n", (unsigned long long)packets,
+           (unsigned long long)batches, (unsigned long long)lost);
+    return 0;
+}
+
+// ============================================================
+//  serve
+// ============================================================
+
+static std::atomic<uint64_t> s_standInSends{ 0 };
+
+struct StandIn
+{
+    static int __thiscall Send(WowConnection*, CDataStore*, int)
+    {
+        s_standInSends.fetch_add(1, std::memory_order_relaxed);
+        return 1;
+    }
+};
+
+static int Serve(int argc, char** argv)
+{
+    const char* endpoint = nullptr;
+    const char* path     = nullptr;
+    double      rate     = 10000.0, seconds = 0.0;
+    for (int i = 0; i < argc; ++i)
+    {
+        if      (!strcmp(argv[i], "-e") && i + 1 < argc) endpoint = argv[++i];
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) rate     = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) seconds  = atof(argv[++i]);
+        else path = argv[i];
+    }
+
+    std::vector<CapturedPacket> packets;
+    if (path && !CaptureFile::Load(path, packets))
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+
+    static uint8_t fakeConn[64];
+    PacketReplay::SetSendFn(&StandIn::Send, reinterpret_cast<WowConnection*>(fakeConn));
+    PacketPipeline::Start();
+    if (!ControlServer::Start(endpoint))
+    {
+        PacketPipeline::Stop();
+        return 1;
+    }
+    printf("serving on %s (%zu capture packets at %.0f/s)\n", ControlServer::Endpoint(), packets.size(), rate);
+    fflush(stdout);
+
+    const auto start = Clock::now();
+    auto nextReport  = start + std::chrono::seconds(1);
+    uint64_t fed = 0;
+    for (;;)
+    {
+        const auto now = Clock::now();
+        if (seconds > 0.0 && now - start >= std::chrono::duration<double>(seconds)) break;
+
+        if (!packets.empty() && rate > 0.0)
+        {
+            const uint64_t due = static_cast<uint64_t>(std::chrono::duration<double>(now - start).count() * rate);
+            for (; fed < due; ++fed)
+            {
+                const CapturedPacket& p = packets[fed % packets.size()];
+                PacketPipeline::Enqueue(p.direction, p.opcode, p.payload.data(),
+                                        static_cast<uint32_t>(p.payload.size()), p.connection);
+            }
+        }
+        if (now >= nextReport)
+        {
+            const ControlStats st = ControlServer::Stats();
+            printf("fed %llu, clients %u, subscribers %u, requests %llu, sent %llu (stand-in %llu, %llu busy), streamed %llu, dropped %llu\n",
+                   (unsigned long long)fed, st.clients, st.subscribers, (unsigned long long)st.requests,
+                   (unsigned long long)st.sent, (unsigned long long)s_standInSends.load(), (unsigned long long)st.busy,
+                   (unsigned long long)st.streamed, (unsigned long long)st.streamDropped);
+            fflush(stdout);
+            nextReport += std::chrono::seconds(1);
+        }
+        ControlServer::RunQueuedSends();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ControlServer::Stop();
+    PacketPipeline::Stop();
+    PacketReplay::SetSendFn(nullptr, nullptr);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) { Usage(); return 2; }
+    if (!strcmp(argv[1], "bench"))  return Bench(argc - 2, argv + 2);
+    if (!strcmp(argv[1], "stream")) return Stream(argc - 2, argv + 2);
+    if (!strcmp(argv[1], "serve"))  return Serve(argc - 2, argv + 2);
+    Usage();
+    return 2;
+}
@@ -0,0 +1,276 @@
+#include "PcapReader.h"
+#include "SessionDecoder.h"
+#include "crypto/WorldCrypt.h"
+#include "packet/CaptureFile.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+// ============================================================
+//  PacketGodDecrypt — offline world-stream decryptor
+//
+//  Input : raw TCP captures (pcap) of one or more world
+//          connections, plus the 40-byte session key(s)
+//          exported from the client (Stats tab → Export key).
+//  Output: one PacketGod capture (.pgcap) per input file with
+//          every decodable session; the record's connection
+//          byte numbers the sessions in the order they appear.
+//
+//  Keys are matched to sessions automatically, so one key file
+//  can cover a whole tap capture.  Parsing runs one input per
+//  worker, decryption one session per worker.
+// ============================================================
+
+using SessionKey = std::vector<uint8_t>;
+
+struct Input
+{
+    std::string  path;
+    std::string  outPath;
+    PcapReader   pcap;
+    bool         ok = false;
+    std::vector<SessionResult> sessions;
+};
+
+static void Usage()
+{
+    printf("usage: PacketGodDecrypt -k <key|keyfile> [-k ...] [-o out.pgcap] [-p port] [-j threads] <capture.pcap>...\n"
+           "\n"
+           "  -k  session key as 80 hex digits, or a file with one key per line\n"
+           "  -o  output file (single input only; default <capture>.pgcap)\n"
+           "  -p  only consider TCP flows to this server port\n"
+           "  -j  worker threads (default: all cores)\n");
+}
+
+// ============================================================
+//  Keys
+// ============================================================
+
+static bool ParseHexKey(const char* text, SessionKey& out)
+{
+    out.clear();
+    int hi = -1;
+    for (const char* p = text; *p; ++p)
+    {
+        if (isspace(static_cast<unsigned char>(*p))) continue;
+        if (!isxdigit(static_cast<unsigned char>(*p))) return false;
+        const int v = isdigit(static_cast<unsigned char>(*p)) ? *p - '0' : (tolower(*p) - 'a' + 10);
+        if (hi < 0) hi = v;
+        else
+        {
+            out.push_back(static_cast<uint8_t>((hi << 4) | v));
+            hi = -1;
+        }
+    }
+    return hi < 0 && out.size() == WorldCrypt::kSessionKeySize;
+}
+
+static bool LoadKeys(const char* arg, std::vector<SessionKey>& keys)
+{
+    SessionKey key;
+    if (ParseHexKey(arg, key))
+    {
+        keys.push_back(key);
+        return true;
+    }
+
+    FILE* f = fopen(arg, "r");
+    if (!f) return false;
+    char line[512];
+    size_t before = keys.size();
+    while (fgets(line, sizeof(line), f))
+    {
+        if (line[0] == '#') continue;
+        if (ParseHexKey(line, key)) keys.push_back(key);
+    }
+    fclose(f);
+    return keys.size() > before;
+}
+
+// ============================================================
+//  Worker pool — each worker pulls the next index until done
+// ============================================================
+
+template <typename Fn>
+static void ParallelFor(size_t count, unsigned threads, Fn fn)
+{
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < count; )
+            fn(i);
+    };
+
+    std::vector<std::thread> pool;
+    const unsigned n = static_cast<unsigned>(std::min<size_t>(threads, count));
+    for (unsigned t = 1; t < n; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+}
+
+// ============================================================
+//  Output
+// ============================================================
+
+static bool WriteCapture(const Input& in, uint64_t& written)
+{
+    CaptureWriter w;
+    if (!w.Open(in.outPath.c_str())) return false;
+
+    // Merge sessions by time; each is already time-ordered.
+    std::vector<size_t> cursor(in.sessions.size(), 0);
+    for (;;)
+    {
+        int best = -1;
+        for (size_t s = 0; s < in.sessions.size(); ++s)
+        {
+            const auto& pk = in.sessions[s].packets;
+            if (cursor[s] < pk.size() &&
+                (best < 0 || pk[cursor[s]].timestamp_us < in.sessions[best].packets[cursor[best]].timestamp_us))
+                best = static_cast<int>(s);
+        }
+        if (best < 0) break;
+
+        const SessionResult& sr = in.sessions[best];
+        const SessionPacket& p  = sr.packets[cursor[best]++];
+        const TcpFlow&       fl = in.pcap.Flows()[sr.flow];
+        const auto& bytes = (p.direction == PacketDirection::CMSG ? fl.toServer : fl.toClient).Bytes();
+        w.Write(p.direction, p.opcode, p.timestamp_us,
+                p.size ? &bytes[p.offset] : nullptr, p.size, static_cast<uint8_t>(best));
+    }
+    written = w.Count();
+    return w.Close();
+}
+
+// ============================================================
+//  main
+// ============================================================
+
+int main(int argc, char** argv)
+{
+    std::vector<SessionKey> keys;
+    std::vector<Input>      inputs;
+    std::string             outPath;
+    unsigned                threads = std::thread::hardware_concurrency();
+    int                     port    = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* a = argv[i];
+        if (a[0] == '-' && a[1] && !a[2] && i + 1 < argc)
+        {
+            const char* v = argv[++i];
+            switch (a[1])
+            {
+            case 'k':
+                if (!LoadKeys(v, keys))
+                {
+                    fprintf(stderr, "error: '%s' is neither an 80-digit hex key nor a key file\n", v);
+                    return 2;
+                }
+                continue;
+            case 'o': outPath = v;            continue;
+            case 'p': port    = atoi(v);      continue;
+            case 'j': threads = static_cast<unsigned>(atoi(v)); continue;
+            default: break;
+            }
+            Usage();
+            return 2;
+        }
+        inputs.emplace_back();
+        inputs.back().path = a;
+    }
+
+    if (inputs.empty() || keys.empty() || (!outPath.empty() && inputs.size() > 1))
+    {
+        Usage();
+        return 2;
+    }
+    if (threads == 0) threads = 1;
+    for (auto& in : inputs)
+        in.outPath = outPath.empty() ? in.path + ".pgcap" : outPath;
+
+    // Stage 1: read + reassemble every input
+    ParallelFor(inputs.size(), threads, [&](size_t i) {
+        inputs[i].ok = inputs[i].pcap.Read(inputs[i].path.c_str());
+    });
+
+    // Stage 2: one task per world session, across all inputs
+    struct Task { size_t input; size_t flow; };
+    std::vector<Task> tasks;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        if (!inputs[i].ok)
+        {
+            fprintf(stderr, "%s: %s\n", inputs[i].path.c_str(), inputs[i].pcap.Error().c_str());
+            continue;
+        }
+        const auto& flows = inputs[i].pcap.Flows();
+        for (size_t f = 0; f < flows.size(); ++f)
+            if ((!port || flows[f].server.port == port) && SessionDecoder::LooksLikeWorld(flows[f]))
+                tasks.push_back({ i, f });
+    }
+
+    std::vector<SessionResult> results(tasks.size());
+    ParallelFor(tasks.size(), threads, [&](size_t t) {
+        const TcpFlow& flow = inputs[tasks[t].input].pcap.Flows()[tasks[t].flow];
+        SessionResult& r = results[t];
+        r.flow = tasks[t].flow;
+        for (size_t k = 0; k < keys.size(); ++k)
+        {
+            if (!SessionDecoder::KeyMatches(flow, keys[k].data(), keys[k].size())) continue;
+            r.key = static_cast<int>(k);
+            SessionDecoder::Decode(flow, keys[k].data(), keys[k].size(), r);
+            break;
+        }
+    });
+
+    // Stage 3: report + write, in input order
+    int rc = 0;
+    for (size_t t = 0; t < tasks.size(); ++t)
+    {
+        Input& in = inputs[tasks[t].input];
+        const SessionResult& r = results[t];
+        const TcpFlow& flow = in.pcap.Flows()[r.flow];
+        if (r.key < 0)
+        {
+            printf("%s: %s -> %s  no matching key\n", in.path.c_str(),
+                   flow.client.ToString().c_str(), flow.server.ToString().c_str());
+            continue;
+        }
+        printf("%s: %s -> %s  key #%d, %zu packets%s", in.path.c_str(),
+               flow.client.ToString().c_str(), flow.server.ToString().c_str(),
+               r.key, r.packets.size(), r.desync ? ", DESYNC" : "");
+        if (r.leftover)                                  printf(", %llu tail bytes", (unsigned long long)r.leftover);
+        if (flow.toServer.Gaps() + flow.toClient.Gaps()) printf(", capture has holes");
+        printf("\n");
+        if (in.sessions.size() < 256)
+            in.sessions.push_back(r);
+    }
+
+    for (auto& in : inputs)
+    {
+        if (!in.ok) { rc = 1; continue; }
+        if (in.sessions.empty())
+        {
+            printf("%s: no decodable world sessions\n", in.path.c_str());
+            rc = 1;
+            continue;
+        }
+        uint64_t written = 0;
+        if (!WriteCapture(in, written))
+        {
+            fprintf(stderr, "%s: write failed\n", in.outPath.c_str());
+            rc = 1;
+            continue;
+        }
+        printf("%s: wrote %llu packets in %zu session(s)\n", in.outPath.c_str(),
+               (unsigned long long)written, in.sessions.size());
+    }
+    return rc;
+}
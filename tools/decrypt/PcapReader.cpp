@@ -0,0 +1,307 @@
+#include "PcapReader.h"
+#include <cstring>
+#include <algorithm>
+
+// ============================================================
+//  Endpoints
+// ============================================================
+
+bool TcpEndpoint::operator<(const TcpEndpoint& o) const
+{
+    if (v6 != o.v6) return v6 < o.v6;
+    if (int c = memcmp(addr, o.addr, sizeof(addr))) return c < 0;
+    return port < o.port;
+}
+
+bool TcpEndpoint::operator==(const TcpEndpoint& o) const
+{
+    return v6 == o.v6 && port == o.port && memcmp(addr, o.addr, sizeof(addr)) == 0;
+}
+
+std::string TcpEndpoint::ToString() const
+{
+    char buf[64];
+    if (!v6)
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u:%u", addr[0], addr[1], addr[2], addr[3], port);
+    else
+        snprintf(buf, sizeof(buf), "[%02x%02x:%02x%02x:..:%02x%02x]:%u",
+                 addr[0], addr[1], addr[2], addr[3], addr[14], addr[15], port);
+    return buf;
+}
+
+// ============================================================
+//  TcpStream — sequence-number reassembly
+// ============================================================
+
+void TcpStream::Append(const uint8_t* data, uint32_t len, uint64_t ts_us)
+{
+    m_marks.emplace_back(m_data.size(), ts_us);
+    m_data.insert(m_data.end(), data, data + len);
+    m_nextSeq += len;
+}
+
+void TcpStream::OnSegment(uint32_t seq, bool syn, const uint8_t* data, uint32_t len, uint64_t ts_us)
+{
+    if (syn)
+    {
+        if (!m_started)
+        {
+            m_started = true;
+            m_nextSeq = seq + 1;
+        }
+        ++seq;   // SYN consumes one sequence number
+    }
+    if (!len) return;
+    if (!m_started)
+    {
+        // Capture began mid-connection; take the first data as the stream start.
+        m_started = true;
+        m_nextSeq = seq;
+    }
+
+    // Signed distance handles 32-bit sequence wrap.
+    int32_t ahead = static_cast<int32_t>(seq - m_nextSeq);
+    if (ahead < 0)
+    {
+        // Retransmission / overlap: keep only the new tail.
+        const uint32_t old = static_cast<uint32_t>(-ahead);
+        if (old >= len) return;
+        data += old; len -= old; ahead = 0;
+    }
+
+    if (ahead > 0)
+    {
+        const uint64_t abs = m_data.size() + static_cast<uint64_t>(ahead);
+        Pending& p = m_pending[abs];
+        if (p.data.size() < len)
+        {
+            p.data.assign(data, data + len);
+            p.ts_us = ts_us;
+        }
+        return;
+    }
+
+    Append(data, len, ts_us);
+
+    // Pull in held segments the new data made contiguous.
+    while (!m_pending.empty())
+    {
+        auto it = m_pending.begin();
+        const uint64_t have = m_data.size();
+        if (it->first > have) break;
+        const uint64_t skip = have - it->first;
+        if (skip < it->second.data.size())
+            Append(it->second.data.data() + skip,
+                   static_cast<uint32_t>(it->second.data.size() - skip), it->second.ts_us);
+        m_pending.erase(it);
+    }
+}
+
+uint64_t TcpStream::Gaps() const
+{
+    uint64_t n = 0;
+    for (const auto& kv : m_pending) n += kv.second.data.size();
+    return n;
+}
+
+uint64_t TcpStream::TimestampAt(size_t offset) const
+{
+    auto it = std::upper_bound(m_marks.begin(), m_marks.end(), offset,
+                               [](size_t off, const std::pair<size_t, uint64_t>& m) { return off < m.first; });
+    return it == m_marks.begin() ? 0 : (it - 1)->second;
+}
+
+// ============================================================
+//  Packet decoding
+// ============================================================
+
+static uint16_t Be16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+static uint32_t Be32(const uint8_t* p) { return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]; }
+
+enum : uint32_t
+{
+    LINKTYPE_NULL      = 0,
+    LINKTYPE_ETHERNET  = 1,
+    LINKTYPE_RAW       = 101,
+    LINKTYPE_LINUX_SLL = 113,
+    LINKTYPE_IPV4      = 228,
+    LINKTYPE_IPV6      = 229,
+};
+
+void PcapReader::OnPacket(const uint8_t* p, uint32_t len, uint32_t linkType, uint64_t ts_us)
+{
+    uint16_t etherType = 0;
+    switch (linkType)
+    {
+    case LINKTYPE_ETHERNET:
+        if (len < 14) return;
+        etherType = Be16(p + 12); p += 14; len -= 14;
+        while (etherType == 0x8100 && len >= 4)   // 802.1Q VLAN tag
+        {
+            etherType = Be16(p + 2); p += 4; len -= 4;
+        }
+        break;
+    case LINKTYPE_LINUX_SLL:
+        if (len < 16) return;
+        etherType = Be16(p + 14); p += 16; len -= 16;
+        break;
+    case LINKTYPE_NULL:
+        if (len < 4) return;
+        p += 4; len -= 4;   // host-order AF_ value; the IP version nibble decides below
+        break;
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV4:
+    case LINKTYPE_IPV6:
+        break;
+    default:
+        return;
+    }
+    if (!len) return;
+    if (etherType && etherType != 0x0800 && etherType != 0x86DD) return;
+
+    TcpEndpoint src = {}, dst = {};
+    const uint8_t version = p[0] >> 4;
+    if (version == 4)
+    {
+        if (len < 20) return;
+        const uint32_t ihl   = (p[0] & 0x0F) * 4u;
+        const uint32_t total = Be16(p + 2);
+        if (ihl < 20 || total < ihl || total > len || p[9] != 6 /*TCP*/) return;
+        if (Be16(p + 6) & 0x3FFF) return;   // fragment
+        memcpy(src.addr, p + 12, 4);
+        memcpy(dst.addr, p + 16, 4);
+        p += ihl; len = total - ihl;
+    }
+    else if (version == 6)
+    {
+        if (len < 40 || p[6] != 6 /*TCP, no extension headers*/) return;
+        const uint32_t payload = Be16(p + 4);
+        if (40 + payload > len) return;
+        src.v6 = dst.v6 = true;
+        memcpy(src.addr, p + 8, 16);
+        memcpy(dst.addr, p + 24, 16);
+        p += 40; len = payload;
+    }
+    else
+        return;
+
+    OnTcp(src, dst, p, len, ts_us);
+}
+
+void PcapReader::OnTcp(const TcpEndpoint& srcIn, const TcpEndpoint& dstIn,
+                       const uint8_t* tcp, uint32_t len, uint64_t ts_us)
+{
+    if (len < 20) return;
+    const uint32_t off = (tcp[12] >> 4) * 4u;
+    if (off < 20 || off > len) return;
+
+    TcpEndpoint src = srcIn, dst = dstIn;
+    src.port = Be16(tcp);
+    dst.port = Be16(tcp + 2);
+    const uint32_t seq   = Be32(tcp + 4);
+    const uint8_t  flags = tcp[13];
+    const bool     syn   = (flags & 0x02) != 0;
+    const bool     ack   = (flags & 0x10) != 0;
+
+    // Orient the flow: (client, server).  A SYN names the client, a
+    // SYN-ACK the server; without either, guess the ephemeral (higher)
+    // port is the client and let a late SYN correct it.
+    size_t flowIdx;
+    bool   fromClient;
+    auto it = m_index.find({ src, dst });
+    if (it != m_index.end()) { flowIdx = it->second; fromClient = true; }
+    else if ((it = m_index.find({ dst, src })) != m_index.end()) { flowIdx = it->second; fromClient = false; }
+    else
+    {
+        const bool srcIsClient = syn ? !ack : src.port > dst.port;
+        TcpFlow flow;
+        flow.client = srcIsClient ? src : dst;
+        flow.server = srcIsClient ? dst : src;
+        flowIdx = m_flows.size();
+        m_flows.push_back(std::move(flow));
+        m_index[{ m_flows.back().client, m_flows.back().server }] = flowIdx;
+        fromClient = srcIsClient;
+    }
+
+    if (syn && fromClient == ack)
+    {
+        // Handshake contradicts the guess: swap roles.
+        TcpFlow& fl = m_flows[flowIdx];
+        m_index.erase({ fl.client, fl.server });
+        std::swap(fl.client, fl.server);
+        std::swap(fl.toServer, fl.toClient);
+        m_index[{ fl.client, fl.server }] = flowIdx;
+        fromClient = !fromClient;
+    }
+
+    TcpFlow& flow = m_flows[flowIdx];
+    (fromClient ? flow.toServer : flow.toClient).OnSegment(seq, syn, tcp + off, len - off, ts_us);
+}
+
+// ============================================================
+//  File reading
+// ============================================================
+
+bool PcapReader::Read(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+    {
+        m_error = "cannot open file";
+        return false;
+    }
+
+    uint8_t gh[24];
+    if (fread(gh, sizeof(gh), 1, f) != 1)
+    {
+        fclose(f);
+        m_error = "truncated pcap header";
+        return false;
+    }
+
+    uint32_t magic;
+    memcpy(&magic, gh, 4);
+    bool swap, nanos;
+    switch (magic)
+    {
+    case 0xA1B2C3D4: swap = false; nanos = false; break;
+    case 0xD4C3B2A1: swap = true;  nanos = false; break;
+    case 0xA1B23C4D: swap = false; nanos = true;  break;
+    case 0x4D3CB2A1: swap = true;  nanos = true;  break;
+    default:
+        fclose(f);
+        m_error = "not a classic pcap file (pcapng is not supported)";
+        return false;
+    }
+
+    auto rd32 = [swap](const uint8_t* p) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        return swap ? ((v >> 24) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24)) : v;
+    };
+    const uint32_t linkType = rd32(gh + 20) & 0x0FFFFFFF;
+
+    std::vector<uint8_t> buf;
+    uint8_t rh[16];
+    bool first = true;
+    while (fread(rh, sizeof(rh), 1, f) == 1)
+    {
+        const uint32_t sec  = rd32(rh);
+        const uint32_t frac = rd32(rh + 4);
+        const uint32_t incl = rd32(rh + 8);
+        if (incl > (1u << 24))
+        {
+            m_error = "corrupt record length";
+            break;
+        }
+        buf.resize(incl);
+        if (incl && fread(buf.data(), incl, 1, f) != 1) break;   // truncated tail: keep what we have
+
+        const uint64_t ts = uint64_t(sec) * 1000000ULL + (nanos ? frac / 1000 : frac);
+        if (first) { m_firstTs = ts; first = false; }
+        ++m_packets;
+        OnPacket(buf.data(), incl, linkType, ts >= m_firstTs ? ts - m_firstTs : 0);
+    }
+    fclose(f);
+    return m_error.empty();
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <vector>
+#include <string>
+
+// ============================================================
+//  PcapReader — classic libpcap files → reassembled TCP streams
+//
+//  Reads µs and ns pcap in either byte order.  Link types:
+//  Ethernet (incl. 802.1Q), raw IP, Linux cooked (SLL) and BSD
+//  loopback.  IPv4 and IPv6, no IP fragment reassembly (the
+//  world protocol never relies on it).
+//
+//  Every TCP connection becomes a TcpFlow with both directions
+//  reassembled by sequence number: retransmissions and overlaps
+//  are trimmed, out-of-order segments are held until the gap
+//  fills.  Each byte range remembers the capture timestamp of
+//  the segment that delivered it.
+// ============================================================
+
+struct TcpEndpoint
+{
+    uint8_t  addr[16];   // IPv4 mapped into the first 4 bytes
+    uint16_t port;
+    bool     v6;
+
+    bool operator<(const TcpEndpoint& o) const;
+    bool operator==(const TcpEndpoint& o) const;
+    std::string ToString() const;
+};
+
+class TcpStream
+{
+public:
+    void OnSegment(uint32_t seq, bool syn, const uint8_t* data, uint32_t len, uint64_t ts_us);
+
+    const std::vector<uint8_t>& Bytes() const { return m_data; }
+    // Capture time of the segment that delivered byte `offset`.
+    uint64_t TimestampAt(size_t offset) const;
+    // Bytes received past a hole that never filled.
+    uint64_t Gaps() const;
+
+private:
+    void Append(const uint8_t* data, uint32_t len, uint64_t ts_us);
+
+    struct Pending
+    {
+        std::vector<uint8_t> data;
+        uint64_t             ts_us;
+    };
+
+    bool                   m_started = false;
+    uint32_t               m_nextSeq = 0;
+    std::vector<uint8_t>   m_data;
+    std::vector<std::pair<size_t, uint64_t>> m_marks;   // (first offset, ts) per appended run
+    std::map<uint64_t, Pending> m_pending;              // absolute stream offset → early segment
+};
+
+struct TcpFlow
+{
+    TcpEndpoint client;       // side that sent the SYN (or first seen)
+    TcpEndpoint server;
+    TcpStream   toServer;     // CMSG bytes
+    TcpStream   toClient;     // SMSG bytes
+};
+
+class PcapReader
+{
+public:
+    // Reads the whole file.  Timestamps are rebased to the first
+    // packet.  Returns false (with Error() set) on unreadable input.
+    bool Read(const char* path);
+
+    const std::vector<TcpFlow>& Flows() const { return m_flows; }
+    const std::string&          Error() const { return m_error; }
+    uint64_t                    Packets() const { return m_packets; }
+
+private:
+    void OnPacket(const uint8_t* data, uint32_t len, uint32_t linkType, uint64_t ts_us);
+    void OnTcp(const TcpEndpoint& src, const TcpEndpoint& dst,
+               const uint8_t* tcp, uint32_t len, uint64_t ts_us);
+
+    std::vector<TcpFlow>                m_flows;
+    std::map<std::pair<TcpEndpoint, TcpEndpoint>, size_t> m_index;   // (client, server) → flow
+    std::string                         m_error;
+    uint64_t                            m_packets = 0;
+    uint64_t                            m_firstTs = 0;
+};
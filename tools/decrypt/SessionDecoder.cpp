@@ -0,0 +1,126 @@
+#include "SessionDecoder.h"
+#include "crypto/WorldCrypt.h"
+#include "Opcodes.h"
+#include <algorithm>
+#include <cstring>
+
+static constexpr size_t   kProbePackets = 3;
+static constexpr uint32_t kMaxPacket    = 0x7FFFFF;
+
+// ============================================================
+//  Header walk
+//
+//  CMSG  [2] size BE (opcode + payload)  [4] opcode LE
+//  SMSG  [2] size BE  [2] opcode LE, or with bit 7 of byte 0 set
+//        [3] size BE (23 bits)  [2] opcode LE
+// ============================================================
+
+struct WalkResult
+{
+    size_t consumed = 0;
+    bool   bad      = false;
+};
+
+static WalkResult Walk(const TcpStream& stream, PacketDirection dir, HeaderCipher& cipher,
+                       size_t maxPackets, std::vector<SessionPacket>* out)
+{
+    const std::vector<uint8_t>& b = stream.Bytes();
+    WalkResult r;
+    size_t pos = 0;
+
+    for (size_t n = 0; n < maxPackets; ++n)
+    {
+        const bool plain = (n == 0);
+        uint8_t  hdr[6];
+        size_t   hlen;
+        uint32_t size;
+        uint16_t opcode;
+
+        if (dir == PacketDirection::CMSG)
+        {
+            hlen = 6;
+            if (b.size() - pos < hlen) break;
+            memcpy(hdr, &b[pos], hlen);
+            if (!plain) cipher.Process(hdr, hlen);
+            const uint32_t field = (uint32_t(hdr[0]) << 8) | hdr[1];
+            if (field < 4) { r.bad = true; break; }
+            size   = field - 4;
+            opcode = static_cast<uint16_t>(hdr[2] | (hdr[3] << 8));
+            if (hdr[4] | hdr[5]) { r.bad = true; break; }   // opcode high word is always zero
+        }
+        else
+        {
+            if (b.size() - pos < 4) break;
+            hdr[0] = b[pos];
+            if (!plain) cipher.Process(hdr, 1);
+            hlen = (hdr[0] & 0x80) ? 5 : 4;
+            if (b.size() - pos < hlen) break;
+            memcpy(hdr + 1, &b[pos + 1], hlen - 1);
+            if (!plain) cipher.Process(hdr + 1, hlen - 1);
+
+            uint32_t field;
+            if (hlen == 5)
+            {
+                field  = (uint32_t(hdr[0] & 0x7F) << 16) | (uint32_t(hdr[1]) << 8) | hdr[2];
+                opcode = static_cast<uint16_t>(hdr[3] | (hdr[4] << 8));
+            }
+            else
+            {
+                field  = (uint32_t(hdr[0]) << 8) | hdr[1];
+                opcode = static_cast<uint16_t>(hdr[2] | (hdr[3] << 8));
+            }
+            if (field < 2 || field > kMaxPacket) { r.bad = true; break; }
+            size = field - 2;
+        }
+
+        if (opcode >= NUM_MSG_TYPES) { r.bad = true; break; }
+        if (b.size() - pos - hlen < size)
+        {
+            // Payload never fully arrived; the header keystream is spent,
+            // but nothing after it can be framed anyway.
+            break;
+        }
+
+        if (out)
+            out->push_back({ stream.TimestampAt(pos), static_cast<uint32_t>(pos + hlen), size, opcode, dir });
+        pos += hlen + size;
+        r.consumed = pos;
+    }
+    return r;
+}
+
+// ============================================================
+//  Public entry points
+// ============================================================
+
+bool SessionDecoder::LooksLikeWorld(const TcpFlow& flow)
+{
+    const std::vector<uint8_t>& b = flow.toClient.Bytes();
+    return b.size() >= 4 && (b[2] | (b[3] << 8)) == SMSG_AUTH_CHALLENGE;
+}
+
+bool SessionDecoder::KeyMatches(const TcpFlow& flow, const uint8_t* sessionKey, size_t keyLen)
+{
+    HeaderCipher cipher;
+    cipher.Init(PacketDirection::SMSG, sessionKey, keyLen);
+
+    std::vector<SessionPacket> probe;
+    const WalkResult r = Walk(flow.toClient, PacketDirection::SMSG, cipher, 1 + kProbePackets, &probe);
+    return !r.bad && probe.size() >= 2 && probe[1].opcode == SMSG_AUTH_RESPONSE;
+}
+
+void SessionDecoder::Decode(const TcpFlow& flow, const uint8_t* sessionKey, size_t keyLen, SessionResult& out)
+{
+    HeaderCipher cmsg, smsg;
+    cmsg.Init(PacketDirection::CMSG, sessionKey, keyLen);
+    smsg.Init(PacketDirection::SMSG, sessionKey, keyLen);
+
+    const WalkResult rc = Walk(flow.toServer, PacketDirection::CMSG, cmsg, SIZE_MAX, &out.packets);
+    const WalkResult rs = Walk(flow.toClient, PacketDirection::SMSG, smsg, SIZE_MAX, &out.packets);
+
+    out.desync   = rc.bad || rs.bad;
+    out.leftover = (flow.toServer.Bytes().size() - rc.consumed) + (flow.toClient.Bytes().size() - rs.consumed);
+
+    std::stable_sort(out.packets.begin(), out.packets.end(),
+                     [](const SessionPacket& a, const SessionPacket& b) { return a.timestamp_us < b.timestamp_us; });
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include "PcapReader.h"
+#include "wow/WowTypes.h"
+
+// ============================================================
+//  SessionDecoder — frame and decrypt one reassembled world flow
+//
+//  Both directions start with one plaintext packet
+//  (SMSG_AUTH_CHALLENGE / CMSG_AUTH_SESSION); every header after
+//  that is ARC4-enciphered with the direction's key (see
+//  WorldCrypt).  Payloads are never enciphered, so decoding is
+//  a header walk over the stream bytes.
+// ============================================================
+
+struct SessionPacket
+{
+    uint64_t        timestamp_us;
+    uint32_t        offset;        // payload offset in the direction's stream
+    uint32_t        size;
+    uint16_t        opcode;
+    PacketDirection direction;
+};
+
+struct SessionResult
+{
+    size_t   flow      = 0;
+    int      key       = -1;       // index into the key list, -1 = none matched
+    uint64_t leftover  = 0;        // undecodable tail bytes (both directions)
+    bool     desync    = false;    // an implausible header stopped a direction early
+    std::vector<SessionPacket> packets;   // time-ordered, CMSG before SMSG on ties
+};
+
+namespace SessionDecoder
+{
+    // SMSG side opens with a plaintext SMSG_AUTH_CHALLENGE.
+    bool LooksLikeWorld(const TcpFlow& flow);
+
+    // The first enciphered SMSG decodes to SMSG_AUTH_RESPONSE and the
+    // next few headers are plausible.
+    bool KeyMatches(const TcpFlow& flow, const uint8_t* sessionKey, size_t keyLen);
+
+    void Decode(const TcpFlow& flow, const uint8_t* sessionKey, size_t keyLen, SessionResult& out);
+}
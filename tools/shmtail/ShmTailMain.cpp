@@ -0,0 +1,191 @@
+#include "ipc/ShmRing.h"
+#include "packet/CaptureFile.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+// ============================================================
+//  PacketGodShmTail — out-of-process consumer of the capture ring
+//
+//    tail <pid|name>            follow a client's ring, one line per packet
+//    feed <name> <file.pgcap>   publish a capture into a new ring
+//
+//  `tail` reads payloads in place and validates each record after
+//  use; the writer is never waited on, so a slow reader loses the
+//  oldest records and reports the gap.  `feed` is the stand-in
+//  writer for running analyzers without the game.
+// ============================================================
+
+static void Usage()
+{
+    printf("usage: PacketGodShmTail tail [-n] [-c count] [-q] <pid|name>\n"
+           "       PacketGodShmTail feed [-l loops] [-r packets/s] [-h seconds] <name> <capture.pgcap>\n"
+           "\n"
+           "  tail -n  start at the newest record instead of the oldest\n"
+           "       -c  exit after this many packets\n"
+           "       -q  no per-packet lines, statistics only\n"
+           "  feed -l  publish the capture this many times (default 1)\n"
+           "       -r  throttle to this many packets per second (default: unthrottled)\n"
+           "       -h  keep the ring open this long after the last packet (default 2)\n");
+}
+
+static void ResolveName(const char* arg, char* out, size_t outSize)
+{
+    const char* p = arg;
+    while (*p && isdigit(static_cast<unsigned char>(*p))) ++p;
+    if (*arg && !*p)
+        ShmRing::DefaultName(static_cast<uint32_t>(strtoul(arg, nullptr, 10)), out, outSize);
+    else
+        snprintf(out, outSize, "%s", arg);
+}
+
+// FNV-1a over the payload — shows the bytes were actually read.
+static uint32_t Fnv1a(const uint8_t* p, uint32_t n)
+{
+    uint32_t h = 2166136261u;
+    for (uint32_t i = 0; i < n; ++i) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+// ============================================================
+//  tail
+// ============================================================
+
+static int Tail(int argc, char** argv)
+{
+    bool     newest = false, quiet = false;
+    uint64_t limit  = 0;
+    const char* target = nullptr;
+    for (int i = 0; i < argc; ++i)
+    {
+        if      (!strcmp(argv[i], "-n")) newest = true;
+        else if (!strcmp(argv[i], "-q")) quiet  = true;
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc) limit = strtoull(argv[++i], nullptr, 10);
+        else target = argv[i];
+    }
+    if (!target) { Usage(); return 2; }
+
+    char name[64];
+    ResolveName(target, name, sizeof(name));
+
+    ShmRingReader reader;
+    if (!reader.Open(name))
+    {
+        fprintf(stderr, "cannot open ring %s\n", name);
+        return 1;
+    }
+    if (newest) reader.SeekNewest();
+    printf("tailing %s (writer pid %u)\n", name, reader.WriterPid());
+
+    uint64_t packets = 0, lastSeq = 0, seqGaps = 0, idle = 0;
+    ShmPacketView v;
+    while (!limit || packets < limit)
+    {
+        if (!reader.Next(v))
+        {
+            if (reader.Stats().stale)
+            {
+                fprintf(stderr, "writer stopped mid-publish (ring lock held), giving up\n");
+                break;
+            }
+            // The writer unlinks the ring on exit; stop after ~2 s of silence once it is gone.
+            if (++idle > 2000)
+            {
+                ShmRingReader probe;
+                if (!probe.Open(name)) break;
+                idle = 0;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        idle = 0;
+
+        const uint32_t hash = Fnv1a(v.payload, v.rec.size);
+        if (!reader.Validate(v)) continue;   // overwritten while hashing; Next() resyncs
+
+        if (lastSeq && v.rec.seq != lastSeq + 1) ++seqGaps;
+        lastSeq = v.rec.seq;
+        ++packets;
+        if (!quiet)
+            printf("%8llu %12.6f %s 0x%04X conn=%u %6u bytes fnv=%08X%s\n",
+                   (unsigned long long)v.rec.seq, v.rec.timestamp_us / 1e6,
+                   v.rec.direction ? "SMSG" : "CMSG", v.rec.opcode, v.rec.connection,
+                   v.wireSize, hash, v.wireSize > v.rec.size ? " (truncated)" : "");
+    }
+
+    const ShmReaderStats st = reader.Stats();
+    const ShmRingReader::HeaderSnapshot hs = reader.ReadHeader();
+    printf("read %llu packets (last seq %llu), %llu seq gaps, %llu overruns (%llu KiB lost), %llu torn%s; "
+           "writer: %llu records, %llu oversize dropped\n",
+           (unsigned long long)packets, (unsigned long long)lastSeq, (unsigned long long)seqGaps,
+           (unsigned long long)st.overruns, (unsigned long long)(st.lostBytes >> 10),
+           (unsigned long long)st.torn, st.stale ? ", writer stale" : "", (unsigned long long)hs.records, (unsigned long long)hs.dropped);
+    return 0;
+}
+
+// ============================================================
+//  feed
+// ============================================================
+
+static int Feed(int argc, char** argv)
+{
+    int    loops = 1;
+    double rate  = 0.0, hold = 2.0;
+    const char* args[2] = {};
+    int nargs = 0;
+    for (int i = 0; i < argc; ++i)
+    {
+        if      (!strcmp(argv[i], "-l") && i + 1 < argc) loops = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) rate  = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-h") && i + 1 < argc) hold  = atof(argv[++i]);
+        else if (nargs < 2) args[nargs++] = argv[i];
+    }
+    if (nargs != 2 || loops < 1) { Usage(); return 2; }
+
+    std::vector<CapturedPacket> packets;
+    if (!CaptureFile::Load(args[1], packets))
+    {
+        fprintf(stderr, "cannot read %s\n", args[1]);
+        return 1;
+    }
+
+    ShmRingWriter writer;
+    if (!writer.Create(args[0], 16u << 20, 0))
+    {
+        fprintf(stderr, "cannot create ring %s\n", args[0]);
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t seq = 0;
+    for (int l = 0; l < loops; ++l)
+        for (const CapturedPacket& pkt : packets)
+        {
+            if (rate > 0.0)
+                std::this_thread::sleep_until(start + std::chrono::duration<double>(seq / rate));
+            writer.Append(++seq, pkt.timestamp_us, pkt.direction, pkt.opcode, pkt.connection,
+                          pkt.payload.data(), static_cast<uint32_t>(pkt.payload.size()), pkt.size);
+        }
+
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const ShmWriterStats st = writer.Stats();
+    printf("fed %llu records (%llu KiB) in %.3f s, %llu overwritten, %llu oversize dropped\n",
+           (unsigned long long)st.records, (unsigned long long)(st.bytes >> 10), secs,
+           (unsigned long long)st.overwritten, (unsigned long long)st.dropped);
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(hold));
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) { Usage(); return 2; }
+    if (!strcmp(argv[1], "tail")) return Tail(argc - 2, argv + 2);
+    if (!strcmp(argv[1], "feed")) return Feed(argc - 2, argv + 2);
+    Usage();
+    return 2;
+}